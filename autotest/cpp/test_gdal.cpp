@@ -25,7 +25,9 @@
 
 #include "gdal_unit_test.h"
 
+#include <gdal_alg.h>
 #include <gdal_priv.h>
+#include <gdal_proxy.h>
 #include <gdal_utils.h>
 #include <gdal_priv_templates.hpp>
 #include <gdal.h>
@@ -466,4 +468,90 @@ namespace tut
         ensure_equals( GDALDataTypeIsComplex(GDT_CFloat64), TRUE );
     }
 
+    // Test the pool of datasets of GDALProxyPoolDataset
+    template<> template<> void object::test<16>()
+    {
+        GDALProxyPoolDataset* poProxyDS = new GDALProxyPoolDataset(
+            GCORE_DATA_DIR "byte.tif", 20, 20, GA_ReadOnly, TRUE);
+        poProxyDS->AddSrcBandDescription(GDT_Byte, 20, 20);
+
+        GDALProxyPoolStatistics sStats;
+        ensure( GDALGetProxyPoolStatistics(&sStats) );
+        ensure_equals( sStats.nHits, 0U );
+        ensure_equals( sStats.nMisses, 0U );
+        ensure_equals( sStats.nCurrentSize, 0 );
+
+        // First access opens the underlying dataset, next ones reuse it
+        ensure_equals( GDALChecksumImage(poProxyDS->GetRasterBand(1),
+                                         0, 0, 20, 20), 4672 );
+        ensure_equals( GDALChecksumImage(poProxyDS->GetRasterBand(1),
+                                         0, 0, 20, 20), 4672 );
+        ensure( GDALGetProxyPoolStatistics(&sStats) );
+        ensure_equals( sStats.nMisses, 1U );
+        ensure( sStats.nHits > 0 );
+        ensure_equals( sStats.nEvictions, 0U );
+        ensure_equals( sStats.nCurrentSize, 1 );
+        ensure( sStats.dfOpenTime >= 0.0 );
+        ensure( sStats.dfMaxOpenTime <= sStats.dfOpenTime );
+
+        // The pool is destroyed with the last proxy dataset
+        delete poProxyDS;
+        ensure( !GDALGetProxyPoolStatistics(&sStats) );
+    }
+
+    // Test concurrent use of the overview and mask bands of a
+    // GDALProxyPoolDataset, each thread getting its own underlying dataset
+    struct ProxyPoolThreadData
+    {
+        GDALProxyPoolDataset* poProxyDS;
+        int                   nErrors;
+    };
+
+    static void ProxyPoolOverviewAndMaskThread( void* pData )
+    {
+        ProxyPoolThreadData* psData = static_cast<ProxyPoolThreadData*>(pData);
+        GDALRasterBand* poBand = psData->poProxyDS->GetRasterBand(1);
+        for( int i = 0; i < 50; i++ )
+        {
+            GDALRasterBand* poOvrBand = poBand->GetOverview(0);
+            if( poOvrBand == nullptr ||
+                GDALChecksumImage(poOvrBand, 0, 0, 10, 10) != 1126 ||
+                GDALChecksumImage(poBand->GetMaskBand(),
+                                  0, 0, 20, 20) != 1222 )
+            {
+                psData->nErrors ++;
+            }
+        }
+    }
+
+    template<> template<> void object::test<17>()
+    {
+        GDALProxyPoolDataset* poProxyDS = new GDALProxyPoolDataset(
+            GCORE_DATA_DIR "test_with_mask_1bit_and_ovr.tif", 20, 20,
+            GA_ReadOnly, TRUE);
+        poProxyDS->AddSrcBandDescription(GDT_Byte, 20, 20);
+
+        ProxyPoolThreadData asData[4];
+        CPLJoinableThread* ahThreads[4];
+        for( int i = 0; i < 4; i++ )
+        {
+            asData[i].poProxyDS = poProxyDS;
+            asData[i].nErrors = 0;
+            ahThreads[i] = CPLCreateJoinableThread(
+                ProxyPoolOverviewAndMaskThread, &asData[i]);
+            ensure( ahThreads[i] != nullptr );
+        }
+        for( int i = 0; i < 4; i++ )
+        {
+            CPLJoinThread(ahThreads[i]);
+            ensure_equals( asData[i].nErrors, 0 );
+        }
+
+        // All the references taken through the overview and mask bands
+        // must have been released
+        delete poProxyDS;
+        GDALProxyPoolStatistics sStats;
+        ensure( !GDALGetProxyPoolStatistics(&sStats) );
+    }
+
 } // namespace tut
@@ -778,4 +778,40 @@ namespace tut
         ensure_equals(ReadFloat64(&pabyBufferRO, abyBuffer + 8), 1.25);
     }
 
+    // Test OGRSimpleCurve point buffer growth and reuse
+    template<>
+    template<>
+    void object::test<11>()
+    {
+        OGRLineString oLS;
+        for( int i = 0; i < 1000; i++ )
+            oLS.addPoint( i, -i, 2 * i );
+        ensure_equals( oLS.getNumPoints(), 1000 );
+        for( int i = 0; i < 1000; i++ )
+        {
+            ensure_equals( oLS.getX(i), i );
+            ensure_equals( oLS.getY(i), -i );
+            ensure_equals( oLS.getZ(i), 2 * i );
+        }
+
+        // Shrinking then growing again must not keep stale values
+        oLS.setNumPoints( 2 );
+        oLS.setNumPoints( 4 );
+        ensure_equals( oLS.getX(1), 1 );
+        ensure_equals( oLS.getX(3), 0 );
+        ensure_equals( oLS.getZ(3), 0 );
+
+        // M array allocated after growth must cover all points
+        oLS.setNumPoints( 10 );
+        oLS.setM( 9, 5 );
+        ensure_equals( oLS.getM(9), 5 );
+        ensure_equals( oLS.getM(8), 0 );
+
+        oLS.empty();
+        ensure_equals( oLS.getNumPoints(), 0 );
+        oLS.addPoint( 1, 2 );
+        ensure_equals( oLS.getX(0), 1 );
+        ensure_equals( oLS.getY(0), 2 );
+    }
+
 } // namespace tut
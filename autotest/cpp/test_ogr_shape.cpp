@@ -406,4 +406,42 @@ namespace tut
         OGR_DS_Destroy(ds);
     }
 
+    // Test GetNextFeatureInto() gives the same results as GetNextFeature()
+    template<>
+    template<>
+    void object::test<11>()
+    {
+        std::string tmp(data_tmp_);
+        tmp += SEP;
+        tmp += "tpoly.shp";
+        OGRDataSourceH ds = OGR_Dr_Open(drv_, tmp.c_str(), false);
+        ensure("Can't open layer", nullptr != ds);
+
+        OGRLayerH lyr = OGR_DS_GetLayer(ds, 0);
+        ensure("Can't get layer", nullptr != lyr);
+
+        std::vector<OGRFeatureH> features;
+        OGRFeatureH feat = nullptr;
+        while( (feat = OGR_L_GetNextFeature(lyr)) != nullptr )
+            features.push_back(feat);
+        ensure("Didn't get any feature", !features.empty());
+
+        OGR_L_ResetReading(lyr);
+        OGRFeatureH reused = OGR_F_Create(OGR_L_GetLayerDefn(lyr));
+        size_t count = 0;
+        while( OGR_L_GetNextFeatureInto(lyr, reused) )
+        {
+            ensure("Got too many features", count < features.size());
+            ensure("Features differ",
+                   OGR_F_Equal(features[count], reused) != FALSE);
+            count++;
+        }
+        ensure_equals("Wrong feature count", count, features.size());
+
+        OGR_F_Destroy(reused);
+        for( size_t i = 0; i < features.size(); i++ )
+            OGR_F_Destroy(features[i]);
+        OGR_DS_Destroy(ds);
+    }
+
 } // namespace tut
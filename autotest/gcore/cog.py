@@ -0,0 +1,279 @@
+#!/usr/bin/env python
+###############################################################################
+# $Id$
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test COG driver (cloud optimized GeoTIFF generation).
+#
+###############################################################################
+# Copyright (c) 2018, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import struct
+import sys
+
+from osgeo import gdal
+
+sys.path.append('../pymod')
+
+import gdaltest
+
+###############################################################################
+# Check that the IFDs are before the imagery, and that each block is
+# surrounded by its leader and trailer.
+
+
+def _check_cog_layout(filename):
+
+    f = gdal.VSIFOpenL(filename, 'rb')
+    data = gdal.VSIFReadL(1, gdal.VSIStatL(filename).size, f)
+    gdal.VSIFCloseL(f)
+
+    if data[8:8 + len('GDAL_STRUCTURAL_METADATA_SIZE=')] != \
+            b'GDAL_STRUCTURAL_METADATA_SIZE=':
+        gdaltest.post_reason('missing ghost header')
+        return False
+    if data.find(b'LAYOUT=IFDS_BEFORE_DATA') < 0:
+        gdaltest.post_reason('missing LAYOUT')
+        return False
+
+    ds = gdal.Open(filename)
+    bands = [ds.GetRasterBand(1)]
+    for i in range(ds.GetRasterBand(1).GetOverviewCount()):
+        bands.append(ds.GetRasterBand(1).GetOverview(i))
+    smallest_ovr_idx = len(bands) - 1
+    if ds.GetRasterBand(1).GetMaskFlags() == gdal.GMF_PER_DATASET:
+        bands.append(ds.GetRasterBand(1).GetMaskBand())
+
+    ifd_offsets = []
+    data_offsets = []
+    first_data_offsets = []
+    for band in bands:
+        ifd_offsets.append(int(band.GetMetadataItem('IFD_OFFSET', 'TIFF')))
+        (blockxsize, blockysize) = band.GetBlockSize()
+        nblocksx = (band.XSize + blockxsize - 1) // blockxsize
+        nblocksy = (band.YSize + blockysize - 1) // blockysize
+        ifd_data_offsets = []
+        for y in range(nblocksy):
+            for x in range(nblocksx):
+                offset = int(band.GetMetadataItem(
+                    'BLOCK_OFFSET_%d_%d' % (x, y), 'TIFF'))
+                size = int(band.GetMetadataItem(
+                    'BLOCK_SIZE_%d_%d' % (x, y), 'TIFF'))
+                # Blocks of an IFD must be written in row-major order
+                if ifd_data_offsets and offset <= ifd_data_offsets[-1]:
+                    gdaltest.post_reason('blocks not in row-major order')
+                    print(x, y, offset, ifd_data_offsets[-1])
+                    return False
+                ifd_data_offsets.append(offset)
+                leader = struct.unpack('<I', data[offset - 4:offset])[0]
+                if leader != size:
+                    gdaltest.post_reason('wrong leader')
+                    print(x, y, leader, size)
+                    return False
+                if data[offset + size - 4:offset + size] != \
+                        data[offset + size:offset + size + 4]:
+                    gdaltest.post_reason('wrong trailer')
+                    print(x, y)
+                    return False
+        data_offsets += ifd_data_offsets
+        first_data_offsets.append(ifd_data_offsets[0])
+    ds = None
+
+    if max(ifd_offsets) > min(data_offsets):
+        gdaltest.post_reason('IFDs not before imagery')
+        print(ifd_offsets, min(data_offsets))
+        return False
+
+    # Smallest overview first
+    if first_data_offsets[smallest_ovr_idx] > first_data_offsets[0]:
+        gdaltest.post_reason('overviews not before full resolution')
+        return False
+
+    return True
+
+###############################################################################
+# Basic test: no overview needed
+
+
+def cog_1():
+
+    if gdal.GetDriverByName('COG') is None:
+        return 'skip'
+
+    src_ds = gdal.Open('data/byte.tif')
+    filename = '/vsimem/cog_1.tif'
+    ds = gdal.GetDriverByName('COG').CreateCopy(filename, src_ds)
+    if ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetRasterBand(1).Checksum() != 4672:
+        gdaltest.post_reason('fail')
+        print(ds.GetRasterBand(1).Checksum())
+        return 'fail'
+    if ds.GetRasterBand(1).GetOverviewCount() != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetRasterBand(1).GetBlockSize() != [512, 512]:
+        gdaltest.post_reason('fail')
+        print(ds.GetRasterBand(1).GetBlockSize())
+        return 'fail'
+    if ds.GetMetadataItem('COMPRESSION', 'IMAGE_STRUCTURE') != 'LZW':
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    if not _check_cog_layout(filename):
+        return 'fail'
+
+    gdal.GetDriverByName('GTiff').Delete(filename)
+
+    return 'success'
+
+###############################################################################
+# Overviews generated in the same pass, with multithreaded compression
+
+
+def cog_2():
+
+    if gdal.GetDriverByName('COG') is None:
+        return 'skip'
+
+    src_ds = gdal.Translate('', 'data/byte.tif', format='MEM',
+                            width=1024, height=1024)
+    filename = '/vsimem/cog_2.tif'
+    ds = gdal.GetDriverByName('COG').CreateCopy(
+        filename, src_ds,
+        options=['COMPRESS=DEFLATE', 'NUM_THREADS=2', 'RESAMPLING=AVERAGE'])
+    if ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetRasterBand(1).Checksum() != \
+            src_ds.GetRasterBand(1).Checksum():
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetRasterBand(1).GetOverviewCount() != 1 or \
+            ds.GetRasterBand(1).GetOverview(0).XSize != 512:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # Same overview as the one computed by gdaladdo
+    src_ds.BuildOverviews('AVERAGE', [2])
+    if ds.GetRasterBand(1).GetOverview(0).Checksum() != \
+            src_ds.GetRasterBand(1).GetOverview(0).Checksum():
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    if not _check_cog_layout(filename):
+        return 'fail'
+
+    if gdal.VSIStatL(filename + '.ovr.tmp') is not None:
+        gdaltest.post_reason('temporary file not removed')
+        return 'fail'
+
+    gdal.GetDriverByName('GTiff').Delete(filename)
+
+    return 'success'
+
+###############################################################################
+# Test OVERVIEWS=NONE and invalid BLOCKSIZE
+
+
+def cog_3():
+
+    if gdal.GetDriverByName('COG') is None:
+        return 'skip'
+
+    src_ds = gdal.Translate('', 'data/byte.tif', format='MEM',
+                            width=1024, height=1024)
+    filename = '/vsimem/cog_3.tif'
+    ds = gdal.GetDriverByName('COG').CreateCopy(
+        filename, src_ds, options=['OVERVIEWS=NONE'])
+    if ds.GetRasterBand(1).GetOverviewCount() != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    with gdaltest.error_handler():
+        ds = gdal.GetDriverByName('COG').CreateCopy(
+            filename, src_ds, options=['BLOCKSIZE=100'])
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    gdal.GetDriverByName('GTiff').Delete(filename)
+
+    return 'success'
+
+###############################################################################
+# Test multi-threaded compression of many small tiles: blocks must still be
+# written in row-major order in each IFD
+
+
+def cog_4():
+
+    if gdal.GetDriverByName('COG') is None:
+        return 'skip'
+
+    src_ds = gdal.Translate('', 'data/byte.tif', format='MEM',
+                            width=1000, height=700)
+    src_ds.CreateMaskBand(gdal.GMF_PER_DATASET)
+    src_ds.GetRasterBand(1).GetMaskBand().Fill(255)
+    filename = '/vsimem/cog_4.tif'
+    ds = gdal.GetDriverByName('COG').CreateCopy(
+        filename, src_ds,
+        options=['BLOCKSIZE=64', 'COMPRESS=DEFLATE', 'NUM_THREADS=8'])
+    if ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetRasterBand(1).GetBlockSize() != [64, 64]:
+        gdaltest.post_reason('fail')
+        print(ds.GetRasterBand(1).GetBlockSize())
+        return 'fail'
+    if ds.GetRasterBand(1).Checksum() != src_ds.GetRasterBand(1).Checksum():
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+    src_ds = None
+
+    if not _check_cog_layout(filename):
+        return 'fail'
+
+    gdal.GetDriverByName('GTiff').Delete(filename)
+
+    return 'success'
+
+
+gdaltest_list = [
+    cog_1,
+    cog_2,
+    cog_3,
+    cog_4
+]
+
+if __name__ == '__main__':
+
+    gdaltest.setup_run('cog')
+
+    gdaltest.run_tests(gdaltest_list)
+
+    gdaltest.summarize()
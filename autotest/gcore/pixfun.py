@@ -487,6 +487,51 @@ def pixfun_diff_c():
     return 'success'
 
 
+###############################################################################
+# Verify the sum and the difference of Byte sources, that are computed with
+# integer arithmetic, are clamped to the range of the output data type.
+
+def pixfun_sum_diff_byte():
+
+    if not numpy_available:
+        return 'skip'
+
+    refds = gdal.Open('data/byte.tif')
+    refdata1 = refds.GetRasterBand(1).ReadAsArray().astype(numpy.int32)
+    refds = None
+    refdata2 = numpy.clip(2 * refdata1, 0, 255)
+
+    for (func, dt, expected) in [
+            ('sum', 'Byte', numpy.clip(refdata1 + refdata2, 0, 255)),
+            ('sum', 'Int16', refdata1 + refdata2),
+            ('diff', 'Byte', numpy.clip(refdata1 - refdata2, 0, 255)),
+            ('diff', 'Float32', refdata1 - refdata2)]:
+        vrt_xml = """<VRTDataset rasterXSize="20" rasterYSize="20">
+  <VRTRasterBand dataType="%s" band="1" subClass="VRTDerivedRasterBand">
+    <PixelFunctionType>%s</PixelFunctionType>
+    <SourceTransferType>Byte</SourceTransferType>
+    <SimpleSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+    <ComplexSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <ScaleRatio>2</ScaleRatio>
+    </ComplexSource>
+  </VRTRasterBand>
+</VRTDataset>""" % (dt, func)
+        ds = gdal.Open(vrt_xml)
+        data = ds.GetRasterBand(1).ReadAsArray()
+        ds = None
+        if not numpy.alltrue(data == expected):
+            gdaltest.post_reason('fail')
+            print(func, dt)
+            return 'fail'
+
+    return 'success'
+
+
 ###############################################################################
 # Verify the product of 3 (real) datasets.
 
@@ -942,6 +987,7 @@ gdaltest_list = [
     pixfun_sum_c,
     pixfun_diff_r,
     pixfun_diff_c,
+    pixfun_sum_diff_byte,
     pixfun_mul_r,
     pixfun_mul_c,
     pixfun_cmul_c,
@@ -7881,6 +7881,177 @@ def tiff_write_172_geometadata_tiff_rsid():
     gdal.Unlink(tmpfilename)
     return 'success'
 
+###############################################################################
+# Test LERC compression
+
+def tiff_write_173_lerc():
+
+    md = gdaltest.tiff_drv.GetMetadata()
+    if md['DMD_CREATIONOPTIONLIST'].find('LERC') == -1:
+        return 'skip'
+
+    for compress in [ 'LERC', 'LERC_DEFLATE' ]:
+        for src in [ 'byte.tif', 'int16.tif', 'float32.tif' ]:
+            ut = gdaltest.GDALTest( 'GTiff', src, 1, 4672,
+                                    options = [ 'COMPRESS=' + compress ] )
+            ret = ut.testCreateCopy()
+            if ret != 'success':
+                print(compress, src)
+                return ret
+
+    tmpfilename = '/vsimem/tiff_write_173_lerc.tif'
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    gdaltest.tiff_drv.CreateCopy(tmpfilename, src_ds,
+                                 options = [ 'COMPRESS=LERC_DEFLATE' ])
+    ds = gdal.Open(tmpfilename)
+    if ds.GetMetadataItem('COMPRESSION', 'IMAGE_STRUCTURE') != 'LERC_DEFLATE':
+        gdaltest.post_reason('fail')
+        print(ds.GetMetadata('IMAGE_STRUCTURE'))
+        return 'fail'
+    # Each band is encoded separately
+    if ds.GetMetadataItem('INTERLEAVE', 'IMAGE_STRUCTURE') != 'BAND':
+        gdaltest.post_reason('fail')
+        print(ds.GetMetadata('IMAGE_STRUCTURE'))
+        return 'fail'
+    cs = [ ds.GetRasterBand(i+1).Checksum() for i in range(3) ]
+    expected_cs = [ src_ds.GetRasterBand(i+1).Checksum() for i in range(3) ]
+    ds = None
+    gdal.Unlink(tmpfilename)
+    if cs != expected_cs:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    with gdaltest.error_handler():
+        ds = gdaltest.tiff_drv.CreateCopy(tmpfilename, src_ds,
+                    options = [ 'COMPRESS=LERC', 'INTERLEAVE=PIXEL' ])
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    gdal.Unlink(tmpfilename)
+
+    return 'success'
+
+###############################################################################
+# Test lossy LERC compression, with multi-threaded compression
+
+def tiff_write_174_lerc_max_z_error():
+
+    md = gdaltest.tiff_drv.GetMetadata()
+    if md['DMD_CREATIONOPTIONLIST'].find('LERC') == -1:
+        return 'skip'
+
+    import struct
+
+    src_ds = gdal.Translate('', 'data/float32.tif', format = 'MEM',
+                            width = 1000, height = 1000,
+                            resampleAlg = gdal.GRIORA_Bilinear)
+    src_data = struct.unpack('f' * 1000 * 1000,
+                             src_ds.GetRasterBand(1).ReadRaster())
+
+    tmpfilename = '/vsimem/tiff_write_174_lerc_max_z_error.tif'
+    for max_z_error in [ 0, 0.5 ]:
+        gdaltest.tiff_drv.CreateCopy(tmpfilename, src_ds,
+            options = [ 'COMPRESS=LERC', 'TILED=YES', 'NUM_THREADS=4',
+                        'MAX_Z_ERROR=%g' % max_z_error ])
+        ds = gdal.Open(tmpfilename)
+        data = struct.unpack('f' * 1000 * 1000,
+                             ds.GetRasterBand(1).ReadRaster())
+        ds = None
+        max_diff = max([ abs(data[i] - src_data[i])
+                         for i in range(len(data)) ])
+        if max_diff > max_z_error:
+            gdaltest.post_reason('fail')
+            print(max_z_error, max_diff)
+            return 'fail'
+    gdal.Unlink(tmpfilename)
+
+    return 'success'
+
+###############################################################################
+# Test WEBP compression
+
+def tiff_write_175_webp():
+
+    md = gdaltest.tiff_drv.GetMetadata()
+    if md['DMD_CREATIONOPTIONLIST'].find('WEBP') == -1:
+        return 'skip'
+
+    ut = gdaltest.GDALTest( 'GTiff', 'rgbsmall.tif', 1, 21212,
+                            options = [ 'COMPRESS=WEBP', 'WEBP_LOSSLESS=YES' ] )
+    ret = ut.testCreateCopy()
+    if ret != 'success':
+        return ret
+
+    tmpfilename = '/vsimem/tiff_write_175_webp.tif'
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    gdaltest.tiff_drv.CreateCopy(tmpfilename, src_ds,
+                                 options = [ 'COMPRESS=WEBP', 'WEBP_LEVEL=50',
+                                             'NUM_THREADS=2' ])
+    ds = gdal.Open(tmpfilename)
+    if ds.GetMetadataItem('COMPRESSION', 'IMAGE_STRUCTURE') != 'WEBP':
+        gdaltest.post_reason('fail')
+        print(ds.GetMetadata('IMAGE_STRUCTURE'))
+        return 'fail'
+    ds = None
+    gdal.Unlink(tmpfilename)
+
+    with gdaltest.error_handler():
+        ds = gdaltest.tiff_drv.CreateCopy(tmpfilename, gdal.Open('data/byte.tif'),
+                                          options = [ 'COMPRESS=WEBP' ])
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    gdal.Unlink(tmpfilename)
+
+    return 'success'
+
+###############################################################################
+# Test that implicit JPEG-in-TIFF overviews of pixel-interleaved files return
+# the same content whatever the order in which bands are read, including for
+# partial right/bottom tiles.
+
+def tiff_write_176_jpeg_implicit_ovr_pixel_interleaved():
+
+    md = gdaltest.tiff_drv.GetMetadata()
+    if md['DMD_CREATIONOPTIONLIST'].find('JPEG') == -1:
+        return 'skip'
+
+    tmpfilename = '/vsimem/tiff_write_176.tif'
+    src_ds = gdal.Translate('', '../gdrivers/data/small_world_400pct.vrt',
+                            format='MEM', width=1000, height=744)
+    for options in [['COMPRESS=JPEG', 'TILED=YES'],
+                    ['COMPRESS=JPEG', 'PHOTOMETRIC=YCBCR', 'TILED=YES'],
+                    ['COMPRESS=JPEG', 'BLOCKYSIZE=48']]:
+        gdaltest.tiff_drv.CreateCopy(tmpfilename, src_ds, options=options)
+
+        for ovr_idx in range(3):
+            ds = gdal.Open(tmpfilename)
+            ovr_ds = ds.GetRasterBand(1).GetOverview(ovr_idx).GetDataset()
+            ref = [ovr_ds.GetRasterBand(i + 1).ReadRaster() for i in range(3)]
+            ds = None
+
+            ds = gdal.Open(tmpfilename)
+            ovr_ds = ds.GetRasterBand(1).GetOverview(ovr_idx).GetDataset()
+            for i in [3, 2, 1]:
+                if ovr_ds.GetRasterBand(i).ReadRaster() != ref[i - 1]:
+                    gdaltest.post_reason('fail')
+                    print(options, ovr_idx, i)
+                    return 'fail'
+            if ovr_ds.ReadRaster(band_list=[1, 2, 3],
+                                 buf_pixel_space=1,
+                                 buf_line_space=ovr_ds.RasterXSize,
+                                 buf_band_space=ovr_ds.RasterXSize *
+                                 ovr_ds.RasterYSize) != b''.join(ref):
+                gdaltest.post_reason('fail')
+                print(options, ovr_idx)
+                return 'fail'
+            ds = None
+
+        gdaltest.tiff_drv.Delete(tmpfilename)
+
+    return 'success'
+
 ###############################################################################
 # Ask to run again tests with GDAL_API_PROXY=YES
 
@@ -8083,6 +8254,10 @@ gdaltest_list = [
     tiff_write_170_invalid_compresion,
     tiff_write_171_zstd,
     tiff_write_172_geometadata_tiff_rsid,
+    tiff_write_173_lerc,
+    tiff_write_174_lerc_max_z_error,
+    tiff_write_175_webp,
+    tiff_write_176_jpeg_implicit_ovr_pixel_interleaved,
     #tiff_write_api_proxy,
     tiff_write_cleanup ]
 
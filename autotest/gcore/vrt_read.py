@@ -1313,6 +1313,149 @@ def vrt_read_30():
 
     return 'success'
 
+###############################################################################
+# Test a mosaic with enough sources to use the spatial index of sources
+
+def _vrt_read_mosaic_xml(filenames = ['data/byte.tif']):
+
+    xml = '<VRTDataset rasterXSize="220" rasterYSize="200">\n'
+    xml += '  <VRTRasterBand dataType="Byte" band="1">\n'
+    for j in range(10):
+        for i in range(10):
+            xml += """    <SimpleSource>
+      <SourceFilename relativeToVRT="0">%s</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="%d" yOff="%d" xSize="20" ySize="20" />
+    </SimpleSource>
+""" % (filenames[(i + j * 10) % len(filenames)], i * 20, j * 20)
+    # Overlapping source, that must be painted last
+    xml += """    <SimpleSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="110" yOff="110" xSize="20" ySize="20" />
+    </SimpleSource>
+"""
+    xml += '  </VRTRasterBand>\n</VRTDataset>'
+    return xml
+
+
+def vrt_read_31():
+
+    xml = _vrt_read_mosaic_xml()
+    ds = gdal.Open(xml)
+
+    ref_ds = gdal.Open('data/byte.tif')
+    ref_data = ref_ds.ReadRaster()
+
+    for (x, y) in [(0, 0), (40, 60), (180, 180), (110, 110)]:
+        if ds.ReadRaster(x, y, 20, 20) != ref_data:
+            gdaltest.post_reason('fail')
+            print(x, y)
+            return 'fail'
+        if ds.GetRasterBand(1).ReadRaster(x, y, 20, 20) != ref_data:
+            gdaltest.post_reason('fail')
+            print(x, y)
+            return 'fail'
+
+    # Outside of any source
+    data = ds.GetRasterBand(1).ReadRaster(200, 0, 20, 20)
+    if data != b'\0' * 400:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    (flags, pct) = ds.GetRasterBand(1).GetDataCoverageStatus(200, 0, 20, 20)
+    if (flags & gdal.GDAL_DATA_COVERAGE_STATUS_UNIMPLEMENTED) == 0 and \
+       flags != gdal.GDAL_DATA_COVERAGE_STATUS_EMPTY:
+        gdaltest.post_reason('fail')
+        print(flags, pct)
+        return 'fail'
+
+    (flags, pct) = ds.GetRasterBand(1).GetDataCoverageStatus(0, 0, 200, 200)
+    if (flags & gdal.GDAL_DATA_COVERAGE_STATUS_UNIMPLEMENTED) == 0 and \
+       (flags != gdal.GDAL_DATA_COVERAGE_STATUS_DATA or pct != 100.0):
+        gdaltest.post_reason('fail')
+        print(flags, pct)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test reading sources concurrently with NUM_THREADS
+
+def vrt_read_32():
+
+    # Sources reading the same file are never read concurrently, so use
+    # several copies
+    filenames = []
+    for i in range(8):
+        filename = '/vsimem/vrt_read_32_%d.tif' % i
+        gdal.Translate(filename, 'data/byte.tif')
+        filenames.append(filename)
+
+    xml = _vrt_read_mosaic_xml(filenames)
+    ref_ds = gdal.Open(xml)
+    ds = gdal.OpenEx(xml, open_options = ['NUM_THREADS=4'])
+
+    for (x, y, xsize, ysize, bufxsize, bufysize) in [
+            (0, 0, 220, 200, 220, 200),
+            (5, 7, 150, 130, 150, 130),
+            (0, 0, 220, 200, 73, 61)]:
+        ref_data = ref_ds.GetRasterBand(1).ReadRaster(x, y, xsize, ysize,
+                                                      bufxsize, bufysize)
+        data = ds.GetRasterBand(1).ReadRaster(x, y, xsize, ysize,
+                                              bufxsize, bufysize)
+        if data != ref_data:
+            gdaltest.post_reason('fail')
+            print(x, y, xsize, ysize, bufxsize, bufysize)
+            return 'fail'
+        data = ds.ReadRaster(x, y, xsize, ysize, bufxsize, bufysize)
+        if data != ref_data:
+            gdaltest.post_reason('fail')
+            print(x, y, xsize, ysize, bufxsize, bufysize)
+            return 'fail'
+
+    ds = None
+    ref_ds = None
+    for filename in filenames:
+        gdal.Unlink(filename)
+
+    return 'success'
+
+###############################################################################
+# Test that errors of sources read concurrently are reported
+
+def vrt_read_33():
+
+    filenames = []
+    for i in range(8):
+        filename = '/vsimem/vrt_read_33_%d.tif' % i
+        gdal.Translate(filename, 'data/byte.tif')
+        filenames.append(filename)
+    # Truncate the imagery of one of the sources
+    f = gdal.VSIFOpenL(filenames[-1], 'rb+')
+    gdal.VSIFSeekL(f, 0, 2)
+    gdal.VSIFTruncateL(f, gdal.VSIFTellL(f) - 200)
+    gdal.VSIFCloseL(f)
+
+    xml = _vrt_read_mosaic_xml(filenames)
+    ds = gdal.OpenEx(xml, open_options = ['NUM_THREADS=4'])
+    gdal.ErrorReset()
+    with gdaltest.error_handler():
+        data = ds.GetRasterBand(1).ReadRaster()
+    if data is not None or \
+       gdal.GetLastErrorMsg().find('vrt_read_33_7.tif') < 0:
+        gdaltest.post_reason('fail')
+        print(gdal.GetLastErrorMsg())
+        return 'fail'
+    ds = None
+
+    for filename in filenames:
+        gdal.Unlink(filename)
+
+    return 'success'
+
 for item in init_list:
     ut = gdaltest.GDALTest( 'VRT', item[0], item[1], item[2] )
     if ut is None:
@@ -1350,6 +1493,9 @@ gdaltest_list.append( vrt_read_27 )
 gdaltest_list.append( vrt_read_28 )
 gdaltest_list.append( vrt_read_29 )
 gdaltest_list.append( vrt_read_30 )
+gdaltest_list.append( vrt_read_31 )
+gdaltest_list.append( vrt_read_32 )
+gdaltest_list.append( vrt_read_33 )
 
 if __name__ == '__main__':
 
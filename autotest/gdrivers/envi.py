@@ -350,6 +350,49 @@ def envi_15():
 
     return 'success'
 
+###############################################################################
+# Test that multi-band reads of pixel and line interleaved files, done with
+# a single read per group of scanlines, match the per-band reads.
+# Scanlines are 8000 bytes, so the 4 MB chunks of the interleaved reads are
+# 524 lines high and the read-ahead thread is used.
+
+def envi_16():
+
+    for interleave in ['BIP', 'BIL']:
+        filename = '/vsimem/envi_16_%s.dat' % interleave
+        gdal.Translate(filename, '../gcore/data/rgbsmall.tif', format='ENVI',
+                       outputType=gdal.GDT_Int16, width=1000, height=1200,
+                       bandList=[1, 2, 3, 1],
+                       creationOptions=['INTERLEAVE=' + interleave])
+
+        for (xoff, yoff, xsize, ysize, band_list, buf_pixel_space,
+             buf_band_space) in [(3, 5, 990, 1190, None, None, None),
+                                 (3, 5, 990, 1190, None, 8, 2),
+                                 (0, 5, 1000, 1190, None, 8, 2),
+                                 (0, 5, 1000, 1190, [3, 1], None, None),
+                                 (0, 0, 1000, 1200, [3, 1], 4, 2)]:
+            res = []
+            for (one_big_read, read_ahead) in [('NO', 'NO'), (None, 'NO'),
+                                               ('YES', 'YES')]:
+                gdal.SetConfigOption('GDAL_ONE_BIG_READ', one_big_read)
+                gdal.SetConfigOption('GDAL_RAW_READ_AHEAD', read_ahead)
+                ds = gdal.Open(filename)
+                res.append(ds.ReadRaster(xoff, yoff, xsize, ysize,
+                                         band_list=band_list,
+                                         buf_pixel_space=buf_pixel_space,
+                                         buf_band_space=buf_band_space))
+                ds = None
+                gdal.SetConfigOption('GDAL_ONE_BIG_READ', None)
+                gdal.SetConfigOption('GDAL_RAW_READ_AHEAD', None)
+            if res[0] != res[1] or res[0] != res[2]:
+                gdaltest.post_reason('fail')
+                print(interleave, xoff, band_list, buf_pixel_space)
+                return 'fail'
+
+        gdal.GetDriverByName('ENVI').Delete(filename)
+
+    return 'success'
+
 gdaltest_list = [
     envi_1,
     envi_2,
@@ -366,6 +409,7 @@ gdaltest_list = [
     envi_13,
     envi_14,
     envi_15,
+    envi_16,
     ]
 
 
@@ -347,6 +347,43 @@ def png_14():
 
     return 'success'
 
+###############################################################################
+# Test reading rows backwards (random access mode with checkpoints)
+
+def png_15():
+
+    src_ds = gdal.Open('../gcore/data/oddsize1bit.tif')
+    gdal.GetDriverByName('PNG').CreateCopy('/vsimem/png_15.png', src_ds)
+    src_ds = None
+
+    for filename in ['../gcore/data/stefan_full_rgba.png',
+                     'data/rgba16.png',
+                     'data/tbbn2c16.png',
+                     '/vsimem/png_15.png']:
+        ds = gdal.Open(filename)
+        ref = [ds.ReadRaster(0, y, ds.RasterXSize, 1)
+               for y in range(ds.RasterYSize)]
+        ds = None
+
+        for interval in ['3', None]:
+            ds = gdal.Open(filename)
+            gdal.SetConfigOption('GDAL_PNG_CHECKPOINT_INTERVAL', interval)
+            for y in list(range(ds.RasterYSize - 1, -1, -1)) + [5, 1, 7]:
+                # Make sure the row is not served by the block cache
+                ds.FlushCache()
+                data = ds.ReadRaster(0, y, ds.RasterXSize, 1)
+                if data != ref[y]:
+                    gdal.SetConfigOption('GDAL_PNG_CHECKPOINT_INTERVAL', None)
+                    gdaltest.post_reason('failure')
+                    print(filename, interval, y)
+                    return 'fail'
+            gdal.SetConfigOption('GDAL_PNG_CHECKPOINT_INTERVAL', None)
+            ds = None
+
+    gdal.Unlink('/vsimem/png_15.png')
+
+    return 'success'
+
 gdaltest_list = [
     png_1,
     png_2,
@@ -361,7 +398,8 @@ gdaltest_list = [
     png_11,
     png_12,
     png_13,
-    png_14
+    png_14,
+    png_15
     ]
 
 if __name__ == '__main__':
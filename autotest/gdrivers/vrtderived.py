@@ -947,6 +947,103 @@ def vrtderived_15():
     return ret
 
 
+###############################################################################
+# Test the Expression pixel function language
+
+def vrtderived_16():
+
+    template = """<VRTDataset rasterXSize="20" rasterYSize="20">
+  <VRTRasterBand dataType="%s" band="1" subClass="VRTDerivedRasterBand">
+    %s
+    <PixelFunctionLanguage>Expression</PixelFunctionLanguage>
+    <PixelFunctionCode><![CDATA[%s]]></PixelFunctionCode>
+    <SimpleSource>
+      <SourceFilename>data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+    <SimpleSource>
+      <SourceFilename>data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>"""
+
+    # Same checksum as the source
+    ds = gdal.Open(template % ('Byte', '', '0.5 * (B1 + B2)'))
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    # Conditionals and functions
+    ds = gdal.Open(template % ('Byte', '', 'B1 > 150 ? 255 : 0'))
+    (my_min, my_max) = ds.GetRasterBand(1).ComputeRasterMinMax()
+    if (my_min, my_max) != (0, 255):
+        gdaltest.post_reason('fail')
+        print(my_min, my_max)
+        return 'fail'
+
+    ds = gdal.Open(template % ('Float32', '',
+                               'max(B1, 130, 0) - min(2, -3^2, 5)'))
+    (my_min, my_max) = ds.GetRasterBand(1).ComputeRasterMinMax()
+    if (my_min, my_max) != (139, 264):
+        gdaltest.post_reason('fail')
+        print(my_min, my_max)
+        return 'fail'
+
+    # NaN results are written as nodata
+    ds = gdal.Open(template % ('Byte', '<NoDataValue>7</NoDataValue>',
+                               'B1 < 120 ? NODATA : B1'))
+    (my_min, my_max) = ds.GetRasterBand(1).ComputeRasterMinMax()
+    if (my_min, my_max) != (123, 255):
+        gdaltest.post_reason('fail')
+        print(my_min, my_max)
+        return 'fail'
+    ds = gdal.Open(template % ('Byte', '<NoDataValue>7</NoDataValue>',
+                               'B1 < 120 ? 0 / 0 : B1'))
+    (my_min, my_max) = ds.GetRasterBand(1).ComputeRasterMinMax()
+    if (my_min, my_max) != (123, 255):
+        gdaltest.post_reason('fail')
+        print(my_min, my_max)
+        return 'fail'
+
+    # Deep nesting is accepted up to a limit
+    ds = gdal.Open(template % ('Byte', '', '(' * 500 + 'B1' + ')' * 500))
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    # Invalid expressions
+    for expr in ['B3', 'B1 +', 'foo(B1)', 'min(B1)', '(B1', 'B1 ? 1',
+                 '(' * 100000 + 'B1' + ')' * 100000,
+                 '-' * 100000 + 'B1',
+                 'B1' + '^1' * 100000,
+                 'B1' + ' ? 0 : B1' * 100000]:
+        with gdaltest.error_handler():
+            ds = gdal.Open(template % ('Byte', '', expr))
+        if ds is not None:
+            gdaltest.post_reason('fail')
+            print(expr[0:100])
+            return 'fail'
+
+    # Serialization
+    ds = gdal.GetDriverByName('VRT').CreateCopy('/vsimem/vrtderived_16.vrt',
+                        gdal.Open(template % ('Byte', '', '0.5 * (B1 + B2)')))
+    ds = None
+    ds = gdal.Open('/vsimem/vrtderived_16.vrt')
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    gdal.Unlink('/vsimem/vrtderived_16.vrt')
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup.
 
@@ -973,6 +1070,7 @@ gdaltest_list = [
     vrtderived_13,
     vrtderived_14,
     vrtderived_15,
+    vrtderived_16,
     vrtderived_cleanup,
 ]
 
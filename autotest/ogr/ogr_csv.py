@@ -2507,6 +2507,113 @@ def ogr_csv_49():
 
     return 'success'
 
+###############################################################################
+# Test NUM_THREADS, with values spanning several lines and several blocks
+
+def ogr_csv_50():
+
+    content = 'id,str,val\n'
+    for i in range(50000):
+        if (i % 7) == 0:
+            content += '%d,"multi\nline, ""quoted"" %d",%d\r\n' % (i, i, i * 2)
+        elif (i % 11) == 0:
+            content += '\n'
+        else:
+            content += '%d,plain %d,%d.5\n' % (i, i, i)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_50.csv', content)
+
+    ds_ref = gdal.OpenEx('/vsimem/ogr_csv_50.csv')
+    lyr_ref = ds_ref.GetLayer(0)
+    for num_threads in ['2', '4', 'ALL_CPUS']:
+        ds = gdal.OpenEx('/vsimem/ogr_csv_50.csv',
+                         open_options=['NUM_THREADS=' + num_threads])
+        lyr = ds.GetLayer(0)
+        lyr_ref.ResetReading()
+        count = 0
+        while True:
+            f_ref = lyr_ref.GetNextFeature()
+            f = lyr.GetNextFeature()
+            if f_ref is None:
+                if f is not None:
+                    gdaltest.post_reason('fail')
+                    f.DumpReadable()
+                    return 'fail'
+                break
+            if f is None or f.GetFID() != f_ref.GetFID() or \
+               f.GetField('id') != f_ref.GetField('id') or \
+               f.GetField('str') != f_ref.GetField('str') or \
+               f.GetField('val') != f_ref.GetField('val'):
+                gdaltest.post_reason('fail')
+                print(num_threads)
+                f_ref.DumpReadable()
+                if f is not None:
+                    f.DumpReadable()
+                return 'fail'
+            count += 1
+        if count != lyr.GetFeatureCount():
+            gdaltest.post_reason('fail')
+            print(count)
+            return 'fail'
+
+        # Random access after sequential reading
+        f = lyr.GetFeature(14)
+        if f is None or f.GetField('str') != 'multi\nline, "quoted" 14':
+            gdaltest.post_reason('fail')
+            if f is not None:
+                f.DumpReadable()
+            return 'fail'
+        ds = None
+
+    ds_ref = None
+    gdal.Unlink('/vsimem/ogr_csv_50.csv')
+
+    return 'success'
+
+###############################################################################
+# Test that with NUM_THREADS, the warnings of the worker threads reach the
+# error handler of the caller, and are only emitted once
+
+class ogr_csv_51_handler_class:
+    def __init__(self):
+        self.msgs = []
+
+    def handler(self, eErrClass, err_no, msg):
+        if eErrClass != gdal.CE_Debug:
+            self.msgs.append(msg)
+
+def ogr_csv_51():
+
+    content = 'id,val\n'
+    for i in range(200000):
+        if i > 120000 and (i % 7) == 3:
+            content += '%d,abc\n' % i
+        else:
+            content += '%d,%d\n' % (i, i)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_51.csv', content)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_51.csvt', 'Integer,Integer')
+
+    for num_threads in ['1', '4']:
+        handler = ogr_csv_51_handler_class()
+        gdal.PushErrorHandler(handler.handler)
+        ds = gdal.OpenEx('/vsimem/ogr_csv_51.csv',
+                         open_options=['NUM_THREADS=' + num_threads])
+        lyr = ds.GetLayer(0)
+        for f in lyr:
+            pass
+        ds = None
+        gdal.PopErrorHandler()
+        if len(handler.msgs) != 1 or \
+           handler.msgs[0].find('record 120005 for field val') < 0:
+            gdaltest.post_reason('fail')
+            print(num_threads)
+            print(handler.msgs)
+            return 'fail'
+
+    gdal.Unlink('/vsimem/ogr_csv_51.csv')
+    gdal.Unlink('/vsimem/ogr_csv_51.csvt')
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -2591,6 +2698,8 @@ gdaltest_list = [
     ogr_csv_47,
     ogr_csv_48,
     ogr_csv_49,
+    ogr_csv_50,
+    ogr_csv_51,
     ogr_csv_cleanup ]
 
 if __name__ == '__main__':
@@ -0,0 +1,279 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+# $Id$
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  FlatGeobuf driver test suite.
+#
+###############################################################################
+# Copyright (c) 2018, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import sys
+
+sys.path.append( '../pymod' )
+
+from osgeo import ogr
+from osgeo import gdal
+
+import gdaltest
+import ogrtest
+
+###############################################################################
+# Translate poly.shp and compare with the source
+
+
+def _ogr_flatgeobuf_roundtrip_poly(lco):
+
+    filename = '/vsimem/ogr_flatgeobuf_poly.fgb'
+    src_ds = ogr.Open('data/poly.shp')
+    ds = gdal.VectorTranslate(filename, src_ds, format = 'FlatGeobuf',
+                              layerCreationOptions = lco)
+    ds = None
+
+    ds = ogr.Open(filename)
+    if ds is None or ds.GetDriver().GetName() != 'FlatGeobuf':
+        gdaltest.post_reason('fail')
+        return 'fail'
+    lyr = ds.GetLayer(0)
+    src_lyr = src_ds.GetLayer(0)
+    if lyr.GetFeatureCount() != src_lyr.GetFeatureCount():
+        gdaltest.post_reason('fail')
+        print(lyr.GetFeatureCount())
+        return 'fail'
+    if lyr.GetGeomType() != ogr.wkbPolygon:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.GetSpatialRef() is None or \
+       not lyr.GetSpatialRef().IsSame(src_lyr.GetSpatialRef()):
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.GetExtent() != src_lyr.GetExtent():
+        gdaltest.post_reason('fail')
+        print(lyr.GetExtent())
+        return 'fail'
+
+    # Features might have been reordered by the index
+    src_features = {}
+    for src_f in src_lyr:
+        src_features[src_f['EAS_ID']] = src_f
+    for f in lyr:
+        src_f = src_features[f['EAS_ID']]
+        if f['AREA'] != src_f['AREA'] or f['PRFEDEA'] != src_f['PRFEDEA']:
+            gdaltest.post_reason('fail')
+            f.DumpReadable()
+            return 'fail'
+        if ogrtest.check_feature_geometry(f, src_f.GetGeometryRef()) != 0:
+            gdaltest.post_reason('fail')
+            f.DumpReadable()
+            return 'fail'
+    ds = None
+
+    gdal.Unlink(filename)
+
+    return 'success'
+
+
+def ogr_flatgeobuf_1():
+    return _ogr_flatgeobuf_roundtrip_poly([])
+
+
+def ogr_flatgeobuf_2():
+    return _ogr_flatgeobuf_roundtrip_poly(['SPATIAL_INDEX=NO'])
+
+###############################################################################
+# Check that spatial filtering through the index gives the same result as a
+# brute force evaluation, and test GetFeature()
+
+
+def ogr_flatgeobuf_3():
+
+    filename = '/vsimem/ogr_flatgeobuf_3.fgb'
+    ds = ogr.GetDriverByName('FlatGeobuf').CreateDataSource(filename)
+    lyr = ds.CreateLayer('test', geom_type = ogr.wkbPoint,
+                         options = ['INDEX_NODE_SIZE=4'])
+    lyr.CreateField(ogr.FieldDefn('id', ogr.OFTInteger))
+    for i in range(1000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['id'] = i
+        f.SetGeometry(ogr.CreateGeometryFromWkt(
+            'POINT(%d %d)' % (i % 37, (i * 7) % 41)))
+        lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 1000:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    all_ids = {}
+    for f in lyr:
+        all_ids[f.GetFID()] = f['id']
+
+    for (minx, miny, maxx, maxy) in [(0, 0, 5, 5), (10.5, 3, 20, 30),
+                                     (36, 40, 100, 100), (-10, -10, -1, -1)]:
+        expected = set()
+        for i in range(1000):
+            x = i % 37
+            y = (i * 7) % 41
+            if x >= minx and x <= maxx and y >= miny and y <= maxy:
+                expected.add(i)
+        lyr.SetSpatialFilterRect(minx, miny, maxx, maxy)
+        got = set([f['id'] for f in lyr])
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(minx, miny, maxx, maxy, len(got), len(expected))
+            return 'fail'
+    lyr.SetSpatialFilter(None)
+
+    for fid in (0, 1, 500, 999):
+        f = lyr.GetFeature(fid)
+        if f is None or f.GetFID() != fid or f['id'] != all_ids[fid]:
+            gdaltest.post_reason('fail')
+            return 'fail'
+    with gdaltest.error_handler():
+        if lyr.GetFeature(1000) is not None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+    ds = None
+
+    gdal.Unlink(filename)
+
+    return 'success'
+
+###############################################################################
+# Test field types and geometry types
+
+
+def ogr_flatgeobuf_4():
+
+    filename = '/vsimem/ogr_flatgeobuf_4.fgb'
+    ds = ogr.GetDriverByName('FlatGeobuf').CreateDataSource(filename)
+    lyr = ds.CreateLayer('test', geom_type = ogr.wkbUnknown)
+    fld = ogr.FieldDefn('bool', ogr.OFTInteger)
+    fld.SetSubType(ogr.OFSTBoolean)
+    lyr.CreateField(fld)
+    fld = ogr.FieldDefn('int16', ogr.OFTInteger)
+    fld.SetSubType(ogr.OFSTInt16)
+    lyr.CreateField(fld)
+    lyr.CreateField(ogr.FieldDefn('int', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('int64', ogr.OFTInteger64))
+    fld = ogr.FieldDefn('float32', ogr.OFTReal)
+    fld.SetSubType(ogr.OFSTFloat32)
+    lyr.CreateField(fld)
+    lyr.CreateField(ogr.FieldDefn('real', ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn('str', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('dt', ogr.OFTDateTime))
+    lyr.CreateField(ogr.FieldDefn('bin', ogr.OFTBinary))
+
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f['bool'] = 1
+    f['int16'] = -123
+    f['int'] = 123456789
+    f['int64'] = 1234567890123
+    f['float32'] = 1.5
+    f['real'] = 1.25
+    f['str'] = 'foo"bar'
+    f['dt'] = '2018/05/04 12:34:56.789+02'
+    f.SetFieldBinaryFromHexString('bin', '0001FF')
+    f.SetGeometry(ogr.CreateGeometryFromWkt('POINT (1 2)'))
+    lyr.CreateFeature(f)
+
+    wkts = ['LINESTRING (1 2,5 6)',
+            'MULTIPOLYGON (((0 0,10 0,10 10,0 10,0 0),(1 1,2 1,2 2,1 1)),((20 20,30 20,30 30,20 20)))',
+            'GEOMETRYCOLLECTION (POINT (1 2),LINESTRING (0 0,1 1))',
+            'MULTIPOINT ((1 2),(3 4))']
+    for wkt in wkts:
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+        lyr.CreateFeature(f)
+    f = ogr.Feature(lyr.GetLayerDefn())
+    lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 6:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    got_wkts = []
+    for f in lyr:
+        g = f.GetGeometryRef()
+        if g is None:
+            continue
+        got_wkts.append(g.ExportToIsoWkt())
+        if g.GetGeometryType() == ogr.wkbPoint:
+            if f['bool'] != 1 or f['int16'] != -123 or \
+               f['int'] != 123456789 or f['int64'] != 1234567890123 or \
+               f['float32'] != 1.5 or f['real'] != 1.25 or \
+               f['str'] != 'foo"bar' or \
+               f['dt'] != '2018/05/04 12:34:56.789+02' or \
+               f.GetFieldAsBinary('bin') != b'\x00\x01\xff':
+                gdaltest.post_reason('fail')
+                f.DumpReadable()
+                return 'fail'
+    for wkt in wkts + ['POINT (1 2)']:
+        if wkt not in got_wkts:
+            gdaltest.post_reason('fail')
+            print(wkt, got_wkts)
+            return 'fail'
+    ds = None
+
+    # Measures are preserved
+    ds = ogr.GetDriverByName('FlatGeobuf').CreateDataSource(filename)
+    lyr = ds.CreateLayer('test', geom_type = ogr.wkbLineStringZM)
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f.SetGeometry(ogr.CreateGeometryFromWkt('LINESTRING ZM (1 2 3 4,5 6 7 8)'))
+    lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    if lyr.GetGeomType() != ogr.wkbLineStringZM:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f.GetGeometryRef().ExportToIsoWkt() != 'LINESTRING ZM (1 2 3 4,5 6 7 8)':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    ds = None
+
+    gdal.Unlink(filename)
+
+    return 'success'
+
+gdaltest_list = [
+    ogr_flatgeobuf_1,
+    ogr_flatgeobuf_2,
+    ogr_flatgeobuf_3,
+    ogr_flatgeobuf_4,
+    ]
+
+if __name__ == '__main__':
+
+    gdaltest.setup_run( 'ogr_flatgeobuf' )
+
+    gdaltest.run_tests( gdaltest_list )
+
+    gdaltest.summarize()
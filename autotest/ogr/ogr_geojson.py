@@ -3890,6 +3890,47 @@ def ogr_geojson_68():
         return 'fail'
     return 'success'
 
+###############################################################################
+# Test that files, which go through the streaming readers, give the same
+# result as the in-memory readers used for inline content.
+
+def ogr_geojson_69():
+
+    for filename in ['data/topojson1.topojson', 'data/topojson3.topojson',
+                     'data/esripolygon.json', 'data/esrimultipoint.json',
+                     'data/esrijsonstartingwithfeaturesgeometry.json']:
+        ds_file = ogr.Open(filename)
+        if ds_file is None:
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+        content = open(filename, 'rb').read().decode('UTF-8')
+        ds_text = ogr.Open(content)
+        if ds_text is None or \
+           ds_text.GetLayerCount() != ds_file.GetLayerCount():
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+        for i in range(ds_file.GetLayerCount()):
+            lyr_file = ds_file.GetLayer(i)
+            lyr_text = ds_text.GetLayer(i)
+            if lyr_file.GetGeomType() != lyr_text.GetGeomType() or \
+               lyr_file.GetFeatureCount() != lyr_text.GetFeatureCount() or \
+               lyr_file.GetLayerDefn().GetFieldCount() != \
+                    lyr_text.GetLayerDefn().GetFieldCount():
+                gdaltest.post_reason('fail')
+                print(filename)
+                return 'fail'
+            for f_text in lyr_text:
+                f_file = lyr_file.GetNextFeature()
+                if f_file.Equal(f_text) == 0:
+                    gdaltest.post_reason('fail')
+                    print(filename)
+                    f_file.DumpReadable()
+                    f_text.DumpReadable()
+                    return 'fail'
+
+    return 'success'
 
 gdaltest_list = [
     ogr_geojson_1,
@@ -3960,6 +4001,7 @@ gdaltest_list = [
     ogr_geojson_66,
     ogr_geojson_67,
     ogr_geojson_68,
+    ogr_geojson_69,
     ogr_geojson_cleanup ]
 
 if __name__ == '__main__':
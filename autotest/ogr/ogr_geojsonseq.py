@@ -0,0 +1,293 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+# $Id$
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  GeoJSONSeq driver test suite.
+#
+###############################################################################
+# Copyright (c) 2018, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import sys
+
+sys.path.append( '../pymod' )
+
+from osgeo import ogr
+from osgeo import osr
+from osgeo import gdal
+
+import gdaltest
+import ogrtest
+
+###############################################################################
+# Write a layer and read it back, with and without the RS separator
+
+
+def _ogr_geojsonseq_create(filename, lco = None, expect_rs = False):
+
+    ds = ogr.GetDriverByName('GeoJSONSeq').CreateDataSource(filename)
+    sr = osr.SpatialReference()
+    sr.SetFromUserInput('WGS84')
+    if lco is None:
+        lco = []
+    lyr = ds.CreateLayer('test', srs = sr, options = lco)
+    lyr.CreateField(ogr.FieldDefn('foo'))
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f['foo'] = 'bar"d'
+    f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(1 2)'))
+    lyr.CreateFeature(f)
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f['foo'] = 'baz'
+    f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(3 4)'))
+    lyr.CreateFeature(f)
+    ds = None
+
+    fp = gdal.VSIFOpenL(filename, 'rb')
+    data = gdal.VSIFReadL(1, 10000, fp).decode('ascii')
+    gdal.VSIFCloseL(fp)
+    if (data[0] == '\x1e') != expect_rs:
+        gdaltest.post_reason('fail')
+        print(data)
+        return 'fail'
+    if data.count('\n') != 2:
+        gdaltest.post_reason('fail')
+        print(data)
+        return 'fail'
+
+    ds = ogr.Open(filename)
+    if ds.GetDriver().GetName() != 'GeoJSONSeq':
+        gdaltest.post_reason('fail')
+        return 'fail'
+    lyr = ds.GetLayer(0)
+    if lyr.GetGeomType() != ogr.wkbPoint:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.GetFeatureCount() != 2:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f['foo'] != 'bar"d' or f.GetGeometryRef().ExportToWkt() != 'POINT (1 2)':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f['foo'] != 'baz' or f.GetGeometryRef().ExportToWkt() != 'POINT (3 4)':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    if lyr.GetNextFeature() is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    gdal.Unlink(filename)
+
+    return 'success'
+
+def ogr_geojsonseq_lf():
+    return _ogr_geojsonseq_create('/vsimem/test.geojsonl')
+
+def ogr_geojsonseq_rs():
+    return _ogr_geojsonseq_create('/vsimem/test.geojsonl', [ 'RS=YES' ], True)
+
+def ogr_geojsonseq_rs_default_for_geojsons():
+    return _ogr_geojsonseq_create('/vsimem/test.geojsons', expect_rs = True)
+
+###############################################################################
+# Test reading of content with bare geometries, multi-line RS records,
+# random access and schema merging
+
+
+def ogr_geojsonseq_read():
+
+    gdal.FileFromMemBuffer('/vsimem/ogr_geojsonseq_read.txt',
+"""\x1e{"type":"Feature","properties":{"a":1},
+"geometry":{"type":"Point","coordinates":[2,49]}}
+\x1e{"type":"Feature","properties":{"b":"x"},"geometry":null}
+\x1e{"type":"LineString","coordinates":[[2,49],[3,50]]}
+""")
+    ds = ogr.Open('/vsimem/ogr_geojsonseq_read.txt')
+    if ds is None or ds.GetDriver().GetName() != 'GeoJSONSeq':
+        gdaltest.post_reason('fail')
+        return 'fail'
+    lyr = ds.GetLayer(0)
+    if lyr.GetLayerDefn().GetFieldCount() != 2:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.GetGeomType() != ogr.wkbUnknown:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.GetFeatureCount() != 3:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.TestCapability(ogr.OLCRandomRead) != 1:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    f = lyr.GetFeature(2)
+    if f is None or f.GetFID() != 2 or \
+       f.GetGeometryRef().ExportToWkt() != 'LINESTRING (2 49,3 50)':
+        gdaltest.post_reason('fail')
+        return 'fail'
+    f = lyr.GetFeature(0)
+    if f['a'] != 1 or f.GetGeometryRef().ExportToWkt() != 'POINT (2 49)':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    if lyr.GetFeature(3) is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    lyr.SetNextByIndex(1)
+    f = lyr.GetNextFeature()
+    if f['b'] != 'x' or f.GetGeometryRef() is not None:
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+
+    lyr.SetAttributeFilter('a = 1')
+    if lyr.GetFeatureCount() != 1:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    gdal.Unlink('/vsimem/ogr_geojsonseq_read.txt')
+
+    return 'success'
+
+###############################################################################
+# Test that NUM_THREADS returns the same features, in the same order
+
+
+def ogr_geojsonseq_num_threads():
+
+    content = ''
+    for i in range(1000):
+        content += '{"type":"Feature","properties":{"i":%d,"s":"%s"},"geometry":{"type":"Point","coordinates":[%d,%d]}}\n' % (i, str(i) * 3, i % 180, i % 90)
+    gdal.FileFromMemBuffer('/vsimem/ogr_geojsonseq_num_threads.geojsonl',
+                           content)
+
+    ref = []
+    ds = gdal.OpenEx('/vsimem/ogr_geojsonseq_num_threads.geojsonl')
+    lyr = ds.GetLayer(0)
+    for f in lyr:
+        ref.append(f.ExportToJson())
+    ds = None
+    if len(ref) != 1000:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    ds = gdal.OpenEx('/vsimem/ogr_geojsonseq_num_threads.geojsonl',
+                     open_options = [ 'NUM_THREADS=ALL_CPUS' ])
+    lyr = ds.GetLayer(0)
+    got = []
+    for f in lyr:
+        got.append(f.ExportToJson())
+    ds = None
+
+    gdal.Unlink('/vsimem/ogr_geojsonseq_num_threads.geojsonl')
+
+    if got != ref:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test that errors of the worker threads are emitted
+
+
+def ogr_geojsonseq_num_threads_errors():
+
+    content = ''
+    for i in range(1000):
+        if i == 500:
+            content += '{invalid\n'
+        else:
+            content += '{"type":"Feature","properties":{"i":%d},"geometry":{"type":"Point","coordinates":[%d,%d]}}\n' % (i, i % 180, i % 90)
+    gdal.FileFromMemBuffer('/vsimem/ogr_geojsonseq_num_threads_errors.geojsonl',
+                           content)
+
+    gdal.ErrorReset()
+    with gdaltest.error_handler():
+        ds = gdal.OpenEx('/vsimem/ogr_geojsonseq_num_threads_errors.geojsonl',
+                         open_options = [ 'NUM_THREADS=4' ])
+    if gdal.GetLastErrorMsg().find('Cannot parse record at offset') < 0:
+        gdaltest.post_reason('fail')
+        print(gdal.GetLastErrorMsg())
+        return 'fail'
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 999:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    gdal.Unlink('/vsimem/ogr_geojsonseq_num_threads_errors.geojsonl')
+
+    return 'success'
+
+###############################################################################
+# Test reprojection to WGS84 on writing
+
+
+def ogr_geojsonseq_reproject():
+
+    ds = ogr.GetDriverByName('GeoJSONSeq').CreateDataSource('/vsimem/ogr_geojsonseq_reproject.geojsonl')
+    sr = osr.SpatialReference()
+    sr.SetFromUserInput('EPSG:32631')
+    lyr = ds.CreateLayer('test', srs = sr)
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(500000 0)'))
+    lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open('/vsimem/ogr_geojsonseq_reproject.geojsonl')
+    lyr = ds.GetLayer(0)
+    f = lyr.GetNextFeature()
+    if ogrtest.check_feature_geometry(f, 'POINT (3 0)') != 0:
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    ds = None
+
+    gdal.Unlink('/vsimem/ogr_geojsonseq_reproject.geojsonl')
+
+    return 'success'
+
+gdaltest_list = [
+    ogr_geojsonseq_lf,
+    ogr_geojsonseq_rs,
+    ogr_geojsonseq_rs_default_for_geojsons,
+    ogr_geojsonseq_read,
+    ogr_geojsonseq_num_threads,
+    ogr_geojsonseq_num_threads_errors,
+    ogr_geojsonseq_reproject,
+    ]
+
+if __name__ == '__main__':
+
+    gdaltest.setup_run( 'ogr_geojsonseq' )
+
+    gdaltest.run_tests( gdaltest_list )
+
+    gdaltest.summarize()
@@ -4620,6 +4620,190 @@ def ogr_gpkg_59():
 
     return 'success'
 
+###############################################################################
+# Test that a bulk loaded spatial index is equivalent to one built by
+# individual insertions
+
+def ogr_gpkg_60():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+
+    results = []
+    # A maximum memory of 0 MB forces the fallback to regular insertion
+    for (bulk_load, max_memory) in [('YES', None), ('YES', '0'), ('NO', None)]:
+        filename = '/vsimem/ogr_gpkg_60.gpkg'
+        ds = gdaltest.gpkg_dr.CreateDataSource(filename)
+        lyr = ds.CreateLayer('test', geom_type = ogr.wkbPolygon,
+                             options = ['SPATIAL_INDEX=NO'])
+        lyr.StartTransaction()
+        for i in range(5000):
+            x = (i * 7919) % 1000
+            y = (i * 104729) % 1000
+            f = ogr.Feature(lyr.GetLayerDefn())
+            f.SetGeometry(ogr.CreateGeometryFromWkt(
+                'POLYGON((%d %d,%d %d,%d %d,%d %d))' %
+                (x, y, x, y + 1.5, x + 1.5, y + 1.5, x, y)))
+            lyr.CreateFeature(f)
+        lyr.CommitTransaction()
+
+        with gdaltest.config_option('OGR_GPKG_RTREE_BULK_LOAD', bulk_load):
+            with gdaltest.config_option('OGR_GPKG_RTREE_BULK_LOAD_MAX_MEMORY',
+                                        max_memory):
+                sql_lyr = ds.ExecuteSQL(
+                    "SELECT CreateSpatialIndex('test', 'geom')")
+        f = sql_lyr.GetNextFeature()
+        if f.GetField(0) != 1:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        ds.ReleaseResultSet(sql_lyr)
+
+        # rtreecheck() is available since sqlite 3.24
+        with gdaltest.error_handler():
+            sql_lyr = ds.ExecuteSQL("SELECT rtreecheck('rtree_test_geom')")
+        if sql_lyr is not None:
+            f = sql_lyr.GetNextFeature()
+            if f.GetField(0) != 'ok':
+                gdaltest.post_reason('fail')
+                print(bulk_load, max_memory)
+                f.DumpReadable()
+                return 'fail'
+            ds.ReleaseResultSet(sql_lyr)
+
+        sql_lyr = ds.ExecuteSQL("SELECT COUNT(*) FROM rtree_test_geom")
+        f = sql_lyr.GetNextFeature()
+        if f.GetField(0) != 5000:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        ds.ReleaseResultSet(sql_lyr)
+
+        # Check that the index remains usable by the triggers
+        lyr = ds.GetLayer(0)
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(500.25 500.25)'))
+        lyr.CreateFeature(f)
+        lyr.DeleteFeature(1)
+
+        fids = []
+        for (minx, miny, maxx, maxy) in [(0, 0, 10, 10), (500, 500, 501, 501),
+                                         (-10, -10, -1, -1),
+                                         (250, 0, 260, 1000)]:
+            lyr.SetSpatialFilterRect(minx, miny, maxx, maxy)
+            fids.append(sorted([f.GetFID() for f in lyr]))
+        results.append(fids)
+        ds = None
+
+        gdal.Unlink(filename)
+
+    if results[0] != results[1] or results[0] != results[2]:
+        gdaltest.post_reason('fail')
+        print(results)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test SPATIAL_SORT layer creation option
+
+def ogr_gpkg_61():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+
+    filename = '/vsimem/ogr_gpkg_61.gpkg'
+    for read_before_close in [False, True]:
+        ds = gdaltest.gpkg_dr.CreateDataSource(filename)
+        lyr = ds.CreateLayer('test', geom_type = ogr.wkbPolygon,
+                             options = ['SPATIAL_SORT=YES'])
+        lyr.CreateField(ogr.FieldDefn('name', ogr.OFTString))
+        lyr.StartTransaction()
+        # 16x16 grid of unit squares, written column by column
+        for i in range(16):
+            for j in range(16):
+                f = ogr.Feature(lyr.GetLayerDefn())
+                f.SetField('name', '%d_%d' % (i, j))
+                f.SetGeometry(ogr.CreateGeometryFromWkt(
+                    'POLYGON((%d %d,%d %d,%d %d,%d %d,%d %d))' %
+                    (i, j, i, j + 1, i + 1, j + 1, i + 1, j, i, j)))
+                lyr.CreateFeature(f)
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetField('name', 'empty')
+        lyr.CreateFeature(f)
+        lyr.CommitTransaction()
+
+        if read_before_close:
+            # Reading builds the spatial index, but features must keep
+            # their FID until the dataset is closed
+            lyr.SetSpatialFilterRect(2.5, 2.5, 4.5, 3.5)
+            if lyr.GetFeatureCount() != 6:
+                gdaltest.post_reason('fail')
+                return 'fail'
+            lyr.SetSpatialFilter(None)
+            f = lyr.GetFeature(18)
+            if f['name'] != '1_1':
+                gdaltest.post_reason('fail')
+                f.DumpReadable()
+                return 'fail'
+        ds = None
+
+        ds = ogr.Open(filename)
+        lyr = ds.GetLayer(0)
+        fids = []
+        cells = []
+        for f in lyr:
+            fids.append(f.GetFID())
+            cells.append(f['name'])
+        if fids != list(range(1, 258)):
+            gdaltest.post_reason('fail')
+            print(read_before_close)
+            return 'fail'
+        # Features without geometry go last
+        if cells[-1] != 'empty':
+            gdaltest.post_reason('fail')
+            print(read_before_close)
+            return 'fail'
+        # Along the Hilbert curve, consecutive cells of the grid are
+        # neighbours
+        for k in range(255):
+            (i0, j0) = [int(v) for v in cells[k].split('_')]
+            (i1, j1) = [int(v) for v in cells[k + 1].split('_')]
+            if abs(i1 - i0) + abs(j1 - j0) != 1:
+                gdaltest.post_reason('fail')
+                print(read_before_close, cells[k], cells[k + 1])
+                return 'fail'
+
+        # The RTree must reference the renumbered features
+        sql_lyr = ds.ExecuteSQL("SELECT COUNT(*) FROM rtree_test_geom")
+        f = sql_lyr.GetNextFeature()
+        if f.GetField(0) != 256:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        ds.ReleaseResultSet(sql_lyr)
+
+        sql_lyr = ds.ExecuteSQL(
+            "SELECT COUNT(*) FROM rtree_test_geom r JOIN test t "
+            "ON r.id = t.fid WHERE "
+            "r.minx <= ST_MinX(t.geom) AND r.maxx >= ST_MaxX(t.geom) AND "
+            "r.miny <= ST_MinY(t.geom) AND r.maxy >= ST_MaxY(t.geom)")
+        f = sql_lyr.GetNextFeature()
+        if f.GetField(0) != 256:
+            gdaltest.post_reason('fail')
+            print(read_before_close)
+            return 'fail'
+        ds.ReleaseResultSet(sql_lyr)
+
+        lyr.SetSpatialFilterRect(2.5, 2.5, 4.5, 3.5)
+        got = sorted([f['name'] for f in lyr])
+        if got != ['2_2', '2_3', '3_2', '3_3', '4_2', '4_3']:
+            gdaltest.post_reason('fail')
+            print(read_before_close, got)
+            return 'fail'
+        ds = None
+
+        gdal.Unlink(filename)
+
+    return 'success'
+
 ###############################################################################
 # Remove the test db from the tmp directory
 
@@ -4704,6 +4888,8 @@ gdaltest_list = [
     ogr_gpkg_57,
     ogr_gpkg_58,
     ogr_gpkg_59,
+    ogr_gpkg_60,
+    ogr_gpkg_61,
     ogr_gpkg_test_ogrsf,
     ogr_gpkg_cleanup,
 ]
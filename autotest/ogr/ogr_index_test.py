@@ -236,7 +236,7 @@ def ogr_index_9():
 
     # After dataset closing, check that the index files do not exist after
     # dropping the index
-    for filename in ['join_t.idm','join_t.ind']:
+    for filename in ['join_t.obi']:
         try:
             os.stat(filename)
             gdaltest.post_reason("%s should not exist" % filename)
@@ -249,7 +249,7 @@ def ogr_index_9():
     gdaltest.s_ds.ExecuteSQL( 'CREATE INDEX ON join_t USING value' )
     gdaltest.s_ds.Release()
 
-    for filename in ['join_t.idm','join_t.ind']:
+    for filename in ['join_t.obi']:
         try:
             os.stat(filename)
         except:
@@ -257,32 +257,29 @@ def ogr_index_9():
             return 'fail'
             pass
 
-    f = open('join_t.idm', 'rt')
-    xml = f.read()
+    f = open('join_t.obi', 'rb')
+    data = f.read()
     f.close()
-    if xml.find('VALUE') == -1:
+    if data.find('VALUE'.encode('ascii')) == -1:
         gdaltest.post_reason('VALUE column is not indexed (1)')
-        print(xml)
         return 'fail'
 
     # Close the dataset and re-open
     gdaltest.s_ds = ogr.OpenShared( 'join_t.dbf', update = 1 )
-    # At this point the .ind was opened in read-only. Now it
+    # At this point the .obi was opened in read-only. Now it
     # will be re-opened in read-write mode
     gdaltest.s_ds.ExecuteSQL( 'CREATE INDEX ON join_t USING skey' )
 
     gdaltest.s_ds.Release()
 
-    f = open('join_t.idm', 'rt')
-    xml = f.read()
+    f = open('join_t.obi', 'rb')
+    data = f.read()
     f.close()
-    if xml.find('VALUE') == -1:
+    if data.find('VALUE'.encode('ascii')) == -1:
         gdaltest.post_reason('VALUE column is not indexed (2)')
-        print(xml)
         return 'fail'
-    if xml.find('SKEY') == -1:
+    if data.find('SKEY'.encode('ascii')) == -1:
         gdaltest.post_reason('SKEY column is not indexed (2)')
-        print(xml)
         return 'fail'
 
     return 'success'
@@ -493,6 +490,220 @@ def ogr_index_11():
 
     return 'success'
 
+###############################################################################
+# Test range and LIKE queries on ordered indexes, and index maintenance
+# on feature creation, update, deletion and repack.
+
+def ogr_index_12():
+
+    ds = ogr.GetDriverByName( 'ESRI Shapefile' ).CreateDataSource('tmp/ogr_index_12.dbf')
+    lyr = ds.CreateLayer('ogr_index_12', geom_type = ogr.wkbNone)
+    lyr.CreateField(ogr.FieldDefn('intfield', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('realfield', ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn('strfield', ogr.OFTString))
+
+    for i in range(10):
+        ogrtest.quick_create_feature(lyr, [i, i + 0.5, 'val%d' % i], None)
+
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_12 USING intfield')
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_12 USING realfield')
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_12 USING strfield')
+
+    tests = [ ('intfield > 7', [ 8, 9 ]),
+              ('intfield >= 7', [ 7, 8, 9 ]),
+              ('intfield < 2', [ 0, 1 ]),
+              ('intfield <= 2', [ 0, 1, 2 ]),
+              ('7 < intfield', [ 8, 9 ]),
+              ('intfield > 7.5', [ 8, 9 ]),
+              ('intfield < 1.5', [ 0, 1 ]),
+              ('intfield BETWEEN 3 AND 5', [ 3, 4, 5 ]),
+              ('realfield > 8', [ 8, 9 ]),
+              ('realfield BETWEEN 1 AND 2.5', [ 1, 2 ]),
+              ("strfield LIKE 'VAL1%'", [ 1 ]),
+              ("strfield LIKE 'val%'", [ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 ]),
+              ("strfield > 'val7'", [ 8, 9 ]),
+              ("intfield > 2 AND strfield < 'val5'", [ 3, 4 ]) ]
+    for (sql, expected_fids) in tests:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+        if lyr.GetFeatureCount() != len(expected_fids):
+            gdaltest.post_reason('failed')
+            print(sql)
+            return 'fail'
+
+    lyr.SetAttributeFilter(None)
+
+    # Update, delete and create features.
+    feat = lyr.GetFeature(4)
+    feat.SetField('intfield', 100)
+    lyr.SetFeature(feat)
+    lyr.DeleteFeature(8)
+    ogrtest.quick_create_feature(lyr, [50, 50.5, 'val50'], None)
+
+    lyr.SetAttributeFilter('intfield >= 8')
+    ret = ogr_index_11_check(lyr, [ 4, 9, 10 ])
+    if ret != 'success':
+        return ret
+
+    lyr.SetAttributeFilter('intfield = 4')
+    ret = ogr_index_11_check(lyr, [ ])
+    if ret != 'success':
+        return ret
+
+    # Repack renumbers the features.
+    ds.ExecuteSQL('REPACK ogr_index_12')
+
+    lyr.SetAttributeFilter('intfield >= 8')
+    ret = ogr_index_11_check(lyr, [ 4, 8, 9 ])
+    if ret != 'success':
+        return ret
+
+    ds = None
+
+    # Check that the index is persistent.
+    ds = ogr.Open('tmp/ogr_index_12.dbf')
+    lyr = ds.GetLayer(0)
+    lyr.SetAttributeFilter("strfield LIKE 'val5%'")
+    ret = ogr_index_11_check(lyr, [ 5, 9 ])
+    if ret != 'success':
+        return ret
+    ds = None
+
+    return 'success'
+
+###############################################################################
+# Test combination of bounds on the same field, AND with a non indexed field,
+# and range queries on dates.
+
+def ogr_index_13():
+
+    ds = ogr.GetDriverByName( 'ESRI Shapefile' ).CreateDataSource('tmp/ogr_index_13.dbf')
+    lyr = ds.CreateLayer('ogr_index_13', geom_type = ogr.wkbNone)
+    lyr.CreateField(ogr.FieldDefn('intfield', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('datefield', ogr.OFTDate))
+    lyr.CreateField(ogr.FieldDefn('noindex', ogr.OFTInteger))
+
+    for i in range(10):
+        ogrtest.quick_create_feature(lyr, [i, '2017/12/%02d' % (25 + i) if i < 7 else '2018/01/%02d' % (i - 6), i % 2], None)
+
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_13 USING intfield')
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_13 USING datefield')
+
+    tests = [ ('intfield >= 2 AND intfield < 5', [ 2, 3, 4 ]),
+              ('intfield < 5 AND intfield >= 2', [ 2, 3, 4 ]),
+              ('intfield > 5 AND intfield < 3', [ ]),
+              ('intfield >= 3 AND intfield <= 3', [ 3 ]),
+              ('intfield > 3 AND intfield >= 3', [ 4, 5, 6, 7, 8, 9 ]),
+              ('intfield BETWEEN 2 AND 8 AND intfield < 4', [ 2, 3 ]),
+              ('intfield > 5 AND noindex = 1', [ 7, 9 ]),
+              ('noindex = 0 AND intfield < 5', [ 0, 2, 4 ]),
+              ('(intfield < 2 AND noindex = 1) OR intfield = 8', [ 1, 8 ]),
+              ("datefield >= '2018-01-01'", [ 7, 8, 9 ]),
+              ("datefield < '2017/12/27'", [ 0, 1 ]),
+              ("datefield BETWEEN '2017-12-30' AND '2018-01-02'", [ 5, 6, 7, 8 ]) ]
+    for (sql, expected_fids) in tests:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+        if lyr.GetFeatureCount() != len(expected_fids):
+            gdaltest.post_reason('failed')
+            print(sql)
+            return 'fail'
+
+    # Counting is only fast when every operand can be answered by an index
+    tests = [ ('intfield >= 2 AND intfield < 5', 1),
+              ("intfield = 2 OR datefield < '2017/12/27'", 1),
+              ('intfield > 5 AND noindex = 1', 0),
+              ('noindex = 0 AND intfield < 5', 0),
+              ('(intfield < 2 AND noindex = 1) OR intfield = 8', 0) ]
+    for (sql, expected_cap) in tests:
+        lyr.SetAttributeFilter(sql)
+        if lyr.TestCapability(ogr.OLCFastFeatureCount) != expected_cap:
+            gdaltest.post_reason('failed')
+            print(sql)
+            return 'fail'
+    lyr.SetAttributeFilter(None)
+
+    ds = None
+
+    return 'success'
+
+###############################################################################
+# Test that indexes follow DeleteField(), ReorderFields() and AlterFieldDefn()
+
+def ogr_index_14():
+
+    ds = ogr.GetDriverByName( 'ESRI Shapefile' ).CreateDataSource('tmp/ogr_index_14.dbf')
+    lyr = ds.CreateLayer('ogr_index_14', geom_type = ogr.wkbNone)
+    lyr.CreateField(ogr.FieldDefn('a', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('b', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('c', ogr.OFTInteger))
+
+    for i in range(10):
+        ogrtest.quick_create_feature(lyr, [i, 'val%d' % i, 10 * i], None)
+
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_14 USING a')
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_14 USING c')
+
+    # Delete an indexed field before the other indexed one
+    if lyr.DeleteField(0) != 0:
+        gdaltest.post_reason('failed')
+        return 'fail'
+    ogrtest.quick_create_feature(lyr, ['new', 100], None)
+
+    for (sql, expected_fids) in [ ('c = 30', [ 3 ]),
+                                  ('c >= 80', [ 8, 9, 10 ]),
+                                  ("b = 'val4'", [ 4 ]) ]:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+
+    lyr.ReorderFields([1, 0])
+    ogrtest.quick_create_feature(lyr, [110, 'new2'], None)
+
+    for (sql, expected_fids) in [ ('c = 50', [ 5 ]),
+                                  ('c > 95', [ 10, 11 ]),
+                                  ("b = 'new2'", [ 11 ]) ]:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+
+    lyr.AlterFieldDefn(0, ogr.FieldDefn('c', ogr.OFTString),
+                       ogr.ALTER_TYPE_FLAG)
+
+    for (sql, expected_fids) in [ ("c = '70'", [ 7 ]),
+                                  ("c = '110'", [ 11 ]) ]:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+
+    ds = None
+
+    # Check the state of the index on disk
+    ds = ogr.Open('tmp/ogr_index_14.dbf')
+    lyr = ds.GetLayer(0)
+    for (sql, expected_fids) in [ ("c = '20'", [ 2 ]),
+                                  ("b = 'val9'", [ 9 ]) ]:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+    ds = None
+
+    return 'success'
+
 ###############################################################################
 
 def ogr_index_cleanup():
@@ -510,7 +721,7 @@ def ogr_index_cleanup():
     ogr.GetDriverByName( 'MapInfo File' ).DeleteDataSource( 'index_p.mif' )
     ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource( 'join_t.dbf' )
 
-    for filename in ['join_t.idm','join_t.ind']:
+    for filename in ['join_t.obi']:
         try:
             os.stat(filename)
             gdaltest.post_reason("%s should not exist" % filename)
@@ -522,6 +733,12 @@ def ogr_index_cleanup():
         'tmp/ogr_index_10.shp' )
     ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
         'tmp/ogr_index_11.dbf' )
+    ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
+        'tmp/ogr_index_12.dbf' )
+    ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
+        'tmp/ogr_index_13.dbf' )
+    ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
+        'tmp/ogr_index_14.dbf' )
 
     return 'success'
 
@@ -537,6 +754,9 @@ gdaltest_list = [
     ogr_index_9,
     ogr_index_10,
     ogr_index_11,
+    ogr_index_12,
+    ogr_index_13,
+    ogr_index_14,
     ogr_index_cleanup ]
 
 if __name__ == '__main__':
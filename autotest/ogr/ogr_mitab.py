@@ -2555,6 +2555,43 @@ def ogr_mitab_tab_field_index_creation():
 
     return 'success'
 
+###############################################################################
+# Test an equality filter on an indexed date field (must not use the .ind)
+
+def ogr_mitab_tab_date_field_index():
+
+    layername = 'ogr_mitab_tab_date_field_index'
+    filename = '/vsimem/' + layername + '.tab'
+    ds = ogr.GetDriverByName('MapInfo File').CreateDataSource(filename)
+    lyr = ds.CreateLayer(layername)
+    lyr.CreateField( ogr.FieldDefn('dt', ogr.OFTDate) )
+    ds.ExecuteSQL('CREATE INDEX ON ' + layername + ' USING dt')
+    for day in range(1, 4):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetField(0, 2018, 1, day, 0, 0, 0, 0)
+        lyr.CreateFeature(f)
+    ds = None
+
+    if gdal.VSIStatL('/vsimem/' + layername + '.ind') is None:
+        gdaltest.post_reason('no ind file')
+        return 'fail'
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    lyr.SetAttributeFilter("dt = '2018/01/02'")
+    if lyr.GetFeatureCount() != 1:
+        gdaltest.post_reason('bad feature count')
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f is None or f.GetField(0) != '2018/01/02':
+        gdaltest.post_reason('bad feature')
+        return 'fail'
+    ds = None
+
+    ogr.GetDriverByName('MapInfo File').DeleteDataSource(filename)
+
+    return 'success'
+
 ###############################################################################
 # Test reading a tab_view file
 
@@ -2653,6 +2690,7 @@ gdaltest_list = [
     ogr_mitab_47,
     ogr_mitab_48,
     ogr_mitab_tab_field_index_creation,
+    ogr_mitab_tab_date_field_index,
     ogr_mitab_tab_view,
     ogr_mitab_cleanup
     ]
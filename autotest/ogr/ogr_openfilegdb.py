@@ -1104,6 +1104,12 @@ def get_spi_state(ds, lyr):
 
 def ogr_openfilegdb_11():
 
+    # The in-memory spatial index is only built when the .spx is not used
+    with gdaltest.config_option('OPENFILEGDB_USE_SPATIAL_INDEX', 'NO'):
+        return ogr_openfilegdb_11_in_memory_spi()
+
+def ogr_openfilegdb_11_in_memory_spi():
+
     # Test building spatial index with GetFeatureCount()
     ds = ogr.Open('data/testopenfilegdb.gdb.zip')
     lyr = ds.GetLayerByName('several_polygons')
@@ -1553,6 +1559,97 @@ def ogr_openfilegdb_21():
 
     return 'success'
 
+###############################################################################
+# Test spatial filtering with the .spx spatial index
+
+def ogr_openfilegdb_22():
+
+    ds = ogr.Open('data/testopenfilegdb.gdb.zip')
+    lyr = ds.GetLayerByName('several_polygons')
+    lyr.SetSpatialFilterRect(0.25,0.25,0.5,0.5)
+    if get_spi_state(ds, lyr) != SPI_INVALID:
+        gdaltest.post_reason('failure')
+        return 'fail'
+    if lyr.TestCapability(ogr.OLCFastSetNextByIndex) != 0:
+        gdaltest.post_reason('failure')
+        return 'fail'
+    if lyr.GetFeatureCount() != 1:
+        gdaltest.post_reason('failure')
+        return 'fail'
+    fids = [f.GetFID() for f in lyr]
+    if fids != [1]:
+        gdaltest.post_reason('failure')
+        print(fids)
+        return 'fail'
+    lyr = None
+    ds = None
+
+    # Compare with the results without the index
+    rects = [(0.25,0.25,0.5,0.5), (-1,-1,0.5,0.5), (1.4,0.4,1.6,0.6),
+             (-180,-90,180,90), (-1e10,-1e10,1e10,1e10), (1,1,1,1),
+             (100,100,200,200)]
+    for filename in ['data/testopenfilegdb.gdb.zip', 'data/curves.gdb',
+                     'data/testopenfilegdb92.gdb.zip']:
+        res = []
+        for use_spx in ['YES', 'NO']:
+            with gdaltest.config_option('OPENFILEGDB_USE_SPATIAL_INDEX',
+                                        use_spx):
+                ds = ogr.Open(filename)
+                layer_res = []
+                for lyr in ds:
+                    if lyr.GetGeomType() == ogr.wkbNone:
+                        continue
+                    for rect in rects:
+                        lyr.SetSpatialFilterRect(rect[0], rect[1],
+                                                 rect[2], rect[3])
+                        layer_res.append(
+                            (lyr.GetName(), rect, lyr.GetFeatureCount(),
+                             [f.GetFID() for f in lyr]))
+                ds = None
+            res.append(layer_res)
+        if res[0] != res[1]:
+            gdaltest.post_reason('failure')
+            print(filename)
+            print(res[0])
+            print(res[1])
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test spatial filtering with a .spx spatial index spanning several pages,
+# with cells at negative coordinates and keys in the coarser grid levels
+
+def ogr_openfilegdb_23():
+
+    rects = [(-1,-1,0.5,0.5), (-0.9,-0.9,-0.6,-0.6), (5.2,0.2,5.4,0.4),
+             (9.2,-0.8,9.4,-0.6), (15.1,0.1,15.2,0.2), (19.2,-0.8,19.4,-0.6),
+             (28.5,-1.5,28.7,-1.3), (29,1.9,31,2.1), (-180,-90,180,90),
+             (-0.05,-1.05,0.05,-0.95), (3,3,4,4)]
+    res = []
+    for use_spx in ['YES', 'NO']:
+        with gdaltest.config_option('OPENFILEGDB_USE_SPATIAL_INDEX', use_spx):
+            ds = ogr.Open('data/filegdb_spx_multipage.gdb.zip')
+            lyr = ds.GetLayer(0)
+            layer_res = []
+            for rect in rects:
+                lyr.SetSpatialFilterRect(rect[0], rect[1], rect[2], rect[3])
+                layer_res.append((rect, lyr.GetFeatureCount(),
+                                  [f.GetFID() for f in lyr]))
+            ds = None
+        res.append(layer_res)
+    if res[0] != res[1]:
+        gdaltest.post_reason('failure')
+        print(res[0])
+        print(res[1])
+        return 'fail'
+    if res[0][2][2] != [2] or res[0][8][2] != [1, 2, 3, 4, 5, 6]:
+        gdaltest.post_reason('failure')
+        print(res[0])
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -1605,6 +1702,8 @@ gdaltest_list = [
     ogr_openfilegdb_19,
     ogr_openfilegdb_20,
     ogr_openfilegdb_21,
+    ogr_openfilegdb_22,
+    ogr_openfilegdb_23,
     ogr_openfilegdb_cleanup,
     ]
 
@@ -333,6 +333,15 @@ def ogr_osm_3_custom_compress_nodes():
     gdal.SetConfigOption('OSM_COMPRESS_NODES', None)
     return ret
 
+###############################################################################
+# Test ogr2ogr with memory-mapped flat nodes file
+
+def ogr_osm_3_flat_nodes():
+    gdal.SetConfigOption('OSM_FLAT_NODES', 'YES')
+    ret = ogr_osm_3()
+    gdal.SetConfigOption('OSM_FLAT_NODES', None)
+    return ret
+
 ###############################################################################
 # Test ogr2ogr with all layers
 
@@ -969,12 +978,64 @@ def ogr_osm_18():
 
     return 'success'
 
+###############################################################################
+# Test that multi-threaded decoding of .pbf files returns the same features,
+# in the same order, as single-threaded decoding.
+# multi_blob.pbf has 13 compressed OSMData blobs, so that they are decoded in
+# parallel, and 2602 ways, so that they are resolved in parallel.
+
+def ogr_osm_19():
+
+    if ogrtest.osm_drv is None:
+        return 'skip'
+
+    for filename in [ 'data/test.pbf', 'data/two_points.pbf',
+                      'data/multi_blob.pbf' ]:
+        res = []
+        for num_threads in [ '1', '4' ]:
+            with gdaltest.config_option('GDAL_NUM_THREADS', num_threads):
+                ds = gdal.OpenEx(filename)
+                features = []
+                while True:
+                    f, lyr = ds.GetNextFeature()
+                    if f is None:
+                        break
+                    features.append(lyr.GetName() + ' ' + f.ExportToJson())
+                ds = None
+            res.append(features)
+        if res[0] != res[1] or not res[0]:
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+
+    # Same with layers read one after the other
+    res = []
+    for num_threads in [ '1', '4' ]:
+        with gdaltest.config_option('GDAL_NUM_THREADS', num_threads):
+            ds = ogr.Open('data/multi_blob.pbf')
+            features = []
+            for lyr in ds:
+                for f in lyr:
+                    features.append(lyr.GetName() + ' ' + f.ExportToJson())
+            ds = None
+        res.append(features)
+    if res[0] != res[1]:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if len([x for x in res[0] if x.startswith('lines ')]) != 2500 or \
+       len([x for x in res[0] if x.startswith('multipolygons ')]) != 101:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     ogr_osm_1,
     ogr_osm_2,
     ogr_osm_3,
     ogr_osm_3_sqlite_nodes,
     ogr_osm_3_custom_compress_nodes,
+    ogr_osm_3_flat_nodes,
     ogr_osm_3_all_layers,
     ogr_osm_4,
     ogr_osm_5,
@@ -993,6 +1054,7 @@ gdaltest_list = [
     ogr_osm_16,
     ogr_osm_17,
     ogr_osm_18,
+    ogr_osm_19,
     ]
 
 if __name__ == '__main__':
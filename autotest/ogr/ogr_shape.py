@@ -5273,6 +5273,219 @@ def ogr_shape_108():
 
     return 'success'
 
+###############################################################################
+# Test the packed Hilbert R-tree spatial index (.hrt)
+
+def ogr_shape_109():
+
+    filename = '/vsimem/ogr_shape_109.shp'
+    ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource(filename)
+    lyr = ds.CreateLayer('ogr_shape_109', geom_type = ogr.wkbLineString)
+    for j in range(50):
+        for i in range(50):
+            f = ogr.Feature(lyr.GetLayerDefn())
+            if i == 25 and j == 25:
+                # Null geometry
+                pass
+            else:
+                f.SetGeometry(ogr.CreateGeometryFromWkt(
+                    'LINESTRING(%d %d,%f %f)' % (i, j, i + 0.5, j + 0.5)))
+            lyr.CreateFeature(f)
+    ds = None
+
+    rects = [ (10.2, 10.2, 12.7, 14.1), (-10, -10, -5, -5), (49.4, 49.4, 60, 60),
+              (0, 0, 0.1, 0.1), (25.1, 25.1, 25.2, 25.2) ]
+
+    ds = ogr.Open(filename, update = 1)
+    lyr = ds.GetLayer(0)
+    expected = []
+    for rect in rects:
+        lyr.SetSpatialFilterRect(rect[0], rect[1], rect[2], rect[3])
+        expected.append([f.GetFID() for f in lyr])
+    lyr.SetSpatialFilter(None)
+
+    with gdaltest.config_option('SHAPE_SPATIAL_INDEX_FORMAT', 'HILBERT'):
+        ds.ExecuteSQL('CREATE SPATIAL INDEX ON ogr_shape_109')
+    if gdal.VSIStatL('/vsimem/ogr_shape_109.hrt') is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if gdal.VSIStatL('/vsimem/ogr_shape_109.qix') is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    ds = ogr.Open(filename, update = 1)
+    lyr = ds.GetLayer(0)
+    if lyr.TestCapability(ogr.OLCFastSpatialFilter) != 1:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    for idx, rect in enumerate(rects):
+        lyr.SetSpatialFilterRect(rect[0], rect[1], rect[2], rect[3])
+        got = [f.GetFID() for f in lyr]
+        if got != expected[idx]:
+            gdaltest.post_reason('fail')
+            print(rect, got, expected[idx])
+            return 'fail'
+    lyr.SetSpatialFilter(None)
+
+    ds.ExecuteSQL('DROP SPATIAL INDEX ON ogr_shape_109')
+    if gdal.VSIStatL('/vsimem/ogr_shape_109.hrt') is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.TestCapability(ogr.OLCFastSpatialFilter) != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    # A .qix next to the .hrt must be listed and dropped too
+    ds = ogr.Open(filename, update = 1)
+    ds.ExecuteSQL('CREATE SPATIAL INDEX ON ogr_shape_109')
+    ds = None
+    f = gdal.VSIFOpenL('/vsimem/ogr_shape_109.qix', 'rb')
+    qix_data = gdal.VSIFReadL(1, 100000000, f)
+    gdal.VSIFCloseL(f)
+    ds = ogr.Open(filename, update = 1)
+    with gdaltest.config_option('SHAPE_SPATIAL_INDEX_FORMAT', 'HILBERT'):
+        ds.ExecuteSQL('CREATE SPATIAL INDEX ON ogr_shape_109')
+    ds = None
+    f = gdal.VSIFOpenL('/vsimem/ogr_shape_109.qix', 'wb')
+    gdal.VSIFWriteL(qix_data, 1, len(qix_data), f)
+    gdal.VSIFCloseL(f)
+
+    ds = ogr.Open(filename, update = 1)
+    filelist = ds.GetFileList()
+    if '/vsimem/ogr_shape_109.hrt' not in filelist or \
+       '/vsimem/ogr_shape_109.qix' not in filelist:
+        gdaltest.post_reason('fail')
+        print(filelist)
+        return 'fail'
+    ds.ExecuteSQL('DROP SPATIAL INDEX ON ogr_shape_109')
+    if gdal.VSIStatL('/vsimem/ogr_shape_109.hrt') is not None or \
+       gdal.VSIStatL('/vsimem/ogr_shape_109.qix') is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    # An index that does not match the .shp must be ignored
+    ds = ogr.Open(filename, update = 1)
+    with gdaltest.config_option('SHAPE_SPATIAL_INDEX_FORMAT', 'HILBERT'):
+        ds.ExecuteSQL('CREATE SPATIAL INDEX ON ogr_shape_109')
+    ds = None
+    f = gdal.VSIFOpenL('/vsimem/ogr_shape_109.hrt', 'rb')
+    data = gdal.VSIFReadL(1, 100000000, f)
+    gdal.VSIFCloseL(f)
+    ds = ogr.Open(filename, update = 1)
+    lyr = ds.GetLayer(0)
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f.SetGeometry(ogr.CreateGeometryFromWkt('LINESTRING(0 0,1 1)'))
+    lyr.CreateFeature(f)
+    ds = None
+    f = gdal.VSIFOpenL('/vsimem/ogr_shape_109.hrt', 'wb')
+    gdal.VSIFWriteL(data, 1, len(data), f)
+    gdal.VSIFCloseL(f)
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    if lyr.TestCapability(ogr.OLCFastSpatialFilter) != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    # A shape id beyond the number of records must not be used
+    ds = ogr.Open(filename, update = 1)
+    with gdaltest.config_option('SHAPE_SPATIAL_INDEX_FORMAT', 'HILBERT'):
+        ds.ExecuteSQL('CREATE SPATIAL INDEX ON ogr_shape_109')
+    ds = None
+    f = gdal.VSIFOpenL('/vsimem/ogr_shape_109.hrt', 'rb+')
+    gdal.VSIFSeekL(f, 0, 2)
+    gdal.VSIFSeekL(f, gdal.VSIFTellL(f) - 8, 0)
+    gdal.VSIFWriteL(struct.pack('<Q', 2501), 1, 8, f)
+    gdal.VSIFCloseL(f)
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    lyr.SetSpatialFilterRect(0.2, 0.2, 49.3, 49.3)
+    gdal.ErrorReset()
+    with gdaltest.error_handler():
+        fc = len([f for f in lyr])
+    # Falls back to a full scan
+    if gdal.GetLastErrorMsg() != 'Corrupted spatial index' or fc != 2500:
+        gdaltest.post_reason('fail')
+        print(gdal.GetLastErrorMsg(), fc)
+        return 'fail'
+    ds = None
+
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource(filename)
+    if gdal.VSIStatL('/vsimem/ogr_shape_109.hrt') is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test SPATIAL_SORT layer creation option
+
+def ogr_shape_110():
+
+    filename = '/vsimem/ogr_shape_110.shp'
+    for index_format in ['QIX', 'HILBERT']:
+        ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource(filename)
+        lyr = ds.CreateLayer('ogr_shape_110', geom_type = ogr.wkbPolygon,
+                             options = ['SPATIAL_SORT=YES',
+                                        'SPATIAL_INDEX=YES'])
+        lyr.CreateField(ogr.FieldDefn('EAS_ID', ogr.OFTInteger64))
+        src_ds = ogr.Open('data/poly.shp')
+        for src_feat in src_ds.GetLayer(0):
+            f = ogr.Feature(lyr.GetLayerDefn())
+            f.SetField('EAS_ID', src_feat.GetField('EAS_ID'))
+            f.SetGeometry(src_feat.GetGeometryRef())
+            lyr.CreateFeature(f)
+        src_ds = None
+        # Deleted features are removed by the rewrite
+        lyr.DeleteFeature(3)
+        # The sort and the spatial index are both done when closing
+        with gdaltest.config_option('SHAPE_SPATIAL_INDEX_FORMAT',
+                                    index_format):
+            ds = None
+
+        if index_format == 'QIX':
+            (index_ext, other_ext) = ('qix', 'hrt')
+        else:
+            (index_ext, other_ext) = ('hrt', 'qix')
+        if gdal.VSIStatL('/vsimem/ogr_shape_110.' + index_ext) is None or \
+           gdal.VSIStatL('/vsimem/ogr_shape_110.' + other_ext) is not None:
+            gdaltest.post_reason('fail')
+            print(index_format)
+            return 'fail'
+
+        ds = ogr.Open(filename)
+        lyr = ds.GetLayer(0)
+        if lyr.TestCapability(ogr.OLCFastSpatialFilter) != 1:
+            gdaltest.post_reason('fail')
+            print(index_format)
+            return 'fail'
+        got = [ (f.GetFID(), f.GetField('EAS_ID')) for f in lyr ]
+        expected = [ (0, 172), (1, 179), (2, 171), (3, 169), (4, 170),
+                     (5, 165), (6, 166), (7, 168), (8, 158) ]
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(index_format, got)
+            return 'fail'
+
+        # The index is built on the sorted file, and the shapes it selects
+        # are read sequentially
+        lyr.SetSpatialFilterRect(479750, 4764700, 480500, 4765500)
+        got = [ f.GetFID() for f in lyr ]
+        if got != [ 1, 2, 3, 4, 5, 6, 7, 8 ]:
+            gdaltest.post_reason('fail')
+            print(index_format, got)
+            return 'fail'
+        ds = None
+
+        ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource(filename)
+
+    return 'success'
+
 ###############################################################################
 def ogr_shape_cleanup():
 
@@ -5425,6 +5638,8 @@ gdaltest_list = [
     ogr_shape_106,
     ogr_shape_107,
     ogr_shape_108,
+    ogr_shape_109,
+    ogr_shape_110,
     ogr_shape_cleanup ]
 
 # gdaltest_list = [ ogr_shape_107 ]
@@ -2737,6 +2737,85 @@ def test_ogr2ogr_67():
     ret = check_identity_transformation(x, y, 4326)
     return ret
 
+###############################################################################
+# Test -threads gives the same result as the serial translation
+
+def test_ogr2ogr_68():
+    if test_cli_utilities.get_ogr2ogr_path() is None:
+        return 'skip'
+
+    options = ' -t_srs EPSG:4326 -segmentize 100'
+    if ogrtest.have_geos():
+        options += ' -clipsrc 478000 4762000 482000 4766000'
+    gdaltest.runexternal(test_cli_utilities.get_ogr2ogr_path() + options + ' tmp/test_ogr2ogr_68_serial.shp ../ogr/data/poly.shp')
+    gdaltest.runexternal(test_cli_utilities.get_ogr2ogr_path() + options + ' -threads 4 tmp/test_ogr2ogr_68_threads.shp ../ogr/data/poly.shp')
+
+    ds_serial = ogr.Open('tmp/test_ogr2ogr_68_serial.shp')
+    ds_threads = ogr.Open('tmp/test_ogr2ogr_68_threads.shp')
+    lyr_serial = ds_serial.GetLayer(0)
+    lyr_threads = ds_threads.GetLayer(0)
+    ret = 'success'
+    if lyr_serial.GetFeatureCount() == 0 or \
+       lyr_serial.GetFeatureCount() != lyr_threads.GetFeatureCount():
+        gdaltest.post_reason('fail')
+        print(lyr_serial.GetFeatureCount(), lyr_threads.GetFeatureCount())
+        ret = 'fail'
+    else:
+        for feat_serial in lyr_serial:
+            feat_threads = lyr_threads.GetNextFeature()
+            if not feat_serial.Equal(feat_threads):
+                gdaltest.post_reason('fail')
+                feat_serial.DumpReadable()
+                feat_threads.DumpReadable()
+                ret = 'fail'
+                break
+    ds_serial = None
+    ds_threads = None
+
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/test_ogr2ogr_68_serial.shp')
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/test_ogr2ogr_68_threads.shp')
+
+    return ret
+
+###############################################################################
+# Test that with -threads, the errors of the geometry translation are
+# reported as in the serial translation
+
+def test_ogr2ogr_69():
+    if test_cli_utilities.get_ogr2ogr_path() is None:
+        return 'skip'
+
+    f = open('tmp/test_ogr2ogr_69_src.csv', 'wt')
+    f.write('id,WKT\n')
+    for i in range(2000):
+        if i % 500 == 10:
+            f.write('%d,"POINT (2 95)"\n' % i)
+        else:
+            f.write('%d,"POINT (2 49)"\n' % i)
+    f.close()
+
+    options = ' -f CSV -lco GEOMETRY=AS_WKT -s_srs EPSG:4326 -t_srs EPSG:3857 -skipfailures'
+    (ret, err_serial) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_ogr2ogr_path() + options + ' tmp/test_ogr2ogr_69_serial.csv tmp/test_ogr2ogr_69_src.csv')
+    (ret, err_threads) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_ogr2ogr_path() + options + ' -threads 4 tmp/test_ogr2ogr_69_threads.csv tmp/test_ogr2ogr_69_src.csv')
+
+    ret = 'success'
+    if err_serial.find('Failed to reproject feature 11 ') < 0 or \
+       err_threads != err_serial:
+        gdaltest.post_reason('fail')
+        print(err_serial)
+        print(err_threads)
+        ret = 'fail'
+    elif open('tmp/test_ogr2ogr_69_serial.csv', 'rt').read() != \
+         open('tmp/test_ogr2ogr_69_threads.csv', 'rt').read():
+        gdaltest.post_reason('fail')
+        ret = 'fail'
+
+    os.unlink('tmp/test_ogr2ogr_69_src.csv')
+    os.unlink('tmp/test_ogr2ogr_69_serial.csv')
+    os.unlink('tmp/test_ogr2ogr_69_threads.csv')
+
+    return ret
+
 gdaltest_list = [
     test_ogr2ogr_1,
     test_ogr2ogr_2,
@@ -2805,7 +2884,9 @@ gdaltest_list = [
     test_ogr2ogr_64,
     test_ogr2ogr_65,
     test_ogr2ogr_66,
-    test_ogr2ogr_67
+    test_ogr2ogr_67,
+    test_ogr2ogr_68,
+    test_ogr2ogr_69
     ]
 
 # gdaltest_list = [ test_ogr2ogr_66 ]
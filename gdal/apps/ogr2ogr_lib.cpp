@@ -39,6 +39,7 @@
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -49,6 +50,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_alg.h"
 #include "gdal_priv.h"
@@ -85,6 +87,13 @@ typedef enum
 #define COORD_DIM_LAYER_DIM -2
 #define COORD_DIM_XYM -3
 
+typedef enum
+{
+    TRANSLATE_GEOM_OK,
+    TRANSLATE_GEOM_SKIPPED,
+    TRANSLATE_GEOM_FAILED,
+} TranslateGeomStatus;
+
 /************************************************************************/
 /*                        GDALVectorTranslateOptions                    */
 /************************************************************************/
@@ -340,6 +349,11 @@ struct GDALVectorTranslateOptions
 
     /*! Maximum number of features, or -1 if no limit. */
     GIntBig nLimit;
+
+    /*! Number of worker threads used to translate feature geometries
+        (reprojection, clipping, simplification, ...). 1 means that features
+        are translated by the calling thread. */
+    int nThreads;
 };
 
 typedef struct
@@ -363,6 +377,29 @@ typedef struct
     TargetLayerInfo  *psInfo;
 } AssociatedLayers;
 
+struct TranslatedFeatureError
+{
+    CPLErr       eErr;
+    CPLErrorNum  nNo;
+    CPLString    osMsg;
+};
+
+struct TranslatedFeature
+{
+    OGRFeature          *poSrcFeature;
+    OGRFeature          *poDstFeature;
+    bool                 bAttributesTranslated;
+    TranslateGeomStatus  eGeomStatus;
+    bool                 bReprojFailed;
+    /* Errors emitted while translating the geometries in a worker */
+    std::vector<TranslatedFeatureError> aoErrors;
+
+    TranslatedFeature() : poSrcFeature(nullptr), poDstFeature(nullptr),
+                          bAttributesTranslated(false),
+                          eGeomStatus(TRANSLATE_GEOM_OK),
+                          bReprojFailed(false) {}
+};
+
 class SetupTargetLayer
 {
 public:
@@ -423,6 +460,20 @@ public:
     bool                          m_bExplodeCollections;
     bool                          m_bNativeData;
     GIntBig                       m_nLimit;
+    int                           m_nThreads;
+
+    bool                TranslateAttributes(TargetLayerInfo* psInfo,
+                                            OGRFeature* poFeature,
+                                            OGRFeature* poDstFeature);
+    TranslateGeomStatus TranslateGeometries(TargetLayerInfo* psInfo,
+                                            OGRFeature* poFeature,
+                                            OGRFeature* poDstFeature,
+                                            int nParts, int iPart,
+                                            OGRCoordinateTransformation** papoCT,
+                                            OGRSpatialReference* poOutputSRS,
+                                            const std::vector<OGRwkbGeometryType>& aeDstGeomTypes,
+                                            bool bSkipFailures,
+                                            bool* pbReprojFailed);
 
     int                 Translate(OGRFeature* poFeatureIn,
                                   TargetLayerInfo* psInfo,
@@ -2468,6 +2519,7 @@ GDALDatasetH GDALVectorTranslate( const char *pszDest, GDALDatasetH hDstDS, int
     oTranslator.m_bExplodeCollections = psOptions->bExplodeCollections;
     oTranslator.m_bNativeData = psOptions->bNativeData;
     oTranslator.m_nLimit = psOptions->nLimit;
+    oTranslator.m_nThreads = psOptions->nThreads;
 
     if( psOptions->nGroupTransactions )
     {
@@ -4320,6 +4372,558 @@ static bool SetupCT( TargetLayerInfo* psInfo,
     return true;
 }
 
+/************************************************************************/
+/*                LayerTranslator::TranslateAttributes()                */
+/*                                                                      */
+/*      Fill a target feature from the fields, FID and native data of  */
+/*      a source feature.  When possible, the source geometry is moved */
+/*      instead of being duplicated into the target feature.           */
+/************************************************************************/
+
+bool LayerTranslator::TranslateAttributes( TargetLayerInfo* psInfo,
+                                           OGRFeature* poFeature,
+                                           OGRFeature* poDstFeature )
+{
+    const int nSrcGeomFieldCount =
+        psInfo->poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
+    const int nDstGeomFieldCount =
+        psInfo->poDstLayer->GetLayerDefn()->GetGeomFieldCount();
+    const bool bExplodeCollections =
+        m_bExplodeCollections && nDstGeomFieldCount <= 1;
+    const bool bPreserveFID = psInfo->bPreserveFID;
+
+    /* Optimization to avoid duplicating the source geometry in the */
+    /* target feature : we steal it from the source feature for now... */
+    OGRGeometry* poStolenGeometry = nullptr;
+    if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
+        nDstGeomFieldCount == 1 )
+    {
+        poStolenGeometry = poFeature->StealGeometry();
+    }
+    else if( !bExplodeCollections &&
+             psInfo->iRequestedSrcGeomField >= 0 )
+    {
+        poStolenGeometry = poFeature->StealGeometry(
+            psInfo->iRequestedSrcGeomField);
+    }
+
+    if( poDstFeature->SetFrom( poFeature, psInfo->panMap, TRUE ) != OGRERR_NONE )
+    {
+        OGRGeometryFactory::destroyGeometry( poStolenGeometry );
+        return false;
+    }
+
+    /* ... and now we can attach the stolen geometry */
+    if( poStolenGeometry )
+    {
+        poDstFeature->SetGeometryDirectly(poStolenGeometry);
+    }
+
+    if( bPreserveFID )
+        poDstFeature->SetFID( poFeature->GetFID() );
+    else if( psInfo->iSrcFIDField >= 0 &&
+             poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField))
+        poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
+
+    /* Erase native data if asked explicitly */
+    if( !m_bNativeData )
+    {
+        poDstFeature->SetNativeData(nullptr);
+        poDstFeature->SetNativeMediaType(nullptr);
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                LayerTranslator::TranslateGeometries()                */
+/*                                                                      */
+/*      Apply the requested geometry operations and reprojection to    */
+/*      the geometries of a target feature.  This only reads shared    */
+/*      state, so it can run concurrently on different features as     */
+/*      long as each thread uses its own coordinate transformations.    */
+/*      The target geometry field types are passed by the caller, so    */
+/*      that the target layer is not accessed here.                     */
+/************************************************************************/
+
+TranslateGeomStatus LayerTranslator::TranslateGeometries(
+                                        TargetLayerInfo* psInfo,
+                                        OGRFeature* poFeature,
+                                        OGRFeature* poDstFeature,
+                                        int nParts, int iPart,
+                                        OGRCoordinateTransformation** papoCT,
+                                        OGRSpatialReference* poOutputSRS,
+                                        const std::vector<OGRwkbGeometryType>& aeDstGeomTypes,
+                                        bool bSkipFailures,
+                                        bool* pbReprojFailed )
+{
+    const int iSrcZField = psInfo->iSrcZField;
+    const int nDstGeomFieldCount = static_cast<int>(aeDstGeomTypes.size());
+    const int eGType = m_eGType;
+
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
+    {
+        OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
+        if (poDstGeometry == nullptr)
+            continue;
+
+        if (nParts > 0)
+        {
+            /* For -explodecollections, extract the iPart(th) of the geometry */
+            OGRGeometry* poPart = ((OGRGeometryCollection*)poDstGeometry)->getGeometryRef(iPart);
+            ((OGRGeometryCollection*)poDstGeometry)->removeGeometry(iPart, FALSE);
+            delete poDstGeometry;
+            poDstGeometry = poPart;
+        }
+
+        if (iSrcZField != -1)
+        {
+            SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
+            /* This will correct the coordinate dimension to 3 */
+            OGRGeometry* poDupGeometry = poDstGeometry->clone();
+            delete poDstGeometry;
+            poDstGeometry = poDupGeometry;
+        }
+
+        if (m_nCoordDim == 2 || m_nCoordDim == 3)
+        {
+            poDstGeometry->setCoordinateDimension( m_nCoordDim );
+        }
+        else if (m_nCoordDim == 4)
+        {
+            poDstGeometry->set3D( TRUE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if (m_nCoordDim == COORD_DIM_XYM)
+        {
+            poDstGeometry->set3D( FALSE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
+        {
+            const OGRwkbGeometryType eDstLayerGeomType = aeDstGeomTypes[iGeom];
+            poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
+            poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
+        }
+
+        if (m_eGeomOp == GEOMOP_SEGMENTIZE)
+        {
+            if (m_dfGeomOpParam > 0)
+                poDstGeometry->segmentize(m_dfGeomOpParam);
+        }
+        else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
+        {
+            if (m_dfGeomOpParam > 0)
+            {
+                OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
+                if (poNewGeom)
+                {
+                    delete poDstGeometry;
+                    poDstGeometry = poNewGeom;
+                }
+            }
+        }
+
+        if (m_poClipSrc)
+        {
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
+            delete poDstGeometry;
+            if (poClipped == nullptr || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                return TRANSLATE_GEOM_SKIPPED;
+            }
+            poDstGeometry = poClipped;
+        }
+
+        OGRCoordinateTransformation* poCT = papoCT[iGeom];
+        if( !m_bTransform )
+            poCT = m_poGCPCoordTrans;
+        char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
+
+        if( poCT != nullptr || papszTransformOptions != nullptr)
+        {
+            OGRGeometry* poReprojectedGeom =
+                OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
+            if( poReprojectedGeom == nullptr )
+            {
+                *pbReprojFailed = true;
+                CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
+                          poFeature->GetFID() );
+                if( !bSkipFailures )
+                {
+                    delete poDstGeometry;
+                    return TRANSLATE_GEOM_FAILED;
+                }
+            }
+
+            delete poDstGeometry;
+            poDstGeometry = poReprojectedGeom;
+        }
+        else if (poOutputSRS != nullptr)
+        {
+            poDstGeometry->assignSpatialReference(poOutputSRS);
+        }
+
+        if (m_poClipDst)
+        {
+            if( poDstGeometry == nullptr )
+                return TRANSLATE_GEOM_SKIPPED;
+
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
+            delete poDstGeometry;
+            if (poClipped == nullptr || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                return TRANSLATE_GEOM_SKIPPED;
+            }
+
+            poDstGeometry = poClipped;
+        }
+
+        if( eGType != GEOMTYPE_UNCHANGED )
+        {
+            poDstGeometry = OGRGeometryFactory::forceTo(
+                    poDstGeometry, (OGRwkbGeometryType)eGType);
+        }
+        else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
+        {
+            if( poDstGeometry != nullptr )
+            {
+                OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
+                eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
+                poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
+            }
+        }
+
+        poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+    }
+
+    return TRANSLATE_GEOM_OK;
+}
+
+/************************************************************************/
+/*                       OGR2OGRFeaturePipeline                         */
+/*                                                                      */
+/*      Used by -threads.  Source features are read in batches by the  */
+/*      calling thread, and their geometries are translated by a pool  */
+/*      of worker threads while the previous batch is being written.   */
+/*      Features are returned in their reading order.                  */
+/************************************************************************/
+
+class OGR2OGRFeaturePipeline
+{
+    struct Job
+    {
+        OGR2OGRFeaturePipeline *poPipeline;
+        size_t                  nStart;
+        size_t                  nEnd;
+        int                     iSlice;
+        std::vector<TranslatedFeatureError>* paoErrors;
+    };
+
+    LayerTranslator              *m_poTranslator;
+    TargetLayerInfo              *m_psInfo;
+    OGRSpatialReference          *m_poOutputSRS;
+    bool                          m_bSkipFailures;
+    GIntBig                       m_nMaxFeatures;
+    GIntBig                       m_nFeaturesRead;
+    size_t                        m_nBatchSize;
+    bool                          m_bEOF;
+    bool                          m_bReadError;
+    bool                          m_bPending;
+    size_t                        m_iNext;
+    CPLWorkerThreadPool           m_oPool;
+    std::vector<OGRwkbGeometryType> m_aeDstGeomTypes;
+    std::vector<std::vector<OGRCoordinateTransformation*> > m_aapoCT;
+    std::vector<TranslatedFeature> m_asReady;
+    std::vector<TranslatedFeature> m_asPending;
+    std::vector<Job>              m_asJobs;
+
+    static void CPL_STDCALL CollectErrorHandler( CPLErr eErr,
+                                                CPLErrorNum nNo,
+                                                const char* pszMsg );
+    static void ProcessJob( void* pData );
+    void        ReadAndSubmitBatch();
+
+    OGR2OGRFeaturePipeline( LayerTranslator* poTranslator,
+                            TargetLayerInfo* psInfo,
+                            OGRSpatialReference* poOutputSRS,
+                            bool bSkipFailures,
+                            GIntBig nMaxFeatures );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGR2OGRFeaturePipeline)
+
+  public:
+    ~OGR2OGRFeaturePipeline();
+
+    static OGR2OGRFeaturePipeline* Create( LayerTranslator* poTranslator,
+                                           TargetLayerInfo* psInfo,
+                                           OGRSpatialReference* poOutputSRS,
+                                           bool bSkipFailures,
+                                           GIntBig nMaxFeatures,
+                                           int nThreads );
+
+    bool        GetNext( TranslatedFeature* psFeature );
+    bool        HasReadError() const { return m_bReadError; }
+};
+
+/************************************************************************/
+/*                       OGR2OGRFeaturePipeline()                       */
+/************************************************************************/
+
+OGR2OGRFeaturePipeline::OGR2OGRFeaturePipeline(
+                                        LayerTranslator* poTranslator,
+                                        TargetLayerInfo* psInfo,
+                                        OGRSpatialReference* poOutputSRS,
+                                        bool bSkipFailures,
+                                        GIntBig nMaxFeatures ) :
+    m_poTranslator(poTranslator),
+    m_psInfo(psInfo),
+    m_poOutputSRS(poOutputSRS),
+    m_bSkipFailures(bSkipFailures),
+    m_nMaxFeatures(nMaxFeatures),
+    m_nFeaturesRead(0),
+    m_nBatchSize(0),
+    m_bEOF(false),
+    m_bReadError(false),
+    m_bPending(false),
+    m_iNext(0)
+{
+}
+
+/************************************************************************/
+/*                      ~OGR2OGRFeaturePipeline()                       */
+/************************************************************************/
+
+OGR2OGRFeaturePipeline::~OGR2OGRFeaturePipeline()
+{
+    if( m_bPending )
+        m_oPool.WaitCompletion();
+
+    for( size_t i = m_iNext; i < m_asReady.size(); i++ )
+    {
+        OGRFeature::DestroyFeature( m_asReady[i].poSrcFeature );
+        OGRFeature::DestroyFeature( m_asReady[i].poDstFeature );
+    }
+    for( size_t i = 0; i < m_asPending.size(); i++ )
+    {
+        OGRFeature::DestroyFeature( m_asPending[i].poSrcFeature );
+        OGRFeature::DestroyFeature( m_asPending[i].poDstFeature );
+    }
+    for( size_t i = 0; i < m_aapoCT.size(); i++ )
+    {
+        for( size_t j = 0; j < m_aapoCT[i].size(); j++ )
+            OGRCoordinateTransformation::DestroyCT( m_aapoCT[i][j] );
+    }
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+OGR2OGRFeaturePipeline* OGR2OGRFeaturePipeline::Create(
+                                        LayerTranslator* poTranslator,
+                                        TargetLayerInfo* psInfo,
+                                        OGRSpatialReference* poOutputSRS,
+                                        bool bSkipFailures,
+                                        GIntBig nMaxFeatures,
+                                        int nThreads )
+{
+    OGR2OGRFeaturePipeline* poPipeline = new OGR2OGRFeaturePipeline(
+        poTranslator, psInfo, poOutputSRS, bSkipFailures, nMaxFeatures);
+
+    // The target layer is only accessed by the calling thread, so the
+    // geometry field types needed by the workers are fetched now.
+    OGRFeatureDefn* poDstDefn = psInfo->poDstLayer->GetLayerDefn();
+    const int nDstGeomFieldCount = poDstDefn->GetGeomFieldCount();
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+    {
+        poPipeline->m_aeDstGeomTypes.push_back(
+            poDstDefn->GetGeomFieldDefn(iGeom)->GetType());
+    }
+
+    // Coordinate transformations are not thread-safe, so each worker
+    // gets its own copy.
+    poPipeline->m_aapoCT.resize(nThreads);
+    for( int iSlice = 0; iSlice < nThreads; iSlice++ )
+    {
+        for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+        {
+            OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
+            if( poCT != nullptr )
+            {
+                poCT = OGRCreateCoordinateTransformation(
+                    poCT->GetSourceCS(), poCT->GetTargetCS());
+                if( poCT == nullptr )
+                {
+                    delete poPipeline;
+                    return nullptr;
+                }
+            }
+            poPipeline->m_aapoCT[iSlice].push_back(poCT);
+        }
+    }
+
+    if( !poPipeline->m_oPool.Setup(nThreads, nullptr, nullptr) )
+    {
+        delete poPipeline;
+        return nullptr;
+    }
+
+    poPipeline->m_nBatchSize = static_cast<size_t>(nThreads) * 512;
+    poPipeline->m_asJobs.resize(nThreads);
+
+    return poPipeline;
+}
+
+/************************************************************************/
+/*                        CollectErrorHandler()                         */
+/*                                                                      */
+/*      Installed in the worker threads, which do not see the error    */
+/*      handler of the calling thread.  Errors are attached to the     */
+/*      feature being translated and emitted again by the caller.      */
+/************************************************************************/
+
+void CPL_STDCALL OGR2OGRFeaturePipeline::CollectErrorHandler(
+                                                    CPLErr eErr,
+                                                    CPLErrorNum nNo,
+                                                    const char* pszMsg )
+{
+    Job* psJob = static_cast<Job*>(CPLGetErrorHandlerUserData());
+    TranslatedFeatureError sError;
+    sError.eErr = eErr;
+    sError.nNo = nNo;
+    sError.osMsg = pszMsg;
+    psJob->paoErrors->push_back(sError);
+}
+
+/************************************************************************/
+/*                             ProcessJob()                             */
+/************************************************************************/
+
+void OGR2OGRFeaturePipeline::ProcessJob( void* pData )
+{
+    Job* psJob = static_cast<Job*>(pData);
+    OGR2OGRFeaturePipeline* poPipeline = psJob->poPipeline;
+    OGRCoordinateTransformation** papoCT =
+        poPipeline->m_aapoCT[psJob->iSlice].empty() ? nullptr :
+        &(poPipeline->m_aapoCT[psJob->iSlice][0]);
+
+    CPLPushErrorHandlerEx(CollectErrorHandler, psJob);
+    // Debug messages are not deferred.
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    for( size_t i = psJob->nStart; i < psJob->nEnd; i++ )
+    {
+        TranslatedFeature& sFeature = poPipeline->m_asPending[i];
+        if( !sFeature.bAttributesTranslated )
+            continue;
+        psJob->paoErrors = &sFeature.aoErrors;
+        sFeature.eGeomStatus = poPipeline->m_poTranslator->TranslateGeometries(
+            poPipeline->m_psInfo, sFeature.poSrcFeature, sFeature.poDstFeature,
+            0, 0, papoCT, poPipeline->m_poOutputSRS,
+            poPipeline->m_aeDstGeomTypes,
+            poPipeline->m_bSkipFailures, &sFeature.bReprojFailed);
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                         ReadAndSubmitBatch()                         */
+/************************************************************************/
+
+void OGR2OGRFeaturePipeline::ReadAndSubmitBatch()
+{
+    CPLAssert( !m_bPending && m_asPending.empty() );
+
+    OGRLayer* poSrcLayer = m_psInfo->poSrcLayer;
+    OGRFeatureDefn* poDstDefn = m_psInfo->poDstLayer->GetLayerDefn();
+    while( !m_bEOF && m_asPending.size() < m_nBatchSize )
+    {
+        if( m_nMaxFeatures >= 0 && m_nFeaturesRead >= m_nMaxFeatures )
+        {
+            m_bEOF = true;
+            break;
+        }
+
+        CPLErrorReset();
+        TranslatedFeature sFeature;
+        sFeature.poSrcFeature = poSrcLayer->GetNextFeature();
+        if( sFeature.poSrcFeature == nullptr )
+        {
+            m_bReadError = CPLGetLastErrorType() == CE_Failure;
+            m_bEOF = true;
+            break;
+        }
+        m_nFeaturesRead++;
+
+        // Attribute translation is done here rather than in the workers,
+        // since it depends on the target layer definition that the
+        // writer may update.
+        sFeature.poDstFeature = OGRFeature::CreateFeature( poDstDefn );
+        sFeature.bAttributesTranslated = m_poTranslator->TranslateAttributes(
+            m_psInfo, sFeature.poSrcFeature, sFeature.poDstFeature );
+        m_asPending.push_back(sFeature);
+    }
+
+    if( m_asPending.empty() )
+        return;
+
+    const size_t nSlices = m_asJobs.size();
+    const size_t nPerSlice = (m_asPending.size() + nSlices - 1) / nSlices;
+    std::vector<void*> apJobs;
+    for( size_t iSlice = 0; iSlice < nSlices; iSlice++ )
+    {
+        Job& sJob = m_asJobs[iSlice];
+        sJob.poPipeline = this;
+        sJob.iSlice = static_cast<int>(iSlice);
+        sJob.paoErrors = nullptr;
+        sJob.nStart = std::min(iSlice * nPerSlice, m_asPending.size());
+        sJob.nEnd = std::min(sJob.nStart + nPerSlice, m_asPending.size());
+        if( sJob.nStart < sJob.nEnd )
+            apJobs.push_back(&sJob);
+    }
+    m_oPool.SubmitJobs(ProcessJob, apJobs);
+    m_bPending = true;
+}
+
+/************************************************************************/
+/*                              GetNext()                               */
+/*                                                                      */
+/*      Ownership of the returned source and target features is         */
+/*      transferred to the caller, which must also report the errors    */
+/*      emitted by the workers.                                         */
+/************************************************************************/
+
+bool OGR2OGRFeaturePipeline::GetNext( TranslatedFeature* psFeature )
+{
+    if( m_iNext == m_asReady.size() )
+    {
+        m_asReady.clear();
+        m_iNext = 0;
+
+        if( !m_bPending )
+            ReadAndSubmitBatch();
+        if( !m_bPending )
+            return false;
+
+        m_oPool.WaitCompletion();
+        m_bPending = false;
+        std::swap(m_asReady, m_asPending);
+
+        // Start translating the next batch while this one is written.
+        ReadAndSubmitBatch();
+    }
+
+    *psFeature = m_asReady[m_iNext];
+    m_asReady[m_iNext].poSrcFeature = nullptr;
+    m_asReady[m_iNext].poDstFeature = nullptr;
+    m_iNext++;
+    return true;
+}
+
 /************************************************************************/
 /*                     LayerTranslator::Translate()                     */
 /************************************************************************/
@@ -4333,17 +4937,20 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                                 void *pProgressArg,
                                 GDALVectorTranslateOptions *psOptions )
 {
-    const int eGType = m_eGType;
     OGRSpatialReference* poOutputSRS = m_poOutputSRS;
 
     OGRLayer *poSrcLayer = psInfo->poSrcLayer;
     OGRLayer *poDstLayer = psInfo->poDstLayer;
-    int* const panMap = psInfo->panMap;
-    const int iSrcZField = psInfo->iSrcZField;
     const bool bPreserveFID = psInfo->bPreserveFID;
     const int nSrcGeomFieldCount = poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
     const int nDstGeomFieldCount = poDstLayer->GetLayerDefn()->GetGeomFieldCount();
     const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
+    std::vector<OGRwkbGeometryType> aeDstGeomTypes;
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+    {
+        aeDstGeomTypes.push_back(
+            poDstLayer->GetLayerDefn()->GetGeomFieldDefn(iGeom)->GetType());
+    }
 
     if( poOutputSRS == nullptr && !m_bNullifyOutputSRS )
     {
@@ -4375,6 +4982,19 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
     GIntBig      nCount = 0; /* written + failed */
     GIntBig      nFeaturesWritten = 0;
 
+    /* When iterating over the whole layer, the same source feature is */
+    /* filled by each GetNextFeatureInto() call to save allocations. */
+    OGRFeature *poReusedFeature = nullptr;
+    if( poFeatureIn == nullptr && psOptions->nFIDToFetch == OGRNullFID )
+        poReusedFeature = new OGRFeature( poSrcLayer->GetLayerDefn() );
+
+    /* With -threads, once the coordinate transformations are set up from */
+    /* the first feature, geometries are translated by worker threads. */
+    std::unique_ptr<OGR2OGRFeaturePipeline> poPipeline;
+    bool bPipelineChecked = m_nThreads <= 1 || poReusedFeature == nullptr ||
+        bExplodeCollections || psInfo->bPerFeatureCT ||
+        (!m_bTransform && m_poGCPCoordTrans != nullptr);
+
     bool bRet = true;
     CPLErrorReset();
     while( true )
@@ -4384,16 +5004,41 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
             break;
         }
 
+        if( !bPipelineChecked && psInfo->nFeaturesRead > 0 )
+        {
+            bPipelineChecked = true;
+            poPipeline.reset(OGR2OGRFeaturePipeline::Create(
+                this, psInfo, poOutputSRS, psOptions->bSkipFailures,
+                m_nLimit >= 0 ? m_nLimit - psInfo->nFeaturesRead : -1,
+                m_nThreads));
+            if( poPipeline )
+            {
+                delete poReusedFeature;
+                poReusedFeature = nullptr;
+            }
+        }
+
+        TranslatedFeature sTranslated;
         if( poFeatureIn != nullptr )
             poFeature = poFeatureIn;
         else if( psOptions->nFIDToFetch != OGRNullFID )
             poFeature = poSrcLayer->GetFeature(psOptions->nFIDToFetch);
+        else if( poPipeline )
+        {
+            if( poPipeline->GetNext(&sTranslated) )
+                poFeature = sTranslated.poSrcFeature;
+            else
+                poFeature = nullptr;
+        }
+        else if( poSrcLayer->GetNextFeatureInto(poReusedFeature) )
+            poFeature = poReusedFeature;
         else
-            poFeature = poSrcLayer->GetNextFeature();
+            poFeature = nullptr;
 
         if( poFeature == nullptr )
         {
-            if( CPLGetLastErrorType() == CE_Failure )
+            if( CPLGetLastErrorType() == CE_Failure ||
+                (poPipeline && poPipeline->HasReadError()) )
             {
                 bRet = false;
             }
@@ -4461,24 +5106,40 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
             }
 
             CPLErrorReset();
-            poDstFeature = OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
-
-            /* Optimization to avoid duplicating the source geometry in the */
-            /* target feature : we steal it from the source feature for now... */
-            OGRGeometry* poStolenGeometry = nullptr;
-            if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
-                nDstGeomFieldCount == 1 )
+            if( sTranslated.poDstFeature == nullptr )
             {
-                poStolenGeometry = poFeature->StealGeometry();
+                sTranslated.poDstFeature =
+                    OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
+                sTranslated.bAttributesTranslated =
+                    TranslateAttributes( psInfo, poFeature,
+                                         sTranslated.poDstFeature );
+                sTranslated.eGeomStatus = TRANSLATE_GEOM_OK;
+                sTranslated.bReprojFailed = false;
+                if( sTranslated.bAttributesTranslated )
+                {
+                    sTranslated.eGeomStatus = TranslateGeometries(
+                        psInfo, poFeature, sTranslated.poDstFeature,
+                        nParts, iPart, psInfo->papoCT, poOutputSRS,
+                        aeDstGeomTypes, psOptions->bSkipFailures,
+                        &sTranslated.bReprojFailed );
+                }
             }
-            else if( !bExplodeCollections &&
-                     psInfo->iRequestedSrcGeomField >= 0 )
+            else
             {
-                poStolenGeometry = poFeature->StealGeometry(
-                    psInfo->iRequestedSrcGeomField);
+                // Report the errors of the worker threads to the error
+                // handler of this thread, as the serial path would.
+                for( size_t i = 0; i < sTranslated.aoErrors.size(); i++ )
+                {
+                    CPLError( sTranslated.aoErrors[i].eErr,
+                              sTranslated.aoErrors[i].nNo, "%s",
+                              sTranslated.aoErrors[i].osMsg.c_str() );
+                }
+                sTranslated.aoErrors.clear();
             }
+            poDstFeature = sTranslated.poDstFeature;
+            sTranslated.poDstFeature = nullptr;
 
-            if( poDstFeature->SetFrom( poFeature, panMap, TRUE ) != OGRERR_NONE )
+            if( !sTranslated.bAttributesTranslated )
             {
                 if( psOptions->nGroupTransactions )
                 {
@@ -4488,7 +5149,6 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                         {
                             OGRFeature::DestroyFeature( poFeature );
                             OGRFeature::DestroyFeature( poDstFeature );
-                            OGRGeometryFactory::destroyGeometry( poStolenGeometry );
                             return false;
                         }
                     }
@@ -4500,184 +5160,35 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
 
                 OGRFeature::DestroyFeature( poFeature );
                 OGRFeature::DestroyFeature( poDstFeature );
-                OGRGeometryFactory::destroyGeometry( poStolenGeometry );
                 return false;
             }
 
-            /* ... and now we can attach the stolen geometry */
-            if( poStolenGeometry )
+            if( sTranslated.bReprojFailed )
             {
-                poDstFeature->SetGeometryDirectly(poStolenGeometry);
-            }
-
-            if( bPreserveFID )
-                poDstFeature->SetFID( poFeature->GetFID() );
-            else if( psInfo->iSrcFIDField >= 0 &&
-                     poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField))
-                poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
-
-            /* Erase native data if asked explicitly */
-            if( !m_bNativeData )
-            {
-                poDstFeature->SetNativeData(nullptr);
-                poDstFeature->SetNativeMediaType(nullptr);
-            }
-
-            for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
-            {
-                OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
-                if (poDstGeometry == nullptr)
-                    continue;
-
-                if (nParts > 0)
-                {
-                    /* For -explodecollections, extract the iPart(th) of the geometry */
-                    OGRGeometry* poPart = ((OGRGeometryCollection*)poDstGeometry)->getGeometryRef(iPart);
-                    ((OGRGeometryCollection*)poDstGeometry)->removeGeometry(iPart, FALSE);
-                    delete poDstGeometry;
-                    poDstGeometry = poPart;
-                }
-
-                if (iSrcZField != -1)
-                {
-                    SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
-                    /* This will correct the coordinate dimension to 3 */
-                    OGRGeometry* poDupGeometry = poDstGeometry->clone();
-                    delete poDstGeometry;
-                    poDstGeometry = poDupGeometry;
-                }
-
-                if (m_nCoordDim == 2 || m_nCoordDim == 3)
-                {
-                    poDstGeometry->setCoordinateDimension( m_nCoordDim );
-                }
-                else if (m_nCoordDim == 4)
-                {
-                    poDstGeometry->set3D( TRUE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if (m_nCoordDim == COORD_DIM_XYM)
-                {
-                    poDstGeometry->set3D( FALSE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
-                {
-                    const OGRwkbGeometryType eDstLayerGeomType =
-                      poDstLayer->GetLayerDefn()->GetGeomFieldDefn(iGeom)->GetType();
-                    poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
-                    poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
-                }
-
-                if (m_eGeomOp == GEOMOP_SEGMENTIZE)
-                {
-                    if (m_dfGeomOpParam > 0)
-                        poDstGeometry->segmentize(m_dfGeomOpParam);
-                }
-                else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
-                {
-                    if (m_dfGeomOpParam > 0)
-                    {
-                        OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
-                        if (poNewGeom)
-                        {
-                            delete poDstGeometry;
-                            poDstGeometry = poNewGeom;
-                        }
-                    }
-                }
-
-                if (m_poClipSrc)
-                {
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
-                    delete poDstGeometry;
-                    if (poClipped == nullptr || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
-                    poDstGeometry = poClipped;
-                }
-
-                OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
-                if( !m_bTransform )
-                    poCT = m_poGCPCoordTrans;
-                char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
-
-                if( poCT != nullptr || papszTransformOptions != nullptr)
+                if( psOptions->nGroupTransactions )
                 {
-                    OGRGeometry* poReprojectedGeom =
-                        OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
-                    if( poReprojectedGeom == nullptr )
+                    if( psOptions->nLayerTransaction )
                     {
-                        if( psOptions->nGroupTransactions )
-                        {
-                            if( psOptions->nLayerTransaction )
-                            {
-                                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
-                                    !psOptions->bSkipFailures )
-                                {
-                                    OGRFeature::DestroyFeature( poFeature );
-                                    OGRFeature::DestroyFeature( poDstFeature );
-                                    delete poDstGeometry;
-                                    return false;
-                                }
-                            }
-                        }
-
-                        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
-                                  poFeature->GetFID() );
-                        if( !psOptions->bSkipFailures )
+                        if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
+                            !psOptions->bSkipFailures )
                         {
                             OGRFeature::DestroyFeature( poFeature );
                             OGRFeature::DestroyFeature( poDstFeature );
-                            delete poDstGeometry;
                             return false;
                         }
                     }
-
-                    delete poDstGeometry;
-                    poDstGeometry = poReprojectedGeom;
-                }
-                else if (poOutputSRS != nullptr)
-                {
-                    poDstGeometry->assignSpatialReference(poOutputSRS);
-                }
-
-                if (m_poClipDst)
-                {
-                    if( poDstGeometry == nullptr )
-                        goto end_loop;
-
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
-                    delete poDstGeometry;
-                    if (poClipped == nullptr || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
-
-                    poDstGeometry = poClipped;
-                }
-
-                if( eGType != GEOMTYPE_UNCHANGED )
-                {
-                    poDstGeometry = OGRGeometryFactory::forceTo(
-                            poDstGeometry, (OGRwkbGeometryType)eGType);
-                }
-                else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
-                {
-                    if( poDstGeometry != nullptr )
-                    {
-                        OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
-                        eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
-                        poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
-                    }
                 }
+            }
 
-                poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+            if( sTranslated.eGeomStatus == TRANSLATE_GEOM_FAILED )
+            {
+                OGRFeature::DestroyFeature( poFeature );
+                OGRFeature::DestroyFeature( poDstFeature );
+                return false;
+            }
+            else if( sTranslated.eGeomStatus == TRANSLATE_GEOM_SKIPPED )
+            {
+                goto end_loop;
             }
 
             CPLErrorReset();
@@ -4731,7 +5242,8 @@ end_loop:
             OGRFeature::DestroyFeature( poDstFeature );
         }
 
-        OGRFeature::DestroyFeature( poFeature );
+        if( poFeature != poReusedFeature )
+            OGRFeature::DestroyFeature( poFeature );
 
         /* Report progress */
         nCount ++;
@@ -4755,6 +5267,8 @@ end_loop:
             break;
     }
 
+    delete poReusedFeature;
+
     if( psOptions->nGroupTransactions )
     {
         if( psOptions->nLayerTransaction )
@@ -4874,6 +5388,7 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
     psOptions->hSpatialFilter = nullptr;
     psOptions->bNativeData = true;
     psOptions->nLimit = -1;
+    psOptions->nThreads = 1;
 
     int nArgc = CSLCount(papszArgv);
     for( int i = 0; papszArgv != nullptr && i < nArgc; i++ )
@@ -5453,6 +5968,21 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
         {
             psOptions->nLimit = CPLAtoGIntBig( papszArgv[++i] );
         }
+        else if( i+1 < nArgc && EQUAL(papszArgv[i],"-threads") )
+        {
+            ++i;
+            if( EQUAL(papszArgv[i], "ALL_CPUS") )
+                psOptions->nThreads = CPLGetNumCPUs();
+            else
+                psOptions->nThreads = atoi(papszArgv[i]);
+            if( psOptions->nThreads < 1 )
+            {
+                CPLError(CE_Failure, CPLE_IllegalArg,
+                         "-threads %s: invalid value.", papszArgv[i]);
+                GDALVectorTranslateOptionsFree(psOptions);
+                return nullptr;
+            }
+        }
         else if( papszArgv[i][0] == '-' )
         {
             CPLError(CE_Failure, CPLE_NotSupported,
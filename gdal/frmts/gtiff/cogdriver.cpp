@@ -0,0 +1,591 @@
+/******************************************************************************
+ *
+ * Project:  GeoTIFF Driver
+ * Purpose:  Cloud optimized GeoTIFF generation, on top of the GTiff driver.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+#include <cstring>
+
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_progress.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "gdal.h"
+#include "gdal_frmts.h"
+#include "gdal_priv.h"
+#include "gdal_proxy.h"
+#include "gtiff.h"
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          COGProxyRasterBand                          */
+/* ==================================================================== */
+/*                                                                      */
+/*      Band forwarding everything to a source band, except the         */
+/*      overviews and the mask which can be taken from other datasets   */
+/*      (the temporary overview files).                                 */
+/************************************************************************/
+
+class COGProxyRasterBand final: public GDALProxyRasterBand
+{
+    GDALRasterBand*              poUnderlyingBand;
+    std::vector<GDALRasterBand*> apoOverviewBands;
+    GDALRasterBand*              poMaskBand;
+
+  protected:
+    GDALRasterBand* RefUnderlyingRasterBand() override
+        { return poUnderlyingBand; }
+
+  public:
+    COGProxyRasterBand( GDALRasterBand* poUnderlyingBandIn,
+                        const std::vector<GDALRasterBand*>& apoOverviewBandsIn,
+                        GDALRasterBand* poMaskBandIn );
+
+    int GetOverviewCount() override
+        { return static_cast<int>(apoOverviewBands.size()); }
+    GDALRasterBand *GetOverview( int i ) override;
+
+    GDALRasterBand *GetMaskBand() override;
+    int GetMaskFlags() override;
+};
+
+/************************************************************************/
+/*                         COGProxyRasterBand()                         */
+/************************************************************************/
+
+COGProxyRasterBand::COGProxyRasterBand(
+                        GDALRasterBand* poUnderlyingBandIn,
+                        const std::vector<GDALRasterBand*>& apoOverviewBandsIn,
+                        GDALRasterBand* poMaskBandIn ) :
+    poUnderlyingBand(poUnderlyingBandIn),
+    apoOverviewBands(apoOverviewBandsIn),
+    poMaskBand(poMaskBandIn)
+{
+    nRasterXSize = poUnderlyingBand->GetXSize();
+    nRasterYSize = poUnderlyingBand->GetYSize();
+    eDataType = poUnderlyingBand->GetRasterDataType();
+    poUnderlyingBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+}
+
+/************************************************************************/
+/*                            GetOverview()                             */
+/************************************************************************/
+
+GDALRasterBand* COGProxyRasterBand::GetOverview( int i )
+{
+    if( i < 0 || i >= static_cast<int>(apoOverviewBands.size()) )
+        return nullptr;
+    return apoOverviewBands[i];
+}
+
+/************************************************************************/
+/*                            GetMaskBand()                             */
+/************************************************************************/
+
+GDALRasterBand* COGProxyRasterBand::GetMaskBand()
+{
+    if( poMaskBand )
+        return poMaskBand;
+    return poUnderlyingBand->GetMaskBand();
+}
+
+/************************************************************************/
+/*                            GetMaskFlags()                            */
+/************************************************************************/
+
+int COGProxyRasterBand::GetMaskFlags()
+{
+    if( poMaskBand )
+        return GMF_PER_DATASET;
+    return poUnderlyingBand->GetMaskFlags();
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                            COGProxyDataset                           */
+/* ==================================================================== */
+/************************************************************************/
+
+class COGProxyDataset final: public GDALProxyDataset
+{
+    GDALDataset* poUnderlyingDS;
+
+  protected:
+    GDALDataset* RefUnderlyingDataset() override { return poUnderlyingDS; }
+
+  public:
+    explicit COGProxyDataset( GDALDataset* poUnderlyingDSIn );
+
+    void AppendBand( GDALRasterBand* poBand ) { SetBand(nBands + 1, poBand); }
+};
+
+/************************************************************************/
+/*                           COGProxyDataset()                          */
+/************************************************************************/
+
+COGProxyDataset::COGProxyDataset( GDALDataset* poUnderlyingDSIn ) :
+    poUnderlyingDS(poUnderlyingDSIn)
+{
+    nRasterXSize = poUnderlyingDS->GetRasterXSize();
+    nRasterYSize = poUnderlyingDS->GetRasterYSize();
+    SetDescription( poUnderlyingDS->GetDescription() );
+}
+
+/************************************************************************/
+/*                        COGGetOverviewBands()                         */
+/*                                                                      */
+/*      The first band of a file created by GTIFFBuildOverviews() is    */
+/*      the first overview level, and its overviews the next levels.    */
+/************************************************************************/
+
+static std::vector<GDALRasterBand*> COGGetOverviewBands( GDALDataset* poOvrDS,
+                                                         int iBand )
+{
+    std::vector<GDALRasterBand*> apoBands;
+    GDALRasterBand* poBand = poOvrDS->GetRasterBand(iBand);
+    apoBands.push_back(poBand);
+    for( int i = 0; i < poBand->GetOverviewCount(); ++i )
+        apoBands.push_back(poBand->GetOverview(i));
+    return apoBands;
+}
+
+/************************************************************************/
+/*                         COGSetConfigOption()                         */
+/*                                                                      */
+/*      Set a thread local configuration option, and return its         */
+/*      previous value so that it can be restored.                      */
+/************************************************************************/
+
+static CPLString COGSetConfigOption( const char* pszKey, const char* pszValue,
+                                     bool& bWasSet )
+{
+    const char* pszOld = CPLGetThreadLocalConfigOption(pszKey, nullptr);
+    bWasSet = pszOld != nullptr;
+    CPLString osOld(pszOld ? pszOld : "");
+    CPLSetThreadLocalConfigOption(pszKey, pszValue);
+    return osOld;
+}
+
+static void COGRestoreConfigOption( const char* pszKey,
+                                    const CPLString& osOld, bool bWasSet )
+{
+    CPLSetThreadLocalConfigOption(pszKey, bWasSet ? osOld.c_str() : nullptr);
+}
+
+/************************************************************************/
+/*                         COGBuildOverviews()                          */
+/*                                                                      */
+/*      Compute in a single pass over the source all the overview       */
+/*      levels into a temporary TIFF file, and return it opened.        */
+/************************************************************************/
+
+static GDALDataset* COGBuildOverviews( const CPLString& osTmpFilename,
+                                       int nBands, GDALRasterBand** papoBands,
+                                       std::vector<int>& anOverviewList,
+                                       const char* pszResampling,
+                                       GDALProgressFunc pfnProgress,
+                                       void* pProgressData )
+{
+    // The temporary file is read back just once: a fast lossless
+    // compression is enough, and avoids degrading lossy outputs twice.
+    bool bWasSet = false;
+    const CPLString osOld =
+        COGSetConfigOption("COMPRESS_OVERVIEW", "LZW", bWasSet);
+    const CPLErr eErr =
+        GTIFFBuildOverviews( osTmpFilename, nBands, papoBands,
+                             static_cast<int>(anOverviewList.size()),
+                             &anOverviewList[0], pszResampling,
+                             pfnProgress, pProgressData );
+    COGRestoreConfigOption("COMPRESS_OVERVIEW", osOld, bWasSet);
+
+    if( eErr != CE_None )
+        return nullptr;
+    return reinterpret_cast<GDALDataset*>(
+        GDALOpenEx( osTmpFilename, GDAL_OF_RASTER, nullptr, nullptr, nullptr ));
+}
+
+/************************************************************************/
+/*                           COGCreateCopy()                            */
+/************************************************************************/
+
+static GDALDataset* COGCreateCopy( const char * pszFilename,
+                                   GDALDataset *poSrcDS,
+                                   int bStrict, char ** papszOptions,
+                                   GDALProgressFunc pfnProgress,
+                                   void * pProgressData )
+{
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+
+    if( poSrcDS->GetRasterCount() == 0 )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "COG driver does not support zero band datasets." );
+        return nullptr;
+    }
+
+    if( STARTS_WITH(pszFilename, "/vsistdout/") )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "COG driver does not support streamed output." );
+        return nullptr;
+    }
+
+    GDALDriver* poGTiffDriver =
+        reinterpret_cast<GDALDriver*>(GDALGetDriverByName("GTiff"));
+    if( poGTiffDriver == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "GTiff driver not available" );
+        return nullptr;
+    }
+
+    const int nBlockSize =
+        atoi(CSLFetchNameValueDef(papszOptions, "BLOCKSIZE", "512"));
+    if( nBlockSize < 64 || nBlockSize > 4096 ||
+        !CPLIsPowerOfTwo(nBlockSize) )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "BLOCKSIZE should be a power of 2 between 64 and 4096" );
+        return nullptr;
+    }
+
+    const int nXSize = poSrcDS->GetRasterXSize();
+    const int nYSize = poSrcDS->GetRasterYSize();
+    const int nBands = poSrcDS->GetRasterCount();
+    GDALRasterBand* poFirstBand = poSrcDS->GetRasterBand(1);
+
+/* -------------------------------------------------------------------- */
+/*      Decide which overviews will be written: halve the dimensions    */
+/*      until the smallest level fits into a single block.              */
+/* -------------------------------------------------------------------- */
+    const char* pszOverviews =
+        CSLFetchNameValueDef(papszOptions, "OVERVIEWS", "AUTO");
+    const bool bUseSrcOverviews =
+        EQUAL(pszOverviews, "AUTO") && poFirstBand->GetOverviewCount() > 0;
+
+    std::vector<int> anOverviewList;
+    if( !EQUAL(pszOverviews, "NONE") && !bUseSrcOverviews )
+    {
+        int nOvrFactor = 1;
+        while( DIV_ROUND_UP(nXSize, nOvrFactor) > nBlockSize ||
+               DIV_ROUND_UP(nYSize, nOvrFactor) > nBlockSize )
+        {
+            nOvrFactor *= 2;
+            anOverviewList.push_back(nOvrFactor);
+        }
+    }
+
+    const int nMaskFlags = poFirstBand->GetMaskFlags();
+    const bool bHasPerDatasetMask =
+        !(nMaskFlags & (GMF_ALL_VALID|GMF_ALPHA|GMF_NODATA)) &&
+        (nMaskFlags & GMF_PER_DATASET);
+
+    double dfBuildRatio = 0.0;
+    if( !anOverviewList.empty() )
+    {
+        // Overview computation reads the full resolution once, whereas the
+        // copy reads it and the overviews, which add about a third.
+        dfBuildRatio = 1.0 / (1.0 + 4.0 / 3.0);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Compute overviews of the imagery and the mask in temporary      */
+/*      files next to the output.                                       */
+/* -------------------------------------------------------------------- */
+    bool bOvrBlockSizeWasSet = false;
+    const CPLString osOldOvrBlockSize =
+        COGSetConfigOption("GDAL_TIFF_OVR_BLOCKSIZE",
+                           CPLSPrintf("%d", nBlockSize),
+                           bOvrBlockSizeWasSet);
+
+    const CPLString osOvrTmpFilename(CPLString(pszFilename) + ".ovr.tmp");
+    const CPLString osMaskOvrTmpFilename(
+                                CPLString(pszFilename) + ".msk.ovr.tmp");
+    GDALDataset* poOvrDS = nullptr;
+    GDALDataset* poMaskOvrDS = nullptr;
+    bool bOK = true;
+
+    if( !anOverviewList.empty() )
+    {
+        const char* pszResampling = CSLFetchNameValueDef(
+            papszOptions, "RESAMPLING",
+            poFirstBand->GetColorTable() ? "NEAREST" : "CUBIC");
+
+        std::vector<GDALRasterBand*> apoSrcBands;
+        for( int i = 1; i <= nBands; ++i )
+            apoSrcBands.push_back(poSrcDS->GetRasterBand(i));
+
+        const double dfMaskRatio = bHasPerDatasetMask ? 1.0 / (nBands + 1) : 0;
+        void* pScaledData = GDALCreateScaledProgress(
+            0, dfBuildRatio * (1 - dfMaskRatio), pfnProgress, pProgressData );
+        poOvrDS = COGBuildOverviews( osOvrTmpFilename, nBands,
+                                     &apoSrcBands[0], anOverviewList,
+                                     pszResampling,
+                                     GDALScaledProgress, pScaledData );
+        GDALDestroyScaledProgress(pScaledData);
+        bOK = poOvrDS != nullptr;
+
+        if( bOK && bHasPerDatasetMask )
+        {
+            // Keep the mask binary.
+            GDALRasterBand* poMaskBand = poFirstBand->GetMaskBand();
+            pScaledData = GDALCreateScaledProgress(
+                dfBuildRatio * (1 - dfMaskRatio), dfBuildRatio,
+                pfnProgress, pProgressData );
+            poMaskOvrDS = COGBuildOverviews( osMaskOvrTmpFilename, 1,
+                                             &poMaskBand, anOverviewList,
+                                             "NEAREST",
+                                             GDALScaledProgress, pScaledData );
+            GDALDestroyScaledProgress(pScaledData);
+            bOK = poMaskOvrDS != nullptr;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Expose the source with those overviews.                         */
+/* -------------------------------------------------------------------- */
+    COGProxyDataset* poProxyDS = nullptr;
+    // Overview bands wrapping the mask overviews, owned by us.
+    std::vector<COGProxyRasterBand*> apoOvrProxyBands;
+    if( bOK )
+    {
+        poProxyDS = new COGProxyDataset(poSrcDS);
+        std::vector<GDALRasterBand*> apoMaskOverviewBands;
+        if( poMaskOvrDS )
+            apoMaskOverviewBands = COGGetOverviewBands(poMaskOvrDS, 1);
+        for( int i = 1; i <= nBands; ++i )
+        {
+            GDALRasterBand* poSrcBand = poSrcDS->GetRasterBand(i);
+            std::vector<GDALRasterBand*> apoOverviewBands;
+            if( bUseSrcOverviews )
+            {
+                for( int j = 0; j < poSrcBand->GetOverviewCount(); ++j )
+                    apoOverviewBands.push_back(poSrcBand->GetOverview(j));
+            }
+            else if( poOvrDS )
+            {
+                std::vector<GDALRasterBand*> apoOvrBands(
+                    COGGetOverviewBands(poOvrDS, i));
+                for( size_t j = 0; j < apoOvrBands.size(); ++j )
+                {
+                    if( j < apoMaskOverviewBands.size() )
+                    {
+                        // Attach the overview of the mask.
+                        apoOvrProxyBands.push_back(
+                            new COGProxyRasterBand(
+                                apoOvrBands[j],
+                                std::vector<GDALRasterBand*>(),
+                                apoMaskOverviewBands[j]));
+                        apoOverviewBands.push_back(apoOvrProxyBands.back());
+                    }
+                    else
+                    {
+                        apoOverviewBands.push_back(apoOvrBands[j]);
+                    }
+                }
+            }
+            poProxyDS->AppendBand(
+                new COGProxyRasterBand(poSrcBand, apoOverviewBands, nullptr));
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the output with the GTiff driver, in cloud optimized      */
+/*      layout.                                                         */
+/* -------------------------------------------------------------------- */
+    GDALDataset* poDS = nullptr;
+    if( bOK )
+    {
+        const char* pszCompress =
+            CSLFetchNameValueDef(papszOptions, "COMPRESS", "LZW");
+
+        CPLStringList aosOptions;
+        aosOptions.SetNameValue("COMPRESS", pszCompress);
+        aosOptions.SetNameValue("TILED", "YES");
+        aosOptions.SetNameValue("BLOCKXSIZE", CPLSPrintf("%d", nBlockSize));
+        aosOptions.SetNameValue("BLOCKYSIZE", CPLSPrintf("%d", nBlockSize));
+        aosOptions.SetNameValue("COPY_SRC_OVERVIEWS", "YES");
+        aosOptions.SetNameValue("@COG_LAYOUT", "YES");
+        if( EQUAL(pszCompress, "JPEG") && nBands == 3 &&
+            poSrcDS->GetRasterBand(1)->GetColorInterpretation() ==
+                                                            GCI_RedBand )
+        {
+            aosOptions.SetNameValue("PHOTOMETRIC", "YCBCR");
+        }
+        const char* const apszPassThroughOptions[] = {
+            "PREDICTOR", "ZLEVEL", "ZSTD_LEVEL", "LZMA_PRESET",
+            "JPEG_QUALITY", "MAX_Z_ERROR", "WEBP_LEVEL", "WEBP_LOSSLESS",
+            "NUM_THREADS", "BIGTIFF" };
+        for( size_t i = 0; i < CPL_ARRAYSIZE(apszPassThroughOptions); ++i )
+        {
+            const char* pszValue = CSLFetchNameValue(
+                papszOptions, apszPassThroughOptions[i]);
+            if( pszValue )
+                aosOptions.SetNameValue(apszPassThroughOptions[i], pszValue);
+        }
+
+        // The mask must be in the same file as the imagery.
+        bool bInternalMaskWasSet = false;
+        const CPLString osOldInternalMask =
+            COGSetConfigOption("GDAL_TIFF_INTERNAL_MASK", "YES",
+                               bInternalMaskWasSet);
+        void* pScaledData = GDALCreateScaledProgress(
+            dfBuildRatio, 1.0, pfnProgress, pProgressData );
+        poDS = poGTiffDriver->CreateCopy( pszFilename, poProxyDS, bStrict,
+                                          aosOptions.List(),
+                                          GDALScaledProgress, pScaledData );
+        GDALDestroyScaledProgress(pScaledData);
+        COGRestoreConfigOption("GDAL_TIFF_INTERNAL_MASK", osOldInternalMask,
+                               bInternalMaskWasSet);
+    }
+
+    COGRestoreConfigOption("GDAL_TIFF_OVR_BLOCKSIZE", osOldOvrBlockSize,
+                           bOvrBlockSizeWasSet);
+
+/* -------------------------------------------------------------------- */
+/*      Cleanup.                                                        */
+/* -------------------------------------------------------------------- */
+    for( size_t i = 0; i < apoOvrProxyBands.size(); ++i )
+        delete apoOvrProxyBands[i];
+    delete poProxyDS;
+    if( poOvrDS )
+    {
+        GDALClose(poOvrDS);
+        VSIUnlink(osOvrTmpFilename);
+    }
+    if( poMaskOvrDS )
+    {
+        GDALClose(poMaskOvrDS);
+        VSIUnlink(osMaskOvrTmpFilename);
+    }
+    if( poDS == nullptr )
+        return nullptr;
+
+    // Re-open in read-only mode, so that further changes by the caller do
+    // not rewrite the directories at the end of the file.
+    GDALClose(poDS);
+    return reinterpret_cast<GDALDataset*>(
+        GDALOpenEx( pszFilename, GDAL_OF_RASTER, nullptr, nullptr, nullptr ));
+}
+
+/************************************************************************/
+/*                          GDALRegister_COG()                          */
+/************************************************************************/
+
+void GDALRegister_COG()
+
+{
+    if( GDALGetDriverByName( "COG" ) != nullptr )
+        return;
+
+    bool bHasLZW = false;
+    bool bHasDEFLATE = false;
+    bool bHasLZMA = false;
+    bool bHasZSTD = false;
+    bool bHasJPEG = false;
+    bool bHasWebP = false;
+    bool bHasLERC = false;
+    CPLString osCompressValues(
+        GTiffGetCompressValues(bHasLZW, bHasDEFLATE, bHasLZMA, bHasZSTD,
+                               bHasJPEG, bHasWebP, bHasLERC, true));
+
+    CPLString osOptions = "<CreationOptionList>"
+              "   <Option name='COMPRESS' type='string-select' default='LZW'>";
+    osOptions += osCompressValues;
+    osOptions += "   </Option>";
+    if( bHasLZW || bHasDEFLATE )
+        osOptions += ""
+"   <Option name='PREDICTOR' type='int' description='Predictor Type (1=default, 2=horizontal differencing, 3=floating point prediction)'/>";
+    if( bHasJPEG )
+        osOptions += ""
+"   <Option name='JPEG_QUALITY' type='int' description='JPEG quality 1-100' default='75'/>";
+    if( bHasDEFLATE )
+        osOptions += ""
+"   <Option name='ZLEVEL' type='int' description='DEFLATE compression level 1-9' default='6'/>";
+    if( bHasLZMA )
+        osOptions += ""
+"   <Option name='LZMA_PRESET' type='int' description='LZMA compression level 0(fast)-9(slow)' default='6'/>";
+    if( bHasZSTD )
+        osOptions += ""
+"   <Option name='ZSTD_LEVEL' type='int' description='ZSTD compression level 1(fast)-22(slow)' default='9'/>";
+    if( bHasLERC )
+        osOptions += ""
+"   <Option name='MAX_Z_ERROR' type='float' description='Maximum error for LERC compression' default='0'/>";
+    if( bHasWebP )
+        osOptions += ""
+"   <Option name='WEBP_LEVEL' type='int' description='WEBP quality level 1-100' default='75'/>"
+"   <Option name='WEBP_LOSSLESS' type='boolean' description='Whether lossless compression should be used' default='FALSE'/>";
+    osOptions += ""
+"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
+"   <Option name='BLOCKSIZE' type='int' description='Tile size in pixels' default='512'/>"
+"   <Option name='RESAMPLING' type='string-select' description='Resampling method for overviews. Defaults to NEAREST for paletted images, CUBIC otherwise'>"
+"       <Value>NEAREST</Value>"
+"       <Value>AVERAGE</Value>"
+"       <Value>BILINEAR</Value>"
+"       <Value>CUBIC</Value>"
+"       <Value>CUBICSPLINE</Value>"
+"       <Value>LANCZOS</Value>"
+"       <Value>MODE</Value>"
+"   </Option>"
+"   <Option name='OVERVIEWS' type='string-select' description='Behaviour regarding overviews' default='AUTO'>"
+"       <Value>AUTO</Value>"
+"       <Value>IGNORE_EXISTING</Value>"
+"       <Value>NONE</Value>"
+"   </Option>"
+#ifdef BIGTIFF_SUPPORT
+"   <Option name='BIGTIFF' type='string-select' description='Force creation of BigTIFF file'>"
+"     <Value>YES</Value>"
+"     <Value>NO</Value>"
+"     <Value>IF_NEEDED</Value>"
+"     <Value>IF_SAFER</Value>"
+"   </Option>"
+#endif
+"</CreationOptionList>";
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "COG" );
+    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME,
+                               "Cloud optimized GeoTIFF generator" );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "frmt_cog.html" );
+    // No extension declared, so that output format guessing from .tif
+    // keeps selecting the GTiff driver.
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
+                               "Byte UInt16 Int16 UInt32 Int32 Float32 "
+                               "Float64 CInt16 CInt32 CFloat32 CFloat64" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osOptions );
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+
+    poDriver->pfnCreateCopy = COGCreateCopy;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
@@ -56,6 +56,7 @@
 #include <algorithm>
 #include <memory>
 #include <mutex>
+#include <queue>
 #include <set>
 #include <string>
 #include <vector>
@@ -390,6 +391,13 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     bool         bFillEmptyTilesAtClosing;
     void         FillEmptyTiles();
 
+    // Cloud optimized layout: blocks are surrounded by a leader and a
+    // trailer, as advertized in the ghost header.
+    bool         bWriteCOGLayout;
+    vsi_l_offset WriteCOGBlockLeader( int nBlockId );
+    void         WriteCOGBlockTrailer( int nBlockId,
+                                       vsi_l_offset nLeaderOffset );
+
     void         FlushDirectory();
     CPLErr       CleanOverviews();
 
@@ -418,6 +426,10 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     int           nZLevel;
     int           nLZMAPreset;
     int           nZSTDLevel;
+    double        dfMaxZError;
+    int           nLercAddCompression;
+    int           nWebPLevel;
+    bool          bWebPLossless;
     int           nJpegQuality;
     int           nJpegTablesMode;
 
@@ -455,11 +467,14 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
 
     CPLWorkerThreadPool *poCompressThreadPool;
     std::vector<GTiffCompressionJob> asCompressionJobs;
+    // Slots of the submitted jobs, in submission order (COG layout only)
+    std::queue<int> anQueueCOGJobs;
     CPLMutex      *hCompressThreadPoolMutex;
     void           InitCompressionThreads( char** papszOptions );
     void           InitCreationOrOpenOptions( char** papszOptions );
     static void    ThreadCompressionFunc( void* pData );
     void           WaitCompletionForBlock( int nBlockId );
+    void           WaitAndWriteCompressionJob( int iJob );
     void           WriteRawStripOrTile( int nStripOrTile,
                                         GByte* pabyCompressedBuffer,
                                         int nCompressedBufferSize );
@@ -627,11 +642,20 @@ class GTiffJPEGOverviewDS CPL_FINAL : public GDALDataset
     // Valid block id of the parent DS that match poJPEGDS.
     int          nBlockId;
 
+    // Pixel-interleaved decoded content of all bands of nBlockBufId.
+    GByte       *pabyBlockBuf;
+    int          nBlockBufId;
+    bool         bLoadingOtherBands;
+
   public:
     GTiffJPEGOverviewDS( GTiffDataset* poParentDS, int nOverviewLevel,
                          const void* pJPEGTable, int nJPEGTableSize );
     virtual ~GTiffJPEGOverviewDS();
 
+    bool LoadBlockBuf( int nBlockIdIn, GDALDataType eDT,
+                       int nReqXSize, int nReqYSize,
+                       int nBufXSize, int nBufYSize );
+
     virtual CPLErr IRasterIO( GDALRWFlag eRWFlag,
                               int nXOff, int nYOff, int nXSize, int nYSize,
                               void * pData, int nBufXSize, int nBufYSize,
@@ -664,7 +688,10 @@ GTiffJPEGOverviewDS::GTiffJPEGOverviewDS( GTiffDataset* poParentDSIn,
     nJPEGTableSize(nJPEGTableSizeIn),
     pabyJPEGTable(nullptr),
     poJPEGDS(nullptr),
-    nBlockId(-1)
+    nBlockId(-1),
+    pabyBlockBuf(nullptr),
+    nBlockBufId(-1),
+    bLoadingOtherBands(false)
 {
     osTmpFilenameJPEGTable.Printf("/vsimem/jpegtable_%p", this);
 
@@ -712,6 +739,7 @@ GTiffJPEGOverviewDS::~GTiffJPEGOverviewDS()
 {
     if( poJPEGDS != nullptr )
         GDALClose( poJPEGDS );
+    CPLFree(pabyBlockBuf);
     VSIUnlink(osTmpFilenameJPEGTable);
     if( !osTmpFilename.empty() )
         VSIUnlink(osTmpFilename);
@@ -753,6 +781,78 @@ CPLErr GTiffJPEGOverviewDS::IRasterIO(
         psExtraArg );
 }
 
+/************************************************************************/
+/*                            LoadBlockBuf()                            */
+/*                                                                      */
+/*      Decode, for all bands at once, the JPEG strip/tile currently    */
+/*      opened in poJPEGDS directly at the reduced resolution of this   */
+/*      overview, into the pixel-interleaved pabyBlockBuf.  Returns     */
+/*      false if the request cannot be served this way, in which case   */
+/*      the caller must go through the band-per-band path.              */
+/************************************************************************/
+
+bool GTiffJPEGOverviewDS::LoadBlockBuf( int nBlockIdIn, GDALDataType eDT,
+                                        int nReqXSize, int nReqYSize,
+                                        int nBufXSize, int nBufYSize )
+{
+    if( nBlockBufId == nBlockIdIn )
+        return true;
+    nBlockBufId = -1;
+
+    GDALRasterBand* poJPEGBand = poJPEGDS->GetRasterBand(1);
+    if( poJPEGBand->GetOverviewCount() < nOverviewLevel )
+        return false;
+    GDALRasterBand* poOvrBand = poJPEGBand->GetOverview(nOverviewLevel - 1);
+    GDALDataset* poOvrDS = poOvrBand ? poOvrBand->GetDataset() : nullptr;
+    if( poOvrDS == nullptr || poOvrDS->GetRasterCount() != nBands )
+        return false;
+
+    // Only take the shortcut if the requested window maps exactly to the
+    // top-left corner of the scaled JPEG image, so that no resampling is
+    // involved and the result is the one of the generic path.
+    const int nJPEGXSize = poJPEGDS->GetRasterXSize();
+    const int nJPEGYSize = poJPEGDS->GetRasterYSize();
+    const int nOvrXSize = poOvrDS->GetRasterXSize();
+    const int nOvrYSize = poOvrDS->GetRasterYSize();
+    int l_nBlockXSize = 0;
+    int l_nBlockYSize = 0;
+    GetRasterBand(1)->GetBlockSize(&l_nBlockXSize, &l_nBlockYSize);
+    if( nOvrXSize > l_nBlockXSize || nOvrYSize > l_nBlockYSize ||
+        nBufXSize > nOvrXSize || nBufYSize > nOvrYSize ||
+        static_cast<GIntBig>(nReqXSize) * nOvrXSize !=
+            static_cast<GIntBig>(nBufXSize) * nJPEGXSize ||
+        static_cast<GIntBig>(nReqYSize) * nOvrYSize !=
+            static_cast<GIntBig>(nBufYSize) * nJPEGYSize )
+    {
+        return false;
+    }
+
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+    if( pabyBlockBuf == nullptr )
+    {
+        pabyBlockBuf = static_cast<GByte *>(
+            VSI_MALLOC3_VERBOSE(l_nBlockXSize, l_nBlockYSize,
+                                nBands * nDTSize));
+        if( pabyBlockBuf == nullptr )
+            return false;
+    }
+
+    // Reading the whole scaled image in one go lets the JPEG driver
+    // decode the scanlines straight into our buffer.
+    if( poOvrDS->RasterIO( GF_Read, 0, 0, nOvrXSize, nOvrYSize,
+                           pabyBlockBuf, nOvrXSize, nOvrYSize, eDT,
+                           nBands, nullptr,
+                           nBands * nDTSize,
+                           static_cast<GSpacing>(nOvrXSize) * nBands * nDTSize,
+                           nDTSize, nullptr ) != CE_None )
+    {
+        return false;
+    }
+
+    nBlockBufId = nBlockIdIn;
+    return true;
+}
+
 /************************************************************************/
 /*                        GTiffJPEGOverviewBand()                       */
 /************************************************************************/
@@ -817,6 +917,7 @@ CPLErr GTiffJPEGOverviewBand::IReadBlock( int nBlockXOff, int nBlockYOff,
     const int nScaleFactor = 1 << poGDS->nOverviewLevel;
     if( poGDS->poJPEGDS == nullptr || nBlockId != poGDS->nBlockId )
     {
+        poGDS->nBlockBufId = -1;
         if( nByteCount < 2 )
             return CE_Failure;
         nOffset += 2;  // Skip leading 0xFF 0xF8.
@@ -1036,6 +1137,55 @@ CPLErr GTiffJPEGOverviewBand::IReadBlock( int nBlockXOff, int nBlockYOff,
             nBufYSize = poGDS->GetRasterYSize() - nBlockYOff * nBlockYSize;
         }
 
+        // In the pixel-interleaved case, decode the strip/tile once for
+        // all bands, and push the result of the other bands into the block
+        // cache, instead of going through the scanline cache of the JPEG
+        // driver for each band.
+        if( !bIsSingleStripAsSplit &&
+            poGDS->poParentDS->nPlanarConfig == PLANARCONFIG_CONTIG &&
+            poGDS->nBands > 1 &&
+            poGDS->LoadBlockBuf( nBlockId, eDataType, nReqXSize, nReqYSize,
+                                 nBufXSize, nBufYSize ) )
+        {
+            const int nBands = poGDS->nBands;
+            const int nOvrXSize = poGDS->poJPEGDS->GetRasterBand(1)->
+                GetOverview(poGDS->nOverviewLevel - 1)->GetXSize();
+            for( int iY = 0; iY < nBufYSize; ++iY )
+            {
+                GDALCopyWords(
+                    poGDS->pabyBlockBuf +
+                        (static_cast<size_t>(iY) * nOvrXSize * nBands +
+                         nBand - 1) * nDataTypeSize,
+                    eDataType, nBands * nDataTypeSize,
+                    static_cast<GByte *>(pImage) +
+                        static_cast<size_t>(iY) * nBlockXSize * nDataTypeSize,
+                    eDataType, nDataTypeSize,
+                    nBufXSize );
+            }
+
+            eErr = CE_None;
+            if( !poGDS->bLoadingOtherBands )
+            {
+                poGDS->bLoadingOtherBands = true;
+                for( int iOtherBand = 1; iOtherBand <= nBands; ++iOtherBand )
+                {
+                    if( iOtherBand == nBand )
+                        continue;
+                    GDALRasterBlock *poBlock =
+                        poGDS->GetRasterBand(iOtherBand)->
+                            GetLockedBlockRef(nBlockXOff, nBlockYOff);
+                    if( poBlock == nullptr )
+                    {
+                        eErr = CE_Failure;
+                        break;
+                    }
+                    poBlock->DropLock();
+                }
+                poGDS->bLoadingOtherBands = false;
+            }
+            return eErr;
+        }
+
         const int nSrcBand =
             poGDS->poParentDS->nPlanarConfig == PLANARCONFIG_SEPARATE ?
             1 : nBand;
@@ -7300,6 +7450,7 @@ GTiffDataset::GTiffDataset() :
     poBaseDS(nullptr),
     bWriteEmptyTiles(true),
     bFillEmptyTilesAtClosing(false),
+    bWriteCOGLayout(false),
     nLastLineRead(-1),
     nLastBandRead(-1),
     bTreatAsSplit(false),
@@ -7314,6 +7465,10 @@ GTiffDataset::GTiffDataset() :
     nZLevel(-1),
     nLZMAPreset(-1),
     nZSTDLevel(-1),
+    dfMaxZError(0.0),
+    nLercAddCompression(LERC_ADD_COMPRESSION_NONE),
+    nWebPLevel(-1),
+    bWebPLossless(false),
     nJpegQuality(-1),
     nJpegTablesMode(-1),
     bPromoteTo8Bits(false),
@@ -8122,6 +8277,80 @@ inline bool GTiffDataset::IsFirstPixelEqualToNoData( const void* pBuffer )
     return false;
 }
 
+/************************************************************************/
+/*                         WriteCOGBlockLeader()                        */
+/*                                                                      */
+/*      Reserve at end of file the 4 bytes that will hold the size of   */
+/*      a new block.  Returns the offset of the leader, or 0 if the     */
+/*      block needs no leader.                                          */
+/************************************************************************/
+
+vsi_l_offset GTiffDataset::WriteCOGBlockLeader( int nBlockId )
+{
+    if( !bWriteCOGLayout || IsBlockAvailable(nBlockId) )
+        return 0;
+
+    VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF ));
+    if( VSIFSeekL(fp, 0, SEEK_END) != 0 )
+        return 0;
+    const vsi_l_offset nLeaderOffset = VSIFTellL(fp);
+    const GByte abyLeader[4] = { 0, 0, 0, 0 };
+    if( VSIFWriteL(abyLeader, 1, 4, fp) != 4 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write leader of block %d", nBlockId );
+        return 0;
+    }
+    return nLeaderOffset;
+}
+
+/************************************************************************/
+/*                        WriteCOGBlockTrailer()                        */
+/*                                                                      */
+/*      Once a new block has been written just after its leader, store  */
+/*      its size in the leader, and append a copy of its last 4 bytes.  */
+/************************************************************************/
+
+void GTiffDataset::WriteCOGBlockTrailer( int nBlockId,
+                                         vsi_l_offset nLeaderOffset )
+{
+    if( nLeaderOffset == 0 )
+        return;
+
+    vsi_l_offset nOffset = 0;
+    vsi_l_offset nSize = 0;
+    if( !IsBlockAvailable(nBlockId, &nOffset, &nSize) ||
+        nOffset != nLeaderOffset + 4 || nSize > 0xFFFFFFFFU )
+    {
+        CPLDebug( "GTiff", "Block %d not written just after its leader",
+                  nBlockId );
+        return;
+    }
+
+    VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF ));
+    const vsi_l_offset nCurOffset = VSIFTellL(fp);
+
+    GUInt32 nSize32 = static_cast<GUInt32>(nSize);
+    CPL_LSBPTR32(&nSize32);
+
+    GByte abyTrailer[4] = { 0, 0, 0, 0 };
+    const int nTrailerSrcSize = static_cast<int>(std::min<vsi_l_offset>(4, nSize));
+    bool bOK =
+        VSIFSeekL(fp, nLeaderOffset, SEEK_SET) == 0 &&
+        VSIFWriteL(&nSize32, 1, 4, fp) == 4 &&
+        VSIFSeekL(fp, nOffset + nSize - nTrailerSrcSize, SEEK_SET) == 0 &&
+        VSIFReadL(abyTrailer, 1, nTrailerSrcSize, fp) ==
+                                    static_cast<size_t>(nTrailerSrcSize) &&
+        VSIFSeekL(fp, nOffset + nSize, SEEK_SET) == 0 &&
+        VSIFWriteL(abyTrailer, 1, 4, fp) == 4;
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write leader/trailer of block %d", nBlockId );
+    }
+    CPL_IGNORE_RET_VAL(VSIFSeekL(fp, nCurOffset, SEEK_SET));
+}
+
 /************************************************************************/
 /*                        WriteEncodedTile()                            */
 /************************************************************************/
@@ -8285,8 +8514,10 @@ bool GTiffDataset::WriteEncodedTile( uint32 tile, GByte *pabyData,
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     const CPLErr eBefore = CPLGetLastErrorType();
 #endif
+    const vsi_l_offset nLeaderOffset = WriteCOGBlockLeader(tile);
     const bool bRet =
         static_cast<int>(TIFFWriteEncodedTile(hTIFF, tile, pabyData, cc)) == cc;
+    WriteCOGBlockTrailer(tile, nLeaderOffset);
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     if( eBefore == CE_None && CPLGetLastErrorType() == CE_Failure )
         return false;
@@ -8391,9 +8622,11 @@ bool GTiffDataset::WriteEncodedStrip( uint32 strip, GByte* pabyData,
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     CPLErr eBefore = CPLGetLastErrorType();
 #endif
+    const vsi_l_offset nLeaderOffset = WriteCOGBlockLeader(strip);
     bool bRet =
         static_cast<int>(TIFFWriteEncodedStrip( hTIFF, strip,
                                                 pabyData, cc)) == cc;
+    WriteCOGBlockTrailer(strip, nLeaderOffset);
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     if( eBefore == CE_None && CPLGetLastErrorType() == CE_Failure )
         bRet = FALSE;
@@ -8521,8 +8754,23 @@ void GTiffDataset::ThreadCompressionFunc( void* pData )
         TIFFSetField(hTIFFTmp, TIFFTAG_ZIPQUALITY, poDS->nZLevel);
     if( poDS->nLZMAPreset > 0 && poDS->nCompression == COMPRESSION_LZMA)
         TIFFSetField(hTIFFTmp, TIFFTAG_LZMAPRESET, poDS->nLZMAPreset);
-    if( poDS->nZSTDLevel > 0 && poDS->nCompression == COMPRESSION_ZSTD)
+    if( poDS->nZSTDLevel > 0 && (poDS->nCompression == COMPRESSION_ZSTD ||
+        (poDS->nCompression == COMPRESSION_LERC &&
+         poDS->nLercAddCompression == LERC_ADD_COMPRESSION_ZSTD)) )
         TIFFSetField(hTIFFTmp, TIFFTAG_ZSTD_LEVEL, poDS->nZSTDLevel);
+    if( poDS->nCompression == COMPRESSION_LERC )
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_LERC_ADD_COMPRESSION,
+                     poDS->nLercAddCompression);
+        TIFFSetField(hTIFFTmp, TIFFTAG_LERC_MAXZERROR, poDS->dfMaxZError);
+    }
+    if( poDS->nCompression == COMPRESSION_WEBP )
+    {
+        if( poDS->nWebPLevel > 0 )
+            TIFFSetField(hTIFFTmp, TIFFTAG_WEBP_LEVEL, poDS->nWebPLevel);
+        TIFFSetField(hTIFFTmp, TIFFTAG_WEBP_LOSSLESS,
+                     poDS->bWebPLossless ? 1 : 0);
+    }
     TIFFSetField(hTIFFTmp, TIFFTAG_PHOTOMETRIC, poDS->nPhotometric);
     TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLEFORMAT, poDS->nSampleFormat);
     TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLESPERPIXEL, poDS->nSamplesPerPixel);
@@ -8607,12 +8855,14 @@ void GTiffDataset::WriteRawStripOrTile( int nStripOrTile,
         // we write at end of file.
         TIFFSetWriteOffset(hTIFF, 0);
     }
+    const vsi_l_offset nLeaderOffset = WriteCOGBlockLeader(nStripOrTile);
     if( TIFFIsTiled( hTIFF ) )
         TIFFWriteRawTile( hTIFF, nStripOrTile, pabyCompressedBuffer,
                           nCompressedBufferSize );
     else
         TIFFWriteRawStrip( hTIFF, nStripOrTile, pabyCompressedBuffer,
                            nCompressedBufferSize );
+    WriteCOGBlockTrailer(nStripOrTile, nLeaderOffset);
 }
 
 /************************************************************************/
@@ -8621,7 +8871,29 @@ void GTiffDataset::WriteRawStripOrTile( int nStripOrTile,
 
 void GTiffDataset::WaitCompletionForBlock(int nBlockId)
 {
-    if( poCompressThreadPool != nullptr )
+    if( poCompressThreadPool != nullptr && bWriteCOGLayout )
+    {
+        // Write the jobs submitted before the one of the block first, to
+        // keep the blocks in submission order.
+        bool bFound = false;
+        for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
+        {
+            if( asCompressionJobs[i].nStripOrTile == nBlockId &&
+                asCompressionJobs[i].nBufferSize != 0 )
+                bFound = true;
+        }
+        while( bFound && !anQueueCOGJobs.empty() )
+        {
+            const int iJob = anQueueCOGJobs.front();
+            anQueueCOGJobs.pop();
+            const bool bIsBlock =
+                asCompressionJobs[iJob].nStripOrTile == nBlockId;
+            WaitAndWriteCompressionJob(iJob);
+            if( bIsBlock )
+                break;
+        }
+    }
+    else if( poCompressThreadPool != nullptr )
     {
         for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
@@ -8656,6 +8928,42 @@ void GTiffDataset::WaitCompletionForBlock(int nBlockId)
     }
 }
 
+/************************************************************************/
+/*                     WaitAndWriteCompressionJob()                     */
+/************************************************************************/
+
+void GTiffDataset::WaitAndWriteCompressionJob( int iJob )
+{
+    while( true )
+    {
+        CPLAcquireMutex(hCompressThreadPoolMutex, 1000.0);
+        const bool bReady = asCompressionJobs[iJob].bReady;
+        int nRunningJobs = 0;
+        for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
+        {
+            if( asCompressionJobs[i].nBufferSize != 0 &&
+                !asCompressionJobs[i].bReady )
+                nRunningJobs++;
+        }
+        CPLReleaseMutex(hCompressThreadPoolMutex);
+        if( bReady )
+            break;
+        // Wait for at least one of the running jobs to finish.
+        poCompressThreadPool->WaitCompletion(nRunningJobs - 1);
+    }
+
+    if( asCompressionJobs[iJob].nCompressedBufferSize )
+    {
+        WriteRawStripOrTile( asCompressionJobs[iJob].nStripOrTile,
+                             asCompressionJobs[iJob].pabyCompressedBuffer,
+                             asCompressionJobs[iJob].nCompressedBufferSize );
+    }
+    asCompressionJobs[iJob].pabyCompressedBuffer = nullptr;
+    asCompressionJobs[iJob].nBufferSize = 0;
+    asCompressionJobs[iJob].bReady = false;
+    asCompressionJobs[iJob].nStripOrTile = -1;
+}
+
 /************************************************************************/
 /*                      SubmitCompressionJob()                          */
 /************************************************************************/
@@ -8671,35 +8979,66 @@ bool GTiffDataset::SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
             nCompression == COMPRESSION_LZW ||
             nCompression == COMPRESSION_PACKBITS ||
             nCompression == COMPRESSION_LZMA ||
-            nCompression == COMPRESSION_ZSTD) ) )
+            nCompression == COMPRESSION_ZSTD ||
+            nCompression == COMPRESSION_LERC ||
+            nCompression == COMPRESSION_WEBP) ) )
         return false;
 
     int nNextCompressionJobAvail = -1;
-    // Wait that at least one job is finished.
-    poCompressThreadPool->WaitCompletion(
-        static_cast<int>(asCompressionJobs.size() - 1) );
-    for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
-    {
-        CPLAcquireMutex(hCompressThreadPoolMutex, 1000.0);
-        const bool bReady = asCompressionJobs[i].bReady;
-        CPLReleaseMutex(hCompressThreadPoolMutex);
-        if( bReady )
+    if( bWriteCOGLayout )
+    {
+        // The blocks of a COG must be written in the order they are
+        // submitted, so write the finished jobs from the oldest one, and
+        // wait for the oldest one if all slots are used.
+        while( !anQueueCOGJobs.empty() )
+        {
+            const int iJob = anQueueCOGJobs.front();
+            CPLAcquireMutex(hCompressThreadPoolMutex, 1000.0);
+            const bool bReady = asCompressionJobs[iJob].bReady;
+            CPLReleaseMutex(hCompressThreadPoolMutex);
+            if( !bReady &&
+                anQueueCOGJobs.size() < asCompressionJobs.size() )
+                break;
+            anQueueCOGJobs.pop();
+            WaitAndWriteCompressionJob(iJob);
+        }
+        for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
-            if( asCompressionJobs[i].nCompressedBufferSize )
+            if( asCompressionJobs[i].nBufferSize == 0 )
             {
-                WriteRawStripOrTile( asCompressionJobs[i].nStripOrTile,
-                                asCompressionJobs[i].pabyCompressedBuffer,
-                                asCompressionJobs[i].nCompressedBufferSize );
+                nNextCompressionJobAvail = i;
+                break;
             }
-            asCompressionJobs[i].pabyCompressedBuffer = nullptr;
-            asCompressionJobs[i].nBufferSize = 0;
-            asCompressionJobs[i].bReady = false;
-            asCompressionJobs[i].nStripOrTile = -1;
         }
-        if( asCompressionJobs[i].nBufferSize == 0 )
+    }
+    else
+    {
+        // Wait that at least one job is finished.
+        poCompressThreadPool->WaitCompletion(
+            static_cast<int>(asCompressionJobs.size() - 1) );
+        for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
-            if( nNextCompressionJobAvail < 0 )
-                nNextCompressionJobAvail = i;
+            CPLAcquireMutex(hCompressThreadPoolMutex, 1000.0);
+            const bool bReady = asCompressionJobs[i].bReady;
+            CPLReleaseMutex(hCompressThreadPoolMutex);
+            if( bReady )
+            {
+                if( asCompressionJobs[i].nCompressedBufferSize )
+                {
+                    WriteRawStripOrTile( asCompressionJobs[i].nStripOrTile,
+                                    asCompressionJobs[i].pabyCompressedBuffer,
+                                    asCompressionJobs[i].nCompressedBufferSize );
+                }
+                asCompressionJobs[i].pabyCompressedBuffer = nullptr;
+                asCompressionJobs[i].nBufferSize = 0;
+                asCompressionJobs[i].bReady = false;
+                asCompressionJobs[i].nStripOrTile = -1;
+            }
+            if( asCompressionJobs[i].nBufferSize == 0 )
+            {
+                if( nNextCompressionJobAvail < 0 )
+                    nNextCompressionJobAvail = i;
+            }
         }
     }
     CPLAssert(nNextCompressionJobAvail >= 0);
@@ -8720,6 +9059,8 @@ bool GTiffDataset::SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
         TIFFGetField( hTIFF, TIFFTAG_PREDICTOR, &psJob->nPredictor );
     }
 
+    if( bWriteCOGLayout )
+        anQueueCOGJobs.push(nNextCompressionJobAvail);
     poCompressThreadPool->SubmitJob(ThreadCompressionFunc, psJob);
     return true;
 }
@@ -9698,7 +10039,12 @@ void GTiffDataset::FlushCacheInternal( bool bFlushDirectory )
     {
         poCompressThreadPool->WaitCompletion();
 
-        // Flush remaining data
+        // Flush remaining data, in submission order for a COG
+        while( !anQueueCOGJobs.empty() )
+        {
+            WaitAndWriteCompressionJob(anQueueCOGJobs.front());
+            anQueueCOGJobs.pop();
+        }
         for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
             if( asCompressionJobs[i].bReady )
@@ -9911,6 +10257,9 @@ CPLErr GTiffDataset::RegisterNewOverviewDataset(toff_t nOverviewOffset,
     poODS->nZLevel = nZLevel;
     poODS->nLZMAPreset = nLZMAPreset;
     poODS->nZSTDLevel = nZSTDLevel;
+    poODS->dfMaxZError = dfMaxZError;
+    poODS->nWebPLevel = nWebPLevel;
+    poODS->bWebPLossless = bWebPLossless;
     poODS->nJpegTablesMode = nJpegTablesMode;
 
     if( poODS->OpenOffset( hTIFF, ppoActiveDSRef, nOverviewOffset, false,
@@ -11846,6 +12195,20 @@ bool GTiffDataset::SetDirectory( toff_t nNewOffset )
             TIFFSetField(hTIFF, TIFFTAG_LZMAPRESET, nLZMAPreset);
         if( nZSTDLevel > 0 && nCompression == COMPRESSION_ZSTD)
             TIFFSetField(hTIFF, TIFFTAG_ZSTD_LEVEL, nZSTDLevel);
+        if( nCompression == COMPRESSION_LERC )
+        {
+            TIFFSetField(hTIFF, TIFFTAG_LERC_MAXZERROR, dfMaxZError);
+            if( nZLevel > 0 )
+                TIFFSetField(hTIFF, TIFFTAG_ZIPQUALITY, nZLevel);
+            if( nZSTDLevel > 0 )
+                TIFFSetField(hTIFF, TIFFTAG_ZSTD_LEVEL, nZSTDLevel);
+        }
+        if( nCompression == COMPRESSION_WEBP )
+        {
+            if( nWebPLevel > 0 )
+                TIFFSetField(hTIFF, TIFFTAG_WEBP_LEVEL, nWebPLevel);
+            TIFFSetField(hTIFF, TIFFTAG_WEBP_LOSSLESS, bWebPLossless ? 1 : 0);
+        }
     }
 
     return true;
@@ -13551,6 +13914,12 @@ CPLErr GTiffDataset::OpenOffset( TIFF *hTIFFIn,
     }
 #endif
 
+    // The additional compression of LERC is stored in the LercParameters
+    // tag of each IFD, and must be known to compress blocks in worker threads.
+    if( nCompression == COMPRESSION_LERC )
+        TIFFGetField( hTIFF, TIFFTAG_LERC_ADD_COMPRESSION,
+                      &nLercAddCompression );
+
 /* -------------------------------------------------------------------- */
 /*      YCbCr JPEG compressed images should be translated on the fly    */
 /*      to RGB by libtiff/libjpeg unless specifically requested         */
@@ -14136,6 +14505,20 @@ CPLErr GTiffDataset::OpenOffset( TIFF *hTIFFIn,
     {
         oGTiffMDMD.SetMetadataItem( "COMPRESSION", "ZSTD", "IMAGE_STRUCTURE" );
     }
+    else if( nCompression == COMPRESSION_LERC )
+    {
+        const char* pszLercCompress =
+            nLercAddCompression == LERC_ADD_COMPRESSION_DEFLATE ?
+                "LERC_DEFLATE" :
+            nLercAddCompression == LERC_ADD_COMPRESSION_ZSTD ?
+                "LERC_ZSTD" : "LERC";
+        oGTiffMDMD.SetMetadataItem( "COMPRESSION", pszLercCompress,
+                                    "IMAGE_STRUCTURE" );
+    }
+    else if( nCompression == COMPRESSION_WEBP )
+    {
+        oGTiffMDMD.SetMetadataItem( "COMPRESSION", "WEBP", "IMAGE_STRUCTURE" );
+    }
     else
     {
         CPLString oComp;
@@ -15010,6 +15393,58 @@ static int GTiffGetZSTDPreset(char** papszOptions)
     return nZSTDLevel;
 }
 
+static int GTiffGetLercAddCompression(const char* pszCompress)
+{
+    if( pszCompress == nullptr )
+        return LERC_ADD_COMPRESSION_NONE;
+    if( EQUAL(pszCompress, "LERC_DEFLATE") )
+        return LERC_ADD_COMPRESSION_DEFLATE;
+    if( EQUAL(pszCompress, "LERC_ZSTD") )
+        return LERC_ADD_COMPRESSION_ZSTD;
+    return LERC_ADD_COMPRESSION_NONE;
+}
+
+static double GTiffGetLERCMaxZError(char** papszOptions)
+{
+    double dfMaxZError = 0.0;
+    const char* pszValue = CSLFetchNameValue( papszOptions, "MAX_Z_ERROR" );
+    if( pszValue != nullptr )
+    {
+        dfMaxZError = CPLAtof( pszValue );
+        if( !(dfMaxZError >= 0.0) )
+        {
+            CPLError( CE_Warning, CPLE_IllegalArg,
+                      "MAX_Z_ERROR=%s value not recognised, ignoring.",
+                      pszValue );
+            dfMaxZError = 0.0;
+        }
+    }
+    return dfMaxZError;
+}
+
+static int GTiffGetWebPLevel(char** papszOptions)
+{
+    int nWebPLevel = -1;
+    const char* pszValue = CSLFetchNameValue( papszOptions, "WEBP_LEVEL" );
+    if( pszValue != nullptr )
+    {
+        nWebPLevel = atoi( pszValue );
+        if( !(nWebPLevel >= 1 && nWebPLevel <= 100) )
+        {
+            CPLError( CE_Warning, CPLE_IllegalArg,
+                      "WEBP_LEVEL=%s value not recognised, ignoring.",
+                      pszValue );
+            nWebPLevel = -1;
+        }
+    }
+    return nWebPLevel;
+}
+
+static bool GTiffGetWebPLossless(char** papszOptions)
+{
+    return CPLFetchBool( papszOptions, "WEBP_LOSSLESS", false );
+}
+
 static int GTiffGetZLevel(char** papszOptions)
 {
     int nZLevel = -1;
@@ -15205,6 +15640,33 @@ TIFF *GTiffDataset::CreateLL( const char * pszFilename,
         if( l_nCompression < 0 )
             return nullptr;
     }
+    const int l_nLercAddCompression = GTiffGetLercAddCompression(pszValue);
+
+    // The LERC codec encodes each sample plane separately.
+    if( l_nCompression == COMPRESSION_LERC && l_nBands > 1 )
+    {
+        if( CSLFetchNameValue(papszParmList, "INTERLEAVE") == nullptr )
+        {
+            nPlanar = PLANARCONFIG_SEPARATE;
+        }
+        else if( nPlanar != PLANARCONFIG_SEPARATE )
+        {
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "LERC compression requires INTERLEAVE=BAND "
+                      "when there are several bands." );
+            return nullptr;
+        }
+    }
+
+    if( l_nCompression == COMPRESSION_WEBP &&
+        (eType != GDT_Byte || (l_nBands != 3 && l_nBands != 4) ||
+         nPlanar != PLANARCONFIG_CONTIG) )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "WEBP compression is only supported for Byte RGB or RGBA "
+                  "datasets with INTERLEAVE=PIXEL." );
+        return nullptr;
+    }
 
     int nPredictor = PREDICTOR_NONE;
     pszValue = CSLFetchNameValue( papszParmList, "PREDICTOR" );
@@ -15214,6 +15676,9 @@ TIFF *GTiffDataset::CreateLL( const char * pszFilename,
     const int l_nZLevel = GTiffGetZLevel(papszParmList);
     const int l_nLZMAPreset = GTiffGetLZMAPreset(papszParmList);
     const int l_nZSTDLevel = GTiffGetZSTDPreset(papszParmList);
+    const double l_dfMaxZError = GTiffGetLERCMaxZError(papszParmList);
+    const int l_nWebPLevel = GTiffGetWebPLevel(papszParmList);
+    const bool l_bWebPLossless = GTiffGetWebPLossless(papszParmList);
     const int l_nJpegQuality = GTiffGetJpegQuality(papszParmList);
     const int l_nJpegTablesMode = GTiffGetJpegTablesMode(papszParmList);
 
@@ -15428,6 +15893,37 @@ TIFF *GTiffDataset::CreateLL( const char * pszFilename,
         return nullptr;
     }
 
+/* -------------------------------------------------------------------- */
+/*      For the cloud optimized layout, write just after the TIFF       */
+/*      header, and thus before the first IFD, a "ghost" header         */
+/*      describing the organization of the file to readers.             */
+/* -------------------------------------------------------------------- */
+    if( CPLFetchBool(papszParmList, "@COG_LAYOUT", false) )
+    {
+        const char* pszStructuralMD =
+            "LAYOUT=IFDS_BEFORE_DATA\n"
+            "BLOCK_ORDER=ROW_MAJOR\n"
+            "BLOCK_LEADER=SIZE_AS_UINT4\n"
+            "BLOCK_TRAILER=LAST_4_BYTES_REPEATED\n"
+            "KNOWN_INCOMPATIBLE_EDITION=NO\n ";  // Pad to an even size.
+        CPLString osGhostHeader;
+        osGhostHeader.Printf("GDAL_STRUCTURAL_METADATA_SIZE=%06d bytes\n",
+                             static_cast<int>(strlen(pszStructuralMD)));
+        osGhostHeader += pszStructuralMD;
+
+        VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( l_hTIFF ));
+        if( VSIFSeekL(fp, 0, SEEK_END) != 0 ||
+            VSIFWriteL(osGhostHeader.c_str(), 1, osGhostHeader.size(), fp) !=
+                                                        osGhostHeader.size() )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot write ghost header of %s", pszFilename );
+            XTIFFClose(l_hTIFF);
+            CPL_IGNORE_RET_VAL(VSIFCloseL(l_fpL));
+            return nullptr;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      How many bits per sample?  We have a special case if NBITS      */
 /*      specified for GDT_Byte, GDT_UInt16, GDT_UInt32.                 */
@@ -15749,6 +16245,22 @@ TIFF *GTiffDataset::CreateLL( const char * pszFilename,
         TIFFSetField( l_hTIFF, TIFFTAG_LZMAPRESET, l_nLZMAPreset );
     else if( l_nCompression == COMPRESSION_ZSTD && l_nZSTDLevel != -1)
         TIFFSetField( l_hTIFF, TIFFTAG_ZSTD_LEVEL, l_nZSTDLevel);
+    else if( l_nCompression == COMPRESSION_LERC )
+    {
+        TIFFSetField( l_hTIFF, TIFFTAG_LERC_ADD_COMPRESSION,
+                      l_nLercAddCompression );
+        TIFFSetField( l_hTIFF, TIFFTAG_LERC_MAXZERROR, l_dfMaxZError );
+        if( l_nZLevel != -1 )
+            TIFFSetField( l_hTIFF, TIFFTAG_ZIPQUALITY, l_nZLevel );
+        if( l_nZSTDLevel != -1 )
+            TIFFSetField( l_hTIFF, TIFFTAG_ZSTD_LEVEL, l_nZSTDLevel );
+    }
+    else if( l_nCompression == COMPRESSION_WEBP )
+    {
+        if( l_nWebPLevel != -1 )
+            TIFFSetField( l_hTIFF, TIFFTAG_WEBP_LEVEL, l_nWebPLevel );
+        TIFFSetField( l_hTIFF, TIFFTAG_WEBP_LOSSLESS, l_bWebPLossless ? 1 : 0 );
+    }
 
     if( l_nCompression == COMPRESSION_JPEG )
         TIFFSetField( l_hTIFF, TIFFTAG_JPEGTABLESMODE, l_nJpegTablesMode );
@@ -16266,6 +16778,9 @@ GDALDataset *GTiffDataset::Create( const char * pszFilename,
         poDS->nPhotometric = PHOTOMETRIC_MINISBLACK;
     TIFFGetField( l_hTIFF, TIFFTAG_BITSPERSAMPLE, &(poDS->nBitsPerSample) );
     TIFFGetField( l_hTIFF, TIFFTAG_COMPRESSION, &(poDS->nCompression) );
+    if( poDS->nCompression == COMPRESSION_LERC )
+        TIFFGetField( l_hTIFF, TIFFTAG_LERC_ADD_COMPRESSION,
+                      &(poDS->nLercAddCompression) );
 
     if( TIFFIsTiled(l_hTIFF) )
     {
@@ -16368,6 +16883,9 @@ GDALDataset *GTiffDataset::Create( const char * pszFilename,
     poDS->nZLevel = GTiffGetZLevel(papszParmList);
     poDS->nLZMAPreset = GTiffGetLZMAPreset(papszParmList);
     poDS->nZSTDLevel = GTiffGetZSTDPreset(papszParmList);
+    poDS->dfMaxZError = GTiffGetLERCMaxZError(papszParmList);
+    poDS->nWebPLevel = GTiffGetWebPLevel(papszParmList);
+    poDS->bWebPLossless = GTiffGetWebPLossless(papszParmList);
     poDS->nJpegQuality = GTiffGetJpegQuality(papszParmList);
     poDS->nJpegTablesMode = GTiffGetJpegTablesMode(papszParmList);
     poDS->InitCreationOrOpenOptions(papszParmList);
@@ -16658,6 +17176,10 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     }
 #endif
 
+    // Set by the COG driver: blocks must go through WriteEncodedTile() or
+    // WriteRawStripOrTile() to get their leader and trailer.
+    const bool bCOGLayout = CPLFetchBool(papszOptions, "@COG_LAYOUT", false);
+
 #ifdef HAVE_LIBJPEG
     bool bCopyFromJPEG = false;
 
@@ -16666,7 +17188,7 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     // strip/tile dimensions, specifying JPEG_QUALITY option, incompatible
     // PHOTOMETRIC with the source colorspace, etc.) to avoid the lossy steps
     // involved by decompression/recompression.
-    if( !bDirectCopyFromJPEG &&
+    if( !bDirectCopyFromJPEG && !bCOGLayout &&
         GTIFF_CanCopyFromJPEG(poSrcDS, papszCreateOptions) )
     {
         CPLDebug( "GTiff", "Using special copy mode from a JPEG dataset" );
@@ -17356,6 +17878,9 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     poDS->nZLevel = GTiffGetZLevel(papszOptions);
     poDS->nLZMAPreset = GTiffGetLZMAPreset(papszOptions);
     poDS->nZSTDLevel = GTiffGetZSTDPreset(papszOptions);
+    poDS->dfMaxZError = GTiffGetLERCMaxZError(papszOptions);
+    poDS->nWebPLevel = GTiffGetWebPLevel(papszOptions);
+    poDS->bWebPLossless = GTiffGetWebPLossless(papszOptions);
     poDS->nJpegQuality = GTiffGetJpegQuality(papszOptions);
     poDS->nJpegTablesMode = GTiffGetJpegTablesMode(papszOptions);
     poDS->GetDiscardLsbOption(papszOptions);
@@ -17390,6 +17915,27 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
             TIFFSetField( l_hTIFF, TIFFTAG_ZSTD_LEVEL, poDS->nZSTDLevel );
         }
     }
+    else if( l_nCompression == COMPRESSION_LERC )
+    {
+        TIFFSetField( l_hTIFF, TIFFTAG_LERC_MAXZERROR, poDS->dfMaxZError );
+        if( poDS->nZLevel != -1 )
+        {
+            TIFFSetField( l_hTIFF, TIFFTAG_ZIPQUALITY, poDS->nZLevel );
+        }
+        if( poDS->nZSTDLevel != -1 )
+        {
+            TIFFSetField( l_hTIFF, TIFFTAG_ZSTD_LEVEL, poDS->nZSTDLevel );
+        }
+    }
+    else if( l_nCompression == COMPRESSION_WEBP )
+    {
+        if( poDS->nWebPLevel != -1 )
+        {
+            TIFFSetField( l_hTIFF, TIFFTAG_WEBP_LEVEL, poDS->nWebPLevel );
+        }
+        TIFFSetField( l_hTIFF, TIFFTAG_WEBP_LOSSLESS,
+                      poDS->bWebPLossless ? 1 : 0 );
+    }
 
     // Precreate (internal) mask, so that the IBuildOverviews() below
     // has a chance to create also the overviews of the mask.
@@ -17402,6 +17948,13 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
         eErr = poDS->CreateMaskBand( nMaskFlags );
     }
 
+    if( bCOGLayout )
+    {
+        poDS->bWriteCOGLayout = true;
+        if( poDS->poMaskDS )
+            poDS->poMaskDS->bWriteCOGLayout = true;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Create and then copy existing overviews if requested            */
 /*  We do it such that all the IFDs are at the beginning of the file,   */
@@ -17431,6 +17984,14 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
                 eErr = CE_Failure;
             }
 
+            for( int i = 0; bCOGLayout && i < poDS->nOverviewCount; ++i )
+            {
+                GTiffDataset* poODS = poDS->papoOverviewDS[i];
+                poODS->bWriteCOGLayout = true;
+                if( poODS->poMaskDS )
+                    poODS->poMaskDS->bWriteCOGLayout = true;
+            }
+
             for( int i = 0; i < nSrcOverviews; ++i )
             {
                 GDALRasterBand* poOvrBand =
@@ -17635,8 +18196,12 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     {
         char* papszCopyWholeRasterOptions[3] = { nullptr, nullptr, nullptr };
         int iNextOption = 0;
-        papszCopyWholeRasterOptions[iNextOption++] =
+        // Holes filled at closing would end up after all other blocks.
+        if( !bCOGLayout )
+        {
+            papszCopyWholeRasterOptions[iNextOption++] =
                 const_cast<char *>( "SKIP_HOLES=YES" );
+        }
         if( l_nCompression != COMPRESSION_NONE )
         {
             papszCopyWholeRasterOptions[iNextOption++] =
@@ -17654,11 +18219,11 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     /*      Do we want to ensure all blocks get written out on close to     */
     /*      avoid sparse files?                                             */
     /* -------------------------------------------------------------------- */
-        if( !CPLFetchBool( papszOptions, "SPARSE_OK", false ) )
+        if( !CPLFetchBool( papszOptions, "SPARSE_OK", false ) && !bCOGLayout )
             poDS->bFillEmptyTilesAtClosing = true;
 
         poDS->bWriteEmptyTiles =
-            bStreaming ||
+            bStreaming || bCOGLayout ||
             (poDS->nCompression != COMPRESSION_NONE &&
              poDS->bFillEmptyTilesAtClosing);
         // Only required for people writing non-compressed stripped files in the
@@ -18751,6 +19316,12 @@ int GTIFFGetCompressionMethod(const char* pszValue, const char* pszVariableName)
         nCompression = COMPRESSION_LZMA;
     else if( EQUAL( pszValue, "ZSTD" ) )
         nCompression = COMPRESSION_ZSTD;
+    else if( EQUAL( pszValue, "LERC" ) ||
+             EQUAL( pszValue, "LERC_DEFLATE" ) ||
+             EQUAL( pszValue, "LERC_ZSTD" ) )
+        nCompression = COMPRESSION_LERC;
+    else if( EQUAL( pszValue, "WEBP" ) )
+        nCompression = COMPRESSION_WEBP;
     else
         CPLError( CE_Warning, CPLE_IllegalArg,
                   "%s=%s value not recognised, ignoring.",
@@ -18765,34 +19336,50 @@ int GTIFFGetCompressionMethod(const char* pszValue, const char* pszVariableName)
             "Cannot create TIFF file due to missing codec for %s.", pszValue );
         return -1;
     }
+    if( nCompression == COMPRESSION_LERC && EQUAL( pszValue, "LERC_ZSTD" ) &&
+        !TIFFIsCODECConfigured(COMPRESSION_ZSTD) )
+    {
+        CPLError(
+            CE_Failure, CPLE_AppDefined,
+            "Cannot create TIFF file due to missing codec for %s.", pszValue );
+        return -1;
+    }
 #endif
 
     return nCompression;
 }
 
 /************************************************************************/
-/*                          GDALRegister_GTiff()                        */
-/************************************************************************/
-
-void GDALRegister_GTiff()
-
+/*                       GTiffGetCompressValues()                       */
+/*                                                                      */
+/*      Return the COMPRESS values supported by the libtiff in use,     */
+/*      for the creation option list of the GTiff and COG drivers.      */
+/*      CCITT compressions are not offered for COG.                     */
+/************************************************************************/
+
+CPLString GTiffGetCompressValues( bool& bHasLZW,
+                                  bool& bHasDEFLATE,
+                                  bool& bHasLZMA,
+                                  bool& bHasZSTD,
+                                  bool& bHasJPEG,
+                                  bool& bHasWebP,
+                                  bool& bHasLERC,
+                                  bool bForCOG )
 {
-    if( GDALGetDriverByName( "GTiff" ) != nullptr )
-        return;
-
-    CPLString osOptions;
-    CPLString osCompressValues;
-    bool bHasJPEG = false;
-    bool bHasLZMA = false;
-    bool bHasZSTD = false;
-
-    GDALDriver *poDriver = new GDALDriver();
+    bHasLZW = false;
+    bHasDEFLATE = false;
+    bHasLZMA = false;
+    bHasZSTD = false;
+    bHasJPEG = false;
+    bHasWebP = false;
+    bHasLERC = false;
 
 /* -------------------------------------------------------------------- */
 /*      Determine which compression codecs are available that we        */
 /*      want to advertise.  If we are using an old libtiff we won't     */
 /*      be able to find out so we just assume all are available.        */
 /* -------------------------------------------------------------------- */
+    CPLString osCompressValues;
     osCompressValues = "       <Value>NONE</Value>";
 
 #if TIFFLIB_VERSION <= 20040919
@@ -18801,11 +19388,9 @@ void GDALRegister_GTiff()
             "       <Value>JPEG</Value>"
             "       <Value>LZW</Value>"
             "       <Value>DEFLATE</Value>";
-    bool bHasLZW = true;
-    bool bHasDEFLATE = true;
+    bHasLZW = true;
+    bHasDEFLATE = true;
 #else
-    bool bHasLZW = false;
-    bool bHasDEFLATE = false;
     TIFFCodec *codecs = TIFFGetConfiguredCODECs();
 
     for( TIFFCodec *c = codecs; c->name; ++c )
@@ -18833,17 +19418,17 @@ void GDALRegister_GTiff()
             osCompressValues +=
                     "       <Value>DEFLATE</Value>";
         }
-        else if( c->scheme == COMPRESSION_CCITTRLE )
+        else if( !bForCOG && c->scheme == COMPRESSION_CCITTRLE )
         {
             osCompressValues +=
                     "       <Value>CCITTRLE</Value>";
         }
-        else if( c->scheme == COMPRESSION_CCITTFAX3 )
+        else if( !bForCOG && c->scheme == COMPRESSION_CCITTFAX3 )
         {
             osCompressValues +=
                     "       <Value>CCITTFAX3</Value>";
         }
-        else if( c->scheme == COMPRESSION_CCITTFAX4 )
+        else if( !bForCOG && c->scheme == COMPRESSION_CCITTFAX4 )
         {
             osCompressValues +=
                     "       <Value>CCITTFAX4</Value>";
@@ -18860,14 +19445,62 @@ void GDALRegister_GTiff()
             osCompressValues +=
                     "       <Value>ZSTD</Value>";
         }
+        else if( c->scheme == COMPRESSION_LERC )
+        {
+            bHasLERC = true;
+        }
+        else if( c->scheme == COMPRESSION_WEBP )
+        {
+            bHasWebP = true;
+            osCompressValues +=
+                    "       <Value>WEBP</Value>";
+        }
+    }
+    if( bHasLERC )
+    {
+        osCompressValues +=
+                "       <Value>LERC</Value>"
+                "       <Value>LERC_DEFLATE</Value>";
+        if( bHasZSTD )
+        {
+            osCompressValues +=
+                "       <Value>LERC_ZSTD</Value>";
+        }
     }
     _TIFFfree( codecs );
 #endif
 
+
+    return osCompressValues;
+}
+
+/************************************************************************/
+/*                          GDALRegister_GTiff()                        */
+/************************************************************************/
+
+void GDALRegister_GTiff()
+
+{
+    if( GDALGetDriverByName( "GTiff" ) != nullptr )
+        return;
+
+    bool bHasLZW = false;
+    bool bHasDEFLATE = false;
+    bool bHasLZMA = false;
+    bool bHasZSTD = false;
+    bool bHasJPEG = false;
+    bool bHasWebP = false;
+    bool bHasLERC = false;
+    CPLString osCompressValues(
+        GTiffGetCompressValues(bHasLZW, bHasDEFLATE, bHasLZMA, bHasZSTD,
+                               bHasJPEG, bHasWebP, bHasLERC, false));
+
+    GDALDriver *poDriver = new GDALDriver();
+
 /* -------------------------------------------------------------------- */
 /*      Build full creation option list.                                */
 /* -------------------------------------------------------------------- */
-    osOptions = "<CreationOptionList>"
+    CPLString osOptions = "<CreationOptionList>"
               "   <Option name='COMPRESS' type='string-select'>";
     osOptions += osCompressValues;
     osOptions += "   </Option>";
@@ -18895,6 +19528,13 @@ void GDALRegister_GTiff()
     if( bHasZSTD )
         osOptions += ""
 "   <Option name='ZSTD_LEVEL' type='int' description='ZSTD compression level 1(fast)-22(slow)' default='9'/>";
+    if( bHasLERC )
+        osOptions += ""
+"   <Option name='MAX_Z_ERROR' type='float' description='Maximum error for LERC compression' default='0'/>";
+    if( bHasWebP )
+        osOptions += ""
+"   <Option name='WEBP_LEVEL' type='int' description='WEBP quality level 1-100' default='75'/>"
+"   <Option name='WEBP_LOSSLESS' type='boolean' description='Whether lossless compression should be used' default='FALSE'/>";
     osOptions += ""
 "   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
 "   <Option name='NBITS' type='int' description='BITS for sub-byte files (1-7), sub-uint16 (9-15), sub-uint32 (17-31), or float32 (16)'/>"
@@ -48,6 +48,14 @@ void    GTIFFSetJpegQuality( GDALDatasetH hGTIFFDS, int nJpegQuality );
 void    GTIFFSetJpegTablesMode( GDALDatasetH hGTIFFDS, int nJpegTablesMode );
 int     GTIFFGetCompressionMethod( const char* pszValue,
                                    const char* pszVariableName );
+CPLString GTiffGetCompressValues( bool& bHasLZW,
+                                  bool& bHasDEFLATE,
+                                  bool& bHasLZMA,
+                                  bool& bHasZSTD,
+                                  bool& bHasJPEG,
+                                  bool& bHasWebP,
+                                  bool& bHasLERC,
+                                  bool bForCOG );
 
 void GTiffDatasetWriteRPCTag( TIFF *hTIFF, char **papszRPCMD );
 char** GTiffDatasetReadRPCTag( TIFF *hTIFF );
@@ -99,4 +107,30 @@ const int knGTIFFJpegTablesModeDefault = 1; /* JPEGTABLESMODE_QUANT */
 #define TIFFTAG_ZSTD_LEVEL      65534    /* ZSTD compression level */
 #endif
 
+#if !defined(COMPRESSION_LERC)
+#define     COMPRESSION_LERC        34887   /* LERC */
+#endif
+
+#if !defined(TIFFTAG_LERC_VERSION)
+#define TIFFTAG_LERC_VERSION            65565 /* LERC version */
+#define     LERC_VERSION_2_4            4
+#define TIFFTAG_LERC_ADD_COMPRESSION    65566 /* LERC additional compression */
+#define     LERC_ADD_COMPRESSION_NONE    0
+#define     LERC_ADD_COMPRESSION_DEFLATE 1
+#define     LERC_ADD_COMPRESSION_ZSTD    2
+#define TIFFTAG_LERC_MAXZERROR          65567 /* LERC maximum error */
+#endif
+
+#if !defined(COMPRESSION_WEBP)
+#define     COMPRESSION_WEBP        50001   /* WebP */
+#endif
+
+#if !defined(TIFFTAG_WEBP_LEVEL)
+#define TIFFTAG_WEBP_LEVEL      65568   /* WebP compression level */
+#endif
+
+#if !defined(TIFFTAG_WEBP_LOSSLESS)
+#define TIFFTAG_WEBP_LOSSLESS   65569   /* WebP lossless/lossy */
+#endif
+
 #endif // GTIFF_H_INCLUDED
@@ -746,6 +746,8 @@
 #define orientNames gdal_orientNames
 #define zipFields gdal_zipFields
 #define ZSTDFields gdal_ZSTDFields
+#define LERCFields gdal_LERCFields
+#define TWebPFields gdal_TWebPFields
 #define _TIFFBuiltinCODECS gdal__TIFFBuiltinCODECS
 #define _TIFFerrorHandler gdal__TIFFerrorHandler
 #define _TIFFwarningHandler gdal__TIFFwarningHandler
@@ -802,3 +804,9 @@
 #ifdef LZMA_SUPPORT
 #define TIFFInitLZMA gdal_TIFFInitLZMA
 #endif
+#ifdef LERC_SUPPORT
+#define TIFFInitLERC gdal_TIFFInitLERC
+#endif
+#ifdef WEBP_SUPPORT
+#define TIFFInitWebP gdal_TIFFInitWebP
+#endif
@@ -0,0 +1,988 @@
+/*
+* Copyright (c) 2018, GDAL contributors
+*
+* Permission to use, copy, modify, distribute, and sell this software and
+* its documentation for any purpose is hereby granted without fee, provided
+* that (i) the above copyright notices and this permission notice appear in
+* all copies of the software and related documentation, and (ii) the names of
+* Sam Leffler and Silicon Graphics may not be used in any advertising or
+* publicity relating to the software without the specific, prior written
+* permission of Sam Leffler and Silicon Graphics.
+*
+* THE SOFTWARE IS PROVIDED "AS-IS" AND WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS, IMPLIED OR OTHERWISE, INCLUDING WITHOUT LIMITATION, ANY
+* WARRANTY OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.
+*
+* IN NO EVENT SHALL SAM LEFFLER OR SILICON GRAPHICS BE LIABLE FOR
+* ANY SPECIAL, INCIDENTAL, INDIRECT OR CONSEQUENTIAL DAMAGES OF ANY KIND,
+* OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+* WHETHER OR NOT ADVISED OF THE POSSIBILITY OF DAMAGE, AND ON ANY THEORY OF
+* LIABILITY, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+* OF THIS SOFTWARE.
+*/
+
+#include "tiffiop.h"
+#ifdef LERC_SUPPORT
+/*
+* TIFF Library.
+*
+* LERC Compression Support
+*
+* A strip or tile is encoded as a single LERC blob (one blob per sample
+* when PlanarConfiguration=Separate), optionally compressed again with
+* Deflate or ZSTD, as described by the LercParameters tag.
+*/
+
+#include "Lerc_c_api.h"
+#include "zlib.h"
+#ifdef ZSTD_SUPPORT
+#include "zstd.h"
+#endif
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+/*
+* State block for each open TIFF file using LERC compression/decompression.
+*/
+typedef struct {
+        double          maxzerror;              /* max z error */
+        int             lerc_version;
+        int             additional_compression;
+        int             zstd_compress_level;    /* zstd */
+        int             zipquality;             /* deflate */
+        int             state;                  /* state flags */
+
+        uint32          segment_width;
+        uint32          segment_height;
+
+        unsigned int    uncompressed_size;
+        unsigned int    uncompressed_alloc;
+        uint8          *uncompressed_buffer;
+        unsigned int    uncompressed_offset;
+
+        unsigned int    compressed_size;
+        uint8          *compressed_buffer;
+
+        unsigned int    mask_size;
+        uint8          *mask_buffer;
+
+        TIFFVGetMethod  vgetparent;            /* super-class method */
+        TIFFVSetMethod  vsetparent;            /* super-class method */
+} LERCState;
+
+#define LSTATE_INIT_DECODE 0x01
+#define LSTATE_INIT_ENCODE 0x02
+
+#define LState(tif)             ((LERCState*) (tif)->tif_data)
+#define DecoderState(tif)       LState(tif)
+#define EncoderState(tif)       LState(tif)
+
+static int LERCEncode(TIFF* tif, uint8* bp, tmsize_t cc, uint16 s);
+static int LERCDecode(TIFF* tif, uint8* op, tmsize_t occ, uint16 s);
+
+static int
+LERCFixupTags(TIFF* tif)
+{
+        (void) tif;
+        return 1;
+}
+
+static int
+LERCSetupDecode(TIFF* tif)
+{
+        LERCState* sp = DecoderState(tif);
+
+        assert(sp != NULL);
+
+        /* if we were last encoding, terminate this mode */
+        if (sp->state & LSTATE_INIT_ENCODE) {
+            sp->state = 0;
+        }
+
+        sp->state |= LSTATE_INIT_DECODE;
+        return 1;
+}
+
+/*
+* Returns the LERC data type matching the sample format of the file,
+* or -1 if it is not supported.
+*/
+static int
+GetLercDataType(TIFF* tif)
+{
+        static const char module[] = "GetLercDataType";
+        TIFFDirectory *td = &tif->tif_dir;
+
+        if( td->td_sampleformat == SAMPLEFORMAT_INT &&
+            td->td_bitspersample == 8 )
+            return LERC_DT_CHAR;
+        if( td->td_sampleformat == SAMPLEFORMAT_UINT &&
+            td->td_bitspersample == 8 )
+            return LERC_DT_UCHAR;
+        if( td->td_sampleformat == SAMPLEFORMAT_INT &&
+            td->td_bitspersample == 16 )
+            return LERC_DT_SHORT;
+        if( td->td_sampleformat == SAMPLEFORMAT_UINT &&
+            td->td_bitspersample == 16 )
+            return LERC_DT_USHORT;
+        if( td->td_sampleformat == SAMPLEFORMAT_INT &&
+            td->td_bitspersample == 32 )
+            return LERC_DT_INT;
+        if( td->td_sampleformat == SAMPLEFORMAT_UINT &&
+            td->td_bitspersample == 32 )
+            return LERC_DT_UINT;
+        if( td->td_sampleformat == SAMPLEFORMAT_IEEEFP &&
+            td->td_bitspersample == 32 )
+            return LERC_DT_FLOAT;
+        if( td->td_sampleformat == SAMPLEFORMAT_IEEEFP &&
+            td->td_bitspersample == 64 )
+            return LERC_DT_DOUBLE;
+
+        TIFFErrorExt(tif->tif_clientdata, module,
+                     "Unsupported combination of SampleFormat and "
+                     "BitsPerSample");
+        return -1;
+}
+
+/*
+* Computes the dimensions of the current strip or tile, and makes sure
+* the buffer holding its uncompressed content is large enough.
+*/
+static int
+SetupUncompressedBuffer(TIFF* tif, LERCState* sp, const char* module)
+{
+        TIFFDirectory *td = &tif->tif_dir;
+        uint64 new_size_64;
+        uint64 new_alloc_64;
+        unsigned int new_size;
+        unsigned int new_alloc;
+
+        sp->uncompressed_offset = 0;
+
+        if( td->td_planarconfig == PLANARCONFIG_CONTIG &&
+            td->td_samplesperpixel > 1 )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "LERC compression is only supported with "
+                         "PlanarConfiguration=Separate when "
+                         "SamplesPerPixel > 1");
+            return 0;
+        }
+
+        if( isTiled(tif) )
+        {
+            sp->segment_width = td->td_tilewidth;
+            sp->segment_height = td->td_tilelength;
+        }
+        else
+        {
+            sp->segment_width = td->td_imagewidth;
+            sp->segment_height = td->td_imagelength - tif->tif_row;
+            if( sp->segment_height > td->td_rowsperstrip )
+                sp->segment_height = td->td_rowsperstrip;
+        }
+
+        new_size_64 = (uint64)sp->segment_width * sp->segment_height *
+                      (td->td_bitspersample / 8);
+        new_size = (unsigned int)new_size_64;
+        sp->uncompressed_size = new_size;
+
+        /* add some margin as we are going to use it also to store deflate/zstd compressed data */
+        new_alloc_64 = 100 + new_size_64 + new_size_64 / 3;
+#ifdef ZSTD_SUPPORT
+        {
+            size_t zstd_max = ZSTD_compressBound((size_t)new_size_64);
+            if( new_alloc_64 < zstd_max )
+            {
+                new_alloc_64 = zstd_max;
+            }
+        }
+#endif
+        new_alloc = (unsigned int)new_alloc_64;
+        if( new_alloc != new_alloc_64 || new_size != new_size_64 )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Too large uncompressed strip/tile");
+            _TIFFfree(sp->uncompressed_buffer);
+            sp->uncompressed_buffer = NULL;
+            sp->uncompressed_alloc = 0;
+            return 0;
+        }
+
+        if( sp->uncompressed_alloc < new_alloc )
+        {
+            _TIFFfree(sp->uncompressed_buffer);
+            sp->uncompressed_buffer = (uint8*)_TIFFmalloc(new_alloc);
+            if( !sp->uncompressed_buffer )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                             "Cannot allocate buffer");
+                sp->uncompressed_alloc = 0;
+                return 0;
+            }
+            sp->uncompressed_alloc = new_alloc;
+        }
+
+        return 1;
+}
+
+/*
+* Makes sure the buffer holding the LERC blob can store new_size bytes.
+*/
+static int
+SetupCompressedBuffer(TIFF* tif, LERCState* sp, unsigned int new_size,
+                      const char* module)
+{
+        if( sp->compressed_size < new_size )
+        {
+            _TIFFfree(sp->compressed_buffer);
+            sp->compressed_buffer = (uint8*)_TIFFmalloc(new_size);
+            if( !sp->compressed_buffer )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                             "Cannot allocate buffer");
+                sp->compressed_size = 0;
+                return 0;
+            }
+            sp->compressed_size = new_size;
+        }
+        return 1;
+}
+
+/*
+* Setup state for decoding a strip: the whole strip or tile is decoded
+* here, and LERCDecode() only copies from the decoded buffer.
+*/
+static int
+LERCPreDecode(TIFF* tif, uint16 s)
+{
+        static const char module[] = "LERCPreDecode";
+        lerc_status lerc_ret;
+        TIFFDirectory *td = &tif->tif_dir;
+        LERCState* sp = DecoderState(tif);
+        int lerc_data_type;
+        unsigned int infoArray[8];
+        unsigned int nPixels;
+        const uint8* lerc_data = tif->tif_rawcp;
+        unsigned int lerc_data_size = (unsigned int)tif->tif_rawcc;
+
+        (void) s;
+        assert(sp != NULL);
+        if( (sp->state & LSTATE_INIT_DECODE) == 0 )
+            tif->tif_setupdecode(tif);
+
+        lerc_data_type = GetLercDataType(tif);
+        if( lerc_data_type < 0 )
+            return 0;
+
+        if( !SetupUncompressedBuffer(tif, sp, module) )
+            return 0;
+
+        if( sp->additional_compression != LERC_ADD_COMPRESSION_NONE )
+        {
+            if( !SetupCompressedBuffer(tif, sp, sp->uncompressed_alloc,
+                                       module) )
+                return 0;
+        }
+
+        if( sp->additional_compression == LERC_ADD_COMPRESSION_DEFLATE )
+        {
+            z_stream strm;
+            int zlib_ret;
+
+            memset(&strm, 0, sizeof(strm));
+            strm.zalloc = NULL;
+            strm.zfree = NULL;
+            strm.opaque = NULL;
+            zlib_ret = inflateInit(&strm);
+            if( zlib_ret != Z_OK )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                         "inflateInit() failed");
+                inflateEnd(&strm);
+                return 0;
+            }
+
+            strm.avail_in = (uInt)tif->tif_rawcc;
+            strm.next_in = tif->tif_rawcp;
+            strm.avail_out = sp->compressed_size;
+            strm.next_out = sp->compressed_buffer;
+            zlib_ret = inflate(&strm, Z_FINISH);
+            if( zlib_ret != Z_STREAM_END && zlib_ret != Z_OK )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                         "inflate() failed");
+                inflateEnd(&strm);
+                return 0;
+            }
+            lerc_data = sp->compressed_buffer;
+            lerc_data_size = sp->compressed_size - strm.avail_out;
+            inflateEnd(&strm);
+        }
+        else if( sp->additional_compression == LERC_ADD_COMPRESSION_ZSTD )
+        {
+#ifdef ZSTD_SUPPORT
+            size_t zstd_ret;
+
+            zstd_ret = ZSTD_decompress(sp->compressed_buffer,
+                                       sp->compressed_size,
+                                       tif->tif_rawcp,
+                                       tif->tif_rawcc);
+            if( ZSTD_isError(zstd_ret) ) {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                             "Error in ZSTD_decompress(): %s",
+                             ZSTD_getErrorName(zstd_ret));
+                return 0;
+            }
+
+            lerc_data = sp->compressed_buffer;
+            lerc_data_size = (unsigned int)zstd_ret;
+#else
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "ZSTD support missing");
+            return 0;
+#endif
+        }
+        else if( sp->additional_compression != LERC_ADD_COMPRESSION_NONE )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Unhandled additional compression");
+            return 0;
+        }
+
+        lerc_ret = lerc_getBlobInfo(lerc_data, lerc_data_size,
+                                    infoArray, NULL, 8, 0);
+        if( lerc_ret != LERC_OK )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "lerc_getBlobInfo() failed");
+            return 0;
+        }
+        if( infoArray[1] != (unsigned int)lerc_data_type ||
+            infoArray[3] != sp->segment_width ||
+            infoArray[4] != sp->segment_height ||
+            infoArray[5] != 1 )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "LERC blob does not match the strip/tile "
+                         "characteristics");
+            return 0;
+        }
+
+        /* Invalid pixels are left to 0, or NaN for floating point data */
+        nPixels = sp->segment_width * sp->segment_height;
+        memset(sp->uncompressed_buffer, 0, sp->uncompressed_size);
+        if( infoArray[6] < nPixels )
+        {
+            if( sp->mask_size < nPixels )
+            {
+                _TIFFfree(sp->mask_buffer);
+                sp->mask_buffer = (uint8*)_TIFFmalloc(nPixels);
+                if( !sp->mask_buffer )
+                {
+                    TIFFErrorExt(tif->tif_clientdata, module,
+                                 "Cannot allocate buffer");
+                    sp->mask_size = 0;
+                    return 0;
+                }
+                sp->mask_size = nPixels;
+            }
+        }
+
+        lerc_ret = lerc_decode(lerc_data, lerc_data_size,
+                               infoArray[6] < nPixels ? sp->mask_buffer : NULL,
+                               1, sp->segment_width, sp->segment_height, 1,
+                               lerc_data_type, sp->uncompressed_buffer);
+        if( lerc_ret != LERC_OK )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "lerc_decode() failed");
+            return 0;
+        }
+
+        if( infoArray[6] < nPixels &&
+            td->td_sampleformat == SAMPLEFORMAT_IEEEFP )
+        {
+            unsigned int i;
+            if( td->td_bitspersample == 32 )
+            {
+                float* pafData = (float*)sp->uncompressed_buffer;
+                for( i = 0; i < nPixels; i++ )
+                {
+                    if( !sp->mask_buffer[i] )
+                        pafData[i] = (float)NAN;
+                }
+            }
+            else
+            {
+                double* padfData = (double*)sp->uncompressed_buffer;
+                for( i = 0; i < nPixels; i++ )
+                {
+                    if( !sp->mask_buffer[i] )
+                        padfData[i] = NAN;
+                }
+            }
+        }
+
+        tif->tif_rawcp += tif->tif_rawcc;
+        tif->tif_rawcc = 0;
+
+        return 1;
+}
+
+/*
+* Decode a strip, tile or scanline.
+*/
+static int
+LERCDecode(TIFF* tif, uint8* op, tmsize_t occ, uint16 s)
+{
+        static const char module[] = "LERCDecode";
+        LERCState* sp = DecoderState(tif);
+
+        (void) s;
+        assert(sp != NULL);
+        assert(sp->state == LSTATE_INIT_DECODE);
+
+        if( sp->uncompressed_buffer == NULL ||
+            (uint64)sp->uncompressed_offset + (uint64)occ >
+                                                sp->uncompressed_size )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Too many bytes read");
+            return 0;
+        }
+
+        memcpy(op, sp->uncompressed_buffer + sp->uncompressed_offset, occ);
+        sp->uncompressed_offset += (unsigned int)occ;
+
+        return 1;
+}
+
+static int
+LERCSetupEncode(TIFF* tif)
+{
+        LERCState* sp = EncoderState(tif);
+
+        assert(sp != NULL);
+        if (sp->state & LSTATE_INIT_DECODE) {
+                sp->state = 0;
+        }
+
+        sp->state |= LSTATE_INIT_ENCODE;
+
+        return 1;
+}
+
+/*
+* Reset encoding state at the start of a strip.
+*/
+static int
+LERCPreEncode(TIFF* tif, uint16 s)
+{
+        static const char module[] = "LERCPreEncode";
+        LERCState *sp = EncoderState(tif);
+
+        (void) s;
+        assert(sp != NULL);
+        if( sp->state != LSTATE_INIT_ENCODE )
+            tif->tif_setupencode(tif);
+
+        if( GetLercDataType(tif) < 0 )
+            return 0;
+
+        if( !SetupUncompressedBuffer(tif, sp, module) )
+            return 0;
+
+        return 1;
+}
+
+/*
+* Encode a chunk of pixels: they are accumulated until LERCPostEncode().
+*/
+static int
+LERCEncode(TIFF* tif, uint8* bp, tmsize_t cc, uint16 s)
+{
+        static const char module[] = "LERCEncode";
+        LERCState *sp = EncoderState(tif);
+
+        (void)s;
+        assert(sp != NULL);
+        assert(sp->state == LSTATE_INIT_ENCODE);
+
+        if( (uint64)sp->uncompressed_offset +
+                                    (uint64)cc > sp->uncompressed_size )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Too many bytes written");
+            return 0;
+        }
+
+        memcpy(sp->uncompressed_buffer + sp->uncompressed_offset,
+               bp, cc);
+        sp->uncompressed_offset += (unsigned int)cc;
+
+        return 1;
+}
+
+/*
+* Append data to the raw buffer, flushing it when it is full.
+*/
+static int
+LERCWriteRaw(TIFF* tif, const uint8* data, tmsize_t size)
+{
+        while( size > 0 )
+        {
+            tmsize_t n = tif->tif_rawdatasize - tif->tif_rawcc;
+            if( n > size )
+                n = size;
+            memcpy(tif->tif_rawcp, data, n);
+            tif->tif_rawcp += n;
+            tif->tif_rawcc += n;
+            data += n;
+            size -= n;
+            if( tif->tif_rawcc >= tif->tif_rawdatasize &&
+                !TIFFFlushData1(tif) )
+                return 0;
+        }
+        return 1;
+}
+
+/*
+* LERC dequantizes in double precision, and the result is then rounded to
+* the sample type.  For floating point samples, that rounding can add up
+* to half an ulp on top of the requested error, so shrink the error passed
+* to the encoder by one ulp of the largest finite magnitude of the segment.
+*/
+static double
+GetEncoderMaxZError(LERCState* sp, int lerc_data_type)
+{
+        double max_abs = 0.0;
+        double epsilon;
+        double max_z_error;
+        tmsize_t i;
+
+        if( sp->maxzerror <= 0.0 )
+            return sp->maxzerror;
+
+        if( lerc_data_type == LERC_DT_FLOAT )
+        {
+            const float* values = (const float*)sp->uncompressed_buffer;
+            const tmsize_t count = sp->uncompressed_size / sizeof(float);
+            for( i = 0; i < count; i++ )
+            {
+                const double v = fabs((double)values[i]);
+                if( v > max_abs && v <= FLT_MAX )
+                    max_abs = v;
+            }
+            epsilon = FLT_EPSILON;
+        }
+        else if( lerc_data_type == LERC_DT_DOUBLE )
+        {
+            const double* values = (const double*)sp->uncompressed_buffer;
+            const tmsize_t count = sp->uncompressed_size / sizeof(double);
+            for( i = 0; i < count; i++ )
+            {
+                const double v = fabs(values[i]);
+                if( v > max_abs && v <= DBL_MAX )
+                    max_abs = v;
+            }
+            epsilon = DBL_EPSILON;
+        }
+        else
+        {
+            return sp->maxzerror;
+        }
+
+        max_z_error = sp->maxzerror - max_abs * epsilon;
+        return max_z_error > 0.0 ? max_z_error : 0.0;
+}
+
+/*
+* Finish off an encoded strip by flushing it.
+*/
+static int
+LERCPostEncode(TIFF* tif)
+{
+        static const char module[] = "LERCPostEncode";
+        lerc_status lerc_ret;
+        LERCState *sp = EncoderState(tif);
+        unsigned int numBytes = 0;
+        unsigned int numBytesWritten = 0;
+        int lerc_data_type;
+        double max_z_error;
+
+        if( sp->uncompressed_offset != sp->uncompressed_size )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Unexpected number of bytes in the buffer");
+            return 0;
+        }
+
+        lerc_data_type = GetLercDataType(tif);
+        if( lerc_data_type < 0 )
+            return 0;
+
+        max_z_error = GetEncoderMaxZError(sp, lerc_data_type);
+
+        lerc_ret = lerc_computeCompressedSize(
+            sp->uncompressed_buffer,
+            lerc_data_type,
+            1,
+            sp->segment_width,
+            sp->segment_height,
+            1,
+            NULL,
+            max_z_error,
+            &numBytes);
+        if( lerc_ret != LERC_OK )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "lerc_computeCompressedSize() failed");
+            return 0;
+        }
+
+        if( !SetupCompressedBuffer(tif, sp, numBytes, module) )
+            return 0;
+
+        lerc_ret = lerc_encode(sp->uncompressed_buffer,
+                               lerc_data_type,
+                               1,
+                               sp->segment_width,
+                               sp->segment_height,
+                               1,
+                               NULL,
+                               max_z_error,
+                               sp->compressed_buffer,
+                               sp->compressed_size,
+                               &numBytesWritten);
+        if( lerc_ret != LERC_OK )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "lerc_encode() failed");
+            return 0;
+        }
+        assert( numBytesWritten == numBytes );
+
+        if( sp->additional_compression == LERC_ADD_COMPRESSION_DEFLATE )
+        {
+            z_stream strm;
+            int zlib_ret;
+
+            memset(&strm, 0, sizeof(strm));
+            strm.zalloc = NULL;
+            strm.zfree = NULL;
+            strm.opaque = NULL;
+            zlib_ret = deflateInit(&strm, sp->zipquality);
+            if( zlib_ret != Z_OK )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                         "deflateInit() failed");
+                return 0;
+            }
+
+            strm.avail_in = numBytes;
+            strm.next_in = sp->compressed_buffer;
+            /* The uncompressed buffer is no longer needed: reuse it */
+            strm.avail_out = sp->uncompressed_alloc;
+            strm.next_out = sp->uncompressed_buffer;
+            zlib_ret = deflate(&strm, Z_FINISH);
+            if( zlib_ret != Z_STREAM_END )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                         "deflate() failed");
+                deflateEnd(&strm);
+                return 0;
+            }
+            {
+                int ret = LERCWriteRaw(tif, sp->uncompressed_buffer,
+                                (tmsize_t)(sp->uncompressed_alloc -
+                                           strm.avail_out));
+                deflateEnd(&strm);
+                if( !ret )
+                    return 0;
+            }
+        }
+        else if( sp->additional_compression == LERC_ADD_COMPRESSION_ZSTD )
+        {
+#ifdef ZSTD_SUPPORT
+            size_t zstd_ret = ZSTD_compress(sp->uncompressed_buffer,
+                                            sp->uncompressed_alloc,
+                                            sp->compressed_buffer,
+                                            numBytes,
+                                            sp->zstd_compress_level);
+            if( ZSTD_isError(zstd_ret) ) {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                             "Error in ZSTD_compress(): %s",
+                             ZSTD_getErrorName(zstd_ret));
+                return 0;
+            }
+            if( !LERCWriteRaw(tif, sp->uncompressed_buffer,
+                              (tmsize_t)zstd_ret) )
+                return 0;
+#else
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "ZSTD support missing");
+            return 0;
+#endif
+        }
+        else if( sp->additional_compression != LERC_ADD_COMPRESSION_NONE )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Unhandled additional compression");
+            return 0;
+        }
+        else
+        {
+            if( !LERCWriteRaw(tif, sp->compressed_buffer, numBytes) )
+                return 0;
+        }
+
+        return 1;
+}
+
+static void
+LERCCleanup(TIFF* tif)
+{
+        LERCState* sp = LState(tif);
+
+        assert(sp != 0);
+
+        tif->tif_tagmethods.vgetfield = sp->vgetparent;
+        tif->tif_tagmethods.vsetfield = sp->vsetparent;
+
+        _TIFFfree(sp->uncompressed_buffer);
+        _TIFFfree(sp->compressed_buffer);
+        _TIFFfree(sp->mask_buffer);
+
+        _TIFFfree(sp);
+        tif->tif_data = NULL;
+
+        _TIFFSetDefaultCompressionState(tif);
+}
+
+static const TIFFField LERCFields[] = {
+        { TIFFTAG_LERC_PARAMETERS, TIFF_VARIABLE2, TIFF_VARIABLE2,
+          TIFF_LONG, 0, TIFF_SETGET_C32_UINT32, TIFF_SETGET_UNDEFINED,
+          FIELD_CUSTOM, FALSE, TRUE, "LercParameters", NULL },
+        { TIFFTAG_LERC_MAXZERROR, 0, 0, TIFF_ANY, 0, TIFF_SETGET_DOUBLE,
+          TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, TRUE, FALSE, "LercMaximumError", NULL },
+        { TIFFTAG_LERC_VERSION, 0, 0, TIFF_ANY, 0, TIFF_SETGET_UINT32,
+          TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, FALSE, FALSE, "LercVersion", NULL },
+        { TIFFTAG_LERC_ADD_COMPRESSION, 0, 0, TIFF_ANY, 0,
+          TIFF_SETGET_UINT32, TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, FALSE, FALSE, "LercAdditionalCompression", NULL },
+        { TIFFTAG_ZSTD_LEVEL, 0, 0, TIFF_ANY, 0, TIFF_SETGET_INT,
+          TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, TRUE, FALSE, "ZSTD compression_level", NULL },
+        { TIFFTAG_ZIPQUALITY, 0, 0, TIFF_ANY, 0, TIFF_SETGET_INT,
+          TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, TRUE, FALSE, "", NULL },
+};
+
+/*
+* Forward a tag to the parent set method, with a fresh argument list.
+*/
+static int
+LERCVSetParentField(TIFF* tif, uint32 tag, ...)
+{
+        LERCState* sp = LState(tif);
+        va_list ap;
+        int ret;
+
+        va_start(ap, tag);
+        ret = (*sp->vsetparent)(tif, tag, ap);
+        va_end(ap);
+        return ret;
+}
+
+/*
+* Update the LercParameters tag from the state.
+*/
+static int
+LERCUpdateParameters(TIFF* tif)
+{
+        LERCState* sp = LState(tif);
+        uint32 params[2];
+
+        params[0] = (uint32)sp->lerc_version;
+        params[1] = (uint32)sp->additional_compression;
+        return LERCVSetParentField(tif, TIFFTAG_LERC_PARAMETERS,
+                                   (uint32)2, params);
+}
+
+static int
+LERCVSetField(TIFF* tif, uint32 tag, va_list ap)
+{
+        static const char module[] = "LERCVSetField";
+        LERCState* sp = LState(tif);
+
+        switch (tag) {
+        case TIFFTAG_LERC_MAXZERROR:
+                sp->maxzerror = va_arg(ap, double);
+                return 1;
+        case TIFFTAG_LERC_VERSION:
+        {
+                int version = va_arg(ap, int);
+                if( version != LERC_VERSION_2_4 )
+                {
+                    TIFFErrorExt(tif->tif_clientdata, module,
+                                 "Invalid value for LercVersion: %d", version);
+                    return 0;
+                }
+                sp->lerc_version = version;
+                return LERCUpdateParameters(tif);
+        }
+        case TIFFTAG_LERC_ADD_COMPRESSION:
+                sp->additional_compression = va_arg(ap, int);
+#ifndef ZSTD_SUPPORT
+                if( sp->additional_compression == LERC_ADD_COMPRESSION_ZSTD )
+                {
+                    TIFFErrorExt(tif->tif_clientdata, module,
+                                 "LERC_ZSTD requested, but ZSTD not available");
+                    return 0;
+                }
+#endif
+                if( sp->additional_compression != LERC_ADD_COMPRESSION_NONE &&
+                    sp->additional_compression != LERC_ADD_COMPRESSION_DEFLATE &&
+                    sp->additional_compression != LERC_ADD_COMPRESSION_ZSTD )
+                {
+                    TIFFErrorExt(tif->tif_clientdata, module,
+                                 "Invalid value for LercAdditionalCompression: %d",
+                                 sp->additional_compression);
+                    return 0;
+                }
+                return LERCUpdateParameters(tif);
+        case TIFFTAG_LERC_PARAMETERS:
+        {
+                uint32 count = va_arg(ap, uint32);
+                uint32* params = va_arg(ap, uint32*);
+                if( count < 2 || params == NULL )
+                {
+                    TIFFErrorExt(tif->tif_clientdata, module,
+                                 "Invalid count for LercParameters: %u", count);
+                    return 0;
+                }
+                sp->lerc_version = (int)params[0];
+                sp->additional_compression = (int)params[1];
+                return LERCVSetParentField(tif, tag, count, params);
+        }
+        case TIFFTAG_ZSTD_LEVEL:
+                sp->zstd_compress_level = (int) va_arg(ap, int);
+#ifdef ZSTD_SUPPORT
+                if( sp->zstd_compress_level <= 0 ||
+                    sp->zstd_compress_level > ZSTD_maxCLevel() )
+                {
+                    TIFFWarningExt(tif->tif_clientdata, module,
+                                   "ZSTD_LEVEL should be between 1 and %d",
+                                   ZSTD_maxCLevel());
+                }
+#endif
+                return 1;
+        case TIFFTAG_ZIPQUALITY:
+                sp->zipquality = (int) va_arg(ap, int);
+                return 1;
+        default:
+                return (*sp->vsetparent)(tif, tag, ap);
+        }
+        /*NOTREACHED*/
+}
+
+static int
+LERCVGetField(TIFF* tif, uint32 tag, va_list ap)
+{
+        LERCState* sp = LState(tif);
+
+        switch (tag) {
+        case TIFFTAG_LERC_MAXZERROR:
+                *va_arg(ap, double*) = sp->maxzerror;
+                break;
+        case TIFFTAG_LERC_VERSION:
+                *va_arg(ap, int*) = sp->lerc_version;
+                break;
+        case TIFFTAG_LERC_ADD_COMPRESSION:
+                *va_arg(ap, int*) = sp->additional_compression;
+                break;
+        case TIFFTAG_ZSTD_LEVEL:
+                *va_arg(ap, int*) = sp->zstd_compress_level;
+                break;
+        case TIFFTAG_ZIPQUALITY:
+                *va_arg(ap, int*) = sp->zipquality;
+                break;
+        default:
+                return (*sp->vgetparent)(tif, tag, ap);
+        }
+        return 1;
+}
+
+int
+TIFFInitLERC(TIFF* tif, int scheme)
+{
+        static const char module[] = "TIFFInitLERC";
+        LERCState* sp;
+
+        assert( scheme == COMPRESSION_LERC );
+
+        /*
+        * Merge codec-specific tag information.
+        */
+        if (!_TIFFMergeFields(tif, LERCFields, TIFFArrayCount(LERCFields))) {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                            "Merging LERC codec-specific tags failed");
+                return 0;
+        }
+
+        /*
+        * Allocate state block so tag methods have storage to record values.
+        */
+        tif->tif_data = (uint8*) _TIFFcalloc(1, sizeof(LERCState));
+        if (tif->tif_data == NULL)
+                goto bad;
+        sp = LState(tif);
+
+        /*
+        * Override parent get/set field methods.
+        */
+        sp->vgetparent = tif->tif_tagmethods.vgetfield;
+        tif->tif_tagmethods.vgetfield = LERCVGetField;	/* hook for codec tags */
+        sp->vsetparent = tif->tif_tagmethods.vsetfield;
+        tif->tif_tagmethods.vsetfield = LERCVSetField;	/* hook for codec tags */
+
+        /*
+        * Install codec methods.
+        */
+        tif->tif_fixuptags = LERCFixupTags;
+        tif->tif_setupdecode = LERCSetupDecode;
+        tif->tif_predecode = LERCPreDecode;
+        tif->tif_decoderow = LERCDecode;
+        tif->tif_decodestrip = LERCDecode;
+        tif->tif_decodetile = LERCDecode;
+        tif->tif_setupencode = LERCSetupEncode;
+        tif->tif_preencode = LERCPreEncode;
+        tif->tif_postencode = LERCPostEncode;
+        tif->tif_encoderow = LERCEncode;
+        tif->tif_encodestrip = LERCEncode;
+        tif->tif_encodetile = LERCEncode;
+        tif->tif_cleanup = LERCCleanup;
+
+        /* Default values for codec-specific fields */
+        TIFFSetField(tif, TIFFTAG_LERC_VERSION, LERC_VERSION_2_4);
+        TIFFSetField(tif, TIFFTAG_LERC_ADD_COMPRESSION,
+                     LERC_ADD_COMPRESSION_NONE);
+        sp->maxzerror = 0.0;
+        sp->zstd_compress_level = 9;		/* default comp. level */
+        sp->zipquality = Z_DEFAULT_COMPRESSION;	/* default comp. level */
+        sp->state = 0;
+
+        return 1;
+bad:
+        TIFFErrorExt(tif->tif_clientdata, module,
+                     "No space for LERC state block");
+        return 0;
+}
+#endif /* LERC_SUPPORT */
+
+/* vim: set ts=8 sts=8 sw=8 noet: */
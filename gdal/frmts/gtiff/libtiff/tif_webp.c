@@ -0,0 +1,528 @@
+/*
+* Copyright (c) 2018, GDAL contributors
+*
+* Permission to use, copy, modify, distribute, and sell this software and
+* its documentation for any purpose is hereby granted without fee, provided
+* that (i) the above copyright notices and this permission notice appear in
+* all copies of the software and related documentation, and (ii) the names of
+* Sam Leffler and Silicon Graphics may not be used in any advertising or
+* publicity relating to the software without the specific, prior written
+* permission of Sam Leffler and Silicon Graphics.
+*
+* THE SOFTWARE IS PROVIDED "AS-IS" AND WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS, IMPLIED OR OTHERWISE, INCLUDING WITHOUT LIMITATION, ANY
+* WARRANTY OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.
+*
+* IN NO EVENT SHALL SAM LEFFLER OR SILICON GRAPHICS BE LIABLE FOR
+* ANY SPECIAL, INCIDENTAL, INDIRECT OR CONSEQUENTIAL DAMAGES OF ANY KIND,
+* OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+* WHETHER OR NOT ADVISED OF THE POSSIBILITY OF DAMAGE, AND ON ANY THEORY OF
+* LIABILITY, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+* OF THIS SOFTWARE.
+*/
+
+#include "tiffiop.h"
+#ifdef WEBP_SUPPORT
+/*
+* TIFF Library.
+*
+* WEBP Compression Support
+*
+* Each strip or tile is a WebP image. Only 8 bit RGB or RGBA data with
+* PlanarConfiguration=Contig is supported.
+*/
+
+#include "webp/decode.h"
+#include "webp/encode.h"
+
+#include <assert.h>
+
+/*
+* State block for each open TIFF file using WEBP compression/decompression.
+*/
+typedef struct {
+        int             quality_level;          /* compression level */
+        int             lossless;               /* 1=lossless, 0=lossy */
+        int             state;                  /* state flags */
+
+        uint32          segment_width;
+        uint32          segment_height;
+
+        unsigned int    buffer_size;
+        unsigned int    buffer_alloc;
+        uint8*          pBuffer;                /* uncompressed strip/tile */
+        unsigned int    buffer_offset;
+
+        TIFFVGetMethod  vgetparent;            /* super-class method */
+        TIFFVSetMethod  vsetparent;            /* super-class method */
+} WebPState;
+
+#define LSTATE_INIT_DECODE 0x01
+#define LSTATE_INIT_ENCODE 0x02
+
+#define LState(tif)             ((WebPState*) (tif)->tif_data)
+#define DecoderState(tif)       LState(tif)
+#define EncoderState(tif)       LState(tif)
+
+static int TWebPEncode(TIFF* tif, uint8* bp, tmsize_t cc, uint16 s);
+static int TWebPDecode(TIFF* tif, uint8* op, tmsize_t occ, uint16 s);
+
+static int
+TWebPFixupTags(TIFF* tif)
+{
+        (void) tif;
+        return 1;
+}
+
+/*
+* Checks that the image is 8 bit RGB or RGBA, and computes the dimensions
+* of the current strip or tile.
+*/
+static int
+TWebPSetupBuffer(TIFF* tif, WebPState* sp, const char* module)
+{
+        TIFFDirectory *td = &tif->tif_dir;
+        uint64 buffer_size_64;
+
+        if( td->td_bitspersample != 8 ||
+            td->td_sampleformat != SAMPLEFORMAT_UINT ||
+            (td->td_samplesperpixel != 3 && td->td_samplesperpixel != 4) ||
+            td->td_planarconfig != PLANARCONFIG_CONTIG )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WEBP compression is only supported for 8 bit "
+                         "RGB or RGBA images with PlanarConfiguration=Contig");
+            return 0;
+        }
+
+        if( isTiled(tif) )
+        {
+            sp->segment_width = td->td_tilewidth;
+            sp->segment_height = td->td_tilelength;
+        }
+        else
+        {
+            sp->segment_width = td->td_imagewidth;
+            sp->segment_height = td->td_imagelength - tif->tif_row;
+            if( sp->segment_height > td->td_rowsperstrip )
+                sp->segment_height = td->td_rowsperstrip;
+        }
+
+        if( sp->segment_width > 16383 || sp->segment_height > 16383 )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WEBP maximum image dimensions are 16383 x 16383");
+            return 0;
+        }
+
+        buffer_size_64 = (uint64)sp->segment_width * sp->segment_height *
+                         td->td_samplesperpixel;
+        sp->buffer_size = (unsigned int)buffer_size_64;
+        sp->buffer_offset = 0;
+
+        if( sp->buffer_alloc < sp->buffer_size )
+        {
+            _TIFFfree(sp->pBuffer);
+            sp->pBuffer = (uint8*)_TIFFmalloc(sp->buffer_size);
+            if( !sp->pBuffer )
+            {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                             "Cannot allocate buffer");
+                sp->buffer_alloc = 0;
+                return 0;
+            }
+            sp->buffer_alloc = sp->buffer_size;
+        }
+        return 1;
+}
+
+static int
+TWebPSetupDecode(TIFF* tif)
+{
+        WebPState* sp = DecoderState(tif);
+
+        assert(sp != NULL);
+
+        /* if we were last encoding, terminate this mode */
+        if (sp->state & LSTATE_INIT_ENCODE) {
+            sp->state = 0;
+        }
+
+        sp->state |= LSTATE_INIT_DECODE;
+        return 1;
+}
+
+/*
+* Setup state for decoding a strip: the whole strip or tile is decoded
+* here, and TWebPDecode() only copies from the decoded buffer.
+*/
+static int
+TWebPPreDecode(TIFF* tif, uint16 s)
+{
+        static const char module[] = "TWebPPreDecode";
+        WebPState* sp = DecoderState(tif);
+        TIFFDirectory *td = &tif->tif_dir;
+        int width = 0;
+        int height = 0;
+        uint8* ret;
+
+        (void) s;
+        assert(sp != NULL);
+
+        if( (sp->state & LSTATE_INIT_DECODE) == 0 )
+            tif->tif_setupdecode(tif);
+
+        if( !TWebPSetupBuffer(tif, sp, module) )
+            return 0;
+
+        if( !WebPGetInfo(tif->tif_rawcp, (size_t)tif->tif_rawcc,
+                         &width, &height) )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WebPGetInfo() failed");
+            return 0;
+        }
+        if( (uint32)width != sp->segment_width ||
+            (uint32)height != sp->segment_height )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WebP blob dimensions (%dx%d) do not match "
+                         "the strip/tile dimensions (%ux%u)",
+                         width, height,
+                         sp->segment_width, sp->segment_height);
+            return 0;
+        }
+
+        if( td->td_samplesperpixel == 4 )
+            ret = WebPDecodeRGBAInto(tif->tif_rawcp, (size_t)tif->tif_rawcc,
+                                     sp->pBuffer, sp->buffer_size,
+                                     (int)(sp->segment_width * 4));
+        else
+            ret = WebPDecodeRGBInto(tif->tif_rawcp, (size_t)tif->tif_rawcc,
+                                    sp->pBuffer, sp->buffer_size,
+                                    (int)(sp->segment_width * 3));
+        if( ret == NULL )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WebP decoding failed");
+            return 0;
+        }
+
+        tif->tif_rawcp += tif->tif_rawcc;
+        tif->tif_rawcc = 0;
+
+        return 1;
+}
+
+static int
+TWebPDecode(TIFF* tif, uint8* op, tmsize_t occ, uint16 s)
+{
+        static const char module[] = "TWebPDecode";
+        WebPState* sp = DecoderState(tif);
+
+        (void) s;
+        assert(sp != NULL);
+        assert(sp->state == LSTATE_INIT_DECODE);
+
+        if( (uint64)sp->buffer_offset + (uint64)occ > sp->buffer_size )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Too many bytes read");
+            return 0;
+        }
+
+        memcpy(op, sp->pBuffer + sp->buffer_offset, occ);
+        sp->buffer_offset += (unsigned int)occ;
+
+        return 1;
+}
+
+static int
+TWebPSetupEncode(TIFF* tif)
+{
+        WebPState* sp = EncoderState(tif);
+
+        assert(sp != NULL);
+        if (sp->state & LSTATE_INIT_DECODE) {
+                sp->state = 0;
+        }
+
+        sp->state |= LSTATE_INIT_ENCODE;
+
+        return 1;
+}
+
+/*
+* Reset encoding state at the start of a strip.
+*/
+static int
+TWebPPreEncode(TIFF* tif, uint16 s)
+{
+        static const char module[] = "TWebPPreEncode";
+        WebPState *sp = EncoderState(tif);
+
+        (void) s;
+        assert(sp != NULL);
+        if( sp->state != LSTATE_INIT_ENCODE )
+            tif->tif_setupencode(tif);
+
+        return TWebPSetupBuffer(tif, sp, module);
+}
+
+/*
+* Encode a chunk of pixels: they are accumulated until TWebPPostEncode().
+*/
+static int
+TWebPEncode(TIFF* tif, uint8* bp, tmsize_t cc, uint16 s)
+{
+        static const char module[] = "TWebPEncode";
+        WebPState *sp = EncoderState(tif);
+
+        (void)s;
+        assert(sp != NULL);
+        assert(sp->state == LSTATE_INIT_ENCODE);
+
+        if( (uint64)sp->buffer_offset + (uint64)cc > sp->buffer_size )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Too many bytes written");
+            return 0;
+        }
+
+        memcpy(sp->pBuffer + sp->buffer_offset, bp, cc);
+        sp->buffer_offset += (unsigned int)cc;
+
+        return 1;
+}
+
+/*
+* WebP writer callback: append data to the raw buffer, flushing it when
+* it is full.
+*/
+static int
+TWebPDatasetWriter(const uint8_t* data, size_t data_size,
+                   const WebPPicture* const picture)
+{
+        TIFF* tif = (TIFF*)(picture->custom_ptr);
+
+        while( data_size > 0 )
+        {
+            tmsize_t n = tif->tif_rawdatasize - tif->tif_rawcc;
+            if( (size_t)n > data_size )
+                n = (tmsize_t)data_size;
+            memcpy(tif->tif_rawcp, data, n);
+            tif->tif_rawcp += n;
+            tif->tif_rawcc += n;
+            data += n;
+            data_size -= (size_t)n;
+            if( tif->tif_rawcc >= tif->tif_rawdatasize &&
+                !TIFFFlushData1(tif) )
+                return 0;
+        }
+        return 1;
+}
+
+/*
+* Finish off an encoded strip by flushing it.
+*/
+static int
+TWebPPostEncode(TIFF* tif)
+{
+        static const char module[] = "TWebPPostEncode";
+        WebPState *sp = EncoderState(tif);
+        TIFFDirectory *td = &tif->tif_dir;
+        WebPConfig config;
+        WebPPicture picture;
+        int ok;
+
+        assert(sp != NULL);
+        assert(sp->state == LSTATE_INIT_ENCODE);
+
+        if( sp->buffer_offset != sp->buffer_size )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Unexpected number of bytes in the buffer");
+            return 0;
+        }
+
+        if( !WebPConfigInit(&config) || !WebPPictureInit(&picture) )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "Error initializing WebP library");
+            return 0;
+        }
+        config.quality = (float)sp->quality_level;
+        config.lossless = sp->lossless;
+        if( !WebPValidateConfig(&config) )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WebPValidateConfig() failed");
+            return 0;
+        }
+
+        picture.use_argb = sp->lossless;
+        picture.width = (int)sp->segment_width;
+        picture.height = (int)sp->segment_height;
+        picture.writer = TWebPDatasetWriter;
+        picture.custom_ptr = tif;
+
+        if( td->td_samplesperpixel == 4 )
+            ok = WebPPictureImportRGBA(&picture, sp->pBuffer,
+                                       (int)(sp->segment_width * 4));
+        else
+            ok = WebPPictureImportRGB(&picture, sp->pBuffer,
+                                      (int)(sp->segment_width * 3));
+        if( !ok )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WebPPictureImport() failed");
+            WebPPictureFree(&picture);
+            return 0;
+        }
+
+        if( !WebPEncode(&config, &picture) )
+        {
+            TIFFErrorExt(tif->tif_clientdata, module,
+                         "WebPEncode() failed with error code %d",
+                         (int)picture.error_code);
+            WebPPictureFree(&picture);
+            return 0;
+        }
+
+        WebPPictureFree(&picture);
+        return 1;
+}
+
+static void
+TWebPCleanup(TIFF* tif)
+{
+        WebPState* sp = LState(tif);
+
+        assert(sp != 0);
+
+        tif->tif_tagmethods.vgetfield = sp->vgetparent;
+        tif->tif_tagmethods.vsetfield = sp->vsetparent;
+
+        _TIFFfree(sp->pBuffer);
+        _TIFFfree(sp);
+        tif->tif_data = NULL;
+
+        _TIFFSetDefaultCompressionState(tif);
+}
+
+static int
+TWebPVSetField(TIFF* tif, uint32 tag, va_list ap)
+{
+        static const char module[] = "WebPVSetField";
+        WebPState* sp = LState(tif);
+
+        switch (tag) {
+        case TIFFTAG_WEBP_LEVEL:
+                sp->quality_level = (int) va_arg(ap, int);
+                if( sp->quality_level <= 0 ||
+                    sp->quality_level > 100 )
+                {
+                    TIFFWarningExt(tif->tif_clientdata, module,
+                                   "WEBP_LEVEL should be between 1 and 100");
+                }
+                return 1;
+        case TIFFTAG_WEBP_LOSSLESS:
+                sp->lossless = va_arg(ap, int);
+                return 1;
+        default:
+                return (*sp->vsetparent)(tif, tag, ap);
+        }
+        /*NOTREACHED*/
+}
+
+static int
+TWebPVGetField(TIFF* tif, uint32 tag, va_list ap)
+{
+        WebPState* sp = LState(tif);
+
+        switch (tag) {
+        case TIFFTAG_WEBP_LEVEL:
+                *va_arg(ap, int*) = sp->quality_level;
+                break;
+        case TIFFTAG_WEBP_LOSSLESS:
+                *va_arg(ap, int*) = sp->lossless;
+                break;
+        default:
+                return (*sp->vgetparent)(tif, tag, ap);
+        }
+        return 1;
+}
+
+static const TIFFField TWebPFields[] = {
+        { TIFFTAG_WEBP_LEVEL, 0, 0, TIFF_ANY, 0, TIFF_SETGET_INT,
+          TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, TRUE, FALSE, "WEBP quality", NULL },
+        { TIFFTAG_WEBP_LOSSLESS, 0, 0, TIFF_ANY, 0, TIFF_SETGET_INT,
+          TIFF_SETGET_UNDEFINED,
+          FIELD_PSEUDO, TRUE, FALSE, "WEBP lossless/lossy", NULL },
+};
+
+int
+TIFFInitWebP(TIFF* tif, int scheme)
+{
+        static const char module[] = "TIFFInitWebP";
+        WebPState* sp;
+
+        assert( scheme == COMPRESSION_WEBP );
+
+        /*
+        * Merge codec-specific tag information.
+        */
+        if ( !_TIFFMergeFields(tif, TWebPFields, TIFFArrayCount(TWebPFields)) ) {
+                TIFFErrorExt(tif->tif_clientdata, module,
+                            "Merging WebP codec-specific tags failed");
+                return 0;
+        }
+
+        /*
+        * Allocate state block so tag methods have storage to record values.
+        */
+        tif->tif_data = (uint8*) _TIFFcalloc(1, sizeof(WebPState));
+        if (tif->tif_data == NULL)
+                goto bad;
+        sp = LState(tif);
+
+        /*
+        * Override parent get/set field methods.
+        */
+        sp->vgetparent = tif->tif_tagmethods.vgetfield;
+        tif->tif_tagmethods.vgetfield = TWebPVGetField;	/* hook for codec tags */
+        sp->vsetparent = tif->tif_tagmethods.vsetfield;
+        tif->tif_tagmethods.vsetfield = TWebPVSetField;	/* hook for codec tags */
+
+        /* Default values for codec-specific fields */
+        sp->quality_level = 75;		/* default comp. level */
+        sp->lossless = 0;		/* default to false */
+        sp->state = 0;
+
+        /*
+        * Install codec methods.
+        */
+        tif->tif_fixuptags = TWebPFixupTags;
+        tif->tif_setupdecode = TWebPSetupDecode;
+        tif->tif_predecode = TWebPPreDecode;
+        tif->tif_decoderow = TWebPDecode;
+        tif->tif_decodestrip = TWebPDecode;
+        tif->tif_decodetile = TWebPDecode;
+        tif->tif_setupencode = TWebPSetupEncode;
+        tif->tif_preencode = TWebPPreEncode;
+        tif->tif_postencode = TWebPPostEncode;
+        tif->tif_encoderow = TWebPEncode;
+        tif->tif_encodestrip = TWebPEncode;
+        tif->tif_encodetile = TWebPEncode;
+        tif->tif_cleanup = TWebPCleanup;
+
+        return 1;
+bad:
+        TIFFErrorExt(tif->tif_clientdata, module,
+                     "No space for WebP state block");
+        return 0;
+}
+#endif /* WEBP_SUPPORT */
+
+/* vim: set ts=8 sts=8 sw=8 noet: */
@@ -0,0 +1,300 @@
+/*
+Copyright 2018 GDAL contributors
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+A local copy of the license and additional notices are located with the
+source distribution at:
+
+http://github.com/Esri/lerc/
+*/
+
+//
+// Lerc_c_api.cpp
+//
+
+#include "Lerc_c_api.h"
+#include "Lerc2.h"
+
+#include <climits>
+#include <cstring>
+#include <vector>
+
+USING_NAMESPACE_LERC
+
+// Lerc2 may read a few bytes past the end of a blob while decoding
+static const size_t LERC_DECODE_PADDING = 8;
+
+// -------------------------------------------------------------------------- ;
+
+static bool CheckParams(unsigned int dataType, int nDim, int nCols, int nRows,
+                        int nBands)
+{
+  return dataType <= LERC_DT_DOUBLE && nDim == 1 && nCols > 0 && nRows > 0 &&
+         nBands > 0 && nCols <= INT_MAX / nRows;
+}
+
+// Builds the Lerc2 bit mask from a byte mask. Returns false if all pixels
+// are valid, in which case no mask needs to be encoded.
+static bool BuildBitMask(const unsigned char* pValidBytes, int nCols, int nRows,
+                         BitMask2& bitMask)
+{
+  if (!pValidBytes)
+    return false;
+  const int nPixels = nCols * nRows;
+  bool hasInvalid = false;
+  for (int k = 0; k < nPixels; k++)
+  {
+    if (!pValidBytes[k])
+    {
+      hasInvalid = true;
+      break;
+    }
+  }
+  if (!hasInvalid)
+    return false;
+
+  bitMask.SetSize(nCols, nRows);
+  bitMask.SetAllValid();
+  for (int k = 0; k < nPixels; k++)
+    if (!pValidBytes[k])
+      bitMask.SetInvalid(k);
+  return true;
+}
+
+// -------------------------------------------------------------------------- ;
+
+template<class T>
+static lerc_status EncodeTempl(const T* pData, int nCols, int nRows, int nBands,
+                               const unsigned char* pValidBytes, double maxZErr,
+                               unsigned char* pOutBuffer,
+                               unsigned int outBufferSize,
+                               unsigned int* nBytesWritten)
+{
+  BitMask2 bitMask;
+  const bool hasMask = BuildBitMask(pValidBytes, nCols, nRows, bitMask);
+  const size_t nPixels = static_cast<size_t>(nCols) * nRows;
+
+  unsigned int nTotal = 0;
+  std::vector<Byte> buffer;
+  for (int iBand = 0; iBand < nBands; iBand++)
+  {
+    Lerc2 lerc2(nCols, nRows, hasMask ? bitMask.Bits() : nullptr);
+    const T* arr = pData + iBand * nPixels;
+    const unsigned int numBytes =
+        lerc2.ComputeNumBytesNeededToWrite(arr, maxZErr, hasMask);
+    if (numBytes == 0)
+      return LERC_FAILED;
+
+    if (pOutBuffer)
+    {
+      if (numBytes > outBufferSize - nTotal)
+        return LERC_BUFFER_TOO_SMALL;
+      buffer.resize(numBytes + Lerc2::NumExtraBytesToAllocate());
+      Byte* ptr = &buffer[0];
+      if (!lerc2.Encode(arr, &ptr) ||
+          static_cast<size_t>(ptr - &buffer[0]) != numBytes)
+        return LERC_FAILED;
+      memcpy(pOutBuffer + nTotal, &buffer[0], numBytes);
+    }
+    nTotal += numBytes;
+  }
+  *nBytesWritten = nTotal;
+  return LERC_OK;
+}
+
+static lerc_status Encode(const void* pData, unsigned int dataType,
+                          int nDim, int nCols, int nRows, int nBands,
+                          const unsigned char* pValidBytes, double maxZErr,
+                          unsigned char* pOutBuffer, unsigned int outBufferSize,
+                          unsigned int* nBytesWritten)
+{
+  if (!pData || !nBytesWritten ||
+      !CheckParams(dataType, nDim, nCols, nRows, nBands))
+    return LERC_WRONG_PARAM;
+
+  switch (dataType)
+  {
+#define ENCODE(T) return EncodeTempl(static_cast<const T*>(pData), nCols, nRows, \
+                                     nBands, pValidBytes, maxZErr, pOutBuffer, \
+                                     outBufferSize, nBytesWritten)
+  case LERC_DT_CHAR:    ENCODE(char);
+  case LERC_DT_UCHAR:   ENCODE(Byte);
+  case LERC_DT_SHORT:   ENCODE(short);
+  case LERC_DT_USHORT:  ENCODE(unsigned short);
+  case LERC_DT_INT:     ENCODE(int);
+  case LERC_DT_UINT:    ENCODE(unsigned int);
+  case LERC_DT_FLOAT:   ENCODE(float);
+  case LERC_DT_DOUBLE:  ENCODE(double);
+#undef ENCODE
+  default:
+    break;
+  }
+  return LERC_WRONG_PARAM;
+}
+
+// -------------------------------------------------------------------------- ;
+
+lerc_status lerc_computeCompressedSize(const void* pData, unsigned int dataType,
+                                       int nDim, int nCols, int nRows,
+                                       int nBands,
+                                       const unsigned char* pValidBytes,
+                                       double maxZErr, unsigned int* numBytes)
+{
+  return Encode(pData, dataType, nDim, nCols, nRows, nBands, pValidBytes,
+                maxZErr, nullptr, 0, numBytes);
+}
+
+// -------------------------------------------------------------------------- ;
+
+lerc_status lerc_encode(const void* pData, unsigned int dataType,
+                        int nDim, int nCols, int nRows, int nBands,
+                        const unsigned char* pValidBytes, double maxZErr,
+                        unsigned char* pOutBuffer, unsigned int outBufferSize,
+                        unsigned int* nBytesWritten)
+{
+  if (!pOutBuffer)
+    return LERC_WRONG_PARAM;
+  return Encode(pData, dataType, nDim, nCols, nRows, nBands, pValidBytes,
+                maxZErr, pOutBuffer, outBufferSize, nBytesWritten);
+}
+
+// -------------------------------------------------------------------------- ;
+
+lerc_status lerc_getBlobInfo(const unsigned char* pLercBlob,
+                             unsigned int blobSize,
+                             unsigned int* infoArray, double* dataRangeArray,
+                             int infoArraySize, int dataRangeArraySize)
+{
+  if (!pLercBlob || (infoArraySize > 0 && !infoArray) ||
+      (dataRangeArraySize > 0 && !dataRangeArray))
+    return LERC_WRONG_PARAM;
+
+  Lerc2 lerc2;
+  Lerc2::HeaderInfo first;
+  if (!lerc2.GetHeaderInfo(pLercBlob, blobSize, first) ||
+      first.blobSize <= 0 || static_cast<unsigned int>(first.blobSize) > blobSize)
+    return LERC_FAILED;
+
+  // Count the bands of the same size and type following the first one
+  int nBands = 1;
+  double zMin = first.zMin;
+  double zMax = first.zMax;
+  unsigned int nOffset = first.blobSize;
+  while (nOffset < blobSize)
+  {
+    Lerc2::HeaderInfo hd;
+    if (!lerc2.GetHeaderInfo(pLercBlob + nOffset, blobSize - nOffset, hd) ||
+        hd.blobSize <= 0 ||
+        static_cast<unsigned int>(hd.blobSize) > blobSize - nOffset ||
+        hd.nCols != first.nCols || hd.nRows != first.nRows || hd.dt != first.dt)
+      break;
+    if (hd.zMin < zMin) zMin = hd.zMin;
+    if (hd.zMax > zMax) zMax = hd.zMax;
+    nOffset += hd.blobSize;
+    nBands++;
+  }
+
+  const unsigned int info[8] = {
+    static_cast<unsigned int>(first.version),
+    static_cast<unsigned int>(first.dt), 1,
+    static_cast<unsigned int>(first.nCols),
+    static_cast<unsigned int>(first.nRows),
+    static_cast<unsigned int>(nBands),
+    static_cast<unsigned int>(first.numValidPixel), nOffset };
+  for (int i = 0; i < infoArraySize; i++)
+    infoArray[i] = i < 8 ? info[i] : 0;
+
+  const double range[3] = { zMin, zMax, first.maxZError };
+  for (int i = 0; i < dataRangeArraySize; i++)
+    dataRangeArray[i] = i < 3 ? range[i] : 0;
+
+  return LERC_OK;
+}
+
+// -------------------------------------------------------------------------- ;
+
+template<class T>
+static lerc_status DecodeTempl(const Byte* pBlob, size_t blobSize,
+                               unsigned char* pValidBytes,
+                               int nCols, int nRows, int nBands,
+                               unsigned int dataType, T* pData)
+{
+  const size_t nPixels = static_cast<size_t>(nCols) * nRows;
+  BitMask2 bitMask(nCols, nRows);
+  const Byte* ptr = pBlob;
+  size_t nRemaining = blobSize + LERC_DECODE_PADDING;
+
+  for (int iBand = 0; iBand < nBands; iBand++)
+  {
+    Lerc2 lerc2;
+    Lerc2::HeaderInfo hd;
+    const size_t nConsumed = static_cast<size_t>(ptr - pBlob);
+    if (!lerc2.GetHeaderInfo(ptr, blobSize - nConsumed, hd) ||
+        hd.blobSize <= 0 ||
+        static_cast<size_t>(hd.blobSize) > blobSize - nConsumed)
+      return LERC_FAILED;
+    if (hd.nCols != nCols || hd.nRows != nRows ||
+        static_cast<unsigned int>(hd.dt) != dataType)
+      return LERC_WRONG_PARAM;
+
+    if (!lerc2.Decode(&ptr, nRemaining, pData + iBand * nPixels,
+                      (iBand == 0 && pValidBytes) ? bitMask.Bits() : nullptr))
+      return LERC_FAILED;
+  }
+
+  if (pValidBytes)
+  {
+    for (size_t k = 0; k < nPixels; k++)
+      pValidBytes[k] = bitMask.IsValid(static_cast<int>(k));
+  }
+  return LERC_OK;
+}
+
+lerc_status lerc_decode(const unsigned char* pLercBlob, unsigned int blobSize,
+                        unsigned char* pValidBytes,
+                        int nDim, int nCols, int nRows, int nBands,
+                        unsigned int dataType, void* pData)
+{
+  if (!pLercBlob || !pData || !CheckParams(dataType, nDim, nCols, nRows, nBands))
+    return LERC_WRONG_PARAM;
+
+  std::vector<Byte> blob;
+  try
+  {
+    blob.resize(blobSize + LERC_DECODE_PADDING);
+  }
+  catch (const std::exception&)
+  {
+    return LERC_FAILED;
+  }
+  memcpy(&blob[0], pLercBlob, blobSize);
+
+  switch (dataType)
+  {
+#define DECODE(T) return DecodeTempl(&blob[0], blobSize, pValidBytes, nCols, \
+                                     nRows, nBands, dataType, static_cast<T*>(pData))
+  case LERC_DT_CHAR:    DECODE(char);
+  case LERC_DT_UCHAR:   DECODE(Byte);
+  case LERC_DT_SHORT:   DECODE(short);
+  case LERC_DT_USHORT:  DECODE(unsigned short);
+  case LERC_DT_INT:     DECODE(int);
+  case LERC_DT_UINT:    DECODE(unsigned int);
+  case LERC_DT_FLOAT:   DECODE(float);
+  case LERC_DT_DOUBLE:  DECODE(double);
+#undef DECODE
+  default:
+    break;
+  }
+  return LERC_WRONG_PARAM;
+}
@@ -0,0 +1,88 @@
+/*
+Copyright 2018 GDAL contributors
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+A local copy of the license and additional notices are located with the
+source distribution at:
+
+http://github.com/Esri/lerc/
+*/
+
+//
+// Lerc_c_api.h
+//
+// Subset of the C interface of the Lerc library, implemented on top of
+// Lerc2, so that C code (the libtiff LERC codec) can use it.
+// Only nDim = 1 is supported. With nBands > 1, the blobs of the bands are
+// concatenated.
+//
+
+#ifndef LERC_C_API_H
+#define LERC_C_API_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int lerc_status;
+
+/* lerc_status values */
+#define LERC_OK              0
+#define LERC_FAILED          1
+#define LERC_WRONG_PARAM     2
+#define LERC_BUFFER_TOO_SMALL 3
+#define LERC_NOT_SUPPORTED   4
+
+/* dataType values, same as Lerc2::DataType */
+#define LERC_DT_CHAR    0
+#define LERC_DT_UCHAR   1
+#define LERC_DT_SHORT   2
+#define LERC_DT_USHORT  3
+#define LERC_DT_INT     4
+#define LERC_DT_UINT    5
+#define LERC_DT_FLOAT   6
+#define LERC_DT_DOUBLE  7
+
+/* Size of the blob needed to encode pData. pValidBytes, if not NULL, has
+   one byte per pixel, 0 for invalid pixels. */
+lerc_status lerc_computeCompressedSize(const void* pData, unsigned int dataType,
+                                       int nDim, int nCols, int nRows,
+                                       int nBands,
+                                       const unsigned char* pValidBytes,
+                                       double maxZErr, unsigned int* numBytes);
+
+lerc_status lerc_encode(const void* pData, unsigned int dataType,
+                        int nDim, int nCols, int nRows, int nBands,
+                        const unsigned char* pValidBytes, double maxZErr,
+                        unsigned char* pOutBuffer, unsigned int outBufferSize,
+                        unsigned int* nBytesWritten);
+
+/* infoArray: version, dataType, nDim, nCols, nRows, nBands, nValidPixels,
+   blobSize. dataRangeArray: zMin, zMax, maxZErrorUsed. */
+lerc_status lerc_getBlobInfo(const unsigned char* pLercBlob,
+                             unsigned int blobSize,
+                             unsigned int* infoArray, double* dataRangeArray,
+                             int infoArraySize, int dataRangeArraySize);
+
+/* Invalid pixels of pData are left untouched. */
+lerc_status lerc_decode(const unsigned char* pLercBlob, unsigned int blobSize,
+                        unsigned char* pValidBytes,
+                        int nDim, int nCols, int nRows, int nBands,
+                        unsigned int dataType, void* pData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
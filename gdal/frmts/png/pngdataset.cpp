@@ -46,9 +46,12 @@
 #include "gdal_pam.h"
 #include "png.h"
 
+#include <climits>
 #include <csetjmp>
+#include <cstdlib>
 
 #include <algorithm>
+#include <new>
 
 CPL_CVSID("$Id$")
 
@@ -275,9 +278,18 @@ PNGDataset::PNGDataset() :
     poColorTable(nullptr),
     bGeoTransformValid(FALSE),
     bHasReadXMPMetadata(FALSE),
+    nIDATOffset(0),
+    bRandomAccess(false),
+    bZStreamInitialized(false),
+    nZFileOffset(0),
+    nZChunkRemaining(0),
+    nRowBytes(0),
+    nCheckpointInterval(0),
     bHasTriedLoadWorldFile(FALSE),
     bHasReadICCMetadata(FALSE)
 {
+    memset(&sZStream, 0, sizeof(sZStream));
+
     adfGeoTransform[0] = 0.0;
     adfGeoTransform[1] = 1.0;
     adfGeoTransform[2] = 0.0;
@@ -300,6 +312,10 @@ PNGDataset::~PNGDataset()
     if( hPNG != nullptr )
         png_destroy_read_struct( &hPNG, &psPNGInfo, nullptr );
 
+    FreeCheckpoints();
+    if( bZStreamInitialized )
+        inflateEnd( &sZStream );
+
     if( fpImage )
         VSIFCloseL( fpImage );
 
@@ -619,6 +635,373 @@ static bool safe_png_read_rows(png_structp hPNG,
     return true;
 }
 
+/************************************************************************/
+/*                           FreeCheckpoints()                          */
+/************************************************************************/
+
+void PNGDataset::FreeCheckpoints()
+
+{
+    for( size_t i = 0; i < apsCheckpoints.size(); i++ )
+    {
+        inflateEnd( &(apsCheckpoints[i]->sStream) );
+        CPLFree( apsCheckpoints[i]->pabyPrevRow );
+        CPLFree( apsCheckpoints[i] );
+    }
+    apsCheckpoints.clear();
+}
+
+/************************************************************************/
+/*                          StartRandomAccess()                         */
+/*                                                                      */
+/*      Called instead of Restart() when a non-interlaced image is      */
+/*      read backwards.  From then on, rows are decoded by              */
+/*      DecodeNextRow(), which inflates the IDAT chunks and unfilters   */
+/*      the rows itself, so that the state of the zlib stream can be    */
+/*      saved at regular row intervals and restored later.              */
+/************************************************************************/
+
+bool PNGDataset::StartRandomAccess()
+
+{
+    if( bInterlaced || nIDATOffset == 0 )
+        return false;
+
+    int nChannels = 0;
+    switch( nColorType )
+    {
+        case PNG_COLOR_TYPE_GRAY:       nChannels = 1; break;
+        case PNG_COLOR_TYPE_PALETTE:    nChannels = 1; break;
+        case PNG_COLOR_TYPE_GRAY_ALPHA: nChannels = 2; break;
+        case PNG_COLOR_TYPE_RGB:        nChannels = 3; break;
+        case PNG_COLOR_TYPE_RGB_ALPHA:  nChannels = 4; break;
+        default: break;
+    }
+    if( nChannels != nBands )
+        return false;
+
+    const GIntBig nRowBytesBig =
+        (static_cast<GIntBig>(nRasterXSize) * nChannels * nBitDepth + 7) / 8;
+    if( nRowBytesBig > INT_MAX - 1 )
+        return false;
+    nRowBytes = static_cast<int>(nRowBytesBig);
+
+    // By default, save a checkpoint every 1 MB of uncompressed data. Each
+    // checkpoint costs about 40 KB plus one row of memory, that is to say
+    // about 5% of the size of the uncompressed image.
+    const char* pszInterval =
+        CPLGetConfigOption("GDAL_PNG_CHECKPOINT_INTERVAL", nullptr);
+    if( pszInterval != nullptr )
+        nCheckpointInterval = atoi(pszInterval);
+    else
+        nCheckpointInterval = std::max(1, 1024 * 1024 / nRowBytes);
+    if( nCheckpointInterval <= 0 )
+        return false;
+
+    try
+    {
+        abyZInBuf.resize(65536);
+        abyFilteredRow.resize(nRowBytes + 1);
+        abyPrevRow.resize(nRowBytes);
+    }
+    catch( const std::bad_alloc& )
+    {
+        return false;
+    }
+
+    if( !ResetZStream() )
+        return false;
+
+    CPLDebug("PNG", "Switching to random access mode, "
+             "with a checkpoint every %d rows", nCheckpointInterval);
+    bRandomAccess = true;
+    return true;
+}
+
+/************************************************************************/
+/*                            ResetZStream()                            */
+/*                                                                      */
+/*      Position the decoder at the start of the first IDAT chunk.      */
+/************************************************************************/
+
+bool PNGDataset::ResetZStream()
+
+{
+    // nIDATOffset is the start of the data of the first IDAT chunk, just
+    // after its length and type.
+    GByte abyHeader[8];
+    if( VSIFSeekL( fpImage, nIDATOffset - 8, SEEK_SET ) != 0 ||
+        VSIFReadL( abyHeader, 8, 1, fpImage ) != 1 ||
+        memcmp( abyHeader + 4, "IDAT", 4 ) != 0 )
+    {
+        return false;
+    }
+    GUInt32 nLength;
+    memcpy( &nLength, abyHeader, 4 );
+    CPL_MSBPTR32( &nLength );
+
+    if( bZStreamInitialized )
+        inflateEnd( &sZStream );
+    memset( &sZStream, 0, sizeof(sZStream) );
+    bZStreamInitialized = inflateInit( &sZStream ) == Z_OK;
+    if( !bZStreamInitialized )
+        return false;
+
+    nZFileOffset = nIDATOffset;
+    nZChunkRemaining = nLength;
+    std::fill( abyPrevRow.begin(), abyPrevRow.end(), static_cast<GByte>(0) );
+    nLastLineRead = -1;
+    return true;
+}
+
+/************************************************************************/
+/*                           CreateCheckpoint()                         */
+/************************************************************************/
+
+void PNGDataset::CreateCheckpoint()
+
+{
+    PNGCheckpoint* psCheckpoint = static_cast<PNGCheckpoint *>(
+        VSI_CALLOC_VERBOSE(1, sizeof(PNGCheckpoint)) );
+    if( psCheckpoint == nullptr )
+        return;
+    psCheckpoint->pabyPrevRow =
+        static_cast<GByte *>( VSI_MALLOC_VERBOSE(nRowBytes) );
+    if( psCheckpoint->pabyPrevRow == nullptr ||
+        inflateCopy( &(psCheckpoint->sStream), &sZStream ) != Z_OK )
+    {
+        CPLFree( psCheckpoint->pabyPrevRow );
+        CPLFree( psCheckpoint );
+        return;
+    }
+
+    // Pending input bytes are not saved: they will be read again from
+    // the file.
+    psCheckpoint->nLine = nLastLineRead + 1;
+    psCheckpoint->nFileOffset = nZFileOffset - sZStream.avail_in;
+    psCheckpoint->nChunkRemaining = nZChunkRemaining + sZStream.avail_in;
+    memcpy( psCheckpoint->pabyPrevRow, &abyPrevRow[0], nRowBytes );
+    apsCheckpoints.push_back( psCheckpoint );
+}
+
+/************************************************************************/
+/*                          RestoreCheckpoint()                         */
+/************************************************************************/
+
+bool PNGDataset::RestoreCheckpoint( const PNGCheckpoint* psCheckpoint )
+
+{
+    if( bZStreamInitialized )
+        inflateEnd( &sZStream );
+    bZStreamInitialized =
+        inflateCopy( &sZStream,
+                     const_cast<z_streamp>(&(psCheckpoint->sStream)) ) == Z_OK;
+    if( !bZStreamInitialized )
+        return false;
+
+    sZStream.next_in = nullptr;
+    sZStream.avail_in = 0;
+    nZFileOffset = psCheckpoint->nFileOffset;
+    nZChunkRemaining = psCheckpoint->nChunkRemaining;
+    memcpy( &abyPrevRow[0], psCheckpoint->pabyPrevRow, nRowBytes );
+    nLastLineRead = psCheckpoint->nLine - 1;
+    return true;
+}
+
+/************************************************************************/
+/*                             FillZInput()                             */
+/*                                                                      */
+/*      Feed the zlib stream with the next bytes of the IDAT chunks.    */
+/************************************************************************/
+
+bool PNGDataset::FillZInput()
+
+{
+    while( nZChunkRemaining == 0 )
+    {
+        // Skip the CRC of the current chunk, and read the length and type
+        // of the next one.
+        GByte abyHeader[12];
+        if( VSIFSeekL( fpImage, nZFileOffset, SEEK_SET ) != 0 ||
+            VSIFReadL( abyHeader, 12, 1, fpImage ) != 1 ||
+            memcmp( abyHeader + 8, "IDAT", 4 ) != 0 )
+        {
+            return false;
+        }
+        memcpy( &nZChunkRemaining, abyHeader + 4, 4 );
+        CPL_MSBPTR32( &nZChunkRemaining );
+        nZFileOffset += 12;
+    }
+
+    const size_t nToRead = std::min( abyZInBuf.size(),
+                                     static_cast<size_t>(nZChunkRemaining) );
+    if( VSIFSeekL( fpImage, nZFileOffset, SEEK_SET ) != 0 ||
+        VSIFReadL( &abyZInBuf[0], nToRead, 1, fpImage ) != 1 )
+    {
+        return false;
+    }
+    sZStream.next_in = &abyZInBuf[0];
+    sZStream.avail_in = static_cast<uInt>(nToRead);
+    nZFileOffset += nToRead;
+    nZChunkRemaining -= static_cast<GUInt32>(nToRead);
+    return true;
+}
+
+/************************************************************************/
+/*                            DecodeNextRow()                           */
+/*                                                                      */
+/*      Inflate and unfilter row nLastLineRead + 1 into abyPrevRow.     */
+/************************************************************************/
+
+bool PNGDataset::DecodeNextRow()
+
+{
+    const int nLine = nLastLineRead + 1;
+    if( nLine > 0 && (nLine % nCheckpointInterval) == 0 &&
+        (apsCheckpoints.empty() || apsCheckpoints.back()->nLine < nLine) )
+    {
+        CreateCheckpoint();
+    }
+
+    sZStream.next_out = &abyFilteredRow[0];
+    sZStream.avail_out = static_cast<uInt>(nRowBytes + 1);
+    while( sZStream.avail_out > 0 )
+    {
+        if( sZStream.avail_in == 0 && !FillZInput() )
+            return false;
+        const int nRet = inflate( &sZStream, Z_NO_FLUSH );
+        if( nRet == Z_STREAM_END && sZStream.avail_out > 0 )
+            return false;
+        if( nRet != Z_OK && nRet != Z_STREAM_END )
+            return false;
+    }
+
+    // Undo the filtering, in place, using the previous row.
+    GByte* pabyRow = &abyFilteredRow[1];
+    const GByte* pabyPrior = &abyPrevRow[0];
+    const int nBPP = std::max(1, nBands * nBitDepth / 8);
+    switch( abyFilteredRow[0] )
+    {
+        case 0:  // None
+            break;
+
+        case 1:  // Sub
+            for( int i = nBPP; i < nRowBytes; i++ )
+                pabyRow[i] = static_cast<GByte>(pabyRow[i] + pabyRow[i-nBPP]);
+            break;
+
+        case 2:  // Up
+            for( int i = 0; i < nRowBytes; i++ )
+                pabyRow[i] = static_cast<GByte>(pabyRow[i] + pabyPrior[i]);
+            break;
+
+        case 3:  // Average
+            for( int i = 0; i < nBPP; i++ )
+                pabyRow[i] = static_cast<GByte>(pabyRow[i] + (pabyPrior[i] >> 1));
+            for( int i = nBPP; i < nRowBytes; i++ )
+                pabyRow[i] = static_cast<GByte>(
+                    pabyRow[i] + ((pabyRow[i-nBPP] + pabyPrior[i]) >> 1));
+            break;
+
+        case 4:  // Paeth
+            for( int i = 0; i < nBPP; i++ )
+                pabyRow[i] = static_cast<GByte>(pabyRow[i] + pabyPrior[i]);
+            for( int i = nBPP; i < nRowBytes; i++ )
+            {
+                const int a = pabyRow[i-nBPP];
+                const int b = pabyPrior[i];
+                const int c = pabyPrior[i-nBPP];
+                const int pa = std::abs(b - c);
+                const int pb = std::abs(a - c);
+                const int pc = std::abs(a + b - 2 * c);
+                const int nPred = (pa <= pb && pa <= pc) ? a :
+                                  (pb <= pc) ? b : c;
+                pabyRow[i] = static_cast<GByte>(pabyRow[i] + nPred);
+            }
+            break;
+
+        default:
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid filter type %d", abyFilteredRow[0]);
+            return false;
+    }
+
+    memcpy( &abyPrevRow[0], pabyRow, nRowBytes );
+    nLastLineRead = nLine;
+    return true;
+}
+
+/************************************************************************/
+/*                      LoadScanlineRandomAccess()                      */
+/************************************************************************/
+
+CPLErr PNGDataset::LoadScanlineRandomAccess( int nLine )
+
+{
+    // Find the last checkpoint before the requested row, and resume from
+    // it if we are past it, or if it saves decoding rows.
+    const PNGCheckpoint* psCheckpoint = nullptr;
+    {
+        size_t nLow = 0;
+        size_t nHigh = apsCheckpoints.size();
+        while( nLow < nHigh )
+        {
+            const size_t nMid = (nLow + nHigh) / 2;
+            if( apsCheckpoints[nMid]->nLine <= nLine )
+                nLow = nMid + 1;
+            else
+                nHigh = nMid;
+        }
+        if( nLow > 0 )
+            psCheckpoint = apsCheckpoints[nLow - 1];
+    }
+
+    bool bOK = true;
+    if( psCheckpoint != nullptr &&
+        (nLine <= nLastLineRead || psCheckpoint->nLine > nLastLineRead + 1) )
+    {
+        bOK = RestoreCheckpoint( psCheckpoint );
+    }
+    else if( nLine <= nLastLineRead )
+    {
+        bOK = ResetZStream();
+    }
+
+    const GUInt32 nErrorCounter = CPLGetErrorCounter();
+    while( bOK && nLine > nLastLineRead )
+        bOK = DecodeNextRow();
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Error while reading row %d%s", nLine,
+                 (nErrorCounter != CPLGetErrorCounter()) ?
+                    CPLSPrintf(": %s", CPLGetLastErrorMsg()) : "");
+        // Force a reset at next request.
+        nLastLineRead = GetRasterYSize();
+        return CE_Failure;
+    }
+
+    if( nBitDepth < 8 )
+    {
+        // Unpack to one byte per sample, as png_set_packing() does.
+        const int nSamples = GetRasterXSize() * nBands;
+        const int nMask = (1 << nBitDepth) - 1;
+        for( int i = 0; i < nSamples; i++ )
+        {
+            const int nBitOffset = i * nBitDepth;
+            pabyBuffer[i] = static_cast<GByte>(
+                (abyPrevRow[nBitOffset / 8] >>
+                    (8 - nBitDepth - (nBitOffset % 8))) & nMask);
+        }
+    }
+    else
+    {
+        memcpy( pabyBuffer, &abyPrevRow[0], nRowBytes );
+    }
+
+    return CE_None;
+}
+
 /************************************************************************/
 /*                            LoadScanline()                            */
 /************************************************************************/
@@ -644,27 +1027,38 @@ CPLErr PNGDataset::LoadScanline( int nLine )
         pabyBuffer = reinterpret_cast<GByte *>(
             CPLMalloc(nPixelOffset * GetRasterXSize() ) );
 
+    png_bytep row = pabyBuffer;
+
     // Otherwise we just try to read the requested row. Do we need to rewind and
-    // start over?
-    if( nLine <= nLastLineRead )
+    // start over? If possible, avoid it by switching to random access mode.
+    if( bRandomAccess ||
+        (nLine <= nLastLineRead && StartRandomAccess()) )
     {
-        Restart();
+        const CPLErr eErr = LoadScanlineRandomAccess( nLine );
+        if( eErr != CE_None )
+            return eErr;
     }
-
-    // Read till we get the desired row.
-    png_bytep row = pabyBuffer;
-    const GUInt32 nErrorCounter = CPLGetErrorCounter();
-    while( nLine > nLastLineRead )
+    else
     {
-        if( !safe_png_read_rows( hPNG, row, sSetJmpContext ) )
+        if( nLine <= nLastLineRead )
         {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                     "Error while reading row %d%s", nLine,
-                     (nErrorCounter != CPLGetErrorCounter()) ?
-                        CPLSPrintf(": %s", CPLGetLastErrorMsg()) : "");
-            return CE_Failure;
+            Restart();
+        }
+
+        // Read till we get the desired row.
+        const GUInt32 nErrorCounter = CPLGetErrorCounter();
+        while( nLine > nLastLineRead )
+        {
+            if( !safe_png_read_rows( hPNG, row, sSetJmpContext ) )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Error while reading row %d%s", nLine,
+                         (nErrorCounter != CPLGetErrorCounter()) ?
+                            CPLSPrintf(": %s", CPLGetLastErrorMsg()) : "");
+                return CE_Failure;
+            }
+            nLastLineRead++;
         }
-        nLastLineRead++;
     }
 
     nBufferStartLine = nLine;
@@ -1034,6 +1428,9 @@ GDALDataset *PNGDataset::OpenStage2( GDALOpenInfo * poOpenInfo, PNGDataset*& poD
     png_set_read_fn( poDS->hPNG, poDS->fpImage, png_vsi_read_data );
     png_read_info( poDS->hPNG, poDS->psPNGInfo );
 
+    // png_read_info() stops just after the header of the first IDAT chunk.
+    poDS->nIDATOffset = VSIFTellL( poDS->fpImage );
+
     // Capture some information from the file that is of interest.
     poDS->nRasterXSize = static_cast<int>(png_get_image_width( poDS->hPNG, poDS->psPNGInfo));
     poDS->nRasterYSize = static_cast<int>(png_get_image_height( poDS->hPNG,poDS->psPNGInfo));
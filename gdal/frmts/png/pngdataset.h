@@ -33,9 +33,11 @@
  *    data as the code is currently structured.
  *  o Interlaced images are read entirely into memory for use.  This is
  *    bad for large images.
- *  o Image reading is always strictly sequential.  Reading backwards will
- *    cause the file to be rewound, and access started again from the
- *    beginning.
+ *  o Image reading is sequential.  For non-interlaced images, reading
+ *    backwards switches to a decoding mode where the state of the zlib
+ *    stream is checkpointed at regular intervals, so that access resumes
+ *    from the nearest checkpoint.  For interlaced images, it causes the
+ *    file to be rewound, and access started again from the beginning.
  *  o 16 bit alpha values are not scaled by to eight bit.
  *
  */
@@ -60,6 +62,7 @@
 #include <csetjmp>
 
 #include <algorithm>
+#include <vector>
 
 #ifdef _MSC_VER
 #  pragma warning(disable:4611)
@@ -73,6 +76,21 @@
 
 class PNGRasterBand;
 
+/************************************************************************/
+/*                            PNGCheckpoint                             */
+/*                                                                      */
+/*      State of the IDAT decoding at the start of a given row.         */
+/************************************************************************/
+
+typedef struct
+{
+    int           nLine;            // Row decoded next from this state.
+    vsi_l_offset  nFileOffset;      // Offset of the next compressed byte.
+    GUInt32       nChunkRemaining;  // Bytes left in the current IDAT chunk.
+    z_stream      sStream;
+    GByte        *pabyPrevRow;      // Unfiltered row nLine - 1.
+} PNGCheckpoint;
+
 #ifdef _MSC_VER
 #pragma warning( push )
 // 'PNGDataset': structure was padded due to __declspec(align()) at line where
@@ -110,6 +128,29 @@ class PNGDataset : public GDALPamDataset
     CPLErr      LoadInterlacedChunk( int );
     void        Restart();
 
+    // Random access to non-interlaced images, used instead of Restart().
+    vsi_l_offset nIDATOffset;
+    bool        bRandomAccess;
+    bool        bZStreamInitialized;
+    z_stream    sZStream;
+    vsi_l_offset nZFileOffset;
+    GUInt32     nZChunkRemaining;
+    int         nRowBytes;
+    int         nCheckpointInterval;
+    std::vector<GByte> abyZInBuf;
+    std::vector<GByte> abyFilteredRow;
+    std::vector<GByte> abyPrevRow;
+    std::vector<PNGCheckpoint*> apsCheckpoints;
+
+    bool        StartRandomAccess();
+    bool        ResetZStream();
+    bool        RestoreCheckpoint( const PNGCheckpoint* psCheckpoint );
+    void        CreateCheckpoint();
+    void        FreeCheckpoints();
+    bool        FillZInput();
+    bool        DecodeNextRow();
+    CPLErr      LoadScanlineRandomAccess( int );
+
     int         bHasTriedLoadWorldFile;
     void        LoadWorldFile();
     CPLString   osWldFilename;
@@ -40,9 +40,11 @@
 #endif
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_virtualmem.h"
@@ -1132,6 +1134,363 @@ RawDataset::RawDataset() {}
 // It's pure virtual function but must be defined, even if empty.
 RawDataset::~RawDataset() {}
 
+/************************************************************************/
+/*                          RawInterleavedChunk                         */
+/*                                                                      */
+/*      Description of the reads needed to fetch a group of scanlines   */
+/*      for all bands of an interleaved request.                        */
+/************************************************************************/
+
+namespace {
+struct RawInterleavedChunk
+{
+    RawRasterBand *poBand = nullptr;
+    vsi_l_offset   nOffset = 0;
+    vsi_l_offset   nReadStride = 0;
+    size_t         nReadSize = 0;
+    int            nReadCount = 0;
+    GByte         *pabyBuffer = nullptr;
+    bool           bOK = false;
+};
+} // namespace
+
+/************************************************************************/
+/*                     SetupRawInterleavedChunk()                       */
+/************************************************************************/
+
+static void SetupRawInterleavedChunk( RawInterleavedChunk &sChunk,
+                                      RawRasterBand *poBand,
+                                      vsi_l_offset nStartOffset,
+                                      int nLineOffset, int iChunkLine,
+                                      int nLines, bool bContiguous,
+                                      size_t nLineSpan,
+                                      GByte *pabyBuffer )
+{
+    sChunk.poBand = poBand;
+    sChunk.nOffset =
+        nStartOffset + static_cast<vsi_l_offset>(iChunkLine) * nLineOffset;
+    sChunk.nReadStride = nLineOffset;
+    sChunk.nReadSize = bContiguous ?
+        static_cast<size_t>(nLines - 1) * nLineOffset + nLineSpan : nLineSpan;
+    sChunk.nReadCount = bContiguous ? 1 : nLines;
+    sChunk.pabyBuffer = pabyBuffer;
+    sChunk.bOK = false;
+}
+
+/************************************************************************/
+/*                             ReadChunk()                              */
+/*                                                                      */
+/*      Run either in the calling thread, or in the read-ahead thread   */
+/*      while the previous chunk is deinterleaved.                      */
+/************************************************************************/
+
+void RawDataset::ReadChunk( void *pJob )
+{
+    RawInterleavedChunk *psChunk = static_cast<RawInterleavedChunk *>(pJob);
+
+    psChunk->bOK = true;
+    for( int i = 0; i < psChunk->nReadCount; i++ )
+    {
+        if( psChunk->poBand->Seek(psChunk->nOffset +
+                                  i * psChunk->nReadStride, SEEK_SET) == -1 ||
+            psChunk->poBand->Read(psChunk->pabyBuffer +
+                                  i * psChunk->nReadSize, 1,
+                                  psChunk->nReadSize) != psChunk->nReadSize )
+        {
+            psChunk->bOK = false;
+            return;
+        }
+    }
+}
+
+/************************************************************************/
+/*                       CanUseInterleavedRead()                        */
+/*                                                                      */
+/*      Check if the requested bands can be fetched with a single read  */
+/*      of each scanline (pixel or line interleaved files), instead of  */
+/*      one read per band.                                              */
+/************************************************************************/
+
+bool RawDataset::CanUseInterleavedRead( int nYOff, int nXSize, int nYSize,
+                                        int nBandCount, int *panBandMap )
+{
+    if( nBandCount < 2 || eAccess != GA_ReadOnly )
+        return false;
+
+    const char *pszGDAL_ONE_BIG_READ =
+        CPLGetConfigOption("GDAL_ONE_BIG_READ", nullptr);
+    if( pszGDAL_ONE_BIG_READ != nullptr && !CPLTestBool(pszGDAL_ONE_BIG_READ) )
+        return false;
+
+    RawRasterBand *poFirstBand =
+        dynamic_cast<RawRasterBand *>(GetRasterBand(panBandMap[0]));
+    if( poFirstBand == nullptr ||
+        poFirstBand->nPixelOffset <= 0 || poFirstBand->nLineOffset <= 0 )
+        return false;
+
+    const int nDTSize = GDALGetDataTypeSizeBytes(poFirstBand->eDataType);
+    vsi_l_offset nMinImgOffset = poFirstBand->nImgOffset;
+    vsi_l_offset nMaxImgOffset = poFirstBand->nImgOffset;
+    for( int iBand = 0; iBand < nBandCount; iBand++ )
+    {
+        RawRasterBand *poBand =
+            dynamic_cast<RawRasterBand *>(GetRasterBand(panBandMap[iBand]));
+        if( poBand == nullptr ||
+            poBand->bIsVSIL != poFirstBand->bIsVSIL ||
+            poBand->fpRawL != poFirstBand->fpRawL ||
+            poBand->fpRaw != poFirstBand->fpRaw ||
+            poBand->nPixelOffset != poFirstBand->nPixelOffset ||
+            poBand->nLineOffset != poFirstBand->nLineOffset ||
+            poBand->eDataType != poFirstBand->eDataType ||
+            poBand->bNativeOrder != poFirstBand->bNativeOrder )
+        {
+            return false;
+        }
+
+        // Sub-byte packed bands (EHdr NBITS < 8) are not described by
+        // their pixel and line offsets.
+        const char *pszNBITS =
+            poBand->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+        if( pszNBITS != nullptr && atoi(pszNBITS) < 8 )
+            return false;
+
+        nMinImgOffset = std::min(nMinImgOffset, poBand->nImgOffset);
+        nMaxImgOffset = std::max(nMaxImgOffset, poBand->nImgOffset);
+    }
+
+    // All the bands must be stored within the same scanline stride, that
+    // is to say the file is not band sequential.
+    if( nMaxImgOffset - nMinImgOffset + nDTSize >
+            static_cast<vsi_l_offset>(poFirstBand->nLineOffset) )
+        return false;
+
+    if( pszGDAL_ONE_BIG_READ == nullptr )
+    {
+        // Do not read more than separate reads of each band would, which
+        // matters for narrow windows in line interleaved files, and do not
+        // bother for small requests or ones already in the block cache.
+        const GIntBig nBandSpan =
+            static_cast<GIntBig>(nXSize - 1) * poFirstBand->nPixelOffset +
+            nDTSize;
+        const GIntBig nLineSpan =
+            nBandSpan + static_cast<GIntBig>(nMaxImgOffset - nMinImgOffset);
+        if( nLineSpan > nBandSpan * nBandCount ||
+            nLineSpan * nYSize < 65536 ||
+            poFirstBand->IsSignificantNumberOfLinesLoaded(nYOff, nYSize) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                          InterleavedRead()                           */
+/*                                                                      */
+/*      Read the window of all requested bands, by chunks of scanlines  */
+/*      each fetched once, and deinterleave them into the user buffer.  */
+/*      With GDAL_RAW_READ_AHEAD=YES, the next chunk is read by a       */
+/*      helper thread while the current one is deinterleaved.           */
+/************************************************************************/
+
+CPLErr RawDataset::InterleavedRead( int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void *pData, GDALDataType eBufType,
+                                    int nBandCount, int *panBandMap,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GSpacing nBandSpace,
+                                    GDALRasterIOExtraArg* psExtraArg )
+{
+    RawRasterBand *poFirstBand =
+        dynamic_cast<RawRasterBand *>(GetRasterBand(panBandMap[0]));
+    if( poFirstBand == nullptr )
+        return CE_Failure;
+
+    const GDALDataType eDataType = poFirstBand->eDataType;
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    const int nPixelOffset = poFirstBand->nPixelOffset;
+    const int nLineOffset = poFirstBand->nLineOffset;
+
+    vsi_l_offset nMinImgOffset = poFirstBand->nImgOffset;
+    for( int iBand = 1; iBand < nBandCount; iBand++ )
+    {
+        nMinImgOffset = std::min(nMinImgOffset,
+            static_cast<RawRasterBand *>(
+                GetRasterBand(panBandMap[iBand]))->nImgOffset);
+    }
+    std::vector<size_t> anBandOffset(nBandCount);
+    size_t nMaxBandOffset = 0;
+    for( int iBand = 0; iBand < nBandCount; iBand++ )
+    {
+        anBandOffset[iBand] = static_cast<size_t>(
+            static_cast<RawRasterBand *>(
+                GetRasterBand(panBandMap[iBand]))->nImgOffset - nMinImgOffset);
+        nMaxBandOffset = std::max(nMaxBandOffset, anBandOffset[iBand]);
+    }
+
+    // Bytes to read for one scanline of all bands.
+    const size_t nLineSpan =
+        static_cast<size_t>(nXSize - 1) * nPixelOffset + nMaxBandOffset +
+        nDTSize;
+
+    // Read consecutive scanlines in a single request, unless the gaps
+    // between them are larger than the useful data.
+    const bool bContiguous =
+        static_cast<size_t>(nLineOffset) <= 2 * nLineSpan;
+    const size_t nBufLineStride = bContiguous ? nLineOffset : nLineSpan;
+
+    // Target about 4 MB per chunk.
+    const int nChunkLines = static_cast<int>(std::max(
+        static_cast<size_t>(1),
+        std::min(static_cast<size_t>(nYSize),
+                 static_cast<size_t>(4 * 1024 * 1024) / nBufLineStride)));
+    const size_t nChunkBytes =
+        (nChunkLines - 1) * nBufLineStride + nLineSpan;
+
+    const bool bReadAhead =
+        nYSize > nChunkLines &&
+        CPLTestBool(CPLGetConfigOption("GDAL_RAW_READ_AHEAD", "NO"));
+
+    GByte *apabyBuffer[2] = { nullptr, nullptr };
+    for( int i = 0; i < (bReadAhead ? 2 : 1); i++ )
+    {
+        apabyBuffer[i] =
+            static_cast<GByte *>(VSI_MALLOC_VERBOSE(nChunkBytes));
+        if( apabyBuffer[i] == nullptr )
+        {
+            CPLFree(apabyBuffer[0]);
+            return CE_Failure;
+        }
+    }
+
+    const vsi_l_offset nStartOffset =
+        nMinImgOffset +
+        static_cast<vsi_l_offset>(nYOff) * nLineOffset +
+        static_cast<vsi_l_offset>(nXOff) * nPixelOffset;
+
+    // Copy the data straight if the file layout matches the user buffer.
+    bool bMemcpy = eBufType == eDataType && nPixelSpace == nPixelOffset &&
+                   nBandSpace == nDTSize &&
+                   nPixelOffset == nBandCount * nDTSize;
+    for( int iBand = 0; bMemcpy && iBand < nBandCount; iBand++ )
+        bMemcpy = anBandOffset[iBand] == static_cast<size_t>(iBand) * nDTSize;
+    const bool bSwap = !poFirstBand->bNativeOrder && eDataType != GDT_Byte;
+
+    RawInterleavedChunk asChunk[2];
+    CPLJoinableThread *hThread = nullptr;
+    int iCur = 0;
+    SetupRawInterleavedChunk(asChunk[0], poFirstBand, nStartOffset,
+                             nLineOffset, 0, std::min(nChunkLines, nYSize),
+                             bContiguous, nLineSpan, apabyBuffer[0]);
+    ReadChunk(&asChunk[0]);
+
+    CPLErr eErr = CE_None;
+    for( int iChunkLine = 0; iChunkLine < nYSize; iChunkLine += nChunkLines )
+    {
+        if( hThread != nullptr )
+        {
+            CPLJoinThread(hThread);
+            hThread = nullptr;
+        }
+
+        const int nLines = std::min(nChunkLines, nYSize - iChunkLine);
+        if( !asChunk[iCur].bOK )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Failed to read scanlines %d to %d.",
+                     nYOff + iChunkLine, nYOff + iChunkLine + nLines - 1);
+            eErr = CE_Failure;
+            break;
+        }
+
+        // Fetch the next chunk while this one is processed.
+        const int iNextChunkLine = iChunkLine + nChunkLines;
+        if( iNextChunkLine < nYSize )
+        {
+            SetupRawInterleavedChunk(
+                asChunk[1 - iCur], poFirstBand, nStartOffset, nLineOffset,
+                iNextChunkLine, std::min(nChunkLines, nYSize - iNextChunkLine),
+                bContiguous, nLineSpan,
+                apabyBuffer[bReadAhead ? 1 - iCur : 0]);
+            if( bReadAhead )
+            {
+                hThread = CPLCreateJoinableThread(ReadChunk,
+                                                  &asChunk[1 - iCur]);
+                if( hThread == nullptr )
+                    ReadChunk(&asChunk[1 - iCur]);
+            }
+        }
+
+        GByte *pabyChunk = asChunk[iCur].pabyBuffer;
+        if( bSwap )
+        {
+            for( int iLine = 0; iLine < nLines; iLine++ )
+            {
+                for( int iBand = 0; iBand < nBandCount; iBand++ )
+                {
+                    GByte *pabyLine = pabyChunk + iLine * nBufLineStride +
+                                      anBandOffset[iBand];
+                    if( GDALDataTypeIsComplex(eDataType) )
+                    {
+                        const int nWordSize = nDTSize / 2;
+                        GDALSwapWordsEx(pabyLine, nWordSize, nXSize,
+                                        nPixelOffset);
+                        GDALSwapWordsEx(pabyLine + nWordSize, nWordSize,
+                                        nXSize, nPixelOffset);
+                    }
+                    else
+                    {
+                        GDALSwapWordsEx(pabyLine, nDTSize, nXSize,
+                                        nPixelOffset);
+                    }
+                }
+            }
+        }
+
+        for( int iLine = 0; iLine < nLines; iLine++ )
+        {
+            const GByte *pabySrcLine = pabyChunk + iLine * nBufLineStride;
+            GByte *pabyDstLine = static_cast<GByte *>(pData) +
+                                 (iChunkLine + iLine) * nLineSpace;
+            if( bMemcpy )
+            {
+                memcpy(pabyDstLine, pabySrcLine,
+                       static_cast<size_t>(nXSize) * nPixelOffset);
+                continue;
+            }
+            for( int iBand = 0; iBand < nBandCount; iBand++ )
+            {
+                GDALCopyWords(pabySrcLine + anBandOffset[iBand],
+                              eDataType, nPixelOffset,
+                              pabyDstLine + iBand * nBandSpace,
+                              eBufType, static_cast<int>(nPixelSpace),
+                              nXSize);
+            }
+        }
+
+        if( psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(1.0 * (iChunkLine + nLines) / nYSize, "",
+                                     psExtraArg->pProgressData) )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        if( iNextChunkLine < nYSize && !bReadAhead )
+            ReadChunk(&asChunk[1 - iCur]);
+        iCur = 1 - iCur;
+    }
+
+    if( hThread != nullptr )
+        CPLJoinThread(hThread);
+
+    CPLFree(apabyBuffer[0]);
+    CPLFree(apabyBuffer[1]);
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /*                                                                      */
@@ -1148,6 +1507,16 @@ CPLErr RawDataset::IRasterIO( GDALRWFlag eRWFlag,
                               GDALRasterIOExtraArg* psExtraArg )
 
 {
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize &&
+        CanUseInterleavedRead(nYOff, nXSize, nYSize,
+                              nBandCount, panBandMap) )
+    {
+        return InterleavedRead(nXOff, nYOff, nXSize, nYSize, pData, eBufType,
+                               nBandCount, panBandMap,
+                               nPixelSpace, nLineSpace, nBandSpace,
+                               psExtraArg);
+    }
+
     const char* pszInterleave = nullptr;
 
     // The default GDALDataset::IRasterIO() implementation would go to
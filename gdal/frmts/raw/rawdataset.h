@@ -61,6 +61,16 @@ class CPL_DLL RawDataset : public GDALPamDataset
          virtual ~RawDataset() = 0;
 
   private:
+    bool        CanUseInterleavedRead( int nYOff, int nXSize, int nYSize,
+                                       int nBandCount, int *panBandMap );
+    CPLErr      InterleavedRead( int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void *pData, GDALDataType eBufType,
+                                 int nBandCount, int *panBandMap,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GSpacing nBandSpace,
+                                 GDALRasterIOExtraArg* psExtraArg );
+    static void ReadChunk( void *pJob );
+
     CPL_DISALLOW_COPY_ASSIGN(RawDataset)
 };
 
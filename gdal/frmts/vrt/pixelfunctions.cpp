@@ -29,6 +29,7 @@
 
 #include <cmath>
 #include "gdal.h"
+#include "gdalsse_priv.h"
 #include "vrtdataset.h"
 
 CPL_CVSID("$Id$")
@@ -194,6 +195,196 @@ static CPLErr ImagPixelFunc( void **papoSources, int nSources, void *pData,
     return CE_None;
 }  // ImagPixelFunc
 
+/************************************************************************/
+/*                        Line based helpers                            */
+/************************************************************************/
+
+/* The pixel functions below process their sources one line at a time.  */
+/* Each source line is converted to double with a single GDALCopyWords() */
+/* call, the computation runs on contiguous arrays (with XMMReg4Double   */
+/* for the arithmetic operations), and the result line is converted to   */
+/* the output buffer type with a single GDALCopyWords() call, instead of */
+/* a data type switch and a GDALCopyWords() call for each pixel.         */
+
+namespace {
+
+class PixelFuncLines
+{
+    double *m_padfLines;
+    int     m_nXSize;
+
+    CPL_DISALLOW_COPY_ASSIGN(PixelFuncLines)
+
+  public:
+    PixelFuncLines( int nLines, int nXSize ) :
+        m_padfLines(static_cast<double *>(
+            VSI_MALLOC3_VERBOSE(nLines, nXSize, sizeof(double)))),
+        m_nXSize(nXSize) {}
+    ~PixelFuncLines() { VSIFree(m_padfLines); }
+
+    bool IsValid() const { return m_padfLines != nullptr; }
+    double *operator[]( int i )
+        { return m_padfLines + static_cast<size_t>(i) * m_nXSize; }
+};
+
+}  // namespace
+
+// Converts a line of a packed source buffer to doubles. For complex
+// sources, the real part, or the imaginary part if bImag is set, is
+// extracted.
+static void LoadLine( const void *pSource, GDALDataType eSrcType,
+                      int nXSize, int iLine, bool bImag, double *padfLine )
+{
+    const int nSrcTypeSize = GDALGetDataTypeSizeBytes( eSrcType );
+    const GByte *pabySrc = static_cast<const GByte *>(pSource) +
+        static_cast<size_t>(iLine) * nXSize * nSrcTypeSize;
+    GDALDataType eType = eSrcType;
+    if( GDALDataTypeIsComplex( eSrcType ) )
+    {
+        eType = GDALGetNonComplexDataType( eSrcType );
+        if( bImag )
+            pabySrc += nSrcTypeSize / 2;
+    }
+    GDALCopyWords( pabySrc, eType, nSrcTypeSize,
+                   padfLine, GDT_Float64, sizeof(double), nXSize );
+}
+
+// Writes a line of results to the output buffer. padfImag may be null
+// for a real result, and is ignored if the output type is not complex.
+static void StoreLine( const double *padfReal, const double *padfImag,
+                       void *pData, int nXSize, int iLine,
+                       GDALDataType eBufType, int nPixelSpace,
+                       int nLineSpace )
+{
+    GByte *pabyDst = static_cast<GByte *>(pData) +
+        static_cast<GPtrDiff_t>(nLineSpace) * iLine;
+    if( padfImag != nullptr && GDALDataTypeIsComplex( eBufType ) )
+    {
+        const GDALDataType eBaseType = GDALGetNonComplexDataType( eBufType );
+        GDALCopyWords( padfReal, GDT_Float64, sizeof(double),
+                       pabyDst, eBaseType, nPixelSpace, nXSize );
+        GDALCopyWords( padfImag, GDT_Float64, sizeof(double),
+                       pabyDst + GDALGetDataTypeSizeBytes( eBaseType ),
+                       eBaseType, nPixelSpace, nXSize );
+    }
+    else
+    {
+        GDALCopyWords( padfReal, GDT_Float64, sizeof(double),
+                       pabyDst, eBufType, nPixelSpace, nXSize );
+    }
+}
+
+// padfAcc[i] += padfVal[i]
+static void AddLine( double *padfAcc, const double *padfVal, int nXSize )
+{
+    int i = 0;
+    for( ; i + 3 < nXSize; i += 4 )
+    {
+        const XMMReg4Double oRes = XMMReg4Double::Load4Val(padfAcc + i) +
+                                   XMMReg4Double::Load4Val(padfVal + i);
+        oRes.Store4Val(padfAcc + i);
+    }
+    for( ; i < nXSize; ++i )
+        padfAcc[i] += padfVal[i];
+}
+
+// padfAcc[i] -= padfVal[i]
+static void SubLine( double *padfAcc, const double *padfVal, int nXSize )
+{
+    int i = 0;
+    for( ; i + 3 < nXSize; i += 4 )
+    {
+        const XMMReg4Double oRes = XMMReg4Double::Load4Val(padfAcc + i) -
+                                   XMMReg4Double::Load4Val(padfVal + i);
+        oRes.Store4Val(padfAcc + i);
+    }
+    for( ; i < nXSize; ++i )
+        padfAcc[i] -= padfVal[i];
+}
+
+// padfAcc[i] *= padfVal[i]
+static void MulLine( double *padfAcc, const double *padfVal, int nXSize )
+{
+    int i = 0;
+    for( ; i + 3 < nXSize; i += 4 )
+    {
+        const XMMReg4Double oRes = XMMReg4Double::Load4Val(padfAcc + i) *
+                                   XMMReg4Double::Load4Val(padfVal + i);
+        oRes.Store4Val(padfAcc + i);
+    }
+    for( ; i < nXSize; ++i )
+        padfAcc[i] *= padfVal[i];
+}
+
+/************************************************************************/
+/*                      Integer sum and difference                      */
+/************************************************************************/
+
+/* Sums and differences of Byte, Int16 and UInt16 sources are exactly */
+/* computed in their native type promoted to 32 bit integers.         */
+
+static bool IsNativeIntegerSumType( GDALDataType eSrcType, int nSources )
+{
+    return (eSrcType == GDT_Byte || eSrcType == GDT_Int16 ||
+            eSrcType == GDT_UInt16) && nSources <= 32767;
+}
+
+template<class T>
+static void AccumulateLine( GInt32 *panAcc, const void *pSource,
+                            int nXSize, int iLine, bool bSubtract )
+{
+    const T *pSrc = static_cast<const T *>(pSource) +
+                    static_cast<size_t>(iLine) * nXSize;
+    if( bSubtract )
+    {
+        for( int i = 0; i < nXSize; ++i )
+            panAcc[i] -= pSrc[i];
+    }
+    else
+    {
+        for( int i = 0; i < nXSize; ++i )
+            panAcc[i] += pSrc[i];
+    }
+}
+
+static CPLErr IntegerSumPixelFunc( void **papoSources, int nSources,
+                                   void *pData, int nXSize, int nYSize,
+                                   GDALDataType eSrcType,
+                                   GDALDataType eBufType,
+                                   int nPixelSpace, int nLineSpace,
+                                   bool bDiff )
+{
+    GInt32 *panAcc = static_cast<GInt32 *>(
+        VSI_MALLOC2_VERBOSE(nXSize, sizeof(GInt32)));
+    if( panAcc == nullptr )
+        return CE_Failure;
+
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        memset( panAcc, 0, sizeof(GInt32) * nXSize );
+        for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
+            const bool bSubtract = bDiff && iSrc > 0;
+            if( eSrcType == GDT_Byte )
+                AccumulateLine<GByte>(panAcc, papoSources[iSrc], nXSize,
+                                      iLine, bSubtract);
+            else if( eSrcType == GDT_Int16 )
+                AccumulateLine<GInt16>(panAcc, papoSources[iSrc], nXSize,
+                                       iLine, bSubtract);
+            else
+                AccumulateLine<GUInt16>(panAcc, papoSources[iSrc], nXSize,
+                                        iLine, bSubtract);
+        }
+
+        GDALCopyWords(
+            panAcc, GDT_Int32, sizeof(GInt32),
+            static_cast<GByte *>(pData) +
+                static_cast<GPtrDiff_t>(nLineSpace) * iLine,
+            eBufType, nPixelSpace, nXSize );
+    }
+
+    VSIFree(panAcc);
+    return CE_None;
+}
+
 static CPLErr ComplexPixelFunc( void **papoSources, int nSources, void *pData,
                                 int nXSize, int nYSize,
                                 GDALDataType eSrcType, GDALDataType eBufType,
@@ -202,22 +393,18 @@ static CPLErr ComplexPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
-    const void * const pReal = papoSources[0];
-    const void * const pImag = papoSources[1];
+    PixelFuncLines oLines(2, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfReal = oLines[0];
+    double * const padfImag = oLines[1];
 
     /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double adfPixVal[2] = {
-                SRCVAL(pReal, eSrcType, ii),  // re
-                SRCVAL(pImag, eSrcType, ii)  // im
-            };
-
-            GDALCopyWords(adfPixVal, GDT_CFloat64, 0,
-                          static_cast<GByte *>(pData) + nLineSpace * iLine +
-                          iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfReal);
+        LoadLine(papoSources[1], eSrcType, nXSize, iLine, false, padfImag);
+
+        StoreLine(padfReal, padfImag, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -232,44 +419,30 @@ static CPLErr ModulePixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const void *pReal = papoSources[0];
-        const void *pImag = static_cast<GByte *>(papoSources[0])
-                    + GDALGetDataTypeSizeBytes( eSrcType ) / 2;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(2, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfVal = oLines[0];
+    double * const padfImag = oLines[1];
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal =
-                    sqrt( dfReal * dfReal + dfImag * dfImag );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfVal);
+        if( bComplex )
+        {
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfVal[iCol] = sqrt( padfVal[iCol] * padfVal[iCol] +
+                                      padfImag[iCol] * padfImag[iCol] );
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfPixVal =
-                    fabs(SRCVAL(papoSources[0], eSrcType, ii));
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfVal[iCol] = fabs( padfVal[iCol] );
         }
+
+        StoreLine(padfVal, nullptr, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -284,45 +457,29 @@ static CPLErr PhasePixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const void * const pReal = papoSources[0];
-        const void * const pImag = static_cast<GByte *>(papoSources[0])
-            + GDALGetDataTypeSizeBytes( eSrcType ) / 2;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(2, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfVal = oLines[0];
+    double * const padfImag = oLines[1];
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal = atan2(dfImag, dfReal);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfVal);
+        if( bComplex )
+        {
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfVal[iCol] = atan2( padfImag[iCol], padfVal[iCol] );
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                const void * const pReal = papoSources[0];
-
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfPixVal = (dfReal < 0) ? M_PI : 0.0;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfVal[iCol] = (padfVal[iCol] < 0) ? M_PI : 0.0;
         }
+
+        StoreLine(padfVal, nullptr, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -339,25 +496,20 @@ static CPLErr ConjPixelFunc( void **papoSources, int nSources, void *pData,
 
     if( GDALDataTypeIsComplex( eSrcType ) && GDALDataTypeIsComplex( eBufType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+        PixelFuncLines oLines(2, nXSize);
+        if( !oLines.IsValid() ) return CE_Failure;
+        double * const padfReal = oLines[0];
+        double * const padfImag = oLines[1];
 
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double adfPixVal[2] = {
-                    +SRCVAL(pReal, eSrcType, ii),  // re
-                    -SRCVAL(pImag, eSrcType, ii)  // im
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfReal);
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfImag[iCol] = -padfImag[iCol];
+
+            StoreLine(padfReal, padfImag, pData, nXSize, iLine,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
@@ -379,51 +531,41 @@ static CPLErr SumPixelFunc(void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources < 2 ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
+    if( IsNativeIntegerSumType( eSrcType, nSources ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double adfSum[2] = { 0.0, 0.0 };
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    const void * const pReal = papoSources[iSrc];
-                    const void * const pImag =
-                        static_cast<const GByte *>(pReal) + nOffset;
-
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    adfSum[0] += SRCVAL(pReal, eSrcType, ii);
-                    adfSum[1] += SRCVAL(pImag, eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    adfSum, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
-        }
+        return IntegerSumPixelFunc(papoSources, nSources, pData,
+                                   nXSize, nYSize, eSrcType, eBufType,
+                                   nPixelSpace, nLineSpace, false);
     }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double dfSum = 0;  // Not complex.
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    dfSum += SRCVAL(papoSources[iSrc], eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    &dfSum, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(3, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfSumReal = oLines[0];
+    double * const padfSumImag = oLines[1];
+    double * const padfVal = oLines[2];
+
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfSumReal);
+        if( bComplex )
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                     padfSumImag);
+
+        for( int iSrc = 1; iSrc < nSources; ++iSrc ) {
+            LoadLine(papoSources[iSrc], eSrcType, nXSize, iLine, false,
+                     padfVal);
+            AddLine(padfSumReal, padfVal, nXSize);
+            if( bComplex )
+            {
+                LoadLine(papoSources[iSrc], eSrcType, nXSize, iLine, true,
+                         padfVal);
+                AddLine(padfSumImag, padfVal, nXSize);
             }
         }
+
+        StoreLine(padfSumReal, bComplex ? padfSumImag : nullptr,
+                  pData, nXSize, iLine, eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -438,50 +580,34 @@ static CPLErr DiffPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
+    if( IsNativeIntegerSumType( eSrcType, nSources ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal0 = papoSources[0];
-        const void * const pImag0 =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-        const void * const pReal1 = papoSources[1];
-        const void * const pImag1 =
-            static_cast<GByte *>(papoSources[1]) + nOffset;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                double adfPixVal[2] = {
-                    SRCVAL(pReal0, eSrcType, ii)
-                    - SRCVAL(pReal1, eSrcType, ii),
-                    SRCVAL(pImag0, eSrcType, ii)
-                    - SRCVAL(pImag1, eSrcType, ii)
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
-        }
+        return IntegerSumPixelFunc(papoSources, nSources, pData,
+                                   nXSize, nYSize, eSrcType, eBufType,
+                                   nPixelSpace, nLineSpace, true);
     }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double dfPixVal = SRCVAL(papoSources[0], eSrcType, ii)
-                    - SRCVAL(papoSources[1], eSrcType, ii);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(3, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfReal = oLines[0];
+    double * const padfImag = oLines[1];
+    double * const padfVal = oLines[2];
+
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfReal);
+        LoadLine(papoSources[1], eSrcType, nXSize, iLine, false, padfVal);
+        SubLine(padfReal, padfVal, nXSize);
+        if( bComplex )
+        {
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            LoadLine(papoSources[1], eSrcType, nXSize, iLine, true, padfVal);
+            SubLine(padfImag, padfVal, nXSize);
         }
+
+        StoreLine(padfReal, bComplex ? padfImag : nullptr,
+                  pData, nXSize, iLine, eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -496,57 +622,43 @@ static CPLErr MulPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources < 2 ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(4, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfReal = oLines[0];
+    double * const padfImag = oLines[1];
+    double * const padfNewReal = oLines[2];
+    double * const padfNewImag = oLines[3];
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double adfPixVal[2] = { 1.0, 0.0 };
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    const void * const pReal = papoSources[iSrc];
-                    const void * const pImag =
-                        static_cast<const GByte *>(pReal) + nOffset;
-
-                    const double dfOldR = adfPixVal[0];
-                    const double dfOldI = adfPixVal[1];
-
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    const double dfNewR = SRCVAL(pReal, eSrcType, ii);
-                    const double dfNewI = SRCVAL(pImag, eSrcType, ii);
-
-                    adfPixVal[0] = dfOldR * dfNewR - dfOldI * dfNewI;
-                    adfPixVal[1] = dfOldR * dfNewI + dfOldI * dfNewR;
-                }
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfReal);
+        if( bComplex )
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+
+        for( int iSrc = 1; iSrc < nSources; ++iSrc ) {
+            LoadLine(papoSources[iSrc], eSrcType, nXSize, iLine, false,
+                     padfNewReal);
+            if( !bComplex )
+            {
+                MulLine(padfReal, padfNewReal, nXSize);
+                continue;
             }
-        }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double dfPixVal = 1.0;  // Not complex.
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    dfPixVal *= SRCVAL(papoSources[iSrc], eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+
+            LoadLine(papoSources[iSrc], eSrcType, nXSize, iLine, true,
+                     padfNewImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                const double dfOldR = padfReal[iCol];
+                const double dfOldI = padfImag[iCol];
+                const double dfNewR = padfNewReal[iCol];
+                const double dfNewI = padfNewImag[iCol];
+                padfReal[iCol] = dfOldR * dfNewR - dfOldI * dfNewI;
+                padfImag[iCol] = dfOldR * dfNewI + dfOldI * dfNewR;
             }
         }
+
+        StoreLine(padfReal, bComplex ? padfImag : nullptr,
+                  pData, nXSize, iLine, eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -561,54 +673,40 @@ static CPLErr CMulPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(4, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfReal0 = oLines[0];
+    double * const padfImag0 = oLines[1];
+    double * const padfReal1 = oLines[2];
+    double * const padfImag1 = oLines[3];
+
     /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal0 = papoSources[0];
-        const void * const pImag0 =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-        const void * const pReal1 = papoSources[1];
-        const void * const pImag1 =
-            static_cast<GByte *>(papoSources[1]) + nOffset;
-
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal0 = SRCVAL(pReal0, eSrcType, ii);
-                const double dfReal1 = SRCVAL(pReal1, eSrcType, ii);
-                const double dfImag0 = SRCVAL(pImag0, eSrcType, ii);
-                const double dfImag1 = SRCVAL(pImag1, eSrcType, ii);
-                const double adfPixVal[2] = {
-                    dfReal0 * dfReal1 + dfImag0 * dfImag1,
-                    dfReal1 * dfImag0 - dfReal0 * dfImag1
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfReal0);
+        LoadLine(papoSources[1], eSrcType, nXSize, iLine, false, padfReal1);
+        if( !bComplex )
+        {
+            // Not complex: the imaginary part of the result is 0.
+            MulLine(padfReal0, padfReal1, nXSize);
+            StoreLine(padfReal0, nullptr, pData, nXSize, iLine,
+                      eBufType, nPixelSpace, nLineSpace);
+            continue;
         }
-    }
-    else
-    {
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double adfPixVal[2] = {
-                    SRCVAL(papoSources[0], eSrcType, ii)
-                    * SRCVAL(papoSources[1], eSrcType, ii),
-                    0.0
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag0);
+        LoadLine(papoSources[1], eSrcType, nXSize, iLine, true, padfImag1);
+        for( int iCol = 0; iCol < nXSize; ++iCol ) {
+            const double dfReal0 = padfReal0[iCol];
+            const double dfReal1 = padfReal1[iCol];
+            const double dfImag0 = padfImag0[iCol];
+            const double dfImag1 = padfImag1[iCol];
+            padfReal0[iCol] = dfReal0 * dfReal1 + dfImag0 * dfImag1;
+            padfImag0[iCol] = dfReal1 * dfImag0 - dfReal0 * dfImag1;
         }
+
+        StoreLine(padfReal0, padfImag0, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -623,45 +721,35 @@ static CPLErr InvPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(2, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfReal = oLines[0];
+    double * const padfImag = oLines[1];
+
     /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfReal);
+        if( bComplex )
+        {
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                const double dfReal = padfReal[iCol];
+                const double dfImag = padfImag[iCol];
                 const double dfAux = dfReal * dfReal + dfImag * dfImag;
-                const double adfPixVal[2] = { dfReal / dfAux, -dfImag / dfAux };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+                padfReal[iCol] = dfReal / dfAux;
+                padfImag[iCol] = -dfImag / dfAux;
             }
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double dfPixVal =
-                    1.0 / SRCVAL(papoSources[0], eSrcType, ii);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            // Not complex.
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = 1.0 / padfReal[iCol];
         }
+
+        StoreLine(padfReal, bComplex ? padfImag : nullptr,
+                  pData, nXSize, iLine, eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -676,44 +764,25 @@ static CPLErr IntensityPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(2, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfVal = oLines[0];
+    double * const padfImag = oLines[1];
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal = dfReal * dfReal + dfImag * dfImag;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
-        }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                double dfPixVal = SRCVAL(papoSources[0], eSrcType, ii);
-                dfPixVal *= dfPixVal;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfVal);
+        MulLine(padfVal, padfVal, nXSize);
+        if( bComplex )
+        {
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            MulLine(padfImag, padfImag, nXSize);
+            AddLine(padfVal, padfImag, nXSize);
         }
+
+        StoreLine(padfVal, nullptr, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -729,18 +798,18 @@ static CPLErr SqrtPixelFunc( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
+    PixelFuncLines oLines(1, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfVal = oLines[0];
+
     /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double dfPixVal =
-                sqrt( SRCVAL(papoSources[0], eSrcType, ii) );
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfVal);
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfVal[iCol] = sqrt( padfVal[iCol] );
 
-            GDALCopyWords(
-                &dfPixVal, GDT_Float64, 0,
-                static_cast<GByte *>(pData) + nLineSpace * iLine +
-                iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+        StoreLine(padfVal, nullptr, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -758,47 +827,34 @@ static CPLErr Log10PixelFuncHelper( void **papoSources, int nSources,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        // Complex input datatype.
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    PixelFuncLines oLines(2, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfVal = oLines[0];
+    double * const padfImag = oLines[1];
 
-                const double dfPixVal =
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfVal);
+        if( bComplex )
+        {
+            // Complex input datatype.
+            LoadLine(papoSources[0], eSrcType, nXSize, iLine, true, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                const double dfReal = padfVal[iCol];
+                const double dfImag = padfImag[iCol];
+                padfVal[iCol] =
                     fact * log10( sqrt( dfReal * dfReal + dfImag * dfImag ) );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
             }
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfPixVal =
-                    fact * log10( fabs(
-                        SRCVAL(papoSources[0], eSrcType, ii) ) );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfVal[iCol] = fact * log10( fabs( padfVal[iCol] ) );
         }
+
+        StoreLine(padfVal, nullptr, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -835,18 +891,18 @@ static CPLErr PowPixelFuncHelper( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
+    PixelFuncLines oLines(1, nXSize);
+    if( !oLines.IsValid() ) return CE_Failure;
+    double * const padfVal = oLines[0];
+
     /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double dfPixVal =
-                pow(base, SRCVAL(papoSources[0], eSrcType, ii) / fact);
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadLine(papoSources[0], eSrcType, nXSize, iLine, false, padfVal);
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfVal[iCol] = pow(base, padfVal[iCol] / fact);
 
-            GDALCopyWords(
-                &dfPixVal, GDT_Float64, 0,
-                static_cast<GByte *>(pData) + nLineSpace * iLine +
-                iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+        StoreLine(padfVal, nullptr, pData, nXSize, iLine,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
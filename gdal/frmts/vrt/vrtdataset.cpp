@@ -56,11 +56,15 @@ VRTDataset::VRTDataset( int nXSize, int nYSize ) :
     m_pszVRTPath(nullptr),
     m_poMaskBand(nullptr),
     m_bCompatibleForDatasetIO(-1),
-    m_papszXMLVRTMetadata(nullptr)
+    m_papszXMLVRTMetadata(nullptr),
+    m_nNumThreads(1),
+    m_poThreadPool(nullptr)
 {
     nRasterXSize = nXSize;
     nRasterYSize = nYSize;
 
+    SetNumThreads( CPLGetConfigOption("VRT_NUM_THREADS", "1") );
+
     m_adfGeoTransform[0] = 0.0;
     m_adfGeoTransform[1] = 1.0;
     m_adfGeoTransform[2] = 0.0;
@@ -116,6 +120,47 @@ VRTDataset::~VRTDataset()
     for(size_t i=0;i<m_apoOverviewsBak.size();i++)
         delete m_apoOverviewsBak[i];
     CSLDestroy( m_papszXMLVRTMetadata );
+    delete m_poThreadPool;
+}
+
+/************************************************************************/
+/*                           SetNumThreads()                            */
+/************************************************************************/
+
+void VRTDataset::SetNumThreads( const char* pszNumThreads )
+{
+    const int nNumThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : std::max(1, std::min(128, atoi(pszNumThreads)));
+    if( nNumThreads != m_nNumThreads )
+    {
+        delete m_poThreadPool;
+        m_poThreadPool = nullptr;
+        m_nNumThreads = nNumThreads;
+    }
+}
+
+/************************************************************************/
+/*                           GetThreadPool()                            */
+/*                                                                      */
+/*      Return the pool used to read sources concurrently, or nullptr   */
+/*      if they must be read from the calling thread.                   */
+/************************************************************************/
+
+CPLWorkerThreadPool* VRTDataset::GetThreadPool()
+{
+    if( m_nNumThreads <= 1 )
+        return nullptr;
+    if( m_poThreadPool == nullptr )
+    {
+        m_poThreadPool = new CPLWorkerThreadPool();
+        if( !m_poThreadPool->Setup(m_nNumThreads, nullptr, nullptr) )
+        {
+            delete m_poThreadPool;
+            m_poThreadPool = nullptr;
+            m_nNumThreads = 1;
+        }
+    }
+    return m_poThreadPool;
 }
 
 /************************************************************************/
@@ -840,8 +885,15 @@ GDALDataset *VRTDataset::Open( GDALOpenInfo * poOpenInfo )
         OpenXML( pszXML, pszVRTPath, poOpenInfo->eAccess ) );
 
     if( poDS != nullptr )
+    {
         poDS->m_bNeedsFlush = FALSE;
 
+        const char* pszNumThreads =
+            CSLFetchNameValue(poOpenInfo->papszOpenOptions, "NUM_THREADS");
+        if( pszNumThreads != nullptr )
+            poDS->SetNumThreads(pszNumThreads);
+    }
+
     CPLFree( pszXML );
     CPLFree( pszVRTPath );
 
@@ -1570,7 +1622,10 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
             const double dfNoDataValue = poBand->GetNoDataValue(&bHasNoData);
             if( bHasNoData )
             {
-                for( int i = 0; i < poBand->nSources; i++ )
+                std::vector<int> anSources;
+                poBand->GetSourcesIntersecting(nXOff, nYOff, nXSize, nYSize,
+                                               anSources);
+                for( const int i : anSources )
                 {
                     VRTSimpleSource* poSource
                         = reinterpret_cast<VRTSimpleSource *>(
@@ -1614,42 +1669,19 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
             poBand->nSources = nSavedSources;
         }
 
-        CPLErr eErr = CE_None;
-        GDALProgressFunc  pfnProgressGlobal = psExtraArg->pfnProgress;
-        void *pProgressDataGlobal = psExtraArg->pProgressData;
-
         // Use the last band, because when sources reference a GDALProxyDataset,
         // they don't necessary instantiate all underlying rasterbands.
         VRTSourcedRasterBand* poBand = reinterpret_cast<VRTSourcedRasterBand *>(
             papoBands[nBands - 1] );
-        for( int iSource = 0;
-             eErr == CE_None && iSource < poBand->nSources;
-             iSource++ )
-        {
-            psExtraArg->pfnProgress = GDALScaledProgress;
-            psExtraArg->pProgressData =
-                GDALCreateScaledProgress(
-                    1.0 * iSource / poBand->nSources,
-                    1.0 * (iSource + 1) / poBand->nSources,
-                    pfnProgressGlobal,
-                    pProgressDataGlobal );
-
-            VRTSimpleSource* poSource = reinterpret_cast<VRTSimpleSource *>(
-                poBand->papoSources[iSource] );
-
-            eErr = poSource->DatasetRasterIO( nXOff, nYOff, nXSize, nYSize,
-                                              pData, nBufXSize, nBufYSize,
-                                              eBufType,
-                                              nBandCount, panBandMap,
-                                              nPixelSpace, nLineSpace,
-                                              nBandSpace,
-                                              psExtraArg );
-
-            GDALDestroyScaledProgress( psExtraArg->pProgressData );
-        }
-
-        psExtraArg->pfnProgress = pfnProgressGlobal;
-        psExtraArg->pProgressData = pProgressDataGlobal;
+        std::vector<int> anSources;
+        poBand->GetSourcesIntersecting(nXOff, nYOff, nXSize, nYSize,
+                                       anSources);
+        const CPLErr eErr =
+            poBand->RasterIOSources( anSources, nXOff, nYOff, nXSize, nYSize,
+                                     pData, nBufXSize, nBufYSize, eBufType,
+                                     nBandCount, panBandMap,
+                                     nPixelSpace, nLineSpace, nBandSpace,
+                                     psExtraArg );
 
         return eErr;
     }
@@ -34,6 +34,8 @@
 #ifndef DOXYGEN_SKIP
 
 #include "cpl_hash_set.h"
+#include "cpl_quad_tree.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_vrt.h"
@@ -154,6 +156,9 @@ class CPL_DLL VRTDataset : public GDALDataset
     std::vector<GDALDataset*> m_apoOverviewsBak;
     char         **m_papszXMLVRTMetadata;
 
+    int            m_nNumThreads;
+    CPLWorkerThreadPool *m_poThreadPool;
+
   protected:
     virtual int         CloseDependentDatasets() CPL_OVERRIDE;
 
@@ -166,6 +171,9 @@ class CPL_DLL VRTDataset : public GDALDataset
 
     void SetWritable(int bWritableIn) { m_bWritable = bWritableIn; }
 
+    void                 SetNumThreads( const char* pszNumThreads );
+    CPLWorkerThreadPool *GetThreadPool();
+
     virtual CPLErr          CreateMaskBand( int nFlags ) CPL_OVERRIDE;
     void SetMaskBand(VRTRasterBand* poMaskBand);
 
@@ -488,8 +496,23 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
     CPLString      m_osLastLocationInfo;
     char         **m_papszSourceList;
 
+    // Spatial index of the destination windows of the sources, built on
+    // the first request when there are many sources.
+    CPLQuadTree   *m_hSourceIndex;
+    int            m_nIndexedSourceCount;
+    VRTSource    **m_papoIndexedSources;
+    std::vector<int> m_anUnindexedSources;
+
     bool           CanUseSourcesMinMaxImplementations();
     void           CheckSource( VRTSimpleSource *poSS );
+    void           BuildSourceIndex();
+    void           InvalidateSourceIndex();
+    bool           BuildSourceBatches( const std::vector<int>& anSources,
+                                       int nXOff, int nYOff,
+                                       int nXSize, int nYSize,
+                                       int nBufXSize, int nBufYSize,
+                                       size_t nMaxBatchSize,
+                                       std::vector<std::vector<int>>& aanBatches );
 
   public:
     int            nSources;
@@ -542,6 +565,18 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
                                   void *pProgressData ) CPL_OVERRIDE;
 
     CPLErr         AddSource( VRTSource * );
+    void           GetSourcesIntersecting( int nXOff, int nYOff,
+                                           int nXSize, int nYSize,
+                                           std::vector<int>& anSources );
+    CPLErr         RasterIOSources( const std::vector<int>& anSources,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void *pData, int nBufXSize, int nBufYSize,
+                                    GDALDataType eBufType,
+                                    int nBandCount, int *panBandMap,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GSpacing nBandSpace,
+                                    GDALRasterIOExtraArg* psExtraArg );
     CPLErr         AddSimpleSource( GDALRasterBand *poSrcBand,
                                     double dfSrcXOff=-1, double dfSrcYOff=-1,
                                     double dfSrcXSize=-1, double dfSrcYSize=-1,
@@ -645,6 +680,49 @@ class VRTPansharpenedRasterBand : public VRTRasterBand
         { return m_nIndexAsPansharpenedBand; }
 };
 
+/************************************************************************/
+/*                            VRTExpression                             */
+/************************************************************************/
+
+class VRTExpression
+{
+  public:
+    enum Opcode
+    {
+        OP_CONST, OP_SOURCE, OP_NODATA,
+        OP_NEG, OP_NOT, OP_ABS, OP_SQRT, OP_EXP, OP_LOG, OP_LOG10,
+        OP_FLOOR, OP_CEIL, OP_ROUND, OP_ISNODATA,
+        OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_POW, OP_MIN, OP_MAX,
+        OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE, OP_AND, OP_OR,
+        OP_SELECT
+    };
+
+    struct Instruction
+    {
+        Opcode eOp;
+        int    nArg;     // source index for OP_SOURCE
+        double dfValue;  // value for OP_CONST
+    };
+
+  private:
+    std::vector<Instruction> m_aoProgram;
+    std::vector<int>         m_anUsedSources;
+    int                      m_nStackDepth;
+
+    void RunProgram( double **papadfSources, double *padfStack,
+                     int nCount, bool bHasNoData, double dfNoData ) const;
+
+  public:
+    VRTExpression();
+
+    bool   Compile( const char *pszExpression, int nSources );
+    CPLErr Evaluate( void **papoSources, int nSources,
+                     GDALDataType eSrcType, int nXSize, int nYSize,
+                     bool bHasNoData, double dfNoData,
+                     void *pData, GDALDataType eBufType,
+                     int nPixelSpace, GSpacing nLineSpace ) const;
+};
+
 /************************************************************************/
 /*                         VRTDerivedRasterBand                         */
 /************************************************************************/
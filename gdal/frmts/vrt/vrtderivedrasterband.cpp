@@ -44,6 +44,7 @@
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <vector>
 #include <utility>
 
@@ -858,6 +859,7 @@ class VRTDerivedRasterBandPrivateData
         bool      m_bExclusiveLock;
         bool      m_bFirstTime;
         std::vector< std::pair<CPLString,CPLString> > m_oFunctionArgs;
+        std::unique_ptr<VRTExpression> m_poExpression;
 
         VRTDerivedRasterBandPrivateData():
             m_osLanguage("C"),
@@ -1926,6 +1928,15 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             VSIFree(pabyTmpBuffer);
         }
     }
+    else if( eErr == CE_None && m_poPrivate->m_poExpression != nullptr )
+    {
+        eErr = m_poPrivate->m_poExpression->Evaluate(
+                             reinterpret_cast<void **>( pBuffers ), nSources,
+                             eSrcType, nBufXSize, nBufYSize,
+                             CPL_TO_BOOL(m_bNoDataValueSet), m_dfNoDataValue,
+                             pData, eBufType, static_cast<int>(nPixelSpace),
+                             nLineSpace );
+    }
     else if( eErr == CE_None && pfnPixelFunc != nullptr ) {
         eErr = pfnPixelFunc( reinterpret_cast<void **>( pBuffers ), nSources,
                              pData, nBufXSize, nBufYSize,
@@ -1972,35 +1983,57 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
     if( eErr != CE_None )
         return eErr;
 
-    // Read derived pixel function type.
-    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType", nullptr ) );
-    if( pszFuncName == nullptr || EQUAL(pszFuncName, "") )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "PixelFunctionType missing");
-        return CE_Failure;
-    }
-
     m_poPrivate->m_osLanguage = CPLGetXMLValue( psTree,
                                                 "PixelFunctionLanguage", "C" );
     if( !EQUAL(m_poPrivate->m_osLanguage, "C") &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") &&
+        !EQUAL(m_poPrivate->m_osLanguage, "Expression") )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
                  "Unsupported PixelFunctionLanguage");
         return CE_Failure;
     }
+    const bool bExpression = EQUAL(m_poPrivate->m_osLanguage, "Expression");
+
+    // Read derived pixel function type.
+    // It is optional for expressions, where it is only informative.
+    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType", nullptr ) );
+    if( !bExpression && (pszFuncName == nullptr || EQUAL(pszFuncName, "")) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "PixelFunctionType missing");
+        return CE_Failure;
+    }
 
     m_poPrivate->m_osCode =
                         CPLGetXMLValue( psTree, "PixelFunctionCode", "" );
     if( !m_poPrivate->m_osCode.empty() &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") && !bExpression )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "PixelFunctionCode can only be used with Python");
+                 "PixelFunctionCode can only be used with Python "
+                 "or Expression");
         return CE_Failure;
     }
 
+    // Expressions are parsed once here, and evaluated for each request.
+    if( bExpression )
+    {
+        if( m_poPrivate->m_osCode.empty() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "PixelFunctionCode missing");
+            return CE_Failure;
+        }
+        m_poPrivate->m_poExpression.reset(new VRTExpression());
+        if( !m_poPrivate->m_poExpression->Compile(m_poPrivate->m_osCode,
+                                                  nSources) )
+        {
+            m_poPrivate->m_poExpression.reset();
+            return CE_Failure;
+        }
+    }
+
     m_poPrivate->m_nBufferRadius =
                         atoi(CPLGetXMLValue( psTree, "BufferRadius", "0" ));
     if( m_poPrivate->m_nBufferRadius < 0 ||
@@ -0,0 +1,756 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Implementation of the expression evaluator of derived bands.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "vrtdataset.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$")
+
+/*! @cond Doxygen_Suppress */
+
+// Number of pixels evaluated at once.
+constexpr int VRT_EXPR_CHUNK_SIZE = 256;
+
+// Maximum nesting level of parentheses, function calls, conditionals,
+// unary operators and exponents, to bound the recursion of the parser.
+constexpr int VRT_EXPR_MAX_DEPTH = 1000;
+
+/************************************************************************/
+/* ==================================================================== */
+/*                         VRTExpressionParser                          */
+/* ==================================================================== */
+/************************************************************************/
+
+/* Recursive descent parser emitting the instructions of the program in  */
+/* postfix order. Grammar, from lowest to highest precedence:           */
+/*   expr    := or [ '?' expr ':' expr ]                                */
+/*   or      := and { '||' and }                                        */
+/*   and     := eq { '&&' eq }                                          */
+/*   eq      := rel { ('==' | '!=') rel }                               */
+/*   rel     := add { ('<' | '<=' | '>' | '>=') add }                   */
+/*   add     := mul { ('+' | '-') mul }                                 */
+/*   mul     := unary { ('*' | '/' | '%') unary }                       */
+/*   unary   := ('-' | '+' | '!') unary | power                         */
+/*   power   := primary [ '^' unary ]                                   */
+/*   primary := number | Bn | constant | function '(' args ')'          */
+/*            | '(' expr ')'                                            */
+
+class VRTExpressionParser
+{
+    const char *m_pszExpr;
+    const char *m_pszCur;
+    int         m_nSources;
+    std::vector<VRTExpression::Instruction>& m_aoProgram;
+    bool        m_bError;
+    int         m_nDepth;
+
+    void SkipSpaces();
+    bool Accept( const char *pszToken );
+    void Error( const char *pszMsg );
+    void Emit( VRTExpression::Opcode eOp, int nArg = 0,
+               double dfValue = 0.0 );
+    bool EnterLevel();
+
+    void ParseExpr();
+    void ParseOr();
+    void ParseAnd();
+    void ParseEq();
+    void ParseRel();
+    void ParseAdd();
+    void ParseMul();
+    void ParseUnary();
+    void ParsePower();
+    void ParsePrimary();
+    void ParseFunction( const CPLString& osName );
+
+    CPL_DISALLOW_COPY_ASSIGN(VRTExpressionParser)
+
+  public:
+    VRTExpressionParser( const char *pszExpr, int nSources,
+                         std::vector<VRTExpression::Instruction>& aoProgram ) :
+        m_pszExpr(pszExpr), m_pszCur(pszExpr), m_nSources(nSources),
+        m_aoProgram(aoProgram), m_bError(false), m_nDepth(0) {}
+
+    bool Parse();
+};
+
+/************************************************************************/
+/*                             SkipSpaces()                             */
+/************************************************************************/
+
+void VRTExpressionParser::SkipSpaces()
+{
+    while( *m_pszCur == ' ' || *m_pszCur == '\t' ||
+           *m_pszCur == '\n' || *m_pszCur == '\r' )
+        m_pszCur++;
+}
+
+/************************************************************************/
+/*                               Accept()                               */
+/************************************************************************/
+
+bool VRTExpressionParser::Accept( const char *pszToken )
+{
+    SkipSpaces();
+    const size_t nLen = strlen(pszToken);
+    if( strncmp(m_pszCur, pszToken, nLen) != 0 )
+        return false;
+    // Do not take '<' for the beginning of '<=', or '!' for '!='
+    if( nLen == 1 && (*pszToken == '<' || *pszToken == '>' ||
+                      *pszToken == '!' || *pszToken == '=') &&
+        m_pszCur[1] == '=' )
+        return false;
+    m_pszCur += nLen;
+    return true;
+}
+
+/************************************************************************/
+/*                                Error()                               */
+/************************************************************************/
+
+void VRTExpressionParser::Error( const char *pszMsg )
+{
+    if( m_bError )
+        return;
+    m_bError = true;
+    CPLError(CE_Failure, CPLE_AppDefined,
+             "Invalid expression '%s' at offset %d: %s",
+             m_pszExpr, static_cast<int>(m_pszCur - m_pszExpr), pszMsg);
+}
+
+/************************************************************************/
+/*                                Emit()                                */
+/************************************************************************/
+
+void VRTExpressionParser::Emit( VRTExpression::Opcode eOp, int nArg,
+                                double dfValue )
+{
+    VRTExpression::Instruction sInstr;
+    sInstr.eOp = eOp;
+    sInstr.nArg = nArg;
+    sInstr.dfValue = dfValue;
+    m_aoProgram.push_back(sInstr);
+}
+
+/************************************************************************/
+/*                             EnterLevel()                             */
+/*                                                                      */
+/*      Must be balanced by a decrement of m_nDepth when it succeeds.   */
+/************************************************************************/
+
+bool VRTExpressionParser::EnterLevel()
+{
+    if( m_bError )
+        return false;
+    if( m_nDepth >= VRT_EXPR_MAX_DEPTH )
+    {
+        Error("too many nested levels");
+        return false;
+    }
+    m_nDepth++;
+    return true;
+}
+
+/************************************************************************/
+/*                                Parse()                               */
+/************************************************************************/
+
+bool VRTExpressionParser::Parse()
+{
+    ParseExpr();
+    SkipSpaces();
+    if( !m_bError && *m_pszCur != '\0' )
+        Error("unexpected character");
+    return !m_bError;
+}
+
+/************************************************************************/
+/*                          Precedence levels                           */
+/************************************************************************/
+
+void VRTExpressionParser::ParseExpr()
+{
+    ParseOr();
+    if( !m_bError && Accept("?") )
+    {
+        if( !EnterLevel() )
+            return;
+        ParseExpr();
+        if( !m_bError && !Accept(":") )
+            Error("':' expected");
+        if( !m_bError )
+            ParseExpr();
+        Emit(VRTExpression::OP_SELECT);
+        m_nDepth--;
+    }
+}
+
+void VRTExpressionParser::ParseOr()
+{
+    ParseAnd();
+    while( !m_bError && Accept("||") )
+    {
+        ParseAnd();
+        Emit(VRTExpression::OP_OR);
+    }
+}
+
+void VRTExpressionParser::ParseAnd()
+{
+    ParseEq();
+    while( !m_bError && Accept("&&") )
+    {
+        ParseEq();
+        Emit(VRTExpression::OP_AND);
+    }
+}
+
+void VRTExpressionParser::ParseEq()
+{
+    ParseRel();
+    while( !m_bError )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("==") )
+            eOp = VRTExpression::OP_EQ;
+        else if( Accept("!=") )
+            eOp = VRTExpression::OP_NE;
+        else
+            break;
+        ParseRel();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseRel()
+{
+    ParseAdd();
+    while( !m_bError )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("<=") )
+            eOp = VRTExpression::OP_LE;
+        else if( Accept(">=") )
+            eOp = VRTExpression::OP_GE;
+        else if( Accept("<") )
+            eOp = VRTExpression::OP_LT;
+        else if( Accept(">") )
+            eOp = VRTExpression::OP_GT;
+        else
+            break;
+        ParseAdd();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseAdd()
+{
+    ParseMul();
+    while( !m_bError )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("+") )
+            eOp = VRTExpression::OP_ADD;
+        else if( Accept("-") )
+            eOp = VRTExpression::OP_SUB;
+        else
+            break;
+        ParseMul();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseMul()
+{
+    ParseUnary();
+    while( !m_bError )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("*") )
+            eOp = VRTExpression::OP_MUL;
+        else if( Accept("/") )
+            eOp = VRTExpression::OP_DIV;
+        else if( Accept("%") )
+            eOp = VRTExpression::OP_MOD;
+        else
+            break;
+        ParseUnary();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseUnary()
+{
+    // Apart from conditionals, every recursion of the parser, be it through
+    // a parenthesis, a function argument, a unary operator or an exponent,
+    // goes through here.
+    if( !EnterLevel() )
+        return;
+    if( Accept("-") )
+    {
+        ParseUnary();
+        Emit(VRTExpression::OP_NEG);
+    }
+    else if( Accept("+") )
+    {
+        ParseUnary();
+    }
+    else if( Accept("!") )
+    {
+        ParseUnary();
+        Emit(VRTExpression::OP_NOT);
+    }
+    else
+    {
+        ParsePower();
+    }
+    m_nDepth--;
+}
+
+void VRTExpressionParser::ParsePower()
+{
+    ParsePrimary();
+    if( !m_bError && Accept("^") )
+    {
+        // Right associative: 2^3^2 = 2^(3^2)
+        ParseUnary();
+        Emit(VRTExpression::OP_POW);
+    }
+}
+
+/************************************************************************/
+/*                            ParsePrimary()                            */
+/************************************************************************/
+
+void VRTExpressionParser::ParsePrimary()
+{
+    if( m_bError )
+        return;
+    SkipSpaces();
+
+    if( Accept("(") )
+    {
+        ParseExpr();
+        if( !m_bError && !Accept(")") )
+            Error("')' expected");
+        return;
+    }
+
+    if( (*m_pszCur >= '0' && *m_pszCur <= '9') || *m_pszCur == '.' )
+    {
+        char *pszEnd = nullptr;
+        const double dfValue = CPLStrtod(m_pszCur, &pszEnd);
+        if( pszEnd == m_pszCur )
+        {
+            Error("invalid number");
+            return;
+        }
+        m_pszCur = pszEnd;
+        Emit(VRTExpression::OP_CONST, 0, dfValue);
+        return;
+    }
+
+    if( !isalpha(static_cast<unsigned char>(*m_pszCur)) && *m_pszCur != '_' )
+    {
+        Error(*m_pszCur == '\0' ? "unexpected end of expression"
+                                : "unexpected character");
+        return;
+    }
+
+    CPLString osName;
+    while( isalnum(static_cast<unsigned char>(*m_pszCur)) ||
+           *m_pszCur == '_' )
+    {
+        osName += *m_pszCur;
+        m_pszCur++;
+    }
+
+    SkipSpaces();
+    if( *m_pszCur == '(' )
+    {
+        m_pszCur++;
+        ParseFunction(osName);
+        return;
+    }
+
+    // Source value: B1 is the first source of the band.
+    if( (osName[0] == 'B' || osName[0] == 'b') && osName.size() > 1 &&
+        osName.find_first_not_of("0123456789", 1) == std::string::npos )
+    {
+        const int nSource = atoi(osName.c_str() + 1);
+        if( nSource < 1 || nSource > m_nSources )
+        {
+            Error(CPLSPrintf("%s does not reference an existing source",
+                             osName.c_str()));
+            return;
+        }
+        Emit(VRTExpression::OP_SOURCE, nSource - 1);
+        return;
+    }
+
+    if( EQUAL(osName, "NODATA") )
+        Emit(VRTExpression::OP_NODATA);
+    else if( EQUAL(osName, "PI") )
+        Emit(VRTExpression::OP_CONST, 0, M_PI);
+    else
+        Error(CPLSPrintf("unknown identifier '%s'", osName.c_str()));
+}
+
+/************************************************************************/
+/*                           ParseFunction()                            */
+/************************************************************************/
+
+void VRTExpressionParser::ParseFunction( const CPLString& osName )
+{
+    int nArgs = 0;
+    SkipSpaces();
+    if( *m_pszCur != ')' )
+    {
+        do
+        {
+            ParseExpr();
+            nArgs++;
+        } while( !m_bError && Accept(",") );
+    }
+    if( !m_bError && !Accept(")") )
+        Error("')' expected");
+    if( m_bError )
+        return;
+
+    static const struct
+    {
+        const char *pszName;
+        VRTExpression::Opcode eOp;
+        int nArgs;
+    } asFunctions[] = {
+        { "abs", VRTExpression::OP_ABS, 1 },
+        { "sqrt", VRTExpression::OP_SQRT, 1 },
+        { "exp", VRTExpression::OP_EXP, 1 },
+        { "log", VRTExpression::OP_LOG, 1 },
+        { "log10", VRTExpression::OP_LOG10, 1 },
+        { "floor", VRTExpression::OP_FLOOR, 1 },
+        { "ceil", VRTExpression::OP_CEIL, 1 },
+        { "round", VRTExpression::OP_ROUND, 1 },
+        { "isnodata", VRTExpression::OP_ISNODATA, 1 },
+        { "pow", VRTExpression::OP_POW, 2 },
+        { "if", VRTExpression::OP_SELECT, 3 },
+    };
+
+    if( EQUAL(osName, "min") || EQUAL(osName, "max") )
+    {
+        if( nArgs < 2 )
+        {
+            Error(CPLSPrintf("%s() expects at least 2 arguments",
+                             osName.c_str()));
+            return;
+        }
+        for( int i = 1; i < nArgs; i++ )
+            Emit(EQUAL(osName, "min") ? VRTExpression::OP_MIN
+                                      : VRTExpression::OP_MAX);
+        return;
+    }
+
+    for( size_t i = 0; i < CPL_ARRAYSIZE(asFunctions); i++ )
+    {
+        if( EQUAL(osName, asFunctions[i].pszName) )
+        {
+            if( nArgs != asFunctions[i].nArgs )
+            {
+                Error(CPLSPrintf("%s() expects %d argument(s)",
+                                 asFunctions[i].pszName,
+                                 asFunctions[i].nArgs));
+                return;
+            }
+            Emit(asFunctions[i].eOp);
+            return;
+        }
+    }
+
+    Error(CPLSPrintf("unknown function '%s'", osName.c_str()));
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                             VRTExpression                            */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                           VRTExpression()                            */
+/************************************************************************/
+
+VRTExpression::VRTExpression() :
+    m_nStackDepth(0)
+{}
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+bool VRTExpression::Compile( const char *pszExpression, int nSources )
+{
+    m_aoProgram.clear();
+    m_anUsedSources.clear();
+    m_nStackDepth = 0;
+
+    VRTExpressionParser oParser(pszExpression, nSources, m_aoProgram);
+    if( !oParser.Parse() )
+    {
+        m_aoProgram.clear();
+        return false;
+    }
+
+    // Compute the stack depth needed to run the program.
+    int nDepth = 0;
+    for( size_t i = 0; i < m_aoProgram.size(); i++ )
+    {
+        switch( m_aoProgram[i].eOp )
+        {
+            case OP_CONST:
+            case OP_NODATA:
+                nDepth++;
+                break;
+            case OP_SOURCE:
+                nDepth++;
+                if( std::find(m_anUsedSources.begin(), m_anUsedSources.end(),
+                              m_aoProgram[i].nArg) == m_anUsedSources.end() )
+                    m_anUsedSources.push_back(m_aoProgram[i].nArg);
+                break;
+            case OP_NEG: case OP_NOT: case OP_ABS: case OP_SQRT:
+            case OP_EXP: case OP_LOG: case OP_LOG10: case OP_FLOOR:
+            case OP_CEIL: case OP_ROUND: case OP_ISNODATA:
+                break;
+            case OP_SELECT:
+                nDepth -= 2;
+                break;
+            default:
+                nDepth--;
+                break;
+        }
+        m_nStackDepth = std::max(m_nStackDepth, nDepth);
+    }
+    CPLAssert(nDepth == 1);
+
+    return true;
+}
+
+/************************************************************************/
+/*                             RunProgram()                             */
+/************************************************************************/
+
+/* Runs the program over nCount pixels. papadfSources[i] points to the  */
+/* values of source i (for the used sources), padfStack to             */
+/* m_nStackDepth * VRT_EXPR_CHUNK_SIZE values. The result is left at    */
+/* the bottom of the stack.                                             */
+
+void VRTExpression::RunProgram( double **papadfSources, double *padfStack,
+                                int nCount, bool bHasNoData,
+                                double dfNoData ) const
+{
+    int nTop = -1;
+    const double dfNoDataOrNaN = bHasNoData ? dfNoData : CPLAtof("nan");
+
+#define TOP(k) (padfStack + static_cast<size_t>(nTop - (k)) * VRT_EXPR_CHUNK_SIZE)
+
+#define UNARY_OP(expr) \
+    { double *x = TOP(0); \
+      for( int i = 0; i < nCount; i++ ) { const double a = x[i]; x[i] = (expr); } }
+
+#define BINARY_OP(expr) \
+    { double *x = TOP(1); const double *y = TOP(0); \
+      for( int i = 0; i < nCount; i++ ) \
+      { const double a = x[i]; const double b = y[i]; x[i] = (expr); } \
+      nTop--; }
+
+    for( size_t iInstr = 0; iInstr < m_aoProgram.size(); iInstr++ )
+    {
+        const Instruction& sInstr = m_aoProgram[iInstr];
+        switch( sInstr.eOp )
+        {
+            case OP_CONST:
+            case OP_NODATA:
+            {
+                nTop++;
+                double *x = TOP(0);
+                const double dfValue = sInstr.eOp == OP_CONST ?
+                                            sInstr.dfValue : dfNoDataOrNaN;
+                for( int i = 0; i < nCount; i++ )
+                    x[i] = dfValue;
+                break;
+            }
+            case OP_SOURCE:
+                nTop++;
+                memcpy(TOP(0), papadfSources[sInstr.nArg],
+                       sizeof(double) * nCount);
+                break;
+            case OP_NEG: UNARY_OP(-a); break;
+            case OP_NOT: UNARY_OP(a == 0.0 ? 1.0 : 0.0); break;
+            case OP_ABS: UNARY_OP(fabs(a)); break;
+            case OP_SQRT: UNARY_OP(sqrt(a)); break;
+            case OP_EXP: UNARY_OP(exp(a)); break;
+            case OP_LOG: UNARY_OP(log(a)); break;
+            case OP_LOG10: UNARY_OP(log10(a)); break;
+            case OP_FLOOR: UNARY_OP(floor(a)); break;
+            case OP_CEIL: UNARY_OP(ceil(a)); break;
+            case OP_ROUND: UNARY_OP(floor(a + 0.5)); break;
+            case OP_ISNODATA:
+                if( bHasNoData )
+                    UNARY_OP((CPLIsNan(a) || a == dfNoData) ? 1.0 : 0.0)
+                else
+                    UNARY_OP(CPLIsNan(a) ? 1.0 : 0.0)
+                break;
+            case OP_ADD: BINARY_OP(a + b); break;
+            case OP_SUB: BINARY_OP(a - b); break;
+            case OP_MUL: BINARY_OP(a * b); break;
+            case OP_DIV: BINARY_OP(a / b); break;
+            case OP_MOD: BINARY_OP(fmod(a, b)); break;
+            case OP_POW: BINARY_OP(pow(a, b)); break;
+            case OP_MIN: BINARY_OP(std::fmin(a, b)); break;
+            case OP_MAX: BINARY_OP(std::fmax(a, b)); break;
+            case OP_LT: BINARY_OP(a < b ? 1.0 : 0.0); break;
+            case OP_LE: BINARY_OP(a <= b ? 1.0 : 0.0); break;
+            case OP_GT: BINARY_OP(a > b ? 1.0 : 0.0); break;
+            case OP_GE: BINARY_OP(a >= b ? 1.0 : 0.0); break;
+            case OP_EQ: BINARY_OP(a == b ? 1.0 : 0.0); break;
+            case OP_NE: BINARY_OP(a != b ? 1.0 : 0.0); break;
+            case OP_AND: BINARY_OP((a != 0.0 && b != 0.0) ? 1.0 : 0.0); break;
+            case OP_OR: BINARY_OP((a != 0.0 || b != 0.0) ? 1.0 : 0.0); break;
+            case OP_SELECT:
+            {
+                double *c = TOP(2);
+                const double *x = TOP(1);
+                const double *y = TOP(0);
+                for( int i = 0; i < nCount; i++ )
+                    c[i] = c[i] != 0.0 ? x[i] : y[i];
+                nTop -= 2;
+                break;
+            }
+        }
+    }
+
+#undef TOP
+#undef UNARY_OP
+#undef BINARY_OP
+
+    CPLAssert(nTop == 0);
+}
+
+/************************************************************************/
+/*                              Evaluate()                              */
+/************************************************************************/
+
+/* papoSources are the packed source buffers, of nXSize * nYSize values */
+/* of type eSrcType, as given to pixel functions. Pixels evaluating to  */
+/* NaN are set to the nodata value, if there is one.                    */
+
+CPLErr VRTExpression::Evaluate( void **papoSources, int nSources,
+                                GDALDataType eSrcType,
+                                int nXSize, int nYSize,
+                                bool bHasNoData, double dfNoData,
+                                void *pData, GDALDataType eBufType,
+                                int nPixelSpace, GSpacing nLineSpace ) const
+{
+    for( size_t i = 0; i < m_anUsedSources.size(); i++ )
+    {
+        if( m_anUsedSources[i] >= nSources )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Expression references source B%d, but the band has "
+                     "only %d source(s)", m_anUsedSources[i] + 1, nSources);
+            return CE_Failure;
+        }
+    }
+
+    // One chunk per used source, followed by the evaluation stack.
+    const size_t nChunks = m_anUsedSources.size() + m_nStackDepth;
+    double *padfWork = static_cast<double *>(
+        VSI_MALLOC2_VERBOSE(nChunks, VRT_EXPR_CHUNK_SIZE * sizeof(double)));
+    if( padfWork == nullptr )
+        return CE_Failure;
+    std::vector<double *> apadfSources(nSources, nullptr);
+    for( size_t i = 0; i < m_anUsedSources.size(); i++ )
+        apadfSources[m_anUsedSources[i]] =
+            padfWork + i * VRT_EXPR_CHUNK_SIZE;
+    double *padfStack =
+        padfWork + m_anUsedSources.size() * VRT_EXPR_CHUNK_SIZE;
+
+    const int nSrcTypeSize = GDALGetDataTypeSizeBytes(eSrcType);
+
+    for( int iLine = 0; iLine < nYSize; iLine++ )
+    {
+        for( int iX = 0; iX < nXSize; iX += VRT_EXPR_CHUNK_SIZE )
+        {
+            const int nCount = std::min(VRT_EXPR_CHUNK_SIZE, nXSize - iX);
+            const size_t nSrcOffset =
+                (static_cast<size_t>(iLine) * nXSize + iX) * nSrcTypeSize;
+
+            // Complex sources are reduced to their real part.
+            for( size_t i = 0; i < m_anUsedSources.size(); i++ )
+            {
+                const int iSrc = m_anUsedSources[i];
+                GDALCopyWords(
+                    static_cast<GByte *>(papoSources[iSrc]) + nSrcOffset,
+                    eSrcType, nSrcTypeSize,
+                    apadfSources[iSrc], GDT_Float64, sizeof(double),
+                    nCount );
+            }
+
+            RunProgram(apadfSources.data(), padfStack, nCount,
+                       bHasNoData, dfNoData);
+
+            if( bHasNoData )
+            {
+                for( int i = 0; i < nCount; i++ )
+                {
+                    if( CPLIsNan(padfStack[i]) )
+                        padfStack[i] = dfNoData;
+                }
+            }
+
+            GDALCopyWords(
+                padfStack, GDT_Float64, sizeof(double),
+                static_cast<GByte *>(pData) + nLineSpace * iLine +
+                    static_cast<GPtrDiff_t>(iX) * nPixelSpace,
+                eBufType, nPixelSpace, nCount );
+        }
+    }
+
+    VSIFree(padfWork);
+    return CE_None;
+}
+
+/*! @endcond */
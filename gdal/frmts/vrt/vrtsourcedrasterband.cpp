@@ -35,16 +35,21 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 #include <cstring>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_hash_set.h"
 #include "cpl_minixml.h"
 #include "cpl_progress.h"
+#include "cpl_quad_tree.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_geometry.h"
@@ -53,6 +58,10 @@ CPL_CVSID("$Id$")
 
 /*! @cond Doxygen_Suppress */
 
+// Minimum number of sources for which a spatial index of their destination
+// windows is built. Below, a linear scan is as fast.
+constexpr int VRT_MIN_SOURCES_FOR_INDEX = 64;
+
 /************************************************************************/
 /* ==================================================================== */
 /*                          VRTSourcedRasterBand                        */
@@ -66,6 +75,9 @@ CPL_CVSID("$Id$")
 VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourceIndex(nullptr),
+    m_nIndexedSourceCount(0),
+    m_papoIndexedSources(nullptr),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -85,6 +97,9 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataType eType,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourceIndex(nullptr),
+    m_nIndexedSourceCount(0),
+    m_papoIndexedSources(nullptr),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -103,6 +118,9 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourceIndex(nullptr),
+    m_nIndexedSourceCount(0),
+    m_papoIndexedSources(nullptr),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -123,9 +141,146 @@ VRTSourcedRasterBand::~VRTSourcedRasterBand()
 
 {
     CloseDependentDatasets();
+    InvalidateSourceIndex();
     CSLDestroy(m_papszSourceList);
 }
 
+/************************************************************************/
+/*                        InvalidateSourceIndex()                       */
+/************************************************************************/
+
+void VRTSourcedRasterBand::InvalidateSourceIndex()
+{
+    if( m_hSourceIndex != nullptr )
+        CPLQuadTreeDestroy(m_hSourceIndex);
+    m_hSourceIndex = nullptr;
+    m_nIndexedSourceCount = 0;
+    m_papoIndexedSources = nullptr;
+    m_anUnindexedSources.clear();
+}
+
+/************************************************************************/
+/*                          BuildSourceIndex()                          */
+/************************************************************************/
+
+void VRTSourcedRasterBand::BuildSourceIndex()
+{
+    InvalidateSourceIndex();
+
+    // Sources that are not simple ones, or whose destination window is not
+    // set, may touch any request: they are kept aside and always returned.
+    std::vector<int> anIndexed;
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = 0;
+    sGlobalBounds.miny = 0;
+    sGlobalBounds.maxx = nRasterXSize;
+    sGlobalBounds.maxy = nRasterYSize;
+    for( int i = 0; i < nSources; i++ )
+    {
+        bool bIndexable = false;
+        if( papoSources[i]->IsSimpleSource() )
+        {
+            VRTSimpleSource* poSS =
+                reinterpret_cast<VRTSimpleSource*>(papoSources[i]);
+            bIndexable = poSS->m_dfDstXSize > 0 && poSS->m_dfDstYSize > 0 &&
+                         CPLIsFinite(poSS->m_dfDstXOff) &&
+                         CPLIsFinite(poSS->m_dfDstYOff) &&
+                         CPLIsFinite(poSS->m_dfDstXSize) &&
+                         CPLIsFinite(poSS->m_dfDstYSize);
+            if( bIndexable )
+            {
+                sGlobalBounds.minx =
+                    std::min(sGlobalBounds.minx, poSS->m_dfDstXOff);
+                sGlobalBounds.miny =
+                    std::min(sGlobalBounds.miny, poSS->m_dfDstYOff);
+                sGlobalBounds.maxx =
+                    std::max(sGlobalBounds.maxx,
+                             poSS->m_dfDstXOff + poSS->m_dfDstXSize);
+                sGlobalBounds.maxy =
+                    std::max(sGlobalBounds.maxy,
+                             poSS->m_dfDstYOff + poSS->m_dfDstYSize);
+            }
+        }
+        if( bIndexable )
+            anIndexed.push_back(i);
+        else
+            m_anUnindexedSources.push_back(i);
+    }
+
+    m_hSourceIndex = CPLQuadTreeCreate(&sGlobalBounds, nullptr);
+    CPLQuadTreeSetMaxDepth(m_hSourceIndex,
+        CPLQuadTreeGetAdvisedMaxDepth(static_cast<int>(anIndexed.size())));
+    for( size_t i = 0; i < anIndexed.size(); i++ )
+    {
+        VRTSimpleSource* poSS =
+            reinterpret_cast<VRTSimpleSource*>(papoSources[anIndexed[i]]);
+        CPLRectObj sRect;
+        sRect.minx = poSS->m_dfDstXOff;
+        sRect.miny = poSS->m_dfDstYOff;
+        sRect.maxx = poSS->m_dfDstXOff + poSS->m_dfDstXSize;
+        sRect.maxy = poSS->m_dfDstYOff + poSS->m_dfDstYSize;
+        // The feature is the address of the source slot, from which its
+        // index is recovered.
+        CPLQuadTreeInsertWithBounds(m_hSourceIndex,
+                                    papoSources + anIndexed[i], &sRect);
+    }
+    m_nIndexedSourceCount = nSources;
+    m_papoIndexedSources = papoSources;
+}
+
+/************************************************************************/
+/*                       GetSourcesIntersecting()                       */
+/************************************************************************/
+
+/**
+ * Return, in increasing order, the indices of the sources that may
+ * contribute to the passed window of the band.
+ *
+ * The returned list is a superset of the sources whose destination window
+ * intersects the request. When the band has many sources, a spatial index
+ * of their destination windows is built on the first call.
+ */
+void VRTSourcedRasterBand::GetSourcesIntersecting(
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    std::vector<int>& anSources )
+{
+    anSources.clear();
+    if( nSources < VRT_MIN_SOURCES_FOR_INDEX )
+    {
+        for( int i = 0; i < nSources; i++ )
+            anSources.push_back(i);
+        return;
+    }
+
+    // The source array might have been modified directly by the caller.
+    if( m_hSourceIndex == nullptr || m_nIndexedSourceCount != nSources ||
+        m_papoIndexedSources != papoSources )
+    {
+        BuildSourceIndex();
+    }
+
+    CPLRectObj sAoi;
+    sAoi.minx = nXOff;
+    sAoi.miny = nYOff;
+    sAoi.maxx = static_cast<double>(nXOff) + nXSize;
+    sAoi.maxy = static_cast<double>(nYOff) + nYSize;
+    int nFeatureCount = 0;
+    void** pahFeatures =
+        CPLQuadTreeSearch(m_hSourceIndex, &sAoi, &nFeatureCount);
+    anSources.reserve(nFeatureCount + m_anUnindexedSources.size());
+    for( int i = 0; i < nFeatureCount; i++ )
+    {
+        anSources.push_back(static_cast<int>(
+            static_cast<VRTSource**>(pahFeatures[i]) - papoSources));
+    }
+    CPLFree(pahFeatures);
+    anSources.insert(anSources.end(), m_anUnindexedSources.begin(),
+                     m_anUnindexedSources.end());
+
+    // Preserve the paint order of the sources.
+    std::sort(anSources.begin(), anSources.end());
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /************************************************************************/
@@ -183,7 +338,9 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         psExtraArg->eResampleAlg != GRIORA_NearestNeighbour &&
         m_bNoDataValueSet )
     {
-        for( int i = 0; i < nSources; i++ )
+        std::vector<int> anSources;
+        GetSourcesIntersecting(nXOff, nYOff, nXSize, nYSize, anSources);
+        for( const int i : anSources )
         {
             bool bFallbackToBase = false;
             if( !papoSources[i]->IsSimpleSource() )
@@ -280,39 +437,349 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 
     m_nRecursionCounter++;
 
+    std::vector<int> anSources;
+    GetSourcesIntersecting(nXOff, nYOff, nXSize, nYSize, anSources);
+
+    const CPLErr eErr =
+        RasterIOSources( anSources, nXOff, nYOff, nXSize, nYSize,
+                         pData, nBufXSize, nBufYSize, eBufType,
+                         0, nullptr, nPixelSpace, nLineSpace, 0,
+                         psExtraArg );
+
+    m_nRecursionCounter--;
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         VRTSourceIOJobError                          */
+/************************************************************************/
+
+struct VRTSourceIOJobError
+{
+    CPLErr                eErr;
+    CPLErrorNum           nNo;
+    CPLString             osMsg;
+};
+
+/************************************************************************/
+/*                           VRTSourceIOJob                             */
+/************************************************************************/
+
+struct VRTSourceIOJob
+{
+    VRTSimpleSource      *poSource;
+    int                   nXOff;
+    int                   nYOff;
+    int                   nXSize;
+    int                   nYSize;
+    void                 *pData;
+    int                   nBufXSize;
+    int                   nBufYSize;
+    GDALDataType          eBufType;
+    int                   nBandCount;
+    int                  *panBandMap;
+    GSpacing              nPixelSpace;
+    GSpacing              nLineSpace;
+    GSpacing              nBandSpace;
+    GDALRasterIOExtraArg  sExtraArg;
+    CPLErr                eErr;
+    // Errors of the job, emitted by the calling thread.
+    std::vector<VRTSourceIOJobError> aoErrors;
+};
+
+/************************************************************************/
+/*                       VRTSourceIOJobErrorHandler()                   */
+/************************************************************************/
+
+static void CPL_STDCALL VRTSourceIOJobErrorHandler( CPLErr eErr,
+                                                    CPLErrorNum nNo,
+                                                    const char* pszMsg )
+{
+    VRTSourceIOJob* psJob =
+        static_cast<VRTSourceIOJob*>(CPLGetErrorHandlerUserData());
+    VRTSourceIOJobError sError;
+    sError.eErr = eErr;
+    sError.nNo = nNo;
+    sError.osMsg = pszMsg;
+    psJob->aoErrors.push_back(sError);
+}
+
+/************************************************************************/
+/*                         VRTSourceIOJobFunc()                         */
+/************************************************************************/
+
+static void VRTSourceIOJobFunc( void* pData )
+{
+    VRTSourceIOJob* psJob = static_cast<VRTSourceIOJob*>(pData);
+    CPLPushErrorHandlerEx(VRTSourceIOJobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    if( psJob->panBandMap == nullptr )
+    {
+        psJob->eErr = psJob->poSource->RasterIO(
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nPixelSpace, psJob->nLineSpace,
+            &psJob->sExtraArg );
+    }
+    else
+    {
+        psJob->eErr = psJob->poSource->DatasetRasterIO(
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nBandCount, psJob->panBandMap,
+            psJob->nPixelSpace, psJob->nLineSpace, psJob->nBandSpace,
+            &psJob->sExtraArg );
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                         BuildSourceBatches()                         */
+/************************************************************************/
+
+// Split the sources of a request into consecutive batches whose sources
+// can be read concurrently: within a batch, sources write to disjoint parts
+// of the output buffer, so the paint order does not matter, and read from
+// distinct datasets, that must not be accessed from several threads.
+// Returns false if the sources must be read one after another.
+bool VRTSourcedRasterBand::BuildSourceBatches(
+    const std::vector<int>& anSources,
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    int nBufXSize, int nBufYSize, size_t nMaxBatchSize,
+    std::vector<std::vector<int>>& aanBatches )
+{
+    struct OutWindow
+    {
+        int nXOff;
+        int nYOff;
+        int nXSize;
+        int nYSize;
+    };
+    std::vector<OutWindow> asBatchWindows;
+    std::set<CPLString> oSetBatchDatasets;
+
+    aanBatches.clear();
+    aanBatches.resize(1);
+    for( const int iSource : anSources )
+    {
+        if( !papoSources[iSource]->IsSimpleSource() )
+            return false;
+        VRTSimpleSource* const poSS =
+            reinterpret_cast<VRTSimpleSource *>( papoSources[iSource] );
+
+        double dfReqXOff = 0.0;
+        double dfReqYOff = 0.0;
+        double dfReqXSize = 0.0;
+        double dfReqYSize = 0.0;
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        OutWindow sWindow = { 0, 0, 0, 0 };
+        if( !poSS->GetSrcDstWindow( nXOff, nYOff, nXSize, nYSize,
+                                    nBufXSize, nBufYSize,
+                                    &dfReqXOff, &dfReqYOff,
+                                    &dfReqXSize, &dfReqYSize,
+                                    &nReqXOff, &nReqYOff,
+                                    &nReqXSize, &nReqYSize,
+                                    &sWindow.nXOff, &sWindow.nYOff,
+                                    &sWindow.nXSize, &sWindow.nYSize ) )
+        {
+            // Nothing would be read from that source.
+            continue;
+        }
+
+        GDALRasterBand* poSrcBand = poSS->m_poMaskBandMainBand
+            ? poSS->m_poMaskBandMainBand : poSS->m_poRasterBand;
+        GDALDataset* poSrcDS =
+            poSrcBand != nullptr ? poSrcBand->GetDataset() : nullptr;
+        if( poSrcDS == nullptr )
+            return false;
+        CPLString osKey(poSrcDS->GetDescription());
+        // Nested VRTs might share their own sources with other sources.
+        if( STARTS_WITH_CI(osKey, "<VRTDataset") ||
+            EQUAL(CPLGetExtension(osKey), "vrt") )
+        {
+            return false;
+        }
+        if( osKey.empty() )
+            osKey.Printf("%p", poSrcDS);
+
+        bool bConflict = aanBatches.back().size() >= nMaxBatchSize ||
+                         oSetBatchDatasets.find(osKey) !=
+                                                    oSetBatchDatasets.end();
+        for( size_t i = 0; !bConflict && i < asBatchWindows.size(); i++ )
+        {
+            const OutWindow& sOther = asBatchWindows[i];
+            bConflict = sWindow.nXOff < sOther.nXOff + sOther.nXSize &&
+                        sOther.nXOff < sWindow.nXOff + sWindow.nXSize &&
+                        sWindow.nYOff < sOther.nYOff + sOther.nYSize &&
+                        sOther.nYOff < sWindow.nYOff + sWindow.nYSize;
+        }
+        if( bConflict )
+        {
+            aanBatches.resize(aanBatches.size() + 1);
+            asBatchWindows.clear();
+            oSetBatchDatasets.clear();
+        }
+        aanBatches.back().push_back(iSource);
+        asBatchWindows.push_back(sWindow);
+        oSetBatchDatasets.insert(osKey);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          RasterIOSources()                           */
+/************************************************************************/
+
+/**
+ * Overlay the passed sources, in order, over the output buffer.
+ *
+ * When panBandMap is nullptr, sources are read with RasterIO(). Otherwise
+ * they are simple sources, read with DatasetRasterIO() for nBandCount
+ * bands. When the dataset has a thread pool (NUM_THREADS open option),
+ * sources that neither overlap nor share a dataset are read concurrently.
+ */
+CPLErr VRTSourcedRasterBand::RasterIOSources(
+    const std::vector<int>& anSources,
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    void *pData, int nBufXSize, int nBufYSize, GDALDataType eBufType,
+    int nBandCount, int *panBandMap,
+    GSpacing nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+    GDALRasterIOExtraArg* psExtraArg )
+{
     GDALProgressFunc const pfnProgressGlobal = psExtraArg->pfnProgress;
     void * const pProgressDataGlobal = psExtraArg->pProgressData;
-
+    const int nRequestSources = static_cast<int>(anSources.size());
+
+    VRTDataset* poVRTDS = dynamic_cast<VRTDataset *>( poDS );
+    CPLWorkerThreadPool* poThreadPool =
+        poVRTDS != nullptr && nRequestSources > 1 ?
+            poVRTDS->GetThreadPool() : nullptr;
+    std::vector<std::vector<int>> aanBatches;
+    if( poThreadPool == nullptr ||
+        !BuildSourceBatches( anSources, nXOff, nYOff, nXSize, nYSize,
+                             nBufXSize, nBufYSize,
+                             8 * static_cast<size_t>(
+                                        poThreadPool->GetThreadCount()),
+                             aanBatches ) )
+    {
 /* -------------------------------------------------------------------- */
 /*      Overlay each source in turn over top this.                      */
 /* -------------------------------------------------------------------- */
-    CPLErr eErr = CE_None;
-    for( int iSource = 0; eErr == CE_None && iSource < nSources; iSource++ )
-    {
-        psExtraArg->pfnProgress = GDALScaledProgress;
-        psExtraArg->pProgressData =
-            GDALCreateScaledProgress( 1.0 * iSource / nSources,
-                                      1.0 * (iSource + 1) / nSources,
-                                      pfnProgressGlobal,
-                                      pProgressDataGlobal );
-        if( psExtraArg->pProgressData == nullptr )
-            psExtraArg->pfnProgress = nullptr;
-
-        eErr =
-            papoSources[iSource]->RasterIO( nXOff, nYOff, nXSize, nYSize,
-                                            pData, nBufXSize, nBufYSize,
-                                            eBufType, nPixelSpace, nLineSpace,
-                                            psExtraArg);
-
-        GDALDestroyScaledProgress( psExtraArg->pProgressData );
+        CPLErr eErr = CE_None;
+        for( int i = 0; eErr == CE_None && i < nRequestSources; i++ )
+        {
+            psExtraArg->pfnProgress = GDALScaledProgress;
+            psExtraArg->pProgressData =
+                GDALCreateScaledProgress( 1.0 * i / nRequestSources,
+                                          1.0 * (i + 1) / nRequestSources,
+                                          pfnProgressGlobal,
+                                          pProgressDataGlobal );
+            if( psExtraArg->pProgressData == nullptr )
+                psExtraArg->pfnProgress = nullptr;
+
+            if( panBandMap == nullptr )
+            {
+                eErr = papoSources[anSources[i]]->RasterIO(
+                    nXOff, nYOff, nXSize, nYSize,
+                    pData, nBufXSize, nBufYSize,
+                    eBufType, nPixelSpace, nLineSpace, psExtraArg );
+            }
+            else
+            {
+                VRTSimpleSource* poSource =
+                    reinterpret_cast<VRTSimpleSource *>(
+                        papoSources[anSources[i]] );
+                eErr = poSource->DatasetRasterIO(
+                    nXOff, nYOff, nXSize, nYSize,
+                    pData, nBufXSize, nBufYSize, eBufType,
+                    nBandCount, panBandMap,
+                    nPixelSpace, nLineSpace, nBandSpace, psExtraArg );
+            }
+
+            GDALDestroyScaledProgress( psExtraArg->pProgressData );
+        }
+
+        psExtraArg->pfnProgress = pfnProgressGlobal;
+        psExtraArg->pProgressData = pProgressDataGlobal;
+
+        return eErr;
     }
 
-    psExtraArg->pfnProgress = pfnProgressGlobal;
-    psExtraArg->pProgressData = pProgressDataGlobal;
+/* -------------------------------------------------------------------- */
+/*      Read the sources of each batch concurrently, and the batches    */
+/*      one after another.                                              */
+/* -------------------------------------------------------------------- */
+    std::vector<VRTSourceIOJob> asJobs;
+    std::vector<void*> apJobs;
+    int nDoneSources = 0;
+    for( const auto& anBatch : aanBatches )
+    {
+        asJobs.resize(anBatch.size());
+        apJobs.resize(anBatch.size());
+        for( size_t i = 0; i < anBatch.size(); i++ )
+        {
+            VRTSourceIOJob& sJob = asJobs[i];
+            sJob.poSource =
+                reinterpret_cast<VRTSimpleSource *>( papoSources[anBatch[i]] );
+            sJob.nXOff = nXOff;
+            sJob.nYOff = nYOff;
+            sJob.nXSize = nXSize;
+            sJob.nYSize = nYSize;
+            sJob.pData = pData;
+            sJob.nBufXSize = nBufXSize;
+            sJob.nBufYSize = nBufYSize;
+            sJob.eBufType = eBufType;
+            sJob.nBandCount = nBandCount;
+            sJob.panBandMap = panBandMap;
+            sJob.nPixelSpace = nPixelSpace;
+            sJob.nLineSpace = nLineSpace;
+            sJob.nBandSpace = nBandSpace;
+            INIT_RASTERIO_EXTRA_ARG(sJob.sExtraArg);
+            sJob.sExtraArg.eResampleAlg = psExtraArg->eResampleAlg;
+            sJob.eErr = CE_None;
+            sJob.aoErrors.clear();
+            apJobs[i] = &sJob;
+        }
 
-    m_nRecursionCounter--;
+        if( anBatch.size() == 1 )
+        {
+            VRTSourceIOJobFunc(apJobs[0]);
+        }
+        else
+        {
+            poThreadPool->SubmitJobs(VRTSourceIOJobFunc, apJobs);
+            poThreadPool->WaitCompletion();
+        }
 
-    return eErr;
+        CPLErr eErr = CE_None;
+        for( const auto& sJob : asJobs )
+        {
+            for( const auto& sError : sJob.aoErrors )
+            {
+                CPLError( sError.eErr, sError.nNo, "%s",
+                          sError.osMsg.c_str() );
+            }
+            if( eErr == CE_None )
+                eErr = sJob.eErr;
+        }
+        if( eErr != CE_None )
+            return eErr;
+
+        nDoneSources += static_cast<int>(anBatch.size());
+        if( pfnProgressGlobal != nullptr &&
+            !pfnProgressGlobal( 1.0 * nDoneSources / nRequestSources, "",
+                                pProgressDataGlobal ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            return CE_Failure;
+        }
+    }
+
+    return CE_None;
 }
 
 /************************************************************************/
@@ -353,7 +820,9 @@ int  VRTSourcedRasterBand::IGetDataCoverageStatus( int nXOff,
     poLR->addPoint( nXOff, nYOff );
     poPolyNonCoveredBySources->addRingDirectly(poLR);
 
-    for( int iSource = 0; iSource < nSources; iSource++ )
+    std::vector<int> anSources;
+    GetSourcesIntersecting(nXOff, nYOff, nXSize, nYSize, anSources);
+    for( const int iSource : anSources )
     {
         if( !papoSources[iSource]->IsSimpleSource() )
         {
@@ -897,6 +1366,7 @@ CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
     papoSources = static_cast<VRTSource **>(
         CPLRealloc( papoSources, sizeof(void*) * nSources ) );
     papoSources[nSources-1] = poNewSource;
+    InvalidateSourceIndex();
 
     reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
 
@@ -1594,6 +2064,7 @@ CPLErr VRTSourcedRasterBand::SetMetadataItem( const char *pszName,
         {
             delete papoSources[iSource];
             papoSources[iSource] = poSource;
+            InvalidateSourceIndex();
             reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
             return CE_None;
         }
@@ -1625,6 +2096,7 @@ CPLErr VRTSourcedRasterBand::SetMetadata( char **papszNewMD, const char *pszDoma
             CPLFree( papoSources );
             papoSources = nullptr;
             nSources = 0;
+            InvalidateSourceIndex();
         }
 
         for( int i = 0; i < CSLCount(papszNewMD); i++ )
@@ -1686,6 +2158,7 @@ int VRTSourcedRasterBand::CloseDependentDatasets()
     CPLFree( papoSources );
     papoSources = nullptr;
     nSources = 0;
+    InvalidateSourceIndex();
 
     return TRUE;
 }
@@ -220,7 +220,6 @@ class CPL_DLL GDALProxyPoolDataset : public GDALProxyDataset
         CPLHashSet      *metadataSet;
         CPLHashSet      *metadataItemSet;
 
-        GDALProxyPoolCacheEntry* cacheEntry;
         char            *m_pszOwner;
 
         GDALDataset *RefUnderlyingDataset(bool bForceOpen);
@@ -289,6 +288,11 @@ class CPL_DLL GDALProxyPoolRasterBand : public GDALProxyRasterBand
     GDALProxyPoolOverviewRasterBand **papoProxyOverviewRasterBand;
     GDALProxyPoolMaskBand            *poProxyMaskBand;
 
+    // Underlying dataset of each referenced underlying band, with its
+    // reference count, since each thread may use its own underlying dataset.
+    std::map<GDALRasterBand*, std::pair<GDALDataset*, int>>
+                                      oMapRefUnderlyingDataset;
+
     void Init();
 
     GDALRasterBand* RefUnderlyingRasterBand( bool bForceOpen );
@@ -341,8 +345,10 @@ class GDALProxyPoolOverviewRasterBand : public GDALProxyPoolRasterBand
     GDALProxyPoolRasterBand *poMainBand;
     int                      nOverviewBand;
 
-    GDALRasterBand          *poUnderlyingMainRasterBand;
-    int                      nRefCountUnderlyingMainRasterBand;
+    // Underlying main band of each referenced underlying overview band,
+    // with its reference count, since each thread may use its own one.
+    std::map<GDALRasterBand*, std::pair<GDALRasterBand*, int>>
+                             oMapRefUnderlyingMainRasterBand;
 
   protected:
     GDALRasterBand* RefUnderlyingRasterBand() override;
@@ -366,8 +372,10 @@ class GDALProxyPoolMaskBand : public GDALProxyPoolRasterBand
   private:
     GDALProxyPoolRasterBand *poMainBand;
 
-    GDALRasterBand          *poUnderlyingMainRasterBand;
-    int                      nRefCountUnderlyingMainRasterBand;
+    // Underlying main band of each referenced underlying mask band,
+    // with its reference count, since each thread may use its own one.
+    std::map<GDALRasterBand*, std::pair<GDALRasterBand*, int>>
+                             oMapRefUnderlyingMainRasterBand;
 
   protected:
     GDALRasterBand* RefUnderlyingRasterBand() override;
@@ -407,6 +415,20 @@ void CPL_DLL GDALProxyPoolDatasetAddSrcBandDescription( GDALProxyPoolDatasetH hP
                                                         GDALDataType eDataType,
                                                         int nBlockXSize, int nBlockYSize);
 
+/** Counters of the pool of datasets used by GDALProxyPoolDataset */
+typedef struct
+{
+    GUIntBig nHits;         /**< References served by an already opened dataset */
+    GUIntBig nMisses;       /**< References that required opening a dataset */
+    GUIntBig nEvictions;    /**< Idle datasets closed to make room in the pool */
+    double   dfOpenTime;    /**< Cumulated time spent opening datasets, in seconds */
+    double   dfMaxOpenTime; /**< Longest time spent opening a dataset, in seconds */
+    int      nMaxSize;      /**< Maximum number of opened datasets */
+    int      nCurrentSize;  /**< Number of currently opened datasets */
+} GDALProxyPoolStatistics;
+
+int CPL_DLL GDALGetProxyPoolStatistics( GDALProxyPoolStatistics* psStats );
+
 CPL_C_END
 
 #endif /* #ifndef DOXYGEN_SKIP */
@@ -30,9 +30,17 @@
 #include "cpl_port.h"
 #include "gdal_proxy.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -46,10 +54,14 @@
 
 CPL_CVSID("$Id$")
 
-/* We *must* share the same mutex as the gdaldataset.cpp file, as we are */
-/* doing GDALOpen() calls that can indirectly call GDALOpenShared() on */
-/* an auxiliary dataset ... */
-/* Then we could get dead-locks in multi-threaded use case */
+/* The pool has its own mutex, that only protects its entry list and lookup */
+/* maps, and that is never held while a dataset is opened or closed. */
+/* This is necessary since GDALOpen() can indirectly call GDALOpenShared() */
+/* on an auxiliary dataset, or create other GDALProxyPoolDataset (VRT of */
+/* VRT), which would otherwise cause dead-locks in multi-threaded use cases, */
+/* and this lets several threads open their datasets concurrently. */
+/* The pool singleton itself (Ref(), Unref(), ...) is still protected by */
+/* the mutex of gdaldataset.cpp */
 
 /* ******************************************************************** */
 /*                         GDALDatasetPool                              */
@@ -73,6 +85,11 @@ struct _GDALProxyPoolCacheEntry
     /* Ref count of the cached dataset */
     int           refCount;
 
+    /* Thread that holds the references of the cached dataset, when */
+    /* refCount > 0. A dataset handle is never used by two threads at */
+    /* the same time: other threads get their own entry for the same file */
+    GIntBig       userThreadId;
+
     GDALProxyPoolCacheEntry* prev;
     GDALProxyPoolCacheEntry* next;
 };
@@ -93,9 +110,27 @@ class GDALDatasetPool
         GDALProxyPoolCacheEntry* firstEntry;
         GDALProxyPoolCacheEntry* lastEntry;
 
-        /* This variable prevents a dataset that is going to be opened in GDALDatasetPool::_RefDataset */
-        /* from increasing refCount if, during its opening, it creates a GDALProxyPoolDataset */
-        /* We increment it before opening or closing a cached dataset and decrement it afterwards */
+        /* Protects the entry list, the lookup maps and the statistics */
+        CPLMutex* hMutex;
+
+        /* Entries indexed by file name, and by their opened dataset */
+        std::unordered_map<std::string,
+                           std::vector<GDALProxyPoolCacheEntry*>> oMapFileNameToEntries;
+        std::unordered_map<GDALDataset*, GDALProxyPoolCacheEntry*> oMapDSToEntry;
+
+        GUIntBig nHits;
+        GUIntBig nMisses;
+        GUIntBig nEvictions;
+        double dfOpenTime;
+        double dfMaxOpenTime;
+
+        /* This variable prevents the pool from being destroyed by inner */
+        /* GDALProxyPoolDataset while the driver manager is being destroyed. */
+        /* The per-thread counter returned by GetThreadDisableRefCount() */
+        /* plays the same role while the current thread is opening or closing */
+        /* a cached dataset: a dataset that is going to be opened in */
+        /* GDALDatasetPool::_RefDataset must not increase refCount if, during */
+        /* its opening, it creates a GDALProxyPoolDataset */
         /* The typical use case is a VRT made of simple sources that are VRT */
         /* We don't want the "inner" VRT to take a reference on the pool, otherwise there is */
         /* a high chance that this reference will not be dropped and the pool remain ghost */
@@ -105,13 +140,23 @@ class GDALDatasetPool
         /* least greater or equal than the maximum number of threads */
         explicit GDALDatasetPool(int maxSize);
         ~GDALDatasetPool();
-        GDALProxyPoolCacheEntry* _RefDataset(const char* pszFileName,
-                                             GDALAccess eAccess,
-                                             char** papszOpenOptions,
-                                             int bShared,
-                                             bool bForceOpen,
-                                             const char* pszOwner);
+        GDALDataset* _RefDataset(const char* pszFileName,
+                                 GDALAccess eAccess,
+                                 char** papszOpenOptions,
+                                 int bShared,
+                                 bool bForceOpen,
+                                 const char* pszOwner);
+        void _UnrefDataset(const char* pszFileName, GDALDataset* poDS);
         void _CloseDataset(const char* pszFileName, GDALAccess eAccess);
+        void _GetStatistics(GDALProxyPoolStatistics* psStats);
+
+        void MoveToFront(GDALProxyPoolCacheEntry* cur);
+        void Unlink(GDALProxyPoolCacheEntry* cur);
+        void RemoveFromMaps(GDALProxyPoolCacheEntry* cur);
+
+        static int& GetThreadDisableRefCount();
+        static void CloseCachedDataset(GDALDataset* poDS,
+                                       GIntBig responsiblePID);
 
 #ifdef DEBUG_PROXY_POOL
         // cppcheck-suppress unusedPrivateFunction
@@ -122,14 +167,15 @@ class GDALDatasetPool
     public:
         static void Ref();
         static void Unref();
-        static GDALProxyPoolCacheEntry* RefDataset(const char* pszFileName,
-                                                   GDALAccess eAccess,
-                                                   char** papszOpenOptions,
-                                                   int bShared,
-                                                   bool bForceOpen,
-                                                   const char* pszOwner);
-        static void UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry);
+        static GDALDataset* RefDataset(const char* pszFileName,
+                                       GDALAccess eAccess,
+                                       char** papszOpenOptions,
+                                       int bShared,
+                                       bool bForceOpen,
+                                       const char* pszOwner);
+        static void UnrefDataset(const char* pszFileName, GDALDataset* poDS);
         static void CloseDataset(const char* pszFileName, GDALAccess eAccess);
+        static int GetStatistics(GDALProxyPoolStatistics* psStats);
 
         static void PreventDestroy();
         static void ForceDestroy();
@@ -146,6 +192,12 @@ GDALDatasetPool::GDALDatasetPool(int maxSizeIn)
     currentSize = 0;
     firstEntry = nullptr;
     lastEntry = nullptr;
+    hMutex = nullptr;
+    nHits = 0;
+    nMisses = 0;
+    nEvictions = 0;
+    dfOpenTime = 0.0;
+    dfMaxOpenTime = 0.0;
     refCount = 0;
     refCountOfDisableRefCount = 0;
 }
@@ -157,6 +209,16 @@ GDALDatasetPool::GDALDatasetPool(int maxSizeIn)
 GDALDatasetPool::~GDALDatasetPool()
 {
     bInDestruction = true;
+
+    if( nHits + nMisses > 0 )
+    {
+        CPLDebug("GDAL",
+                 "Dataset pool: " CPL_FRMT_GUIB " hits, " CPL_FRMT_GUIB
+                 " misses, " CPL_FRMT_GUIB " evictions, "
+                 "open time: %.3f s (max %.3f s)",
+                 nHits, nMisses, nEvictions, dfOpenTime, dfMaxOpenTime);
+    }
+
     GDALProxyPoolCacheEntry* cur = firstEntry;
     GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
     while(cur)
@@ -174,6 +236,9 @@ GDALDatasetPool::~GDALDatasetPool()
         cur = next;
     }
     GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+
+    if( hMutex )
+        CPLDestroyMutex(hMutex);
 }
 
 #ifdef DEBUG_PROXY_POOL
@@ -217,146 +282,275 @@ void GDALDatasetPool::CheckLinks()
 #endif
 
 /************************************************************************/
-/*                            _RefDataset()                             */
+/*                     GetThreadDisableRefCount()                       */
 /************************************************************************/
 
-GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
-                                                      GDALAccess eAccess,
-                                                      char** papszOpenOptions,
-                                                      int bShared,
-                                                      bool bForceOpen,
-                                                      const char* pszOwner)
+int& GDALDatasetPool::GetThreadDisableRefCount()
 {
-    if( bInDestruction )
-        return nullptr;
+    int* pnCount =
+        static_cast<int *>(CPLGetTLS(CTLS_PROXYPOOL_DISABLE_REFCOUNT));
+    if( pnCount == nullptr )
+    {
+        pnCount = static_cast<int *>(CPLCalloc(1, sizeof(int)));
+        CPLSetTLS(CTLS_PROXYPOOL_DISABLE_REFCOUNT, pnCount, TRUE);
+    }
+    return *pnCount;
+}
 
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    GDALProxyPoolCacheEntry* lastEntryWithZeroRefCount = nullptr;
+/************************************************************************/
+/*                       CloseCachedDataset()                           */
+/************************************************************************/
 
-    while(cur)
-    {
-        GDALProxyPoolCacheEntry* next = cur->next;
+/* Must be called without holding hMutex */
+void GDALDatasetPool::CloseCachedDataset(GDALDataset* poDS,
+                                         GIntBig responsiblePID)
+{
+    /* Close by pretending we are the thread that GDALOpen'ed this */
+    /* dataset */
+    GIntBig curResponsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    GDALSetResponsiblePIDForCurrentThread(responsiblePID);
 
-        if (strcmp(cur->pszFileName, pszFileName) == 0 &&
-            ((bShared && cur->responsiblePID == responsiblePID &&
-              ((cur->pszOwner == nullptr && pszOwner == nullptr) ||
-                (cur->pszOwner != nullptr && pszOwner != nullptr &&
-                 strcmp(cur->pszOwner, pszOwner) == 0))) ||
-             (!bShared && cur->refCount == 0)) )
-        {
-            if (cur != firstEntry)
-            {
-                /* Move to begin */
-                if (cur->next)
-                    cur->next->prev = cur->prev;
-                else
-                    lastEntry = cur->prev;
-                cur->prev->next = cur->next;
-                cur->prev = nullptr;
-                firstEntry->prev = cur;
-                cur->next = firstEntry;
-                firstEntry = cur;
+    GetThreadDisableRefCount() ++;
+    GDALClose(poDS);
+    GetThreadDisableRefCount() --;
+
+    GDALSetResponsiblePIDForCurrentThread(curResponsiblePID);
+}
+
+/************************************************************************/
+/*                            MoveToFront()                             */
+/************************************************************************/
 
+void GDALDatasetPool::MoveToFront(GDALProxyPoolCacheEntry* cur)
+{
+    if (cur == firstEntry)
+        return;
+    Unlink(cur);
+    cur->prev = nullptr;
+    cur->next = firstEntry;
+    if (firstEntry)
+        firstEntry->prev = cur;
+    else
+        lastEntry = cur;
+    firstEntry = cur;
 #ifdef DEBUG_PROXY_POOL
-                CheckLinks();
+    CheckLinks();
 #endif
-            }
+}
 
-            cur->refCount ++;
-            return cur;
-        }
+/************************************************************************/
+/*                               Unlink()                               */
+/************************************************************************/
 
-        if (cur->refCount == 0)
-            lastEntryWithZeroRefCount = cur;
+void GDALDatasetPool::Unlink(GDALProxyPoolCacheEntry* cur)
+{
+    if (cur->prev)
+        cur->prev->next = cur->next;
+    else
+        firstEntry = cur->next;
+    if (cur->next)
+        cur->next->prev = cur->prev;
+    else
+        lastEntry = cur->prev;
+    cur->prev = nullptr;
+    cur->next = nullptr;
+}
 
-        cur = next;
-    }
+/************************************************************************/
+/*                          RemoveFromMaps()                            */
+/************************************************************************/
 
-    if( !bForceOpen )
-        return nullptr;
+void GDALDatasetPool::RemoveFromMaps(GDALProxyPoolCacheEntry* cur)
+{
+    if (cur->poDS)
+        oMapDSToEntry.erase(cur->poDS);
+    auto oIter = oMapFileNameToEntries.find(cur->pszFileName);
+    if (oIter == oMapFileNameToEntries.end())
+        return;
+    std::vector<GDALProxyPoolCacheEntry*>& apoEntries = oIter->second;
+    apoEntries.erase(std::remove(apoEntries.begin(), apoEntries.end(), cur),
+                     apoEntries.end());
+    if (apoEntries.empty())
+        oMapFileNameToEntries.erase(oIter);
+}
+
+/************************************************************************/
+/*                            _RefDataset()                             */
+/************************************************************************/
+
+GDALDataset* GDALDatasetPool::_RefDataset(const char* pszFileName,
+                                          GDALAccess eAccess,
+                                          char** papszOpenOptions,
+                                          int bShared,
+                                          bool bForceOpen,
+                                          const char* pszOwner)
+{
+    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    GIntBig userThreadId = CPLGetPID();
+    GDALProxyPoolCacheEntry* cur = nullptr;
+    GDALDataset* poDSToClose = nullptr;
+    GIntBig responsiblePIDToClose = 0;
 
-    if (currentSize == maxSize)
     {
-        if (lastEntryWithZeroRefCount == nullptr)
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                     "Too many threads are running for the current value of the dataset pool size (%d).\n"
-                     "or too many proxy datasets are opened in a cascaded way.\n"
-                     "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
+        CPLMutexHolderD( &hMutex );
+
+        if( bInDestruction )
             return nullptr;
+
+        auto oIter = oMapFileNameToEntries.find(pszFileName);
+        if (oIter != oMapFileNameToEntries.end())
+        {
+            for( GDALProxyPoolCacheEntry* poEntry : oIter->second )
+            {
+                /* An entry that is referenced by another thread is not */
+                /* shared: that thread will get its own dataset handle */
+                if ((bShared && poEntry->responsiblePID == responsiblePID &&
+                     (poEntry->refCount == 0 ||
+                      poEntry->userThreadId == userThreadId) &&
+                     ((poEntry->pszOwner == nullptr && pszOwner == nullptr) ||
+                      (poEntry->pszOwner != nullptr && pszOwner != nullptr &&
+                       strcmp(poEntry->pszOwner, pszOwner) == 0))) ||
+                    (!bShared && poEntry->refCount == 0))
+                {
+                    cur = poEntry;
+                    break;
+                }
+            }
         }
 
-        lastEntryWithZeroRefCount->pszFileName[0] = '\0';
-        if (lastEntryWithZeroRefCount->poDS)
+        if (cur)
         {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(lastEntryWithZeroRefCount->responsiblePID);
+            MoveToFront(cur);
 
-            refCountOfDisableRefCount ++;
-            GDALClose(lastEntryWithZeroRefCount->poDS);
-            refCountOfDisableRefCount --;
+            /* Either the dataset failed to open, or it is being opened */
+            /* by the current thread (recursive reference) */
+            if (cur->poDS == nullptr)
+                return nullptr;
 
-            lastEntryWithZeroRefCount->poDS = nullptr;
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+            cur->refCount ++;
+            cur->userThreadId = userThreadId;
+            nHits ++;
+            return cur->poDS;
         }
-        CPLFree(lastEntryWithZeroRefCount->pszFileName);
-        CPLFree(lastEntryWithZeroRefCount->pszOwner);
-
-        /* Recycle this entry for the to-be-opened dataset and */
-        /* moves it to the top of the list */
-        if (lastEntryWithZeroRefCount->prev)
-            lastEntryWithZeroRefCount->prev->next = lastEntryWithZeroRefCount->next;
-        else {
-            CPLAssert(false);
+
+        if( !bForceOpen )
+            return nullptr;
+
+        if (currentSize >= maxSize)
+        {
+            GDALProxyPoolCacheEntry* lastEntryWithZeroRefCount = lastEntry;
+            while (lastEntryWithZeroRefCount &&
+                   lastEntryWithZeroRefCount->refCount != 0)
+            {
+                lastEntryWithZeroRefCount = lastEntryWithZeroRefCount->prev;
+            }
+            if (lastEntryWithZeroRefCount == nullptr)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Too many threads are running for the current value of the dataset pool size (%d).\n"
+                         "or too many proxy datasets are opened in a cascaded way.\n"
+                         "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
+                return nullptr;
+            }
+
+            /* Recycle this entry for the to-be-opened dataset. The evicted */
+            /* dataset is closed once the lock is released */
+            cur = lastEntryWithZeroRefCount;
+            RemoveFromMaps(cur);
+            Unlink(cur);
+            poDSToClose = cur->poDS;
+            responsiblePIDToClose = cur->responsiblePID;
+            CPLFree(cur->pszFileName);
+            CPLFree(cur->pszOwner);
+            if (poDSToClose)
+                nEvictions ++;
         }
-        if (lastEntryWithZeroRefCount->next)
-            lastEntryWithZeroRefCount->next->prev = lastEntryWithZeroRefCount->prev;
         else
         {
-            CPLAssert(lastEntryWithZeroRefCount == lastEntry);
-            lastEntry->prev->next = nullptr;
-            lastEntry = lastEntry->prev;
+            cur = static_cast<GDALProxyPoolCacheEntry*>(
+                CPLMalloc(sizeof(GDALProxyPoolCacheEntry)));
+            cur->prev = nullptr;
+            cur->next = nullptr;
+            currentSize ++;
         }
-        lastEntryWithZeroRefCount->prev = nullptr;
-        lastEntryWithZeroRefCount->next = firstEntry;
-        firstEntry->prev = lastEntryWithZeroRefCount;
-        cur = firstEntry = lastEntryWithZeroRefCount;
-#ifdef DEBUG_PROXY_POOL
-        CheckLinks();
-#endif
-    }
-    else
-    {
+
+        cur->pszFileName = CPLStrdup(pszFileName);
+        cur->pszOwner = (pszOwner) ? CPLStrdup(pszOwner) : nullptr;
+        cur->responsiblePID = responsiblePID;
+        cur->poDS = nullptr;
+        cur->refCount = 1;
+        cur->userThreadId = userThreadId;
+
         /* Prepend */
-        cur = (GDALProxyPoolCacheEntry*) CPLMalloc(sizeof(GDALProxyPoolCacheEntry));
-        if (lastEntry == nullptr)
-            lastEntry = cur;
-        cur->prev = nullptr;
         cur->next = firstEntry;
         if (firstEntry)
             firstEntry->prev = cur;
+        else
+            lastEntry = cur;
         firstEntry = cur;
-        currentSize ++;
 #ifdef DEBUG_PROXY_POOL
         CheckLinks();
 #endif
+        oMapFileNameToEntries[cur->pszFileName].push_back(cur);
+        nMisses ++;
     }
 
-    cur->pszFileName = CPLStrdup(pszFileName);
-    cur->pszOwner = (pszOwner) ? CPLStrdup(pszOwner) : nullptr;
-    cur->responsiblePID = responsiblePID;
-    cur->refCount = 1;
+    if (poDSToClose)
+        CloseCachedDataset(poDSToClose, responsiblePIDToClose);
 
-    refCountOfDisableRefCount ++;
+    const auto tStart = std::chrono::steady_clock::now();
+    GetThreadDisableRefCount() ++;
     int nFlag = ((eAccess == GA_Update) ? GDAL_OF_UPDATE : GDAL_OF_READONLY) | GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
     CPLConfigOptionSetter oSetter("CPL_ALLOW_VSISTDIN", "NO", true);
-    cur->poDS = (GDALDataset*) GDALOpenEx( pszFileName, nFlag, nullptr,
+    GDALDataset* poDS = (GDALDataset*) GDALOpenEx( pszFileName, nFlag, nullptr,
                            (const char* const* )papszOpenOptions, nullptr );
-    refCountOfDisableRefCount --;
+    GetThreadDisableRefCount() --;
+    const double dfElapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - tStart).count();
+
+    CPLMutexHolderD( &hMutex );
+    dfOpenTime += dfElapsed;
+    dfMaxOpenTime = std::max(dfMaxOpenTime, dfElapsed);
+    cur->poDS = poDS;
+    if (poDS)
+        oMapDSToEntry[poDS] = cur;
+    else
+        cur->refCount --;
 
-    return cur;
+    return poDS;
+}
+
+/************************************************************************/
+/*                          _UnrefDataset()                             */
+/************************************************************************/
+
+void GDALDatasetPool::_UnrefDataset(const char* pszFileName, GDALDataset* poDS)
+{
+    CPLMutexHolderD( &hMutex );
+
+    auto oIter = oMapDSToEntry.find(poDS);
+    if (oIter != oMapDSToEntry.end())
+    {
+        oIter->second->refCount --;
+        return;
+    }
+
+    /* The caller may give us a dataset returned by GetDataset() on one of */
+    /* the bands, that is not necessarily the cached one. Fall back to the */
+    /* entry of the file referenced by the current thread */
+    auto oIterFileName = oMapFileNameToEntries.find(pszFileName);
+    if (oIterFileName == oMapFileNameToEntries.end())
+        return;
+    const GIntBig userThreadId = CPLGetPID();
+    for( GDALProxyPoolCacheEntry* poEntry : oIterFileName->second )
+    {
+        if (poEntry->refCount > 0 && poEntry->poDS != nullptr &&
+            poEntry->userThreadId == userThreadId)
+        {
+            poEntry->refCount --;
+            return;
+        }
+    }
 }
 
 /************************************************************************/
@@ -366,36 +560,55 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
 void GDALDatasetPool::_CloseDataset( const char* pszFileName,
                                      GDALAccess /* eAccess */ )
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    std::vector<std::pair<GDALDataset*, GIntBig>> aoToClose;
 
-    while(cur)
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-
-        CPLAssert(cur->pszFileName);
-        if (strcmp(cur->pszFileName, pszFileName) == 0 && cur->refCount == 0 &&
-            cur->poDS != nullptr )
-        {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
+        CPLMutexHolderD( &hMutex );
 
-            refCountOfDisableRefCount ++;
-            GDALClose(cur->poDS);
-            refCountOfDisableRefCount --;
+        if( bInDestruction )
+            return;
 
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+        auto oIter = oMapFileNameToEntries.find(pszFileName);
+        if (oIter == oMapFileNameToEntries.end())
+            return;
 
-            cur->poDS = nullptr;
-            cur->pszFileName[0] = '\0';
-            CPLFree(cur->pszOwner);
-            cur->pszOwner = nullptr;
-            break;
+        /* Close all the idle handles of the file, as several threads */
+        /* may have opened it */
+        const std::vector<GDALProxyPoolCacheEntry*> apoEntries(oIter->second);
+        for( GDALProxyPoolCacheEntry* cur : apoEntries )
+        {
+            if (cur->refCount == 0 && cur->poDS != nullptr)
+            {
+                aoToClose.push_back(
+                    std::pair<GDALDataset*, GIntBig>(cur->poDS,
+                                                     cur->responsiblePID));
+                RemoveFromMaps(cur);
+                cur->poDS = nullptr;
+                cur->pszFileName[0] = '\0';
+                CPLFree(cur->pszOwner);
+                cur->pszOwner = nullptr;
+            }
         }
-
-        cur = next;
     }
+
+    for( const auto& oToClose : aoToClose )
+        CloseCachedDataset(oToClose.first, oToClose.second);
+}
+
+/************************************************************************/
+/*                          _GetStatistics()                            */
+/************************************************************************/
+
+void GDALDatasetPool::_GetStatistics(GDALProxyPoolStatistics* psStats)
+{
+    CPLMutexHolderD( &hMutex );
+    psStats->nHits = nHits;
+    psStats->nMisses = nMisses;
+    psStats->nEvictions = nEvictions;
+    psStats->dfOpenTime = dfOpenTime;
+    psStats->dfMaxOpenTime = dfMaxOpenTime;
+    psStats->nMaxSize = maxSize;
+    psStats->nCurrentSize = static_cast<int>(oMapDSToEntry.size());
 }
 
 /************************************************************************/
@@ -412,7 +625,8 @@ void GDALDatasetPool::Ref()
             l_maxSize = 100;
         singleton = new GDALDatasetPool(l_maxSize);
     }
-    if (singleton->refCountOfDisableRefCount == 0)
+    if (singleton->refCountOfDisableRefCount == 0 &&
+        GetThreadDisableRefCount() == 0)
       singleton->refCount++;
 }
 
@@ -445,7 +659,8 @@ void GDALDatasetPool::Unref()
         CPLAssert(false);
         return;
     }
-    if (singleton->refCountOfDisableRefCount == 0)
+    if (singleton->refCountOfDisableRefCount == 0 &&
+        GetThreadDisableRefCount() == 0)
     {
       singleton->refCount--;
       if (singleton->refCount == 0)
@@ -481,14 +696,16 @@ void GDALDatasetPoolForceDestroy()
 /*                           RefDataset()                               */
 /************************************************************************/
 
-GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
-                                                     GDALAccess eAccess,
-                                                     char** papszOpenOptions,
-                                                     int bShared,
-                                                     bool bForceOpen,
-                                                     const char* pszOwner)
+/* The singleton cannot be destroyed while a toplevel GDALProxyPoolDataset */
+/* exists, so it is safe to access it without the mutex of gdaldataset.cpp */
+
+GDALDataset* GDALDatasetPool::RefDataset(const char* pszFileName,
+                                         GDALAccess eAccess,
+                                         char** papszOpenOptions,
+                                         int bShared,
+                                         bool bForceOpen,
+                                         const char* pszOwner)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
     return singleton->_RefDataset(pszFileName, eAccess, papszOpenOptions,
                                   bShared, bForceOpen, pszOwner);
 }
@@ -497,10 +714,9 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
 /*                       UnrefDataset()                                 */
 /************************************************************************/
 
-void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
+void GDALDatasetPool::UnrefDataset(const char* pszFileName, GDALDataset* poDS)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
-    cacheEntry->refCount --;
+    singleton->_UnrefDataset(pszFileName, poDS);
 }
 
 /************************************************************************/
@@ -509,10 +725,49 @@ void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
 
 void GDALDatasetPool::CloseDataset(const char* pszFileName, GDALAccess eAccess)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
     singleton->_CloseDataset(pszFileName, eAccess);
 }
 
+/************************************************************************/
+/*                          GetStatistics()                             */
+/************************************************************************/
+
+int GDALDatasetPool::GetStatistics(GDALProxyPoolStatistics* psStats)
+{
+    CPLMutexHolderD( GDALGetphDLMutex() );
+    if (! singleton)
+        return FALSE;
+    singleton->_GetStatistics(psStats);
+    return TRUE;
+}
+
+/************************************************************************/
+/*                     GDALGetProxyPoolStatistics()                     */
+/************************************************************************/
+
+/**
+ * \brief Fetch the counters of the pool of datasets.
+ *
+ * GDALProxyPoolDataset objects, used for example by the sources of VRT
+ * datasets, defer the opening of their underlying dataset to a pool limited
+ * to GDAL_MAX_DATASET_POOL_SIZE opened datasets. This function returns the
+ * number of requests served by an already opened dataset (hits), the number
+ * of requests that required opening a dataset (misses), the number of idle
+ * datasets closed to make room (evictions), and the time spent in opening
+ * datasets. The counters are reset when the pool is destroyed, that is to
+ * say when the last GDALProxyPoolDataset is closed.
+ *
+ * @param psStats structure to fill.
+ * @return TRUE if the pool currently exists, FALSE otherwise (psStats is
+ * then left untouched).
+ * @since GDAL 2.3
+ */
+
+int GDALGetProxyPoolStatistics(GDALProxyPoolStatistics* psStats)
+{
+    return GDALDatasetPool::GetStatistics(psStats);
+}
+
 CPL_C_START
 
 typedef struct
@@ -656,7 +911,6 @@ GDALProxyPoolDataset::GDALProxyPoolDataset(const char* pszSourceDatasetDescripti
     pasGCPList = nullptr;
     metadataSet = nullptr;
     metadataItemSet = nullptr;
-    cacheEntry = nullptr;
 }
 
 /************************************************************************/
@@ -734,17 +988,11 @@ GDALDataset* GDALProxyPoolDataset::RefUnderlyingDataset(bool bForceOpen)
     /* a VRT of GeoTIFFs that have associated .aux files */
     GIntBig curResponsiblePID = GDALGetResponsiblePIDForCurrentThread();
     GDALSetResponsiblePIDForCurrentThread(responsiblePID);
-    cacheEntry = GDALDatasetPool::RefDataset(GetDescription(), eAccess, papszOpenOptions,
-                                             GetShared(), bForceOpen, m_pszOwner);
+    GDALDataset* poUnderlyingDataset =
+        GDALDatasetPool::RefDataset(GetDescription(), eAccess, papszOpenOptions,
+                                    GetShared(), bForceOpen, m_pszOwner);
     GDALSetResponsiblePIDForCurrentThread(curResponsiblePID);
-    if (cacheEntry != nullptr)
-    {
-        if (cacheEntry->poDS != nullptr)
-            return cacheEntry->poDS;
-        else
-            GDALDatasetPool::UnrefDataset(cacheEntry);
-    }
-    return nullptr;
+    return poUnderlyingDataset;
 }
 
 /************************************************************************/
@@ -752,14 +1000,10 @@ GDALDataset* GDALProxyPoolDataset::RefUnderlyingDataset(bool bForceOpen)
 /************************************************************************/
 
 void GDALProxyPoolDataset::UnrefUnderlyingDataset(
-    CPL_UNUSED GDALDataset* poUnderlyingDataset )
+    GDALDataset* poUnderlyingDataset )
 {
-    if (cacheEntry != nullptr)
-    {
-        CPLAssert(cacheEntry->poDS == poUnderlyingDataset);
-        if (cacheEntry->poDS != nullptr)
-            GDALDatasetPool::UnrefDataset(cacheEntry);
-    }
+    if (poUnderlyingDataset != nullptr)
+        GDALDatasetPool::UnrefDataset(GetDescription(), poUnderlyingDataset);
 }
 
 /************************************************************************/
@@ -1072,6 +1316,43 @@ void GDALProxyPoolRasterBand::AddSrcMaskBandDescription( GDALDataType eDataTypeI
                                                 nBlockXSizeIn, nBlockYSizeIn);
 }
 
+/************************************************************************/
+/*                     GDALProxyPoolRememberRef()                       */
+/************************************************************************/
+
+/* Protects the maps of references of all the proxy bands. They are only */
+/* held for short lookups. */
+static std::mutex oRefMapMutex;
+
+template<class T> static void GDALProxyPoolRememberRef(
+    std::map<GDALRasterBand*, std::pair<T*, int>>& oMap,
+    GDALRasterBand* poUnderlyingBand, T* poObject )
+{
+    std::lock_guard<std::mutex> oLock(oRefMapMutex);
+    std::pair<T*, int>& oRef = oMap[poUnderlyingBand];
+    oRef.first = poObject;
+    oRef.second ++;
+}
+
+/************************************************************************/
+/*                      GDALProxyPoolForgetRef()                        */
+/************************************************************************/
+
+template<class T> static T* GDALProxyPoolForgetRef(
+    std::map<GDALRasterBand*, std::pair<T*, int>>& oMap,
+    GDALRasterBand* poUnderlyingBand )
+{
+    std::lock_guard<std::mutex> oLock(oRefMapMutex);
+    auto oIter = oMap.find(poUnderlyingBand);
+    if( oIter == oMap.end() )
+        return nullptr;
+    T* poObject = oIter->second.first;
+    oIter->second.second --;
+    if( oIter->second.second == 0 )
+        oMap.erase(oIter);
+    return poObject;
+}
+
 /************************************************************************/
 /*                  RefUnderlyingRasterBand()                           */
 /************************************************************************/
@@ -1086,8 +1367,13 @@ GDALRasterBand* GDALProxyPoolRasterBand::RefUnderlyingRasterBand(bool bForceOpen
     if (poBand == nullptr)
     {
         ((GDALProxyPoolDataset*)poDS)->UnrefUnderlyingDataset(poUnderlyingDataset);
+        return nullptr;
     }
 
+    /* Remember the dataset we got the band from, so as to release it */
+    /* even if the band does not report it with GetDataset() */
+    GDALProxyPoolRememberRef(oMapRefUnderlyingDataset, poBand,
+                             poUnderlyingDataset);
     return poBand;
 }
 
@@ -1102,8 +1388,12 @@ GDALRasterBand* GDALProxyPoolRasterBand::RefUnderlyingRasterBand()
 
 void GDALProxyPoolRasterBand::UnrefUnderlyingRasterBand(GDALRasterBand* poUnderlyingRasterBand)
 {
-    if (poUnderlyingRasterBand)
-        ((GDALProxyPoolDataset*)poDS)->UnrefUnderlyingDataset(poUnderlyingRasterBand->GetDataset());
+    if (poUnderlyingRasterBand == nullptr)
+        return;
+    GDALDataset* poUnderlyingDataset =
+        GDALProxyPoolForgetRef(oMapRefUnderlyingDataset, poUnderlyingRasterBand);
+    CPLAssert(poUnderlyingDataset != nullptr);
+    ((GDALProxyPoolDataset*)poDS)->UnrefUnderlyingDataset(poUnderlyingDataset);
 }
 
 /************************************************************************/
@@ -1338,9 +1628,6 @@ GDALProxyPoolOverviewRasterBand::GDALProxyPoolOverviewRasterBand(GDALProxyPoolDa
 {
     poMainBand = poMainBandIn;
     nOverviewBand = nOverviewBandIn;
-
-    poUnderlyingMainRasterBand = nullptr;
-    nRefCountUnderlyingMainRasterBand = 0;
 }
 
 /* ******************************************************************** */
@@ -1349,7 +1636,7 @@ GDALProxyPoolOverviewRasterBand::GDALProxyPoolOverviewRasterBand(GDALProxyPoolDa
 
 GDALProxyPoolOverviewRasterBand::~GDALProxyPoolOverviewRasterBand()
 {
-    CPLAssert(nRefCountUnderlyingMainRasterBand == 0);
+    CPLAssert(oMapRefUnderlyingMainRasterBand.empty());
 }
 
 /* ******************************************************************** */
@@ -1358,12 +1645,21 @@ GDALProxyPoolOverviewRasterBand::~GDALProxyPoolOverviewRasterBand()
 
 GDALRasterBand* GDALProxyPoolOverviewRasterBand::RefUnderlyingRasterBand()
 {
-    poUnderlyingMainRasterBand = poMainBand->RefUnderlyingRasterBand();
+    GDALRasterBand* poUnderlyingMainRasterBand =
+        poMainBand->RefUnderlyingRasterBand();
     if (poUnderlyingMainRasterBand == nullptr)
         return nullptr;
 
-    nRefCountUnderlyingMainRasterBand ++;
-    return poUnderlyingMainRasterBand->GetOverview(nOverviewBand);
+    GDALRasterBand* poBand =
+        poUnderlyingMainRasterBand->GetOverview(nOverviewBand);
+    if (poBand == nullptr)
+    {
+        poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
+        return nullptr;
+    }
+    GDALProxyPoolRememberRef(oMapRefUnderlyingMainRasterBand, poBand,
+                             poUnderlyingMainRasterBand);
+    return poBand;
 }
 
 /* ******************************************************************** */
@@ -1371,10 +1667,15 @@ GDALRasterBand* GDALProxyPoolOverviewRasterBand::RefUnderlyingRasterBand()
 /* ******************************************************************** */
 
 void GDALProxyPoolOverviewRasterBand::UnrefUnderlyingRasterBand(
-    GDALRasterBand* /* poUnderlyingRasterBand */ )
+    GDALRasterBand* poUnderlyingRasterBand )
 {
+    if (poUnderlyingRasterBand == nullptr)
+        return;
+    GDALRasterBand* poUnderlyingMainRasterBand =
+        GDALProxyPoolForgetRef(oMapRefUnderlyingMainRasterBand,
+                               poUnderlyingRasterBand);
+    CPLAssert(poUnderlyingMainRasterBand != nullptr);
     poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
-    nRefCountUnderlyingMainRasterBand --;
 }
 
 /* ******************************************************************** */
@@ -1387,9 +1688,6 @@ GDALProxyPoolMaskBand::GDALProxyPoolMaskBand(GDALProxyPoolDataset* poDSIn,
         GDALProxyPoolRasterBand(poDSIn, poUnderlyingMaskBand)
 {
     poMainBand = poMainBandIn;
-
-    poUnderlyingMainRasterBand = nullptr;
-    nRefCountUnderlyingMainRasterBand = 0;
 }
 
 /* ******************************************************************** */
@@ -1403,9 +1701,6 @@ GDALProxyPoolMaskBand::GDALProxyPoolMaskBand(GDALProxyPoolDataset* poDSIn,
         GDALProxyPoolRasterBand(poDSIn, 1, eDataTypeIn, nBlockXSizeIn, nBlockYSizeIn)
 {
     poMainBand = poMainBandIn;
-
-    poUnderlyingMainRasterBand = nullptr;
-    nRefCountUnderlyingMainRasterBand = 0;
 }
 
 /* ******************************************************************** */
@@ -1414,7 +1709,7 @@ GDALProxyPoolMaskBand::GDALProxyPoolMaskBand(GDALProxyPoolDataset* poDSIn,
 
 GDALProxyPoolMaskBand::~GDALProxyPoolMaskBand()
 {
-    CPLAssert(nRefCountUnderlyingMainRasterBand == 0);
+    CPLAssert(oMapRefUnderlyingMainRasterBand.empty());
 }
 
 /* ******************************************************************** */
@@ -1423,12 +1718,20 @@ GDALProxyPoolMaskBand::~GDALProxyPoolMaskBand()
 
 GDALRasterBand* GDALProxyPoolMaskBand::RefUnderlyingRasterBand()
 {
-    poUnderlyingMainRasterBand = poMainBand->RefUnderlyingRasterBand();
+    GDALRasterBand* poUnderlyingMainRasterBand =
+        poMainBand->RefUnderlyingRasterBand();
     if (poUnderlyingMainRasterBand == nullptr)
         return nullptr;
 
-    nRefCountUnderlyingMainRasterBand ++;
-    return poUnderlyingMainRasterBand->GetMaskBand();
+    GDALRasterBand* poBand = poUnderlyingMainRasterBand->GetMaskBand();
+    if (poBand == nullptr)
+    {
+        poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
+        return nullptr;
+    }
+    GDALProxyPoolRememberRef(oMapRefUnderlyingMainRasterBand, poBand,
+                             poUnderlyingMainRasterBand);
+    return poBand;
 }
 
 /* ******************************************************************** */
@@ -1436,10 +1739,15 @@ GDALRasterBand* GDALProxyPoolMaskBand::RefUnderlyingRasterBand()
 /* ******************************************************************** */
 
 void GDALProxyPoolMaskBand::UnrefUnderlyingRasterBand(
-    GDALRasterBand* /* poUnderlyingRasterBand */ )
+    GDALRasterBand* poUnderlyingRasterBand )
 {
+    if (poUnderlyingRasterBand == nullptr)
+        return;
+    GDALRasterBand* poUnderlyingMainRasterBand =
+        GDALProxyPoolForgetRef(oMapRefUnderlyingMainRasterBand,
+                               poUnderlyingRasterBand);
+    CPLAssert(poUnderlyingMainRasterBand != nullptr);
     poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
-    nRefCountUnderlyingMainRasterBand --;
 }
 
 //! @endcond
@@ -324,6 +324,7 @@ class CPL_DLL OGRFeature
     OGRErr              SetGeomField( int iField, const OGRGeometry * );
 
     OGRFeature         *Clone() CPL_WARN_UNUSED_RESULT;
+    bool                SwapContent( OGRFeature *poOther );
     virtual OGRBoolean  Equal( OGRFeature * poFeature );
 
     int                 GetFieldCount() const
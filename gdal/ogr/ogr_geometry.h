@@ -503,6 +503,7 @@ class CPL_DLL OGRSimpleCurve: public OGRCurve
     friend class OGRGeometry;
 
     int         nPointCount;
+    int         nPointCapacity;
     OGRRawPoint *paoPoints;
     double      *padfZ;
     double      *padfM;
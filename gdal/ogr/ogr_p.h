@@ -179,4 +179,7 @@ void CPL_DLL OGRUpdateFieldType( OGRFieldDefn* poFDefn,
                                  OGRFieldType eNewType,
                                  OGRFieldSubType eNewSubType );
 
+GUInt32 CPL_DLL OGRHilbertCode( const OGREnvelope& sDomain,
+                                double dfX, double dfY );
+
 #endif /* ndef OGR_P_H_INCLUDED */
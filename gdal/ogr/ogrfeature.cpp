@@ -40,6 +40,7 @@
 
 #include <limits>
 #include <new>
+#include <utility>
 #include <vector>
 
 #include "cpl_conv.h"
@@ -984,6 +985,51 @@ bool OGRFeature::CopySelfTo( OGRFeature* poNew )
     return true;
 }
 
+/************************************************************************/
+/*                            SwapContent()                             */
+/************************************************************************/
+
+/**
+ * \brief Exchange the content of two features.
+ *
+ * The FID, field values, geometries, style string and native data of this
+ * feature are exchanged with the ones of poOther, without any copy.  Both
+ * features must share the same feature definition.
+ *
+ * This is typically used to recycle a feature object, for example by
+ * OGRLayer::GetNextFeatureInto().
+ *
+ * @param poOther the other feature.
+ *
+ * @return true on success, false if the definitions differ.
+ *
+ * @since GDAL 2.3
+ */
+
+bool OGRFeature::SwapContent( OGRFeature *poOther )
+
+{
+    if( poOther == this )
+        return true;
+    if( poOther->poDefn != poDefn )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "SwapContent(): features have different definitions." );
+        return false;
+    }
+
+    std::swap( nFID, poOther->nFID );
+    std::swap( pauFields, poOther->pauFields );
+    std::swap( papoGeometries, poOther->papoGeometries );
+    std::swap( m_pszNativeData, poOther->m_pszNativeData );
+    std::swap( m_pszNativeMediaType, poOther->m_pszNativeMediaType );
+    std::swap( m_pszStyleString, poOther->m_pszStyleString );
+    std::swap( m_poStyleTable, poOther->m_poStyleTable );
+    std::swap( m_pszTmpFieldValue, poOther->m_pszTmpFieldValue );
+
+    return true;
+}
+
 /************************************************************************/
 /*                           GetFieldCount()                            */
 /************************************************************************/
@@ -3707,10 +3753,25 @@ void OGRFeature::SetField( int iField, const char * pszValue )
     OGRFieldType eType = poFDefn->GetType();
     if( eType == OFTString )
     {
+        if( pszValue == nullptr )
+            pszValue = "";
+
+        // Overwrite the previous value in place when it is long enough, so
+        // that features reused for reading do not reallocate their strings.
+        const size_t nLen = strlen(pszValue);
+        if( IsFieldSetAndNotNull(iField) &&
+            pauFields[iField].String != nullptr &&
+            strlen(pauFields[iField].String) >= nLen )
+        {
+            memmove( pauFields[iField].String, pszValue, nLen + 1 );
+            return;
+        }
+
+        char* pszNewValue = VSI_STRDUP_VERBOSE(pszValue);
         if( IsFieldSetAndNotNull(iField) )
             CPLFree( pauFields[iField].String );
 
-        pauFields[iField].String = VSI_STRDUP_VERBOSE(pszValue ? pszValue : "");
+        pauFields[iField].String = pszNewValue;
         if( pauFields[iField].String == nullptr )
         {
             OGR_RawField_SetUnset(&pauFields[iField]);
@@ -32,9 +32,12 @@
 #include "ogr_feature.h"
 #include "swq.h"
 
+#include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <algorithm>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -351,6 +354,376 @@ int OGRFeatureQuery::Evaluate( OGRFeature *poFeature )
     return bLogicalResult;
 }
 
+/************************************************************************/
+/*                         OGRIndexedPredicate                          */
+/*                                                                      */
+/*      Description of an elementary predicate of the WHERE clause      */
+/*      that may be answered by an attribute index.                     */
+/************************************************************************/
+
+namespace {
+struct OGRIndexedPredicate
+{
+    OGRAttrIndex   *poIndex = nullptr;
+    OGRFieldDefn   *poFieldDefn = nullptr;
+    swq_expr_node  *poColumn = nullptr;
+    swq_op          eOp = SWQ_EQ;
+    // Constant operands, in the order of the operator once the column
+    // has been put first.
+    std::vector<swq_expr_node*> apoValues{};
+    // Literal prefix of a LIKE pattern.
+    CPLString       osPrefix{};
+};
+} // namespace
+
+/************************************************************************/
+/*                       OGRGetLikePatternPrefix()                      */
+/*                                                                      */
+/*      Returns the part of the pattern before the first wildcard.      */
+/************************************************************************/
+
+static CPLString OGRGetLikePatternPrefix( const char *pszPattern,
+                                          char chEscape )
+{
+    CPLString osPrefix;
+    for( ; *pszPattern != '\0'; pszPattern++ )
+    {
+        if( *pszPattern == '%' || *pszPattern == '_' ||
+            (chEscape != '\0' && *pszPattern == chEscape) )
+            break;
+        osPrefix += *pszPattern;
+    }
+    return osPrefix;
+}
+
+/************************************************************************/
+/*                      OGRAnalyzeIndexedPredicate()                    */
+/*                                                                      */
+/*      Checks whether psExpr is a comparison of an indexed field       */
+/*      against constants that its index is able to answer.            */
+/************************************************************************/
+
+static bool OGRAnalyzeIndexedPredicate( swq_expr_node *psExpr,
+                                        OGRLayer *poLayer,
+                                        OGRIndexedPredicate& oPred )
+{
+    if( psExpr == nullptr || psExpr->eNodeType != SNT_OPERATION ||
+        psExpr->nSubExprCount < 2 )
+        return false;
+
+    swq_op eOp = static_cast<swq_op>(psExpr->nOperation);
+    swq_expr_node *poColumn = psExpr->papoSubExpr[0];
+    swq_expr_node *poValue = psExpr->papoSubExpr[1];
+
+    // Accept "constant op column" for binary comparisons.
+    if( psExpr->nSubExprCount == 2 &&
+        poColumn->eNodeType == SNT_CONSTANT &&
+        poValue->eNodeType == SNT_COLUMN )
+    {
+        switch( eOp )
+        {
+            case SWQ_EQ: break;
+            case SWQ_GT: eOp = SWQ_LT; break;
+            case SWQ_GE: eOp = SWQ_LE; break;
+            case SWQ_LT: eOp = SWQ_GT; break;
+            case SWQ_LE: eOp = SWQ_GE; break;
+            default: return false;
+        }
+        std::swap(poColumn, poValue);
+    }
+
+    if( poColumn->eNodeType != SNT_COLUMN || poColumn->table_index != 0 )
+        return false;
+
+    const int nIdx = OGRFeatureFetcherFixFieldIndex(
+        poLayer->GetLayerDefn(), poColumn->field_index);
+    if( nIdx < 0 || nIdx >= poLayer->GetLayerDefn()->GetFieldCount() )
+        return false;
+
+    OGRAttrIndex *poIndex = poLayer->GetIndex()->GetFieldIndex(nIdx);
+    if( poIndex == nullptr )
+        return false;
+
+    oPred.poIndex = poIndex;
+    oPred.poFieldDefn = poLayer->GetLayerDefn()->GetFieldDefn(nIdx);
+    oPred.poColumn = poColumn;
+    oPred.eOp = eOp;
+    oPred.apoValues.clear();
+    oPred.apoValues.push_back(poValue);
+    for( int i = 2; i < psExpr->nSubExprCount; i++ )
+        oPred.apoValues.push_back(psExpr->papoSubExpr[i]);
+
+    for( size_t i = 0; i < oPred.apoValues.size(); i++ )
+    {
+        if( oPred.apoValues[i]->eNodeType != SNT_CONSTANT )
+            return false;
+    }
+
+    const OGRFieldType eType = oPred.poFieldDefn->GetType();
+
+    // Date comparisons are only done on parsed values for timestamps.
+    // Other cases use string comparisons that the index cannot reproduce.
+    // Only indexes with range support know how to build date keys.
+    if( (eType == OFTDate || eType == OFTDateTime) &&
+        (poColumn->field_type != SWQ_TIMESTAMP || eOp == SWQ_IN ||
+         eOp == SWQ_LIKE || !poIndex->SupportsRangeMatches()) )
+        return false;
+
+    switch( eOp )
+    {
+        case SWQ_EQ:
+            return oPred.apoValues.size() == 1;
+
+        case SWQ_IN:
+            return true;
+
+        case SWQ_GT:
+        case SWQ_GE:
+        case SWQ_LT:
+        case SWQ_LE:
+            return oPred.apoValues.size() == 1 &&
+                   poIndex->SupportsRangeMatches();
+
+        case SWQ_BETWEEN:
+            return oPred.apoValues.size() == 2 &&
+                   poIndex->SupportsRangeMatches();
+
+        case SWQ_LIKE:
+        {
+            if( eType != OFTString || !poIndex->SupportsRangeMatches() ||
+                poValue->field_type != SWQ_STRING ||
+                poValue->string_value == nullptr )
+                return false;
+            char chEscape = '\0';
+            if( oPred.apoValues.size() == 2 )
+            {
+                if( oPred.apoValues[1]->string_value == nullptr )
+                    return false;
+                chEscape = oPred.apoValues[1]->string_value[0];
+            }
+            oPred.osPrefix =
+                OGRGetLikePatternPrefix(poValue->string_value, chEscape);
+            return !oPred.osPrefix.empty();
+        }
+
+        default:
+            return false;
+    }
+}
+
+/************************************************************************/
+/*                          OGRGetIndexKey()                            */
+/*                                                                      */
+/*      Converts a constant into a key of the type of the indexed      */
+/*      field.  When a non integral value is compared to an integer     */
+/*      field, nRounding tells if it must be truncated (0, equality     */
+/*      tests), rounded up (1, lower bounds) or down (-1, upper         */
+/*      bounds).  In the two later cases *pbIncluded is set to true     */
+/*      as the rounded bound is then part of the range.                 */
+/************************************************************************/
+
+static bool OGRGetIndexKey( OGRFieldDefn *poFieldDefn, swq_expr_node *poValue,
+                            int nRounding, OGRField *psField,
+                            bool *pbIncluded )
+{
+    switch( poFieldDefn->GetType() )
+    {
+      case OFTInteger:
+      case OFTInteger64:
+      {
+        GIntBig nVal = 0;
+        if( poValue->field_type == SWQ_FLOAT )
+        {
+            double dfVal = poValue->float_value;
+            if( CPLIsNan(dfVal) )
+                return false;
+            if( nRounding != 0 && dfVal != floor(dfVal) )
+            {
+                dfVal = nRounding > 0 ? ceil(dfVal) : floor(dfVal);
+                if( pbIncluded )
+                    *pbIncluded = true;
+            }
+            if( poFieldDefn->GetType() == OFTInteger
+                ? !(dfVal >= INT_MIN && dfVal <= INT_MAX)
+                : !(dfVal >= -9.2e18 && dfVal <= 9.2e18) )
+                return false;
+            nVal = static_cast<GIntBig>(dfVal);
+        }
+        else
+        {
+            nVal = poValue->int_value;
+        }
+        if( poFieldDefn->GetType() == OFTInteger )
+        {
+            if( nRounding != 0 && !CPL_INT64_FITS_ON_INT32(nVal) )
+                return false;
+            psField->Integer = static_cast<int>(nVal);
+        }
+        else
+        {
+            psField->Integer64 = nVal;
+        }
+        return true;
+      }
+
+      case OFTReal:
+        if( SWQ_IS_INTEGER(poValue->field_type) )
+            psField->Real = static_cast<double>(poValue->int_value);
+        else
+            psField->Real = poValue->float_value;
+        return true;
+
+      case OFTString:
+        if( poValue->string_value == nullptr )
+            return false;
+        psField->String = poValue->string_value;
+        return true;
+
+      case OFTDate:
+      case OFTDateTime:
+        if( poValue->string_value == nullptr )
+            return false;
+        return OGRParseDate(poValue->string_value, psField, 0) == TRUE;
+
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                           OGRIndexedRange                            */
+/************************************************************************/
+
+namespace {
+struct OGRIndexedRange
+{
+    OGRField    sMin{};
+    OGRField    sMax{};
+    bool        bHasMin = false;
+    bool        bHasMax = false;
+    bool        bMinIncluded = true;
+    bool        bMaxIncluded = true;
+};
+} // namespace
+
+/************************************************************************/
+/*                         OGRGetIndexedRange()                         */
+/*                                                                      */
+/*      Fetch the bounds of a <, <=, >, >= or BETWEEN predicate.        */
+/************************************************************************/
+
+static bool OGRGetIndexedRange( const OGRIndexedPredicate& oPred,
+                                OGRIndexedRange& oRange )
+{
+    const swq_op eOp = oPred.eOp;
+    if( eOp != SWQ_GT && eOp != SWQ_GE && eOp != SWQ_LT && eOp != SWQ_LE &&
+        eOp != SWQ_BETWEEN )
+        return false;
+
+    oRange = OGRIndexedRange();
+    oRange.bMinIncluded = eOp != SWQ_GT;
+    oRange.bMaxIncluded = eOp != SWQ_LT;
+    if( eOp == SWQ_GT || eOp == SWQ_GE || eOp == SWQ_BETWEEN )
+    {
+        if( !OGRGetIndexKey(oPred.poFieldDefn, oPred.apoValues[0], 1,
+                            &oRange.sMin, &oRange.bMinIncluded) )
+            return false;
+        oRange.bHasMin = true;
+    }
+    if( eOp == SWQ_LT || eOp == SWQ_LE || eOp == SWQ_BETWEEN )
+    {
+        if( !OGRGetIndexKey(oPred.poFieldDefn, oPred.apoValues.back(), -1,
+                            &oRange.sMax, &oRange.bMaxIncluded) )
+            return false;
+        oRange.bHasMax = true;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         OGRCompareIndexKeys()                        */
+/*                                                                      */
+/*      Compare two keys with the semantics of the SQL engine.          */
+/************************************************************************/
+
+static int OGRCompareIndexKeys( OGRFieldType eType,
+                                const OGRField *psKey1,
+                                const OGRField *psKey2 )
+{
+    switch( eType )
+    {
+      case OFTInteger:
+        return psKey1->Integer < psKey2->Integer ? -1 :
+               psKey1->Integer > psKey2->Integer ? 1 : 0;
+      case OFTInteger64:
+        return psKey1->Integer64 < psKey2->Integer64 ? -1 :
+               psKey1->Integer64 > psKey2->Integer64 ? 1 : 0;
+      case OFTReal:
+        return psKey1->Real < psKey2->Real ? -1 :
+               psKey1->Real > psKey2->Real ? 1 : 0;
+      case OFTString:
+        return STRCASECMP(psKey1->String, psKey2->String);
+      default:
+        return OGRCompareDate(psKey1, psKey2);
+    }
+}
+
+/************************************************************************/
+/*                        OGRIntersectIndexedRange()                    */
+/*                                                                      */
+/*      Restrict oRange to the bounds of oOther.                        */
+/************************************************************************/
+
+static void OGRIntersectIndexedRange( OGRFieldType eType,
+                                      OGRIndexedRange& oRange,
+                                      const OGRIndexedRange& oOther )
+{
+    if( oOther.bHasMin )
+    {
+        const int nCmp = oRange.bHasMin ?
+            OGRCompareIndexKeys(eType, &oOther.sMin, &oRange.sMin) : 1;
+        if( nCmp > 0 )
+        {
+            oRange.sMin = oOther.sMin;
+            oRange.bMinIncluded = oOther.bMinIncluded;
+        }
+        else if( nCmp == 0 )
+        {
+            oRange.bMinIncluded &= oOther.bMinIncluded;
+        }
+        oRange.bHasMin = true;
+    }
+    if( oOther.bHasMax )
+    {
+        const int nCmp = oRange.bHasMax ?
+            OGRCompareIndexKeys(eType, &oOther.sMax, &oRange.sMax) : -1;
+        if( nCmp < 0 )
+        {
+            oRange.sMax = oOther.sMax;
+            oRange.bMaxIncluded = oOther.bMaxIncluded;
+        }
+        else if( nCmp == 0 )
+        {
+            oRange.bMaxIncluded &= oOther.bMaxIncluded;
+        }
+        oRange.bHasMax = true;
+    }
+}
+
+/************************************************************************/
+/*                         OGRQueryIndexedRange()                       */
+/************************************************************************/
+
+static GIntBig *OGRQueryIndexedRange( OGRAttrIndex *poIndex,
+                                      OGRIndexedRange& oRange,
+                                      int *pnFIDCount, int *pnLength )
+{
+    return poIndex->GetRangeMatches(
+        oRange.bHasMin ? &oRange.sMin : nullptr, oRange.bMinIncluded,
+        oRange.bHasMax ? &oRange.sMax : nullptr, oRange.bMaxIncluded,
+        nullptr, pnFIDCount, pnLength );
+}
+
 /************************************************************************/
 /*                            CanUseIndex()                             */
 /************************************************************************/
@@ -373,6 +746,9 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
     if( psExpr == nullptr || psExpr->eNodeType != SNT_OPERATION )
         return FALSE;
 
+    // Every operand must be indexed, even for AND: when only one side can
+    // be answered, EvaluateAgainstIndices() returns a superset of the
+    // matching features, so the query must be evaluated on each of them.
     if( (psExpr->nOperation == SWQ_OR || psExpr->nOperation == SWQ_AND) &&
          psExpr->nSubExprCount == 2 )
     {
@@ -380,26 +756,8 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
                CanUseIndex(psExpr->papoSubExpr[1], poLayer);
     }
 
-    if( !(psExpr->nOperation == SWQ_EQ || psExpr->nOperation == SWQ_IN)
-        || psExpr->nSubExprCount < 2 )
-        return FALSE;
-
-    swq_expr_node *poColumn = psExpr->papoSubExpr[0];
-    swq_expr_node *poValue = psExpr->papoSubExpr[1];
-
-    if( poColumn->eNodeType != SNT_COLUMN
-        || poValue->eNodeType != SNT_CONSTANT )
-        return FALSE;
-
-    OGRAttrIndex *poIndex =
-        poLayer->GetIndex()->GetFieldIndex(
-            OGRFeatureFetcherFixFieldIndex(poLayer->GetLayerDefn(),
-                                           poColumn->field_index));
-    if( poIndex == nullptr )
-        return FALSE;
-
-    // Have an index.
-    return TRUE;
+    OGRIndexedPredicate oPred;
+    return OGRAnalyzeIndexedPredicate(psExpr, poLayer, oPred);
 }
 
 /************************************************************************/
@@ -411,9 +769,15 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
 /*      available indices, or an "OGRNullFID" terminated list of        */
 /*      FIDs if it can.                                                 */
 /*                                                                      */
-/*      For now we only support equality tests on a single indexed      */
-/*      attribute field.  Eventually we should make this support        */
-/*      multi-part queries with ranges.                                 */
+/*      Equality and IN tests are supported on all indexes.  Range      */
+/*      comparisons, BETWEEN and LIKE 'prefix%' require an ordered      */
+/*      index (see OGRAttrIndex::SupportsRangeMatches()).               */
+/*                                                                      */
+/*      The elementary predicates can be combined with AND and OR.      */
+/*      When only one side of an AND can be answered, its result is     */
+/*      returned: it is then a superset of the matching features, so    */
+/*      callers must still evaluate the query against each feature,     */
+/*      as they already do.                                             */
 /************************************************************************/
 
 static int CompareGIntBig( const void *pa, const void *pb )
@@ -579,8 +943,7 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
         psExpr->eNodeType != SNT_OPERATION )
         return nullptr;
 
-    if( (psExpr->nOperation == SWQ_OR || psExpr->nOperation == SWQ_AND) &&
-         psExpr->nSubExprCount == 2 )
+    if( psExpr->nOperation == SWQ_OR && psExpr->nSubExprCount == 2 )
     {
         GIntBig nFIDCount1 = 0;
         GIntBig nFIDCount2 = 0;
@@ -592,139 +955,147 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
         GIntBig* panFIDList = nullptr;
         if( panFIDList1 != nullptr && panFIDList2 != nullptr )
         {
-            if( psExpr->nOperation == SWQ_OR )
-                panFIDList = OGRORGIntBigArray(panFIDList1, nFIDCount1,
-                                            panFIDList2, nFIDCount2, nFIDCount);
-            else if( psExpr->nOperation == SWQ_AND )
-                panFIDList = OGRANDGIntBigArray(panFIDList1, nFIDCount1,
-                                            panFIDList2, nFIDCount2, nFIDCount);
+            panFIDList = OGRORGIntBigArray(panFIDList1, nFIDCount1,
+                                           panFIDList2, nFIDCount2, nFIDCount);
         }
         CPLFree(panFIDList1);
         CPLFree(panFIDList2);
         return panFIDList;
     }
 
-    if( !(psExpr->nOperation == SWQ_EQ || psExpr->nOperation == SWQ_IN)
-        || psExpr->nSubExprCount < 2 )
-        return nullptr;
+    if( psExpr->nOperation == SWQ_AND && psExpr->nSubExprCount == 2 )
+    {
+/* -------------------------------------------------------------------- */
+/*      Two bounds on the same ordered index, like "x >= 1 AND          */
+/*      x < 5", are answered with a single range scan.                  */
+/* -------------------------------------------------------------------- */
+        OGRIndexedPredicate oPred1;
+        OGRIndexedPredicate oPred2;
+        OGRIndexedRange oRange1;
+        OGRIndexedRange oRange2;
+        if( OGRAnalyzeIndexedPredicate(psExpr->papoSubExpr[0], poLayer,
+                                       oPred1) &&
+            OGRAnalyzeIndexedPredicate(psExpr->papoSubExpr[1], poLayer,
+                                       oPred2) &&
+            oPred1.poIndex == oPred2.poIndex &&
+            OGRGetIndexedRange(oPred1, oRange1) &&
+            OGRGetIndexedRange(oPred2, oRange2) )
+        {
+            OGRIntersectIndexedRange(oPred1.poFieldDefn->GetType(),
+                                     oRange1, oRange2);
+            int nLength = 0;
+            int nFIDCount32 = 0;
+            GIntBig *panFIDs = OGRQueryIndexedRange(oPred1.poIndex, oRange1,
+                                                    &nFIDCount32, &nLength);
+            if( panFIDs == nullptr )
+                return nullptr;
+            nFIDCount = nFIDCount32;
+            if( nFIDCount > 1 )
+                qsort(panFIDs, static_cast<size_t>(nFIDCount),
+                      sizeof(GIntBig), CompareGIntBig);
+            return panFIDs;
+        }
 
-    swq_expr_node *poColumn = psExpr->papoSubExpr[0];
-    swq_expr_node *poValue = psExpr->papoSubExpr[1];
+        GIntBig nFIDCount1 = 0;
+        GIntBig nFIDCount2 = 0;
+        GIntBig* panFIDList1 =
+            EvaluateAgainstIndices(psExpr->papoSubExpr[0], poLayer, nFIDCount1);
+        // An empty list cannot be further restricted.
+        if( panFIDList1 != nullptr && nFIDCount1 == 0 )
+        {
+            nFIDCount = 0;
+            return panFIDList1;
+        }
+        GIntBig* panFIDList2 =
+            EvaluateAgainstIndices(psExpr->papoSubExpr[1], poLayer, nFIDCount2);
+        if( panFIDList1 == nullptr )
+        {
+            nFIDCount = nFIDCount2;
+            return panFIDList2;
+        }
+        if( panFIDList2 == nullptr )
+        {
+            nFIDCount = nFIDCount1;
+            return panFIDList1;
+        }
+        GIntBig* panFIDList =
+            OGRANDGIntBigArray(panFIDList1, nFIDCount1,
+                               panFIDList2, nFIDCount2, nFIDCount);
+        CPLFree(panFIDList1);
+        CPLFree(panFIDList2);
+        return panFIDList;
+    }
 
-    if( poColumn->eNodeType != SNT_COLUMN
-        || poValue->eNodeType != SNT_CONSTANT )
+    OGRIndexedPredicate oPred;
+    if( !OGRAnalyzeIndexedPredicate(psExpr, poLayer, oPred) )
         return nullptr;
 
-    const int nIdx = OGRFeatureFetcherFixFieldIndex(
-        poLayer->GetLayerDefn(), poColumn->field_index);
-
-    OGRAttrIndex *poIndex =
-        poLayer->GetIndex()->GetFieldIndex(nIdx);
-    if( poIndex == nullptr )
-        return nullptr;
+    OGRAttrIndex *poIndex = oPred.poIndex;
+    OGRFieldDefn *poFieldDefn = oPred.poFieldDefn;
 
     // Have an index, now we need to query it.
-    OGRField sValue;
-    OGRFieldDefn *poFieldDefn =
-        poLayer->GetLayerDefn()->GetFieldDefn(nIdx);
+    int nLength = 0;
+    int nFIDCount32 = 0;
+    GIntBig *panFIDs = nullptr;
 
-    // Handle the case of an IN operation.
-    if( psExpr->nOperation == SWQ_IN )
+    switch( oPred.eOp )
     {
-        int nLength = 0;
-        GIntBig *panFIDs = nullptr;
-        nFIDCount = 0;
-
-        for( int iIN = 1; iIN < psExpr->nSubExprCount; iIN++ )
+      // Handle the case of an IN operation and equality test.
+      case SWQ_EQ:
+      case SWQ_IN:
+      {
+        for( size_t iIN = 0; iIN < oPred.apoValues.size(); iIN++ )
         {
-            switch( poFieldDefn->GetType() )
+            OGRField sValue;
+            if( !OGRGetIndexKey(poFieldDefn, oPred.apoValues[iIN], 0,
+                                &sValue, nullptr) )
             {
-              case OFTInteger:
-                if( psExpr->papoSubExpr[iIN]->field_type == SWQ_FLOAT )
-                    sValue.Integer =
-                        static_cast<int>(psExpr->papoSubExpr[iIN]->float_value);
-                else
-                    sValue.Integer =
-                        static_cast<int>(psExpr->papoSubExpr[iIN]->int_value);
-                break;
-
-              case OFTInteger64:
-                if( psExpr->papoSubExpr[iIN]->field_type == SWQ_FLOAT )
-                    sValue.Integer64 = static_cast<GIntBig>(
-                        psExpr->papoSubExpr[iIN]->float_value);
-                else
-                    sValue.Integer64 = psExpr->papoSubExpr[iIN]->int_value;
-                break;
-
-              case OFTReal:
-                sValue.Real = psExpr->papoSubExpr[iIN]->float_value;
-                break;
-
-              case OFTString:
-                sValue.String = psExpr->papoSubExpr[iIN]->string_value;
-                break;
-
-              default:
-                CPLAssert(false);
+                CPLFree(panFIDs);
                 return nullptr;
             }
 
-            int nFIDCount32 = static_cast<int>(nFIDCount);
             panFIDs = poIndex->GetAllMatches(&sValue, panFIDs,
                                              &nFIDCount32, &nLength);
-            nFIDCount = nFIDCount32;
-        }
-
-        if( nFIDCount > 1 )
-        {
-            // The returned FIDs are expected to be in sorted order.
-            qsort(panFIDs, static_cast<size_t>(nFIDCount),
-                  sizeof(GIntBig), CompareGIntBig);
+            if( panFIDs == nullptr )
+                return nullptr;
         }
-        return panFIDs;
-    }
-
-    // Handle equality test.
-    switch( poFieldDefn->GetType() )
-    {
-      case OFTInteger:
-        if( poValue->field_type == SWQ_FLOAT )
-            sValue.Integer = static_cast<int>(poValue->float_value);
-        else
-            sValue.Integer = static_cast<int>(poValue->int_value);
         break;
-
-      case OFTInteger64:
-        if( poValue->field_type == SWQ_FLOAT )
-            sValue.Integer64 = static_cast<GIntBig>(poValue->float_value);
-        else
-            sValue.Integer64 = poValue->int_value;
-        break;
-
-      case OFTReal:
-        sValue.Real = poValue->float_value;
+      }
+
+      // Handle range comparisons.
+      case SWQ_GT:
+      case SWQ_GE:
+      case SWQ_LT:
+      case SWQ_LE:
+      case SWQ_BETWEEN:
+      {
+        OGRIndexedRange oRange;
+        if( !OGRGetIndexedRange(oPred, oRange) )
+            return nullptr;
+        panFIDs = OGRQueryIndexedRange(poIndex, oRange,
+                                       &nFIDCount32, &nLength);
         break;
+      }
 
-      case OFTString:
-        sValue.String = poValue->string_value;
+      case SWQ_LIKE:
+        panFIDs = poIndex->GetPrefixMatches(oPred.osPrefix, nullptr,
+                                            &nFIDCount32, &nLength);
         break;
 
       default:
         CPLAssert(false);
-        return nullptr;
+        break;
     }
 
-    int nLength = 0;
-    int nFIDCount32 = 0;
-    GIntBig* panFIDs =
-        poIndex->GetAllMatches(&sValue, nullptr, &nFIDCount32, &nLength);
+    if( panFIDs == nullptr )
+        return nullptr;
+
     nFIDCount = nFIDCount32;
     if( nFIDCount > 1 )
     {
         // The returned FIDs are expected to be sorted.
-        // TODO(schwehr): Use std::sort.
-        qsort(panFIDs, static_cast<size_t>(nFIDCount),
-              sizeof(GIntBig), CompareGIntBig);
+        qsort(panFIDs, static_cast<size_t>(nFIDCount), sizeof(GIntBig),
+              CompareGIntBig);
     }
     return panFIDs;
 }
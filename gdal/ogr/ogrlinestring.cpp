@@ -31,6 +31,7 @@
 #include "ogr_geos.h"
 #include "ogr_p.h"
 
+#include <climits>
 #include <cstdlib>
 #include <algorithm>
 #include <limits>
@@ -57,6 +58,7 @@ int DoubleToIntClamp(double dfValue) {
 /** Constructor */
 OGRSimpleCurve::OGRSimpleCurve() :
     nPointCount(0),
+    nPointCapacity(0),
     paoPoints(nullptr),
     padfZ(nullptr),
     padfM(nullptr)
@@ -78,6 +80,7 @@ OGRSimpleCurve::OGRSimpleCurve() :
 OGRSimpleCurve::OGRSimpleCurve( const OGRSimpleCurve& other ) :
     OGRCurve(other),
     nPointCount(0),
+    nPointCapacity(0),
     paoPoints(nullptr),
     padfZ(nullptr),
     padfM(nullptr)
@@ -238,12 +241,12 @@ void OGRSimpleCurve::Make3D()
 {
     if( padfZ == nullptr )
     {
-        if( nPointCount == 0 )
+        if( nPointCapacity == 0 )
             padfZ =
                 static_cast<double *>(VSI_CALLOC_VERBOSE(sizeof(double), 1));
         else
             padfZ = static_cast<double *>(VSI_CALLOC_VERBOSE(
-                sizeof(double), nPointCount));
+                sizeof(double), nPointCapacity));
         if( padfZ == nullptr )
         {
             flags &= ~OGR_G_3D;
@@ -279,12 +282,12 @@ void OGRSimpleCurve::AddM()
 {
     if( padfM == nullptr )
     {
-        if( nPointCount == 0 )
+        if( nPointCapacity == 0 )
             padfM =
                 static_cast<double *>(VSI_CALLOC_VERBOSE(sizeof(double), 1));
         else
             padfM = static_cast<double *>(
-                VSI_CALLOC_VERBOSE(sizeof(double), nPointCount));
+                VSI_CALLOC_VERBOSE(sizeof(double), nPointCapacity));
         if( padfM == nullptr )
         {
             flags &= ~OGR_G_MEASURED;
@@ -450,59 +453,78 @@ void OGRSimpleCurve::setNumPoints( int nNewPointCount, int bZeroizeNewContent )
         padfM = nullptr;
 
         nPointCount = 0;
+        nPointCapacity = 0;
         return;
     }
 
-    if( nNewPointCount > nPointCount )
+    // Buffers are only reallocated when growing beyond their capacity, so
+    // that a geometry reused for successive features keeps its allocations.
+    if( nNewPointCount > nPointCapacity )
     {
+        // When appending to existing points (addPoint() and the like, as
+        // done by most text based geometry parsers), grow the capacity
+        // geometrically rather than reallocating for every vertex.
+        int nNewCapacity = nNewPointCount;
+        if( nPointCount > 0 && nPointCapacity < INT_MAX / 3 )
+        {
+            nNewCapacity = std::max(nNewPointCount,
+                                    nPointCapacity + nPointCapacity / 2 + 1);
+        }
+
         OGRRawPoint* paoNewPoints = static_cast<OGRRawPoint *>(
             VSI_REALLOC_VERBOSE(paoPoints,
-                                sizeof(OGRRawPoint) * nNewPointCount));
+                                sizeof(OGRRawPoint) * nNewCapacity));
         if( paoNewPoints == nullptr )
         {
             return;
         }
         paoPoints = paoNewPoints;
 
-        if( bZeroizeNewContent )
-        {
-            // gcc 8.0 (dev) complains about -Wclass-memaccess since
-            // OGRRawPoint() has a constructor. So use a void* pointer.  Doing
-            // the memset() here is correct since the constructor sets to 0.  We
-            // could instead use a std::fill(), but at every other place, we
-            // treat this class as a regular POD (see above use of realloc())
-            void* dest = static_cast<void*>(paoPoints + nPointCount);
-            memset( dest,
-                    0, sizeof(OGRRawPoint) * (nNewPointCount - nPointCount) );
-        }
-
         if( flags & OGR_G_3D )
         {
             double* padfNewZ = static_cast<double *>(
-                VSI_REALLOC_VERBOSE(padfZ, sizeof(double) * nNewPointCount));
+                VSI_REALLOC_VERBOSE(padfZ, sizeof(double) * nNewCapacity));
             if( padfNewZ == nullptr )
             {
                 return;
             }
             padfZ = padfNewZ;
-            if( bZeroizeNewContent )
-                memset( padfZ + nPointCount, 0,
-                    sizeof(double) * (nNewPointCount - nPointCount) );
         }
 
         if( flags & OGR_G_MEASURED )
         {
             double* padfNewM = static_cast<double *>(
-                VSI_REALLOC_VERBOSE(padfM, sizeof(double) * nNewPointCount));
+                VSI_REALLOC_VERBOSE(padfM, sizeof(double) * nNewCapacity));
             if( padfNewM == nullptr )
             {
                 return;
             }
             padfM = padfNewM;
-            if( bZeroizeNewContent )
-                memset( padfM + nPointCount, 0,
-                    sizeof(double) * (nNewPointCount - nPointCount) );
         }
+
+        // Z and M arrays allocated later by Make3D() / AddM() are sized
+        // on the capacity, so only update it once every array has grown.
+        nPointCapacity = nNewCapacity;
+    }
+
+    if( nNewPointCount > nPointCount && bZeroizeNewContent )
+    {
+        // gcc 8.0 (dev) complains about -Wclass-memaccess since
+        // OGRRawPoint() has a constructor. So use a void* pointer.  Doing
+        // the memset() here is correct since the constructor sets to 0.  We
+        // could instead use a std::fill(), but at every other place, we
+        // treat this class as a regular POD (see above use of realloc())
+        void* dest = static_cast<void*>(paoPoints + nPointCount);
+        memset( dest,
+                0, sizeof(OGRRawPoint) * (nNewPointCount - nPointCount) );
+
+        if( (flags & OGR_G_3D) && padfZ != nullptr )
+            memset( padfZ + nPointCount, 0,
+                sizeof(double) * (nNewPointCount - nPointCount) );
+
+        if( (flags & OGR_G_MEASURED) && padfM != nullptr )
+            memset( padfM + nPointCount, 0,
+                sizeof(double) * (nNewPointCount - nPointCount) );
     }
 
     nPointCount = nNewPointCount;
@@ -1737,6 +1759,7 @@ OGRErr OGRSimpleCurve::importFromWkt( char ** ppszInput )
     pszInput = OGRWktReadPointsM( pszInput, &paoPoints, &padfZ, &padfM,
                                   &flagsFromInput,
                                   &nMaxPoints, &nPointCount );
+    nPointCapacity = nPointCount;
     if( pszInput == nullptr )
         return OGRERR_CORRUPT_DATA;
 
@@ -2595,12 +2618,21 @@ void OGRSimpleCurve::segmentize( double dfMaxLength )
     CPLFree(paoPoints);
     paoPoints = paoNewPoints;
     nPointCount = nNewPointCount;
+    nPointCapacity = nNewPointCount;
 
     if( nCoordinateDimension == 3 )
     {
         CPLFree(padfZ);
         padfZ = padfNewZ;
     }
+
+    // M values are not interpolated, but keep the array consistent with
+    // the capacity.
+    if( padfM != nullptr )
+    {
+        padfM = static_cast<double *>(
+            CPLRealloc(padfM, sizeof(double) * nNewPointCount));
+    }
 }
 
 /************************************************************************/
@@ -2817,11 +2849,17 @@ OGRLineString* OGRLineString::TransferMembersAndDestroy(
     poDst->setMeasured(poSrc->IsMeasured());
     poDst->assignSpatialReference(poSrc->getSpatialReference());
     poDst->nPointCount = poSrc->nPointCount;
+    poDst->nPointCapacity = poSrc->nPointCapacity;
     poDst->paoPoints = poSrc->paoPoints;
+    CPLFree(poDst->padfZ);
     poDst->padfZ = poSrc->padfZ;
+    CPLFree(poDst->padfM);
+    poDst->padfM = poSrc->padfM;
     poSrc->nPointCount = 0;
+    poSrc->nPointCapacity = 0;
     poSrc->paoPoints = nullptr;
     poSrc->padfZ = nullptr;
+    poSrc->padfM = nullptr;
     delete poSrc;
     return poDst;
 }
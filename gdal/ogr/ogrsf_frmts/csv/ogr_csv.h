@@ -33,6 +33,9 @@
 
 #include "ogrsf_frmts.h"
 
+#include <deque>
+#include <vector>
+
 #if defined(_MSC_VER) && _MSC_VER <= 1600 // MSVC <= 2010
 # define GDAL_OVERRIDE
 #else
@@ -51,6 +54,7 @@ typedef enum
 } OGRCSVGeometryFormat;
 
 class OGRCSVDataSource;
+class CPLWorkerThreadPool;
 
 char **OGRCSVReadParseLineL( VSILFILE *fp, char chDelimiter,
                              bool bDontHonourStrings = false,
@@ -66,6 +70,71 @@ typedef enum
 
 void OGRCSVDriverRemoveFromMap(const char *pszName, GDALDataset *poDS);
 
+size_t OGRCSVCountQuotes( const char *pszData, size_t nLen );
+
+size_t OGRCSVSkipLineBreaks( const char *pszData, size_t nSize, size_t nPos );
+
+size_t OGRCSVFindRecordStart( const char *pszData, size_t nSize, size_t nPos,
+                              bool bInString );
+
+bool OGRCSVFindRecordEnd( const char *pszData, size_t nSize, size_t nStart,
+                          bool bEOF, size_t &nRecordEnd, size_t &nNextRecord,
+                          bool &bMultiLine );
+
+void OGRCSVNormalizeLineBreaks( const char *pszRecord, size_t nLen,
+                                bool bTrimLastLineBreak,
+                                std::vector<char> &abyRecord );
+
+int OGRCSVSplitRecord( const char *pszRecord, size_t nLen, char chDelimiter,
+                       bool bMergeDelimiter, std::vector<char> &abyTokens,
+                       std::vector<size_t> &anTokenOffsets );
+
+/************************************************************************/
+/*                         OGRCSVRecordReader                           */
+/*                                                                      */
+/*      Reads CSV records out of large buffered blocks, rather than     */
+/*      line by line, and splits them into tokens without per-field     */
+/*      allocations.                                                    */
+/************************************************************************/
+
+class OGRCSVRecordReader
+{
+    VSILFILE           *fp;
+    char                chDelimiter;
+    bool                bMergeDelimiter;
+
+    std::vector<char>   abyBuffer;
+    vsi_l_offset        nBufferOffset;
+    size_t              nBufferStart;
+    size_t              nBufferEnd;
+    bool                bEOF;
+
+    std::vector<char>   abyRecord;
+    std::vector<char>   abyTokens;
+    std::vector<size_t> anTokenOffsets;
+    std::vector<char *> apszTokens;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRCSVRecordReader)
+
+  public:
+    OGRCSVRecordReader();
+
+    void                Reset( VSILFILE *fpIn, char chDelimiterIn,
+                               bool bMergeDelimiterIn );
+    void                Detach();
+    VSILFILE           *GetFile() const { return fp; }
+
+    char              **ReadRecord();
+
+    void                FillBuffer( size_t nMinAvailable );
+    const char         *GetData() const
+                            { return abyBuffer.data() + nBufferStart; }
+    size_t              GetDataSize() const
+                            { return nBufferEnd - nBufferStart; }
+    bool                IsEOF() const { return bEOF; }
+    void                Consume( size_t nBytes ) { nBufferStart += nBytes; }
+};
+
 /************************************************************************/
 /*                             OGRCSVLayer                              */
 /************************************************************************/
@@ -127,7 +196,25 @@ class OGRCSVLayer : public OGRLayer
 
     bool                bEmptyStringNull;
 
+    OGRCSVRecordReader  oRecordReader;
+    char              **papszLineTokens;
+
+    int                 nNumThreads;
+    CPLWorkerThreadPool *poThreadPool;
+    std::deque<OGRFeature *> oFeatureQueue;
+
+    bool                UseRecordReader() const
+                            { return !(chDelimiter == '\t' &&
+                                       bDontHonourStrings); }
     char              **GetNextLineTokens();
+    OGRFeature         *BuildFeature( char **papszTokens, GIntBig nFID,
+                                      bool &bWarningEmitted );
+    void                ClearFeatureQueue();
+    bool                FillFeatureQueue();
+
+    static void         CountChunkQuotesFunc( void *pData );
+    static void         FindChunkRecordsFunc( void *pData );
+    static void         BuildChunkFeaturesFunc( void *pData );
 
     static bool         Matches( const char *pszFieldName,
                                  char **papszPossibleNames );
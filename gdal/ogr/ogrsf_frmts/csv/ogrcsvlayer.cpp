@@ -49,6 +49,7 @@
 #include "cpl_error.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "ogr_core.h"
 #include "ogr_feature.h"
@@ -59,6 +60,9 @@
 
 #define DIGIT_ZERO '0'
 
+// Size of the part of a block parsed by each thread when NUM_THREADS > 1.
+static const size_t CSV_THREAD_CHUNK_SIZE = 1024 * 1024;
+
 CPL_CVSID("$Id$")
 
 /************************************************************************/
@@ -266,7 +270,10 @@ OGRCSVLayer::OGRCSVLayer( const char *pszLayerNameIn,
     bKeepSourceColumns(false),
     bKeepGeomColumns(true),
     bMergeDelimiter(false),
-    bEmptyStringNull(false)
+    bEmptyStringNull(false),
+    papszLineTokens(nullptr),
+    nNumThreads(1),
+    poThreadPool(nullptr)
 {
     poFeatureDefn = new OGRFeatureDefn(pszLayerNameIn);
     SetDescription(poFeatureDefn->GetName());
@@ -340,6 +347,13 @@ void OGRCSVLayer::BuildFeatureDefn( const char *pszNfdcGeomField,
     bEmptyStringNull =
         CPLFetchBool(papszOpenOptions, "EMPTY_STRING_AS_NULL", false);
 
+    const char *pszNumThreads =
+        CSLFetchNameValueDef(papszOpenOptions, "NUM_THREADS", "1");
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nNumThreads = CPLGetNumCPUs();
+    else
+        nNumThreads = std::max(1, std::min(128, atoi(pszNumThreads)));
+
     // If this is not a new file, read ahead to establish if it is
     // already in CRLF (DOS) mode, or just a normal unix CR mode.
     if( !bNew && bInWriteMode )
@@ -1016,6 +1030,9 @@ char **OGRCSVLayer::AutodetectFieldTypes(char **papszOpenOptions,
     // caching.
     int nBytes = atoi(CSLFetchNameValueDef(papszOpenOptions,
                                            "AUTODETECT_SIZE_LIMIT", "1000000"));
+
+    // The record reader may have buffered data past the header line.
+    oRecordReader.Detach();
     if( nBytes == 0 )
     {
         const vsi_l_offset nCurPos = VSIFTellL(fpCSV);
@@ -1335,6 +1352,10 @@ OGRCSVLayer::~OGRCSVLayer()
 
     CPLFree(panGeomFieldIndex);
 
+    ClearFeatureQueue();
+    delete poThreadPool;
+    CSLDestroy(papszLineTokens);
+
     poFeatureDefn->Release();
     CPLFree(pszFilename);
 
@@ -1352,9 +1373,18 @@ void OGRCSVLayer::ResetReading()
     if( fpCSV )
         VSIRewindL(fpCSV);
 
+    ClearFeatureQueue();
+    oRecordReader.Reset(UseRecordReader() ? fpCSV : nullptr, chDelimiter,
+                        bMergeDelimiter);
+
     if( bHasFieldNames )
-        CSLDestroy(
-            OGRCSVReadParseLineL(fpCSV, chDelimiter, bDontHonourStrings));
+    {
+        if( UseRecordReader() )
+            oRecordReader.ReadRecord();
+        else
+            CSLDestroy(
+                OGRCSVReadParseLineL(fpCSV, chDelimiter, bDontHonourStrings));
+    }
 
     bNeedRewindBeforeRead = false;
 
@@ -1363,23 +1393,40 @@ void OGRCSVLayer::ResetReading()
 
 /************************************************************************/
 /*                        GetNextLineTokens()                           */
+/*                                                                      */
+/*      Returns the tokens of the next non empty record. The list is    */
+/*      owned by the layer and valid until the next call.               */
 /************************************************************************/
 
 char **OGRCSVLayer::GetNextLineTokens()
 {
+    const bool bUseRecordReader = UseRecordReader();
+    if( !bUseRecordReader )
+        oRecordReader.Detach();
+    else if( oRecordReader.GetFile() != fpCSV )
+        oRecordReader.Reset(fpCSV, chDelimiter, bMergeDelimiter);
+
     while( true )
     {
         // Read the CSV record.
-        char **papszTokens = OGRCSVReadParseLineL(
-            fpCSV, chDelimiter, bDontHonourStrings, false, bMergeDelimiter);
+        char **papszTokens = nullptr;
+        if( bUseRecordReader )
+        {
+            papszTokens = oRecordReader.ReadRecord();
+        }
+        else
+        {
+            CSLDestroy(papszLineTokens);
+            papszLineTokens = OGRCSVReadParseLineL(
+                fpCSV, chDelimiter, bDontHonourStrings, false, bMergeDelimiter);
+            papszTokens = papszLineTokens;
+        }
 
         if( papszTokens == nullptr )
             return nullptr;
 
         if( papszTokens[0] != nullptr )
             return papszTokens;
-
-        CSLDestroy(papszTokens);
     }
 }
 
@@ -1395,10 +1442,15 @@ OGRFeature *OGRCSVLayer::GetFeature(GIntBig nFID)
         ResetReading();
     while( nNextFID < nFID )
     {
-        char **papszTokens = GetNextLineTokens();
-        if( papszTokens == nullptr )
+        if( !oFeatureQueue.empty() )
+        {
+            delete oFeatureQueue.front();
+            oFeatureQueue.pop_front();
+        }
+        else if( GetNextLineTokens() == nullptr )
+        {
             return nullptr;
-        CSLDestroy(papszTokens);
+        }
         nNextFID++;
     }
     return GetNextUnfilteredFeature();
@@ -1414,11 +1466,42 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
     if( fpCSV == nullptr )
         return nullptr;
 
-    // Read the CSV record.
-    char **papszTokens = GetNextLineTokens();
-    if( papszTokens == nullptr )
-        return nullptr;
+    if( nNumThreads > 1 && oFeatureQueue.empty() && UseRecordReader() )
+        FillFeatureQueue();
+
+    OGRFeature *poFeature = nullptr;
+    if( !oFeatureQueue.empty() )
+    {
+        poFeature = oFeatureQueue.front();
+        oFeatureQueue.pop_front();
+    }
+    else
+    {
+        // Read the CSV record.
+        char **papszTokens = GetNextLineTokens();
+        if( papszTokens == nullptr )
+            return nullptr;
+
+        poFeature =
+            BuildFeature(papszTokens, nNextFID, bWarningBadTypeOrWidth);
+    }
+
+    nNextFID++;
+    m_nFeaturesRead++;
 
+    return poFeature;
+}
+
+/************************************************************************/
+/*                            BuildFeature()                            */
+/*                                                                      */
+/*      Translate the tokens of a record into a feature. This may be    */
+/*      called from worker threads, so it must not modify the layer.   */
+/************************************************************************/
+
+OGRFeature *OGRCSVLayer::BuildFeature( char **papszTokens, GIntBig nFID,
+                                       bool &bWarningEmitted )
+{
     // Create the OGR feature.
     OGRFeature *poFeature = new OGRFeature(poFeatureDefn);
 
@@ -1503,14 +1586,15 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
                 {
                     poFeature->SetField(iOGRField, 0);
                 }
-                else if( !bWarningBadTypeOrWidth )
+                else if( !bWarningEmitted )
                 {
-                    bWarningBadTypeOrWidth = true;
+                    bWarningEmitted = true;
                     CPLError(
                         CE_Warning, CPLE_AppDefined,
-                        "Invalid value type found in record %d for field %s. "
+                        "Invalid value type found in record " CPL_FRMT_GIB
+                        " for field %s. "
                         "This warning will no longer be emitted",
-                        nNextFID, poFieldDefn->GetNameRef());
+                        nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1529,31 +1613,32 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
                 if( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
                 {
                     poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                    if( !bWarningBadTypeOrWidth &&
+                    if( !bWarningEmitted &&
                         (eFieldType == OFTInteger ||
                          eFieldType == OFTInteger64) &&
                         eType == CPL_VALUE_REAL )
                     {
-                        bWarningBadTypeOrWidth = true;
+                        bWarningEmitted = true;
                         CPLError(CE_Warning, CPLE_AppDefined,
-                                 "Invalid value type found in record %d for "
-                                 "field %s. "
+                                 "Invalid value type found in record "
+                                 CPL_FRMT_GIB " for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth &&
+                    else if( !bWarningEmitted &&
                              poFieldDefn->GetWidth() > 0 &&
                              static_cast<int>(strlen(papszTokens[iAttr])) >
                                  poFieldDefn->GetWidth() )
                     {
-                        bWarningBadTypeOrWidth = true;
+                        bWarningEmitted = true;
                         CPLError(CE_Warning, CPLE_AppDefined,
                                  "Value with a width greater than field width "
-                                 "found in record %d for field %s. "
+                                 "found in record " CPL_FRMT_GIB
+                                 " for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth &&
+                    else if( !bWarningEmitted &&
                              eType == CPL_VALUE_REAL &&
                              poFieldDefn->GetWidth() > 0)
                     {
@@ -1564,26 +1649,27 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
                                 : 0;
                         if( nPrecision > poFieldDefn->GetPrecision() )
                         {
-                            bWarningBadTypeOrWidth = true;
+                            bWarningEmitted = true;
                             CPLError(CE_Warning, CPLE_AppDefined,
                                      "Value with a precision greater than "
-                                     "field precision found in record %d for "
-                                     "field %s. "
+                                     "field precision found in record "
+                                     CPL_FRMT_GIB " for field %s. "
                                      "This warning will no longer be emitted",
-                                     nNextFID, poFieldDefn->GetNameRef());
+                                     nFID, poFieldDefn->GetNameRef());
                         }
                     }
                 }
                 else
                 {
-                    if( !bWarningBadTypeOrWidth )
+                    if( !bWarningEmitted )
                     {
-                        bWarningBadTypeOrWidth = true;
+                        bWarningEmitted = true;
                         CPLError(
                             CE_Warning, CPLE_AppDefined,
-                            "Invalid value type found in record %d for field "
+                            "Invalid value type found in record " CPL_FRMT_GIB
+                            " for field "
                             "%s. This warning will no longer be emitted.",
-                            nNextFID, poFieldDefn->GetNameRef());
+                            nFID, poFieldDefn->GetNameRef());
                     }
                 }
             }
@@ -1593,15 +1679,16 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
             if( papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored() )
             {
                 poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                if( !bWarningBadTypeOrWidth &&
+                if( !bWarningEmitted &&
                     !poFeature->IsFieldSetAndNotNull(iOGRField) )
                 {
-                    bWarningBadTypeOrWidth = true;
+                    bWarningEmitted = true;
                     CPLError(
                         CE_Warning, CPLE_AppDefined,
-                        "Invalid value type found in record %d for field %s. "
+                        "Invalid value type found in record " CPL_FRMT_GIB
+                        " for field %s. "
                         "This warning will no longer be emitted",
-                        nNextFID, poFieldDefn->GetNameRef());
+                        nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1614,16 +1701,16 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
             else
             {
                 poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+                if( !bWarningEmitted && poFieldDefn->GetWidth() > 0 &&
                     static_cast<int>(strlen(papszTokens[iAttr])) >
                         poFieldDefn->GetWidth() )
                 {
-                    bWarningBadTypeOrWidth = true;
+                    bWarningEmitted = true;
                     CPLError(CE_Warning, CPLE_AppDefined,
                              "Value with a width greater than field width "
-                             "found in record %d for field %s. "
+                             "found in record " CPL_FRMT_GIB " for field %s. "
                              "This warning will no longer be emitted",
-                             nNextFID, poFieldDefn->GetNameRef());
+                             nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1732,12 +1819,8 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
         }
     }
 
-    CSLDestroy(papszTokens);
-
     // Translate the record id.
-    poFeature->SetFID(nNextFID++);
-
-    m_nFeaturesRead++;
+    poFeature->SetFID(nFID);
 
     return poFeature;
 }
@@ -1769,6 +1852,322 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
     }
 }
 
+/************************************************************************/
+/*                          ClearFeatureQueue()                         */
+/************************************************************************/
+
+void OGRCSVLayer::ClearFeatureQueue()
+{
+    for( size_t i = 0; i < oFeatureQueue.size(); i++ )
+        delete oFeatureQueue[i];
+    oFeatureQueue.clear();
+}
+
+/************************************************************************/
+/*                           OGRCSVChunkError                           */
+/************************************************************************/
+
+struct OGRCSVChunkError
+{
+    CPLErr              eErr;
+    CPLErrorNum         nNo;
+    CPLString           osMsg;
+};
+
+/************************************************************************/
+/*                             OGRCSVChunk                              */
+/*                                                                      */
+/*      Part of a block of records processed by a worker thread.        */
+/************************************************************************/
+
+struct OGRCSVChunk
+{
+    OGRCSVLayer        *poLayer = nullptr;
+
+    // Whole block, starting on a record boundary.
+    const char         *pszData = nullptr;
+    size_t              nDataSize = 0;
+    bool                bEOF = false;
+
+    // Nominal range of the chunk. The chunk processes the records
+    // starting in ]nStart, nEnd], or in [0, nEnd] for the first one.
+    size_t              nStart = 0;
+    size_t              nEnd = 0;
+    bool                bFirst = false;
+    bool                bLast = false;
+
+    size_t              nQuotes = 0;
+    bool                bInString = false;
+
+    std::vector<char>   abyTokens{};
+    std::vector<size_t> anTokenOffsets{};
+    std::vector<int>    anTokenCount{};
+
+    // Set if the chunk ends with a record that is not terminated yet.
+    bool                bIncomplete = false;
+    size_t              nStop = 0;
+
+    GIntBig             nFirstFID = 0;
+    bool                bWarningEmitted = false;
+    std::vector<OGRFeature *> apoFeatures{};
+
+    // Errors emitted while building the features, and index of the
+    // one that set bWarningEmitted, if any.
+    std::vector<OGRCSVChunkError> aoErrors{};
+    int                 iWarningError = -1;
+};
+
+/************************************************************************/
+/*                       OGRCSVChunkErrorHandler()                      */
+/*                                                                      */
+/*      Collect the errors of a worker thread, so that they can be      */
+/*      emitted by the calling thread.                                  */
+/************************************************************************/
+
+static void CPL_STDCALL OGRCSVChunkErrorHandler( CPLErr eErr, CPLErrorNum nNo,
+                                                 const char *pszMsg )
+{
+    OGRCSVChunk *psChunk =
+        static_cast<OGRCSVChunk *>(CPLGetErrorHandlerUserData());
+    OGRCSVChunkError sError;
+    sError.eErr = eErr;
+    sError.nNo = nNo;
+    sError.osMsg = pszMsg;
+    psChunk->aoErrors.push_back(sError);
+}
+
+/************************************************************************/
+/*                        CountChunkQuotesFunc()                        */
+/************************************************************************/
+
+void OGRCSVLayer::CountChunkQuotesFunc( void *pData )
+{
+    OGRCSVChunk *psChunk = static_cast<OGRCSVChunk *>(pData);
+    psChunk->nQuotes = OGRCSVCountQuotes(psChunk->pszData + psChunk->nStart,
+                                         psChunk->nEnd - psChunk->nStart);
+}
+
+/************************************************************************/
+/*                        FindChunkRecordsFunc()                        */
+/*                                                                      */
+/*      Resynchronize on the first record starting in the chunk,        */
+/*      thanks to the quoting state at its nominal start, and split     */
+/*      its records into tokens.                                        */
+/************************************************************************/
+
+void OGRCSVLayer::FindChunkRecordsFunc( void *pData )
+{
+    OGRCSVChunk *psChunk = static_cast<OGRCSVChunk *>(pData);
+    const OGRCSVLayer *poLayer = psChunk->poLayer;
+    const char *pszData = psChunk->pszData;
+    const size_t nSize = psChunk->nDataSize;
+
+    size_t nPos = psChunk->bFirst
+        ? OGRCSVSkipLineBreaks(pszData, nSize, 0)
+        : OGRCSVFindRecordStart(pszData, nSize, psChunk->nStart,
+                                psChunk->bInString);
+
+    std::vector<char> abyRecord;
+    while( nPos < nSize && (psChunk->bLast || nPos <= psChunk->nEnd) )
+    {
+        const size_t nSkip = (nSize - nPos >= 3 &&
+                              memcmp(pszData + nPos, "\xEF\xBB\xBF", 3) == 0)
+                                 ? 3 : 0;
+        size_t nRecordEnd = 0;
+        size_t nNextRecord = 0;
+        bool bMultiLine = false;
+        if( !OGRCSVFindRecordEnd(pszData, nSize, nPos + nSkip, psChunk->bEOF,
+                                 nRecordEnd, nNextRecord, bMultiLine) )
+        {
+            psChunk->bIncomplete = true;
+            break;
+        }
+
+        const char *pszRecord = pszData + nPos + nSkip;
+        size_t nLen = nRecordEnd - nPos - nSkip;
+        if( bMultiLine )
+        {
+            OGRCSVNormalizeLineBreaks(pszRecord, nLen,
+                                      nNextRecord == nRecordEnd, abyRecord);
+            pszRecord = abyRecord.data();
+            nLen = abyRecord.size();
+        }
+
+        const int nTokens = OGRCSVSplitRecord(
+            pszRecord, nLen, poLayer->chDelimiter, poLayer->bMergeDelimiter,
+            psChunk->abyTokens, psChunk->anTokenOffsets);
+        if( nTokens > 0 )
+            psChunk->anTokenCount.push_back(nTokens);
+
+        nPos = OGRCSVSkipLineBreaks(pszData, nSize, nNextRecord);
+    }
+    psChunk->nStop = nPos;
+}
+
+/************************************************************************/
+/*                       BuildChunkFeaturesFunc()                       */
+/************************************************************************/
+
+void OGRCSVLayer::BuildChunkFeaturesFunc( void *pData )
+{
+    OGRCSVChunk *psChunk = static_cast<OGRCSVChunk *>(pData);
+
+    CPLPushErrorHandlerEx(OGRCSVChunkErrorHandler, psChunk);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+
+    std::vector<char *> apszTokens;
+    size_t iToken = 0;
+    psChunk->apoFeatures.reserve(psChunk->anTokenCount.size());
+    for( size_t iRecord = 0; iRecord < psChunk->anTokenCount.size();
+         iRecord++ )
+    {
+        const int nTokens = psChunk->anTokenCount[iRecord];
+        apszTokens.resize(nTokens + 1);
+        for( int i = 0; i < nTokens; i++ )
+        {
+            apszTokens[i] = psChunk->abyTokens.data() +
+                            psChunk->anTokenOffsets[iToken + i];
+        }
+        apszTokens[nTokens] = nullptr;
+        iToken += nTokens;
+
+        const bool bWarningEmittedBefore = psChunk->bWarningEmitted;
+        const size_t nErrorsBefore = psChunk->aoErrors.size();
+        psChunk->apoFeatures.push_back(psChunk->poLayer->BuildFeature(
+            apszTokens.data(), psChunk->nFirstFID + iRecord,
+            psChunk->bWarningEmitted));
+        if( !bWarningEmittedBefore && psChunk->bWarningEmitted &&
+            nErrorsBefore < psChunk->aoErrors.size() )
+        {
+            psChunk->iWarningError = static_cast<int>(nErrorsBefore);
+        }
+    }
+
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                          FillFeatureQueue()                          */
+/*                                                                      */
+/*      Read a block of records, and parse it with nNumThreads worker   */
+/*      threads. The block is cut into chunks of the same size, and     */
+/*      each worker resynchronizes on the first record starting in      */
+/*      its chunk, using the parity of the number of double quotes      */
+/*      found before it. Features are queued in file order.             */
+/************************************************************************/
+
+bool OGRCSVLayer::FillFeatureQueue()
+{
+    if( oRecordReader.GetFile() != fpCSV )
+        oRecordReader.Reset(fpCSV, chDelimiter, bMergeDelimiter);
+
+    if( poThreadPool == nullptr )
+    {
+        poThreadPool = new CPLWorkerThreadPool();
+        if( !poThreadPool->Setup(nNumThreads, nullptr, nullptr) )
+        {
+            delete poThreadPool;
+            poThreadPool = nullptr;
+            nNumThreads = 1;
+            return false;
+        }
+    }
+
+    const int nThreads = poThreadPool->GetThreadCount();
+    size_t nBlockSize = static_cast<size_t>(nThreads) * CSV_THREAD_CHUNK_SIZE;
+
+    while( oFeatureQueue.empty() )
+    {
+        oRecordReader.FillBuffer(nBlockSize);
+        const char *pszData = oRecordReader.GetData();
+        const size_t nSize = oRecordReader.GetDataSize();
+        const bool bEOF = oRecordReader.IsEOF();
+        if( nSize == 0 )
+            return false;
+
+        std::vector<OGRCSVChunk> asChunks(nThreads);
+        std::vector<void *> apData;
+        for( int i = 0; i < nThreads; i++ )
+        {
+            OGRCSVChunk &sChunk = asChunks[i];
+            sChunk.poLayer = this;
+            sChunk.pszData = pszData;
+            sChunk.nDataSize = nSize;
+            sChunk.bEOF = bEOF;
+            sChunk.nStart = nSize / nThreads * i;
+            sChunk.bFirst = i == 0;
+            sChunk.bLast = i == nThreads - 1;
+            sChunk.nEnd = sChunk.bLast ? nSize : nSize / nThreads * (i + 1);
+            apData.push_back(&sChunk);
+        }
+
+        // Quoting state at the nominal start of each chunk.
+        poThreadPool->SubmitJobs(CountChunkQuotesFunc, apData);
+        poThreadPool->WaitCompletion();
+        bool bInString = false;
+        for( int i = 0; i < nThreads; i++ )
+        {
+            asChunks[i].bInString = bInString;
+            if( (asChunks[i].nQuotes % 2) != 0 )
+                bInString = !bInString;
+        }
+
+        poThreadPool->SubmitJobs(FindChunkRecordsFunc, apData);
+        poThreadPool->WaitCompletion();
+
+        size_t nConsumed = nSize;
+        for( int i = 0; i < nThreads; i++ )
+        {
+            if( asChunks[i].bIncomplete )
+            {
+                nConsumed = asChunks[i].nStop;
+                break;
+            }
+        }
+        if( nConsumed == 0 )
+        {
+            // A single record does not fit in the block.
+            nBlockSize = 2 * nSize;
+            continue;
+        }
+
+        GIntBig nFID = nNextFID;
+        for( int i = 0; i < nThreads; i++ )
+        {
+            asChunks[i].nFirstFID = nFID;
+            asChunks[i].bWarningEmitted = bWarningBadTypeOrWidth;
+            nFID += static_cast<GIntBig>(asChunks[i].anTokenCount.size());
+        }
+
+        poThreadPool->SubmitJobs(BuildChunkFeaturesFunc, apData);
+        poThreadPool->WaitCompletion();
+
+        // Emit the errors of the workers in file order. The invalid value
+        // warning, that each chunk may have emitted, is only kept once.
+        for( int i = 0; i < nThreads; i++ )
+        {
+            oFeatureQueue.insert(oFeatureQueue.end(),
+                                 asChunks[i].apoFeatures.begin(),
+                                 asChunks[i].apoFeatures.end());
+            const std::vector<OGRCSVChunkError> &aoErrors =
+                asChunks[i].aoErrors;
+            for( int j = 0; j < static_cast<int>(aoErrors.size()); j++ )
+            {
+                if( j == asChunks[i].iWarningError && bWarningBadTypeOrWidth )
+                    continue;
+                CPLError(aoErrors[j].eErr, aoErrors[j].nNo, "%s",
+                         aoErrors[j].osMsg.c_str());
+            }
+            if( asChunks[i].bWarningEmitted )
+                bWarningBadTypeOrWidth = true;
+        }
+
+        oRecordReader.Consume(nConsumed);
+    }
+
+    return true;
+}
+
 /************************************************************************/
 /*                           TestCapability()                           */
 /************************************************************************/
@@ -2521,8 +2920,6 @@ GIntBig OGRCSVLayer::GetFeatureCount( int bForce )
                 break;
 
             nTotalFeatures++;
-
-            CSLDestroy(papszTokens);
         }
     }
 
@@ -0,0 +1,464 @@
+/******************************************************************************
+ *
+ * Project:  CSV Translator
+ * Purpose:  Implements OGRCSVRecordReader class, and the record scanning
+ *           and tokenizing helpers shared with multi-threaded reading.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+/*
+ * The record reader gives the same results as OGRCSVReadParseLineL(), that is
+ * CPLReadLineL() followed by CSVSplitLine():
+ *
+ *  - "\r\n", "\n\r", "\n" and "\r" are all line terminators,
+ *  - a line terminator only ends the record when the number of double quotes
+ *    seen since the start of the record is even. Otherwise it is part of a
+ *    quoted value and is returned as a single "\n",
+ *  - a UTF-8 BOM at the start of a record is skipped.
+ *
+ * The scanning only looks for line terminators and double quotes, with
+ * memchr(), so that the C library can use its vectorized implementation on
+ * the large blocks read from the file.
+ */
+
+#include "cpl_port.h"
+#include "ogr_csv.h"
+
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_vsi.h"
+
+CPL_CVSID("$Id$")
+
+static const size_t CSV_READ_CHUNK_SIZE = 65536;
+
+/************************************************************************/
+/*                           CSVFindEOL()                               */
+/************************************************************************/
+
+static const char *CSVFindEOL( const char *pszData, size_t nLen )
+{
+    const char *pszLF =
+        static_cast<const char *>(memchr(pszData, '\n', nLen));
+    const char *pszCR = static_cast<const char *>(
+        memchr(pszData, '\r', pszLF ? static_cast<size_t>(pszLF - pszData)
+                                    : nLen));
+    return pszCR ? pszCR : pszLF;
+}
+
+/************************************************************************/
+/*                         OGRCSVCountQuotes()                          */
+/************************************************************************/
+
+size_t OGRCSVCountQuotes( const char *pszData, size_t nLen )
+{
+    size_t nCount = 0;
+    const char *pszEnd = pszData + nLen;
+    while( pszData < pszEnd )
+    {
+        pszData = static_cast<const char *>(
+            memchr(pszData, '"', static_cast<size_t>(pszEnd - pszData)));
+        if( pszData == nullptr )
+            break;
+        nCount++;
+        pszData++;
+    }
+    return nCount;
+}
+
+/************************************************************************/
+/*                        OGRCSVFindRecordEnd()                         */
+/*                                                                      */
+/*      Find the end of the record starting at pszData[nStart].         */
+/*      nRecordEnd is set to the offset of its line terminator, and     */
+/*      nNextRecord just after it. Returns false if more data is        */
+/*      needed to find the end of the record.                           */
+/************************************************************************/
+
+bool OGRCSVFindRecordEnd( const char *pszData, size_t nSize, size_t nStart,
+                          bool bEOF, size_t &nRecordEnd, size_t &nNextRecord,
+                          bool &bMultiLine )
+{
+    bool bInString = false;
+    size_t nPos = nStart;
+    bMultiLine = false;
+
+    while( true )
+    {
+        const char *pszEOL = CSVFindEOL(pszData + nPos, nSize - nPos);
+        const size_t nEOL =
+            pszEOL ? static_cast<size_t>(pszEOL - pszData) : nSize;
+        if( (OGRCSVCountQuotes(pszData + nPos, nEOL - nPos) % 2) != 0 )
+            bInString = !bInString;
+
+        if( pszEOL == nullptr )
+        {
+            if( !bEOF )
+                return false;
+            nRecordEnd = nSize;
+            nNextRecord = nSize;
+            return true;
+        }
+
+        // We need the next character to know if this is a two character
+        // line terminator.
+        size_t nTermLen = 1;
+        if( nEOL + 1 < nSize )
+        {
+            const char chNext = pszData[nEOL + 1];
+            if( (chNext == '\r' || chNext == '\n') && chNext != *pszEOL )
+                nTermLen = 2;
+        }
+        else if( !bEOF )
+        {
+            return false;
+        }
+
+        if( !bInString )
+        {
+            nRecordEnd = nEOL;
+            nNextRecord = nEOL + nTermLen;
+            return true;
+        }
+
+        bMultiLine = true;
+        nPos = nEOL + nTermLen;
+    }
+}
+
+/************************************************************************/
+/*                       OGRCSVSkipLineBreaks()                         */
+/*                                                                      */
+/*      Skip the line terminators, and thus the empty records,         */
+/*      starting at nPos.                                               */
+/************************************************************************/
+
+size_t OGRCSVSkipLineBreaks( const char *pszData, size_t nSize, size_t nPos )
+{
+    while( nPos < nSize && (pszData[nPos] == '\r' || pszData[nPos] == '\n') )
+        nPos++;
+    return nPos;
+}
+
+/************************************************************************/
+/*                       OGRCSVFindRecordStart()                        */
+/*                                                                      */
+/*      Returns the offset of the first non empty record starting      */
+/*      strictly after nPos, knowing whether nPos is inside a quoted    */
+/*      value, or nSize if there is none.                               */
+/************************************************************************/
+
+size_t OGRCSVFindRecordStart( const char *pszData, size_t nSize, size_t nPos,
+                              bool bInString )
+{
+    while( nPos < nSize )
+    {
+        const char *pszEOL = CSVFindEOL(pszData + nPos, nSize - nPos);
+        if( pszEOL == nullptr )
+            break;
+        const size_t nEOL = static_cast<size_t>(pszEOL - pszData);
+        if( (OGRCSVCountQuotes(pszData + nPos, nEOL - nPos) % 2) != 0 )
+            bInString = !bInString;
+        nPos = nEOL + 1;
+        if( !bInString )
+            return OGRCSVSkipLineBreaks(pszData, nSize, nPos);
+    }
+    return nSize;
+}
+
+/************************************************************************/
+/*                     OGRCSVNormalizeLineBreaks()                      */
+/*                                                                      */
+/*      Copy a record spanning several lines, replacing each line       */
+/*      terminator by a single "\n". A record ended by the end of       */
+/*      file does not get the "\n" of its last line.                    */
+/************************************************************************/
+
+void OGRCSVNormalizeLineBreaks( const char *pszRecord, size_t nLen,
+                                bool bTrimLastLineBreak,
+                                std::vector<char> &abyRecord )
+{
+    abyRecord.clear();
+    abyRecord.reserve(nLen);
+    for( size_t i = 0; i < nLen; i++ )
+    {
+        const char ch = pszRecord[i];
+        if( ch == '\r' || ch == '\n' )
+        {
+            if( i + 1 < nLen && pszRecord[i + 1] != ch &&
+                (pszRecord[i + 1] == '\r' || pszRecord[i + 1] == '\n') )
+            {
+                i++;
+            }
+            abyRecord.push_back('\n');
+        }
+        else
+        {
+            abyRecord.push_back(ch);
+        }
+    }
+    if( bTrimLastLineBreak && nLen > 0 &&
+        (pszRecord[nLen - 1] == '\r' || pszRecord[nLen - 1] == '\n') )
+    {
+        abyRecord.pop_back();
+    }
+}
+
+/************************************************************************/
+/*                         OGRCSVSplitRecord()                          */
+/*                                                                      */
+/*      Same as CSVSplitLine(), but appends the nul terminated tokens   */
+/*      to abyTokens and their offsets to anTokenOffsets. Returns the   */
+/*      number of tokens.                                               */
+/************************************************************************/
+
+int OGRCSVSplitRecord( const char *pszRecord, size_t nLen, char chDelimiter,
+                       bool bMergeDelimiter, std::vector<char> &abyTokens,
+                       std::vector<size_t> &anTokenOffsets )
+{
+    // CSVSplitLine() works on a nul terminated string.
+    if( nLen == 0 )
+        return 0;
+    const char *pszNul = static_cast<const char *>(memchr(pszRecord, 0, nLen));
+    if( pszNul != nullptr )
+        nLen = static_cast<size_t>(pszNul - pszRecord);
+
+    const char *pszIter = pszRecord;
+    const char *pszEnd = pszRecord + nLen;
+    int nTokens = 0;
+
+    while( pszIter < pszEnd )
+    {
+        anTokenOffsets.push_back(abyTokens.size());
+
+        // Fast path for unquoted tokens: copy up to the next delimiter.
+        const char *pszDelim = static_cast<const char *>(memchr(
+            pszIter, chDelimiter, static_cast<size_t>(pszEnd - pszIter)));
+        const char *pszTokenEnd = pszDelim ? pszDelim : pszEnd;
+        if( memchr(pszIter, '"',
+                   static_cast<size_t>(pszTokenEnd - pszIter)) == nullptr )
+        {
+            abyTokens.insert(abyTokens.end(), pszIter, pszTokenEnd);
+            pszIter = pszTokenEnd;
+            if( pszIter < pszEnd )
+            {
+                pszIter++;
+                if( bMergeDelimiter )
+                {
+                    while( pszIter < pszEnd && *pszIter == chDelimiter )
+                        pszIter++;
+                }
+            }
+        }
+        else
+        {
+            bool bInString = false;
+            for( ; pszIter < pszEnd; pszIter++ )
+            {
+                if( !bInString && *pszIter == chDelimiter )
+                {
+                    pszIter++;
+                    if( bMergeDelimiter )
+                    {
+                        while( pszIter < pszEnd && *pszIter == chDelimiter )
+                            pszIter++;
+                    }
+                    break;
+                }
+
+                if( *pszIter == '"' )
+                {
+                    if( !bInString || pszIter + 1 == pszEnd ||
+                        pszIter[1] != '"' )
+                    {
+                        bInString = !bInString;
+                        continue;
+                    }
+                    // Doubled quotes in string resolve to one quote.
+                    pszIter++;
+                }
+
+                abyTokens.push_back(*pszIter);
+            }
+        }
+
+        abyTokens.push_back('\0');
+        nTokens++;
+
+        // Trailing delimiter: add the last, empty, token.
+        if( pszIter == pszEnd && pszIter[-1] == chDelimiter )
+        {
+            anTokenOffsets.push_back(abyTokens.size());
+            abyTokens.push_back('\0');
+            nTokens++;
+        }
+    }
+
+    return nTokens;
+}
+
+/************************************************************************/
+/*                         OGRCSVRecordReader()                         */
+/************************************************************************/
+
+OGRCSVRecordReader::OGRCSVRecordReader() :
+    fp(nullptr),
+    chDelimiter(','),
+    bMergeDelimiter(false),
+    nBufferOffset(0),
+    nBufferStart(0),
+    nBufferEnd(0),
+    bEOF(false)
+{}
+
+/************************************************************************/
+/*                               Reset()                                */
+/*                                                                      */
+/*      Start reading from the current position of fpIn.               */
+/************************************************************************/
+
+void OGRCSVRecordReader::Reset( VSILFILE *fpIn, char chDelimiterIn,
+                                bool bMergeDelimiterIn )
+{
+    fp = fpIn;
+    chDelimiter = chDelimiterIn;
+    bMergeDelimiter = bMergeDelimiterIn;
+    nBufferOffset = fp ? VSIFTellL(fp) : 0;
+    nBufferStart = 0;
+    nBufferEnd = 0;
+    bEOF = fp == nullptr;
+}
+
+/************************************************************************/
+/*                               Detach()                               */
+/*                                                                      */
+/*      Seek the file back to the start of the first unread record,     */
+/*      so that it can be read directly, and forget about it.           */
+/************************************************************************/
+
+void OGRCSVRecordReader::Detach()
+{
+    if( fp != nullptr )
+    {
+        CPL_IGNORE_RET_VAL(
+            VSIFSeekL(fp, nBufferOffset + nBufferStart, SEEK_SET));
+    }
+    Reset(nullptr, chDelimiter, bMergeDelimiter);
+}
+
+/************************************************************************/
+/*                             FillBuffer()                             */
+/*                                                                      */
+/*      Make sure that at least nMinAvailable bytes following the       */
+/*      current position are buffered, unless the end of file is       */
+/*      reached.                                                        */
+/************************************************************************/
+
+void OGRCSVRecordReader::FillBuffer( size_t nMinAvailable )
+{
+    if( bEOF || nBufferEnd - nBufferStart >= nMinAvailable )
+        return;
+
+    if( nBufferStart > 0 )
+    {
+        memmove(abyBuffer.data(), abyBuffer.data() + nBufferStart,
+                nBufferEnd - nBufferStart);
+        nBufferOffset += nBufferStart;
+        nBufferEnd -= nBufferStart;
+        nBufferStart = 0;
+    }
+
+    if( abyBuffer.size() < nMinAvailable ||
+        abyBuffer.size() < CSV_READ_CHUNK_SIZE )
+    {
+        abyBuffer.resize(std::max(std::max(nMinAvailable, CSV_READ_CHUNK_SIZE),
+                                  2 * abyBuffer.size()));
+    }
+
+    const size_t nToRead = abyBuffer.size() - nBufferEnd;
+    const size_t nRead =
+        VSIFReadL(abyBuffer.data() + nBufferEnd, 1, nToRead, fp);
+    nBufferEnd += nRead;
+    if( nRead < nToRead )
+        bEOF = true;
+}
+
+/************************************************************************/
+/*                             ReadRecord()                             */
+/*                                                                      */
+/*      Returns the tokens of the next record, or NULL at end of        */
+/*      file. The list is owned by the reader and valid until the      */
+/*      next call.                                                      */
+/************************************************************************/
+
+char **OGRCSVRecordReader::ReadRecord()
+{
+    size_t nSkip = 0;
+    size_t nRecordEnd = 0;
+    size_t nNextRecord = 0;
+    bool bMultiLine = false;
+
+    while( true )
+    {
+        FillBuffer(3);
+        if( nBufferStart == nBufferEnd )
+            return nullptr;
+
+        const char *pszData = GetData();
+        const size_t nSize = GetDataSize();
+        nSkip = (nSize >= 3 && memcmp(pszData, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+        if( OGRCSVFindRecordEnd(pszData, nSize, nSkip, bEOF,
+                                nRecordEnd, nNextRecord, bMultiLine) )
+        {
+            break;
+        }
+        FillBuffer(nSize + 1);
+    }
+
+    const char *pszRecord = GetData() + nSkip;
+    size_t nLen = nRecordEnd - nSkip;
+    if( bMultiLine )
+    {
+        OGRCSVNormalizeLineBreaks(pszRecord, nLen, nNextRecord == nRecordEnd,
+                                  abyRecord);
+        pszRecord = abyRecord.data();
+        nLen = abyRecord.size();
+    }
+
+    abyTokens.clear();
+    anTokenOffsets.clear();
+    const int nTokens = OGRCSVSplitRecord(pszRecord, nLen, chDelimiter,
+                                          bMergeDelimiter, abyTokens,
+                                          anTokenOffsets);
+    Consume(nNextRecord);
+
+    apszTokens.resize(nTokens + 1);
+    for( int i = 0; i < nTokens; i++ )
+        apszTokens[i] = abyTokens.data() + anTokenOffsets[i];
+    apszTokens[nTokens] = nullptr;
+
+    return apszTokens.data();
+}
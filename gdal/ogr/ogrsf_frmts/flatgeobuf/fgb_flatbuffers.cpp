@@ -0,0 +1,457 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Minimal reader and writer of FlatBuffers tables, as used by the
+ *           FlatGeobuf header and features.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "fgb_flatbuffers.h"
+
+#include <algorithm>
+#include <cstring>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                          Little endian helpers                       */
+/************************************************************************/
+
+static void WriteUInt16( GByte* pabyDst, GUInt16 nVal )
+{
+    CPL_LSBPTR16(&nVal);
+    memcpy(pabyDst, &nVal, sizeof(nVal));
+}
+
+static void WriteUInt32( GByte* pabyDst, GUInt32 nVal )
+{
+    CPL_LSBPTR32(&nVal);
+    memcpy(pabyDst, &nVal, sizeof(nVal));
+}
+
+static GUInt16 ReadUInt16( const GByte* pabySrc )
+{
+    GUInt16 nVal;
+    memcpy(&nVal, pabySrc, sizeof(nVal));
+    CPL_LSBPTR16(&nVal);
+    return nVal;
+}
+
+static GUInt32 ReadUInt32( const GByte* pabySrc )
+{
+    GUInt32 nVal;
+    memcpy(&nVal, pabySrc, sizeof(nVal));
+    CPL_LSBPTR32(&nVal);
+    return nVal;
+}
+
+static size_t AlignUp( size_t nPos, size_t nAlign )
+{
+    return (nPos + nAlign - 1) / nAlign * nAlign;
+}
+
+/************************************************************************/
+/*                           FGBCreateString()                          */
+/************************************************************************/
+
+FGBBlob FGBCreateString( const GByte* pabyData, size_t nSize )
+{
+    FGBBlob oBlob;
+    oBlob.abyData.assign(sizeof(GUInt32) + nSize + 1, 0);
+    GByte* pabyDst = oBlob.abyData.data();
+    WriteUInt32(pabyDst, static_cast<GUInt32>(nSize));
+    if( nSize )
+        memcpy(pabyDst + sizeof(GUInt32), pabyData, nSize);
+    return oBlob;
+}
+
+FGBBlob FGBCreateString( const char* pszStr )
+{
+    return FGBCreateString(reinterpret_cast<const GByte*>(pszStr),
+                           strlen(pszStr));
+}
+
+/************************************************************************/
+/*                           FGBCreateVector()                          */
+/************************************************************************/
+
+FGBBlob FGBCreateVector( const void* pData, size_t nCount, size_t nEltSize )
+{
+    // Elements of 8 bytes must be 8-byte aligned, so the count is preceded
+    // by 4 bytes of padding in that case.
+    const size_t nStart = nEltSize == 8 ? sizeof(GUInt32) : 0;
+    FGBBlob oBlob;
+    oBlob.nObjectOffset = nStart;
+    oBlob.abyData.resize(nStart + sizeof(GUInt32) + nCount * nEltSize);
+    WriteUInt32(&oBlob.abyData[nStart], static_cast<GUInt32>(nCount));
+    GByte* pabyDst = &oBlob.abyData[nStart + sizeof(GUInt32)];
+    if( nCount )
+        memcpy(pabyDst, pData, nCount * nEltSize);
+#ifdef CPL_MSB
+    for( size_t i = 0; i < nCount; i++ )
+    {
+        if( nEltSize == 2 )
+            CPL_SWAP16PTR(pabyDst + i * nEltSize);
+        else if( nEltSize == 4 )
+            CPL_SWAP32PTR(pabyDst + i * nEltSize);
+        else if( nEltSize == 8 )
+            CPL_SWAP64PTR(pabyDst + i * nEltSize);
+    }
+#endif
+    return oBlob;
+}
+
+/************************************************************************/
+/*                        FGBCreateTableVector()                        */
+/************************************************************************/
+
+FGBBlob FGBCreateTableVector( const std::vector<FGBBlob>& aoTables )
+{
+    FGBBlob oBlob;
+    const size_t nHeaderSize = sizeof(GUInt32) * (1 + aoTables.size());
+    oBlob.abyData.resize(nHeaderSize);
+    WriteUInt32(&oBlob.abyData[0], static_cast<GUInt32>(aoTables.size()));
+    for( size_t i = 0; i < aoTables.size(); i++ )
+    {
+        const size_t nPos = AlignUp(oBlob.abyData.size(), 8);
+        const size_t nRefPos = sizeof(GUInt32) * (1 + i);
+        oBlob.abyData.resize(nPos);
+        oBlob.abyData.insert(oBlob.abyData.end(),
+                             aoTables[i].abyData.begin(),
+                             aoTables[i].abyData.end());
+        WriteUInt32(&oBlob.abyData[nRefPos], static_cast<GUInt32>(
+            nPos + aoTables[i].nObjectOffset - nRefPos));
+    }
+    return oBlob;
+}
+
+/************************************************************************/
+/*                       FGBTableWriter::AddXXXX()                      */
+/************************************************************************/
+
+void FGBTableWriter::AddScalar( int iField, const void* pValue, size_t nSize )
+{
+    Field sField;
+    sField.iField = iField;
+    sField.nSize = nSize;
+    memcpy(sField.abyValue, pValue, nSize);
+    sField.iChild = -1;
+    m_aoFields.push_back(sField);
+}
+
+void FGBTableWriter::AddUInt8( int iField, GByte nVal )
+{
+    AddScalar(iField, &nVal, sizeof(nVal));
+}
+
+void FGBTableWriter::AddUInt16( int iField, GUInt16 nVal )
+{
+    CPL_LSBPTR16(&nVal);
+    AddScalar(iField, &nVal, sizeof(nVal));
+}
+
+void FGBTableWriter::AddInt32( int iField, GInt32 nVal )
+{
+    CPL_LSBPTR32(&nVal);
+    AddScalar(iField, &nVal, sizeof(nVal));
+}
+
+void FGBTableWriter::AddUInt64( int iField, GUIntBig nVal )
+{
+    CPL_LSBPTR64(&nVal);
+    AddScalar(iField, &nVal, sizeof(nVal));
+}
+
+void FGBTableWriter::AddChild( int iField, FGBBlob&& oBlob )
+{
+    Field sField;
+    sField.iField = iField;
+    sField.nSize = sizeof(GUInt32);
+    sField.iChild = static_cast<int>(m_aoChildren.size());
+    m_aoFields.push_back(sField);
+    m_aoChildren.emplace_back(std::move(oBlob));
+}
+
+/************************************************************************/
+/*                       FGBTableWriter::Finish()                       */
+/************************************************************************/
+
+FGBBlob FGBTableWriter::Finish()
+{
+    int nMaxField = -1;
+    for( const auto& sField: m_aoFields )
+        nMaxField = std::max(nMaxField, sField.iField);
+
+    // Largest fields first, so that each one is naturally aligned given
+    // that the first field starts on a 8 byte boundary.
+    std::stable_sort(m_aoFields.begin(), m_aoFields.end(),
+                     [](const Field& a, const Field& b)
+                     { return a.nSize > b.nSize; });
+
+    const size_t nVTableSize = sizeof(GUInt16) * (2 + nMaxField + 1);
+    // The table starts with its 4 byte offset to the vtable, and its first
+    // field must be 8-byte aligned.
+    const size_t nTablePos = AlignUp(nVTableSize, 8) + 4;
+
+    FGBBlob oBlob;
+    oBlob.nObjectOffset = nTablePos;
+    std::vector<GByte>& abyData = oBlob.abyData;
+    size_t nTableSize = sizeof(GInt32);
+    for( const auto& sField: m_aoFields )
+        nTableSize += sField.nSize;
+    abyData.resize(nTablePos + nTableSize);
+
+    WriteUInt16(&abyData[0], static_cast<GUInt16>(nVTableSize));
+    WriteUInt16(&abyData[2], static_cast<GUInt16>(nTableSize));
+    WriteUInt32(&abyData[nTablePos], static_cast<GUInt32>(nTablePos));
+
+    std::vector<std::pair<size_t, int>> aoRefs;
+    size_t nFieldPos = nTablePos + sizeof(GInt32);
+    for( const auto& sField: m_aoFields )
+    {
+        WriteUInt16(&abyData[4 + 2 * sField.iField],
+                    static_cast<GUInt16>(nFieldPos - nTablePos));
+        if( sField.iChild >= 0 )
+            aoRefs.emplace_back(nFieldPos, sField.iChild);
+        else
+            memcpy(&abyData[nFieldPos], sField.abyValue, sField.nSize);
+        nFieldPos += sField.nSize;
+    }
+
+    for( const auto& oRef: aoRefs )
+    {
+        const FGBBlob& oChild = m_aoChildren[oRef.second];
+        const size_t nPos = AlignUp(abyData.size(), 8);
+        abyData.resize(nPos);
+        abyData.insert(abyData.end(),
+                       oChild.abyData.begin(), oChild.abyData.end());
+        WriteUInt32(&abyData[oRef.first], static_cast<GUInt32>(
+            nPos + oChild.nObjectOffset - oRef.first));
+    }
+
+    m_aoFields.clear();
+    m_aoChildren.clear();
+    return oBlob;
+}
+
+/************************************************************************/
+/*                        FGBFinishSizePrefixed()                       */
+/************************************************************************/
+
+std::vector<GByte> FGBFinishSizePrefixed( const FGBBlob& oRoot )
+{
+    // Size prefix, root offset, padding to have the root blob at a 8 byte
+    // boundary of the flatbuffer.
+    const size_t nRootBlobPos = 8;
+    std::vector<GByte> abyBuffer(sizeof(GUInt32) + nRootBlobPos);
+    abyBuffer.insert(abyBuffer.end(),
+                     oRoot.abyData.begin(), oRoot.abyData.end());
+    WriteUInt32(&abyBuffer[0],
+                static_cast<GUInt32>(abyBuffer.size() - sizeof(GUInt32)));
+    WriteUInt32(&abyBuffer[sizeof(GUInt32)],
+                static_cast<GUInt32>(nRootBlobPos + oRoot.nObjectOffset));
+    return abyBuffer;
+}
+
+/************************************************************************/
+/*                     FGBTableReader::InitFromRoot()                   */
+/************************************************************************/
+
+bool FGBTableReader::InitFromRoot( const GByte* pabyBuf, size_t nBufSize )
+{
+    if( nBufSize < sizeof(GUInt32) )
+        return false;
+    return Init(pabyBuf, nBufSize, ReadUInt32(pabyBuf));
+}
+
+/************************************************************************/
+/*                         FGBTableReader::Init()                       */
+/************************************************************************/
+
+bool FGBTableReader::Init( const GByte* pabyBuf, size_t nBufSize,
+                           size_t nTablePos )
+{
+    m_pabyBuf = nullptr;
+    if( nTablePos < sizeof(GUInt32) || nTablePos > nBufSize ||
+        nBufSize - nTablePos < sizeof(GInt32) )
+        return false;
+    const GIntBig nVTablePos =
+        static_cast<GIntBig>(nTablePos) -
+        static_cast<GInt32>(ReadUInt32(pabyBuf + nTablePos));
+    if( nVTablePos < 0 ||
+        static_cast<GUIntBig>(nVTablePos) + 2 * sizeof(GUInt16) > nBufSize )
+        return false;
+    const size_t nVTableSize = ReadUInt16(pabyBuf + nVTablePos);
+    if( nVTableSize < 2 * sizeof(GUInt16) ||
+        static_cast<size_t>(nVTablePos) + nVTableSize > nBufSize )
+        return false;
+    const size_t nTableSize =
+        ReadUInt16(pabyBuf + nVTablePos + sizeof(GUInt16));
+    if( nTableSize > nBufSize - nTablePos )
+        return false;
+
+    m_pabyBuf = pabyBuf;
+    m_nBufSize = nBufSize;
+    m_nTablePos = nTablePos;
+    m_nVTablePos = static_cast<size_t>(nVTablePos);
+    m_nVTableSize = nVTableSize;
+    return true;
+}
+
+/************************************************************************/
+/*                      FGBTableReader::GetFieldPos()                   */
+/************************************************************************/
+
+// Returns 0 if the field is absent or does not fit in the buffer.
+size_t FGBTableReader::GetFieldPos( int iField, size_t nSize ) const
+{
+    if( m_pabyBuf == nullptr )
+        return 0;
+    const size_t nEntryPos = sizeof(GUInt16) * (2 + iField);
+    if( nEntryPos + sizeof(GUInt16) > m_nVTableSize )
+        return 0;
+    const size_t nOffset = ReadUInt16(m_pabyBuf + m_nVTablePos + nEntryPos);
+    if( nOffset == 0 || m_nTablePos + nOffset + nSize > m_nBufSize )
+        return 0;
+    return m_nTablePos + nOffset;
+}
+
+/************************************************************************/
+/*                     FGBTableReader::GetReference()                   */
+/************************************************************************/
+
+bool FGBTableReader::GetReference( int iField, size_t& nPos ) const
+{
+    const size_t nFieldPos = GetFieldPos(iField, sizeof(GUInt32));
+    if( nFieldPos == 0 )
+        return false;
+    const GUInt32 nOffset = ReadUInt32(m_pabyBuf + nFieldPos);
+    if( nOffset >= m_nBufSize - nFieldPos )
+        return false;
+    nPos = nFieldPos + nOffset;
+    return true;
+}
+
+/************************************************************************/
+/*                       FGBTableReader::GetXXXX()                      */
+/************************************************************************/
+
+bool FGBTableReader::HasField( int iField ) const
+{
+    return GetFieldPos(iField, 0) != 0;
+}
+
+GByte FGBTableReader::GetUInt8( int iField, GByte nDefault ) const
+{
+    const size_t nPos = GetFieldPos(iField, sizeof(GByte));
+    return nPos ? m_pabyBuf[nPos] : nDefault;
+}
+
+GUInt16 FGBTableReader::GetUInt16( int iField, GUInt16 nDefault ) const
+{
+    const size_t nPos = GetFieldPos(iField, sizeof(GUInt16));
+    return nPos ? ReadUInt16(m_pabyBuf + nPos) : nDefault;
+}
+
+GInt32 FGBTableReader::GetInt32( int iField, GInt32 nDefault ) const
+{
+    const size_t nPos = GetFieldPos(iField, sizeof(GInt32));
+    return nPos ? static_cast<GInt32>(ReadUInt32(m_pabyBuf + nPos)) : nDefault;
+}
+
+GUIntBig FGBTableReader::GetUInt64( int iField, GUIntBig nDefault ) const
+{
+    const size_t nPos = GetFieldPos(iField, sizeof(GUIntBig));
+    if( nPos == 0 )
+        return nDefault;
+    GUIntBig nVal;
+    memcpy(&nVal, m_pabyBuf + nPos, sizeof(nVal));
+    CPL_LSBPTR64(&nVal);
+    return nVal;
+}
+
+CPLString FGBTableReader::GetString( int iField ) const
+{
+    const GByte* pabyData = nullptr;
+    GUInt32 nCount = 0;
+    if( !GetVector(iField, 1, pabyData, nCount) )
+        return CPLString();
+    return CPLString(reinterpret_cast<const char*>(pabyData), nCount);
+}
+
+bool FGBTableReader::GetTable( int iField, FGBTableReader& oTable ) const
+{
+    size_t nPos = 0;
+    if( !GetReference(iField, nPos) )
+        return false;
+    return oTable.Init(m_pabyBuf, m_nBufSize, nPos);
+}
+
+/************************************************************************/
+/*                       FGBTableReader::GetVector()                    */
+/************************************************************************/
+
+bool FGBTableReader::GetVector( int iField, size_t nEltSize,
+                                const GByte*& pabyData,
+                                GUInt32& nCount ) const
+{
+    size_t nPos = 0;
+    if( !GetReference(iField, nPos) ||
+        m_nBufSize - nPos < sizeof(GUInt32) )
+        return false;
+    const GUInt32 nEltCount = ReadUInt32(m_pabyBuf + nPos);
+    nPos += sizeof(GUInt32);
+    if( nEltCount > (m_nBufSize - nPos) / nEltSize )
+        return false;
+    pabyData = m_pabyBuf + nPos;
+    nCount = nEltCount;
+    return true;
+}
+
+/************************************************************************/
+/*                    FGBTableReader::GetTableVector()                  */
+/************************************************************************/
+
+bool FGBTableReader::GetTableVector( int iField,
+                                  std::vector<FGBTableReader>& aoTables ) const
+{
+    aoTables.clear();
+    const GByte* pabyData = nullptr;
+    GUInt32 nCount = 0;
+    if( !GetVector(iField, sizeof(GUInt32), pabyData, nCount) )
+        return false;
+    const size_t nStart = static_cast<size_t>(pabyData - m_pabyBuf);
+    aoTables.resize(nCount);
+    for( GUInt32 i = 0; i < nCount; i++ )
+    {
+        const size_t nRefPos = nStart + i * sizeof(GUInt32);
+        const GUInt32 nOffset = ReadUInt32(m_pabyBuf + nRefPos);
+        if( nOffset >= m_nBufSize - nRefPos ||
+            !aoTables[i].Init(m_pabyBuf, m_nBufSize, nRefPos + nOffset) )
+        {
+            aoTables.clear();
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Minimal reader and writer of FlatBuffers tables, as used by the
+ *           FlatGeobuf header and features.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef FGB_FLATBUFFERS_H_INCLUDED
+#define FGB_FLATBUFFERS_H_INCLUDED
+
+#include "cpl_port.h"
+#include "cpl_string.h"
+
+#include <vector>
+
+/*
+ * Only the subset of the FlatBuffers binary format needed by FlatGeobuf is
+ * handled: tables with scalar fields, strings, vectors of scalars, vectors
+ * of tables, and sub-tables. All values are little endian.
+ *
+ * The writer lays out objects front to back: the vtable of a table is
+ * followed by the table, and then by the objects it references, each one
+ * starting on a 8 byte boundary so that the alignment requirements of its
+ * content are preserved wherever it is copied in the final buffer.
+ */
+
+/************************************************************************/
+/*                               FGBBlob                                */
+/************************************************************************/
+
+// A serialized object and the position of its start within abyData.
+struct FGBBlob
+{
+    std::vector<GByte>  abyData{};
+    size_t              nObjectOffset = 0;
+};
+
+FGBBlob FGBCreateString( const char* pszStr );
+FGBBlob FGBCreateString( const GByte* pabyData, size_t nSize );
+FGBBlob FGBCreateVector( const void* pData, size_t nCount,
+                         size_t nEltSize );
+FGBBlob FGBCreateTableVector( const std::vector<FGBBlob>& aoTables );
+
+/************************************************************************/
+/*                           FGBTableWriter                             */
+/************************************************************************/
+
+class FGBTableWriter
+{
+        struct Field
+        {
+            int         iField;
+            size_t      nSize;      // 1, 2, 4 or 8 for scalars
+            GByte       abyValue[8];
+            int         iChild;     // index in m_aoChildren, or -1
+        };
+
+        std::vector<Field>      m_aoFields{};
+        std::vector<FGBBlob>    m_aoChildren{};
+
+        void    AddScalar( int iField, const void* pValue, size_t nSize );
+
+    public:
+        void    AddUInt8( int iField, GByte nVal );
+        void    AddUInt16( int iField, GUInt16 nVal );
+        void    AddInt32( int iField, GInt32 nVal );
+        void    AddUInt64( int iField, GUIntBig nVal );
+        void    AddChild( int iField, FGBBlob&& oBlob );
+
+        FGBBlob Finish();
+};
+
+// Serialize a root table, prefixed by its size as an uint32.
+std::vector<GByte> FGBFinishSizePrefixed( const FGBBlob& oRoot );
+
+/************************************************************************/
+/*                           FGBTableReader                             */
+/************************************************************************/
+
+// Accessor to a table of a FlatBuffers buffer. All accesses are checked
+// against the buffer bounds, and return the default value on error.
+class FGBTableReader
+{
+        const GByte    *m_pabyBuf = nullptr;
+        size_t          m_nBufSize = 0;
+        size_t          m_nTablePos = 0;
+        size_t          m_nVTablePos = 0;
+        size_t          m_nVTableSize = 0;
+
+        size_t          GetFieldPos( int iField, size_t nSize ) const;
+        bool            GetReference( int iField, size_t& nPos ) const;
+
+    public:
+        bool            InitFromRoot( const GByte* pabyBuf, size_t nBufSize );
+        bool            Init( const GByte* pabyBuf, size_t nBufSize,
+                              size_t nTablePos );
+
+        bool            HasField( int iField ) const;
+        GByte           GetUInt8( int iField, GByte nDefault = 0 ) const;
+        GUInt16         GetUInt16( int iField, GUInt16 nDefault = 0 ) const;
+        GInt32          GetInt32( int iField, GInt32 nDefault = 0 ) const;
+        GUIntBig        GetUInt64( int iField, GUIntBig nDefault = 0 ) const;
+        CPLString       GetString( int iField ) const;
+        bool            GetTable( int iField, FGBTableReader& oTable ) const;
+
+        // Position of the first element and number of elements of a vector
+        // of scalars of nEltSize bytes.
+        bool            GetVector( int iField, size_t nEltSize,
+                                   const GByte*& pabyData,
+                                   GUInt32& nCount ) const;
+        bool            GetTableVector( int iField,
+                                        std::vector<FGBTableReader>& aoTables )
+                                                                        const;
+};
+
+#endif /* ndef FGB_FLATBUFFERS_H_INCLUDED */
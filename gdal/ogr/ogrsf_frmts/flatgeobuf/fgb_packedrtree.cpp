@@ -0,0 +1,329 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Static packed Hilbert R-tree of FlatGeobuf files.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "fgb_packedrtree.h"
+#include "cpl_error.h"
+
+#include <algorithm>
+#include <cstring>
+
+CPL_CVSID("$Id$")
+
+// Nodes of a level that are separated by less than this number of nodes are
+// fetched in a single read, which saves round trips on network files.
+constexpr GUIntBig MAX_NODE_GAP_MERGED = 64;
+// Upper bound of the size of a single read, and of the reads issued at once.
+constexpr GUIntBig MAX_NODES_PER_READ = 100 * 1024;
+constexpr size_t MAX_RANGES_PER_BATCH = 100;
+
+/************************************************************************/
+/*                          FGBGetLevelBounds()                         */
+/************************************************************************/
+
+std::vector<std::pair<GUIntBig, GUIntBig>>
+                        FGBGetLevelBounds( GUIntBig nItems, GUInt16 nNodeSize )
+{
+    std::vector<std::pair<GUIntBig, GUIntBig>> aoBounds;
+    if( nItems == 0 || nNodeSize < 2 )
+        return aoBounds;
+
+    // Number of nodes of each level, from the leaves to the root. Even a
+    // single item gets a root node above it.
+    std::vector<GUIntBig> anLevelNodes;
+    GUIntBig n = nItems;
+    GUIntBig nNodes = n;
+    anLevelNodes.push_back(n);
+    do
+    {
+        n = (n + nNodeSize - 1) / nNodeSize;
+        nNodes += n;
+        anLevelNodes.push_back(n);
+    } while( n != 1 );
+
+    for( GUIntBig nLevelNodes: anLevelNodes )
+    {
+        aoBounds.emplace_back(nNodes - nLevelNodes, nNodes);
+        nNodes -= nLevelNodes;
+    }
+    return aoBounds;
+}
+
+/************************************************************************/
+/*                           FGBGetIndexSize()                          */
+/************************************************************************/
+
+GUIntBig FGBGetIndexSize( GUIntBig nItems, GUInt16 nNodeSize )
+{
+    const auto aoBounds = FGBGetLevelBounds(nItems, nNodeSize);
+    if( aoBounds.empty() )
+        return 0;
+    return aoBounds[0].second * FGB_NODE_ITEM_SIZE;
+}
+
+/************************************************************************/
+/*                       Node (de)serialization                         */
+/************************************************************************/
+
+static void SerializeNode( const FGBNodeItem& sNode, GByte* pabyDst )
+{
+    double adfBounds[4] = { sNode.dfMinX, sNode.dfMinY,
+                            sNode.dfMaxX, sNode.dfMaxY };
+    GUIntBig nOffset = sNode.nOffset;
+    for( int i = 0; i < 4; i++ )
+        CPL_LSBPTR64(&adfBounds[i]);
+    CPL_LSBPTR64(&nOffset);
+    memcpy(pabyDst, adfBounds, sizeof(adfBounds));
+    memcpy(pabyDst + sizeof(adfBounds), &nOffset, sizeof(nOffset));
+}
+
+static void DeserializeNode( const GByte* pabySrc, FGBNodeItem& sNode )
+{
+    double adfBounds[4];
+    memcpy(adfBounds, pabySrc, sizeof(adfBounds));
+    memcpy(&sNode.nOffset, pabySrc + sizeof(adfBounds), sizeof(GUIntBig));
+    for( int i = 0; i < 4; i++ )
+        CPL_LSBPTR64(&adfBounds[i]);
+    CPL_LSBPTR64(&sNode.nOffset);
+    sNode.dfMinX = adfBounds[0];
+    sNode.dfMinY = adfBounds[1];
+    sNode.dfMaxX = adfBounds[2];
+    sNode.dfMaxY = adfBounds[3];
+}
+
+/************************************************************************/
+/*                            FGBWriteIndex()                           */
+/************************************************************************/
+
+bool FGBWriteIndex( VSILFILE* fp, const std::vector<FGBNodeItem>& asLeaves,
+                    GUInt16 nNodeSize )
+{
+    const auto aoBounds = FGBGetLevelBounds(asLeaves.size(), nNodeSize);
+    if( aoBounds.empty() )
+        return true;
+
+    std::vector<FGBNodeItem> asNodes;
+    try
+    {
+        asNodes.resize(static_cast<size_t>(aoBounds[0].second));
+    }
+    catch( const std::exception& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate spatial index");
+        return false;
+    }
+    std::copy(asLeaves.begin(), asLeaves.end(),
+              asNodes.begin() + static_cast<size_t>(aoBounds[0].first));
+
+    // Each parent covers nNodeSize consecutive nodes of the level below,
+    // and points to the first of them.
+    for( size_t iLevel = 0; iLevel + 1 < aoBounds.size(); iLevel++ )
+    {
+        size_t iParent = static_cast<size_t>(aoBounds[iLevel + 1].first);
+        for( GUIntBig nPos = aoBounds[iLevel].first;
+             nPos < aoBounds[iLevel].second; nPos += nNodeSize, iParent++ )
+        {
+            const GUIntBig nEnd =
+                std::min(nPos + nNodeSize, aoBounds[iLevel].second);
+            FGBNodeItem& sParent = asNodes[iParent];
+            sParent = asNodes[static_cast<size_t>(nPos)];
+            for( GUIntBig i = nPos + 1; i < nEnd; i++ )
+            {
+                const FGBNodeItem& sChild = asNodes[static_cast<size_t>(i)];
+                sParent.dfMinX = std::min(sParent.dfMinX, sChild.dfMinX);
+                sParent.dfMinY = std::min(sParent.dfMinY, sChild.dfMinY);
+                sParent.dfMaxX = std::max(sParent.dfMaxX, sChild.dfMaxX);
+                sParent.dfMaxY = std::max(sParent.dfMaxY, sChild.dfMaxY);
+            }
+            sParent.nOffset = nPos;
+        }
+    }
+
+    std::vector<GByte> abyBuffer(FGB_NODE_ITEM_SIZE * 4096);
+    for( size_t i = 0; i < asNodes.size(); i += 4096 )
+    {
+        const size_t nCount = std::min(asNodes.size() - i,
+                                       static_cast<size_t>(4096));
+        for( size_t j = 0; j < nCount; j++ )
+            SerializeNode(asNodes[i + j], &abyBuffer[j * FGB_NODE_ITEM_SIZE]);
+        if( VSIFWriteL(abyBuffer.data(), FGB_NODE_ITEM_SIZE, nCount, fp) !=
+                                                                    nCount )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           FGBSearchIndex()                           */
+/************************************************************************/
+
+bool FGBSearchIndex( VSILFILE* fp, vsi_l_offset nIndexOffset,
+                     GUIntBig nItems, GUInt16 nNodeSize,
+                     const OGREnvelope& sFilterEnvelope,
+                     std::vector<FGBSearchResult>& asResults )
+{
+    asResults.clear();
+    const auto aoBounds = FGBGetLevelBounds(nItems, nNodeSize);
+    if( aoBounds.empty() )
+        return true;
+    const GUIntBig nLeafStart = aoBounds[0].first;
+
+    typedef std::pair<GUIntBig, GUIntBig> NodeRange;
+    std::vector<NodeRange> aoRanges{ NodeRange(0, 1) };
+    std::vector<NodeRange> aoNextRanges;
+    std::vector<std::vector<GByte>> aabyBuffers;
+    std::vector<void*> apData;
+    std::vector<vsi_l_offset> anOffsets;
+    std::vector<size_t> anSizes;
+
+    for( int iLevel = static_cast<int>(aoBounds.size()) - 1;
+         iLevel >= 0 && !aoRanges.empty(); iLevel-- )
+    {
+        const bool bIsLeafLevel = iLevel == 0;
+        const GUIntBig nChildLevelEnd =
+            bIsLeafLevel ? 0 : aoBounds[iLevel - 1].second;
+
+        // Coalesce the ranges of nodes to visit that are close to each other.
+        // Nodes between them are visited too, which is harmless since any
+        // node intersecting the filter has a parent intersecting it.
+        std::vector<NodeRange> aoReads;
+        for( const auto& oRange: aoRanges )
+        {
+            if( !aoReads.empty() &&
+                oRange.first <= aoReads.back().second + MAX_NODE_GAP_MERGED &&
+                oRange.second - aoReads.back().first <= MAX_NODES_PER_READ )
+            {
+                aoReads.back().second =
+                    std::max(aoReads.back().second, oRange.second);
+            }
+            else
+            {
+                aoReads.push_back(oRange);
+            }
+        }
+
+        aoNextRanges.clear();
+        for( size_t iRead = 0; iRead < aoReads.size(); )
+        {
+            // Fetch a batch of ranges at once, which /vsicurl/ turns into
+            // parallel HTTP range requests.
+            aabyBuffers.clear();
+            apData.clear();
+            anOffsets.clear();
+            anSizes.clear();
+            GUIntBig nBatchNodes = 0;
+            size_t iEnd = iRead;
+            while( iEnd < aoReads.size() &&
+                   iEnd - iRead < MAX_RANGES_PER_BATCH &&
+                   (iEnd == iRead || nBatchNodes +
+                        (aoReads[iEnd].second - aoReads[iEnd].first) <=
+                                                        MAX_NODES_PER_READ) )
+            {
+                const GUIntBig nCount =
+                    aoReads[iEnd].second - aoReads[iEnd].first;
+                nBatchNodes += nCount;
+                aabyBuffers.emplace_back(
+                    static_cast<size_t>(nCount * FGB_NODE_ITEM_SIZE));
+                anOffsets.push_back(nIndexOffset +
+                                aoReads[iEnd].first * FGB_NODE_ITEM_SIZE);
+                anSizes.push_back(aabyBuffers.back().size());
+                iEnd++;
+            }
+            for( auto& abyBuffer: aabyBuffers )
+                apData.push_back(abyBuffer.data());
+            if( VSIFReadMultiRangeL(static_cast<int>(apData.size()),
+                                    apData.data(), anOffsets.data(),
+                                    anSizes.data(), fp) != 0 )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot read spatial index");
+                return false;
+            }
+
+            for( size_t i = 0; i < aabyBuffers.size(); i++ )
+            {
+                const NodeRange& oRead = aoReads[iRead + i];
+                for( GUIntBig nPos = oRead.first; nPos < oRead.second; nPos++ )
+                {
+                    FGBNodeItem sNode;
+                    DeserializeNode(&aabyBuffers[i][static_cast<size_t>(
+                        (nPos - oRead.first) * FGB_NODE_ITEM_SIZE)], sNode);
+                    if( sNode.dfMaxX < sFilterEnvelope.MinX ||
+                        sNode.dfMaxY < sFilterEnvelope.MinY ||
+                        sNode.dfMinX > sFilterEnvelope.MaxX ||
+                        sNode.dfMinY > sFilterEnvelope.MaxY )
+                        continue;
+                    if( bIsLeafLevel )
+                    {
+                        FGBSearchResult sResult;
+                        sResult.nOffset = sNode.nOffset;
+                        sResult.nIndex = nPos - nLeafStart;
+                        asResults.push_back(sResult);
+                    }
+                    else
+                    {
+                        if( sNode.nOffset >= nChildLevelEnd ||
+                            sNode.nOffset < aoBounds[iLevel - 1].first )
+                        {
+                            CPLError(CE_Failure, CPLE_AppDefined,
+                                     "Corrupted spatial index");
+                            return false;
+                        }
+                        aoNextRanges.emplace_back(
+                            sNode.nOffset,
+                            std::min(sNode.nOffset + nNodeSize,
+                                     nChildLevelEnd));
+                    }
+                }
+            }
+            iRead = iEnd;
+        }
+        std::swap(aoRanges, aoNextRanges);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             FGBReadLeaf()                            */
+/************************************************************************/
+
+bool FGBReadLeaf( VSILFILE* fp, vsi_l_offset nIndexOffset,
+                  GUIntBig nItems, GUInt16 nNodeSize,
+                  GUIntBig nIndex, FGBNodeItem& sLeaf )
+{
+    const auto aoBounds = FGBGetLevelBounds(nItems, nNodeSize);
+    if( aoBounds.empty() || nIndex >= nItems )
+        return false;
+    GByte abyNode[FGB_NODE_ITEM_SIZE];
+    if( VSIFSeekL(fp, nIndexOffset +
+                  (aoBounds[0].first + nIndex) * FGB_NODE_ITEM_SIZE,
+                  SEEK_SET) != 0 ||
+        VSIFReadL(abyNode, sizeof(abyNode), 1, fp) != 1 )
+        return false;
+    DeserializeNode(abyNode, sLeaf);
+    return true;
+}
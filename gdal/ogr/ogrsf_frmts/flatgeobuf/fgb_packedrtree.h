@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Static packed Hilbert R-tree of FlatGeobuf files.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef FGB_PACKEDRTREE_H_INCLUDED
+#define FGB_PACKEDRTREE_H_INCLUDED
+
+#include "cpl_vsi.h"
+#include "ogr_core.h"
+
+#include <utility>
+#include <vector>
+
+/*
+ * The tree is stored root first, one level after the other, the leaves
+ * being last. Each node is made of its bounding box as 4 doubles followed
+ * by an uint64: for a leaf, the offset of the feature relative to the start
+ * of the feature section; for other nodes, the index of their first child.
+ */
+
+constexpr size_t FGB_NODE_ITEM_SIZE = 4 * sizeof(double) + sizeof(GUIntBig);
+
+struct FGBNodeItem
+{
+    double      dfMinX;
+    double      dfMinY;
+    double      dfMaxX;
+    double      dfMaxY;
+    GUIntBig    nOffset;
+};
+
+struct FGBSearchResult
+{
+    GUIntBig    nOffset;    // offset of the feature in the feature section
+    GUIntBig    nIndex;     // rank of the feature, which is its FID
+};
+
+// [start, end) node indices of each level, from the leaves to the root.
+std::vector<std::pair<GUIntBig, GUIntBig>>
+    FGBGetLevelBounds( GUIntBig nItems, GUInt16 nNodeSize );
+
+GUIntBig FGBGetIndexSize( GUIntBig nItems, GUInt16 nNodeSize );
+
+// Write the tree whose leaves, already in Hilbert order, are given.
+bool FGBWriteIndex( VSILFILE* fp, const std::vector<FGBNodeItem>& asLeaves,
+                    GUInt16 nNodeSize );
+
+// Search the tree at nIndexOffset in fp, reading only the nodes whose
+// parents intersect sFilterEnvelope. Results are sorted by feature rank.
+bool FGBSearchIndex( VSILFILE* fp, vsi_l_offset nIndexOffset,
+                     GUIntBig nItems, GUInt16 nNodeSize,
+                     const OGREnvelope& sFilterEnvelope,
+                     std::vector<FGBSearchResult>& asResults );
+
+// Read the leaf of rank nIndex.
+bool FGBReadLeaf( VSILFILE* fp, vsi_l_offset nIndexOffset,
+                  GUIntBig nItems, GUInt16 nNodeSize,
+                  GUIntBig nIndex, FGBNodeItem& sLeaf );
+
+#endif /* ndef FGB_PACKEDRTREE_H_INCLUDED */
@@ -0,0 +1,264 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Definition of classes for OGR FlatGeobuf driver.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef OGR_FLATGEOBUF_H_INCLUDED
+#define OGR_FLATGEOBUF_H_INCLUDED
+
+#include "ogrsf_frmts.h"
+#include "fgb_flatbuffers.h"
+#include "fgb_packedrtree.h"
+
+#include <vector>
+
+/*
+ * A FlatGeobuf file is made of:
+ * - the 8 byte magic, whose 4th byte is the major version of the format,
+ * - the size of the header as an uint32, followed by the header, a
+ *   FlatBuffers table describing the layer,
+ * - if the features are counted and the index node size is not zero, a
+ *   packed Hilbert R-tree of the feature bounding boxes,
+ * - the features, each one being its size as an uint32 followed by a
+ *   FlatBuffers table. When there is an index, features are in the order of
+ *   its leaves.
+ */
+
+constexpr GByte FGB_MAGIC[8] = { 'f', 'g', 'b', 3, 'f', 'g', 'b', 0 };
+constexpr GUInt16 FGB_DEFAULT_INDEX_NODE_SIZE = 16;
+
+// Fields of the Header table.
+enum
+{
+    FGB_HEADER_NAME = 0,
+    FGB_HEADER_ENVELOPE = 1,
+    FGB_HEADER_GEOMETRY_TYPE = 2,
+    FGB_HEADER_HAS_Z = 3,
+    FGB_HEADER_HAS_M = 4,
+    FGB_HEADER_COLUMNS = 7,
+    FGB_HEADER_FEATURES_COUNT = 8,
+    FGB_HEADER_INDEX_NODE_SIZE = 9,
+    FGB_HEADER_CRS = 10,
+    FGB_HEADER_TITLE = 11,
+    FGB_HEADER_DESCRIPTION = 12
+};
+
+// Fields of the Crs table.
+enum
+{
+    FGB_CRS_ORG = 0,
+    FGB_CRS_CODE = 1,
+    FGB_CRS_WKT = 4
+};
+
+// Fields of the Column table.
+enum
+{
+    FGB_COLUMN_NAME = 0,
+    FGB_COLUMN_TYPE = 1,
+    FGB_COLUMN_WIDTH = 4,
+    FGB_COLUMN_PRECISION = 5,
+    FGB_COLUMN_SCALE = 6,
+    FGB_COLUMN_NULLABLE = 7
+};
+
+// Fields of the Geometry table.
+enum
+{
+    FGB_GEOMETRY_ENDS = 0,
+    FGB_GEOMETRY_XY = 1,
+    FGB_GEOMETRY_Z = 2,
+    FGB_GEOMETRY_M = 3,
+    FGB_GEOMETRY_TYPE = 6,
+    FGB_GEOMETRY_PARTS = 7
+};
+
+// Fields of the Feature table.
+enum
+{
+    FGB_FEATURE_GEOMETRY = 0,
+    FGB_FEATURE_PROPERTIES = 1
+};
+
+enum FGBGeometryType
+{
+    FGB_GT_UNKNOWN = 0,
+    FGB_GT_POINT = 1,
+    FGB_GT_LINESTRING = 2,
+    FGB_GT_POLYGON = 3,
+    FGB_GT_MULTIPOINT = 4,
+    FGB_GT_MULTILINESTRING = 5,
+    FGB_GT_MULTIPOLYGON = 6,
+    FGB_GT_GEOMETRYCOLLECTION = 7
+};
+
+enum FGBColumnType
+{
+    FGB_CT_BYTE = 0,
+    FGB_CT_UBYTE = 1,
+    FGB_CT_BOOL = 2,
+    FGB_CT_SHORT = 3,
+    FGB_CT_USHORT = 4,
+    FGB_CT_INT = 5,
+    FGB_CT_UINT = 6,
+    FGB_CT_LONG = 7,
+    FGB_CT_ULONG = 8,
+    FGB_CT_FLOAT = 9,
+    FGB_CT_DOUBLE = 10,
+    FGB_CT_STRING = 11,
+    FGB_CT_JSON = 12,
+    FGB_CT_DATETIME = 13,
+    FGB_CT_BINARY = 14
+};
+
+/************************************************************************/
+/*                          OGRFlatGeobufLayer                          */
+/************************************************************************/
+
+class OGRFlatGeobufLayer final: public OGRLayer
+{
+        OGRFeatureDefn         *m_poFeatureDefn = nullptr;
+        OGRSpatialReference    *m_poSRS = nullptr;
+        VSILFILE               *m_fp = nullptr;
+        FGBGeometryType         m_eGeomType = FGB_GT_UNKNOWN;
+        bool                    m_bHasZ = false;
+        bool                    m_bHasM = false;
+        std::vector<FGBColumnType> m_aeColumnTypes{};
+        std::vector<GByte>      m_abyBuffer{};
+
+        // Reading.
+        GUIntBig                m_nFeatureCount = 0;
+        GUInt16                 m_nIndexNodeSize = 0;
+        vsi_l_offset            m_nIndexOffset = 0;
+        vsi_l_offset            m_nFeaturesOffset = 0;
+        bool                    m_bHasExtent = false;
+        OGREnvelope             m_sExtent{};
+        GUIntBig                m_nNextIndex = 0;
+        vsi_l_offset            m_nNextOffset = 0;
+        bool                    m_bIndexSearched = false;
+        std::vector<FGBSearchResult> m_asSearchResults{};
+        size_t                  m_iNextSearchResult = 0;
+
+        // Writing.
+        struct WrittenFeature
+        {
+            vsi_l_offset        nOffset;
+            GUInt32             nSize;
+            FGBNodeItem         sBounds;
+        };
+
+        bool                    m_bCreate = false;
+        bool                    m_bSpatialIndex = true;
+        bool                    m_bHeaderWritten = false;
+        CPLString               m_osTempFilename{};
+        VSILFILE               *m_fpTemp = nullptr;
+        vsi_l_offset            m_nTempSize = 0;
+        std::vector<WrittenFeature> m_asWrittenFeatures{};
+        GUIntBig                m_nWrittenCount = 0;
+
+        bool                    HasIndex() const
+                                { return m_nFeatureCount > 0 &&
+                                         m_nIndexNodeSize > 0; }
+        OGRFeature             *ReadFeature( vsi_l_offset nOffset,
+                                             GIntBig nFID,
+                                             GUInt32* pnSize );
+        OGRFeature             *GetNextRawFeature();
+        void                    ParseProperties( OGRFeature* poFeature,
+                                                 const GByte* pabyData,
+                                                 size_t nSize );
+        OGRGeometry            *ParseGeometry( const FGBTableReader& oGeom,
+                                               FGBGeometryType eType,
+                                               int nRecLevel );
+        std::vector<GByte>      BuildHeader( GUIntBig nFeatureCount,
+                                             GUInt16 nIndexNodeSize,
+                                             const OGREnvelope* psExtent );
+        FGBBlob                 BuildGeometry( const OGRGeometry* poGeom );
+        bool                    WriteHeader( GUIntBig nFeatureCount,
+                                             GUInt16 nIndexNodeSize,
+                                             const OGREnvelope* psExtent );
+
+    public:
+        OGRFlatGeobufLayer( const char* pszName, VSILFILE* fp );
+        OGRFlatGeobufLayer( const char* pszName, const char* pszFilename,
+                            VSILFILE* fp,
+                            OGRSpatialReference* poSRS,
+                            OGRwkbGeometryType eGType,
+                            char** papszOptions );
+        virtual ~OGRFlatGeobufLayer();
+
+        bool                    Open( const std::vector<GByte>& abyHeader,
+                                      vsi_l_offset nHeaderOffset );
+        bool                    FinishCreation();
+
+        OGRFeatureDefn         *GetLayerDefn() override
+                                { return m_poFeatureDefn; }
+        void                    ResetReading() override;
+        OGRFeature             *GetNextFeature() override;
+        OGRFeature             *GetFeature( GIntBig nFID ) override;
+        GIntBig                 GetFeatureCount( int bForce ) override;
+        OGRErr                  GetExtent( OGREnvelope* psExtent,
+                                           int bForce ) override;
+        OGRErr                  GetExtent( int iGeomField,
+                                           OGREnvelope* psExtent,
+                                           int bForce ) override
+                { return OGRLayer::GetExtent(iGeomField, psExtent, bForce); }
+        int                     TestCapability( const char* ) override;
+
+        OGRErr                  ICreateFeature( OGRFeature* poFeature ) override;
+        OGRErr                  CreateField( OGRFieldDefn* poField,
+                                             int bApproxOK ) override;
+};
+
+/************************************************************************/
+/*                         OGRFlatGeobufDataset                         */
+/************************************************************************/
+
+class OGRFlatGeobufDataset final: public GDALDataset
+{
+        OGRFlatGeobufLayer     *m_poLayer = nullptr;
+        VSILFILE               *m_fp = nullptr;
+
+    public:
+        OGRFlatGeobufDataset() = default;
+        virtual ~OGRFlatGeobufDataset();
+
+        static int              Identify( GDALOpenInfo* poOpenInfo );
+        static GDALDataset     *Open( GDALOpenInfo* poOpenInfo );
+        static GDALDataset     *Create( const char* pszName,
+                                        int nBands, int nXSize, int nYSize,
+                                        GDALDataType eDT,
+                                        char** papszOptions );
+
+        int                     GetLayerCount() override
+                                { return m_poLayer != nullptr ? 1 : 0; }
+        OGRLayer               *GetLayer( int ) override;
+        int                     TestCapability( const char* ) override;
+        OGRLayer               *ICreateLayer( const char* pszName,
+                                      OGRSpatialReference* poSRS,
+                                      OGRwkbGeometryType eGType,
+                                      char** papszOptions ) override;
+};
+
+#endif /* ndef OGR_FLATGEOBUF_H_INCLUDED */
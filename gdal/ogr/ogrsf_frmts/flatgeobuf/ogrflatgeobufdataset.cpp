@@ -0,0 +1,235 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Implements OGRFlatGeobufDataset class and driver registration.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_flatgeobuf.h"
+#include "cpl_vsi_error.h"
+
+#include <cstring>
+
+CPL_CVSID("$Id$")
+
+// Sanity limit on the size of the header.
+constexpr GUInt32 MAX_HEADER_SIZE = 100 * 1024 * 1024;
+
+/************************************************************************/
+/*                        ~OGRFlatGeobufDataset()                       */
+/************************************************************************/
+
+OGRFlatGeobufDataset::~OGRFlatGeobufDataset()
+{
+    if( m_poLayer != nullptr && eAccess == GA_Update )
+        m_poLayer->FinishCreation();
+    delete m_poLayer;
+    if( m_fp != nullptr )
+        VSIFCloseL(m_fp);
+}
+
+/************************************************************************/
+/*                              Identify()                              */
+/************************************************************************/
+
+int OGRFlatGeobufDataset::Identify( GDALOpenInfo* poOpenInfo )
+{
+    // Only the major version, in the 4th byte, is checked.
+    return poOpenInfo->fpL != nullptr &&
+           poOpenInfo->nHeaderBytes >= static_cast<int>(sizeof(FGB_MAGIC)) &&
+           memcmp(poOpenInfo->pabyHeader, FGB_MAGIC, 3) == 0 &&
+           poOpenInfo->pabyHeader[3] == FGB_MAGIC[3] &&
+           memcmp(poOpenInfo->pabyHeader + 4, FGB_MAGIC + 4, 3) == 0;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+GDALDataset* OGRFlatGeobufDataset::Open( GDALOpenInfo* poOpenInfo )
+{
+    if( !Identify(poOpenInfo) )
+        return nullptr;
+    if( poOpenInfo->eAccess == GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Update of existing FlatGeobuf files not supported");
+        return nullptr;
+    }
+
+    VSILFILE* fp = poOpenInfo->fpL;
+    GUInt32 nHeaderSize = 0;
+    if( VSIFSeekL(fp, sizeof(FGB_MAGIC), SEEK_SET) != 0 ||
+        VSIFReadL(&nHeaderSize, sizeof(nHeaderSize), 1, fp) != 1 )
+        return nullptr;
+    CPL_LSBPTR32(&nHeaderSize);
+    if( nHeaderSize > MAX_HEADER_SIZE )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Invalid FlatGeobuf header size: %u", nHeaderSize);
+        return nullptr;
+    }
+    std::vector<GByte> abyHeader(nHeaderSize);
+    if( VSIFReadL(abyHeader.data(), 1, nHeaderSize, fp) != nHeaderSize )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read FlatGeobuf header");
+        return nullptr;
+    }
+
+    OGRFlatGeobufDataset* poDS = new OGRFlatGeobufDataset();
+    poDS->SetDescription(poOpenInfo->pszFilename);
+    poDS->m_fp = fp;
+    poOpenInfo->fpL = nullptr;
+
+    OGRFlatGeobufLayer* poLayer = new OGRFlatGeobufLayer(
+        CPLGetBasename(poOpenInfo->pszFilename), fp);
+    if( !poLayer->Open(abyHeader,
+                       sizeof(FGB_MAGIC) + sizeof(GUInt32) + nHeaderSize) )
+    {
+        delete poLayer;
+        delete poDS;
+        return nullptr;
+    }
+    poDS->m_poLayer = poLayer;
+    return poDS;
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+GDALDataset* OGRFlatGeobufDataset::Create( const char* pszName,
+                                           int /* nBands */,
+                                           int /* nXSize */,
+                                           int /* nYSize */,
+                                           GDALDataType /* eDT */,
+                                           char ** /* papszOptions */ )
+{
+    if( strcmp(pszName, "/dev/stdout") == 0 )
+        pszName = "/vsistdout/";
+
+    VSILFILE* fp = VSIFOpenExL(pszName, "wb", true);
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_OpenFailed, "Failed to create %s: %s",
+                 pszName, VSIGetLastErrorMsg());
+        return nullptr;
+    }
+
+    OGRFlatGeobufDataset* poDS = new OGRFlatGeobufDataset();
+    poDS->SetDescription(pszName);
+    poDS->m_fp = fp;
+    poDS->eAccess = GA_Update;
+    return poDS;
+}
+
+/************************************************************************/
+/*                              GetLayer()                              */
+/************************************************************************/
+
+OGRLayer* OGRFlatGeobufDataset::GetLayer( int iLayer )
+{
+    return iLayer == 0 ? m_poLayer : nullptr;
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRFlatGeobufDataset::TestCapability( const char* pszCap )
+{
+    if( EQUAL(pszCap, ODsCCreateLayer) )
+        return eAccess == GA_Update && m_poLayer == nullptr;
+
+    return FALSE;
+}
+
+/************************************************************************/
+/*                            ICreateLayer()                            */
+/************************************************************************/
+
+OGRLayer* OGRFlatGeobufDataset::ICreateLayer( const char* pszName,
+                                              OGRSpatialReference* poSRS,
+                                              OGRwkbGeometryType eGType,
+                                              char** papszOptions )
+{
+    if( eAccess != GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Layer creation only supported on newly created datasets");
+        return nullptr;
+    }
+    if( m_poLayer != nullptr )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "FlatGeobuf driver only supports one layer per file");
+        return nullptr;
+    }
+
+    m_poLayer = new OGRFlatGeobufLayer(pszName, GetDescription(), m_fp,
+                                       poSRS, eGType, papszOptions);
+    return m_poLayer;
+}
+
+/************************************************************************/
+/*                        RegisterOGRFlatGeobuf()                       */
+/************************************************************************/
+
+void RegisterOGRFlatGeobuf()
+{
+    if( !GDAL_CHECK_VERSION("OGR/FlatGeobuf driver") )
+        return;
+
+    if( GDALGetDriverByName( "FlatGeobuf" ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "FlatGeobuf" );
+    poDriver->SetMetadataItem( GDAL_DCAP_VECTOR, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "FlatGeobuf" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "fgb" );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_flatgeobuf.html" );
+
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
+                               "<CreationOptionList/>");
+
+    poDriver->SetMetadataItem( GDAL_DS_LAYER_CREATIONOPTIONLIST,
+"<LayerCreationOptionList>"
+"  <Option name='SPATIAL_INDEX' type='boolean' description='Whether to sort features and write a packed Hilbert R-tree. If NO, features are streamed to the output in their creation order' default='YES'/>"
+"  <Option name='INDEX_NODE_SIZE' type='int' description='Number of children of the nodes of the spatial index' default='16'/>"
+"</LayerCreationOptionList>");
+
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATATYPES,
+                               "Integer Integer64 Real String Date DateTime "
+                               "Binary" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATASUBTYPES,
+                               "Boolean Int16 Float32" );
+
+    poDriver->pfnOpen = OGRFlatGeobufDataset::Open;
+    poDriver->pfnIdentify = OGRFlatGeobufDataset::Identify;
+    poDriver->pfnCreate = OGRFlatGeobufDataset::Create;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
@@ -0,0 +1,1458 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf Translator
+ * Purpose:  Implements OGRFlatGeobufLayer class.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_flatgeobuf.h"
+#include "ogr_p.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+CPL_CVSID("$Id$")
+
+// Sanity limits, to avoid huge allocations on corrupted files.
+constexpr GUInt32 MAX_FEATURE_SIZE = 1024 * 1024 * 1024;
+constexpr GUIntBig MAX_FEATURE_COUNT = static_cast<GUIntBig>(1) << 50;
+constexpr int MAX_GEOMETRY_NESTING = 32;
+
+/************************************************************************/
+/*                          Geometry type mapping                       */
+/************************************************************************/
+
+static OGRwkbGeometryType FGBToOGRGeomType( FGBGeometryType eType,
+                                            bool bHasZ, bool bHasM )
+{
+    OGRwkbGeometryType eOGRType = wkbUnknown;
+    switch( eType )
+    {
+        case FGB_GT_POINT: eOGRType = wkbPoint; break;
+        case FGB_GT_LINESTRING: eOGRType = wkbLineString; break;
+        case FGB_GT_POLYGON: eOGRType = wkbPolygon; break;
+        case FGB_GT_MULTIPOINT: eOGRType = wkbMultiPoint; break;
+        case FGB_GT_MULTILINESTRING: eOGRType = wkbMultiLineString; break;
+        case FGB_GT_MULTIPOLYGON: eOGRType = wkbMultiPolygon; break;
+        case FGB_GT_GEOMETRYCOLLECTION:
+            eOGRType = wkbGeometryCollection; break;
+        default: break;
+    }
+    return OGR_GT_SetModifier(eOGRType, bHasZ, bHasM);
+}
+
+// Returns FGB_GT_UNKNOWN for types without FlatGeobuf equivalent.
+static FGBGeometryType OGRToFGBGeomType( OGRwkbGeometryType eOGRType )
+{
+    switch( wkbFlatten(eOGRType) )
+    {
+        case wkbPoint: return FGB_GT_POINT;
+        case wkbLineString: return FGB_GT_LINESTRING;
+        case wkbPolygon: return FGB_GT_POLYGON;
+        case wkbMultiPoint: return FGB_GT_MULTIPOINT;
+        case wkbMultiLineString: return FGB_GT_MULTILINESTRING;
+        case wkbMultiPolygon: return FGB_GT_MULTIPOLYGON;
+        case wkbGeometryCollection: return FGB_GT_GEOMETRYCOLLECTION;
+        default: return FGB_GT_UNKNOWN;
+    }
+}
+
+/************************************************************************/
+/*                          Little endian helpers                       */
+/************************************************************************/
+
+template<class T> static T ReadLE( const GByte* pabyData )
+{
+    T nVal;
+    memcpy(&nVal, pabyData, sizeof(T));
+#ifdef CPL_MSB
+    std::reverse(reinterpret_cast<GByte*>(&nVal),
+                 reinterpret_cast<GByte*>(&nVal) + sizeof(T));
+#endif
+    return nVal;
+}
+
+template<class T> static void AppendLE( std::vector<GByte>& abyBuffer,
+                                        T nVal )
+{
+#ifdef CPL_MSB
+    std::reverse(reinterpret_cast<GByte*>(&nVal),
+                 reinterpret_cast<GByte*>(&nVal) + sizeof(T));
+#endif
+    const GByte* pabyVal = reinterpret_cast<const GByte*>(&nVal);
+    abyBuffer.insert(abyBuffer.end(), pabyVal, pabyVal + sizeof(T));
+}
+
+static void AppendString( std::vector<GByte>& abyBuffer,
+                          const GByte* pabyData, size_t nSize )
+{
+    AppendLE<GUInt32>(abyBuffer, static_cast<GUInt32>(nSize));
+    abyBuffer.insert(abyBuffer.end(), pabyData, pabyData + nSize);
+}
+
+static void AppendString( std::vector<GByte>& abyBuffer, const char* pszStr )
+{
+    AppendString(abyBuffer, reinterpret_cast<const GByte*>(pszStr),
+                 strlen(pszStr));
+}
+
+/************************************************************************/
+/*                         OGRFlatGeobufLayer()                         */
+/*                                                                      */
+/*      Constructor for reading.                                        */
+/************************************************************************/
+
+OGRFlatGeobufLayer::OGRFlatGeobufLayer( const char* pszName, VSILFILE* fp ) :
+    m_fp(fp)
+{
+    SetDescription(pszName);
+}
+
+/************************************************************************/
+/*                         OGRFlatGeobufLayer()                         */
+/*                                                                      */
+/*      Constructor for writing.                                        */
+/************************************************************************/
+
+OGRFlatGeobufLayer::OGRFlatGeobufLayer( const char* pszName,
+                                        const char* pszFilename,
+                                        VSILFILE* fp,
+                                        OGRSpatialReference* poSRS,
+                                        OGRwkbGeometryType eGType,
+                                        char** papszOptions ) :
+    m_poFeatureDefn(new OGRFeatureDefn(pszName)),
+    m_fp(fp),
+    m_bCreate(true)
+{
+    SetDescription(pszName);
+    m_poFeatureDefn->Reference();
+
+    // Curves are written as their linear approximation.
+    if( eGType != wkbNone )
+    {
+        m_bHasZ = CPL_TO_BOOL(wkbHasZ(eGType));
+        m_bHasM = CPL_TO_BOOL(wkbHasM(eGType));
+        m_eGeomType = OGRToFGBGeomType(OGR_GT_GetLinear(eGType));
+        eGType = FGBToOGRGeomType(m_eGeomType, m_bHasZ, m_bHasM);
+    }
+    m_poFeatureDefn->SetGeomType(eGType);
+    if( poSRS != nullptr && eGType != wkbNone )
+    {
+        m_poSRS = poSRS->Clone();
+        m_poFeatureDefn->GetGeomFieldDefn(0)->SetSpatialRef(m_poSRS);
+    }
+
+    m_bSpatialIndex = CPLFetchBool(papszOptions, "SPATIAL_INDEX", true);
+    m_nIndexNodeSize = static_cast<GUInt16>(std::max(2, std::min(65535,
+        atoi(CSLFetchNameValueDef(papszOptions, "INDEX_NODE_SIZE",
+                    CPLSPrintf("%d", FGB_DEFAULT_INDEX_NODE_SIZE))))));
+
+    if( m_bSpatialIndex )
+    {
+        // Features are staged in a temporary file, as they must be written
+        // in the order of the index once all of them are known.
+        if( STARTS_WITH(pszFilename, "/vsimem/") )
+            m_osTempFilename = CPLSPrintf("/vsimem/fgb_tmp_%p", this);
+        else
+            m_osTempFilename = CPLGenerateTempFilename("fgb_tmp");
+        m_fpTemp = VSIFOpenL(m_osTempFilename, "wb+");
+        if( m_fpTemp == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_FileIO, "Cannot create %s",
+                     m_osTempFilename.c_str());
+        }
+    }
+}
+
+/************************************************************************/
+/*                        ~OGRFlatGeobufLayer()                         */
+/************************************************************************/
+
+OGRFlatGeobufLayer::~OGRFlatGeobufLayer()
+{
+    if( m_fpTemp != nullptr )
+    {
+        VSIFCloseL(m_fpTemp);
+        VSIUnlink(m_osTempFilename);
+    }
+    if( m_poFeatureDefn != nullptr )
+        m_poFeatureDefn->Release();
+    if( m_poSRS != nullptr )
+        m_poSRS->Release();
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::Open( const std::vector<GByte>& abyHeader,
+                               vsi_l_offset nHeaderEnd )
+{
+    FGBTableReader oHeader;
+    if( !oHeader.InitFromRoot(abyHeader.data(), abyHeader.size()) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid FlatGeobuf header");
+        return false;
+    }
+
+    const CPLString osName(oHeader.GetString(FGB_HEADER_NAME));
+    if( !osName.empty() )
+        SetDescription(osName);
+    m_poFeatureDefn = new OGRFeatureDefn(GetDescription());
+    m_poFeatureDefn->Reference();
+
+    const GByte nGeomType = oHeader.GetUInt8(FGB_HEADER_GEOMETRY_TYPE);
+    if( nGeomType > FGB_GT_GEOMETRYCOLLECTION )
+    {
+        // Features of other types are returned without geometry.
+        CPLError(CE_Warning, CPLE_NotSupported,
+                 "Unsupported FlatGeobuf geometry type: %d", nGeomType);
+    }
+    else
+    {
+        m_eGeomType = static_cast<FGBGeometryType>(nGeomType);
+    }
+    m_bHasZ = oHeader.GetUInt8(FGB_HEADER_HAS_Z) != 0;
+    m_bHasM = oHeader.GetUInt8(FGB_HEADER_HAS_M) != 0;
+    m_poFeatureDefn->SetGeomType(
+        FGBToOGRGeomType(m_eGeomType, m_bHasZ, m_bHasM));
+
+    FGBTableReader oCrs;
+    if( oHeader.GetTable(FGB_HEADER_CRS, oCrs) )
+    {
+        m_poSRS = new OGRSpatialReference();
+        const CPLString osWKT(oCrs.GetString(FGB_CRS_WKT));
+        const CPLString osOrg(oCrs.GetString(FGB_CRS_ORG));
+        const int nCode = oCrs.GetInt32(FGB_CRS_CODE);
+        OGRErr eErr = OGRERR_FAILURE;
+        if( !osWKT.empty() )
+            eErr = m_poSRS->SetFromUserInput(osWKT);
+        else if( nCode > 0 && (osOrg.empty() || EQUAL(osOrg, "EPSG")) )
+            eErr = m_poSRS->importFromEPSG(nCode);
+        if( eErr != OGRERR_NONE )
+        {
+            m_poSRS->Release();
+            m_poSRS = nullptr;
+        }
+        else
+        {
+            m_poFeatureDefn->GetGeomFieldDefn(0)->SetSpatialRef(m_poSRS);
+        }
+    }
+
+    const GByte* pabyEnvelope = nullptr;
+    GUInt32 nEnvelopeCount = 0;
+    if( oHeader.GetVector(FGB_HEADER_ENVELOPE, sizeof(double),
+                          pabyEnvelope, nEnvelopeCount) &&
+        nEnvelopeCount >= 4 )
+    {
+        m_bHasExtent = true;
+        m_sExtent.MinX = ReadLE<double>(pabyEnvelope);
+        m_sExtent.MinY = ReadLE<double>(pabyEnvelope + 8);
+        m_sExtent.MaxX = ReadLE<double>(pabyEnvelope + 16);
+        m_sExtent.MaxY = ReadLE<double>(pabyEnvelope + 24);
+    }
+
+    std::vector<FGBTableReader> aoColumns;
+    oHeader.GetTableVector(FGB_HEADER_COLUMNS, aoColumns);
+    for( const auto& oColumn: aoColumns )
+    {
+        const GByte nType = oColumn.GetUInt8(FGB_COLUMN_TYPE);
+        OGRFieldType eType = OFTString;
+        OGRFieldSubType eSubType = OFSTNone;
+        switch( nType )
+        {
+            case FGB_CT_BOOL:
+                eType = OFTInteger; eSubType = OFSTBoolean; break;
+            case FGB_CT_BYTE: case FGB_CT_UBYTE: case FGB_CT_USHORT:
+            case FGB_CT_INT:
+                eType = OFTInteger; break;
+            case FGB_CT_SHORT:
+                eType = OFTInteger; eSubType = OFSTInt16; break;
+            case FGB_CT_UINT: case FGB_CT_LONG: case FGB_CT_ULONG:
+                eType = OFTInteger64; break;
+            case FGB_CT_FLOAT:
+                eType = OFTReal; eSubType = OFSTFloat32; break;
+            case FGB_CT_DOUBLE:
+                eType = OFTReal; break;
+            case FGB_CT_STRING: case FGB_CT_JSON:
+                eType = OFTString; break;
+            case FGB_CT_DATETIME:
+                eType = OFTDateTime; break;
+            case FGB_CT_BINARY:
+                eType = OFTBinary; break;
+            default:
+                CPLError(CE_Failure, CPLE_NotSupported,
+                         "Unsupported FlatGeobuf column type: %d", nType);
+                return false;
+        }
+        OGRFieldDefn oField(oColumn.GetString(FGB_COLUMN_NAME), eType);
+        oField.SetSubType(eSubType);
+        if( eType == OFTReal )
+        {
+            oField.SetWidth(std::max(0,
+                                oColumn.GetInt32(FGB_COLUMN_PRECISION, -1)));
+            oField.SetPrecision(std::max(0,
+                                oColumn.GetInt32(FGB_COLUMN_SCALE, -1)));
+        }
+        else if( eType != OFTDateTime )
+        {
+            oField.SetWidth(std::max(0,
+                                oColumn.GetInt32(FGB_COLUMN_WIDTH, -1)));
+        }
+        oField.SetNullable(oColumn.GetUInt8(FGB_COLUMN_NULLABLE, 1) != 0);
+        m_poFeatureDefn->AddFieldDefn(&oField);
+        m_aeColumnTypes.push_back(static_cast<FGBColumnType>(nType));
+    }
+
+    m_nFeatureCount = oHeader.GetUInt64(FGB_HEADER_FEATURES_COUNT);
+    m_nIndexNodeSize = oHeader.GetUInt16(FGB_HEADER_INDEX_NODE_SIZE,
+                                         FGB_DEFAULT_INDEX_NODE_SIZE);
+    if( m_nFeatureCount > MAX_FEATURE_COUNT || m_nIndexNodeSize == 1 )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid FlatGeobuf header");
+        return false;
+    }
+    m_nIndexOffset = nHeaderEnd;
+    m_nFeaturesOffset = nHeaderEnd;
+    if( HasIndex() )
+        m_nFeaturesOffset += FGBGetIndexSize(m_nFeatureCount,
+                                             m_nIndexNodeSize);
+    return true;
+}
+
+/************************************************************************/
+/*                            ResetReading()                            */
+/************************************************************************/
+
+void OGRFlatGeobufLayer::ResetReading()
+{
+    m_nNextIndex = 0;
+    m_nNextOffset = 0;
+    m_bIndexSearched = false;
+    m_asSearchResults.clear();
+    m_iNextSearchResult = 0;
+}
+
+/************************************************************************/
+/*                            ReadFeature()                             */
+/************************************************************************/
+
+OGRFeature* OGRFlatGeobufLayer::ReadFeature( vsi_l_offset nOffset,
+                                             GIntBig nFID,
+                                             GUInt32* pnSize )
+{
+    GUInt32 nSize = 0;
+    if( VSIFSeekL(m_fp, m_nFeaturesOffset + nOffset, SEEK_SET) != 0 ||
+        VSIFReadL(&nSize, sizeof(nSize), 1, m_fp) != 1 )
+    {
+        // End of file.
+        return nullptr;
+    }
+    CPL_LSBPTR32(&nSize);
+    if( nSize > MAX_FEATURE_SIZE )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Invalid size for feature " CPL_FRMT_GIB ": %u", nFID, nSize);
+        return nullptr;
+    }
+    try
+    {
+        m_abyBuffer.resize(nSize);
+    }
+    catch( const std::exception& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate %u bytes for feature " CPL_FRMT_GIB,
+                 nSize, nFID);
+        return nullptr;
+    }
+    FGBTableReader oFeature;
+    if( VSIFReadL(m_abyBuffer.data(), 1, nSize, m_fp) != nSize ||
+        !oFeature.InitFromRoot(m_abyBuffer.data(), nSize) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Cannot read feature " CPL_FRMT_GIB, nFID);
+        return nullptr;
+    }
+    if( pnSize != nullptr )
+        *pnSize = nSize;
+
+    OGRFeature* poFeature = new OGRFeature(m_poFeatureDefn);
+    poFeature->SetFID(nFID);
+
+    FGBTableReader oGeom;
+    if( oFeature.GetTable(FGB_FEATURE_GEOMETRY, oGeom) )
+    {
+        // The type of each geometry is only relevant when the layer has
+        // no single geometry type.
+        FGBGeometryType eType = m_eGeomType;
+        if( eType == FGB_GT_UNKNOWN )
+            eType = static_cast<FGBGeometryType>(
+                                    oGeom.GetUInt8(FGB_GEOMETRY_TYPE));
+        OGRGeometry* poGeom = ParseGeometry(oGeom, eType, 0);
+        if( poGeom != nullptr )
+        {
+            poGeom->assignSpatialReference(m_poSRS);
+            poFeature->SetGeometryDirectly(poGeom);
+        }
+    }
+
+    const GByte* pabyProperties = nullptr;
+    GUInt32 nPropertiesSize = 0;
+    if( oFeature.GetVector(FGB_FEATURE_PROPERTIES, 1,
+                           pabyProperties, nPropertiesSize) )
+    {
+        ParseProperties(poFeature, pabyProperties, nPropertiesSize);
+    }
+    return poFeature;
+}
+
+/************************************************************************/
+/*                          ParseProperties()                           */
+/************************************************************************/
+
+void OGRFlatGeobufLayer::ParseProperties( OGRFeature* poFeature,
+                                          const GByte* pabyData,
+                                          size_t nSize )
+{
+    size_t nPos = 0;
+    while( nPos < nSize )
+    {
+        if( nSize - nPos < sizeof(GUInt16) )
+            break;
+        const GUInt16 iField = ReadLE<GUInt16>(pabyData + nPos);
+        nPos += sizeof(GUInt16);
+        if( iField >= m_aeColumnTypes.size() )
+            break;
+        const GByte* pabyValue = pabyData + nPos;
+        const size_t nRemaining = nSize - nPos;
+
+        size_t nValueSize = 0;
+        switch( m_aeColumnTypes[iField] )
+        {
+            case FGB_CT_BYTE: case FGB_CT_UBYTE: case FGB_CT_BOOL:
+                nValueSize = 1; break;
+            case FGB_CT_SHORT: case FGB_CT_USHORT:
+                nValueSize = 2; break;
+            case FGB_CT_INT: case FGB_CT_UINT: case FGB_CT_FLOAT:
+                nValueSize = 4; break;
+            case FGB_CT_LONG: case FGB_CT_ULONG: case FGB_CT_DOUBLE:
+                nValueSize = 8; break;
+            default:
+                if( nRemaining < sizeof(GUInt32) )
+                    break;
+                nValueSize = sizeof(GUInt32) + ReadLE<GUInt32>(pabyValue);
+                break;
+        }
+        if( nValueSize == 0 || nValueSize > nRemaining )
+            break;
+        nPos += nValueSize;
+
+        const char* pszStr =
+            reinterpret_cast<const char*>(pabyValue + sizeof(GUInt32));
+        const size_t nStrLen = nValueSize - sizeof(GUInt32);
+        switch( m_aeColumnTypes[iField] )
+        {
+            case FGB_CT_BYTE:
+                poFeature->SetField(iField,
+                    static_cast<int>(static_cast<signed char>(*pabyValue)));
+                break;
+            case FGB_CT_UBYTE:
+                poFeature->SetField(iField, static_cast<int>(*pabyValue));
+                break;
+            case FGB_CT_BOOL:
+                poFeature->SetField(iField, *pabyValue != 0 ? 1 : 0);
+                break;
+            case FGB_CT_SHORT:
+                poFeature->SetField(iField, static_cast<int>(
+                                        ReadLE<GInt16>(pabyValue)));
+                break;
+            case FGB_CT_USHORT:
+                poFeature->SetField(iField, static_cast<int>(
+                                        ReadLE<GUInt16>(pabyValue)));
+                break;
+            case FGB_CT_INT:
+                poFeature->SetField(iField, ReadLE<GInt32>(pabyValue));
+                break;
+            case FGB_CT_UINT:
+                poFeature->SetField(iField, static_cast<GIntBig>(
+                                        ReadLE<GUInt32>(pabyValue)));
+                break;
+            case FGB_CT_LONG:
+                poFeature->SetField(iField, ReadLE<GIntBig>(pabyValue));
+                break;
+            case FGB_CT_ULONG:
+                poFeature->SetField(iField, static_cast<GIntBig>(
+                                        ReadLE<GUIntBig>(pabyValue)));
+                break;
+            case FGB_CT_FLOAT:
+                poFeature->SetField(iField, static_cast<double>(
+                                        ReadLE<float>(pabyValue)));
+                break;
+            case FGB_CT_DOUBLE:
+                poFeature->SetField(iField, ReadLE<double>(pabyValue));
+                break;
+            case FGB_CT_STRING:
+            case FGB_CT_JSON:
+                poFeature->SetField(iField,
+                                    std::string(pszStr, nStrLen).c_str());
+                break;
+            case FGB_CT_DATETIME:
+            {
+                const std::string osValue(pszStr, nStrLen);
+                OGRField sField;
+                if( OGRParseXMLDateTime(osValue.c_str(), &sField) )
+                    poFeature->SetField(iField, &sField);
+                else
+                    poFeature->SetField(iField, osValue.c_str());
+                break;
+            }
+            case FGB_CT_BINARY:
+                poFeature->SetField(iField, static_cast<int>(nStrLen),
+                    reinterpret_cast<GByte*>(const_cast<char*>(pszStr)));
+                break;
+        }
+    }
+    if( nPos != nSize )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Invalid properties for feature " CPL_FRMT_GIB,
+                 poFeature->GetFID());
+    }
+}
+
+/************************************************************************/
+/*                           ParseGeometry()                            */
+/************************************************************************/
+
+OGRGeometry* OGRFlatGeobufLayer::ParseGeometry( const FGBTableReader& oGeom,
+                                                FGBGeometryType eType,
+                                                int nRecLevel )
+{
+    if( nRecLevel == MAX_GEOMETRY_NESTING )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Too many nested geometries");
+        return nullptr;
+    }
+
+    if( eType == FGB_GT_MULTIPOLYGON || eType == FGB_GT_GEOMETRYCOLLECTION )
+    {
+        std::vector<FGBTableReader> aoParts;
+        oGeom.GetTableVector(FGB_GEOMETRY_PARTS, aoParts);
+        OGRGeometryCollection* poColl = eType == FGB_GT_MULTIPOLYGON ?
+            new OGRMultiPolygon() : new OGRGeometryCollection();
+        for( const auto& oPart: aoParts )
+        {
+            const FGBGeometryType ePartType =
+                eType == FGB_GT_MULTIPOLYGON ? FGB_GT_POLYGON :
+                static_cast<FGBGeometryType>(
+                    oPart.GetUInt8(FGB_GEOMETRY_TYPE));
+            OGRGeometry* poPart = ParseGeometry(oPart, ePartType,
+                                                nRecLevel + 1);
+            if( poPart == nullptr ||
+                poColl->addGeometryDirectly(poPart) != OGRERR_NONE )
+            {
+                delete poPart;
+                delete poColl;
+                return nullptr;
+            }
+        }
+        return poColl;
+    }
+
+    const GByte* pabyXY = nullptr;
+    const GByte* pabyZ = nullptr;
+    const GByte* pabyM = nullptr;
+    const GByte* pabyEnds = nullptr;
+    GUInt32 nXYCount = 0;
+    GUInt32 nZCount = 0;
+    GUInt32 nMCount = 0;
+    GUInt32 nEndsCount = 0;
+    // Empty geometries have no coordinate vectors, but vectors that are
+    // present must be valid.
+    if( (oGeom.HasField(FGB_GEOMETRY_XY) &&
+         !oGeom.GetVector(FGB_GEOMETRY_XY, sizeof(double),
+                          pabyXY, nXYCount)) ||
+        (oGeom.HasField(FGB_GEOMETRY_Z) &&
+         !oGeom.GetVector(FGB_GEOMETRY_Z, sizeof(double), pabyZ, nZCount)) ||
+        (oGeom.HasField(FGB_GEOMETRY_M) &&
+         !oGeom.GetVector(FGB_GEOMETRY_M, sizeof(double), pabyM, nMCount)) ||
+        (oGeom.HasField(FGB_GEOMETRY_ENDS) &&
+         !oGeom.GetVector(FGB_GEOMETRY_ENDS, sizeof(GUInt32),
+                          pabyEnds, nEndsCount)) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid geometry");
+        return nullptr;
+    }
+    const GUInt32 nPoints = nXYCount / 2;
+    if( (nZCount != 0 && nZCount != nPoints) ||
+        (nMCount != 0 && nMCount != nPoints) ||
+        (nXYCount % 2) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid geometry");
+        return nullptr;
+    }
+    if( nZCount == 0 )
+        pabyZ = nullptr;
+    if( nMCount == 0 )
+        pabyM = nullptr;
+
+    // Parts of polygons and multilinestrings, as end positions in points.
+    std::vector<GUInt32> anEnds;
+    if( nEndsCount > 0 )
+    {
+        GUInt32 nLastEnd = 0;
+        for( GUInt32 i = 0; i < nEndsCount; i++ )
+        {
+            const GUInt32 nEnd = ReadLE<GUInt32>(pabyEnds + i * 4);
+            if( nEnd < nLastEnd || nEnd > nPoints )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "Invalid geometry");
+                return nullptr;
+            }
+            anEnds.push_back(nEnd);
+            nLastEnd = nEnd;
+        }
+    }
+    else if( nPoints > 0 )
+    {
+        anEnds.push_back(nPoints);
+    }
+
+    const auto ReadCurve = [=](OGRSimpleCurve* poCurve,
+                               GUInt32 nStart, GUInt32 nEnd)
+    {
+        poCurve->setNumPoints(static_cast<int>(nEnd - nStart), FALSE);
+        for( GUInt32 i = nStart; i < nEnd; i++ )
+        {
+            const int iPoint = static_cast<int>(i - nStart);
+            const double dfX = ReadLE<double>(pabyXY + i * 16);
+            const double dfY = ReadLE<double>(pabyXY + i * 16 + 8);
+            if( pabyZ != nullptr && pabyM != nullptr )
+                poCurve->setPoint(iPoint, dfX, dfY,
+                                  ReadLE<double>(pabyZ + i * 8),
+                                  ReadLE<double>(pabyM + i * 8));
+            else if( pabyZ != nullptr )
+                poCurve->setPoint(iPoint, dfX, dfY,
+                                  ReadLE<double>(pabyZ + i * 8));
+            else if( pabyM != nullptr )
+                poCurve->setPointM(iPoint, dfX, dfY,
+                                   ReadLE<double>(pabyM + i * 8));
+            else
+                poCurve->setPoint(iPoint, dfX, dfY);
+        }
+    };
+
+    switch( eType )
+    {
+        case FGB_GT_POINT:
+        {
+            OGRPoint* poPoint = new OGRPoint();
+            if( nPoints > 0 )
+            {
+                poPoint->setX(ReadLE<double>(pabyXY));
+                poPoint->setY(ReadLE<double>(pabyXY + 8));
+                if( pabyZ != nullptr )
+                    poPoint->setZ(ReadLE<double>(pabyZ));
+                if( pabyM != nullptr )
+                    poPoint->setM(ReadLE<double>(pabyM));
+            }
+            return poPoint;
+        }
+
+        case FGB_GT_MULTIPOINT:
+        {
+            OGRMultiPoint* poMP = new OGRMultiPoint();
+            for( GUInt32 i = 0; i < nPoints; i++ )
+            {
+                OGRPoint* poPoint = new OGRPoint(
+                    ReadLE<double>(pabyXY + i * 16),
+                    ReadLE<double>(pabyXY + i * 16 + 8));
+                if( pabyZ != nullptr )
+                    poPoint->setZ(ReadLE<double>(pabyZ + i * 8));
+                if( pabyM != nullptr )
+                    poPoint->setM(ReadLE<double>(pabyM + i * 8));
+                poMP->addGeometryDirectly(poPoint);
+            }
+            return poMP;
+        }
+
+        case FGB_GT_LINESTRING:
+        {
+            OGRLineString* poLS = new OGRLineString();
+            ReadCurve(poLS, 0, nPoints);
+            return poLS;
+        }
+
+        case FGB_GT_POLYGON:
+        case FGB_GT_MULTILINESTRING:
+        {
+            OGRPolygon* poPoly = nullptr;
+            OGRMultiLineString* poMLS = nullptr;
+            if( eType == FGB_GT_POLYGON )
+                poPoly = new OGRPolygon();
+            else
+                poMLS = new OGRMultiLineString();
+            GUInt32 nStart = 0;
+            for( GUInt32 nEnd: anEnds )
+            {
+                if( poPoly != nullptr )
+                {
+                    OGRLinearRing* poRing = new OGRLinearRing();
+                    ReadCurve(poRing, nStart, nEnd);
+                    poPoly->addRingDirectly(poRing);
+                }
+                else
+                {
+                    OGRLineString* poLS = new OGRLineString();
+                    ReadCurve(poLS, nStart, nEnd);
+                    poMLS->addGeometryDirectly(poLS);
+                }
+                nStart = nEnd;
+            }
+            if( poPoly != nullptr )
+                return poPoly;
+            return poMLS;
+        }
+
+        default:
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Unsupported FlatGeobuf geometry type: %d", eType);
+            return nullptr;
+    }
+}
+
+/************************************************************************/
+/*                         GetNextRawFeature()                          */
+/************************************************************************/
+
+OGRFeature* OGRFlatGeobufLayer::GetNextRawFeature()
+{
+    if( m_bCreate )
+        return nullptr;
+
+    // With a spatial filter, only the features of the leaves of the index
+    // intersecting it are read.
+    if( m_poFilterGeom != nullptr && HasIndex() )
+    {
+        if( !m_bIndexSearched )
+        {
+            m_bIndexSearched = true;
+            m_iNextSearchResult = 0;
+            if( !FGBSearchIndex(m_fp, m_nIndexOffset, m_nFeatureCount,
+                                m_nIndexNodeSize, m_sFilterEnvelope,
+                                m_asSearchResults) )
+            {
+                m_asSearchResults.clear();
+                return nullptr;
+            }
+        }
+        if( m_iNextSearchResult >= m_asSearchResults.size() )
+            return nullptr;
+        const FGBSearchResult& sResult =
+            m_asSearchResults[m_iNextSearchResult++];
+        return ReadFeature(sResult.nOffset,
+                           static_cast<GIntBig>(sResult.nIndex), nullptr);
+    }
+
+    if( m_nFeatureCount > 0 && m_nNextIndex >= m_nFeatureCount )
+        return nullptr;
+    GUInt32 nSize = 0;
+    OGRFeature* poFeature = ReadFeature(
+        m_nNextOffset, static_cast<GIntBig>(m_nNextIndex), &nSize);
+    if( poFeature != nullptr )
+    {
+        m_nNextOffset += sizeof(GUInt32) + nSize;
+        m_nNextIndex++;
+    }
+    return poFeature;
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature* OGRFlatGeobufLayer::GetNextFeature()
+{
+    while( true )
+    {
+        OGRFeature* poFeature = GetNextRawFeature();
+        if( poFeature == nullptr )
+            return nullptr;
+
+        if( (m_poFilterGeom == nullptr ||
+             FilterGeometry(poFeature->GetGeometryRef())) &&
+            (m_poAttrQuery == nullptr ||
+             m_poAttrQuery->Evaluate(poFeature)) )
+        {
+            return poFeature;
+        }
+        delete poFeature;
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+OGRFeature* OGRFlatGeobufLayer::GetFeature( GIntBig nFID )
+{
+    if( m_bCreate )
+        return nullptr;
+    if( !HasIndex() )
+        return OGRLayer::GetFeature(nFID);
+    if( nFID < 0 || static_cast<GUIntBig>(nFID) >= m_nFeatureCount )
+        return nullptr;
+
+    // The leaf of rank N of the index points to the feature of rank N.
+    FGBNodeItem sLeaf;
+    if( !FGBReadLeaf(m_fp, m_nIndexOffset, m_nFeatureCount,
+                     m_nIndexNodeSize, static_cast<GUIntBig>(nFID), sLeaf) )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read spatial index");
+        return nullptr;
+    }
+    return ReadFeature(sLeaf.nOffset, nFID, nullptr);
+}
+
+/************************************************************************/
+/*                          GetFeatureCount()                           */
+/************************************************************************/
+
+GIntBig OGRFlatGeobufLayer::GetFeatureCount( int bForce )
+{
+    if( m_bCreate )
+        return static_cast<GIntBig>(m_nWrittenCount);
+    if( m_poFilterGeom == nullptr && m_poAttrQuery == nullptr && HasIndex() )
+        return static_cast<GIntBig>(m_nFeatureCount);
+    return OGRLayer::GetFeatureCount(bForce);
+}
+
+/************************************************************************/
+/*                             GetExtent()                              */
+/************************************************************************/
+
+OGRErr OGRFlatGeobufLayer::GetExtent( OGREnvelope* psExtent, int bForce )
+{
+    if( m_bHasExtent )
+    {
+        *psExtent = m_sExtent;
+        return OGRERR_NONE;
+    }
+    if( m_bCreate )
+        return OGRERR_FAILURE;
+    return OGRLayer::GetExtent(psExtent, bForce);
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRFlatGeobufLayer::TestCapability( const char* pszCap )
+{
+    if( EQUAL(pszCap, OLCFastFeatureCount) )
+        return !m_bCreate && HasIndex() &&
+               m_poFilterGeom == nullptr && m_poAttrQuery == nullptr;
+    if( EQUAL(pszCap, OLCFastGetExtent) )
+        return m_bHasExtent;
+    if( EQUAL(pszCap, OLCFastSpatialFilter) ||
+        EQUAL(pszCap, OLCRandomRead) )
+        return !m_bCreate && HasIndex();
+    if( EQUAL(pszCap, OLCStringsAsUTF8) ||
+        EQUAL(pszCap, OLCMeasuredGeometries) )
+        return TRUE;
+    if( EQUAL(pszCap, OLCSequentialWrite) )
+        return m_bCreate;
+    if( EQUAL(pszCap, OLCCreateField) )
+        return m_bCreate && !m_bHeaderWritten;
+    return FALSE;
+}
+
+/************************************************************************/
+/*                            CreateField()                             */
+/************************************************************************/
+
+OGRErr OGRFlatGeobufLayer::CreateField( OGRFieldDefn* poField,
+                                        int bApproxOK )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateField() not supported on read-only layer");
+        return OGRERR_FAILURE;
+    }
+    if( m_bHeaderWritten )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Cannot create fields once features have been written "
+                 "with SPATIAL_INDEX=NO");
+        return OGRERR_FAILURE;
+    }
+    if( m_poFeatureDefn->GetFieldCount() >= 65536 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Too many fields");
+        return OGRERR_FAILURE;
+    }
+
+    OGRFieldDefn oField(poField);
+    FGBColumnType eColumnType = FGB_CT_STRING;
+    switch( poField->GetType() )
+    {
+        case OFTInteger:
+            if( poField->GetSubType() == OFSTBoolean )
+                eColumnType = FGB_CT_BOOL;
+            else if( poField->GetSubType() == OFSTInt16 )
+                eColumnType = FGB_CT_SHORT;
+            else
+                eColumnType = FGB_CT_INT;
+            break;
+        case OFTInteger64:
+            eColumnType = FGB_CT_LONG;
+            break;
+        case OFTReal:
+            eColumnType = poField->GetSubType() == OFSTFloat32 ?
+                                            FGB_CT_FLOAT : FGB_CT_DOUBLE;
+            break;
+        case OFTString:
+            eColumnType = FGB_CT_STRING;
+            break;
+        case OFTDate:
+        case OFTDateTime:
+            eColumnType = FGB_CT_DATETIME;
+            break;
+        case OFTBinary:
+            eColumnType = FGB_CT_BINARY;
+            break;
+        default:
+            if( !bApproxOK )
+            {
+                CPLError(CE_Failure, CPLE_NotSupported,
+                         "Field %s of type %s not supported",
+                         poField->GetNameRef(),
+                         OGRFieldDefn::GetFieldTypeName(poField->GetType()));
+                return OGRERR_FAILURE;
+            }
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "Field %s of type %s written as String",
+                     poField->GetNameRef(),
+                     OGRFieldDefn::GetFieldTypeName(poField->GetType()));
+            oField.SetType(OFTString);
+            oField.SetSubType(OFSTNone);
+            break;
+    }
+    m_poFeatureDefn->AddFieldDefn(&oField);
+    m_aeColumnTypes.push_back(eColumnType);
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                           BuildGeometry()                            */
+/************************************************************************/
+
+FGBBlob OGRFlatGeobufLayer::BuildGeometry( const OGRGeometry* poGeom )
+{
+    const OGRwkbGeometryType eFlatType = wkbFlatten(poGeom->getGeometryType());
+    FGBTableWriter oGeom;
+    std::vector<double> adfXY;
+    std::vector<double> adfZ;
+    std::vector<double> adfM;
+    std::vector<GUInt32> anEnds;
+
+    const auto AddPoint = [&](double dfX, double dfY, double dfZ, double dfM)
+    {
+        adfXY.push_back(dfX);
+        adfXY.push_back(dfY);
+        if( m_bHasZ )
+            adfZ.push_back(dfZ);
+        if( m_bHasM )
+            adfM.push_back(dfM);
+    };
+    const auto AddCurve = [&](const OGRSimpleCurve* poCurve)
+    {
+        for( int i = 0; i < poCurve->getNumPoints(); i++ )
+            AddPoint(poCurve->getX(i), poCurve->getY(i),
+                     poCurve->getZ(i), poCurve->getM(i));
+        anEnds.push_back(static_cast<GUInt32>(adfXY.size() / 2));
+    };
+
+    switch( eFlatType )
+    {
+        case wkbPoint:
+        {
+            const OGRPoint* poPoint = static_cast<const OGRPoint*>(poGeom);
+            if( !poPoint->IsEmpty() )
+                AddPoint(poPoint->getX(), poPoint->getY(),
+                         poPoint->getZ(), poPoint->getM());
+            break;
+        }
+        case wkbMultiPoint:
+        {
+            const OGRMultiPoint* poMP =
+                static_cast<const OGRMultiPoint*>(poGeom);
+            for( int i = 0; i < poMP->getNumGeometries(); i++ )
+            {
+                const OGRPoint* poPoint =
+                    static_cast<const OGRPoint*>(poMP->getGeometryRef(i));
+                if( !poPoint->IsEmpty() )
+                    AddPoint(poPoint->getX(), poPoint->getY(),
+                             poPoint->getZ(), poPoint->getM());
+            }
+            break;
+        }
+        case wkbLineString:
+            AddCurve(static_cast<const OGRLineString*>(poGeom));
+            break;
+        case wkbPolygon:
+        {
+            const OGRPolygon* poPoly = static_cast<const OGRPolygon*>(poGeom);
+            if( poPoly->getExteriorRing() != nullptr )
+                AddCurve(poPoly->getExteriorRing());
+            for( int i = 0; i < poPoly->getNumInteriorRings(); i++ )
+                AddCurve(poPoly->getInteriorRing(i));
+            break;
+        }
+        case wkbMultiLineString:
+        {
+            const OGRMultiLineString* poMLS =
+                static_cast<const OGRMultiLineString*>(poGeom);
+            for( int i = 0; i < poMLS->getNumGeometries(); i++ )
+                AddCurve(static_cast<const OGRLineString*>(
+                                                poMLS->getGeometryRef(i)));
+            break;
+        }
+        default:
+        {
+            const OGRGeometryCollection* poColl =
+                static_cast<const OGRGeometryCollection*>(poGeom);
+            std::vector<FGBBlob> aoParts;
+            for( int i = 0; i < poColl->getNumGeometries(); i++ )
+                aoParts.emplace_back(BuildGeometry(poColl->getGeometryRef(i)));
+            oGeom.AddChild(FGB_GEOMETRY_PARTS,
+                           FGBCreateTableVector(aoParts));
+            break;
+        }
+    }
+
+    if( anEnds.size() > 1 )
+        oGeom.AddChild(FGB_GEOMETRY_ENDS,
+                       FGBCreateVector(anEnds.data(), anEnds.size(),
+                                       sizeof(GUInt32)));
+    if( !adfXY.empty() )
+    {
+        oGeom.AddChild(FGB_GEOMETRY_XY,
+                       FGBCreateVector(adfXY.data(), adfXY.size(),
+                                       sizeof(double)));
+        if( m_bHasZ )
+            oGeom.AddChild(FGB_GEOMETRY_Z,
+                           FGBCreateVector(adfZ.data(), adfZ.size(),
+                                           sizeof(double)));
+        if( m_bHasM )
+            oGeom.AddChild(FGB_GEOMETRY_M,
+                           FGBCreateVector(adfM.data(), adfM.size(),
+                                           sizeof(double)));
+    }
+    oGeom.AddUInt8(FGB_GEOMETRY_TYPE,
+                   static_cast<GByte>(OGRToFGBGeomType(eFlatType)));
+    return oGeom.Finish();
+}
+
+/************************************************************************/
+/*                           ICreateFeature()                           */
+/************************************************************************/
+
+OGRErr OGRFlatGeobufLayer::ICreateFeature( OGRFeature* poFeature )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateFeature() not supported on read-only layer");
+        return OGRERR_FAILURE;
+    }
+    if( m_bSpatialIndex && m_fpTemp == nullptr )
+        return OGRERR_FAILURE;
+
+    FGBTableWriter oFeature;
+    FGBNodeItem sBounds;
+    sBounds.dfMinX = std::numeric_limits<double>::infinity();
+    sBounds.dfMinY = std::numeric_limits<double>::infinity();
+    sBounds.dfMaxX = -std::numeric_limits<double>::infinity();
+    sBounds.dfMaxY = -std::numeric_limits<double>::infinity();
+    sBounds.nOffset = 0;
+
+    const OGRGeometry* poGeom = poFeature->GetGeometryRef();
+    std::unique_ptr<OGRGeometry> poLinearGeom;
+    if( poGeom != nullptr && poGeom->hasCurveGeometry() )
+    {
+        poLinearGeom.reset(poGeom->getLinearGeometry());
+        poGeom = poLinearGeom.get();
+    }
+    if( poGeom != nullptr )
+    {
+        const FGBGeometryType eType =
+            OGRToFGBGeomType(poGeom->getGeometryType());
+        if( eType == FGB_GT_UNKNOWN )
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Geometry type %s not supported",
+                     OGRGeometryTypeToName(poGeom->getGeometryType()));
+            return OGRERR_FAILURE;
+        }
+        if( m_eGeomType != FGB_GT_UNKNOWN && eType != m_eGeomType )
+        {
+            if( m_bHeaderWritten || !m_bSpatialIndex )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Geometry type %s not compatible with layer type",
+                         OGRGeometryTypeToName(poGeom->getGeometryType()));
+                return OGRERR_FAILURE;
+            }
+            // Each geometry records its type, so the layer type can still
+            // be relaxed as the header is only written at the end.
+            CPLDebug("FlatGeobuf", "Mixed geometry types: writing layer "
+                     "geometry type as Unknown");
+            m_eGeomType = FGB_GT_UNKNOWN;
+        }
+        // Layers of unknown type get the dimensions of their geometries,
+        // as long as the header is not written.
+        if( m_bSpatialIndex &&
+            wkbFlatten(m_poFeatureDefn->GetGeomType()) == wkbUnknown )
+        {
+            m_bHasZ |= CPL_TO_BOOL(poGeom->Is3D());
+            m_bHasM |= CPL_TO_BOOL(poGeom->IsMeasured());
+        }
+        oFeature.AddChild(FGB_FEATURE_GEOMETRY, BuildGeometry(poGeom));
+        if( !poGeom->IsEmpty() )
+        {
+            OGREnvelope sEnvelope;
+            poGeom->getEnvelope(&sEnvelope);
+            sBounds.dfMinX = sEnvelope.MinX;
+            sBounds.dfMinY = sEnvelope.MinY;
+            sBounds.dfMaxX = sEnvelope.MaxX;
+            sBounds.dfMaxY = sEnvelope.MaxY;
+        }
+    }
+
+    std::vector<GByte> abyProperties;
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( !poFeature->IsFieldSetAndNotNull(i) )
+            continue;
+        AppendLE<GUInt16>(abyProperties, static_cast<GUInt16>(i));
+        switch( m_aeColumnTypes[i] )
+        {
+            case FGB_CT_BOOL:
+                abyProperties.push_back(
+                    poFeature->GetFieldAsInteger(i) != 0 ? 1 : 0);
+                break;
+            case FGB_CT_SHORT:
+                AppendLE<GInt16>(abyProperties, static_cast<GInt16>(
+                                        poFeature->GetFieldAsInteger(i)));
+                break;
+            case FGB_CT_INT:
+                AppendLE<GInt32>(abyProperties,
+                                 poFeature->GetFieldAsInteger(i));
+                break;
+            case FGB_CT_LONG:
+                AppendLE<GIntBig>(abyProperties,
+                                  poFeature->GetFieldAsInteger64(i));
+                break;
+            case FGB_CT_FLOAT:
+                AppendLE<float>(abyProperties, static_cast<float>(
+                                        poFeature->GetFieldAsDouble(i)));
+                break;
+            case FGB_CT_DOUBLE:
+                AppendLE<double>(abyProperties,
+                                 poFeature->GetFieldAsDouble(i));
+                break;
+            case FGB_CT_DATETIME:
+            {
+                if( m_poFeatureDefn->GetFieldDefn(i)->GetType() == OFTDate )
+                {
+                    const OGRField* psField = poFeature->GetRawFieldRef(i);
+                    AppendString(abyProperties,
+                                 CPLSPrintf("%04d-%02d-%02d",
+                                            psField->Date.Year,
+                                            psField->Date.Month,
+                                            psField->Date.Day));
+                }
+                else
+                {
+                    char* pszDateTime =
+                        OGRGetXMLDateTime(poFeature->GetRawFieldRef(i));
+                    AppendString(abyProperties, pszDateTime);
+                    CPLFree(pszDateTime);
+                }
+                break;
+            }
+            case FGB_CT_BINARY:
+            {
+                int nCount = 0;
+                const GByte* pabyData =
+                    poFeature->GetFieldAsBinary(i, &nCount);
+                AppendString(abyProperties, pabyData, nCount);
+                break;
+            }
+            default:
+                AppendString(abyProperties, poFeature->GetFieldAsString(i));
+                break;
+        }
+    }
+    if( !abyProperties.empty() )
+        oFeature.AddChild(FGB_FEATURE_PROPERTIES,
+                          FGBCreateVector(abyProperties.data(),
+                                          abyProperties.size(), 1));
+
+    const std::vector<GByte> abyFeature =
+        FGBFinishSizePrefixed(oFeature.Finish());
+    if( abyFeature.size() - sizeof(GUInt32) > MAX_FEATURE_SIZE )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Feature too large");
+        return OGRERR_FAILURE;
+    }
+
+    if( m_bSpatialIndex )
+    {
+        if( VSIFWriteL(abyFeature.data(), abyFeature.size(), 1,
+                       m_fpTemp) != 1 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Cannot write to temporary file");
+            return OGRERR_FAILURE;
+        }
+        WrittenFeature sWritten;
+        sWritten.nOffset = m_nTempSize;
+        sWritten.nSize = static_cast<GUInt32>(abyFeature.size());
+        sWritten.sBounds = sBounds;
+        m_asWrittenFeatures.push_back(sWritten);
+        m_nTempSize += abyFeature.size();
+    }
+    else
+    {
+        // Streaming: the feature count and extent are left unknown.
+        if( !m_bHeaderWritten && !WriteHeader(0, 0, nullptr) )
+            return OGRERR_FAILURE;
+        if( VSIFWriteL(abyFeature.data(), abyFeature.size(), 1, m_fp) != 1 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO, "Cannot write feature");
+            return OGRERR_FAILURE;
+        }
+    }
+
+    poFeature->SetFID(static_cast<GIntBig>(m_nWrittenCount));
+    m_nWrittenCount++;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            BuildHeader()                             */
+/************************************************************************/
+
+std::vector<GByte> OGRFlatGeobufLayer::BuildHeader(
+                                        GUIntBig nFeatureCount,
+                                        GUInt16 nIndexNodeSize,
+                                        const OGREnvelope* psExtent )
+{
+    FGBTableWriter oHeader;
+    oHeader.AddChild(FGB_HEADER_NAME,
+                     FGBCreateString(m_poFeatureDefn->GetName()));
+    if( psExtent != nullptr )
+    {
+        const double adfEnvelope[4] = { psExtent->MinX, psExtent->MinY,
+                                        psExtent->MaxX, psExtent->MaxY };
+        oHeader.AddChild(FGB_HEADER_ENVELOPE,
+                         FGBCreateVector(adfEnvelope, 4, sizeof(double)));
+    }
+    oHeader.AddUInt8(FGB_HEADER_GEOMETRY_TYPE,
+                     static_cast<GByte>(m_eGeomType));
+    if( m_bHasZ )
+        oHeader.AddUInt8(FGB_HEADER_HAS_Z, 1);
+    if( m_bHasM )
+        oHeader.AddUInt8(FGB_HEADER_HAS_M, 1);
+
+    std::vector<FGBBlob> aoColumns;
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        OGRFieldDefn* poField = m_poFeatureDefn->GetFieldDefn(i);
+        FGBTableWriter oColumn;
+        oColumn.AddChild(FGB_COLUMN_NAME,
+                         FGBCreateString(poField->GetNameRef()));
+        oColumn.AddUInt8(FGB_COLUMN_TYPE,
+                         static_cast<GByte>(m_aeColumnTypes[i]));
+        if( poField->GetType() == OFTReal )
+        {
+            if( poField->GetWidth() > 0 )
+                oColumn.AddInt32(FGB_COLUMN_PRECISION, poField->GetWidth());
+            if( poField->GetPrecision() > 0 )
+                oColumn.AddInt32(FGB_COLUMN_SCALE, poField->GetPrecision());
+        }
+        else if( poField->GetWidth() > 0 )
+        {
+            oColumn.AddInt32(FGB_COLUMN_WIDTH, poField->GetWidth());
+        }
+        if( !poField->IsNullable() )
+            oColumn.AddUInt8(FGB_COLUMN_NULLABLE, 0);
+        aoColumns.emplace_back(oColumn.Finish());
+    }
+    if( !aoColumns.empty() )
+        oHeader.AddChild(FGB_HEADER_COLUMNS,
+                         FGBCreateTableVector(aoColumns));
+
+    oHeader.AddUInt64(FGB_HEADER_FEATURES_COUNT, nFeatureCount);
+    oHeader.AddUInt16(FGB_HEADER_INDEX_NODE_SIZE, nIndexNodeSize);
+
+    if( m_poSRS != nullptr )
+    {
+        FGBTableWriter oCrs;
+        const char* pszAuthName = m_poSRS->GetAuthorityName(nullptr);
+        const char* pszAuthCode = m_poSRS->GetAuthorityCode(nullptr);
+        if( pszAuthName != nullptr && pszAuthCode != nullptr &&
+            EQUAL(pszAuthName, "EPSG") )
+        {
+            oCrs.AddChild(FGB_CRS_ORG, FGBCreateString("EPSG"));
+            oCrs.AddInt32(FGB_CRS_CODE, atoi(pszAuthCode));
+        }
+        char* pszWKT = nullptr;
+        if( m_poSRS->exportToWkt(&pszWKT) == OGRERR_NONE && pszWKT )
+            oCrs.AddChild(FGB_CRS_WKT, FGBCreateString(pszWKT));
+        CPLFree(pszWKT);
+        oHeader.AddChild(FGB_HEADER_CRS, oCrs.Finish());
+    }
+
+    return FGBFinishSizePrefixed(oHeader.Finish());
+}
+
+/************************************************************************/
+/*                            WriteHeader()                             */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::WriteHeader( GUIntBig nFeatureCount,
+                                      GUInt16 nIndexNodeSize,
+                                      const OGREnvelope* psExtent )
+{
+    m_bHeaderWritten = true;
+    const std::vector<GByte> abyHeader =
+        BuildHeader(nFeatureCount, nIndexNodeSize, psExtent);
+    if( VSIFWriteL(FGB_MAGIC, sizeof(FGB_MAGIC), 1, m_fp) != 1 ||
+        VSIFWriteL(abyHeader.data(), abyHeader.size(), 1, m_fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write header");
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           FinishCreation()                           */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::FinishCreation()
+{
+    if( !m_bCreate )
+        return true;
+    m_bCreate = false;
+
+    if( !m_bSpatialIndex )
+        return m_bHeaderWritten || WriteHeader(0, 0, nullptr);
+    if( m_fpTemp == nullptr )
+        return false;
+
+    const size_t nFeatures = m_asWrittenFeatures.size();
+    bool bHasExtent = false;
+    OGREnvelope sExtent;
+    for( const auto& sWritten: m_asWrittenFeatures )
+    {
+        const FGBNodeItem& sBounds = sWritten.sBounds;
+        if( sBounds.dfMinX > sBounds.dfMaxX )
+            continue;
+        OGREnvelope sEnvelope;
+        sEnvelope.MinX = sBounds.dfMinX;
+        sEnvelope.MinY = sBounds.dfMinY;
+        sEnvelope.MaxX = sBounds.dfMaxX;
+        sEnvelope.MaxY = sBounds.dfMaxY;
+        sExtent.Merge(sEnvelope);
+        bHasExtent = true;
+    }
+
+    // Sort features along the Hilbert curve of the centers of their
+    // bounding boxes, features without geometry being last.
+    std::vector<GUInt32> anCodes(nFeatures);
+    for( size_t i = 0; i < nFeatures; i++ )
+    {
+        const FGBNodeItem& sBounds = m_asWrittenFeatures[i].sBounds;
+        if( sBounds.dfMinX <= sBounds.dfMaxX )
+            anCodes[i] = OGRHilbertCode(sExtent,
+                                (sBounds.dfMinX + sBounds.dfMaxX) / 2,
+                                (sBounds.dfMinY + sBounds.dfMaxY) / 2);
+    }
+    std::vector<size_t> anOrder(nFeatures);
+    std::iota(anOrder.begin(), anOrder.end(), 0);
+    std::stable_sort(anOrder.begin(), anOrder.end(),
+        [this, &anCodes](size_t a, size_t b)
+        {
+            const bool bEmptyA = m_asWrittenFeatures[a].sBounds.dfMinX >
+                                 m_asWrittenFeatures[a].sBounds.dfMaxX;
+            const bool bEmptyB = m_asWrittenFeatures[b].sBounds.dfMinX >
+                                 m_asWrittenFeatures[b].sBounds.dfMaxX;
+            if( bEmptyA != bEmptyB )
+                return bEmptyB;
+            return anCodes[a] < anCodes[b];
+        });
+
+    std::vector<FGBNodeItem> asLeaves(nFeatures);
+    GUIntBig nOffset = 0;
+    for( size_t i = 0; i < nFeatures; i++ )
+    {
+        const WrittenFeature& sWritten = m_asWrittenFeatures[anOrder[i]];
+        asLeaves[i] = sWritten.sBounds;
+        asLeaves[i].nOffset = nOffset;
+        nOffset += sWritten.nSize;
+    }
+
+    if( !WriteHeader(nFeatures, m_nIndexNodeSize,
+                     bHasExtent ? &sExtent : nullptr) ||
+        !FGBWriteIndex(m_fp, asLeaves, m_nIndexNodeSize) )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write spatial index");
+        return false;
+    }
+    asLeaves.clear();
+
+    for( size_t i = 0; i < nFeatures; i++ )
+    {
+        const WrittenFeature& sWritten = m_asWrittenFeatures[anOrder[i]];
+        m_abyBuffer.resize(sWritten.nSize);
+        if( VSIFSeekL(m_fpTemp, sWritten.nOffset, SEEK_SET) != 0 ||
+            VSIFReadL(m_abyBuffer.data(), sWritten.nSize, 1, m_fpTemp) != 1 ||
+            VSIFWriteL(m_abyBuffer.data(), sWritten.nSize, 1, m_fp) != 1 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO, "Cannot write features");
+            return false;
+        }
+    }
+    return true;
+}
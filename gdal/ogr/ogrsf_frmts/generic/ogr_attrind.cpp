@@ -77,4 +77,34 @@ OGRAttrIndex::OGRAttrIndex() {}
 
 OGRAttrIndex::~OGRAttrIndex() {}
 
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/*                                                                      */
+/*      Default implementation for indexes that are not ordered.        */
+/*      Returning NULL lets the caller fall back to a full scan.        */
+/************************************************************************/
+
+GIntBig *OGRAttrIndex::GetRangeMatches( OGRField * /* psMinKey */,
+                                        bool /* bMinIncluded */,
+                                        OGRField * /* psMaxKey */,
+                                        bool /* bMaxIncluded */,
+                                        GIntBig* /* panFIDList */,
+                                        int* /* nFIDCount */,
+                                        int* /* nLength */ )
+{
+    return nullptr;
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/************************************************************************/
+
+GIntBig *OGRAttrIndex::GetPrefixMatches( const char * /* pszPrefix */,
+                                         GIntBig* /* panFIDList */,
+                                         int* /* nFIDCount */,
+                                         int* /* nLength */ )
+{
+    return nullptr;
+}
+
 //! @endcond
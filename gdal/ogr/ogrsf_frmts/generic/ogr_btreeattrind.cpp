@@ -0,0 +1,2081 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implements a persistent B+tree used as the default generic
+ *           attribute index.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_attrind.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <algorithm>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+//! @cond Doxygen_Suppress
+
+/************************************************************************/
+/*                                                                      */
+/*      File layout (all integers little endian).                       */
+/*                                                                      */
+/*      The .obi file is made of fixed size pages.  Page 0 is the       */
+/*      header, followed by one descriptor per indexed field.  Each     */
+/*      field has its own B+tree whose pages share the rest of the      */
+/*      file.                                                           */
+/*                                                                      */
+/*      Entries are stored as a memcmp() comparable encoding of the      */
+/*      key, followed by the big-endian sign-flipped FID, so that       */
+/*      duplicate keys are ordered by FID and every entry is unique.    */
+/*      Strings are lower-cased to match the case insensitive          */
+/*      comparisons of the OGR SQL engine.                              */
+/*                                                                      */
+/*      Leaves are chained left to right for range scans.  Nodes are    */
+/*      not merged on underflow: deleted entries simply leave room      */
+/*      for later insertions.                                           */
+/*                                                                      */
+/************************************************************************/
+
+static const char BTREE_SIGNATURE[] = "OGRBTIDX";
+static const int BTREE_VERSION = 1;
+static const int BTREE_PAGE_SIZE = 8192;
+
+static const int BTREE_HDR_PAGE_SIZE_OFFSET = 12;
+static const int BTREE_HDR_PAGE_COUNT_OFFSET = 16;
+static const int BTREE_HDR_FREE_LIST_OFFSET = 20;
+static const int BTREE_HDR_INDEX_COUNT_OFFSET = 24;
+static const int BTREE_DESC_OFFSET = 64;
+static const int BTREE_DESC_SIZE = 128;
+static const int BTREE_DESC_NAME_SIZE = 96;
+static const int BTREE_MAX_INDEX_COUNT =
+    (BTREE_PAGE_SIZE - BTREE_DESC_OFFSET) / BTREE_DESC_SIZE;
+
+static const GByte BTREE_NODE_LEAF = 1;
+static const GByte BTREE_NODE_INTERNAL = 2;
+static const GByte BTREE_NODE_FREE = 3;
+static const int BTREE_NODE_HEADER_SIZE = 16;
+
+static const int BTREE_FID_SIZE = 8;
+static const int BTREE_MAX_STRING_KEY_SIZE = 254;
+static const int BTREE_DATE_KEY_SIZE = 10;
+
+/************************************************************************/
+/*                         Page access helpers.                         */
+/************************************************************************/
+
+static GUInt32 BTreeGetUInt32( const GByte *pabyData )
+{
+    GUInt32 nVal = 0;
+    memcpy(&nVal, pabyData, sizeof(nVal));
+    CPL_LSBPTR32(&nVal);
+    return nVal;
+}
+
+static void BTreeSetUInt32( GByte *pabyData, GUInt32 nVal )
+{
+    CPL_LSBPTR32(&nVal);
+    memcpy(pabyData, &nVal, sizeof(nVal));
+}
+
+static int BTreeGetCount( const GByte *pabyPage )
+{
+    return pabyPage[2] | (pabyPage[3] << 8);
+}
+
+static void BTreeSetCount( GByte *pabyPage, int nCount )
+{
+    pabyPage[2] = static_cast<GByte>(nCount & 0xff);
+    pabyPage[3] = static_cast<GByte>(nCount >> 8);
+}
+
+static void BTreeStoreBigEndian( GUIntBig nVal, GByte *pabyOut, int nBytes )
+{
+    for( int i = 0; i < nBytes; i++ )
+        pabyOut[i] = static_cast<GByte>(nVal >> (8 * (nBytes - 1 - i)));
+}
+
+static GUIntBig BTreeLoadBigEndian( const GByte *pabyIn, int nBytes )
+{
+    GUIntBig nVal = 0;
+    for( int i = 0; i < nBytes; i++ )
+        nVal = (nVal << 8) | pabyIn[i];
+    return nVal;
+}
+
+static void BTreeEncodeFID( GIntBig nFID, GByte *pabyOut )
+{
+    BTreeStoreBigEndian(static_cast<GUIntBig>(nFID) ^
+                            (static_cast<GUIntBig>(1) << 63),
+                        pabyOut, BTREE_FID_SIZE);
+}
+
+static GIntBig BTreeDecodeFID( const GByte *pabyIn )
+{
+    return static_cast<GIntBig>(BTreeLoadBigEndian(pabyIn, BTREE_FID_SIZE) ^
+                                (static_cast<GUIntBig>(1) << 63));
+}
+
+/************************************************************************/
+/*                           OGRBTreeSorter                             */
+/*                                                                      */
+/*      External merge sort of fixed size entries, used to bulk load   */
+/*      a tree from an unsorted stream of keys.                         */
+/************************************************************************/
+
+class OGRBTreeSorter
+{
+    struct Run
+    {
+        VSILFILE            *fp = nullptr;
+        CPLString            osFilename{};
+        std::vector<GByte>   abyBuffer{};
+        size_t               nBufferEntries = 0;
+        size_t               iBufferEntry = 0;
+    };
+
+    int                  nEntrySize;
+    size_t               nMaxEntries;
+    std::vector<GByte>   abyEntries{};
+    std::vector<size_t>  anOrder{};
+    size_t               iNext = 0;
+    std::vector<Run>     aoRuns{};
+    std::vector<int>     anHeap{};
+    bool                 bMerging = false;
+
+    void                 SortBuffer();
+    bool                 FlushRun();
+    bool                 FillRunBuffer( Run& oRun );
+    const GByte         *RunEntry( int iRun ) const
+    {
+        const Run& oRun = aoRuns[iRun];
+        return oRun.abyBuffer.data() + oRun.iBufferEntry * nEntrySize;
+    }
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRBTreeSorter)
+
+  public:
+    explicit             OGRBTreeSorter( int nEntrySizeIn );
+                        ~OGRBTreeSorter();
+
+    bool                 Add( const GByte *pabyEntry );
+    bool                 Finish();
+    const GByte         *Next();
+};
+
+/************************************************************************/
+/*                           OGRBTreeSorter()                           */
+/************************************************************************/
+
+OGRBTreeSorter::OGRBTreeSorter( int nEntrySizeIn ) :
+    nEntrySize(nEntrySizeIn),
+    nMaxEntries(0)
+{
+    const GIntBig nMaxMem = static_cast<GIntBig>(
+        atoi(CPLGetConfigOption("OGR_ATTR_INDEX_SORT_MEMORY_MB", "64")))
+        * 1024 * 1024;
+    nMaxEntries = static_cast<size_t>(std::max(
+        static_cast<GIntBig>(1024),
+        nMaxMem / (nEntrySize + static_cast<int>(sizeof(size_t)))));
+}
+
+/************************************************************************/
+/*                          ~OGRBTreeSorter()                           */
+/************************************************************************/
+
+OGRBTreeSorter::~OGRBTreeSorter()
+{
+    for( size_t i = 0; i < aoRuns.size(); i++ )
+    {
+        if( aoRuns[i].fp != nullptr )
+            VSIFCloseL(aoRuns[i].fp);
+        VSIUnlink(aoRuns[i].osFilename);
+    }
+}
+
+/************************************************************************/
+/*                             SortBuffer()                             */
+/************************************************************************/
+
+void OGRBTreeSorter::SortBuffer()
+{
+    const size_t nEntries = abyEntries.size() / nEntrySize;
+    anOrder.resize(nEntries);
+    for( size_t i = 0; i < nEntries; i++ )
+        anOrder[i] = i;
+    const GByte *pabyEntries = abyEntries.data();
+    const size_t nSize = static_cast<size_t>(nEntrySize);
+    std::sort(anOrder.begin(), anOrder.end(),
+              [pabyEntries, nSize](size_t a, size_t b)
+              {
+                  return memcmp(pabyEntries + a * nSize,
+                                pabyEntries + b * nSize, nSize) < 0;
+              });
+}
+
+/************************************************************************/
+/*                              FlushRun()                              */
+/************************************************************************/
+
+bool OGRBTreeSorter::FlushRun()
+{
+    SortBuffer();
+
+    Run oRun;
+    oRun.osFilename = CPLGenerateTempFilename("ogr_attrind_run");
+    oRun.fp = VSIFOpenL(oRun.osFilename, "wb+");
+    if( oRun.fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_OpenFailed,
+                 "Cannot create temporary file %s.", oRun.osFilename.c_str());
+        return false;
+    }
+    aoRuns.push_back(oRun);
+
+    for( size_t i = 0; i < anOrder.size(); i++ )
+    {
+        if( VSIFWriteL(abyEntries.data() + anOrder[i] * nEntrySize,
+                       nEntrySize, 1, aoRuns.back().fp) != 1 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Cannot write temporary file %s.",
+                     aoRuns.back().osFilename.c_str());
+            return false;
+        }
+    }
+    abyEntries.clear();
+    anOrder.clear();
+    return true;
+}
+
+/************************************************************************/
+/*                                Add()                                 */
+/************************************************************************/
+
+bool OGRBTreeSorter::Add( const GByte *pabyEntry )
+{
+    abyEntries.insert(abyEntries.end(), pabyEntry, pabyEntry + nEntrySize);
+    if( abyEntries.size() / nEntrySize >= nMaxEntries )
+        return FlushRun();
+    return true;
+}
+
+/************************************************************************/
+/*                            FillRunBuffer()                           */
+/************************************************************************/
+
+bool OGRBTreeSorter::FillRunBuffer( Run& oRun )
+{
+    const size_t nBufferEntries =
+        std::max(static_cast<size_t>(1),
+                 static_cast<size_t>((256 * 1024) / nEntrySize));
+    oRun.abyBuffer.resize(nBufferEntries * nEntrySize);
+    oRun.nBufferEntries = VSIFReadL(oRun.abyBuffer.data(), nEntrySize,
+                                    nBufferEntries, oRun.fp);
+    oRun.iBufferEntry = 0;
+    return oRun.nBufferEntries > 0;
+}
+
+/************************************************************************/
+/*                               Finish()                               */
+/*                                                                      */
+/*      Terminates the input phase.  When everything fitted in         */
+/*      memory we iterate the sorted buffer directly, otherwise the     */
+/*      runs are merged with a heap.                                    */
+/************************************************************************/
+
+bool OGRBTreeSorter::Finish()
+{
+    if( aoRuns.empty() )
+    {
+        SortBuffer();
+        iNext = 0;
+        return true;
+    }
+
+    if( !abyEntries.empty() && !FlushRun() )
+        return false;
+
+    bMerging = true;
+    for( size_t i = 0; i < aoRuns.size(); i++ )
+    {
+        VSIFSeekL(aoRuns[i].fp, 0, SEEK_SET);
+        if( FillRunBuffer(aoRuns[i]) )
+            anHeap.push_back(static_cast<int>(i));
+    }
+
+    const auto cmp = [this](int a, int b)
+        { return memcmp(RunEntry(a), RunEntry(b), nEntrySize) > 0; };
+    std::make_heap(anHeap.begin(), anHeap.end(), cmp);
+    return true;
+}
+
+/************************************************************************/
+/*                                Next()                                */
+/*                                                                      */
+/*      Returns the next entry in sorted order, or NULL at the end.     */
+/*      The returned pointer is valid until the next call.              */
+/************************************************************************/
+
+const GByte *OGRBTreeSorter::Next()
+{
+    if( !bMerging )
+    {
+        if( iNext >= anOrder.size() )
+            return nullptr;
+        return abyEntries.data() + anOrder[iNext++] * nEntrySize;
+    }
+
+    const auto cmp = [this](int a, int b)
+        { return memcmp(RunEntry(a), RunEntry(b), nEntrySize) > 0; };
+
+    // The entry returned on the previous call is still at the top of the
+    // heap: advance its run now.
+    if( iNext > 0 && !anHeap.empty() )
+    {
+        std::pop_heap(anHeap.begin(), anHeap.end(), cmp);
+        const int iRun = anHeap.back();
+        Run& oRun = aoRuns[iRun];
+        oRun.iBufferEntry++;
+        if( oRun.iBufferEntry < oRun.nBufferEntries || FillRunBuffer(oRun) )
+            std::push_heap(anHeap.begin(), anHeap.end(), cmp);
+        else
+            anHeap.pop_back();
+    }
+    iNext = 1;
+
+    if( anHeap.empty() )
+        return nullptr;
+    return RunEntry(anHeap.front());
+}
+
+/************************************************************************/
+/*                          OGRBTreeAttrIndex                           */
+/*                                                                      */
+/*      B+tree index on one field.                                      */
+/************************************************************************/
+
+class OGRBTreeLayerAttrIndex;
+
+struct OGRBTreeBulkLevel
+{
+    GUInt32             nPage = 0;
+    std::vector<GByte>  abyPage{};
+    std::vector<GByte>  abyFirstEntry{};
+    int                 nChildren = 0;
+};
+
+class OGRBTreeAttrIndex final : public OGRAttrIndex
+{
+    int         InsertInto( GUInt32 nPage, int nLevel,
+                            const GByte *pabyEntry,
+                            GByte *pabySplitEntry, GUInt32 *pnSplitPage );
+    bool        BulkPushChild( std::vector<OGRBTreeBulkLevel>& aoLevels,
+                               size_t iLevel, const GByte *pabyFirstEntry,
+                               GUInt32 nChild, int nFill );
+    bool        FreeSubTree( GUInt32 nPage, int nLevel );
+
+    template<class Visitor> bool Scan( const GByte *pabyStart,
+                                       Visitor& oVisitor );
+
+    GIntBig    *CollectMatches( const GByte *pabyMinKey, bool bMinIncluded,
+                                const GByte *pabyMaxKey, bool bMaxIncluded,
+                                int nPrefixLen,
+                                GIntBig* panFIDList, int* nFIDCount,
+                                int* nLength );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRBTreeAttrIndex)
+
+public:
+    OGRBTreeLayerAttrIndex *poLIndex;
+    int           iField;
+    CPLString     osFieldName;
+    OGRFieldType  eFieldType;
+    int           nKeySize;
+    int           nEntrySize;
+    GUInt32       nRootPage;
+    int           nHeight;
+    GUIntBig      nEntryCount;
+
+                OGRBTreeAttrIndex( OGRBTreeLayerAttrIndex *poLIndexIn,
+                                   int iFieldIn, const char *pszFieldName,
+                                   OGRFieldType eFieldTypeIn,
+                                   int nKeySizeIn );
+               ~OGRBTreeAttrIndex() override;
+
+    static int  GetKeySize( OGRFieldDefn *poFldDefn );
+    bool        EncodeKey( const OGRField *psKey, GByte *pabyKey ) const;
+
+    int         GetLeafCapacity() const
+        { return (BTREE_PAGE_SIZE - BTREE_NODE_HEADER_SIZE) / nEntrySize; }
+    int         GetInternalCapacity() const
+        { return (BTREE_PAGE_SIZE - BTREE_NODE_HEADER_SIZE - 4) /
+                 (nEntrySize + 4); }
+
+    OGRErr      Insert( const GByte *pabyEntry );
+    OGRErr      Remove( const GByte *pabyEntry );
+    OGRErr      BulkLoad( OGRBTreeSorter& oSorter );
+
+    GIntBig     GetFirstMatch( OGRField *psKey ) override;
+    GIntBig    *GetAllMatches( OGRField *psKey ) override;
+    GIntBig    *GetAllMatches( OGRField *psKey, GIntBig* panFIDList,
+                               int* nFIDCount, int* nLength ) override;
+
+    bool        SupportsRangeMatches() override { return true; }
+    GIntBig    *GetRangeMatches( OGRField *psMinKey, bool bMinIncluded,
+                                 OGRField *psMaxKey, bool bMaxIncluded,
+                                 GIntBig* panFIDList, int* nFIDCount,
+                                 int* nLength ) override;
+    GIntBig    *GetPrefixMatches( const char *pszPrefix,
+                                  GIntBig* panFIDList, int* nFIDCount,
+                                  int* nLength ) override;
+
+    OGRErr      AddEntry( OGRField *psKey, GIntBig nFID ) override;
+    OGRErr      RemoveEntry( OGRField *psKey, GIntBig nFID ) override;
+
+    OGRErr      Clear() override;
+};
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        OGRBTreeLayerAttrIndex                        */
+/*                                                                      */
+/*      Owner of the .obi file and of the per-field trees.              */
+/* ==================================================================== */
+/************************************************************************/
+
+class OGRBTreeLayerAttrIndex final : public OGRLayerAttrIndex
+{
+    VSILFILE    *fp;
+    bool         bUpdate;
+    bool         bHeaderDirty;
+    GUInt32      nPageCount;
+    GUInt32      nFreeListHead;
+    CPLString    osIndexFilename;
+
+    std::vector<OGRBTreeAttrIndex*> apoIndexList;
+
+    OGRErr       LoadHeader();
+    OGRErr       OpenForUpdate();
+    OGRErr       FlushHeader();
+    void         CloseAndUnlinkIfEmpty();
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRBTreeLayerAttrIndex)
+
+public:
+                OGRBTreeLayerAttrIndex();
+    virtual     ~OGRBTreeLayerAttrIndex();
+
+    /* base class virtual methods */
+    OGRErr      Initialize( const char *pszIndexPath, OGRLayer * ) override;
+    OGRErr      CreateIndex( int iField ) override;
+    OGRErr      DropIndex( int iField ) override;
+    OGRErr      IndexAllFeatures( int iField = -1 ) override;
+
+    OGRErr      AddToIndex( OGRFeature *poFeature, int iField = -1 ) override;
+    OGRErr      RemoveFromIndex( OGRFeature *poFeature ) override;
+
+    OGRAttrIndex *GetFieldIndex( int iField ) override;
+
+    /* page management, used by OGRBTreeAttrIndex */
+    bool        ReadPage( GUInt32 nPage, GByte *pabyPage );
+    bool        WritePage( GUInt32 nPage, const GByte *pabyPage );
+    GUInt32     AllocPage();
+    bool        FreePage( GUInt32 nPage );
+    OGRErr      PrepareForUpdate() { return OpenForUpdate(); }
+    void        SetHeaderDirty() { bHeaderDirty = true; }
+};
+
+/************************************************************************/
+/*                       OGRBTreeLayerAttrIndex()                       */
+/************************************************************************/
+
+OGRBTreeLayerAttrIndex::OGRBTreeLayerAttrIndex() :
+    fp(nullptr),
+    bUpdate(false),
+    bHeaderDirty(false),
+    nPageCount(0),
+    nFreeListHead(0)
+{}
+
+/************************************************************************/
+/*                      ~OGRBTreeLayerAttrIndex()                       */
+/************************************************************************/
+
+OGRBTreeLayerAttrIndex::~OGRBTreeLayerAttrIndex()
+
+{
+    if( fp != nullptr )
+    {
+        FlushHeader();
+        VSIFCloseL(fp);
+        fp = nullptr;
+    }
+
+    for( size_t i = 0; i < apoIndexList.size(); i++ )
+        delete apoIndexList[i];
+}
+
+/************************************************************************/
+/*                             Initialize()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::Initialize( const char *pszIndexPathIn,
+                                           OGRLayer *poLayerIn )
+
+{
+    if( poLayerIn == poLayer )
+        return OGRERR_NONE;
+
+    poLayer = poLayerIn;
+    pszIndexPath = CPLStrdup( pszIndexPathIn );
+    osIndexFilename = CPLResetExtension( pszIndexPathIn, "obi" );
+
+/* -------------------------------------------------------------------- */
+/*      If an index file already exists, load its trees.               */
+/* -------------------------------------------------------------------- */
+    VSIStatBufL sStat;
+    if( VSIStatL( osIndexFilename, &sStat ) != 0 )
+        return OGRERR_NONE;
+
+    fp = VSIFOpenL( osIndexFilename, "rb" );
+    if( fp == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "Failed to open index file %s.",
+                  osIndexFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+    return LoadHeader();
+}
+
+/************************************************************************/
+/*                             LoadHeader()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::LoadHeader()
+
+{
+    std::vector<GByte> abyHeader(BTREE_PAGE_SIZE);
+    if( VSIFReadL( abyHeader.data(), BTREE_PAGE_SIZE, 1, fp ) != 1 ||
+        memcmp( abyHeader.data(), BTREE_SIGNATURE, 8 ) != 0 ||
+        BTreeGetUInt32( &abyHeader[8] ) != BTREE_VERSION ||
+        BTreeGetUInt32( &abyHeader[BTREE_HDR_PAGE_SIZE_OFFSET] ) !=
+                                                        BTREE_PAGE_SIZE )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "%s is not a valid attribute index file.",
+                  osIndexFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+    nPageCount = BTreeGetUInt32( &abyHeader[BTREE_HDR_PAGE_COUNT_OFFSET] );
+    nFreeListHead = BTreeGetUInt32( &abyHeader[BTREE_HDR_FREE_LIST_OFFSET] );
+    const int nIndexCount = static_cast<int>(
+        BTreeGetUInt32( &abyHeader[BTREE_HDR_INDEX_COUNT_OFFSET] ));
+    if( nIndexCount > BTREE_MAX_INDEX_COUNT )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Corrupted index file %s.", osIndexFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+    OGRFeatureDefn *poDefn = poLayer->GetLayerDefn();
+    for( int i = 0; i < nIndexCount; i++ )
+    {
+        const GByte *pabyDesc =
+            &abyHeader[BTREE_DESC_OFFSET + i * BTREE_DESC_SIZE];
+        char szName[BTREE_DESC_NAME_SIZE + 1] = {};
+        memcpy( szName, pabyDesc, BTREE_DESC_NAME_SIZE );
+
+        const OGRFieldType eType = static_cast<OGRFieldType>(
+            BTreeGetUInt32( pabyDesc + 96 ));
+        const int nKeySize = static_cast<int>(
+            BTreeGetUInt32( pabyDesc + 100 ));
+        if( nKeySize <= 0 || nKeySize > BTREE_MAX_STRING_KEY_SIZE )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Skipping corrupt index entry for field %s.", szName );
+            continue;
+        }
+
+        // Trees are bound by field name, so that indexes survive field
+        // reordering.  Indexes whose definition no longer match the
+        // field are ignored.
+        const int iField = poDefn->GetFieldIndex( szName );
+        if( iField < 0 ||
+            poDefn->GetFieldDefn(iField)->GetType() != eType )
+        {
+            CPLDebug( "OGR", "Ignoring attribute index on field %s "
+                      "that does not match the layer definition.", szName );
+            continue;
+        }
+
+        OGRBTreeAttrIndex *poAI =
+            new OGRBTreeAttrIndex( this, iField, szName, eType, nKeySize );
+        poAI->nRootPage = BTreeGetUInt32( pabyDesc + 104 );
+        poAI->nHeight = static_cast<int>(BTreeGetUInt32( pabyDesc + 108 ));
+        GUIntBig nCount = 0;
+        memcpy( &nCount, pabyDesc + 112, sizeof(nCount) );
+        CPL_LSBPTR64( &nCount );
+        poAI->nEntryCount = nCount;
+        apoIndexList.push_back( poAI );
+    }
+
+    CPLDebug( "OGR", "Restored %d field indexes for layer %s from %s.",
+              static_cast<int>(apoIndexList.size()),
+              poDefn->GetName(), osIndexFilename.c_str() );
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            FlushHeader()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::FlushHeader()
+
+{
+    if( !bHeaderDirty || fp == nullptr || !bUpdate )
+        return OGRERR_NONE;
+
+    std::vector<GByte> abyHeader(BTREE_PAGE_SIZE);
+    memcpy( abyHeader.data(), BTREE_SIGNATURE, 8 );
+    BTreeSetUInt32( &abyHeader[8], BTREE_VERSION );
+    BTreeSetUInt32( &abyHeader[BTREE_HDR_PAGE_SIZE_OFFSET], BTREE_PAGE_SIZE );
+    BTreeSetUInt32( &abyHeader[BTREE_HDR_PAGE_COUNT_OFFSET], nPageCount );
+    BTreeSetUInt32( &abyHeader[BTREE_HDR_FREE_LIST_OFFSET], nFreeListHead );
+    BTreeSetUInt32( &abyHeader[BTREE_HDR_INDEX_COUNT_OFFSET],
+                    static_cast<GUInt32>(apoIndexList.size()) );
+
+    for( size_t i = 0; i < apoIndexList.size(); i++ )
+    {
+        OGRBTreeAttrIndex *poAI = apoIndexList[i];
+        GByte *pabyDesc = &abyHeader[BTREE_DESC_OFFSET + i * BTREE_DESC_SIZE];
+        memcpy( pabyDesc, poAI->osFieldName.c_str(),
+                std::min( static_cast<int>(poAI->osFieldName.size()),
+                          BTREE_DESC_NAME_SIZE ) );
+        BTreeSetUInt32( pabyDesc + 96, static_cast<GUInt32>(poAI->eFieldType) );
+        BTreeSetUInt32( pabyDesc + 100, static_cast<GUInt32>(poAI->nKeySize) );
+        BTreeSetUInt32( pabyDesc + 104, poAI->nRootPage );
+        BTreeSetUInt32( pabyDesc + 108, static_cast<GUInt32>(poAI->nHeight) );
+        GUIntBig nCount = poAI->nEntryCount;
+        CPL_LSBPTR64( &nCount );
+        memcpy( pabyDesc + 112, &nCount, sizeof(nCount) );
+    }
+
+    if( VSIFSeekL( fp, 0, SEEK_SET ) != 0 ||
+        VSIFWriteL( abyHeader.data(), BTREE_PAGE_SIZE, 1, fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Failed to write header of %s.", osIndexFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+    bHeaderDirty = false;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                           OpenForUpdate()                            */
+/*                                                                      */
+/*      The index is opened read-only until it has to be modified.      */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::OpenForUpdate()
+
+{
+    if( bUpdate )
+        return OGRERR_NONE;
+
+    if( fp == nullptr )
+    {
+        fp = VSIFOpenL( osIndexFilename, "wb+" );
+        if( fp == nullptr )
+        {
+            CPLError( CE_Failure, CPLE_OpenFailed,
+                      "Failed to create %s.", osIndexFilename.c_str() );
+            return OGRERR_FAILURE;
+        }
+        bUpdate = true;
+        nPageCount = 1;
+        nFreeListHead = 0;
+        bHeaderDirty = true;
+        return FlushHeader();
+    }
+
+    VSIFCloseL( fp );
+    fp = VSIFOpenL( osIndexFilename, "rb+" );
+    if( fp == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "Failed to open %s in update mode.",
+                  osIndexFilename.c_str() );
+        fp = VSIFOpenL( osIndexFilename, "rb" );
+        return OGRERR_FAILURE;
+    }
+    bUpdate = true;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                       CloseAndUnlinkIfEmpty()                        */
+/************************************************************************/
+
+void OGRBTreeLayerAttrIndex::CloseAndUnlinkIfEmpty()
+
+{
+    if( !apoIndexList.empty() )
+        return;
+
+    if( fp != nullptr )
+    {
+        VSIFCloseL( fp );
+        fp = nullptr;
+    }
+    bUpdate = false;
+    bHeaderDirty = false;
+    nPageCount = 0;
+    nFreeListHead = 0;
+    VSIUnlink( osIndexFilename );
+}
+
+/************************************************************************/
+/*                              ReadPage()                              */
+/************************************************************************/
+
+bool OGRBTreeLayerAttrIndex::ReadPage( GUInt32 nPage, GByte *pabyPage )
+
+{
+    if( fp == nullptr || nPage == 0 || nPage >= nPageCount ||
+        VSIFSeekL( fp, static_cast<vsi_l_offset>(nPage) * BTREE_PAGE_SIZE,
+                   SEEK_SET ) != 0 ||
+        VSIFReadL( pabyPage, BTREE_PAGE_SIZE, 1, fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Failed to read page %u of %s.",
+                  nPage, osIndexFilename.c_str() );
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             WritePage()                              */
+/************************************************************************/
+
+bool OGRBTreeLayerAttrIndex::WritePage( GUInt32 nPage, const GByte *pabyPage )
+
+{
+    if( fp == nullptr || !bUpdate || nPage == 0 ||
+        VSIFSeekL( fp, static_cast<vsi_l_offset>(nPage) * BTREE_PAGE_SIZE,
+                   SEEK_SET ) != 0 ||
+        VSIFWriteL( pabyPage, BTREE_PAGE_SIZE, 1, fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Failed to write page %u of %s.",
+                  nPage, osIndexFilename.c_str() );
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             AllocPage()                              */
+/*                                                                      */
+/*      Returns 0 on failure.                                           */
+/************************************************************************/
+
+GUInt32 OGRBTreeLayerAttrIndex::AllocPage()
+
+{
+    bHeaderDirty = true;
+    if( nFreeListHead != 0 )
+    {
+        GByte abyPage[BTREE_NODE_HEADER_SIZE];
+        const GUInt32 nPage = nFreeListHead;
+        if( VSIFSeekL( fp, static_cast<vsi_l_offset>(nPage) * BTREE_PAGE_SIZE,
+                       SEEK_SET ) != 0 ||
+            VSIFReadL( abyPage, sizeof(abyPage), 1, fp ) != 1 ||
+            abyPage[0] != BTREE_NODE_FREE )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Corrupted free page list in %s.",
+                      osIndexFilename.c_str() );
+            return 0;
+        }
+        nFreeListHead = BTreeGetUInt32( abyPage + 4 );
+        return nPage;
+    }
+    return nPageCount++;
+}
+
+/************************************************************************/
+/*                              FreePage()                              */
+/************************************************************************/
+
+bool OGRBTreeLayerAttrIndex::FreePage( GUInt32 nPage )
+
+{
+    std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+    abyPage[0] = BTREE_NODE_FREE;
+    BTreeSetUInt32( &abyPage[4], nFreeListHead );
+    if( !WritePage( nPage, abyPage.data() ) )
+        return false;
+    nFreeListHead = nPage;
+    bHeaderDirty = true;
+    return true;
+}
+
+/************************************************************************/
+/*                            CreateIndex()                             */
+/*                                                                      */
+/*      Create an index corresponding to the indicated field, but do    */
+/*      not populate it.  Use IndexAllFeatures() for that.              */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::CreateIndex( int iField )
+
+{
+    OGRFieldDefn *poFldDefn = poLayer->GetLayerDefn()->GetFieldDefn(iField);
+
+    if( GetFieldIndex( iField ) != nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "It seems we already have an index for field %d/%s\n"
+                  "of layer %s.",
+                  iField, poFldDefn->GetNameRef(),
+                  poLayer->GetLayerDefn()->GetName() );
+        return OGRERR_FAILURE;
+    }
+
+    const int nKeySize = OGRBTreeAttrIndex::GetKeySize( poFldDefn );
+    if( nKeySize == 0 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Indexing not support for the field type of field %s.",
+                  poFldDefn->GetNameRef() );
+        return OGRERR_FAILURE;
+    }
+
+    if( static_cast<int>(apoIndexList.size()) == BTREE_MAX_INDEX_COUNT )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot create more than %d attribute indexes per layer.",
+                  BTREE_MAX_INDEX_COUNT );
+        return OGRERR_FAILURE;
+    }
+
+    if( OpenForUpdate() != OGRERR_NONE )
+        return OGRERR_FAILURE;
+
+    apoIndexList.push_back(
+        new OGRBTreeAttrIndex( this, iField, poFldDefn->GetNameRef(),
+                               poFldDefn->GetType(), nKeySize ) );
+    bHeaderDirty = true;
+
+    return FlushHeader();
+}
+
+/************************************************************************/
+/*                             DropIndex()                              */
+/*                                                                      */
+/*      The pages of the tree go to the free list, and the file is      */
+/*      removed when the last index is dropped.                         */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::DropIndex( int iField )
+
+{
+    OGRFieldDefn *poFldDefn = poLayer->GetLayerDefn()->GetFieldDefn(iField);
+
+    size_t i = 0;
+    for( ; i < apoIndexList.size(); i++ )
+    {
+        if( apoIndexList[i]->iField == iField )
+            break;
+    }
+
+    if( i == apoIndexList.size() )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "DROP INDEX on field (%s) that doesn't have an index.",
+                  poFldDefn->GetNameRef() );
+        return OGRERR_FAILURE;
+    }
+
+    OGRBTreeAttrIndex *poAI = apoIndexList[i];
+    if( apoIndexList.size() > 1 && poAI->Clear() != OGRERR_NONE )
+        return OGRERR_FAILURE;
+
+    apoIndexList.erase( apoIndexList.begin() + i );
+    delete poAI;
+    bHeaderDirty = true;
+
+    if( apoIndexList.empty() )
+    {
+        CloseAndUnlinkIfEmpty();
+        return OGRERR_NONE;
+    }
+
+    return FlushHeader();
+}
+
+/************************************************************************/
+/*                          IndexAllFeatures()                          */
+/*                                                                      */
+/*      Empty trees are bulk loaded from sorted entries, which is       */
+/*      much faster and gives fully packed leaves.  Trees that          */
+/*      already have content get incremental insertions.                */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::IndexAllFeatures( int iField )
+
+{
+    std::vector<OGRBTreeAttrIndex*> apoTargets;
+    std::vector<OGRBTreeSorter*> apoSorters;
+    for( size_t i = 0; i < apoIndexList.size(); i++ )
+    {
+        OGRBTreeAttrIndex *poAI = apoIndexList[i];
+        if( iField != -1 && poAI->iField != iField )
+            continue;
+        apoTargets.push_back( poAI );
+        apoSorters.push_back( poAI->nEntryCount == 0 ?
+                    new OGRBTreeSorter( poAI->nEntrySize ) : nullptr );
+    }
+    if( apoTargets.empty() )
+        return OGRERR_NONE;
+
+    OGRErr eErr = OpenForUpdate();
+
+    std::vector<GByte> abyEntry(BTREE_MAX_STRING_KEY_SIZE + BTREE_FID_SIZE);
+    poLayer->ResetReading();
+
+    OGRFeature *poFeature = nullptr;
+    while( eErr == OGRERR_NONE &&
+           (poFeature = poLayer->GetNextFeature()) != nullptr )
+    {
+        for( size_t i = 0; i < apoTargets.size() && eErr == OGRERR_NONE; i++ )
+        {
+            OGRBTreeAttrIndex *poAI = apoTargets[i];
+            if( !poFeature->IsFieldSetAndNotNull( poAI->iField ) ||
+                !poAI->EncodeKey( poFeature->GetRawFieldRef( poAI->iField ),
+                                  abyEntry.data() ) )
+                continue;
+            BTreeEncodeFID( poFeature->GetFID(),
+                            abyEntry.data() + poAI->nKeySize );
+            if( apoSorters[i] != nullptr )
+            {
+                if( !apoSorters[i]->Add( abyEntry.data() ) )
+                    eErr = OGRERR_FAILURE;
+            }
+            else
+            {
+                eErr = poAI->Insert( abyEntry.data() );
+            }
+        }
+
+        delete poFeature;
+    }
+
+    poLayer->ResetReading();
+
+    for( size_t i = 0; i < apoTargets.size(); i++ )
+    {
+        if( apoSorters[i] != nullptr )
+        {
+            if( eErr == OGRERR_NONE )
+            {
+                if( !apoSorters[i]->Finish() )
+                    eErr = OGRERR_FAILURE;
+                else
+                    eErr = apoTargets[i]->BulkLoad( *apoSorters[i] );
+            }
+            delete apoSorters[i];
+        }
+    }
+
+    if( eErr == OGRERR_NONE )
+        eErr = FlushHeader();
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                           GetFieldIndex()                            */
+/************************************************************************/
+
+OGRAttrIndex *OGRBTreeLayerAttrIndex::GetFieldIndex( int iField )
+
+{
+    for( size_t i = 0; i < apoIndexList.size(); i++ )
+    {
+        if( apoIndexList[i]->iField == iField )
+            return apoIndexList[i];
+    }
+
+    return nullptr;
+}
+
+/************************************************************************/
+/*                             AddToIndex()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::AddToIndex( OGRFeature *poFeature,
+                                           int iTargetField )
+
+{
+    if( apoIndexList.empty() )
+        return OGRERR_NONE;
+
+    if( poFeature->GetFID() == OGRNullFID )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Attempt to index feature with no FID." );
+        return OGRERR_FAILURE;
+    }
+
+    OGRErr eErr = OGRERR_NONE;
+    for( size_t i = 0; i < apoIndexList.size() && eErr == OGRERR_NONE; i++ )
+    {
+        const int iField = apoIndexList[i]->iField;
+
+        if( iTargetField != -1 && iTargetField != iField )
+            continue;
+
+        if( !poFeature->IsFieldSetAndNotNull( iField ) )
+            continue;
+
+        eErr = apoIndexList[i]->AddEntry( poFeature->GetRawFieldRef( iField ),
+                                          poFeature->GetFID() );
+    }
+
+    if( eErr == OGRERR_NONE )
+        eErr = FlushHeader();
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          RemoveFromIndex()                           */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::RemoveFromIndex( OGRFeature *poFeature )
+
+{
+    if( apoIndexList.empty() )
+        return OGRERR_NONE;
+
+    OGRErr eErr = OGRERR_NONE;
+    for( size_t i = 0; i < apoIndexList.size() && eErr == OGRERR_NONE; i++ )
+    {
+        const int iField = apoIndexList[i]->iField;
+
+        if( !poFeature->IsFieldSetAndNotNull( iField ) )
+            continue;
+
+        eErr = apoIndexList[i]->RemoveEntry(
+                    poFeature->GetRawFieldRef( iField ), poFeature->GetFID() );
+    }
+
+    if( eErr == OGRERR_NONE )
+        eErr = FlushHeader();
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                     OGRCreateDefaultLayerIndex()                     */
+/************************************************************************/
+
+OGRLayerAttrIndex *OGRCreateDefaultLayerIndex()
+
+{
+    return new OGRBTreeLayerAttrIndex();
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          OGRBTreeAttrIndex                           */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                         OGRBTreeAttrIndex()                          */
+/************************************************************************/
+
+OGRBTreeAttrIndex::OGRBTreeAttrIndex( OGRBTreeLayerAttrIndex *poLIndexIn,
+                                      int iFieldIn,
+                                      const char *pszFieldName,
+                                      OGRFieldType eFieldTypeIn,
+                                      int nKeySizeIn ) :
+    poLIndex(poLIndexIn),
+    iField(iFieldIn),
+    osFieldName(pszFieldName),
+    eFieldType(eFieldTypeIn),
+    nKeySize(nKeySizeIn),
+    nEntrySize(nKeySizeIn + BTREE_FID_SIZE),
+    nRootPage(0),
+    nHeight(0),
+    nEntryCount(0)
+{}
+
+/************************************************************************/
+/*                         ~OGRBTreeAttrIndex()                         */
+/************************************************************************/
+
+OGRBTreeAttrIndex::~OGRBTreeAttrIndex()
+{
+}
+
+/************************************************************************/
+/*                             GetKeySize()                             */
+/*                                                                      */
+/*      Returns 0 for field types that cannot be indexed.              */
+/************************************************************************/
+
+int OGRBTreeAttrIndex::GetKeySize( OGRFieldDefn *poFldDefn )
+
+{
+    switch( poFldDefn->GetType() )
+    {
+      case OFTInteger:
+      case OFTInteger64:
+      case OFTReal:
+        return 8;
+
+      case OFTDate:
+      case OFTDateTime:
+        return BTREE_DATE_KEY_SIZE;
+
+      case OFTString:
+        // Keys are not truncated for widths up to the DBF limit, so that
+        // lookups are exact.
+        if( poFldDefn->GetWidth() > 0 &&
+            poFldDefn->GetWidth() < BTREE_MAX_STRING_KEY_SIZE )
+            return poFldDefn->GetWidth();
+        return BTREE_MAX_STRING_KEY_SIZE;
+
+      default:
+        return 0;
+    }
+}
+
+/************************************************************************/
+/*                             EncodeKey()                              */
+/*                                                                      */
+/*      Encodes psKey so that memcmp() order matches the order of the   */
+/*      OGR SQL comparison operators.  Returns false for values that    */
+/*      must not be indexed (NaN).                                      */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::EncodeKey( const OGRField *psKey,
+                                   GByte *pabyKey ) const
+
+{
+    switch( eFieldType )
+    {
+      case OFTInteger:
+      case OFTInteger64:
+      {
+        const GIntBig nVal = eFieldType == OFTInteger ?
+            psKey->Integer : psKey->Integer64;
+        BTreeStoreBigEndian( static_cast<GUIntBig>(nVal) ^
+                                (static_cast<GUIntBig>(1) << 63),
+                             pabyKey, 8 );
+        return true;
+      }
+
+      case OFTReal:
+      {
+        double dfVal = psKey->Real;
+        if( CPLIsNan(dfVal) )
+            return false;
+        if( dfVal == 0.0 )
+            dfVal = 0.0;  // Normalize -0.0
+        GUIntBig nBits = 0;
+        memcpy( &nBits, &dfVal, sizeof(nBits) );
+        if( nBits >> 63 )
+            nBits = ~nBits;
+        else
+            nBits |= static_cast<GUIntBig>(1) << 63;
+        BTreeStoreBigEndian( nBits, pabyKey, 8 );
+        return true;
+      }
+
+      case OFTDate:
+      case OFTDateTime:
+      {
+        // Same ordering as OGRCompareDate(), which ignores TZFlag.
+        float fSecond = psKey->Date.Second;
+        if( CPLIsNan(fSecond) )
+            return false;
+        if( fSecond == 0.0f )
+            fSecond = 0.0f;
+        BTreeStoreBigEndian( static_cast<GUIntBig>(psKey->Date.Year + 32768),
+                             pabyKey, 2 );
+        pabyKey[2] = psKey->Date.Month;
+        pabyKey[3] = psKey->Date.Day;
+        pabyKey[4] = psKey->Date.Hour;
+        pabyKey[5] = psKey->Date.Minute;
+        GUInt32 nBits = 0;
+        memcpy( &nBits, &fSecond, sizeof(nBits) );
+        if( nBits >> 31 )
+            nBits = ~nBits;
+        else
+            nBits |= 0x80000000U;
+        BTreeStoreBigEndian( nBits, pabyKey + 6, 4 );
+        return true;
+      }
+
+      case OFTString:
+      {
+        memset( pabyKey, 0, nKeySize );
+        const char *pszVal = psKey->String;
+        for( int i = 0; i < nKeySize && pszVal[i] != '\0'; i++ )
+        {
+            GByte ch = static_cast<GByte>(pszVal[i]);
+            if( ch >= 'A' && ch <= 'Z' )
+                ch = static_cast<GByte>(ch - 'A' + 'a');
+            pabyKey[i] = ch;
+        }
+        return true;
+      }
+
+      default:
+        CPLAssert( false );
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                             InsertInto()                             */
+/*                                                                      */
+/*      Recursive insertion.  Returns -1 on error, 0 if the entry       */
+/*      already existed and 1 if it was inserted.  When the node had    */
+/*      to be split, the new right sibling and its separator are        */
+/*      returned so that the caller can insert them.                    */
+/************************************************************************/
+
+int OGRBTreeAttrIndex::InsertInto( GUInt32 nPage, int nLevel,
+                                   const GByte *pabyEntry,
+                                   GByte *pabySplitEntry,
+                                   GUInt32 *pnSplitPage )
+
+{
+    *pnSplitPage = 0;
+
+    std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+    if( !poLIndex->ReadPage( nPage, abyPage.data() ) )
+        return -1;
+    GByte *pabyPage = abyPage.data();
+    const int nCount = BTreeGetCount( pabyPage );
+
+/* -------------------------------------------------------------------- */
+/*      Leaf node.                                                      */
+/* -------------------------------------------------------------------- */
+    if( nLevel == 1 )
+    {
+        GByte *pabyEntries = pabyPage + BTREE_NODE_HEADER_SIZE;
+        int nLo = 0;
+        int nHi = nCount;
+        while( nLo < nHi )
+        {
+            const int nMid = (nLo + nHi) / 2;
+            if( memcmp( pabyEntries + nMid * nEntrySize, pabyEntry,
+                        nEntrySize ) < 0 )
+                nLo = nMid + 1;
+            else
+                nHi = nMid;
+        }
+        if( nLo < nCount &&
+            memcmp( pabyEntries + nLo * nEntrySize, pabyEntry,
+                    nEntrySize ) == 0 )
+            return 0;
+
+        if( nCount < GetLeafCapacity() )
+        {
+            memmove( pabyEntries + (nLo + 1) * nEntrySize,
+                     pabyEntries + nLo * nEntrySize,
+                     (nCount - nLo) * nEntrySize );
+            memcpy( pabyEntries + nLo * nEntrySize, pabyEntry, nEntrySize );
+            BTreeSetCount( pabyPage, nCount + 1 );
+            return poLIndex->WritePage( nPage, pabyPage ) ? 1 : -1;
+        }
+
+        // Split: build the full sorted sequence and share it.
+        std::vector<GByte> abyAll( (nCount + 1) * nEntrySize );
+        memcpy( abyAll.data(), pabyEntries, nLo * nEntrySize );
+        memcpy( &abyAll[nLo * nEntrySize], pabyEntry, nEntrySize );
+        memcpy( &abyAll[(nLo + 1) * nEntrySize],
+                pabyEntries + nLo * nEntrySize, (nCount - nLo) * nEntrySize );
+
+        const GUInt32 nNewPage = poLIndex->AllocPage();
+        if( nNewPage == 0 )
+            return -1;
+
+        const int nLeft = (nCount + 1) / 2;
+        const int nRight = nCount + 1 - nLeft;
+
+        std::vector<GByte> abyNewPage(BTREE_PAGE_SIZE);
+        abyNewPage[0] = BTREE_NODE_LEAF;
+        BTreeSetCount( abyNewPage.data(), nRight );
+        BTreeSetUInt32( &abyNewPage[4], BTreeGetUInt32( pabyPage + 4 ) );
+        memcpy( &abyNewPage[BTREE_NODE_HEADER_SIZE],
+                &abyAll[nLeft * nEntrySize], nRight * nEntrySize );
+
+        memset( pabyEntries, 0, BTREE_PAGE_SIZE - BTREE_NODE_HEADER_SIZE );
+        memcpy( pabyEntries, abyAll.data(), nLeft * nEntrySize );
+        BTreeSetCount( pabyPage, nLeft );
+        BTreeSetUInt32( pabyPage + 4, nNewPage );
+
+        if( !poLIndex->WritePage( nNewPage, abyNewPage.data() ) ||
+            !poLIndex->WritePage( nPage, pabyPage ) )
+            return -1;
+
+        memcpy( pabySplitEntry, &abyAll[nLeft * nEntrySize], nEntrySize );
+        *pnSplitPage = nNewPage;
+        return 1;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Internal node: find the child whose range covers the entry.     */
+/* -------------------------------------------------------------------- */
+    const int nStride = nEntrySize + 4;
+    GByte *pabyEntries = pabyPage + BTREE_NODE_HEADER_SIZE + 4;
+    int nLo = 0;
+    int nHi = nCount;
+    while( nLo < nHi )
+    {
+        const int nMid = (nLo + nHi) / 2;
+        if( memcmp( pabyEntries + nMid * nStride, pabyEntry,
+                    nEntrySize ) <= 0 )
+            nLo = nMid + 1;
+        else
+            nHi = nMid;
+    }
+    const GUInt32 nChild = nLo == 0 ?
+        BTreeGetUInt32( pabyPage + BTREE_NODE_HEADER_SIZE ) :
+        BTreeGetUInt32( pabyEntries + (nLo - 1) * nStride + nEntrySize );
+
+    std::vector<GByte> abyChildSplit( nEntrySize );
+    GUInt32 nChildSplitPage = 0;
+    const int nRet = InsertInto( nChild, nLevel - 1, pabyEntry,
+                                 abyChildSplit.data(), &nChildSplitPage );
+    if( nRet <= 0 || nChildSplitPage == 0 )
+        return nRet;
+
+    // Insert the new separator right after the child we descended into.
+    std::vector<GByte> abyNewItem( nStride );
+    memcpy( abyNewItem.data(), abyChildSplit.data(), nEntrySize );
+    BTreeSetUInt32( &abyNewItem[nEntrySize], nChildSplitPage );
+
+    if( nCount < GetInternalCapacity() )
+    {
+        memmove( pabyEntries + (nLo + 1) * nStride,
+                 pabyEntries + nLo * nStride, (nCount - nLo) * nStride );
+        memcpy( pabyEntries + nLo * nStride, abyNewItem.data(), nStride );
+        BTreeSetCount( pabyPage, nCount + 1 );
+        return poLIndex->WritePage( nPage, pabyPage ) ? 1 : -1;
+    }
+
+    std::vector<GByte> abyAll( (nCount + 1) * nStride );
+    memcpy( abyAll.data(), pabyEntries, nLo * nStride );
+    memcpy( &abyAll[nLo * nStride], abyNewItem.data(), nStride );
+    memcpy( &abyAll[(nLo + 1) * nStride], pabyEntries + nLo * nStride,
+            (nCount - nLo) * nStride );
+
+    const GUInt32 nNewPage = poLIndex->AllocPage();
+    if( nNewPage == 0 )
+        return -1;
+
+    // The middle separator moves up, its child becomes the first child
+    // of the new right node.
+    const int nMiddle = (nCount + 1) / 2;
+    const int nRight = nCount - nMiddle;
+
+    std::vector<GByte> abyNewPage(BTREE_PAGE_SIZE);
+    abyNewPage[0] = BTREE_NODE_INTERNAL;
+    BTreeSetCount( abyNewPage.data(), nRight );
+    BTreeSetUInt32( &abyNewPage[BTREE_NODE_HEADER_SIZE],
+                    BTreeGetUInt32( &abyAll[nMiddle * nStride + nEntrySize] ) );
+    memcpy( &abyNewPage[BTREE_NODE_HEADER_SIZE + 4],
+            &abyAll[(nMiddle + 1) * nStride], nRight * nStride );
+
+    memset( pabyEntries, 0, BTREE_PAGE_SIZE - BTREE_NODE_HEADER_SIZE - 4 );
+    memcpy( pabyEntries, abyAll.data(), nMiddle * nStride );
+    BTreeSetCount( pabyPage, nMiddle );
+
+    if( !poLIndex->WritePage( nNewPage, abyNewPage.data() ) ||
+        !poLIndex->WritePage( nPage, pabyPage ) )
+        return -1;
+
+    memcpy( pabySplitEntry, &abyAll[nMiddle * nStride], nEntrySize );
+    *pnSplitPage = nNewPage;
+    return 1;
+}
+
+/************************************************************************/
+/*                               Insert()                               */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::Insert( const GByte *pabyEntry )
+
+{
+    if( poLIndex->PrepareForUpdate() != OGRERR_NONE )
+        return OGRERR_FAILURE;
+
+    if( nHeight == 0 )
+    {
+        const GUInt32 nPage = poLIndex->AllocPage();
+        if( nPage == 0 )
+            return OGRERR_FAILURE;
+        std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+        abyPage[0] = BTREE_NODE_LEAF;
+        BTreeSetCount( abyPage.data(), 1 );
+        memcpy( &abyPage[BTREE_NODE_HEADER_SIZE], pabyEntry, nEntrySize );
+        if( !poLIndex->WritePage( nPage, abyPage.data() ) )
+            return OGRERR_FAILURE;
+        nRootPage = nPage;
+        nHeight = 1;
+        nEntryCount = 1;
+        poLIndex->SetHeaderDirty();
+        return OGRERR_NONE;
+    }
+
+    std::vector<GByte> abySplit( nEntrySize );
+    GUInt32 nSplitPage = 0;
+    const int nRet = InsertInto( nRootPage, nHeight, pabyEntry,
+                                 abySplit.data(), &nSplitPage );
+    if( nRet < 0 )
+        return OGRERR_FAILURE;
+    if( nRet == 0 )
+        return OGRERR_NONE;
+
+    if( nSplitPage != 0 )
+    {
+        // Grow the tree by one level.
+        const GUInt32 nNewRoot = poLIndex->AllocPage();
+        if( nNewRoot == 0 )
+            return OGRERR_FAILURE;
+        std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+        abyPage[0] = BTREE_NODE_INTERNAL;
+        BTreeSetCount( abyPage.data(), 1 );
+        BTreeSetUInt32( &abyPage[BTREE_NODE_HEADER_SIZE], nRootPage );
+        memcpy( &abyPage[BTREE_NODE_HEADER_SIZE + 4], abySplit.data(),
+                nEntrySize );
+        BTreeSetUInt32( &abyPage[BTREE_NODE_HEADER_SIZE + 4 + nEntrySize],
+                        nSplitPage );
+        if( !poLIndex->WritePage( nNewRoot, abyPage.data() ) )
+            return OGRERR_FAILURE;
+        nRootPage = nNewRoot;
+        nHeight++;
+    }
+
+    nEntryCount++;
+    poLIndex->SetHeaderDirty();
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                               Remove()                               */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::Remove( const GByte *pabyEntry )
+
+{
+    if( nHeight == 0 )
+        return OGRERR_NONE;
+
+    if( poLIndex->PrepareForUpdate() != OGRERR_NONE )
+        return OGRERR_FAILURE;
+
+    std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+    GByte *pabyPage = abyPage.data();
+    GUInt32 nPage = nRootPage;
+    const int nStride = nEntrySize + 4;
+
+    for( int nLevel = nHeight; nLevel > 1; nLevel-- )
+    {
+        if( !poLIndex->ReadPage( nPage, pabyPage ) )
+            return OGRERR_FAILURE;
+        const int nCount = BTreeGetCount( pabyPage );
+        const GByte *pabyEntries = pabyPage + BTREE_NODE_HEADER_SIZE + 4;
+        int i = 0;
+        while( i < nCount &&
+               memcmp( pabyEntries + i * nStride, pabyEntry,
+                       nEntrySize ) <= 0 )
+            i++;
+        nPage = i == 0 ?
+            BTreeGetUInt32( pabyPage + BTREE_NODE_HEADER_SIZE ) :
+            BTreeGetUInt32( pabyEntries + (i - 1) * nStride + nEntrySize );
+    }
+
+    if( !poLIndex->ReadPage( nPage, pabyPage ) )
+        return OGRERR_FAILURE;
+    const int nCount = BTreeGetCount( pabyPage );
+    GByte *pabyEntries = pabyPage + BTREE_NODE_HEADER_SIZE;
+    for( int i = 0; i < nCount; i++ )
+    {
+        if( memcmp( pabyEntries + i * nEntrySize, pabyEntry,
+                    nEntrySize ) == 0 )
+        {
+            memmove( pabyEntries + i * nEntrySize,
+                     pabyEntries + (i + 1) * nEntrySize,
+                     (nCount - i - 1) * nEntrySize );
+            memset( pabyEntries + (nCount - 1) * nEntrySize, 0, nEntrySize );
+            BTreeSetCount( pabyPage, nCount - 1 );
+            if( !poLIndex->WritePage( nPage, pabyPage ) )
+                return OGRERR_FAILURE;
+            if( nEntryCount > 0 )
+                nEntryCount--;
+            poLIndex->SetHeaderDirty();
+            return OGRERR_NONE;
+        }
+    }
+
+    // Not indexed: nothing to do.
+    return OGRERR_NONE;
+}
+
+
+/************************************************************************/
+/*                           BulkPushChild()                            */
+/*                                                                      */
+/*      Appends a child to the internal node being built at iLevel     */
+/*      (0 being the level right above the leaves).  Full nodes are     */
+/*      written and registered into their parent.                       */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::BulkPushChild( std::vector<OGRBTreeBulkLevel>& aoLevels,
+                                       size_t iLevel,
+                                       const GByte *pabyFirstEntry,
+                                       GUInt32 nChild, int nFill )
+
+{
+    if( iLevel == aoLevels.size() )
+    {
+        aoLevels.push_back( OGRBTreeBulkLevel() );
+        aoLevels.back().abyPage.resize( BTREE_PAGE_SIZE );
+    }
+
+    const int nStride = nEntrySize + 4;
+
+    if( aoLevels[iLevel].nChildren > nFill )
+    {
+        if( !poLIndex->WritePage( aoLevels[iLevel].nPage,
+                                  aoLevels[iLevel].abyPage.data() ) )
+            return false;
+        const std::vector<GByte> abyFirst( aoLevels[iLevel].abyFirstEntry );
+        const GUInt32 nFullPage = aoLevels[iLevel].nPage;
+        aoLevels[iLevel].nChildren = 0;
+        // May reallocate aoLevels.
+        if( !BulkPushChild( aoLevels, iLevel + 1, abyFirst.data(),
+                            nFullPage, nFill ) )
+            return false;
+    }
+
+    OGRBTreeBulkLevel& oLevel = aoLevels[iLevel];
+    GByte *pabyPage = oLevel.abyPage.data();
+    if( oLevel.nChildren == 0 )
+    {
+        oLevel.nPage = poLIndex->AllocPage();
+        if( oLevel.nPage == 0 )
+            return false;
+        memset( pabyPage, 0, BTREE_PAGE_SIZE );
+        pabyPage[0] = BTREE_NODE_INTERNAL;
+        BTreeSetUInt32( pabyPage + BTREE_NODE_HEADER_SIZE, nChild );
+        oLevel.abyFirstEntry.assign( pabyFirstEntry,
+                                     pabyFirstEntry + nEntrySize );
+        oLevel.nChildren = 1;
+        return true;
+    }
+
+    GByte *pabyItem = pabyPage + BTREE_NODE_HEADER_SIZE + 4 +
+                      (oLevel.nChildren - 1) * nStride;
+    memcpy( pabyItem, pabyFirstEntry, nEntrySize );
+    BTreeSetUInt32( pabyItem + nEntrySize, nChild );
+    BTreeSetCount( pabyPage, oLevel.nChildren );
+    oLevel.nChildren++;
+    return true;
+}
+
+/************************************************************************/
+/*                              BulkLoad()                              */
+/*                                                                      */
+/*      Builds the tree bottom-up from sorted entries.  Nodes are       */
+/*      filled to 90% to leave some room for later insertions.          */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::BulkLoad( OGRBTreeSorter& oSorter )
+
+{
+    CPLAssert( nHeight == 0 );
+
+    if( poLIndex->PrepareForUpdate() != OGRERR_NONE )
+        return OGRERR_FAILURE;
+
+    const int nLeafFill = std::max(1, GetLeafCapacity() * 9 / 10);
+    const int nInternalFill = std::max(2, GetInternalCapacity() * 9 / 10);
+
+    std::vector<OGRBTreeBulkLevel> aoLevels;
+    std::vector<GByte> abyLeaf(BTREE_PAGE_SIZE);
+    std::vector<GByte> abyPrevEntry;
+    GUInt32 nLeafPage = 0;
+    int nLeafCount = 0;
+    GUIntBig nCount = 0;
+
+    const GByte *pabyEntry = nullptr;
+    while( (pabyEntry = oSorter.Next()) != nullptr )
+    {
+        // The same feature could have been emitted twice.
+        if( !abyPrevEntry.empty() &&
+            memcmp( abyPrevEntry.data(), pabyEntry, nEntrySize ) == 0 )
+            continue;
+        abyPrevEntry.assign( pabyEntry, pabyEntry + nEntrySize );
+
+        if( nLeafPage != 0 && nLeafCount == nLeafFill )
+        {
+            const GUInt32 nNextLeaf = poLIndex->AllocPage();
+            if( nNextLeaf == 0 )
+                return OGRERR_FAILURE;
+            BTreeSetUInt32( &abyLeaf[4], nNextLeaf );
+            if( !poLIndex->WritePage( nLeafPage, abyLeaf.data() ) ||
+                !BulkPushChild( aoLevels, 0,
+                                &abyLeaf[BTREE_NODE_HEADER_SIZE],
+                                nLeafPage, nInternalFill ) )
+                return OGRERR_FAILURE;
+            nLeafPage = nNextLeaf;
+            nLeafCount = 0;
+        }
+        else if( nLeafPage == 0 )
+        {
+            nLeafPage = poLIndex->AllocPage();
+            if( nLeafPage == 0 )
+                return OGRERR_FAILURE;
+        }
+
+        if( nLeafCount == 0 )
+        {
+            std::fill( abyLeaf.begin(), abyLeaf.end(), 0 );
+            abyLeaf[0] = BTREE_NODE_LEAF;
+        }
+        memcpy( &abyLeaf[BTREE_NODE_HEADER_SIZE + nLeafCount * nEntrySize],
+                pabyEntry, nEntrySize );
+        nLeafCount++;
+        BTreeSetCount( abyLeaf.data(), nLeafCount );
+        nCount++;
+    }
+
+    if( nLeafPage == 0 )
+        return OGRERR_NONE;
+
+/* -------------------------------------------------------------------- */
+/*      Flush the last leaf, then close the partially filled nodes      */
+/*      from bottom to top.  The top most node with a single child      */
+/*      is not needed: its child is the root.                           */
+/* -------------------------------------------------------------------- */
+    if( !poLIndex->WritePage( nLeafPage, abyLeaf.data() ) )
+        return OGRERR_FAILURE;
+
+    nRootPage = nLeafPage;
+    nHeight = 1;
+    if( !aoLevels.empty() )
+    {
+        if( !BulkPushChild( aoLevels, 0, &abyLeaf[BTREE_NODE_HEADER_SIZE],
+                            nLeafPage, nInternalFill ) )
+            return OGRERR_FAILURE;
+
+        for( size_t i = 0; i < aoLevels.size(); i++ )
+        {
+            if( i + 1 == aoLevels.size() && aoLevels[i].nChildren == 1 )
+            {
+                nRootPage = BTreeGetUInt32(
+                    &aoLevels[i].abyPage[BTREE_NODE_HEADER_SIZE] );
+                nHeight = static_cast<int>(i) + 1;
+                if( !poLIndex->FreePage( aoLevels[i].nPage ) )
+                    return OGRERR_FAILURE;
+                break;
+            }
+            if( !poLIndex->WritePage( aoLevels[i].nPage,
+                                      aoLevels[i].abyPage.data() ) )
+                return OGRERR_FAILURE;
+            if( i + 1 == aoLevels.size() )
+            {
+                nRootPage = aoLevels[i].nPage;
+                nHeight = static_cast<int>(i) + 2;
+                break;
+            }
+            const std::vector<GByte> abyFirst( aoLevels[i].abyFirstEntry );
+            if( !BulkPushChild( aoLevels, i + 1, abyFirst.data(),
+                                aoLevels[i].nPage, nInternalFill ) )
+                return OGRERR_FAILURE;
+        }
+    }
+
+    nEntryCount = nCount;
+    poLIndex->SetHeaderDirty();
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                                Scan()                                */
+/*                                                                      */
+/*      Visits entries in order, starting at the first entry greater   */
+/*      or equal to pabyStart, until the visitor returns false.         */
+/************************************************************************/
+
+template<class Visitor>
+bool OGRBTreeAttrIndex::Scan( const GByte *pabyStart, Visitor& oVisitor )
+
+{
+    if( nHeight == 0 )
+        return true;
+
+    std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+    GByte *pabyPage = abyPage.data();
+    GUInt32 nPage = nRootPage;
+    const int nStride = nEntrySize + 4;
+
+    for( int nLevel = nHeight; nLevel > 1; nLevel-- )
+    {
+        if( !poLIndex->ReadPage( nPage, pabyPage ) ||
+            pabyPage[0] != BTREE_NODE_INTERNAL )
+            return false;
+        const int nCount = BTreeGetCount( pabyPage );
+        const GByte *pabyEntries = pabyPage + BTREE_NODE_HEADER_SIZE + 4;
+        int nLo = 0;
+        int nHi = nCount;
+        while( nLo < nHi )
+        {
+            const int nMid = (nLo + nHi) / 2;
+            if( memcmp( pabyEntries + nMid * nStride, pabyStart,
+                        nEntrySize ) <= 0 )
+                nLo = nMid + 1;
+            else
+                nHi = nMid;
+        }
+        nPage = nLo == 0 ?
+            BTreeGetUInt32( pabyPage + BTREE_NODE_HEADER_SIZE ) :
+            BTreeGetUInt32( pabyEntries + (nLo - 1) * nStride + nEntrySize );
+    }
+
+    if( !poLIndex->ReadPage( nPage, pabyPage ) ||
+        pabyPage[0] != BTREE_NODE_LEAF )
+        return false;
+
+    int nCount = BTreeGetCount( pabyPage );
+    const GByte *pabyEntries = pabyPage + BTREE_NODE_HEADER_SIZE;
+    int i = 0;
+    {
+        int nHi = nCount;
+        while( i < nHi )
+        {
+            const int nMid = (i + nHi) / 2;
+            if( memcmp( pabyEntries + nMid * nEntrySize, pabyStart,
+                        nEntrySize ) < 0 )
+                i = nMid + 1;
+            else
+                nHi = nMid;
+        }
+    }
+
+    while( true )
+    {
+        for( ; i < nCount; i++ )
+        {
+            if( !oVisitor( pabyEntries + i * nEntrySize ) )
+                return true;
+        }
+        nPage = BTreeGetUInt32( pabyPage + 4 );
+        if( nPage == 0 )
+            return true;
+        if( !poLIndex->ReadPage( nPage, pabyPage ) ||
+            pabyPage[0] != BTREE_NODE_LEAF )
+            return false;
+        nCount = BTreeGetCount( pabyPage );
+        i = 0;
+    }
+}
+
+/************************************************************************/
+/*                           CollectMatches()                           */
+/*                                                                      */
+/*      Appends to panFIDList the FIDs of the entries whose key is in   */
+/*      the requested range.  With nPrefixLen > 0, pabyMinKey is a      */
+/*      prefix and all keys starting with it are returned.              */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::CollectMatches( const GByte *pabyMinKey,
+                                            bool bMinIncluded,
+                                            const GByte *pabyMaxKey,
+                                            bool bMaxIncluded,
+                                            int nPrefixLen,
+                                            GIntBig* panFIDList,
+                                            int* nFIDCount, int* nLength )
+
+{
+    if( panFIDList == nullptr )
+    {
+        panFIDList = static_cast<GIntBig *>(CPLMalloc(sizeof(GIntBig) * 2));
+        *nFIDCount = 0;
+        *nLength = 2;
+    }
+
+    // Smallest entry with the min key, whatever its FID.
+    std::vector<GByte> abyStart( nEntrySize );
+    if( pabyMinKey != nullptr )
+        memcpy( abyStart.data(), pabyMinKey, nKeySize );
+
+    const int nKeySizeLocal = nKeySize;
+    bool bOverflow = false;
+    auto oVisitor = [&](const GByte *pabyEntry) -> bool
+    {
+        if( nPrefixLen > 0 )
+        {
+            if( memcmp( pabyEntry, pabyMinKey, nPrefixLen ) != 0 )
+                return false;
+        }
+        else
+        {
+            if( pabyMinKey != nullptr && !bMinIncluded &&
+                memcmp( pabyEntry, pabyMinKey, nKeySizeLocal ) == 0 )
+                return true;
+            if( pabyMaxKey != nullptr )
+            {
+                const int nCmp = memcmp( pabyEntry, pabyMaxKey,
+                                         nKeySizeLocal );
+                if( nCmp > 0 || (nCmp == 0 && !bMaxIncluded) )
+                    return false;
+            }
+        }
+
+        if( *nFIDCount >= *nLength - 1 )
+        {
+            if( *nLength > INT_MAX / 2 - 10 )
+            {
+                bOverflow = true;
+                return false;
+            }
+            *nLength = (*nLength) * 2 + 10;
+            panFIDList = static_cast<GIntBig *>(
+                CPLRealloc(panFIDList, sizeof(GIntBig) * (*nLength)));
+        }
+        panFIDList[(*nFIDCount)++] = BTreeDecodeFID( pabyEntry + nKeySizeLocal );
+        return true;
+    };
+
+    if( !Scan( abyStart.data(), oVisitor ) || bOverflow )
+    {
+        if( bOverflow )
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Too many matches in attribute index." );
+        CPLFree( panFIDList );
+        return nullptr;
+    }
+
+    panFIDList[*nFIDCount] = OGRNullFID;
+
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                           GetFirstMatch()                            */
+/************************************************************************/
+
+GIntBig OGRBTreeAttrIndex::GetFirstMatch( OGRField *psKey )
+
+{
+    int nFIDCount = 0;
+    int nLength = 0;
+    GIntBig *panFIDs = GetAllMatches( psKey, nullptr, &nFIDCount, &nLength );
+    const GIntBig nFID = ( panFIDs != nullptr && nFIDCount > 0 ) ?
+                                                panFIDs[0] : OGRNullFID;
+    CPLFree( panFIDs );
+    return nFID;
+}
+
+/************************************************************************/
+/*                           GetAllMatches()                            */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::GetAllMatches( OGRField *psKey,
+                                           GIntBig* panFIDList,
+                                           int* nFIDCount, int* nLength )
+{
+    return GetRangeMatches( psKey, true, psKey, true,
+                            panFIDList, nFIDCount, nLength );
+}
+
+GIntBig *OGRBTreeAttrIndex::GetAllMatches( OGRField *psKey )
+{
+    int nFIDCount = 0;
+    int nLength = 0;
+    return GetAllMatches( psKey, nullptr, &nFIDCount, &nLength );
+}
+
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::GetRangeMatches( OGRField *psMinKey,
+                                             bool bMinIncluded,
+                                             OGRField *psMaxKey,
+                                             bool bMaxIncluded,
+                                             GIntBig* panFIDList,
+                                             int* nFIDCount, int* nLength )
+
+{
+    std::vector<GByte> abyMin( nKeySize );
+    std::vector<GByte> abyMax( nKeySize );
+    if( (psMinKey != nullptr && !EncodeKey( psMinKey, abyMin.data() )) ||
+        (psMaxKey != nullptr && !EncodeKey( psMaxKey, abyMax.data() )) )
+    {
+        // NaN bounds match nothing.
+        if( panFIDList == nullptr )
+        {
+            panFIDList = static_cast<GIntBig *>(CPLMalloc(sizeof(GIntBig)));
+            *nFIDCount = 0;
+            *nLength = 1;
+        }
+        panFIDList[*nFIDCount] = OGRNullFID;
+        return panFIDList;
+    }
+
+    return CollectMatches( psMinKey ? abyMin.data() : nullptr, bMinIncluded,
+                           psMaxKey ? abyMax.data() : nullptr, bMaxIncluded,
+                           0, panFIDList, nFIDCount, nLength );
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::GetPrefixMatches( const char *pszPrefix,
+                                              GIntBig* panFIDList,
+                                              int* nFIDCount, int* nLength )
+
+{
+    if( eFieldType != OFTString || pszPrefix[0] == '\0' )
+        return nullptr;
+
+    std::vector<GByte> abyPrefix( nKeySize );
+    OGRField sKey;
+    sKey.String = const_cast<char *>(pszPrefix);
+    EncodeKey( &sKey, abyPrefix.data() );
+
+    const int nPrefixLen =
+        std::min( static_cast<int>(strlen(pszPrefix)), nKeySize );
+
+    return CollectMatches( abyPrefix.data(), true, nullptr, true,
+                           nPrefixLen, panFIDList, nFIDCount, nLength );
+}
+
+/************************************************************************/
+/*                              AddEntry()                              */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::AddEntry( OGRField *psKey, GIntBig nFID )
+
+{
+    if( psKey == nullptr )
+        return OGRERR_FAILURE;
+
+    std::vector<GByte> abyEntry( nEntrySize );
+    if( !EncodeKey( psKey, abyEntry.data() ) )
+        return OGRERR_NONE;
+    BTreeEncodeFID( nFID, abyEntry.data() + nKeySize );
+
+    return Insert( abyEntry.data() );
+}
+
+/************************************************************************/
+/*                            RemoveEntry()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::RemoveEntry( OGRField *psKey, GIntBig nFID )
+
+{
+    if( psKey == nullptr )
+        return OGRERR_FAILURE;
+
+    std::vector<GByte> abyEntry( nEntrySize );
+    if( !EncodeKey( psKey, abyEntry.data() ) )
+        return OGRERR_NONE;
+    BTreeEncodeFID( nFID, abyEntry.data() + nKeySize );
+
+    return Remove( abyEntry.data() );
+}
+
+/************************************************************************/
+/*                            FreeSubTree()                             */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::FreeSubTree( GUInt32 nPage, int nLevel )
+
+{
+    if( nLevel > 1 )
+    {
+        std::vector<GByte> abyPage(BTREE_PAGE_SIZE);
+        if( !poLIndex->ReadPage( nPage, abyPage.data() ) )
+            return false;
+        const int nCount = BTreeGetCount( abyPage.data() );
+        const int nStride = nEntrySize + 4;
+        if( !FreeSubTree( BTreeGetUInt32( &abyPage[BTREE_NODE_HEADER_SIZE] ),
+                          nLevel - 1 ) )
+            return false;
+        for( int i = 0; i < nCount; i++ )
+        {
+            if( !FreeSubTree( BTreeGetUInt32(
+                    &abyPage[BTREE_NODE_HEADER_SIZE + 4 + i * nStride +
+                             nEntrySize] ), nLevel - 1 ) )
+                return false;
+        }
+    }
+    return poLIndex->FreePage( nPage );
+}
+
+/************************************************************************/
+/*                               Clear()                                */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::Clear()
+
+{
+    if( nHeight == 0 )
+        return OGRERR_NONE;
+
+    if( poLIndex->PrepareForUpdate() != OGRERR_NONE ||
+        !FreeSubTree( nRootPage, nHeight ) )
+        return OGRERR_FAILURE;
+
+    nRootPage = 0;
+    nHeight = 0;
+    nEntryCount = 0;
+    poLIndex->SetHeaderDirty();
+    return OGRERR_NONE;
+}
+
+//! @endcond
@@ -651,10 +651,13 @@ OGRErr OGRMILayerAttrIndex::RemoveFromIndex( OGRFeature * /*poFeature*/ )
 }
 
 /************************************************************************/
-/*                     OGRCreateDefaultLayerIndex()                     */
+/*                       OGRCreateMILayerIndex()                        */
+/*                                                                      */
+/*      Used for MapInfo native indexes, and for legacy .idm/.ind       */
+/*      indexes created by previous versions.                           */
 /************************************************************************/
 
-OGRLayerAttrIndex *OGRCreateDefaultLayerIndex()
+OGRLayerAttrIndex *OGRCreateMILayerIndex()
 
 {
     return new OGRMILayerAttrIndex();
@@ -757,7 +760,9 @@ GByte *OGRMIAttrIndex::BuildKey( OGRField *psKey )
         break;
 
       default:
-        CPLAssert( false );
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "Indexing not support for the field type of field %s.",
+                  poFldDefn->GetNameRef() );
         break;
     }
     return ret;
@@ -771,6 +776,9 @@ GIntBig OGRMIAttrIndex::GetFirstMatch( OGRField *psKey )
 
 {
     GByte *pabyKey = BuildKey( psKey );
+    if( pabyKey == nullptr )
+        return OGRNullFID;
+
     const GIntBig nFID = poINDFile->FindFirst( iIndex, pabyKey );
     if( nFID < 1 )
         return OGRNullFID;
@@ -793,7 +801,7 @@ GIntBig *OGRMIAttrIndex::GetAllMatches( OGRField *psKey, GIntBig* panFIDList, in
         *nLength = 2;
     }
 
-    GIntBig nFID = poINDFile->FindFirst( iIndex, pabyKey );
+    GIntBig nFID = pabyKey ? poINDFile->FindFirst( iIndex, pabyKey ) : 0;
     while( nFID > 0 )
     {
         if( *nFIDCount >= *nLength-1 )
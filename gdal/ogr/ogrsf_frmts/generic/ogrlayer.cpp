@@ -549,6 +549,41 @@ OGRFeatureH OGR_L_GetNextFeature( OGRLayerH hLayer )
     return (OGRFeatureH) ((OGRLayer *)hLayer)->GetNextFeature();
 }
 
+/************************************************************************/
+/*                         GetNextFeatureInto()                         */
+/*                                                                      */
+/*      Default implementation: the content of a newly fetched          */
+/*      feature is transferred into the provided one.  Drivers can      */
+/*      override it to decode directly into the provided feature,       */
+/*      reusing its field buffers and geometries.                       */
+/************************************************************************/
+
+bool OGRLayer::GetNextFeatureInto( OGRFeature *poFeature )
+
+{
+    OGRFeature *poNextFeature = GetNextFeature();
+    if( poNextFeature == nullptr )
+        return false;
+
+    const bool bRet = poFeature->SwapContent( poNextFeature );
+    delete poNextFeature;
+    return bRet;
+}
+
+/************************************************************************/
+/*                      OGR_L_GetNextFeatureInto()                      */
+/************************************************************************/
+
+int OGR_L_GetNextFeatureInto( OGRLayerH hLayer, OGRFeatureH hFeat )
+
+{
+    VALIDATE_POINTER1( hLayer, "OGR_L_GetNextFeatureInto", FALSE );
+    VALIDATE_POINTER1( hFeat, "OGR_L_GetNextFeatureInto", FALSE );
+
+    return reinterpret_cast<OGRLayer *>(hLayer)->
+        GetNextFeatureInto( reinterpret_cast<OGRFeature *>(hFeat) );
+}
+
 /************************************************************************/
 /*                       ConvertGeomsIfNecessary()                      */
 /************************************************************************/
@@ -1491,7 +1526,22 @@ OGRErr OGRLayer::InitializeIndexSupport( const char *pszFilename )
     if (m_poAttrIndex != nullptr)
         return OGRERR_NONE;
 
-    m_poAttrIndex = OGRCreateDefaultLayerIndex();
+/* -------------------------------------------------------------------- */
+/*      MapInfo native indexes are passed as an in-memory XML           */
+/*      description.  Indexes created with the former .idm/.ind        */
+/*      default implementation are still honoured if present.          */
+/* -------------------------------------------------------------------- */
+    VSIStatBufL sStat;
+    if( STARTS_WITH_CI(pszFilename, "<OGRMILayerAttrIndex>") ||
+        (VSIStatL(CPLResetExtension(pszFilename, "obi"), &sStat) != 0 &&
+         VSIStatL(CPLResetExtension(pszFilename, "idm"), &sStat) == 0) )
+    {
+        m_poAttrIndex = OGRCreateMILayerIndex();
+    }
+    else
+    {
+        m_poAttrIndex = OGRCreateDefaultLayerIndex();
+    }
 
     eErr = m_poAttrIndex->Initialize( pszFilename, this );
     if( eErr != OGRERR_NONE )
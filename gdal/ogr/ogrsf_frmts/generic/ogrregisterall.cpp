@@ -97,6 +97,7 @@ void OGRRegisterAllInternal()
     RegisterOGRGeoJSON();
     RegisterOGRESRIJSON();
     RegisterOGRTopoJSON();
+    RegisterOGRGeoJSONSeq();
 #endif
 #ifdef ILI_ENABLED
     RegisterOGRILI1();
@@ -302,6 +303,9 @@ void OGRRegisterAllInternal()
 #ifdef MVT_ENABLED
     RegisterOGRMVT();
 #endif
+#ifdef FLATGEOBUF_ENABLED
+    RegisterOGRFlatGeobuf();
+#endif
 
 /* Put TIGER and AVCBIN at end since they need poOpenInfo->GetSiblingFiles() */
 #ifdef TIGER_ENABLED
@@ -259,6 +259,9 @@ class OGRGeoJSONDataSource : public OGRDataSource
                     GeoJSONSourceType nSrcType,
                     const char* pszUnprefixed,
                     const char* pszJSonFlavor);
+    void LoadESRIJSONLayer(GDALOpenInfo* poOpenInfo,
+                           GeoJSONSourceType nSrcType,
+                           const char* pszUnprefixed);
     void SetOptionsOnReader(GDALOpenInfo* poOpenInfo,
                             OGRGeoJSONReader* poReader);
     void CheckExceededTransferLimit( json_object* poObj );
@@ -127,7 +127,7 @@ void OGRESRIJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS,
     if( poSRS != nullptr )
         poSRS->Release();
 
-    if( !GenerateLayerDefn() )
+    if( !GenerateLayerDefn(poGJObject_) )
     {
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Layer schema generation failed." );
@@ -153,9 +153,9 @@ void OGRESRIJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS,
 /*                        GenerateFeatureDefn()                         */
 /************************************************************************/
 
-bool OGRESRIJSONReader::GenerateLayerDefn()
+bool OGRESRIJSONReader::GenerateLayerDefn( json_object* poObj )
 {
-    CPLAssert( nullptr != poGJObject_ );
+    CPLAssert( nullptr != poObj );
     CPLAssert( nullptr != poLayer_->GetLayerDefn() );
     CPLAssert( 0 == poLayer_->GetLayerDefn()->GetFieldCount() );
 
@@ -165,7 +165,7 @@ bool OGRESRIJSONReader::GenerateLayerDefn()
 /*      Scan all features and generate layer definition.                */
 /* -------------------------------------------------------------------- */
     json_object* poObjFeatures =
-        OGRGeoJSONFindMemberByName( poGJObject_, "fields" );
+        OGRGeoJSONFindMemberByName( poObj, "fields" );
     if( nullptr != poObjFeatures &&
         json_type_array == json_object_get_type( poObjFeatures ) )
     {
@@ -184,7 +184,7 @@ bool OGRESRIJSONReader::GenerateLayerDefn()
     else
     {
         poObjFeatures = OGRGeoJSONFindMemberByName(
-            poGJObject_, "fieldAliases" );
+            poObj, "fieldAliases" );
         if( nullptr != poObjFeatures &&
             json_object_get_type(poObjFeatures) == json_type_object )
         {
@@ -762,7 +762,6 @@ OGRGeometry* OGRESRIJSONReadLineString( json_object* poObj )
                 poMLS = new OGRMultiLineString();
                 poRet = poMLS;
             }
-            poMLS->addGeometryDirectly(poLine);
         }
         else
         {
@@ -781,6 +780,8 @@ OGRGeometry* OGRESRIJSONReadLineString( json_object* poObj )
             if( !OGRESRIJSONReaderParseXYZMArray (
               poObjCoords, bHasZ, bHasM, &dfX, &dfY, &dfZ, &dfM, &nNumCoords) )
             {
+                if( poMLS != nullptr )
+                    delete poLine;
                 delete poRet;
                 return nullptr;
             }
@@ -802,6 +803,10 @@ OGRGeometry* OGRESRIJSONReadLineString( json_object* poObj )
                 poLine->addPoint( dfX, dfY );
             }
         }
+        // Add the path once filled, so that the multilinestring gets the
+        // dimension of its coordinates.
+        if( poMLS != nullptr )
+            poMLS->addGeometryDirectly(poLine);
     }
 
     if( poRet == nullptr )
@@ -862,7 +867,6 @@ OGRGeometry* OGRESRIJSONReadPolygon( json_object* poObj)
 
         OGRPolygon* poPoly = new OGRPolygon();
         OGRLinearRing* poLine = new OGRLinearRing();
-        poPoly->addRingDirectly(poLine);
         papoGeoms[iRing] = poPoly;
 
         const int nPoints = json_object_array_length( poObjRing );
@@ -878,6 +882,7 @@ OGRGeometry* OGRESRIJSONReadPolygon( json_object* poObj)
             if( !OGRESRIJSONReaderParseXYZMArray (
               poObjCoords, bHasZ, bHasM, &dfX, &dfY, &dfZ, &dfM, &nNumCoords) )
             {
+                delete poLine;
                 for( int j = 0; j <= iRing; j++ )
                     delete papoGeoms[j];
                 delete[] papoGeoms;
@@ -901,6 +906,9 @@ OGRGeometry* OGRESRIJSONReadPolygon( json_object* poObj)
                 poLine->addPoint( dfX, dfY );
             }
         }
+        // Add the ring once filled, so that the polygon gets the
+        // dimension of its coordinates.
+        poPoly->addRingDirectly(poLine);
     }
 
     OGRGeometry* poRet = OGRGeometryFactory::organizePolygons( papoGeoms,
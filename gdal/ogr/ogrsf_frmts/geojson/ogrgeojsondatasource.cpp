@@ -766,22 +766,13 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
 
 /* -------------------------------------------------------------------- */
 /*      Is it ESRI Feature Service data ?                               */
+/*      Files go through the streaming interface of the GeoJSON         */
+/*      reader below.                                                   */
 /* -------------------------------------------------------------------- */
-    if( EQUAL(pszJSonFlavor, "ESRIJSON") )
+    const bool bESRIJSON = EQUAL(pszJSonFlavor, "ESRIJSON");
+    if( bESRIJSON && nSrcType != eGeoJSONSourceFile )
     {
-        OGRESRIJSONReader reader;
-        if( nSrcType == eGeoJSONSourceFile )
-        {
-            if( !ReadFromFile( poOpenInfo, pszUnprefixed ) )
-                return;
-        }
-        OGRErr err = reader.Parse( pszGeoData_ );
-        if( OGRERR_NONE == err )
-        {
-            json_object* poObj = reader.GetJSonObject();
-            CheckExceededTransferLimit(poObj);
-            reader.ReadLayers( this, nSrcType );
-        }
+        LoadESRIJSONLayer(poOpenInfo, nSrcType, pszUnprefixed);
         return;
     }
 
@@ -791,12 +782,23 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
     if( EQUAL(pszJSonFlavor, "TOPOJSON") )
     {
         OGRTopoJSONReader reader;
+        OGRErr err = OGRERR_NONE;
         if( nSrcType == eGeoJSONSourceFile )
         {
-            if( !ReadFromFile( poOpenInfo, pszUnprefixed ) )
+            // Stream the file, so that the arcs are directly decoded and
+            // never held in a json-c tree.
+            VSILFILE* fp = EQUAL(poOpenInfo->pszFilename, pszUnprefixed) ?
+                poOpenInfo->fpL : VSIFOpenL(pszUnprefixed, "rb");
+            if( fp == nullptr )
                 return;
+            err = reader.Parse( fp );
+            if( fp != poOpenInfo->fpL )
+                VSIFCloseL(fp);
+        }
+        else
+        {
+            err = reader.Parse( pszGeoData_ );
         }
-        OGRErr err = reader.Parse( pszGeoData_ );
         if( OGRERR_NONE == err )
         {
             reader.ReadLayers( this );
@@ -819,7 +821,7 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
         oOpenInfo.fpL = nullptr;
     }
 
-    if( !GeoJSONIsObject( pszGeoData_) )
+    if( !bESRIJSON && !GeoJSONIsObject( pszGeoData_) )
     {
         CPLDebug( pszJSonFlavor,
                   "No valid %s data found in source '%s'",
@@ -834,6 +836,7 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
 /* -------------------------------------------------------------------- */
     OGRGeoJSONReader* poReader = new OGRGeoJSONReader();
     SetOptionsOnReader(poOpenInfo, poReader);
+    poReader->SetESRIJSON(bESRIJSON);
 
 /* -------------------------------------------------------------------- */
 /*      Parse GeoJSON and build valid OGRLayer instance.                */
@@ -845,8 +848,14 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
         (!STARTS_WITH(pszUnprefixed, "/vsistdin/") ||
          (nMaxBytesFirstPass > 0 && nMaxBytesFirstPass <= 1000000)) )
     {
+        // The "features" member of ESRIJSON generally comes after the
+        // (possibly long) "fields" one, so do not require it in the header.
         const char* pszStr = strstr( pszGeoData_, "\"features\"");
-        if( pszStr )
+        if( bESRIJSON )
+        {
+            bUseStreamingInterface = true;
+        }
+        else if( pszStr )
         {
             pszStr += strlen("\"features\"");
             while( *pszStr && isspace(*pszStr) )
@@ -893,6 +902,12 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
 
     if( fp )
         VSIFCloseL(fp);
+    if( bESRIJSON )
+    {
+        delete poReader;
+        LoadESRIJSONLayer(poOpenInfo, nSrcType, pszUnprefixed);
+        return;
+    }
     if( nSrcType == eGeoJSONSourceFile )
     {
         if( !ReadFromFile( poOpenInfo, pszUnprefixed ) )
@@ -912,6 +927,29 @@ void OGRGeoJSONDataSource::LoadLayers(GDALOpenInfo* poOpenInfo,
     delete poReader;
 }
 
+/************************************************************************/
+/*                         LoadESRIJSONLayer()                          */
+/************************************************************************/
+
+void OGRGeoJSONDataSource::LoadESRIJSONLayer(GDALOpenInfo* poOpenInfo,
+                                             GeoJSONSourceType nSrcType,
+                                             const char* pszUnprefixed)
+{
+    OGRESRIJSONReader reader;
+    if( nSrcType == eGeoJSONSourceFile )
+    {
+        if( !ReadFromFile( poOpenInfo, pszUnprefixed ) )
+            return;
+    }
+    OGRErr err = reader.Parse( pszGeoData_ );
+    if( OGRERR_NONE == err )
+    {
+        json_object* poObj = reader.GetJSonObject();
+        CheckExceededTransferLimit(poObj);
+        reader.ReadLayers( this, nSrcType );
+    }
+}
+
 /************************************************************************/
 /*                          SetOptionsOnReader()                        */
 /************************************************************************/
@@ -157,6 +157,8 @@ OGRGeoJSONReader::OGRGeoJSONReader() :
     chNestedAttributeSeparator_(0),
     bStoreNativeData_(false),
     bArrayAsString_(false),
+    bESRIJSON_(false),
+    poESRIJSONReader_(nullptr),
     nBufferSize_(0),
     pabyBuffer_(nullptr),
     nTotalFeatureCount_(0),
@@ -184,6 +186,7 @@ OGRGeoJSONReader::~OGRGeoJSONReader()
         VSIFCloseL(fp_);
     }
     delete poStreamingParser_;
+    delete poESRIJSONReader_;
     CPLFree(pabyBuffer_);
 
     poGJObject_ = nullptr;
@@ -488,7 +491,13 @@ void OGRGeoJSONReaderStreamingParser::EndObject()
                 m_osJson.size() + strlen("application/vnd.geo+json");
         }
 
-        if( m_bFirstPass )
+        if( m_bFirstPass && m_oReader.bESRIJSON_ )
+        {
+            // The ESRIJSON schema comes from the "fields" member of the
+            // root object, so features only need to be counted here.
+            m_poLayer->IncFeatureCount();
+        }
+        else if( m_bFirstPass )
         {
             json_object* poObjTypeObj =
                 CPL_json_object_object_get(m_poCurObj, "type");
@@ -504,8 +513,10 @@ void OGRGeoJSONReaderStreamingParser::EndObject()
         }
         else
         {
-            OGRFeature* poFeat = m_oReader.ReadFeature(m_poLayer, m_poCurObj,
-                                                       m_osJson.c_str());
+            OGRFeature* poFeat = m_oReader.bESRIJSON_ ?
+                m_oReader.poESRIJSONReader_->ReadFeature(m_poCurObj) :
+                m_oReader.ReadFeature(m_poLayer, m_poCurObj,
+                                      m_osJson.c_str());
             if( poFeat )
             {
                 m_apoFeatures.push_back( poFeat );
@@ -554,7 +565,7 @@ void OGRGeoJSONReaderStreamingParser::StartObjectMember(const char* pszKey,
     {
         m_bInFeatures = strcmp(pszKey, "features") == 0;
         m_bCanEasilyAppend = m_bInFeatures;
-        m_bInType = strcmp(pszKey, "type") == 0;
+        m_bInType = !m_oReader.bESRIJSON_ && strcmp(pszKey, "type") == 0;
         if( m_bInType || m_bInFeatures )
         {
             m_poCurObj = nullptr;
@@ -606,6 +617,13 @@ void OGRGeoJSONReaderStreamingParser::StartArray()
     if( m_nDepth == 1 && m_bInFeatures )
     {
         m_bInFeaturesArray = true;
+        // ESRIJSON has no root "type" member: a "features" array is what
+        // identifies a FeatureSet.
+        if( m_oReader.bESRIJSON_ )
+        {
+            m_bIsTypeKnown = true;
+            m_bIsFeatureCollection = true;
+        }
     }
     else if( m_poCurObj )
     {
@@ -837,6 +855,8 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
     const char* pszName = poDS->GetDescription();
     if( STARTS_WITH_CI(pszName, "GeoJSON:") )
         pszName += strlen("GeoJSON:");
+    else if( STARTS_WITH_CI(pszName, "ESRIJSON:") )
+        pszName += strlen("ESRIJSON:");
     pszName = CPLGetBasename(pszName);
 
     OGRGeoJSONLayer* poLayer =
@@ -845,6 +865,12 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
                            poDS, this );
     OGRGeoJSONReaderStreamingParser oParser(*this, poLayer,
                                             true, bStoreNativeData_);
+    if( bESRIJSON_ )
+    {
+        delete poESRIJSONReader_;
+        poESRIJSONReader_ = new OGRESRIJSONReader();
+        poESRIJSONReader_->SetLayer(poLayer);
+    }
 
     vsi_l_offset nFileSize = 0;
     if( STARTS_WITH(poDS->GetDescription(), "/vsimem/") ||
@@ -954,6 +980,10 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
         return false;
     }
 
+    if( bESRIJSON_ )
+        return FinalizeESRIJSONLayer( poDS, fp, poLayer,
+                                      oParser.StealRootObject() );
+
     FinalizeLayerDefn(poLayer);
 
     bCanEasilyAppend_ = oParser.CanEasilyAppend();
@@ -1024,6 +1054,48 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
     return true;
 }
 
+/************************************************************************/
+/*                       FinalizeESRIJSONLayer()                        */
+/************************************************************************/
+
+bool OGRGeoJSONReader::FinalizeESRIJSONLayer( OGRGeoJSONDataSource* poDS,
+                                              VSILFILE* fp,
+                                              OGRGeoJSONLayer* poLayer,
+                                              json_object* poRootObj )
+{
+    nTotalFeatureCount_ = poLayer->GetFeatureCount(FALSE);
+
+    if( poRootObj == nullptr ||
+        !poESRIJSONReader_->GenerateLayerDefn(poRootObj) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Layer schema generation failed." );
+        if( poRootObj )
+            json_object_put(poRootObj);
+        // to avoid killing ourselves during layer deletion
+        poLayer->UnsetReader();
+        delete poLayer;
+        return false;
+    }
+
+    OGRFeatureDefn* poDefn = poLayer->GetLayerDefn();
+    poDefn->SetGeomType( OGRESRIJSONGetGeometryType(poRootObj) );
+
+    OGRSpatialReference* poSRS = OGRESRIJSONReadSpatialReference( poRootObj );
+    if( poSRS != nullptr )
+    {
+        if( poDefn->GetGeomType() != wkbNone )
+            poDefn->GetGeomFieldDefn(0)->SetSpatialRef(poSRS);
+        poSRS->Release();
+    }
+    CPLErrorReset();
+
+    poGJObject_ = poRootObj;
+    fp_ = fp;
+    poDS->AddLayer(poLayer);
+    return true;
+}
+
 /************************************************************************/
 /*               SkipPrologEpilogAndUpdateJSonPLikeWrapper()            */
 /************************************************************************/
@@ -1474,6 +1546,18 @@ void OGRGeoJSONReader::SetArrayAsString( bool bArrayAsString )
     bArrayAsString_ = bArrayAsString;
 }
 
+/************************************************************************/
+/*                             SetESRIJSON                              */
+/************************************************************************/
+
+void OGRGeoJSONReader::SetESRIJSON( bool bESRIJSON )
+{
+    bESRIJSON_ = bESRIJSON;
+    // NATIVE_DATA is only defined for GeoJSON.
+    if( bESRIJSON_ )
+        bStoreNativeData_ = false;
+}
+
 /************************************************************************/
 /*                         GenerateLayerDefn()                          */
 /************************************************************************/
@@ -1536,10 +1620,20 @@ bool OGRGeoJSONReader::GenerateLayerDefn( OGRGeoJSONLayer* poLayer,
 /************************************************************************/
 
 void OGRGeoJSONReader::FinalizeLayerDefn(OGRGeoJSONLayer* poLayer)
+{
+    CPLString osFIDColumn;
+    FinalizeLayerDefn(poLayer, osFIDColumn);
+    if( !osFIDColumn.empty() )
+        poLayer->SetFIDColumn(osFIDColumn);
+}
+
+void OGRGeoJSONReader::FinalizeLayerDefn( OGRLayer* poLayer,
+                                          CPLString& osFIDColumn )
 {
 /* -------------------------------------------------------------------- */
 /*      Validate and add FID column if necessary.                       */
 /* -------------------------------------------------------------------- */
+    osFIDColumn.clear();
     OGRFeatureDefn* poLayerDefn = poLayer->GetLayerDefn();
     CPLAssert( nullptr != poLayerDefn );
 
@@ -1552,8 +1646,7 @@ void OGRGeoJSONReader::FinalizeLayerDefn(OGRGeoJSONLayer* poLayer)
             if( poFDefn->GetType() == OFTInteger ||
                 poFDefn->GetType() == OFTInteger64 )
             {
-                poLayer->SetFIDColumn(
-                    poLayerDefn->GetFieldDefn(idx)->GetNameRef() );
+                osFIDColumn = poLayerDefn->GetFieldDefn(idx)->GetNameRef();
             }
         }
     }
@@ -1839,7 +1932,7 @@ void OGRGeoJSONReaderAddOrUpdateField(
 /************************************************************************/
 /*                        GenerateFeatureDefn()                         */
 /************************************************************************/
-bool OGRGeoJSONReader::GenerateFeatureDefn( OGRGeoJSONLayer* poLayer,
+bool OGRGeoJSONReader::GenerateFeatureDefn( OGRLayer* poLayer,
                                             json_object* poObj )
 {
     OGRFeatureDefn* poDefn = poLayer->GetLayerDefn();
@@ -2287,7 +2380,7 @@ void OGRGeoJSONReaderSetField( OGRLayer* poLayer,
 /*                           ReadFeature()                              */
 /************************************************************************/
 
-OGRFeature* OGRGeoJSONReader::ReadFeature( OGRGeoJSONLayer* poLayer,
+OGRFeature* OGRGeoJSONReader::ReadFeature( OGRLayer* poLayer,
                                            json_object* poObj,
                                            const char* pszSerializedObj )
 {
@@ -38,6 +38,7 @@
 #include "ogrgeojsonutils.h"
 
 #include <set>
+#include <vector>
 
 /************************************************************************/
 /*                         FORWARD DECLARATIONS                         */
@@ -90,6 +91,8 @@ struct GeoJSONObject
 
 class OGRGeoJSONDataSource;
 class OGRGeoJSONReaderStreamingParser;
+class OGRGeoJSONSeqLayer;
+class OGRESRIJSONReader;
 
 class OGRGeoJSONReader
 {
@@ -102,6 +105,7 @@ class OGRGeoJSONReader
     void SetFlattenNestedAttributes( bool bFlatten, char chSeparator );
     void SetStoreNativeData( bool bStoreNativeData );
     void SetArrayAsString( bool bArrayAsString );
+    void SetESRIJSON( bool bESRIJSON );
 
     OGRErr Parse( const char* pszText );
     void ReadLayers( OGRGeoJSONDataSource* poDS );
@@ -123,6 +127,7 @@ class OGRGeoJSONReader
 
   private:
     friend class OGRGeoJSONReaderStreamingParser;
+    friend class OGRGeoJSONSeqLayer;
 
     json_object* poGJObject_;
     OGRGeoJSONReaderStreamingParser* poStreamingParser_;
@@ -138,6 +143,8 @@ class OGRGeoJSONReader
     char chNestedAttributeSeparator_;
     bool bStoreNativeData_;
     bool bArrayAsString_;
+    bool bESRIJSON_;
+    OGRESRIJSONReader* poESRIJSONReader_;
     std::set<int> aoSetUndeterminedTypeFields_;
 
     size_t nBufferSize_;
@@ -165,13 +172,17 @@ class OGRGeoJSONReader
     // Translation utilities.
     //
     bool GenerateLayerDefn( OGRGeoJSONLayer* poLayer, json_object* poGJObject );
-    bool GenerateFeatureDefn( OGRGeoJSONLayer* poLayer, json_object* poObj );
+    bool GenerateFeatureDefn( OGRLayer* poLayer, json_object* poObj );
     void FinalizeLayerDefn( OGRGeoJSONLayer* poLayer );
+    void FinalizeLayerDefn( OGRLayer* poLayer, CPLString& osFIDColumn );
+    bool FinalizeESRIJSONLayer( OGRGeoJSONDataSource* poDS, VSILFILE* fp,
+                                OGRGeoJSONLayer* poLayer,
+                                json_object* poRootObj );
     static bool AddFeature( OGRGeoJSONLayer* poLayer, OGRGeometry* poGeometry );
     static bool AddFeature( OGRGeoJSONLayer* poLayer, OGRFeature* poFeature );
 
     OGRGeometry* ReadGeometry( json_object* poObj, OGRSpatialReference* poLayerSRS );
-    OGRFeature* ReadFeature( OGRGeoJSONLayer* poLayer, json_object* poObj,
+    OGRFeature* ReadFeature( OGRLayer* poLayer, json_object* poObj,
                              const char* pszSerializedObj );
     void ReadFeatureCollection( OGRGeoJSONLayer* poLayer, json_object* poObj );
     size_t SkipPrologEpilogAndUpdateJSonPLikeWrapper( size_t nRead );
@@ -244,6 +255,11 @@ class OGRESRIJSONReader
 
     json_object* GetJSonObject() { return poGJObject_; }
 
+    // Used by the streaming reader of OGRGeoJSONReader.
+    void SetLayer( OGRGeoJSONLayer* poLayer ) { poLayer_ = poLayer; }
+    bool GenerateLayerDefn( json_object* poObj );
+    OGRFeature* ReadFeature( json_object* poObj );
+
 private:
     json_object* poGJObject_;
     OGRGeoJSONLayer* poLayer_;
@@ -257,12 +273,10 @@ private:
     //
     // Translation utilities.
     //
-    bool GenerateLayerDefn();
     bool GenerateFeatureDefn( json_object* poObj );
     bool AddFeature( OGRFeature* poFeature );
 
     OGRGeometry* ReadGeometry( json_object* poObj );
-    OGRFeature* ReadFeature( json_object* poObj );
     OGRGeoJSONLayer* ReadFeatureCollection( json_object* poObj );
 };
 
@@ -277,6 +291,17 @@ OGRMultiPoint* OGRESRIJSONReadMultiPoint( json_object* poObj);
 /*                          OGRTopoJSONReader                           */
 /************************************************************************/
 
+/* Quantized or absolute positions of the "arcs" member, stored as flat */
+/* x,y pairs rather than as a json-c tree. Invalid positions are NaN.  */
+struct OGRTopoJSONArcs
+{
+    std::vector<double> adfXY;
+    std::vector<size_t> anPointStart;  // Index of first point, for each arc.
+
+    int GetArcCount() const
+        { return static_cast<int>(anPointStart.size()); }
+};
+
 class OGRTopoJSONReader
 {
   public:
@@ -284,10 +309,13 @@ class OGRTopoJSONReader
     ~OGRTopoJSONReader();
 
     OGRErr Parse( const char* pszText );
+    OGRErr Parse( VSILFILE* fp );
     void ReadLayers( OGRGeoJSONDataSource* poDS );
 
   private:
     json_object* poGJObject_;
+    bool bHasArcs_;
+    OGRTopoJSONArcs oArcs_;
 
     //
     // Copy operations not supported.
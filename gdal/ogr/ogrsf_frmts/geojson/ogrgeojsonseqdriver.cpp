@@ -0,0 +1,1170 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implementation of GeoJSON Sequence driver (RFC 8142 and
+ *           newline-delimited GeoJSON)
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "ogr_geojson.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_vsi_error.h"
+#include "cpl_worker_thread_pool.h"
+#include "gdal_priv.h"
+#include "ogrgeojsonreader.h"
+#include "ogrgeojsonutils.h"
+#include "ogrgeojsonwriter.h"
+#include "ogrsf_frmts.h"
+
+CPL_CVSID("$Id$")
+
+// Record separator of RFC 7464 JSON text sequences.
+static const char RS = '\x1e';
+
+// Size of the blocks read during the scan of the file, and of the part of a
+// block decoded by each thread when NUM_THREADS > 1.
+static const size_t GEOJSONSEQ_CHUNK_SIZE = 1024 * 1024;
+
+/************************************************************************/
+/*                        OGRGeoJSONSeqDataSource                       */
+/************************************************************************/
+
+class OGRGeoJSONSeqDataSource final: public GDALDataset
+{
+        friend class OGRGeoJSONSeqLayer;
+
+        OGRLayer* m_poLayer;
+        VSILFILE* m_fp;
+        bool m_bIsRSSeparated;
+
+        CPL_DISALLOW_COPY_ASSIGN(OGRGeoJSONSeqDataSource)
+
+    public:
+        OGRGeoJSONSeqDataSource();
+        ~OGRGeoJSONSeqDataSource();
+
+        int GetLayerCount() override { return m_poLayer ? 1 : 0; }
+        OGRLayer* GetLayer(int) override;
+        OGRLayer* ICreateLayer( const char* pszName,
+                                OGRSpatialReference* poSRS = nullptr,
+                                OGRwkbGeometryType eGType = wkbUnknown,
+                                char** papszOptions = nullptr ) override;
+        int TestCapability(const char*) override;
+
+        bool Open( GDALOpenInfo* poOpenInfo, GeoJSONSourceType nSrcType );
+        bool Create( const char* pszFilename, char** papszOptions );
+};
+
+/************************************************************************/
+/*                           OGRGeoJSONSeqLayer                         */
+/************************************************************************/
+
+class OGRGeoJSONSeqLayer final: public OGRLayer
+{
+        struct JobError
+        {
+            CPLErr eErr;
+            CPLErrorNum nNo;
+            CPLString osMsg;
+        };
+
+        struct DecodeJob
+        {
+            OGRGeoJSONSeqLayer* poLayer;
+            const char* pszBlock;
+            const std::vector<size_t>* panRecordStarts;
+            size_t nFirst;
+            size_t nLast;
+            // Index of the first record of the block, or file offset of
+            // the block when scanning it in Init().
+            GIntBig nFirstRecord;
+            std::vector<json_object*> apoObjects;
+            std::vector<OGRwkbGeometryType> aeGeomTypes;
+            std::vector<OGRFeature*> apoFeatures;
+            // Errors of the job, emitted by the calling thread.
+            std::vector<JobError> aoErrors;
+        };
+
+        OGRGeoJSONSeqDataSource* m_poDS;
+        OGRFeatureDefn* m_poFeatureDefn;
+        CPLString m_osFIDColumn;
+
+        // Reading.
+        OGRGeoJSONReader m_oReader;
+        std::vector<vsi_l_offset> m_anRecordOffsets;
+        vsi_l_offset m_nFileSize;
+        GIntBig m_nNextRecord;
+        std::deque<OGRFeature*> m_oFeatureQueue;
+        int m_nNumThreads;
+        CPLWorkerThreadPool* m_poThreadPool;
+
+        // Writing.
+        OGRCoordinateTransformation* m_poCT;
+        OGRGeoJSONWriteOptions m_oWriteOptions;
+        bool m_bRS;
+
+        size_t GetRecordEnd( const char* pszBlock, size_t nStart,
+                             size_t nEnd ) const;
+        json_object* ParseRecord( const char* pszRecord, size_t nSize,
+                                  vsi_l_offset nOffset ) const;
+        OGRFeature* DecodeRecord( const char* pszRecord, size_t nSize,
+                                  GIntBig nRecord );
+        void RunJobs( std::vector<DecodeJob>& aoJobs,
+                      void (*pfnFunc)(void*) );
+        static void CPL_STDCALL JobErrorHandler( CPLErr eErr,
+                                                 CPLErrorNum nNo,
+                                                 const char* pszMsg );
+        static void DecodeJobFunc( void* pData );
+        static void ParseJobFunc( void* pData );
+        void ClearFeatureQueue();
+        bool FillFeatureQueue();
+        OGRFeature* GetNextRawFeature();
+
+        CPL_DISALLOW_COPY_ASSIGN(OGRGeoJSONSeqLayer)
+
+    public:
+        OGRGeoJSONSeqLayer( OGRGeoJSONSeqDataSource* poDS,
+                            const char* pszName, int nNumThreads,
+                            char** papszOpenOptions );
+        OGRGeoJSONSeqLayer( OGRGeoJSONSeqDataSource* poDS,
+                            const char* pszName, char** papszOptions,
+                            OGRCoordinateTransformation* poCT );
+        ~OGRGeoJSONSeqLayer();
+
+        bool Init();
+
+        const char* GetName() override { return GetDescription(); }
+        void ResetReading() override;
+        OGRFeature* GetNextFeature() override;
+        OGRFeature* GetFeature( GIntBig nFID ) override;
+        OGRErr SetNextByIndex( GIntBig nIndex ) override;
+        OGRFeatureDefn* GetLayerDefn() override { return m_poFeatureDefn; }
+        const char* GetFIDColumn() override { return m_osFIDColumn.c_str(); }
+        GIntBig GetFeatureCount( int ) override;
+        int TestCapability( const char* ) override;
+        OGRErr ICreateFeature( OGRFeature* poFeature ) override;
+        OGRErr CreateField( OGRFieldDefn* poField, int bApproxOK ) override;
+};
+
+/************************************************************************/
+/*                       OGRGeoJSONSeqDataSource()                      */
+/************************************************************************/
+
+OGRGeoJSONSeqDataSource::OGRGeoJSONSeqDataSource() :
+    m_poLayer(nullptr),
+    m_fp(nullptr),
+    m_bIsRSSeparated(false)
+{
+}
+
+/************************************************************************/
+/*                      ~OGRGeoJSONSeqDataSource()                      */
+/************************************************************************/
+
+OGRGeoJSONSeqDataSource::~OGRGeoJSONSeqDataSource()
+{
+    delete m_poLayer;
+    if( m_fp )
+        VSIFCloseL(m_fp);
+}
+
+/************************************************************************/
+/*                               GetLayer()                             */
+/************************************************************************/
+
+OGRLayer* OGRGeoJSONSeqDataSource::GetLayer( int nIndex )
+{
+    return nIndex == 0 ? m_poLayer : nullptr;
+}
+
+/************************************************************************/
+/*                           ICreateLayer()                             */
+/************************************************************************/
+
+OGRLayer* OGRGeoJSONSeqDataSource::ICreateLayer( const char* pszNameIn,
+                                                 OGRSpatialReference* poSRS,
+                                                 OGRwkbGeometryType /*eGType*/,
+                                                 char** papszOptions )
+{
+    if( eAccess != GA_Update || m_fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Layer creation only supported on newly created datasets");
+        return nullptr;
+    }
+    if( m_poLayer != nullptr )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "GeoJSONSeq driver only supports one layer");
+        return nullptr;
+    }
+
+    // RFC 8142 mandates RFC 7946 GeoJSON texts, hence long/lat on WGS84.
+    OGRCoordinateTransformation* poCT = nullptr;
+    if( poSRS == nullptr )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "No SRS set on layer. Assuming it is long/lat on WGS84 "
+                 "ellipsoid");
+    }
+    else
+    {
+        OGRSpatialReference oSRSWGS84;
+        oSRSWGS84.SetWellKnownGeogCS( "WGS84" );
+        if( !poSRS->IsSame(&oSRSWGS84) )
+        {
+            poCT = OGRCreateCoordinateTransformation( poSRS, &oSRSWGS84 );
+            if( poCT == nullptr )
+            {
+                CPLError(
+                    CE_Warning, CPLE_AppDefined,
+                    "Failed to create coordinate transformation between the "
+                    "input coordinate system and WGS84.  This may be because "
+                    "they are not transformable, or because projection "
+                    "services (PROJ.4 DLL/.so) could not be loaded." );
+                return nullptr;
+            }
+        }
+    }
+
+    const char* pszRS = CSLFetchNameValue(papszOptions, "RS");
+    if( pszRS != nullptr )
+        m_bIsRSSeparated = CPLTestBool(pszRS);
+
+    m_poLayer = new OGRGeoJSONSeqLayer(this, pszNameIn, papszOptions, poCT);
+    return m_poLayer;
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRGeoJSONSeqDataSource::TestCapability( const char* pszCap )
+{
+    if( EQUAL(pszCap, ODsCCreateLayer) )
+        return eAccess == GA_Update && m_poLayer == nullptr;
+
+    return FALSE;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+bool OGRGeoJSONSeqDataSource::Open( GDALOpenInfo* poOpenInfo,
+                                    GeoJSONSourceType nSrcType )
+{
+    CPLAssert( nSrcType == eGeoJSONSourceFile );
+    CPL_IGNORE_RET_VAL(nSrcType);
+
+    if( poOpenInfo->eAccess == GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Update of existing GeoJSONSeq files not supported");
+        return false;
+    }
+
+    const char* pszUnprefixed = poOpenInfo->pszFilename;
+    if( STARTS_WITH_CI(pszUnprefixed, "GeoJSONSeq:") )
+        pszUnprefixed += strlen("GeoJSONSeq:");
+
+    if( pszUnprefixed == poOpenInfo->pszFilename && poOpenInfo->fpL )
+    {
+        m_fp = poOpenInfo->fpL;
+        poOpenInfo->fpL = nullptr;
+    }
+    else
+    {
+        m_fp = VSIFOpenL(pszUnprefixed, "rb");
+    }
+    if( m_fp == nullptr )
+        return false;
+
+    const char* pszNumThreads =
+        CSLFetchNameValueDef(poOpenInfo->papszOpenOptions,
+                             "NUM_THREADS", "1");
+    int nNumThreads = 1;
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nNumThreads = CPLGetNumCPUs();
+    else
+        nNumThreads = std::max(1, std::min(128, atoi(pszNumThreads)));
+
+    SetDescription(poOpenInfo->pszFilename);
+    OGRGeoJSONSeqLayer* poLayer = new OGRGeoJSONSeqLayer(
+        this, CPLGetBasename(pszUnprefixed), nNumThreads,
+        poOpenInfo->papszOpenOptions);
+    if( !poLayer->Init() )
+    {
+        delete poLayer;
+        return false;
+    }
+    m_poLayer = poLayer;
+    return true;
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+bool OGRGeoJSONSeqDataSource::Create( const char* pszFilename,
+                                      char** /* papszOptions */ )
+{
+    CPLAssert( nullptr == m_fp );
+
+    if( strcmp(pszFilename, "/dev/stdout") == 0 )
+        pszFilename = "/vsistdout/";
+
+    // Default to RFC 8142 when the extension suggests it.
+    m_bIsRSSeparated = EQUAL(CPLGetExtension(pszFilename), "GEOJSONS");
+
+    m_fp = VSIFOpenExL( pszFilename, "w", true );
+    if( nullptr == m_fp )
+    {
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "Failed to create %s: %s",
+                  pszFilename, VSIGetLastErrorMsg() );
+        return false;
+    }
+
+    eAccess = GA_Update;
+    return true;
+}
+
+/************************************************************************/
+/*                         OGRGeoJSONSeqLayer()                         */
+/*                                                                      */
+/*      Constructor for reading.                                        */
+/************************************************************************/
+
+OGRGeoJSONSeqLayer::OGRGeoJSONSeqLayer( OGRGeoJSONSeqDataSource* poDS,
+                                        const char* pszName,
+                                        int nNumThreads,
+                                        char** papszOpenOptions ) :
+    m_poDS(poDS),
+    m_poFeatureDefn(new OGRFeatureDefn(pszName)),
+    m_nFileSize(0),
+    m_nNextRecord(0),
+    m_nNumThreads(nNumThreads),
+    m_poThreadPool(nullptr),
+    m_poCT(nullptr),
+    m_bRS(false)
+{
+    SetDescription(pszName);
+    m_poFeatureDefn->Reference();
+    m_poFeatureDefn->SetGeomType(wkbNone);
+
+    m_oReader.SetFlattenNestedAttributes(
+        CPLFetchBool(papszOpenOptions, "FLATTEN_NESTED_ATTRIBUTES", false),
+        CSLFetchNameValueDef(papszOpenOptions,
+                             "NESTED_ATTRIBUTE_SEPARATOR", "_")[0]);
+    m_oReader.SetArrayAsString(
+        CPLTestBool(CSLFetchNameValueDef(papszOpenOptions, "ARRAY_AS_STRING",
+                CPLGetConfigOption("OGR_GEOJSON_ARRAY_AS_STRING", "NO"))));
+}
+
+/************************************************************************/
+/*                         OGRGeoJSONSeqLayer()                         */
+/*                                                                      */
+/*      Constructor for writing.                                        */
+/************************************************************************/
+
+OGRGeoJSONSeqLayer::OGRGeoJSONSeqLayer( OGRGeoJSONSeqDataSource* poDS,
+                                        const char* pszName,
+                                        char** papszOptions,
+                                        OGRCoordinateTransformation* poCT ) :
+    m_poDS(poDS),
+    m_poFeatureDefn(new OGRFeatureDefn(pszName)),
+    m_nFileSize(0),
+    m_nNextRecord(0),
+    m_nNumThreads(1),
+    m_poThreadPool(nullptr),
+    m_poCT(poCT),
+    m_bRS(poDS->m_bIsRSSeparated)
+{
+    SetDescription(pszName);
+    m_poFeatureDefn->Reference();
+
+    m_oWriteOptions.SetRFC7946Settings();
+    m_oWriteOptions.nCoordPrecision = atoi(
+        CSLFetchNameValueDef(papszOptions, "COORDINATE_PRECISION", "7"));
+    m_oWriteOptions.nSignificantFigures = atoi(
+        CSLFetchNameValueDef(papszOptions, "SIGNIFICANT_FIGURES", "-1"));
+}
+
+/************************************************************************/
+/*                        ~OGRGeoJSONSeqLayer()                         */
+/************************************************************************/
+
+OGRGeoJSONSeqLayer::~OGRGeoJSONSeqLayer()
+{
+    ClearFeatureQueue();
+    delete m_poThreadPool;
+    delete m_poCT;
+    m_poFeatureDefn->Release();
+}
+
+/************************************************************************/
+/*                            GetRecordEnd()                            */
+/*                                                                      */
+/*      Returns the end of the record starting at nStart.  Records of   */
+/*      RFC 8142 sequences may span several lines.                      */
+/************************************************************************/
+
+size_t OGRGeoJSONSeqLayer::GetRecordEnd( const char* pszBlock, size_t nStart,
+                                         size_t nEnd ) const
+{
+    const void* pEnd = memchr(pszBlock + nStart,
+                              m_poDS->m_bIsRSSeparated ? RS : '\n',
+                              nEnd - nStart);
+    if( pEnd == nullptr )
+        return nEnd;
+    return static_cast<const char*>(pEnd) - pszBlock;
+}
+
+/************************************************************************/
+/*                            ParseRecord()                             */
+/************************************************************************/
+
+json_object* OGRGeoJSONSeqLayer::ParseRecord( const char* pszRecord,
+                                              size_t nSize,
+                                              vsi_l_offset nOffset ) const
+{
+    // Records are not nul-terminated in the block.
+    CPLString osRecord(pszRecord, nSize);
+    json_object* poObj = nullptr;
+    if( !OGRJSonParse(osRecord, &poObj, false) )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Cannot parse record at offset " CPL_FRMT_GUIB
+                 ". Skipping it",
+                 static_cast<GUIntBig>(nOffset));
+        return nullptr;
+    }
+    if( json_object_get_type(poObj) != json_type_object )
+    {
+        json_object_put(poObj);
+        return nullptr;
+    }
+
+    // Bare geometries are promoted to features, so that the translation
+    // of OGRGeoJSONReader can be used.
+    const GeoJSONObject::Type eType = OGRGeoJSONGetType(poObj);
+    if( eType == GeoJSONObject::eFeature )
+        return poObj;
+    if( eType == GeoJSONObject::eUnknown ||
+        eType == GeoJSONObject::eFeatureCollection )
+    {
+        json_object_put(poObj);
+        return nullptr;
+    }
+    json_object* poFeatureObj = json_object_new_object();
+    json_object_object_add(poFeatureObj, "type",
+                           json_object_new_string("Feature"));
+    json_object_object_add(poFeatureObj, "geometry", poObj);
+    return poFeatureObj;
+}
+
+/************************************************************************/
+/*                               Init()                                 */
+/*                                                                      */
+/*      Scans the whole file to establish the layer schema and the      */
+/*      offset of each record.                                          */
+/************************************************************************/
+
+bool OGRGeoJSONSeqLayer::Init()
+{
+    VSILFILE* fp = m_poDS->m_fp;
+
+    // Skip UTF-8 BOM and detect the flavour of the sequence.
+    GByte abyStart[4] = { 0, 0, 0, 0 };
+    VSIFSeekL(fp, 0, SEEK_SET);
+    const size_t nStartRead = VSIFReadL(abyStart, 1, sizeof(abyStart), fp);
+    vsi_l_offset nOffset = 0;
+    if( nStartRead >= 3 && abyStart[0] == 0xEF && abyStart[1] == 0xBB &&
+        abyStart[2] == 0xBF )
+    {
+        CPLDebug("GeoJSONSeq", "Skip UTF-8 BOM");
+        nOffset = 3;
+    }
+    m_poDS->m_bIsRSSeparated =
+        nStartRead > nOffset && abyStart[nOffset] == RS;
+
+    if( m_nNumThreads > 1 )
+    {
+        m_poThreadPool = new CPLWorkerThreadPool();
+        if( !m_poThreadPool->Setup(m_nNumThreads, nullptr, nullptr) )
+        {
+            delete m_poThreadPool;
+            m_poThreadPool = nullptr;
+            m_nNumThreads = 1;
+        }
+    }
+
+    bool bFirstGeometry = true;
+    OGRwkbGeometryType eLayerGeomType = wkbNone;
+
+    const size_t nBlockSize = GEOJSONSEQ_CHUNK_SIZE *
+        static_cast<size_t>(m_nNumThreads);
+    std::string osBlock;
+    std::vector<size_t> anRecordStarts;
+    std::vector<DecodeJob> aoJobs;
+    bool bEOF = false;
+    while( !bEOF )
+    {
+        // Append a new block to the left-over of the previous one.
+        const size_t nPrevSize = osBlock.size();
+        osBlock.resize(nPrevSize + nBlockSize);
+        VSIFSeekL(fp, nOffset + nPrevSize, SEEK_SET);
+        const size_t nRead = VSIFReadL(&osBlock[nPrevSize], 1, nBlockSize, fp);
+        osBlock.resize(nPrevSize + nRead);
+        bEOF = nRead < nBlockSize;
+
+        // Locate complete records.
+        anRecordStarts.clear();
+        size_t nPos = 0;
+        size_t nConsumed = 0;
+        const size_t nSize = osBlock.size();
+        while( nPos < nSize )
+        {
+            const char ch = osBlock[nPos];
+            if( ch == RS || isspace(static_cast<unsigned char>(ch)) )
+            {
+                nPos ++;
+                nConsumed = nPos;
+                continue;
+            }
+            const size_t nEnd = GetRecordEnd(osBlock.data(), nPos, nSize);
+            if( nEnd == nSize && !bEOF )
+                break;
+            anRecordStarts.push_back(nPos);
+            nPos = nEnd;
+            nConsumed = nPos;
+        }
+
+        // Parse them, possibly in parallel.
+        const size_t nRecords = anRecordStarts.size();
+        anRecordStarts.push_back(nSize);
+        const size_t nJobs = std::max(static_cast<size_t>(1),
+            std::min(static_cast<size_t>(m_nNumThreads), nRecords));
+        aoJobs.resize(nJobs);
+        for( size_t i = 0; i < nJobs; i++ )
+        {
+            DecodeJob& oJob = aoJobs[i];
+            oJob.poLayer = this;
+            oJob.pszBlock = osBlock.data();
+            oJob.panRecordStarts = &anRecordStarts;
+            oJob.nFirst = nRecords * i / nJobs;
+            oJob.nLast = nRecords * (i + 1) / nJobs;
+            oJob.nFirstRecord = static_cast<GIntBig>(nOffset);
+            oJob.apoObjects.clear();
+            oJob.aeGeomTypes.clear();
+        }
+        RunJobs(aoJobs, ParseJobFunc);
+
+        // Merge schemas sequentially, to keep the field order of the file.
+        for( size_t i = 0; i < nJobs; i++ )
+        {
+            DecodeJob& oJob = aoJobs[i];
+            for( size_t j = oJob.nFirst; j < oJob.nLast; j++ )
+            {
+                json_object* poObj = oJob.apoObjects[j - oJob.nFirst];
+                if( poObj == nullptr )
+                    continue;
+                m_anRecordOffsets.push_back(nOffset + anRecordStarts[j]);
+                m_oReader.GenerateFeatureDefn(this, poObj);
+                json_object_put(poObj);
+
+                const OGRwkbGeometryType eType =
+                    oJob.aeGeomTypes[j - oJob.nFirst];
+                if( eType != wkbNone )
+                {
+                    if( bFirstGeometry )
+                    {
+                        eLayerGeomType = eType;
+                        bFirstGeometry = false;
+                    }
+                    else if( eType != eLayerGeomType )
+                    {
+                        eLayerGeomType = wkbUnknown;
+                    }
+                }
+            }
+        }
+
+        osBlock.erase(0, nConsumed);
+        nOffset += nConsumed;
+    }
+
+    m_oReader.FinalizeLayerDefn(this, m_osFIDColumn);
+
+    if( eLayerGeomType != wkbNone )
+    {
+        m_poFeatureDefn->SetGeomType(eLayerGeomType);
+        OGRSpatialReference* poSRSWGS84 = new OGRSpatialReference();
+        poSRSWGS84->SetFromUserInput(SRS_WKT_WGS84);
+        m_poFeatureDefn->GetGeomFieldDefn(0)->SetSpatialRef(poSRSWGS84);
+        poSRSWGS84->Release();
+    }
+
+    m_nFileSize = nOffset;
+    ResetReading();
+    return true;
+}
+
+/************************************************************************/
+/*                              RunJobs()                               */
+/************************************************************************/
+
+void OGRGeoJSONSeqLayer::RunJobs( std::vector<DecodeJob>& aoJobs,
+                                  void (*pfnFunc)(void*) )
+{
+    if( m_poThreadPool == nullptr || aoJobs.size() == 1 )
+    {
+        for( size_t i = 0; i < aoJobs.size(); i++ )
+            pfnFunc(&aoJobs[i]);
+    }
+    else
+    {
+        std::vector<void*> apData;
+        for( size_t i = 0; i < aoJobs.size(); i++ )
+            apData.push_back(&aoJobs[i]);
+        m_poThreadPool->SubmitJobs(pfnFunc, apData);
+        m_poThreadPool->WaitCompletion();
+    }
+
+    // Emit the errors of the jobs in the order of the records.
+    for( size_t i = 0; i < aoJobs.size(); i++ )
+    {
+        for( size_t j = 0; j < aoJobs[i].aoErrors.size(); j++ )
+        {
+            const JobError& oError = aoJobs[i].aoErrors[j];
+            CPLError(oError.eErr, oError.nNo, "%s", oError.osMsg.c_str());
+        }
+        aoJobs[i].aoErrors.clear();
+    }
+}
+
+/************************************************************************/
+/*                          JobErrorHandler()                           */
+/*                                                                      */
+/*      Collect the errors of a job, so that they can be emitted by     */
+/*      the calling thread.                                             */
+/************************************************************************/
+
+void CPL_STDCALL OGRGeoJSONSeqLayer::JobErrorHandler( CPLErr eErr,
+                                                      CPLErrorNum nNo,
+                                                      const char* pszMsg )
+{
+    DecodeJob* psJob = static_cast<DecodeJob*>(CPLGetErrorHandlerUserData());
+    JobError oError;
+    oError.eErr = eErr;
+    oError.nNo = nNo;
+    oError.osMsg = pszMsg;
+    psJob->aoErrors.push_back(oError);
+}
+
+/************************************************************************/
+/*                            ParseJobFunc()                            */
+/************************************************************************/
+
+void OGRGeoJSONSeqLayer::ParseJobFunc( void* pData )
+{
+    DecodeJob* psJob = static_cast<DecodeJob*>(pData);
+    CPLPushErrorHandlerEx(JobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    const std::vector<size_t>& anStarts = *(psJob->panRecordStarts);
+    for( size_t i = psJob->nFirst; i < psJob->nLast; i++ )
+    {
+        const size_t nEnd = psJob->poLayer->GetRecordEnd(
+            psJob->pszBlock, anStarts[i], anStarts[i + 1]);
+        json_object* poObj = psJob->poLayer->ParseRecord(
+            psJob->pszBlock + anStarts[i], nEnd - anStarts[i],
+            static_cast<vsi_l_offset>(psJob->nFirstRecord) + anStarts[i]);
+        psJob->apoObjects.push_back(poObj);
+
+        // Decoding the geometry here lets the threads establish the
+        // geometry type, including its dimension.
+        OGRwkbGeometryType eType = wkbNone;
+        json_object* poGeom = poObj ?
+            CPL_json_object_object_get(poObj, "geometry") : nullptr;
+        if( poGeom && json_object_get_type(poGeom) == json_type_object )
+        {
+            OGRGeometry* poGeometry = OGRGeoJSONReadGeometry(poGeom);
+            if( poGeometry )
+            {
+                eType = poGeometry->getGeometryType();
+                delete poGeometry;
+            }
+        }
+        psJob->aeGeomTypes.push_back(eType);
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                            DecodeRecord()                            */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONSeqLayer::DecodeRecord( const char* pszRecord,
+                                              size_t nSize,
+                                              GIntBig nRecord )
+{
+    json_object* poObj = ParseRecord(pszRecord, nSize,
+                                     m_anRecordOffsets[
+                                         static_cast<size_t>(nRecord)]);
+    if( poObj == nullptr )
+        return nullptr;
+    OGRFeature* poFeature = m_oReader.ReadFeature(this, poObj, nullptr);
+    json_object_put(poObj);
+    if( poFeature != nullptr && poFeature->GetFID() == OGRNullFID )
+        poFeature->SetFID(nRecord);
+    return poFeature;
+}
+
+/************************************************************************/
+/*                           DecodeJobFunc()                            */
+/************************************************************************/
+
+void OGRGeoJSONSeqLayer::DecodeJobFunc( void* pData )
+{
+    DecodeJob* psJob = static_cast<DecodeJob*>(pData);
+    CPLPushErrorHandlerEx(JobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    const std::vector<size_t>& anStarts = *(psJob->panRecordStarts);
+    for( size_t i = psJob->nFirst; i < psJob->nLast; i++ )
+    {
+        const size_t nEnd = psJob->poLayer->GetRecordEnd(
+            psJob->pszBlock, anStarts[i], anStarts[i + 1]);
+        psJob->apoFeatures.push_back(
+            psJob->poLayer->DecodeRecord(psJob->pszBlock + anStarts[i],
+                                         nEnd - anStarts[i],
+                                         psJob->nFirstRecord +
+                                            static_cast<GIntBig>(i)));
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                         ClearFeatureQueue()                          */
+/************************************************************************/
+
+void OGRGeoJSONSeqLayer::ClearFeatureQueue()
+{
+    for( size_t i = 0; i < m_oFeatureQueue.size(); i++ )
+        delete m_oFeatureQueue[i];
+    m_oFeatureQueue.clear();
+}
+
+/************************************************************************/
+/*                          FillFeatureQueue()                          */
+/*                                                                      */
+/*      Reads the byte range of the next records, as known from         */
+/*      Init(), and decodes them, in parallel when NUM_THREADS > 1.     */
+/************************************************************************/
+
+bool OGRGeoJSONSeqLayer::FillFeatureQueue()
+{
+    const GIntBig nRecords = static_cast<GIntBig>(m_anRecordOffsets.size());
+    if( m_nNextRecord >= nRecords )
+        return false;
+
+    const vsi_l_offset nStart =
+        m_anRecordOffsets[static_cast<size_t>(m_nNextRecord)];
+    const vsi_l_offset nMaxSize = GEOJSONSEQ_CHUNK_SIZE *
+        static_cast<vsi_l_offset>(m_nNumThreads);
+
+    // Take at least one record, and as many as fit in the block.
+    GIntBig nLastRecord = m_nNextRecord + 1;
+    while( nLastRecord < nRecords &&
+           m_anRecordOffsets[static_cast<size_t>(nLastRecord)] - nStart <
+                nMaxSize )
+    {
+        nLastRecord ++;
+    }
+    const vsi_l_offset nEnd = nLastRecord < nRecords ?
+        m_anRecordOffsets[static_cast<size_t>(nLastRecord)] : m_nFileSize;
+
+    std::string osBlock;
+    osBlock.resize(static_cast<size_t>(nEnd - nStart));
+    VSILFILE* fp = m_poDS->m_fp;
+    VSIFSeekL(fp, nStart, SEEK_SET);
+    if( VSIFReadL(&osBlock[0], 1, osBlock.size(), fp) != osBlock.size() )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read " CPL_FRMT_GUIB
+                 " bytes at offset " CPL_FRMT_GUIB,
+                 static_cast<GUIntBig>(osBlock.size()),
+                 static_cast<GUIntBig>(nStart));
+        m_nNextRecord = nRecords;
+        return false;
+    }
+
+    std::vector<size_t> anRecordStarts;
+    for( GIntBig i = m_nNextRecord; i < nLastRecord; i++ )
+    {
+        anRecordStarts.push_back(static_cast<size_t>(
+            m_anRecordOffsets[static_cast<size_t>(i)] - nStart));
+    }
+    anRecordStarts.push_back(osBlock.size());
+
+    const size_t nBlockRecords =
+        static_cast<size_t>(nLastRecord - m_nNextRecord);
+    const size_t nJobs = std::max(static_cast<size_t>(1),
+        std::min(static_cast<size_t>(m_nNumThreads), nBlockRecords));
+    std::vector<DecodeJob> aoJobs(nJobs);
+    for( size_t i = 0; i < nJobs; i++ )
+    {
+        DecodeJob& oJob = aoJobs[i];
+        oJob.poLayer = this;
+        oJob.pszBlock = osBlock.data();
+        oJob.panRecordStarts = &anRecordStarts;
+        oJob.nFirst = nBlockRecords * i / nJobs;
+        oJob.nLast = nBlockRecords * (i + 1) / nJobs;
+        oJob.nFirstRecord = m_nNextRecord;
+    }
+    RunJobs(aoJobs, DecodeJobFunc);
+
+    for( size_t i = 0; i < nJobs; i++ )
+    {
+        for( size_t j = 0; j < aoJobs[i].apoFeatures.size(); j++ )
+        {
+            if( aoJobs[i].apoFeatures[j] != nullptr )
+                m_oFeatureQueue.push_back(aoJobs[i].apoFeatures[j]);
+        }
+    }
+    m_nNextRecord = nLastRecord;
+    return true;
+}
+
+/************************************************************************/
+/*                            ResetReading()                            */
+/************************************************************************/
+
+void OGRGeoJSONSeqLayer::ResetReading()
+{
+    ClearFeatureQueue();
+    m_nNextRecord = 0;
+}
+
+/************************************************************************/
+/*                         GetNextRawFeature()                          */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONSeqLayer::GetNextRawFeature()
+{
+    while( m_oFeatureQueue.empty() )
+    {
+        if( m_poDS->eAccess == GA_Update || !FillFeatureQueue() )
+            return nullptr;
+    }
+    OGRFeature* poFeature = m_oFeatureQueue.front();
+    m_oFeatureQueue.pop_front();
+    return poFeature;
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONSeqLayer::GetNextFeature()
+{
+    while( true )
+    {
+        OGRFeature* poFeature = GetNextRawFeature();
+        if( poFeature == nullptr )
+            return nullptr;
+        if( (m_poFilterGeom == nullptr ||
+             FilterGeometry(poFeature->GetGeometryRef())) &&
+            (m_poAttrQuery == nullptr ||
+             m_poAttrQuery->Evaluate(poFeature)) )
+        {
+            return poFeature;
+        }
+        delete poFeature;
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONSeqLayer::GetFeature( GIntBig nFID )
+{
+    // FIDs are record indices, unless an "id" member was used for them.
+    if( !m_osFIDColumn.empty() || m_oReader.bFoundFeatureId_ )
+        return OGRLayer::GetFeature(nFID);
+
+    if( m_poDS->eAccess == GA_Update || nFID < 0 ||
+        nFID >= static_cast<GIntBig>(m_anRecordOffsets.size()) )
+    {
+        return nullptr;
+    }
+
+    const size_t nRecord = static_cast<size_t>(nFID);
+    const vsi_l_offset nStart = m_anRecordOffsets[nRecord];
+    const vsi_l_offset nEnd = nRecord + 1 < m_anRecordOffsets.size() ?
+        m_anRecordOffsets[nRecord + 1] : m_nFileSize;
+    std::string osRecord;
+    osRecord.resize(static_cast<size_t>(nEnd - nStart));
+    VSILFILE* fp = m_poDS->m_fp;
+    VSIFSeekL(fp, nStart, SEEK_SET);
+    if( VSIFReadL(&osRecord[0], 1, osRecord.size(), fp) != osRecord.size() )
+        return nullptr;
+    const size_t nSize = GetRecordEnd(osRecord.data(), 0, osRecord.size());
+    return DecodeRecord(osRecord.data(), nSize, nFID);
+}
+
+/************************************************************************/
+/*                           SetNextByIndex()                           */
+/************************************************************************/
+
+OGRErr OGRGeoJSONSeqLayer::SetNextByIndex( GIntBig nIndex )
+{
+    if( m_poFilterGeom != nullptr || m_poAttrQuery != nullptr )
+        return OGRLayer::SetNextByIndex(nIndex);
+
+    if( nIndex < 0 ||
+        nIndex >= static_cast<GIntBig>(m_anRecordOffsets.size()) )
+    {
+        return OGRERR_FAILURE;
+    }
+    ClearFeatureQueue();
+    m_nNextRecord = nIndex;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                          GetFeatureCount()                           */
+/************************************************************************/
+
+GIntBig OGRGeoJSONSeqLayer::GetFeatureCount( int bForce )
+{
+    if( m_poDS->eAccess != GA_Update &&
+        m_poFilterGeom == nullptr && m_poAttrQuery == nullptr )
+    {
+        return static_cast<GIntBig>(m_anRecordOffsets.size());
+    }
+    return OGRLayer::GetFeatureCount(bForce);
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRGeoJSONSeqLayer::TestCapability( const char* pszCap )
+{
+    if( EQUAL(pszCap, OLCStringsAsUTF8) )
+        return TRUE;
+    if( EQUAL(pszCap, OLCSequentialWrite) || EQUAL(pszCap, OLCCreateField) )
+        return m_poDS->eAccess == GA_Update;
+    if( EQUAL(pszCap, OLCFastFeatureCount) ||
+        EQUAL(pszCap, OLCFastSetNextByIndex) )
+    {
+        return m_poDS->eAccess != GA_Update &&
+               m_poFilterGeom == nullptr && m_poAttrQuery == nullptr;
+    }
+    if( EQUAL(pszCap, OLCRandomRead) )
+        return m_poDS->eAccess != GA_Update;
+    return FALSE;
+}
+
+/************************************************************************/
+/*                           ICreateFeature()                           */
+/************************************************************************/
+
+OGRErr OGRGeoJSONSeqLayer::ICreateFeature( OGRFeature* poFeature )
+{
+    if( m_poDS->eAccess != GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateFeature() not supported on read-only dataset");
+        return OGRERR_FAILURE;
+    }
+
+    OGRFeature* poFeatureToWrite = new OGRFeature(m_poFeatureDefn);
+    poFeatureToWrite->SetFrom( poFeature );
+    poFeatureToWrite->SetFID( poFeature->GetFID() );
+    OGRGeometry* poGeometry = poFeatureToWrite->GetGeometryRef();
+    if( poGeometry )
+    {
+        const char* const apszOptions[] = { "WRAPDATELINE=YES", nullptr };
+        OGRGeometry* poNewGeom =
+            OGRGeometryFactory::transformWithOptions(
+                poGeometry, m_poCT, const_cast<char**>(apszOptions));
+        if( poNewGeom == nullptr )
+        {
+            delete poFeatureToWrite;
+            return OGRERR_FAILURE;
+        }
+
+        OGREnvelope sEnvelope;
+        poNewGeom->getEnvelope(&sEnvelope);
+        if( sEnvelope.MinX < -180.0 || sEnvelope.MaxX > 180.0 ||
+            sEnvelope.MinY < -90.0 || sEnvelope.MaxY > 90.0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Geometry extent outside of "
+                     "[-180.0,180.0]x[-90.0,90.0] bounds");
+            delete poNewGeom;
+            delete poFeatureToWrite;
+            return OGRERR_FAILURE;
+        }
+
+        poFeatureToWrite->SetGeometryDirectly( poNewGeom );
+    }
+
+    json_object* poObj =
+        OGRGeoJSONWriteFeature( poFeatureToWrite, m_oWriteOptions );
+    CPLAssert( nullptr != poObj );
+
+    VSILFILE* fp = m_poDS->m_fp;
+    if( m_bRS )
+        VSIFPrintfL( fp, "%c", RS );
+    VSIFPrintfL( fp, "%s\n", json_object_to_json_string( poObj ) );
+
+    json_object_put( poObj );
+    delete poFeatureToWrite;
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            CreateField()                             */
+/************************************************************************/
+
+OGRErr OGRGeoJSONSeqLayer::CreateField( OGRFieldDefn* poField,
+                                        int /* bApproxOK */ )
+{
+    if( m_poDS->eAccess != GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateField() not supported on read-only dataset");
+        return OGRERR_FAILURE;
+    }
+    m_poFeatureDefn->AddFieldDefn(poField);
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                    OGRGeoJSONSeqDriverIdentify()                     */
+/************************************************************************/
+
+static int OGRGeoJSONSeqDriverIdentify( GDALOpenInfo* poOpenInfo )
+{
+    return GeoJSONSeqGetSourceType(poOpenInfo) != eGeoJSONSourceUnknown;
+}
+
+/************************************************************************/
+/*                      OGRGeoJSONSeqDriverOpen()                       */
+/************************************************************************/
+
+static GDALDataset* OGRGeoJSONSeqDriverOpen( GDALOpenInfo* poOpenInfo )
+{
+    const GeoJSONSourceType nSrcType = GeoJSONSeqGetSourceType(poOpenInfo);
+    if( nSrcType == eGeoJSONSourceUnknown )
+        return nullptr;
+    OGRGeoJSONSeqDataSource* poDS = new OGRGeoJSONSeqDataSource();
+    if( !poDS->Open(poOpenInfo, nSrcType) )
+    {
+        delete poDS;
+        return nullptr;
+    }
+    return poDS;
+}
+
+/************************************************************************/
+/*                     OGRGeoJSONSeqDriverCreate()                      */
+/************************************************************************/
+
+static GDALDataset* OGRGeoJSONSeqDriverCreate( const char * pszName,
+                                               int /* nBands */,
+                                               int /* nXSize */,
+                                               int /* nYSize */,
+                                               GDALDataType /* eDT */,
+                                               char **papszOptions )
+{
+    OGRGeoJSONSeqDataSource* poDS = new OGRGeoJSONSeqDataSource();
+    if( !poDS->Create(pszName, papszOptions) )
+    {
+        delete poDS;
+        return nullptr;
+    }
+    return poDS;
+}
+
+/************************************************************************/
+/*                        RegisterOGRGeoJSONSeq()                       */
+/************************************************************************/
+
+void RegisterOGRGeoJSONSeq()
+{
+    if( !GDAL_CHECK_VERSION("OGR/GeoJSONSeq driver") )
+        return;
+
+    if( GDALGetDriverByName( "GeoJSONSeq" ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "GeoJSONSeq" );
+    poDriver->SetMetadataItem( GDAL_DCAP_VECTOR, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "GeoJSON Sequence" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "geojsonl geojsons" );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_geojsonseq.html" );
+
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OpenOptionList>"
+"  <Option name='FLATTEN_NESTED_ATTRIBUTES' type='boolean' description='Whether to recursively explore nested objects and produce flatten OGR attributes' default='NO'/>"
+"  <Option name='NESTED_ATTRIBUTE_SEPARATOR' type='string' description='Separator between components of nested attributes' default='_'/>"
+"  <Option name='ARRAY_AS_STRING' type='boolean' description='Whether to expose JSon arrays of strings, integers or reals as a OGR String' default='NO'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads used to parse records. Integer or ALL_CPUS' default='1'/>"
+"</OpenOptionList>");
+
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
+                               "<CreationOptionList/>");
+
+    poDriver->SetMetadataItem( GDAL_DS_LAYER_CREATIONOPTIONLIST,
+"<LayerCreationOptionList>"
+"  <Option name='RS' type='boolean' description='whether to prefix records with the RS=0x1e character (RFC 8142)' default='NO'/>"
+"  <Option name='COORDINATE_PRECISION' type='int' description='Number of decimal for coordinates' default='7'/>"
+"  <Option name='SIGNIFICANT_FIGURES' type='int' description='Number of significant figures for floating-point values' default='17'/>"
+"</LayerCreationOptionList>");
+
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATATYPES,
+                               "Integer Integer64 Real String IntegerList "
+                               "Integer64List RealList StringList Date "
+                               "DateTime" );
+
+    poDriver->pfnOpen = OGRGeoJSONSeqDriverOpen;
+    poDriver->pfnIdentify = OGRGeoJSONSeqDriverIdentify;
+    poDriver->pfnCreate = OGRGeoJSONSeqDriverCreate;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
@@ -225,6 +225,93 @@ bool TopoJSONIsObject(const char *pszText)
     return IsTypeSomething(pszText, "Topology");
 }
 
+/************************************************************************/
+/*                  IsLikelyNewlineSequenceGeoJSON()                    */
+/*                                                                      */
+/*      Returns true if the text starts with a GeoJSON object that is   */
+/*      entirely on the first line, followed by another object on the   */
+/*      next line.                                                      */
+/************************************************************************/
+
+static bool IsLikelyNewlineSequenceGeoJSON( const char* pszText )
+{
+    if( *pszText != '{' )
+        return false;
+
+    int nDepth = 0;
+    bool bInString = false;
+    const char* pszIter = pszText;
+    for( ; *pszIter != '\0'; pszIter++ )
+    {
+        const char ch = *pszIter;
+        if( bInString )
+        {
+            if( ch == '\\' && pszIter[1] != '\0' )
+                pszIter ++;
+            else if( ch == '"' )
+                bInString = false;
+        }
+        else if( ch == '"' )
+            bInString = true;
+        else if( ch == '\n' )
+            return false;
+        else if( ch == '{' || ch == '[' )
+            nDepth ++;
+        else if( ch == '}' || ch == ']' )
+        {
+            nDepth --;
+            if( nDepth == 0 )
+                break;
+        }
+    }
+    if( *pszIter == '\0' )
+        return false;
+
+    // Only the first object is examined for its type.
+    const CPLString osFirst(pszText, pszIter + 1 - pszText);
+    if( !IsTypeSomething(osFirst, "Feature") &&
+        !IsTypeSomething(osFirst, "Point") &&
+        !IsTypeSomething(osFirst, "LineString") &&
+        !IsTypeSomething(osFirst, "Polygon") &&
+        !IsTypeSomething(osFirst, "MultiPoint") &&
+        !IsTypeSomething(osFirst, "MultiLineString") &&
+        !IsTypeSomething(osFirst, "MultiPolygon") &&
+        !IsTypeSomething(osFirst, "GeometryCollection") )
+    {
+        return false;
+    }
+
+    pszIter ++;
+    while( *pszIter == ' ' || *pszIter == '\t' || *pszIter == '\r' )
+        pszIter ++;
+    if( *pszIter != '\n' )
+        return false;
+    while( isspace(static_cast<unsigned char>(*pszIter)) )
+        pszIter ++;
+    return *pszIter == '{';
+}
+
+/************************************************************************/
+/*                       GeoJSONSeqIsObject()                           */
+/************************************************************************/
+
+bool GeoJSONSeqIsObject(const char *pszText)
+{
+    if( nullptr == pszText )
+        return false;
+
+    /* Skip UTF-8 BOM (#5630) */
+    const GByte* pabyData = reinterpret_cast<const GByte *>(pszText);
+    if( pabyData[0] == 0xEF && pabyData[1] == 0xBB && pabyData[2] == 0xBF )
+        pszText += 3;
+
+    // RFC 8142 sequence.
+    if( *pszText == '\x1e' )
+        return pszText[1] == '{';
+
+    return IsLikelyNewlineSequenceGeoJSON(pszText);
+}
+
 /************************************************************************/
 /*                           GeoJSONFileIsObject()                      */
 /************************************************************************/
@@ -247,6 +334,15 @@ bool GeoJSONFileIsObject( GDALOpenInfo* poOpenInfo )
         return false;
     }
 
+    // Leave sequences of features to the GeoJSONSeq driver.
+    const char* pszExt = CPLGetExtension(poOpenInfo->pszFilename);
+    if( EQUAL(pszExt, "geojsonl") || EQUAL(pszExt, "geojsons") ||
+        GeoJSONSeqIsObject(
+            reinterpret_cast<const char*>(poOpenInfo->pabyHeader)) )
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -421,6 +517,44 @@ GeoJSONSourceType TopoJSONDriverGetSourceType( GDALOpenInfo* poOpenInfo )
     }
     return eGeoJSONSourceUnknown;
 }
+
+/************************************************************************/
+/*                       GeoJSONSeqGetSourceType()                      */
+/************************************************************************/
+
+GeoJSONSourceType GeoJSONSeqGetSourceType( GDALOpenInfo* poOpenInfo )
+{
+    if( STARTS_WITH_CI(poOpenInfo->pszFilename, "GeoJSONSeq:") )
+    {
+        VSIStatBufL sStat;
+        if( VSIStatL(poOpenInfo->pszFilename + strlen("GeoJSONSeq:"),
+                     &sStat) == 0 )
+        {
+            return eGeoJSONSourceFile;
+        }
+        return eGeoJSONSourceUnknown;
+    }
+
+    if( poOpenInfo->fpL == nullptr )
+        return eGeoJSONSourceUnknown;
+
+    const char* pszExt = CPLGetExtension(poOpenInfo->pszFilename);
+    if( EQUAL(pszExt, "geojsonl") || EQUAL(pszExt, "geojsons") )
+        return eGeoJSONSourceFile;
+
+    // By default read first 6000 bytes, like the other JSON drivers.
+    if( !poOpenInfo->TryToIngest(6000) )
+        return eGeoJSONSourceUnknown;
+
+    if( poOpenInfo->pabyHeader != nullptr &&
+        GeoJSONSeqIsObject(
+            reinterpret_cast<const char*>(poOpenInfo->pabyHeader)) )
+    {
+        return eGeoJSONSourceFile;
+    }
+    return eGeoJSONSourceUnknown;
+}
+
 /************************************************************************/
 /*                           GeoJSONPropertyToFieldType()               */
 /************************************************************************/
@@ -30,15 +30,22 @@
 #include "ogrgeojsonutils.h"
 #include "ogr_geojson.h"
 #include <json.h>  // JSON-C
+#include "cpl_json_streaming_parser.h"
 #include <ogr_api.h>
 
+#include <limits>
+#include <vector>
+
 CPL_CVSID("$Id$")
 
 /************************************************************************/
 /*                          OGRTopoJSONReader()                         */
 /************************************************************************/
 
-OGRTopoJSONReader::OGRTopoJSONReader() : poGJObject_( nullptr ) {}
+OGRTopoJSONReader::OGRTopoJSONReader() :
+    poGJObject_( nullptr ),
+    bHasArcs_( false )
+{}
 
 /************************************************************************/
 /*                         ~OGRTopoJSONReader()                         */
@@ -54,6 +61,61 @@ OGRTopoJSONReader::~OGRTopoJSONReader()
     poGJObject_ = nullptr;
 }
 
+/************************************************************************/
+/*                            ParsePoint()                              */
+/************************************************************************/
+
+static bool ParsePoint( json_object* poPoint, double* pdfX, double* pdfY )
+{
+    if( poPoint != nullptr && json_type_array == json_object_get_type(poPoint) &&
+        json_object_array_length(poPoint) == 2 )
+    {
+        json_object* poX = json_object_array_get_idx(poPoint, 0);
+        json_object* poY = json_object_array_get_idx(poPoint, 1);
+        if( poX != nullptr &&
+            (json_type_int == json_object_get_type(poX) ||
+                json_type_double == json_object_get_type(poX)) &&
+            poY != nullptr &&
+            (json_type_int == json_object_get_type(poY) ||
+                json_type_double == json_object_get_type(poY)) )
+        {
+            *pdfX = json_object_get_double(poX);
+            *pdfY = json_object_get_double(poY);
+            return true;
+        }
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                             LoadArcs()                               */
+/************************************************************************/
+
+static void LoadArcs( json_object* poArcsDB, OGRTopoJSONArcs& oArcs )
+{
+    const int nArcs = json_object_array_length(poArcsDB);
+    oArcs.anPointStart.reserve(nArcs);
+    for( int i = 0; i < nArcs; i++ )
+    {
+        oArcs.anPointStart.push_back( oArcs.adfXY.size() / 2 );
+        json_object* poArcDB = json_object_array_get_idx(poArcsDB, i);
+        if( poArcDB == nullptr ||
+            json_type_array != json_object_get_type(poArcDB) )
+            continue;
+        const int nPoints = json_object_array_length(poArcDB);
+        for( int j = 0; j < nPoints; j++ )
+        {
+            json_object* poPoint = json_object_array_get_idx(poArcDB, j);
+            // Left untouched when the position is invalid.
+            double dfX = std::numeric_limits<double>::quiet_NaN();
+            double dfY = std::numeric_limits<double>::quiet_NaN();
+            ParsePoint( poPoint, &dfX, &dfY );
+            oArcs.adfXY.push_back(dfX);
+            oArcs.adfXY.push_back(dfY);
+        }
+    }
+}
+
 /************************************************************************/
 /*                           Parse()                                    */
 /************************************************************************/
@@ -69,64 +131,497 @@ OGRErr OGRTopoJSONReader::Parse( const char* pszText )
     // JSON tree is shared for while lifetime of the reader object
     // and will be released in the destructor.
     poGJObject_ = jsobj;
+
+    // Move the arcs out of the tree, so that both Parse() flavours
+    // leave the reader in the same state.
+    lh_entry* poEntry = OGRGeoJSONFindMemberEntryByName( poGJObject_, "arcs" );
+    if( poEntry != nullptr )
+    {
+        json_object* poArcs = const_cast<json_object*>(
+            static_cast<const json_object*>(poEntry->v));
+        if( poArcs != nullptr &&
+            json_type_array == json_object_get_type( poArcs ) )
+        {
+            LoadArcs( poArcs, oArcs_ );
+            bHasArcs_ = true;
+        }
+        const CPLString osKey( static_cast<const char*>(poEntry->k) );
+        json_object_object_del( poGJObject_, osKey );
+    }
     return OGRERR_NONE;
 }
 
-typedef struct
+/************************************************************************/
+/*                  OGRTopoJSONReaderStreamingParser                    */
+/*                                                                      */
+/*      Builds the json-c tree of a TopoJSON document, except for the   */
+/*      top-level "arcs" member whose positions are directly decoded    */
+/*      into a OGRTopoJSONArcs.                                         */
+/************************************************************************/
+
+class OGRTopoJSONReaderStreamingParser: public CPLJSonStreamingParser
 {
-    double dfScale0;
-    double dfScale1;
-    double dfTranslate0;
-    double dfTranslate1;
-    bool bElementExists;
-} ScalingParams;
+        OGRTopoJSONArcs& m_oArcs;
+        json_object* m_poRootObj;
+        std::vector<json_object*> m_apoCurObj;
+        CPLString m_osCurKey;
+        bool m_bKeySet;
+        int m_nDepth;
+
+        bool m_bInArcs;
+        bool m_bSkipMember;
+        bool m_bHasArcs;
+        bool m_bPointValid;
+        int m_nPointValues;
+        double m_adfPoint[2];
+
+        void AppendObject( json_object* poNewObj );
+        void StartArcElement( bool bIsArray );
+        void EndArcElement();
+        void ArcValue( const double* pdfValue );
+        bool IsBuilding() const
+            { return !m_apoCurObj.empty() && !m_bInArcs && !m_bSkipMember; }
+
+        CPL_DISALLOW_COPY_ASSIGN(OGRTopoJSONReaderStreamingParser)
+
+    public:
+        explicit OGRTopoJSONReaderStreamingParser( OGRTopoJSONArcs& oArcs );
+        ~OGRTopoJSONReaderStreamingParser();
+
+        virtual void String(const char* /*pszValue*/, size_t) override;
+        virtual void Number(const char* /*pszValue*/, size_t) override;
+        virtual void Boolean(bool b) override;
+        virtual void Null() override;
+
+        virtual void StartObject() override;
+        virtual void EndObject() override;
+        virtual void StartObjectMember(const char* /*pszKey*/, size_t) override;
+
+        virtual void StartArray() override;
+        virtual void EndArray() override;
+
+        virtual void Exception(const char* /*pszMessage*/) override;
+
+        json_object* StealRootObject();
+        bool HasArcs() const { return m_bHasArcs; }
+};
 
 /************************************************************************/
-/*                            ParsePoint()                              */
+/*                  OGRTopoJSONReaderStreamingParser()                  */
 /************************************************************************/
 
-static bool ParsePoint( json_object* poPoint, double* pdfX, double* pdfY )
+OGRTopoJSONReaderStreamingParser::OGRTopoJSONReaderStreamingParser(
+                                                OGRTopoJSONArcs& oArcs ) :
+    m_oArcs(oArcs),
+    m_poRootObj(nullptr),
+    m_bKeySet(false),
+    m_nDepth(0),
+    m_bInArcs(false),
+    m_bSkipMember(false),
+    m_bHasArcs(false),
+    m_bPointValid(false),
+    m_nPointValues(0)
 {
-    if( poPoint != nullptr && json_type_array == json_object_get_type(poPoint) &&
-        json_object_array_length(poPoint) == 2 )
+    m_adfPoint[0] = 0.0;
+    m_adfPoint[1] = 0.0;
+}
+
+/************************************************************************/
+/*                 ~OGRTopoJSONReaderStreamingParser()                  */
+/************************************************************************/
+
+OGRTopoJSONReaderStreamingParser::~OGRTopoJSONReaderStreamingParser()
+{
+    if( m_poRootObj )
+        json_object_put(m_poRootObj);
+}
+
+/************************************************************************/
+/*                          StealRootObject()                           */
+/************************************************************************/
+
+json_object* OGRTopoJSONReaderStreamingParser::StealRootObject()
+{
+    json_object* poRet = m_poRootObj;
+    m_poRootObj = nullptr;
+    m_apoCurObj.clear();
+    return poRet;
+}
+
+/************************************************************************/
+/*                            AppendObject()                            */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::AppendObject( json_object* poNewObj )
+{
+    if( m_bKeySet )
     {
-        json_object* poX = json_object_array_get_idx(poPoint, 0);
-        json_object* poY = json_object_array_get_idx(poPoint, 1);
-        if( poX != nullptr &&
-            (json_type_int == json_object_get_type(poX) ||
-                json_type_double == json_object_get_type(poX)) &&
-            poY != nullptr &&
-            (json_type_int == json_object_get_type(poY) ||
-                json_type_double == json_object_get_type(poY)) )
+        CPLAssert(
+            json_object_get_type(m_apoCurObj.back()) == json_type_object );
+        json_object_object_add( m_apoCurObj.back(), m_osCurKey, poNewObj );
+        m_osCurKey.clear();
+        m_bKeySet = false;
+    }
+    else
+    {
+        CPLAssert(
+            json_object_get_type(m_apoCurObj.back()) == json_type_array );
+        json_object_array_add( m_apoCurObj.back(), poNewObj );
+    }
+}
+
+/************************************************************************/
+/*                          StartArcElement()                           */
+/*                                                                      */
+/*      Called for each array, object or scalar found inside "arcs",    */
+/*      before m_nDepth is incremented for containers.                  */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::StartArcElement( bool bIsArray )
+{
+    if( m_nDepth == 2 )
+    {
+        // New arc. Anything else than an array is an empty arc.
+        m_oArcs.anPointStart.push_back( m_oArcs.adfXY.size() / 2 );
+    }
+    else if( m_nDepth == 3 )
+    {
+        // New position.
+        m_bPointValid = bIsArray;
+        m_nPointValues = 0;
+    }
+    else if( m_nDepth == 4 )
+    {
+        // Nested value inside a position: not a valid [x,y] pair.
+        m_bPointValid = false;
+        m_nPointValues ++;
+    }
+}
+
+/************************************************************************/
+/*                           EndArcElement()                            */
+/*                                                                      */
+/*      Called once a value at the position level is complete, after    */
+/*      m_nDepth has been decremented for containers.                   */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::EndArcElement()
+{
+    if( m_nDepth == 3 )
+    {
+        if( m_bPointValid && m_nPointValues == 2 )
         {
-            *pdfX = json_object_get_double(poX);
-            *pdfY = json_object_get_double(poY);
-            return true;
+            m_oArcs.adfXY.push_back( m_adfPoint[0] );
+            m_oArcs.adfXY.push_back( m_adfPoint[1] );
+        }
+        else
+        {
+            m_oArcs.adfXY.push_back( std::numeric_limits<double>::quiet_NaN() );
+            m_oArcs.adfXY.push_back( std::numeric_limits<double>::quiet_NaN() );
         }
     }
-    return false;
 }
 
+/************************************************************************/
+/*                              ArcValue()                              */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::ArcValue( const double* pdfValue )
+{
+    if( m_nDepth == 2 )
+    {
+        StartArcElement( false );
+    }
+    else if( m_nDepth == 3 )
+    {
+        StartArcElement( false );
+        EndArcElement();
+    }
+    else if( m_nDepth == 4 )
+    {
+        if( pdfValue == nullptr )
+            m_bPointValid = false;
+        else if( m_nPointValues < 2 )
+            m_adfPoint[m_nPointValues] = *pdfValue;
+        m_nPointValues ++;
+    }
+}
+
+/************************************************************************/
+/*                            StartObject()                             */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::StartObject()
+{
+    if( m_bInArcs && m_nDepth == 1 )
+    {
+        m_bInArcs = false;
+        m_bSkipMember = true;
+    }
+    else if( m_bInArcs )
+    {
+        StartArcElement( false );
+    }
+    else if( m_nDepth == 0 )
+    {
+        m_poRootObj = json_object_new_object();
+        m_apoCurObj.push_back( m_poRootObj );
+    }
+    else if( IsBuilding() )
+    {
+        json_object* poNewObj = json_object_new_object();
+        AppendObject( poNewObj );
+        m_apoCurObj.push_back( poNewObj );
+    }
+    m_nDepth ++;
+}
+
+/************************************************************************/
+/*                             EndObject()                              */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::EndObject()
+{
+    m_nDepth --;
+    if( m_bInArcs )
+        EndArcElement();
+    else if( IsBuilding() && m_nDepth > 0 )
+        m_apoCurObj.pop_back();
+}
+
+/************************************************************************/
+/*                         StartObjectMember()                          */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::StartObjectMember( const char* pszKey,
+                                                          size_t nKeyLen )
+{
+    if( m_nDepth == 1 )
+    {
+        // Only the first "arcs" member is used, as OGRGeoJSONFindMemberByName()
+        // would do. Others are skipped.
+        m_bSkipMember = false;
+        if( EQUAL(pszKey, "arcs") )
+        {
+            if( m_bHasArcs )
+                m_bSkipMember = true;
+            else
+                m_bInArcs = true;
+            return;
+        }
+        m_bInArcs = false;
+    }
+    if( IsBuilding() )
+    {
+        m_osCurKey.assign( pszKey, nKeyLen );
+        m_bKeySet = true;
+    }
+}
+
+/************************************************************************/
+/*                             StartArray()                             */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::StartArray()
+{
+    if( m_bInArcs )
+    {
+        if( m_nDepth > 1 )
+            StartArcElement( true );
+    }
+    else if( IsBuilding() )
+    {
+        json_object* poNewObj = json_object_new_array();
+        AppendObject( poNewObj );
+        m_apoCurObj.push_back( poNewObj );
+    }
+    m_nDepth ++;
+}
+
+/************************************************************************/
+/*                               EndArray()                             */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::EndArray()
+{
+    m_nDepth --;
+    if( m_bInArcs )
+    {
+        if( m_nDepth == 1 )
+        {
+            m_bInArcs = false;
+            m_bHasArcs = true;
+            m_bSkipMember = true;
+        }
+        else
+        {
+            EndArcElement();
+        }
+    }
+    else if( IsBuilding() )
+    {
+        m_apoCurObj.pop_back();
+    }
+}
+
+/************************************************************************/
+/*                              String()                                */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::String( const char* pszValue, size_t )
+{
+    if( m_bInArcs )
+    {
+        if( m_nDepth == 1 )
+            m_bInArcs = false;
+        else
+            ArcValue( nullptr );
+    }
+    else if( IsBuilding() )
+        AppendObject( json_object_new_string(pszValue) );
+}
+
+/************************************************************************/
+/*                              Number()                                */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::Number( const char* pszValue, size_t )
+{
+    if( m_bInArcs )
+    {
+        if( m_nDepth == 1 )
+        {
+            m_bInArcs = false;
+        }
+        else
+        {
+            const double dfValue = CPLAtof(pszValue);
+            ArcValue( &dfValue );
+        }
+    }
+    else if( IsBuilding() )
+    {
+        if( CPLGetValueType(pszValue) == CPL_VALUE_REAL )
+            AppendObject( json_object_new_double(CPLAtof(pszValue)) );
+        else
+            AppendObject( json_object_new_int64(CPLAtoGIntBig(pszValue)) );
+    }
+}
+
+/************************************************************************/
+/*                              Boolean()                               */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::Boolean( bool bVal )
+{
+    if( m_bInArcs )
+    {
+        if( m_nDepth == 1 )
+            m_bInArcs = false;
+        else
+            ArcValue( nullptr );
+    }
+    else if( IsBuilding() )
+        AppendObject( json_object_new_boolean(bVal) );
+}
+
+/************************************************************************/
+/*                               Null()                                 */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::Null()
+{
+    if( m_bInArcs )
+    {
+        if( m_nDepth == 1 )
+            m_bInArcs = false;
+        else
+            ArcValue( nullptr );
+    }
+    else if( IsBuilding() )
+        AppendObject( nullptr );
+}
+
+/************************************************************************/
+/*                             Exception()                              */
+/************************************************************************/
+
+void OGRTopoJSONReaderStreamingParser::Exception( const char* pszMessage )
+{
+    CPLError(CE_Failure, CPLE_AppDefined, "%s", pszMessage);
+}
+
+/************************************************************************/
+/*                           Parse()                                    */
+/************************************************************************/
+
+OGRErr OGRTopoJSONReader::Parse( VSILFILE* fp )
+{
+    OGRTopoJSONReaderStreamingParser oParser( oArcs_ );
+
+    const size_t nBufferSize = 4096 * 10;
+    std::vector<GByte> abyBuffer( nBufferSize );
+    bool bFirstSeg = true;
+    VSIFSeekL( fp, 0, SEEK_SET );
+    while( true )
+    {
+        const size_t nRead = VSIFReadL( &abyBuffer[0], 1, nBufferSize, fp );
+        const bool bFinished = nRead < nBufferSize;
+        size_t nSkip = 0;
+        if( bFirstSeg )
+        {
+            bFirstSeg = false;
+            if( nRead >= 3 && abyBuffer[0] == 0xEF && abyBuffer[1] == 0xBB &&
+                abyBuffer[2] == 0xBF )
+            {
+                CPLDebug("TopoJSON", "Skip UTF-8 BOM");
+                nSkip = 3;
+            }
+        }
+        if( !oParser.Parse( reinterpret_cast<const char*>(&abyBuffer[nSkip]),
+                            nRead - nSkip, bFinished ) ||
+            oParser.ExceptionOccurred() )
+        {
+            return OGRERR_CORRUPT_DATA;
+        }
+        if( bFinished )
+            break;
+    }
+
+    poGJObject_ = oParser.StealRootObject();
+    bHasArcs_ = oParser.HasArcs();
+    return OGRERR_NONE;
+}
+
+typedef struct
+{
+    double dfScale0;
+    double dfScale1;
+    double dfTranslate0;
+    double dfTranslate1;
+    bool bElementExists;
+} ScalingParams;
+
 /************************************************************************/
 /*                             ParseArc()                               */
 /************************************************************************/
 
-static void ParseArc( OGRLineString* poLS, json_object* poArcsDB, int nArcID,
-                      bool bReverse, ScalingParams* psParams )
+static void ParseArc( OGRLineString* poLS, const OGRTopoJSONArcs& oArcs,
+                      int nArcID, bool bReverse, ScalingParams* psParams )
 {
-    json_object* poArcDB = json_object_array_get_idx(poArcsDB, nArcID);
-    if( poArcDB == nullptr || json_type_array != json_object_get_type(poArcDB) )
-        return;
-    int nPoints = json_object_array_length(poArcDB);
+    const size_t nStart = oArcs.anPointStart[nArcID];
+    const size_t nEnd = nArcID + 1 < oArcs.GetArcCount() ?
+        oArcs.anPointStart[nArcID + 1] : oArcs.adfXY.size() / 2;
+    int nPoints = static_cast<int>(nEnd - nStart);
+    const double* padfXY = oArcs.adfXY.data() + 2 * nStart;
     double dfAccX = 0.0;
     double dfAccY = 0.0;
     int nBaseIndice = poLS->getNumPoints();
     for( int i = 0; i < nPoints; i++ )
     {
-        json_object* poPoint = json_object_array_get_idx(poArcDB, i);
-        double dfX = 0.0;
-        double dfY = 0.0;
-        if( ParsePoint( poPoint, &dfX, &dfY ) )
+        double dfX = padfXY[2 * i];
+        double dfY = padfXY[2 * i + 1];
+        if( !CPLIsNan(dfX) )
         {
             if( psParams->bElementExists )
             {
@@ -172,9 +667,9 @@ static void ParseArc( OGRLineString* poLS, json_object* poArcsDB, int nArcID,
 /************************************************************************/
 
 static void ParseLineString( OGRLineString* poLS, json_object* poRing,
-                             json_object* poArcsDB, ScalingParams* psParams )
+                             const OGRTopoJSONArcs& oArcs, ScalingParams* psParams )
 {
-    const int nArcsDB = json_object_array_length(poArcsDB);
+    const int nArcsDB = oArcs.GetArcCount();
 
     const int nArcsRing = json_object_array_length(poRing);
     for( int j = 0; j < nArcsRing; j++ )
@@ -191,7 +686,7 @@ static void ParseLineString( OGRLineString* poLS, json_object* poRing,
             }
             if( nArcId < nArcsDB )
             {
-                ParseArc(poLS, poArcsDB, nArcId, bReverse, psParams);
+                ParseArc(poLS, oArcs, nArcId, bReverse, psParams);
             }
         }
     }
@@ -202,7 +697,7 @@ static void ParseLineString( OGRLineString* poLS, json_object* poRing,
 /************************************************************************/
 
 static void ParsePolygon( OGRPolygon* poPoly, json_object* poArcsObj,
-                          json_object* poArcsDB, ScalingParams* psParams )
+                          const OGRTopoJSONArcs& oArcs, ScalingParams* psParams )
 {
     const int nRings = json_object_array_length(poArcsObj);
     for( int i = 0; i < nRings; i++ )
@@ -212,7 +707,7 @@ static void ParsePolygon( OGRPolygon* poPoly, json_object* poArcsObj,
         json_object* poRing = json_object_array_get_idx(poArcsObj, i);
         if( poRing != nullptr && json_type_array == json_object_get_type(poRing) )
         {
-            ParseLineString(poLR, poRing, poArcsDB, psParams);
+            ParseLineString(poLR, poRing, oArcs, psParams);
         }
         poLR->closeRings();
         if( poLR->getNumPoints() < 4 )
@@ -234,7 +729,7 @@ static void ParsePolygon( OGRPolygon* poPoly, json_object* poArcsObj,
 
 static void ParseMultiLineString( OGRMultiLineString* poMLS,
                                   json_object* poArcsObj,
-                                  json_object* poArcsDB,
+                                  const OGRTopoJSONArcs& oArcs,
                                   ScalingParams* psParams )
 {
     const int nRings = json_object_array_length(poArcsObj);
@@ -246,7 +741,7 @@ static void ParseMultiLineString( OGRMultiLineString* poMLS,
         json_object* poRing = json_object_array_get_idx(poArcsObj, i);
         if( poRing != nullptr && json_type_array == json_object_get_type(poRing) )
         {
-            ParseLineString(poLS, poRing, poArcsDB, psParams);
+            ParseLineString(poLS, poRing, oArcs, psParams);
         }
     }
 }
@@ -257,7 +752,7 @@ static void ParseMultiLineString( OGRMultiLineString* poMLS,
 
 static void ParseMultiPolygon( OGRMultiPolygon* poMultiPoly,
                                json_object* poArcsObj,
-                               json_object* poArcsDB, ScalingParams* psParams )
+                               const OGRTopoJSONArcs& oArcs, ScalingParams* psParams )
 {
     const int nPolys = json_object_array_length(poArcsObj);
     for( int i = 0; i < nPolys; i++ )
@@ -268,7 +763,7 @@ static void ParseMultiPolygon( OGRMultiPolygon* poMultiPoly,
         if( poPolyArcs != nullptr &&
             json_type_array == json_object_get_type(poPolyArcs) )
         {
-            ParsePolygon(poPoly, poPolyArcs, poArcsDB, psParams);
+            ParsePolygon(poPoly, poPolyArcs, oArcs, psParams);
         }
 
         if( poPoly->IsEmpty() )
@@ -288,7 +783,7 @@ static void ParseMultiPolygon( OGRMultiPolygon* poMultiPoly,
 
 static void ParseObject( const char* pszId,
                          json_object* poObj, OGRGeoJSONLayer* poLayer,
-                         json_object* poArcsDB, ScalingParams* psParams )
+                         const OGRTopoJSONArcs& oArcs, ScalingParams* psParams )
 {
     json_object* poType = OGRGeoJSONFindMemberByName(poObj, "type");
     if( poType == nullptr || json_object_get_type(poType) != json_type_string )
@@ -381,25 +876,25 @@ static void ParseObject( const char* pszId,
     {
         OGRLineString* poLS = new OGRLineString();
         poGeom = poLS;
-        ParseLineString(poLS, poArcsObj, poArcsDB, psParams);
+        ParseLineString(poLS, poArcsObj, oArcs, psParams);
     }
     else if( strcmp(pszType, "MultiLineString") == 0 )
     {
         OGRMultiLineString* poMLS = new OGRMultiLineString();
         poGeom = poMLS;
-        ParseMultiLineString(poMLS, poArcsObj, poArcsDB, psParams);
+        ParseMultiLineString(poMLS, poArcsObj, oArcs, psParams);
     }
     else if( strcmp(pszType, "Polygon") == 0 )
     {
         OGRPolygon* poPoly = new OGRPolygon();
         poGeom = poPoly;
-        ParsePolygon(poPoly, poArcsObj, poArcsDB, psParams);
+        ParsePolygon(poPoly, poArcsObj, oArcs, psParams);
     }
     else if( strcmp(pszType, "MultiPolygon") == 0 )
     {
         OGRMultiPolygon* poMultiPoly = new OGRMultiPolygon();
         poGeom = poMultiPoly;
-        ParseMultiPolygon(poMultiPoly, poArcsObj, poArcsDB, psParams);
+        ParseMultiPolygon(poMultiPoly, poArcsObj, oArcs, psParams);
     }
 
     if( poGeom != nullptr )
@@ -441,7 +936,7 @@ static void EstablishLayerDefn( OGRFeatureDefn* poDefn,
 static bool ParseObjectMain( const char* pszId, json_object* poObj,
                              OGRGeoJSONDataSource* poDS,
                              OGRGeoJSONLayer **ppoMainLayer,
-                             json_object* poArcs,
+                             const OGRTopoJSONArcs& oArcs,
                              ScalingParams* psParams,
                              int nPassNumber,
                              std::set<int>& aoSetUndeterminedTypeFields)
@@ -507,7 +1002,7 @@ static bool ParseObjectMain( const char* pszId, json_object* poObj,
                             json_type_object == json_object_get_type( poGeom ) )
                         {
                             ParseObject(nullptr, poGeom, poLayer,
-                                        poArcs, psParams);
+                                        oArcs, psParams);
                         }
                     }
 
@@ -540,7 +1035,7 @@ static bool ParseObjectMain( const char* pszId, json_object* poObj,
                     bNeedSecondPass = true;
                 }
                 else
-                    ParseObject(pszId, poObj, *ppoMainLayer, poArcs, psParams);
+                    ParseObject(pszId, poObj, *ppoMainLayer, oArcs, psParams);
             }
         }
     }
@@ -616,8 +1111,7 @@ void OGRTopoJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS )
         }
     }
 
-    json_object* poArcs = OGRGeoJSONFindMemberByName( poGJObject_, "arcs" );
-    if( poArcs == nullptr || json_type_array != json_object_get_type( poArcs ) )
+    if( !bHasArcs_ )
         return;
 
     OGRGeoJSONLayer* poMainLayer = nullptr;
@@ -639,7 +1133,7 @@ void OGRTopoJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS )
         {
             json_object* poObj = it.val;
             bNeedSecondPass |= ParseObjectMain( it.key, poObj, poDS,
-                                                &poMainLayer, poArcs, &sParams,
+                                                &poMainLayer, oArcs_, &sParams,
                                                 1, aoSetUndeterminedTypeFields);
         }
         if( bNeedSecondPass )
@@ -650,7 +1144,7 @@ void OGRTopoJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS )
             json_object_object_foreachC( poObjects, it )
             {
                 json_object* poObj = it.val;
-                ParseObjectMain(it.key, poObj, poDS, &poMainLayer, poArcs,
+                ParseObjectMain(it.key, poObj, poDS, &poMainLayer, oArcs_,
                                 &sParams, 2, aoSetUndeterminedTypeFields);
             }
         }
@@ -663,7 +1157,7 @@ void OGRTopoJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS )
         {
             json_object* poObj = json_object_array_get_idx(poObjects, i);
             bNeedSecondPass |= ParseObjectMain(nullptr, poObj, poDS, &poMainLayer,
-                                               poArcs, &sParams, 1,
+                                               oArcs_, &sParams, 1,
                                                aoSetUndeterminedTypeFields);
         }
         if( bNeedSecondPass )
@@ -671,7 +1165,7 @@ void OGRTopoJSONReader::ReadLayers( OGRGeoJSONDataSource* poDS )
             for( int i = 0; i < nObjects; i++ )
             {
                 json_object* poObj = json_object_array_get_idx(poObjects, i);
-                ParseObjectMain(nullptr, poObj, poDS, &poMainLayer, poArcs,
+                ParseObjectMain(nullptr, poObj, poDS, &poMainLayer, oArcs_,
                                 &sParams, 2, aoSetUndeterminedTypeFields);
             }
         }
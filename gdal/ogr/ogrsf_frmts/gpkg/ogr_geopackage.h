@@ -410,6 +410,7 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
     bool                        m_bInsertStatementWithFID;
     sqlite3_stmt*               m_poInsertStatement;
     bool                        m_bDeferredSpatialIndexCreation;
+    bool                        m_bDeferredSpatialSort;
     // m_bHasSpatialIndex cannot be bool.  -1 is unset.
     int                         m_bHasSpatialIndex;
     bool                        m_bDropRTreeTable;
@@ -442,6 +443,10 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
 
     void                CheckGeometryType( OGRFeature *poFeature );
 
+    OGRErr              SpatialSort();
+    OGRErr              BulkLoadRTree( const char* pszT, const char* pszI,
+                                       const char* pszC );
+
     OGRErr              ReadTableDefinition();
     void                InitView();
 
@@ -502,10 +507,13 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
                                                const char* pszDescription );
     void                SetDeferredSpatialIndexCreation( bool bFlag )
                                 { m_bDeferredSpatialIndexCreation = bFlag; }
+    void                SetDeferredSpatialSort( bool bFlag )
+                                { m_bDeferredSpatialSort = bFlag; }
     void                SetASpatialVariant( GPKGASpatialVariant eASPatialVariant )
                                 { m_eASPatialVariant = eASPatialVariant; }
 
     void                CreateSpatialIndexIfNecessary();
+    void                RunDeferredSpatialSortIfNecessary();
     bool                CreateSpatialIndex(const char* pszTableName = nullptr);
     bool                DropSpatialIndex(bool bCalledFromSQLFunction = false);
 
@@ -546,6 +546,10 @@ GDALGeoPackageDataset::~GDALGeoPackageDataset()
                   m_osRasterTable.c_str());
     }
 
+    // Must be done before the spatial indexes are created by FlushCache()
+    for( int i = 0; i < m_nLayers; i++ )
+        m_papoLayers[i]->RunDeferredSpatialSortIfNecessary();
+
     FlushCache();
     FlushMetadata();
 
@@ -4725,6 +4729,11 @@ OGRLayer* GDALGeoPackageDataset::ICreateLayer( const char * pszLayerName,
     {
         poLayer->SetDeferredSpatialIndexCreation(true);
     }
+    if( eGType != wkbNone &&
+        CPLFetchBool(papszOptions, "SPATIAL_SORT", false) )
+    {
+        poLayer->SetDeferredSpatialSort(true);
+    }
 
     poLayer->SetPrecisionFlag( CPLFetchBool(papszOptions, "PRECISION", true) );
     poLayer->SetTruncateFieldsFlag(
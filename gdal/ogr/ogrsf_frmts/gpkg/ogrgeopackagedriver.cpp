@@ -391,6 +391,7 @@ COMPRESSION_OPTIONS
 "  <Option name='PRECISION' type='boolean' description='Whether text fields created should keep the width' default='YES'/>"
 "  <Option name='TRUNCATE_FIELDS' type='boolean' description='Whether to truncate text content that exceeds maximum width' default='NO'/>"
 "  <Option name='SPATIAL_INDEX' type='boolean' description='Whether to create a spatial index' default='YES'/>"
+"  <Option name='SPATIAL_SORT' type='boolean' description='Whether to sort the features along a Hilbert curve when the dataset is closed, to improve the locality of spatial queries' default='NO'/>"
 "  <Option name='IDENTIFIER' type='string' description='Identifier of the layer, as put in the contents table'/>"
 "  <Option name='DESCRIPTION' type='string' description='Description of the layer, as put in the contents table'/>"
 "  <Option name='ASPATIAL_VARIANT' type='string-select' description='How to register non spatial tables' default='GPKG_ATTRIBUTES'>"
@@ -33,6 +33,12 @@
 #include "cpl_time.h"
 #include "ogr_p.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
 CPL_CVSID("$Id$")
 
 static const char UNSUPPORTED_OP_READ_ONLY[] =
@@ -1141,6 +1147,7 @@ OGRGeoPackageTableLayer::OGRGeoPackageTableLayer(
     m_bInsertStatementWithFID(false),
     m_poInsertStatement(nullptr),
     m_bDeferredSpatialIndexCreation(false),
+    m_bDeferredSpatialSort(false),
     m_bHasSpatialIndex(-1),
     m_bDropRTreeTable(false),
     m_bPreservePrecision(true),
@@ -2540,6 +2547,231 @@ void OGRGeoPackageTableLayer::CreateSpatialIndexIfNecessary()
     }
 }
 
+/************************************************************************/
+/*                  RunDeferredSpatialSortIfNecessary()                 */
+/*                                                                      */
+/*      Only called when the dataset is closed, since the sort          */
+/*      renumbers the features.                                         */
+/************************************************************************/
+
+void OGRGeoPackageTableLayer::RunDeferredSpatialSortIfNecessary()
+{
+    if( !m_bDeferredSpatialSort )
+        return;
+    m_bDeferredSpatialSort = false;
+
+    if( !m_bFeatureDefnCompleted )
+        GetLayerDefn();
+    if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
+        return;
+
+    SpatialSort();
+}
+
+/************************************************************************/
+/*                            SpatialSort()                             */
+/*                                                                      */
+/*      Rewrite the rows of the table in the order of the Hilbert       */
+/*      code of the center of the envelope of their geometry, so that   */
+/*      features close in space are stored in neighbouring pages.       */
+/*      The rows are renumbered in that order.                          */
+/************************************************************************/
+
+OGRErr OGRGeoPackageTableLayer::SpatialSort()
+{
+    if( m_pszFidColumn == nullptr ||
+        m_poFeatureDefn->GetGeomFieldCount() == 0 )
+        return OGRERR_NONE;
+
+    sqlite3* hDB = m_poDS->GetDB();
+    const char* pszT = m_pszTableName;
+    const char* pszI = m_pszFidColumn;
+    const char* pszC = m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+
+/* -------------------------------------------------------------------- */
+/*      Collect the center of the envelope of all features.             */
+/* -------------------------------------------------------------------- */
+    char* pszSQL = sqlite3_mprintf(
+        "SELECT \"%w\", ST_MinX(\"%w\"), ST_MaxX(\"%w\"), "
+        "ST_MinY(\"%w\"), ST_MaxY(\"%w\") FROM \"%w\"",
+            pszI, pszC, pszC, pszC, pszC, pszT );
+    sqlite3_stmt* hIterStmt = nullptr;
+    if ( sqlite3_prepare_v2(hDB, pszSQL, -1, &hIterStmt, nullptr) != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to prepare SQL: %s", pszSQL);
+        sqlite3_free(pszSQL);
+        return OGRERR_FAILURE;
+    }
+    sqlite3_free(pszSQL);
+
+    OGREnvelope sExtent;
+    std::vector<GIntBig> anIds;
+    std::vector<double> adfCenters;
+    std::vector<std::pair<GUInt32, size_t> > aoOrder;
+    try
+    {
+        while( true )
+        {
+            const int sqlite_err = sqlite3_step(hIterStmt);
+            if( sqlite_err == SQLITE_DONE )
+                break;
+            if( sqlite_err != SQLITE_ROW )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "failed to iterate over features while sorting "
+                          "them: %s",
+                          sqlite3_errmsg( hDB ) );
+                sqlite3_finalize(hIterStmt);
+                return OGRERR_FAILURE;
+            }
+            anIds.push_back(sqlite3_column_int64(hIterStmt, 0));
+            if( sqlite3_column_type(hIterStmt, 1) == SQLITE_NULL )
+            {
+                // No geometry or empty geometry: goes last.
+                adfCenters.push_back(std::numeric_limits<double>::quiet_NaN());
+                adfCenters.push_back(std::numeric_limits<double>::quiet_NaN());
+                continue;
+            }
+            const double dfX = (sqlite3_column_double(hIterStmt, 1) +
+                                sqlite3_column_double(hIterStmt, 2)) / 2;
+            const double dfY = (sqlite3_column_double(hIterStmt, 3) +
+                                sqlite3_column_double(hIterStmt, 4)) / 2;
+            adfCenters.push_back(dfX);
+            adfCenters.push_back(dfY);
+            if( !CPLIsNan(dfX) && !CPLIsNan(dfY) )
+                sExtent.Merge(dfX, dfY);
+        }
+        aoOrder.reserve(anIds.size());
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Not enough memory for sorting features of %s", pszT );
+        sqlite3_finalize(hIterStmt);
+        return OGRERR_FAILURE;
+    }
+    sqlite3_finalize(hIterStmt);
+
+    if( anIds.size() < 2 )
+        return OGRERR_NONE;
+
+    for( size_t i = 0; i < anIds.size(); i++ )
+    {
+        const double dfX = adfCenters[2 * i];
+        const double dfY = adfCenters[2 * i + 1];
+        const GUInt32 nCode = ( CPLIsNan(dfX) || CPLIsNan(dfY) ) ?
+            0xFFFFFFFFU : OGRHilbertCode(sExtent, dfX, dfY);
+        aoOrder.push_back(std::pair<GUInt32, size_t>(nCode, i));
+    }
+    std::sort(aoOrder.begin(), aoOrder.end());
+
+    CPLDebug("GPKG", "Sorting %d features of %s spatially",
+             static_cast<int>(anIds.size()), pszT);
+
+/* -------------------------------------------------------------------- */
+/*      Store the new rank of each feature in a temporary table.        */
+/* -------------------------------------------------------------------- */
+    m_poDS->SoftStartTransaction();
+
+    OGRErr err = SQLCommand(hDB,
+        "CREATE TEMP TABLE ogr_gpkg_spatial_sort "
+        "(fid INTEGER PRIMARY KEY, rank INTEGER)");
+    if( err != OGRERR_NONE )
+    {
+        m_poDS->SoftRollbackTransaction();
+        return err;
+    }
+
+    sqlite3_stmt* hInsertStmt = nullptr;
+    if( sqlite3_prepare_v2(hDB,
+            "INSERT INTO ogr_gpkg_spatial_sort (fid, rank) VALUES (?, ?)",
+            -1, &hInsertStmt, nullptr) != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to prepare SQL: %s", sqlite3_errmsg(hDB) );
+        m_poDS->SoftRollbackTransaction();
+        return OGRERR_FAILURE;
+    }
+    for( size_t i = 0; i < aoOrder.size(); i++ )
+    {
+        sqlite3_reset(hInsertStmt);
+        sqlite3_bind_int64(hInsertStmt, 1, anIds[aoOrder[i].second]);
+        sqlite3_bind_int64(hInsertStmt, 2, static_cast<GIntBig>(i));
+        if( sqlite3_step(hInsertStmt) != SQLITE_DONE )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "failed to execute insertion: %s",
+                      sqlite3_errmsg(hDB) );
+            sqlite3_finalize(hInsertStmt);
+            m_poDS->SoftRollbackTransaction();
+            return OGRERR_FAILURE;
+        }
+    }
+    sqlite3_finalize(hInsertStmt);
+
+/* -------------------------------------------------------------------- */
+/*      Copy the rows in sorted order to a temporary table, and then    */
+/*      back into the emptied table, without their FID so that new      */
+/*      ones are assigned in sorted order.                              */
+/* -------------------------------------------------------------------- */
+    CPLString osColumns;
+    osColumns += "\"";
+    osColumns += SQLEscapeName(pszC);
+    osColumns += "\"";
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( i == m_iFIDAsRegularColumnIndex )
+            continue;
+        osColumns += ", \"";
+        osColumns += SQLEscapeName(
+                        m_poFeatureDefn->GetFieldDefn(i)->GetNameRef());
+        osColumns += "\"";
+    }
+
+    char* apszSQL[5];
+    apszSQL[0] = sqlite3_mprintf(
+        "CREATE TEMP TABLE ogr_gpkg_sorted_features AS "
+        "SELECT t.* FROM \"%w\" t JOIN ogr_gpkg_spatial_sort s "
+        "ON t.\"%w\" = s.fid ORDER BY s.rank", pszT, pszI);
+    apszSQL[1] = sqlite3_mprintf("DELETE FROM \"%w\"", pszT);
+    // FID columns created by the driver are AUTOINCREMENT.
+    apszSQL[2] = sqlite3_mprintf(
+        "UPDATE sqlite_sequence SET seq = 0 WHERE name = '%q'", pszT);
+    apszSQL[3] = sqlite3_mprintf(
+        "INSERT INTO \"%w\" (%s) SELECT %s FROM ogr_gpkg_sorted_features "
+        "ORDER BY rowid", pszT, osColumns.c_str(), osColumns.c_str());
+    apszSQL[4] = sqlite3_mprintf(
+        "DROP TABLE ogr_gpkg_sorted_features; "
+        "DROP TABLE ogr_gpkg_spatial_sort");
+    for( int i = 0; i < 5; i++ )
+    {
+        // Only tables with an AUTOINCREMENT column have a sqlite_sequence
+        if( i == 2 && SQLGetInteger(hDB,
+                "SELECT 1 FROM sqlite_master WHERE name = 'sqlite_sequence'",
+                nullptr) != 1 )
+            continue;
+        if( err == OGRERR_NONE )
+            err = SQLCommand(hDB, apszSQL[i]);
+    }
+    for( int i = 0; i < 5; i++ )
+        sqlite3_free(apszSQL[i]);
+
+    if( err != OGRERR_NONE )
+    {
+        m_poDS->SoftRollbackTransaction();
+        SQLCommand(hDB, "DROP TABLE IF EXISTS ogr_gpkg_sorted_features");
+        SQLCommand(hDB, "DROP TABLE IF EXISTS ogr_gpkg_spatial_sort");
+        return err;
+    }
+
+    err = m_poDS->SoftCommitTransaction();
+
+    ResetReading();
+
+    return err;
+}
+
 /************************************************************************/
 /*                       CreateSpatialIndex()                           */
 /************************************************************************/
@@ -2553,6 +2785,366 @@ typedef struct
     double  dfMaxY;
 } GPKGRTreeEntry;
 
+/************************************************************************/
+/*                            GPKGRTreeCell                             */
+/*                                                                      */
+/*      Cell of a node of the SQLite R*Tree module: a rowid (in leaf    */
+/*      nodes) or child node number, and a float32 bounding box.        */
+/************************************************************************/
+
+typedef struct
+{
+    GIntBig nId;
+    float   fMinX;
+    float   fMaxX;
+    float   fMinY;
+    float   fMaxY;
+} GPKGRTreeCell;
+
+// Same rounding as the SQLite R*Tree module, so that the float32 box
+// always contains the double precision one.
+#define GPKG_RTREE_RNDTOWARDS  (1.0 - 1.0/8388608.0)
+#define GPKG_RTREE_RNDAWAY     (1.0 + 1.0/8388608.0)
+
+static float GPKGRTreeValueDown( double d )
+{
+    float f = static_cast<float>(d);
+    if( f > d )
+    {
+        f = static_cast<float>(
+            d * (d < 0 ? GPKG_RTREE_RNDAWAY : GPKG_RTREE_RNDTOWARDS));
+    }
+    return f;
+}
+
+static float GPKGRTreeValueUp( double d )
+{
+    float f = static_cast<float>(d);
+    if( f < d )
+    {
+        f = static_cast<float>(
+            d * (d < 0 ? GPKG_RTREE_RNDTOWARDS : GPKG_RTREE_RNDAWAY));
+    }
+    return f;
+}
+
+static bool GPKGRTreeCompareX( const GPKGRTreeCell& a, const GPKGRTreeCell& b )
+{
+    return a.fMinX + a.fMaxX < b.fMinX + b.fMaxX;
+}
+
+static bool GPKGRTreeCompareY( const GPKGRTreeCell& a, const GPKGRTreeCell& b )
+{
+    return a.fMinY + a.fMaxY < b.fMinY + b.fMaxY;
+}
+
+/************************************************************************/
+/*                          GPKGRTreeSTRSort()                          */
+/*                                                                      */
+/*      Sort-Tile-Recursive ordering: cells are sorted by X center,    */
+/*      cut in vertical slices of about sqrt(node count) nodes, and    */
+/*      each slice is sorted by Y center.  Consecutive runs of          */
+/*      nNodeCapacity cells then make compact nodes.                    */
+/************************************************************************/
+
+static void GPKGRTreeSTRSort( std::vector<GPKGRTreeCell>& aoCells,
+                              size_t nNodeCapacity )
+{
+    const size_t nCells = aoCells.size();
+    const size_t nNodes = (nCells + nNodeCapacity - 1) / nNodeCapacity;
+    const size_t nSlices = static_cast<size_t>(
+        ceil(sqrt(static_cast<double>(nNodes))));
+    const size_t nSliceSize = nSlices * nNodeCapacity;
+
+    std::sort(aoCells.begin(), aoCells.end(), GPKGRTreeCompareX);
+    for( size_t i = 0; i < nCells; i += nSliceSize )
+    {
+        std::sort(aoCells.begin() + i,
+                  aoCells.begin() + std::min(i + nSliceSize, nCells),
+                  GPKGRTreeCompareY);
+    }
+}
+
+static void GPKGRTreeWriteInt64( GByte* pabyDest, GIntBig nVal )
+{
+    GUIntBig nUVal = static_cast<GUIntBig>(nVal);
+    for( int i = 7; i >= 0; i-- )
+    {
+        pabyDest[i] = static_cast<GByte>(nUVal & 0xff);
+        nUVal >>= 8;
+    }
+}
+
+static void GPKGRTreeWriteFloat( GByte* pabyDest, float fVal )
+{
+    GUInt32 nVal;
+    memcpy(&nVal, &fVal, sizeof(nVal));
+    CPL_MSBPTR32(&nVal);
+    memcpy(pabyDest, &nVal, sizeof(nVal));
+}
+
+/************************************************************************/
+/*                       GPKGRTreeBulkLoadMaxCells()                    */
+/*                                                                      */
+/*      Maximum number of envelopes that can be held in memory by       */
+/*      BulkLoadRTree(), from OGR_GPKG_RTREE_BULK_LOAD_MAX_MEMORY (in   */
+/*      MB), or a quarter of the usable RAM.                            */
+/************************************************************************/
+
+static size_t GPKGRTreeBulkLoadMaxCells()
+{
+    const char* pszMaxMemory =
+        CPLGetConfigOption("OGR_GPKG_RTREE_BULK_LOAD_MAX_MEMORY", nullptr);
+    GIntBig nMaxMemory = 0;
+    if( pszMaxMemory != nullptr )
+    {
+        nMaxMemory = std::max(static_cast<GIntBig>(0),
+                              CPLAtoGIntBig(pszMaxMemory)) * 1024 * 1024;
+    }
+    else
+    {
+        nMaxMemory = CPLGetUsablePhysicalRAM() / 4;
+        if( nMaxMemory <= 0 )
+            nMaxMemory = static_cast<GIntBig>(1024) * 1024 * 1024;
+    }
+    // Leave room for the growth of the vector.
+    return static_cast<size_t>(std::min(
+        static_cast<GUIntBig>(nMaxMemory) / (2 * sizeof(GPKGRTreeCell)),
+        static_cast<GUIntBig>(std::numeric_limits<size_t>::max())));
+}
+
+/************************************************************************/
+/*                           BulkLoadRTree()                            */
+/*                                                                      */
+/*      Populate a newly created, empty, R*Tree virtual table by        */
+/*      writing directly its _node, _rowid and _parent shadow tables    */
+/*      with a Sort-Tile-Recursive packed tree, which is much faster    */
+/*      than inserting one entry at a time and gives a better query     */
+/*      performance.                                                    */
+/*                                                                      */
+/*      Returns OGRERR_UNSUPPORTED_OPERATION if nothing was written     */
+/*      and the caller should fall back to regular insertion. This is   */
+/*      also the case when the envelopes of all features do not fit in  */
+/*      the memory allowed by GPKGRTreeBulkLoadMaxCells().              */
+/************************************************************************/
+
+OGRErr OGRGeoPackageTableLayer::BulkLoadRTree( const char* pszT,
+                                               const char* pszI,
+                                               const char* pszC )
+{
+    sqlite3* hDB = m_poDS->GetDB();
+
+    // The node size is chosen by the R*Tree module from the page size,
+    // and can be found from the size of the root node.
+    char* pszSQL = sqlite3_mprintf(
+        "SELECT length(data) FROM \"%w_node\" WHERE nodeno = 1",
+        m_osRTreeName.c_str());
+    OGRErr err = OGRERR_NONE;
+    const int nNodeSize = SQLGetInteger(hDB, pszSQL, &err);
+    sqlite3_free(pszSQL);
+    const int nCellSize = 8 + 4 * 4;
+    if( err != OGRERR_NONE || nNodeSize < 4 + 2 * nCellSize )
+        return OGRERR_UNSUPPORTED_OPERATION;
+    const size_t nMaxCells = static_cast<size_t>((nNodeSize - 4) / nCellSize);
+
+/* -------------------------------------------------------------------- */
+/*      Collect the envelopes of all features.                          */
+/* -------------------------------------------------------------------- */
+    pszSQL = sqlite3_mprintf(
+        "SELECT \"%w\", ST_MinX(\"%w\"), ST_MaxX(\"%w\"), "
+        "ST_MinY(\"%w\"), ST_MaxY(\"%w\") FROM \"%w\" "
+        "WHERE \"%w\" NOT NULL AND NOT ST_IsEmpty(\"%w\")",
+            pszI, pszC, pszC, pszC, pszC, pszT, pszC, pszC );
+    sqlite3_stmt* hIterStmt = nullptr;
+    if ( sqlite3_prepare_v2(hDB, pszSQL, -1, &hIterStmt, nullptr) != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to prepare SQL: %s", pszSQL);
+        sqlite3_free(pszSQL);
+        return OGRERR_FAILURE;
+    }
+    sqlite3_free(pszSQL);
+
+    const size_t nMaxBulkLoadCells = GPKGRTreeBulkLoadMaxCells();
+    std::vector<GPKGRTreeCell> aoCells;
+    try
+    {
+        while( true )
+        {
+            const int sqlite_err = sqlite3_step(hIterStmt);
+            if( sqlite_err == SQLITE_DONE )
+                break;
+            if( sqlite_err == SQLITE_ROW &&
+                aoCells.size() >= nMaxBulkLoadCells )
+            {
+                CPLDebug("GPKG", "Too many features for bulk loading of %s",
+                         m_osRTreeName.c_str());
+                sqlite3_finalize(hIterStmt);
+                return OGRERR_UNSUPPORTED_OPERATION;
+            }
+            if( sqlite_err != SQLITE_ROW )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "failed to iterate over features while inserting in "
+                          "RTree: %s",
+                          sqlite3_errmsg( hDB ) );
+                sqlite3_finalize(hIterStmt);
+                return OGRERR_FAILURE;
+            }
+            GPKGRTreeCell sCell;
+            sCell.nId = sqlite3_column_int64(hIterStmt, 0);
+            sCell.fMinX = GPKGRTreeValueDown(sqlite3_column_double(hIterStmt, 1));
+            sCell.fMaxX = GPKGRTreeValueUp(sqlite3_column_double(hIterStmt, 2));
+            sCell.fMinY = GPKGRTreeValueDown(sqlite3_column_double(hIterStmt, 3));
+            sCell.fMaxY = GPKGRTreeValueUp(sqlite3_column_double(hIterStmt, 4));
+            aoCells.push_back(sCell);
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLDebug("GPKG", "Not enough memory for bulk loading of %s",
+                 m_osRTreeName.c_str());
+        sqlite3_finalize(hIterStmt);
+        return OGRERR_UNSUPPORTED_OPERATION;
+    }
+    sqlite3_finalize(hIterStmt);
+
+    if( aoCells.empty() )
+        return OGRERR_NONE;
+
+/* -------------------------------------------------------------------- */
+/*      Prepare the statements for the shadow tables.                   */
+/* -------------------------------------------------------------------- */
+    const char* const apszSQL[] = {
+        "UPDATE \"%w_node\" SET data = ? WHERE nodeno = 1",
+        "INSERT INTO \"%w_node\" (nodeno, data) VALUES (?, ?)",
+        "INSERT INTO \"%w_rowid\" (rowid, nodeno) VALUES (?, ?)",
+        "INSERT INTO \"%w_parent\" (nodeno, parentnode) VALUES (?, ?)" };
+    sqlite3_stmt* ahStmt[4] = { nullptr, nullptr, nullptr, nullptr };
+    for( int i = 0; i < 4; i++ )
+    {
+        pszSQL = sqlite3_mprintf(apszSQL[i], m_osRTreeName.c_str());
+        if( sqlite3_prepare_v2(hDB, pszSQL, -1, &ahStmt[i], nullptr)
+                                                            != SQLITE_OK )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "failed to prepare SQL: %s", pszSQL);
+            sqlite3_free(pszSQL);
+            for( int j = 0; j < i; j++ )
+                sqlite3_finalize(ahStmt[j]);
+            return OGRERR_FAILURE;
+        }
+        sqlite3_free(pszSQL);
+    }
+    sqlite3_stmt* const hUpdateRootStmt = ahStmt[0];
+    sqlite3_stmt* const hInsertNodeStmt = ahStmt[1];
+    sqlite3_stmt* const hInsertRowidStmt = ahStmt[2];
+    sqlite3_stmt* const hInsertParentStmt = ahStmt[3];
+
+/* -------------------------------------------------------------------- */
+/*      Build the tree bottom-up, one level at a time.  The root is     */
+/*      always node 1, and stores the depth of the tree.                */
+/* -------------------------------------------------------------------- */
+    const GUIntBig nEntryCount = aoCells.size();
+    std::vector<GByte> abyNode(nNodeSize);
+    GIntBig nNextNodeNo = 2;
+    int nDepth = 0;
+    int sqlite_err = SQLITE_OK;
+    while( sqlite_err == SQLITE_OK )
+    {
+        const bool bRoot = aoCells.size() <= nMaxCells;
+        if( !bRoot )
+            GPKGRTreeSTRSort(aoCells, nMaxCells);
+
+        std::vector<GPKGRTreeCell> aoParentCells;
+        for( size_t iStart = 0;
+             sqlite_err == SQLITE_OK && iStart < aoCells.size();
+             iStart += nMaxCells )
+        {
+            const size_t nCells = std::min(nMaxCells, aoCells.size() - iStart);
+            const GIntBig nNodeNo = bRoot ? 1 : nNextNodeNo++;
+
+            std::fill(abyNode.begin(), abyNode.end(), static_cast<GByte>(0));
+            const int nNodeDepth = bRoot ? nDepth : 0;
+            abyNode[0] = static_cast<GByte>(nNodeDepth >> 8);
+            abyNode[1] = static_cast<GByte>(nNodeDepth & 0xff);
+            abyNode[2] = static_cast<GByte>(nCells >> 8);
+            abyNode[3] = static_cast<GByte>(nCells & 0xff);
+
+            GPKGRTreeCell sParent = aoCells[iStart];
+            sParent.nId = nNodeNo;
+            sqlite3_stmt* hChildStmt =
+                nDepth == 0 ? hInsertRowidStmt : hInsertParentStmt;
+            for( size_t i = 0; i < nCells; i++ )
+            {
+                const GPKGRTreeCell& sCell = aoCells[iStart + i];
+                GByte* pabyCell = &abyNode[4 + i * nCellSize];
+                GPKGRTreeWriteInt64(pabyCell, sCell.nId);
+                GPKGRTreeWriteFloat(pabyCell + 8, sCell.fMinX);
+                GPKGRTreeWriteFloat(pabyCell + 12, sCell.fMaxX);
+                GPKGRTreeWriteFloat(pabyCell + 16, sCell.fMinY);
+                GPKGRTreeWriteFloat(pabyCell + 20, sCell.fMaxY);
+
+                sParent.fMinX = std::min(sParent.fMinX, sCell.fMinX);
+                sParent.fMaxX = std::max(sParent.fMaxX, sCell.fMaxX);
+                sParent.fMinY = std::min(sParent.fMinY, sCell.fMinY);
+                sParent.fMaxY = std::max(sParent.fMaxY, sCell.fMaxY);
+
+                sqlite3_reset(hChildStmt);
+                sqlite3_bind_int64(hChildStmt, 1, sCell.nId);
+                sqlite3_bind_int64(hChildStmt, 2, nNodeNo);
+                sqlite_err = sqlite3_step(hChildStmt);
+                if( sqlite_err != SQLITE_DONE )
+                    break;
+                sqlite_err = SQLITE_OK;
+            }
+            if( sqlite_err != SQLITE_OK )
+                break;
+
+            if( bRoot )
+            {
+                sqlite3_reset(hUpdateRootStmt);
+                sqlite3_bind_blob(hUpdateRootStmt, 1, &abyNode[0], nNodeSize,
+                                  SQLITE_STATIC);
+                sqlite_err = sqlite3_step(hUpdateRootStmt);
+            }
+            else
+            {
+                sqlite3_reset(hInsertNodeStmt);
+                sqlite3_bind_int64(hInsertNodeStmt, 1, nNodeNo);
+                sqlite3_bind_blob(hInsertNodeStmt, 2, &abyNode[0], nNodeSize,
+                                  SQLITE_STATIC);
+                sqlite_err = sqlite3_step(hInsertNodeStmt);
+            }
+            if( sqlite_err != SQLITE_DONE )
+                break;
+            sqlite_err = SQLITE_OK;
+
+            aoParentCells.push_back(sParent);
+        }
+
+        if( bRoot )
+            break;
+        aoCells.swap(aoParentCells);
+        nDepth++;
+    }
+
+    for( int i = 0; i < 4; i++ )
+        sqlite3_finalize(ahStmt[i]);
+
+    if( sqlite_err != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to execute insertion in RTree : %s",
+                  sqlite3_errmsg( hDB ) );
+        return OGRERR_FAILURE;
+    }
+
+    CPLDebug("GPKG", CPL_FRMT_GUIB " rows bulk loaded into %s (depth %d)",
+             nEntryCount, m_osRTreeName.c_str(), nDepth);
+    return OGRERR_NONE;
+}
+
 bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
 {
     OGRErr err;
@@ -2599,6 +3191,7 @@ bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
 
     char* pszSQL;
     /* Create virtual table */
+    const bool bNewRTreeTable = !m_bDropRTreeTable;
     if( !m_bDropRTreeTable )
     {
         pszSQL = sqlite3_mprintf(
@@ -2615,125 +3208,143 @@ bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
     m_bDropRTreeTable = false;
 
     /* Populate the RTree */
-#ifdef NO_PROGRESSIVE_RTREE_INSERTION
-    pszSQL = sqlite3_mprintf(
-        "INSERT INTO \"%w\" "
-        "SELECT \"%w\", ST_MinX(\"%w\"), ST_MaxX(\"%w\"), "
-        "ST_MinY(\"%w\"), ST_MaxY(\"%w\") FROM \"%w\" "
-        "WHERE \"%w\" NOT NULL AND NOT ST_IsEmpty(\"%w\")",
-        m_osRTreeName.c_str(), pszI, pszC, pszC, pszC, pszC, pszT, pszC, pszC );
-    err = SQLCommand(m_poDS->GetDB(), pszSQL);
-    sqlite3_free(pszSQL);
-    if( err != OGRERR_NONE )
+    if( bNewRTreeTable &&
+        CPLTestBool(CPLGetConfigOption("OGR_GPKG_RTREE_BULK_LOAD", "YES")) )
     {
-        m_poDS->SoftRollbackTransaction();
-        return false;
+        err = BulkLoadRTree(pszT, pszI, pszC);
+        if( err != OGRERR_NONE && err != OGRERR_UNSUPPORTED_OPERATION )
+        {
+            m_poDS->SoftRollbackTransaction();
+            return false;
+        }
     }
-#else
-    pszSQL = sqlite3_mprintf(
-        "SELECT \"%w\", ST_MinX(\"%w\"), ST_MaxX(\"%w\"), "
-        "ST_MinY(\"%w\"), ST_MaxY(\"%w\") FROM \"%w\" "
-        "WHERE \"%w\" NOT NULL AND NOT ST_IsEmpty(\"%w\")",
-            pszI, pszC, pszC, pszC, pszC, pszT, pszC, pszC );
-    sqlite3_stmt* hIterStmt = nullptr;
-    if ( sqlite3_prepare_v2(m_poDS->GetDB(), pszSQL, -1, &hIterStmt, nullptr)
-                                                            != SQLITE_OK )
+    else
     {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                    "failed to prepare SQL: %s", pszSQL);
-        sqlite3_free(pszSQL);
-        m_poDS->SoftRollbackTransaction();
-        return false;
+        err = OGRERR_UNSUPPORTED_OPERATION;
     }
-    sqlite3_free(pszSQL);
 
-    pszSQL = sqlite3_mprintf(
-        "INSERT INTO \"%w\" VALUES (?,?,?,?,?)",
-        m_osRTreeName.c_str());
-    sqlite3_stmt* hInsertStmt = nullptr;
-    if ( sqlite3_prepare_v2(m_poDS->GetDB(), pszSQL, -1, &hInsertStmt, nullptr)
-                                                            != SQLITE_OK )
+    if( err == OGRERR_UNSUPPORTED_OPERATION )
     {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                    "failed to prepare SQL: %s", pszSQL);
+#ifdef NO_PROGRESSIVE_RTREE_INSERTION
+        pszSQL = sqlite3_mprintf(
+            "INSERT INTO \"%w\" "
+            "SELECT \"%w\", ST_MinX(\"%w\"), ST_MaxX(\"%w\"), "
+            "ST_MinY(\"%w\"), ST_MaxY(\"%w\") FROM \"%w\" "
+            "WHERE \"%w\" NOT NULL AND NOT ST_IsEmpty(\"%w\")",
+            m_osRTreeName.c_str(), pszI, pszC, pszC, pszC, pszC, pszT, pszC, pszC );
+        err = SQLCommand(m_poDS->GetDB(), pszSQL);
         sqlite3_free(pszSQL);
-        sqlite3_finalize(hIterStmt);
-        m_poDS->SoftRollbackTransaction();
-        return false;
-    }
-    sqlite3_free(pszSQL);
-
-    // Insert entries in RTree by chuncks of 100000
-    std::vector<GPKGRTreeEntry> aoEntries;
-    GUIntBig nEntryCount = 0;
-    const size_t nChunkSize = 100000;
-    while( true )
-    {
-        int sqlite_err = sqlite3_step(hIterStmt);
-        bool bFinished = false;
-        if( sqlite_err == SQLITE_ROW )
+        if( err != OGRERR_NONE )
         {
-            GPKGRTreeEntry sEntry;
-            sEntry.nId = sqlite3_column_int64(hIterStmt, 0);
-            sEntry.dfMinX = sqlite3_column_double(hIterStmt, 1);
-            sEntry.dfMaxX = sqlite3_column_double(hIterStmt, 2);
-            sEntry.dfMinY = sqlite3_column_double(hIterStmt, 3);
-            sEntry.dfMaxY = sqlite3_column_double(hIterStmt, 4);
-            aoEntries.push_back(sEntry);
+            m_poDS->SoftRollbackTransaction();
+            return false;
         }
-        else if( sqlite_err == SQLITE_DONE )
+#else
+        pszSQL = sqlite3_mprintf(
+            "SELECT \"%w\", ST_MinX(\"%w\"), ST_MaxX(\"%w\"), "
+            "ST_MinY(\"%w\"), ST_MaxY(\"%w\") FROM \"%w\" "
+            "WHERE \"%w\" NOT NULL AND NOT ST_IsEmpty(\"%w\")",
+                pszI, pszC, pszC, pszC, pszC, pszT, pszC, pszC );
+        sqlite3_stmt* hIterStmt = nullptr;
+        if ( sqlite3_prepare_v2(m_poDS->GetDB(), pszSQL, -1, &hIterStmt, nullptr)
+                                                                != SQLITE_OK )
         {
-            bFinished = true;
+            CPLError( CE_Failure, CPLE_AppDefined,
+                        "failed to prepare SQL: %s", pszSQL);
+            sqlite3_free(pszSQL);
+            m_poDS->SoftRollbackTransaction();
+            return false;
         }
-        else
+        sqlite3_free(pszSQL);
+
+        pszSQL = sqlite3_mprintf(
+            "INSERT INTO \"%w\" VALUES (?,?,?,?,?)",
+            m_osRTreeName.c_str());
+        sqlite3_stmt* hInsertStmt = nullptr;
+        if ( sqlite3_prepare_v2(m_poDS->GetDB(), pszSQL, -1, &hInsertStmt, nullptr)
+                                                                != SQLITE_OK )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
-                      "failed to iterate over features while inserting in "
-                      "RTree: %s",
-                      sqlite3_errmsg( m_poDS->GetDB() ) );
+                        "failed to prepare SQL: %s", pszSQL);
+            sqlite3_free(pszSQL);
             sqlite3_finalize(hIterStmt);
-            sqlite3_finalize(hInsertStmt);
             m_poDS->SoftRollbackTransaction();
             return false;
         }
+        sqlite3_free(pszSQL);
 
-        if( aoEntries.size() == nChunkSize || bFinished )
+        // Insert entries in RTree by chuncks of 100000
+        std::vector<GPKGRTreeEntry> aoEntries;
+        GUIntBig nEntryCount = 0;
+        const size_t nChunkSize = 100000;
+        while( true )
         {
-            for( size_t i = 0; i < aoEntries.size(); ++i )
+            int sqlite_err = sqlite3_step(hIterStmt);
+            bool bFinished = false;
+            if( sqlite_err == SQLITE_ROW )
             {
-                sqlite3_reset(hInsertStmt);
-
-                sqlite3_bind_int64(hInsertStmt,1,aoEntries[i].nId);
-                sqlite3_bind_double(hInsertStmt,2,aoEntries[i].dfMinX);
-                sqlite3_bind_double(hInsertStmt,3,aoEntries[i].dfMaxX);
-                sqlite3_bind_double(hInsertStmt,4,aoEntries[i].dfMinY);
-                sqlite3_bind_double(hInsertStmt,5,aoEntries[i].dfMaxY);
-                sqlite_err = sqlite3_step(hInsertStmt);
-                if ( sqlite_err != SQLITE_OK && sqlite_err != SQLITE_DONE )
+                GPKGRTreeEntry sEntry;
+                sEntry.nId = sqlite3_column_int64(hIterStmt, 0);
+                sEntry.dfMinX = sqlite3_column_double(hIterStmt, 1);
+                sEntry.dfMaxX = sqlite3_column_double(hIterStmt, 2);
+                sEntry.dfMinY = sqlite3_column_double(hIterStmt, 3);
+                sEntry.dfMaxY = sqlite3_column_double(hIterStmt, 4);
+                aoEntries.push_back(sEntry);
+            }
+            else if( sqlite_err == SQLITE_DONE )
+            {
+                bFinished = true;
+            }
+            else
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "failed to iterate over features while inserting in "
+                          "RTree: %s",
+                          sqlite3_errmsg( m_poDS->GetDB() ) );
+                sqlite3_finalize(hIterStmt);
+                sqlite3_finalize(hInsertStmt);
+                m_poDS->SoftRollbackTransaction();
+                return false;
+            }
+
+            if( aoEntries.size() == nChunkSize || bFinished )
+            {
+                for( size_t i = 0; i < aoEntries.size(); ++i )
                 {
-                    CPLError( CE_Failure, CPLE_AppDefined,
-                              "failed to execute insertion in RTree : %s",
-                              sqlite3_errmsg( m_poDS->GetDB() ) );
-                    sqlite3_finalize(hIterStmt);
-                    sqlite3_finalize(hInsertStmt);
-                    m_poDS->SoftRollbackTransaction();
-                    return false;
+                    sqlite3_reset(hInsertStmt);
+
+                    sqlite3_bind_int64(hInsertStmt,1,aoEntries[i].nId);
+                    sqlite3_bind_double(hInsertStmt,2,aoEntries[i].dfMinX);
+                    sqlite3_bind_double(hInsertStmt,3,aoEntries[i].dfMaxX);
+                    sqlite3_bind_double(hInsertStmt,4,aoEntries[i].dfMinY);
+                    sqlite3_bind_double(hInsertStmt,5,aoEntries[i].dfMaxY);
+                    sqlite_err = sqlite3_step(hInsertStmt);
+                    if ( sqlite_err != SQLITE_OK && sqlite_err != SQLITE_DONE )
+                    {
+                        CPLError( CE_Failure, CPLE_AppDefined,
+                                  "failed to execute insertion in RTree : %s",
+                                  sqlite3_errmsg( m_poDS->GetDB() ) );
+                        sqlite3_finalize(hIterStmt);
+                        sqlite3_finalize(hInsertStmt);
+                        m_poDS->SoftRollbackTransaction();
+                        return false;
+                    }
                 }
-            }
 
-            nEntryCount += aoEntries.size();
-            CPLDebug("GPKG", CPL_FRMT_GUIB " rows inserted into %s",
-                     nEntryCount, m_osRTreeName.c_str());
+                nEntryCount += aoEntries.size();
+                CPLDebug("GPKG", CPL_FRMT_GUIB " rows inserted into %s",
+                         nEntryCount, m_osRTreeName.c_str());
 
-            aoEntries.clear();
-            if( bFinished )
-                break;
+                aoEntries.clear();
+                if( bFinished )
+                    break;
+            }
         }
-    }
 
-    sqlite3_finalize(hIterStmt);
-    sqlite3_finalize(hInsertStmt);
+        sqlite3_finalize(hIterStmt);
+        sqlite3_finalize(hInsertStmt);
 #endif
+    }
 
     CPLString osSQL;
 
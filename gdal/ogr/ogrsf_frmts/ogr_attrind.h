@@ -38,6 +38,12 @@
 /*                             OGRAttrIndex                             */
 /*                                                                      */
 /*      Base class for accessing the indexing info about one field.     */
+/*                                                                      */
+/*      Drivers whose native indexes are ordered can let                */
+/*      OGRFeatureQuery::EvaluateAgainstIndices() answer range and      */
+/*      prefix predicates with them, by installing their own            */
+/*      OGRLayerAttrIndex in OGRLayer::m_poAttrIndex and returning      */
+/*      true from SupportsRangeMatches().                               */
 /************************************************************************/
 
 class CPL_DLL OGRAttrIndex
@@ -52,6 +58,16 @@ public:
     virtual GIntBig  *GetAllMatches( OGRField *psKey ) = 0;
     virtual GIntBig  *GetAllMatches( OGRField *psKey, GIntBig* panFIDList, int* nFIDCount, int* nLength ) = 0;
 
+    /* Optional support for ordered indexes.  NULL bounds are open ended. */
+    virtual bool      SupportsRangeMatches() { return false; }
+    virtual GIntBig  *GetRangeMatches( OGRField *psMinKey, bool bMinIncluded,
+                                       OGRField *psMaxKey, bool bMaxIncluded,
+                                       GIntBig* panFIDList, int* nFIDCount,
+                                       int* nLength );
+    virtual GIntBig  *GetPrefixMatches( const char *pszPrefix,
+                                        GIntBig* panFIDList, int* nFIDCount,
+                                        int* nLength );
+
     virtual OGRErr AddEntry( OGRField *psKey, GIntBig nFID ) = 0;
     virtual OGRErr RemoveEntry( OGRField *psKey, GIntBig nFID ) = 0;
 
@@ -89,6 +105,7 @@ public:
 };
 
 OGRLayerAttrIndex CPL_DLL *OGRCreateDefaultLayerIndex();
+OGRLayerAttrIndex CPL_DLL *OGRCreateMILayerIndex();
 
 //! @endcond
 
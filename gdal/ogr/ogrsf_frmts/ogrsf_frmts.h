@@ -107,6 +107,7 @@ class CPL_DLL OGRLayer : public GDALMajorObject
 
     virtual void        ResetReading() = 0;
     virtual OGRFeature *GetNextFeature() CPL_WARN_UNUSED_RESULT = 0;
+    virtual bool        GetNextFeatureInto( OGRFeature *poFeature );
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
     virtual OGRFeature *GetFeature( GIntBig nFID )  CPL_WARN_UNUSED_RESULT;
 
@@ -381,6 +382,7 @@ void CPL_DLL RegisterOGRKML();
 void CPL_DLL RegisterOGRGeoJSON();
 void CPL_DLL RegisterOGRESRIJSON();
 void CPL_DLL RegisterOGRTopoJSON();
+void CPL_DLL RegisterOGRGeoJSONSeq();
 void CPL_DLL RegisterOGRAVCBin();
 void CPL_DLL RegisterOGRAVCE00();
 void CPL_DLL RegisterOGRREC();
@@ -449,6 +451,7 @@ void CPL_DLL RegisterOGRMongoDB();
 void CPL_DLL RegisterOGRVDV();
 void CPL_DLL RegisterOGRGMLAS();
 void CPL_DLL RegisterOGRMVT();
+void CPL_DLL RegisterOGRFlatGeobuf();
 // @endcond
 
 CPL_C_END
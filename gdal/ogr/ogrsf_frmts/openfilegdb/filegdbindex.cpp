@@ -29,12 +29,14 @@
 #include "cpl_port.h"
 #include "filegdbtable_priv.h"
 
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -265,6 +267,62 @@ class FileGDBIndexIterator CPL_FINAL : public FileGDBIterator
                                                        double& dfSum, int& nCount) override;
 };
 
+/************************************************************************/
+/*                      FileGDBSpatialIndexIterator                     */
+/*                                                                      */
+/*      Iterates over the rows referenced by the .spx spatial index     */
+/*      in the grid cells touched by a filter envelope. The .spx        */
+/*      shares the paged B-tree layout of the .atx files, with 64 bit   */
+/*      keys made of the grid level (2 most significant bits), the      */
+/*      cell column (next 31 bits) and the cell row (31 least           */
+/*      significant bits). Keys are ordered as signed integers, so      */
+/*      the keys of levels 2 and 3 come first in the B-tree. A feature  */
+/*      has one entry for each cell its envelope covers, in the finest  */
+/*      grid where it does not cover too many cells. Returned rows are  */
+/*      candidates only: the caller must still check the geometry       */
+/*      against the filter.                                             */
+/************************************************************************/
+
+class FileGDBSpatialIndexIterator CPL_FINAL : public FileGDBIterator
+{
+        FileGDBTable        *poParent;
+        VSILFILE            *fpSpx;
+        GUInt32              nMaxPerPages;
+        GUInt32              nOffsetFirstValInPage;
+        GUInt32              nIndexDepth;
+        GByte                abyPage[MAX_DEPTH + 1][FGDB_PAGE_SIZE];
+
+        std::vector<int>     anRows;
+        size_t               iCurRow;
+
+        /* Key range, and for level 0, cell row range to check in leaves */
+        GIntBig              nMinKey;
+        GIntBig              nMaxKey;
+        bool                 bCheckCellRow;
+        GUInt32              nMinCellRow;
+        GUInt32              nMaxCellRow;
+
+        GIntBig              GetKey(const GByte* pabyPage, GUInt32 i) const;
+        int                  CollectRows(GUInt32 iLevel, GUInt32 nPage);
+        int                  CollectRange(GUIntBig nMin, GUIntBig nMax);
+        int                  Init(const OGREnvelope& sFilterEnvelope);
+
+        explicit             FileGDBSpatialIndexIterator(
+                                                FileGDBTable* poParentIn);
+
+    public:
+        virtual             ~FileGDBSpatialIndexIterator();
+
+        static FileGDBIterator* Build(FileGDBTable* poParent,
+                                      const OGREnvelope& sFilterEnvelope);
+
+        virtual FileGDBTable        *GetTable() override { return poParent; }
+        virtual void                 Reset() override { iCurRow = 0; }
+        virtual int                  GetNextRowSortedByFID() override;
+        virtual int                  GetRowCount() override
+                                    { return static_cast<int>(anRows.size()); }
+};
+
 /************************************************************************/
 /*                            GetMinValue()                             */
 /************************************************************************/
@@ -379,6 +437,17 @@ FileGDBIterator* FileGDBIterator::BuildOr(FileGDBIterator* poIter1,
     return new FileGDBOrIterator(poIter1, poIter2, bIteratorAreExclusive);
 }
 
+/************************************************************************/
+/*                       BuildFromSpatialIndex()                        */
+/************************************************************************/
+
+FileGDBIterator* FileGDBIterator::BuildFromSpatialIndex(
+                                        FileGDBTable* poParent,
+                                        const OGREnvelope& sFilterEnvelope)
+{
+    return FileGDBSpatialIndexIterator::Build(poParent, sFilterEnvelope);
+}
+
 /************************************************************************/
 /*                           GetRowCount()                              */
 /************************************************************************/
@@ -1851,4 +1920,264 @@ int FileGDBIndexIterator::GetMinMaxSumCount(double& dfMin, double& dfMax,
     return TRUE;
 }
 
+/************************************************************************/
+/*                     FileGDBSpatialIndexIterator()                    */
+/************************************************************************/
+
+FileGDBSpatialIndexIterator::FileGDBSpatialIndexIterator(
+                                                FileGDBTable* poParentIn ) :
+    poParent(poParentIn),
+    fpSpx(nullptr),
+    nMaxPerPages(0),
+    nOffsetFirstValInPage(0),
+    nIndexDepth(0),
+    iCurRow(0),
+    nMinKey(0),
+    nMaxKey(0),
+    bCheckCellRow(false),
+    nMinCellRow(0),
+    nMaxCellRow(0)
+{}
+
+/************************************************************************/
+/*                    ~FileGDBSpatialIndexIterator()                    */
+/************************************************************************/
+
+FileGDBSpatialIndexIterator::~FileGDBSpatialIndexIterator()
+{
+    if( fpSpx )
+        VSIFCloseL(fpSpx);
+}
+
+/************************************************************************/
+/*                                Build()                               */
+/************************************************************************/
+
+FileGDBIterator* FileGDBSpatialIndexIterator::Build(
+                                        FileGDBTable* poParent,
+                                        const OGREnvelope& sFilterEnvelope)
+{
+    FileGDBSpatialIndexIterator* poIter =
+                new FileGDBSpatialIndexIterator(poParent);
+    if( poIter->Init(sFilterEnvelope) )
+        return poIter;
+    delete poIter;
+    return nullptr;
+}
+
+/************************************************************************/
+/*                               GetKey()                               */
+/************************************************************************/
+
+GIntBig FileGDBSpatialIndexIterator::GetKey(const GByte* pabyPageIn,
+                                            GUInt32 i) const
+{
+    const GByte* pabyKey = pabyPageIn + nOffsetFirstValInPage;
+    return static_cast<GIntBig>(
+           static_cast<GUIntBig>(GetUInt32(pabyKey, 2 * i)) |
+           (static_cast<GUIntBig>(GetUInt32(pabyKey, 2 * i + 1)) << 32));
+}
+
+/************************************************************************/
+/*                          SpatialIndexCell()                          */
+/*                                                                      */
+/*      Cell number, as encoded in the keys, of a coordinate.           */
+/************************************************************************/
+
+static GUInt32 SpatialIndexCell(double dfCoord, double dfGridSize)
+{
+    const double dfCell = floor(dfCoord / dfGridSize) + (1 << 29);
+    if( !(dfCell >= 0) )
+        return 0;
+    if( dfCell >= 0x7FFFFFFF )
+        return 0x7FFFFFFF;
+    return static_cast<GUInt32>(dfCell);
+}
+
+/************************************************************************/
+/*                                Init()                                */
+/************************************************************************/
+
+int FileGDBSpatialIndexIterator::Init(const OGREnvelope& sFilterEnvelope)
+{
+    const int errorRetValue = FALSE;
+
+    const FileGDBGeomField* poGeomField = poParent->GetGeomField();
+    if( poGeomField == nullptr )
+        return FALSE;
+    const std::vector<double>& adfGridSize =
+                            poGeomField->GetSpatialIndexGridResolution();
+    if( adfGridSize.empty() || !(adfGridSize[0] > 0) )
+        return FALSE;
+
+    const char* pszSpxName = CPLResetExtension(
+                                    poParent->GetFilename().c_str(), "spx");
+    fpSpx = VSIFOpenL( pszSpxName, "rb" );
+    if( fpSpx == nullptr )
+        return FALSE;
+
+    VSIFSeekL(fpSpx, 0, SEEK_END);
+    vsi_l_offset nFileSize = VSIFTellL(fpSpx);
+    returnErrorIf(nFileSize < FGDB_PAGE_SIZE + 22 );
+
+    VSIFSeekL(fpSpx, nFileSize - 22, SEEK_SET);
+    GByte abyTrailer[22];
+    returnErrorIf(VSIFReadL( abyTrailer, 22, 1, fpSpx ) != 1 );
+    returnErrorIf(abyTrailer[0] != sizeof(GUIntBig) );
+
+    nMaxPerPages = (FGDB_PAGE_SIZE - 12) / (4 + abyTrailer[0]);
+    nOffsetFirstValInPage = 12 + nMaxPerPages * 4;
+
+    GUInt32 nMagic1 = GetUInt32(abyTrailer + 2, 0);
+    returnErrorIf(nMagic1 != 1 );
+
+    nIndexDepth = GetUInt32(abyTrailer + 6, 0);
+    returnErrorIf(!(nIndexDepth >= 1 && nIndexDepth <= MAX_DEPTH + 1) );
+
+/* -------------------------------------------------------------------- */
+/*      Finest grid: only look at the cells touched by the envelope,    */
+/*      slightly enlarged to be robust to the quantization of the       */
+/*      coordinates.                                                    */
+/* -------------------------------------------------------------------- */
+    const double dfEps = poGeomField->GetXYScale() > 0 ?
+                            1.0 / poGeomField->GetXYScale() : 0.0;
+    const GUInt32 nMinCol =
+        SpatialIndexCell(sFilterEnvelope.MinX - dfEps, adfGridSize[0]);
+    const GUInt32 nMaxCol =
+        SpatialIndexCell(sFilterEnvelope.MaxX + dfEps, adfGridSize[0]);
+    nMinCellRow =
+        SpatialIndexCell(sFilterEnvelope.MinY - dfEps, adfGridSize[0]);
+    nMaxCellRow =
+        SpatialIndexCell(sFilterEnvelope.MaxY + dfEps, adfGridSize[0]);
+
+    // One B-tree lookup per column when there are not too many of them,
+    // otherwise a single lookup over all the columns.
+    const GUInt32 nMaxColumnLookups = 256;
+    if( nMaxCol - nMinCol < nMaxColumnLookups )
+    {
+        bCheckCellRow = false;
+        for( GUInt32 nCol = nMinCol; nCol <= nMaxCol; nCol++ )
+        {
+            const GUIntBig nColKey = static_cast<GUIntBig>(nCol) << 31;
+            if( !CollectRange(nColKey | nMinCellRow, nColKey | nMaxCellRow) )
+                return FALSE;
+        }
+    }
+    else
+    {
+        bCheckCellRow = true;
+        if( !CollectRange(static_cast<GUIntBig>(nMinCol) << 31,
+                          (static_cast<GUIntBig>(nMaxCol) << 31) | 0x7FFFFFFF) )
+            return FALSE;
+        bCheckCellRow = false;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Coarser grids only contain the few features too large for the   */
+/*      finest one, so take all their entries.                          */
+/* -------------------------------------------------------------------- */
+    for( size_t iGrid = 1; iGrid < adfGridSize.size() && iGrid < 4; iGrid++ )
+    {
+        if( !(adfGridSize[iGrid] > 0) )
+            continue;
+        const GUIntBig nLevelKey = static_cast<GUIntBig>(iGrid) << 62;
+        if( !CollectRange(nLevelKey,
+                          nLevelKey | ((static_cast<GUIntBig>(1) << 62) - 1)) )
+            return FALSE;
+    }
+
+    std::sort(anRows.begin(), anRows.end());
+    anRows.erase(std::unique(anRows.begin(), anRows.end()), anRows.end());
+
+    VSIFCloseL(fpSpx);
+    fpSpx = nullptr;
+
+    CPLDebug("OpenFileGDB", "Using spatial index of %s: %d candidate rows",
+             CPLGetFilename(poParent->GetFilename().c_str()),
+             static_cast<int>(anRows.size()));
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                            CollectRange()                            */
+/*                                                                      */
+/*      Collect the rows of the keys in [nMin, nMax], given as their    */
+/*      unsigned encoding. The range must not cross a grid level.       */
+/************************************************************************/
+
+int FileGDBSpatialIndexIterator::CollectRange(GUIntBig nMin, GUIntBig nMax)
+{
+    nMinKey = static_cast<GIntBig>(nMin);
+    nMaxKey = static_cast<GIntBig>(nMax);
+    return CollectRows(0, 1);
+}
+
+/************************************************************************/
+/*                            CollectRows()                             */
+/************************************************************************/
+
+int FileGDBSpatialIndexIterator::CollectRows(GUInt32 iLevel, GUInt32 nPage)
+{
+    const int errorRetValue = FALSE;
+    returnErrorIf(nPage < 1);
+    GByte* pabyPage = abyPage[iLevel];
+    VSIFSeekL(fpSpx, static_cast<vsi_l_offset>(nPage - 1) * FGDB_PAGE_SIZE,
+              SEEK_SET);
+    returnErrorIf(VSIFReadL( pabyPage, FGDB_PAGE_SIZE, 1, fpSpx ) != 1 );
+
+    const GUInt32 nCount = GetUInt32(pabyPage + 4, 0);
+    returnErrorIf(nCount > nMaxPerPages);
+
+    if( iLevel + 1 < nIndexDepth )
+    {
+        /* Internal page: nCount keys, the i-th one being the greatest */
+        /* key of the i-th of the nCount + 1 sub-pages */
+        returnErrorIf(nCount == 0);
+        for( GUInt32 i = 0; i <= nCount; i++ )
+        {
+            if( i < nCount && GetKey(pabyPage, i) < nMinKey )
+                continue;
+            const GUInt32 nSubPage = GetUInt32(pabyPage + 8, i);
+            returnErrorIf(nSubPage < 2);
+            if( !CollectRows(iLevel + 1, nSubPage) )
+                return FALSE;
+            /* The recursion overwrote the pages of the next levels only */
+            if( i < nCount && GetKey(pabyPage, i) > nMaxKey )
+                break;
+        }
+        return TRUE;
+    }
+
+    const int nTotalRecordCount = poParent->GetTotalRecordCount();
+    for( GUInt32 i = 0; i < nCount; i++ )
+    {
+        const GIntBig nKey = GetKey(pabyPage, i);
+        if( nKey < nMinKey || nKey > nMaxKey )
+            continue;
+        if( bCheckCellRow )
+        {
+            const GUInt32 nCellRow = static_cast<GUInt32>(nKey & 0x7FFFFFFF);
+            if( nCellRow < nMinCellRow || nCellRow > nMaxCellRow )
+                continue;
+        }
+        const GUInt32 nFID = GetUInt32(pabyPage + 12, i);
+        returnErrorIf(nFID < 1 ||
+                      nFID > static_cast<GUInt32>(nTotalRecordCount));
+        anRows.push_back(static_cast<int>(nFID - 1));
+    }
+    return TRUE;
+}
+
+/************************************************************************/
+/*                        GetNextRowSortedByFID()                       */
+/************************************************************************/
+
+int FileGDBSpatialIndexIterator::GetNextRowSortedByFID()
+{
+    if( iCurRow < anRows.size() )
+        return anRows[iCurRow++];
+    return -1;
+}
+
 } /* namespace OpenFileGDB */
@@ -144,6 +144,7 @@ class FileGDBGeomField: public FileGDBField
         double            dfXMax;
         double            dfYMax;
         int               bHas3D;
+        std::vector<double> adfSpatialIndexGridResolution;
 
     public:
         explicit          FileGDBGeomField(FileGDBTable* poParent);
@@ -173,6 +174,11 @@ class FileGDBGeomField: public FileGDBField
         double             GetMTolerance() const { return dfMTolerance; }
 
         int                Has3D() const { return bHas3D; }
+
+        /* Cell sizes of the grids of the .spx spatial index, from the finest */
+        /* to the coarsest one. Values <= 0 mean unused grid levels */
+        const std::vector<double>& GetSpatialIndexGridResolution() const
+                                    { return adfSpatialIndexGridResolution; }
 };
 
 /************************************************************************/
@@ -371,6 +377,10 @@ class FileGDBIterator
         static FileGDBIterator*      BuildOr(FileGDBIterator* poIter1,
                                              FileGDBIterator* poIter2,
                                              int bIteratorAreExclusive = FALSE);
+        /* Rows whose geometry may intersect the envelope, from the .spx */
+        static FileGDBIterator*      BuildFromSpatialIndex(
+                                        FileGDBTable* poParent,
+                                        const OGREnvelope& sFilterEnvelope);
 };
 
 /************************************************************************/
@@ -174,6 +174,7 @@ OGROpenFileGDBLayer::OGROpenFileGDBLayer( const char* pszGDBFilename,
     m_poIterator(nullptr),
     m_bIteratorSufficientToEvaluateFilter(FALSE),
     m_poIterMinMax(nullptr),
+    m_poSpatialIndexIterator(nullptr),
     m_eSpatialIndexState(SPI_IN_BUILDING),
     m_pQuadTree(nullptr),
     m_pahFilteredFeatures(nullptr),
@@ -210,6 +211,7 @@ OGROpenFileGDBLayer::~OGROpenFileGDBLayer()
     }
     delete m_poIterator;
     delete m_poIterMinMax;
+    delete m_poSpatialIndexIterator;
     delete m_poGeomConverter;
     if( m_pQuadTree != nullptr )
         CPLQuadTreeDestroy(m_pQuadTree);
@@ -850,6 +852,8 @@ void OGROpenFileGDBLayer::ResetReading()
     m_iCurFeat = 0;
     if( m_poIterator )
         m_poIterator->Reset();
+    if( m_poSpatialIndexIterator )
+        m_poSpatialIndexIterator->Reset();
 }
 
 /***********************************************************************/
@@ -863,6 +867,9 @@ void OGROpenFileGDBLayer::SetSpatialFilter( OGRGeometry *poGeom )
 
     OGRLayer::SetSpatialFilter(poGeom);
 
+    delete m_poSpatialIndexIterator;
+    m_poSpatialIndexIterator = nullptr;
+
     if( m_bFilterIsEnvelope )
     {
         OGREnvelope sLayerEnvelope;
@@ -901,6 +908,16 @@ void OGROpenFileGDBLayer::SetSpatialFilter( OGRGeometry *poGeom )
                 std::sort(panStart, panStart + m_nFilteredFeatureCount);
             }
         }
+        else if( m_iGeomFieldIdx >= 0 &&
+                 CPLTestBool(CPLGetConfigOption(
+                            "OPENFILEGDB_USE_SPATIAL_INDEX", "YES")) )
+        {
+            m_poSpatialIndexIterator = FileGDBIterator::BuildFromSpatialIndex(
+                                            m_poLyrTable, m_sFilterEnvelope);
+            if( m_poSpatialIndexIterator != nullptr &&
+                m_eSpatialIndexState == SPI_IN_BUILDING )
+                m_eSpatialIndexState = SPI_INVALID;
+        }
         m_poLyrTable->InstallFilterEnvelope(&m_sFilterEnvelope);
     }
     else
@@ -1601,11 +1618,14 @@ OGRFeature* OGROpenFileGDBLayer::GetNextFeature()
                 }
             }
         }
-        else if( m_poIterator != nullptr )
+        else if( m_poIterator != nullptr ||
+                 m_poSpatialIndexIterator != nullptr )
         {
+            FileGDBIterator* poIterator =
+                m_poIterator ? m_poIterator : m_poSpatialIndexIterator;
             while( true )
             {
-                int iRow = m_poIterator->GetNextRowSortedByFID();
+                int iRow = poIterator->GetNextRowSortedByFID();
                 if( iRow < 0 )
                     return nullptr;
                 if( m_poLyrTable->SelectRow(iRow) )
@@ -1701,7 +1721,7 @@ OGRFeature* OGROpenFileGDBLayer::GetFeature( GIntBig nFeatureId )
 
 OGRErr OGROpenFileGDBLayer::SetNextByIndex( GIntBig nIndex )
 {
-    if( m_poIterator != nullptr )
+    if( m_poIterator != nullptr || m_poSpatialIndexIterator != nullptr )
         return OGRLayer::SetNextByIndex(nIndex);
 
     if( !BuildLayerDefinition() )
@@ -1786,8 +1806,22 @@ GIntBig OGROpenFileGDBLayer::GetFeatureCount( int bForce )
             m_nFilteredFeatureCount = 0;
         }
 
-        for(int i=0;i<m_poLyrTable->GetTotalRecordCount();i++)
+        if( m_poSpatialIndexIterator != nullptr )
+            m_poSpatialIndexIterator->Reset();
+        int i = -1;
+        while( true )
         {
+            if( m_poSpatialIndexIterator != nullptr )
+            {
+                i = m_poSpatialIndexIterator->GetNextRowSortedByFID();
+                if( i < 0 )
+                    break;
+            }
+            else if( ++i == m_poLyrTable->GetTotalRecordCount() )
+            {
+                break;
+            }
+
             if( !m_poLyrTable->SelectRow(i) )
             {
                 if( m_poLyrTable->HasGotError() )
@@ -1846,6 +1880,8 @@ GIntBig OGROpenFileGDBLayer::GetFeatureCount( int bForce )
             m_nFilteredFeatureCount = nCount;
             m_eSpatialIndexState = SPI_COMPLETED;
         }
+        if( m_poSpatialIndexIterator != nullptr )
+            m_poSpatialIndexIterator->Reset();
 
         return nCount;
     }
@@ -1877,7 +1913,8 @@ int OGROpenFileGDBLayer::TestCapability( const char * pszCap )
     {
         return ( m_poLyrTable->GetValidRecordCount() ==
                  m_poLyrTable->GetTotalRecordCount() &&
-                 m_poIterator == nullptr );
+                 m_poIterator == nullptr &&
+                 m_poSpatialIndexIterator == nullptr );
     }
     else if( EQUAL(pszCap,OLCRandomRead) )
     {
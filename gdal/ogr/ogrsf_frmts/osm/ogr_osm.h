@@ -35,6 +35,7 @@
 
 #include "ogrsf_frmts.h"
 #include "cpl_string.h"
+#include "cpl_virtualmem.h"
 
 #include <set>
 #include <unordered_set>
@@ -274,6 +275,13 @@ typedef struct
     EMULATED_BOOL       bAttrFilterAlreadyEvaluated : 1;
 } WayFeaturePair;
 
+typedef struct
+{
+    size_t              nOffset;  /* index of first coordinate in OGROSMDataSource.m_asResolvedLonLat */
+    unsigned int        nFound;   /* number of coordinates found */
+    OGRLineString      *poLS;     /* geometry if the way has a feature, or nullptr */
+} ResolvedWay;
+
 #ifdef ENABLE_NODE_LOOKUP_BY_HASHING
 typedef struct
 {
@@ -385,6 +393,9 @@ class OGROSMDataSource : public OGRDataSource
     WayFeaturePair     *pasWayFeaturePairs;
     int                 nWayFeaturePairs;
 
+    std::vector<ResolvedWay> m_asResolvedWays;
+    std::vector<LonLat>      m_asResolvedLonLat;
+
     int                          nNextKeyIndex;
     std::vector<KeyDesc*>         asKeys;
     std::map<const char*, KeyDesc*, ConstCharComp> aoMapIndexedKeys; /* map that is the reverse of asKeys */
@@ -395,6 +406,15 @@ class OGROSMDataSource : public OGRDataSource
     GIntBig             nNodesFileSize;
     VSILFILE           *fpNodes;
 
+    // Memory-mapped sparse file, indexed by node id
+    bool                m_bFlatNodes;
+    CPLString           m_osFlatNodesFilename;
+    bool                m_bMustUnlinkFlatNodesFile;
+    VSILFILE           *m_fpFlatNodes;
+    CPLVirtualMem      *m_psFlatNodesMem;
+    LonLat             *m_pasFlatNodes;
+    GIntBig             m_nFlatNodesCapacity;
+
     GIntBig             nPrevNodeId;
     int                 nBucketOld;
     int                 nOffInBucketReducedOld;
@@ -430,6 +450,9 @@ class OGROSMDataSource : public OGRDataSource
     bool                FlushCurrentSectorCompressedCase();
     bool                FlushCurrentSectorNonCompressedCase();
     bool                IndexPointCustom( OSMNode* psNode );
+    bool                GrowFlatNodesMapping( GIntBig nID );
+    void                ResetFlatNodes();
+    bool                IndexPointFlat( OSMNode* psNode );
 
     void                IndexWay(GIntBig nWayID, bool bIsArea,
                                  unsigned int nTags, IndexedKVP* pasTags,
@@ -440,6 +463,10 @@ class OGROSMDataSource : public OGRDataSource
     bool                CommitTransactionCacheDB();
 
     int                 FindNode(GIntBig nID);
+    unsigned int        ResolveWayNodes( const WayFeaturePair* psWayFeaturePairs,
+                                         LonLat* pasLonLat );
+    static void         ResolveWaysJob( void* pData );
+    void                ResolveWaysInParallel( CPLWorkerThreadPool* poWTP );
     void                ProcessWaysBatch();
 
     void                ProcessPolygonsStandalone();
@@ -449,6 +476,7 @@ class OGROSMDataSource : public OGRDataSource
     void                LookupNodesCustom();
     void                LookupNodesCustomCompressedCase();
     void                LookupNodesCustomNonCompressedCase();
+    void                LookupNodesFlat();
 
     unsigned int        LookupWays( std::map< GIntBig, std::pair<int,void*> >& aoMapWays,
                                     OSMRelation* psRelation );
@@ -54,6 +54,7 @@
 #include "cpl_string.h"
 #include "cpl_time.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "ogr_core.h"
 #include "ogr_feature.h"
@@ -297,6 +298,12 @@ OGROSMDataSource::OGROSMDataSource() :
     bMustUnlinkNodesFile(true),
     nNodesFileSize(0),
     fpNodes(nullptr),
+    m_bFlatNodes(false),
+    m_bMustUnlinkFlatNodesFile(true),
+    m_fpFlatNodes(nullptr),
+    m_psFlatNodesMem(nullptr),
+    m_pasFlatNodes(nullptr),
+    m_nFlatNodesCapacity(0),
     nPrevNodeId(-INT_MAX),
     nBucketOld(-1),
     nOffInBucketReducedOld(-1),
@@ -394,6 +401,17 @@ OGROSMDataSource::~OGROSMDataSource()
             VSIUnlink(osNodesFilename);
     }
 
+    if( m_psFlatNodesMem )
+        CPLVirtualMemFree(m_psFlatNodesMem);
+    if( m_fpFlatNodes )
+        VSIFCloseL(m_fpFlatNodes);
+    if( !m_osFlatNodesFilename.empty() && m_bMustUnlinkFlatNodesFile )
+    {
+        const char* pszVal = CPLGetConfigOption("OSM_UNLINK_TMPFILE", "YES");
+        if( !EQUAL(pszVal, "NOT_EVEN_AT_END") )
+            VSIUnlink(m_osFlatNodesFilename);
+    }
+
     CPLFree(pabySector);
     std::map<int, Bucket>::iterator oIter = oMapBuckets.begin();
     for( ; oIter != oMapBuckets.end(); ++oIter )
@@ -496,6 +514,9 @@ bool OGROSMDataSource::IndexPoint( OSMNode* psNode )
     if( !bIndexPoints )
         return true;
 
+    if( m_bFlatNodes )
+        return IndexPointFlat(psNode);
+
     if( bCustomIndexing)
         return IndexPointCustom(psNode);
 
@@ -800,6 +821,111 @@ bool OGROSMDataSource::IndexPointCustom(OSMNode* psNode)
     return true;
 }
 
+/************************************************************************/
+/*                        GrowFlatNodesMapping()                        */
+/************************************************************************/
+
+// Node ids are used as indexes in the flat nodes file, whose mapping is
+// grown by powers of two. As the file is extended with ftruncate(), it is
+// sparse: only the pages where nodes are written consume disk space.
+constexpr GIntBig FLAT_NODES_INITIAL_CAPACITY = 1 << 24;
+constexpr GIntBig MAX_FLAT_NODE_ID = (static_cast<GIntBig>(1) << 40) - 1;
+
+// Added to the latitude, so that a zero entry means a missing node
+constexpr int FLAT_NODES_LAT_SHIFT = 1000 * 1000 * 1000;
+
+bool OGROSMDataSource::GrowFlatNodesMapping( GIntBig nID )
+{
+    GIntBig nNewCapacity =
+        std::max(m_nFlatNodesCapacity * 2, FLAT_NODES_INITIAL_CAPACITY);
+    while( nNewCapacity <= nID )
+        nNewCapacity *= 2;
+    nNewCapacity = std::min(nNewCapacity, MAX_FLAT_NODE_ID + 1);
+
+    const vsi_l_offset nNewSize =
+        static_cast<vsi_l_offset>(nNewCapacity) * sizeof(LonLat);
+    if( static_cast<vsi_l_offset>(static_cast<size_t>(nNewSize)) != nNewSize )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Node id " CPL_FRMT_GIB " too large for flat nodes file "
+                  "on this architecture. Use OSM_FLAT_NODES=NO", nID );
+        return false;
+    }
+
+    if( m_psFlatNodesMem )
+    {
+        CPLVirtualMemFree(m_psFlatNodesMem);
+        m_psFlatNodesMem = nullptr;
+        m_pasFlatNodes = nullptr;
+        m_nFlatNodesCapacity = 0;
+    }
+
+    if( VSIFTruncateL(m_fpFlatNodes, nNewSize) != 0 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot extend flat nodes file %s to " CPL_FRMT_GUIB
+                  " bytes", m_osFlatNodesFilename.c_str(), nNewSize );
+        return false;
+    }
+
+    m_psFlatNodesMem = CPLVirtualMemFileMapNew( m_fpFlatNodes, 0, nNewSize,
+                                                VIRTUALMEM_READWRITE,
+                                                nullptr, nullptr );
+    if( m_psFlatNodesMem == nullptr )
+        return false;
+    m_pasFlatNodes =
+        static_cast<LonLat*>(CPLVirtualMemGetAddr(m_psFlatNodesMem));
+    m_nFlatNodesCapacity = nNewCapacity;
+
+    return true;
+}
+
+/************************************************************************/
+/*                           ResetFlatNodes()                           */
+/************************************************************************/
+
+void OGROSMDataSource::ResetFlatNodes()
+{
+    if( m_psFlatNodesMem )
+    {
+        CPLVirtualMemFree(m_psFlatNodesMem);
+        m_psFlatNodesMem = nullptr;
+        m_pasFlatNodes = nullptr;
+    }
+    m_nFlatNodesCapacity = 0;
+    VSIFTruncateL(m_fpFlatNodes, 0);
+}
+
+/************************************************************************/
+/*                           IndexPointFlat()                           */
+/************************************************************************/
+
+bool OGROSMDataSource::IndexPointFlat( OSMNode* psNode )
+{
+    if( psNode->nID < 0 || psNode->nID > MAX_FLAT_NODE_ID )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unsupported node id value (" CPL_FRMT_GIB
+                  "). Use OSM_FLAT_NODES=NO",
+                  psNode->nID );
+        bStopParsing = true;
+        return false;
+    }
+
+    if( psNode->nID >= m_nFlatNodesCapacity &&
+        !GrowFlatNodesMapping(psNode->nID) )
+    {
+        bStopParsing = true;
+        return false;
+    }
+
+    LonLat* psLonLat = &m_pasFlatNodes[psNode->nID];
+    psLonLat->nLon = DBL_TO_INT(psNode->dfLon);
+    psLonLat->nLat = DBL_TO_INT(psNode->dfLat) + FLAT_NODES_LAT_SHIFT;
+
+    return true;
+}
+
 /************************************************************************/
 /*                             NotifyNodes()                            */
 /************************************************************************/
@@ -884,7 +1010,9 @@ static void OGROSMNotifyNodes ( unsigned int nNodes,
 
 void OGROSMDataSource::LookupNodes( )
 {
-    if( bCustomIndexing )
+    if( m_bFlatNodes )
+        LookupNodesFlat();
+    else if( bCustomIndexing )
         LookupNodesCustom();
     else
         LookupNodesSQLite();
@@ -1364,6 +1492,45 @@ void OGROSMDataSource::LookupNodesCustomNonCompressedCase()
     nReqIds = j;
 }
 
+/************************************************************************/
+/*                           LookupNodesFlat()                          */
+/************************************************************************/
+
+void OGROSMDataSource::LookupNodesFlat()
+{
+    CPLAssert(
+        nUnsortedReqIds <= static_cast<unsigned int>(MAX_ACCUMULATED_NODES));
+
+    nReqIds = 0;
+    for( unsigned int i = 0; i < nUnsortedReqIds; i++ )
+    {
+        const GIntBig id = panUnsortedReqIds[i];
+        if( id >= 0 && id < m_nFlatNodesCapacity &&
+            m_pasFlatNodes[id].nLat != 0 )
+        {
+            panReqIds[nReqIds++] = id;
+        }
+    }
+
+    std::sort(panReqIds, panReqIds + nReqIds);
+
+    /* Remove duplicates */
+    unsigned int j = 0;  // Used after for.
+    for( unsigned int i = 0; i < nReqIds; i++)
+    {
+        if( !(i > 0 && panReqIds[i] == panReqIds[i-1]) )
+            panReqIds[j++] = panReqIds[i];
+    }
+    nReqIds = j;
+
+    for( unsigned int i = 0; i < nReqIds; i++ )
+    {
+        const LonLat& sLonLat = m_pasFlatNodes[panReqIds[i]];
+        pasLonLatArray[i].nLon = sLonLat.nLon;
+        pasLonLatArray[i].nLat = sLonLat.nLat - FLAT_NODES_LAT_SHIFT;
+    }
+}
+
 /************************************************************************/
 /*                            WriteVarInt()                             */
 /************************************************************************/
@@ -1665,93 +1832,204 @@ int OGROSMDataSource::FindNode(GIntBig nID)
 }
 
 /************************************************************************/
-/*                         ProcessWaysBatch()                           */
+/*                          ResolveWayNodes()                           */
 /************************************************************************/
 
-void OGROSMDataSource::ProcessWaysBatch()
+// Fetch the coordinates of the nodes of a way from the result of
+// LookupNodes(). Only reads the node arrays, so can be run concurrently.
+unsigned int OGROSMDataSource::ResolveWayNodes(
+    const WayFeaturePair* psWayFeaturePair, LonLat* pasLonLat )
 {
-    if( nWayFeaturePairs == 0 ) return;
-
-    //printf("nodes = %d, features = %d\n", nUnsortedReqIds, nWayFeaturePairs);
-    LookupNodes();
-
-    for( int iPair = 0; iPair < nWayFeaturePairs; iPair ++)
-    {
-        WayFeaturePair* psWayFeaturePairs = &pasWayFeaturePairs[iPair];
-
-        const EMULATED_BOOL bIsArea = psWayFeaturePairs->bIsArea;
-
-        unsigned int nFound = 0;
+    unsigned int nFound = 0;
 
 #ifdef ENABLE_NODE_LOOKUP_BY_HASHING
-        if( bHashedIndexValid )
+    if( bHashedIndexValid )
+    {
+        for( unsigned int i=0;i<psWayFeaturePair->nRefs;i++)
         {
-            for( unsigned int i=0;i<psWayFeaturePairs->nRefs;i++)
+            int nIndInHashArray = static_cast<int>(
+                HASH_ID_FUNC(psWayFeaturePair->panNodeRefs[i]) %
+                    HASHED_INDEXES_ARRAY_SIZE);
+            int nIdx = panHashedIndexes[nIndInHashArray];
+            if( nIdx < -1 )
             {
-                int nIndInHashArray = static_cast<int>(
-                    HASH_ID_FUNC(psWayFeaturePairs->panNodeRefs[i]) %
-                        HASHED_INDEXES_ARRAY_SIZE);
-                int nIdx = panHashedIndexes[nIndInHashArray];
-                if( nIdx < -1 )
+                int iBucket = -nIdx - 2;
+                while( true )
                 {
-                    int iBucket = -nIdx - 2;
-                    while( true )
+                    nIdx = psCollisionBuckets[iBucket].nInd;
+                    if( panReqIds[nIdx] ==
+                        psWayFeaturePair->panNodeRefs[i] )
+                        break;
+                    iBucket = psCollisionBuckets[iBucket].nNext;
+                    if( iBucket < 0 )
                     {
-                        nIdx = psCollisionBuckets[iBucket].nInd;
-                        if( panReqIds[nIdx] ==
-                            psWayFeaturePairs->panNodeRefs[i] )
-                            break;
-                        iBucket = psCollisionBuckets[iBucket].nNext;
-                        if( iBucket < 0 )
-                        {
-                            nIdx = -1;
-                            break;
-                        }
+                        nIdx = -1;
+                        break;
                     }
                 }
-                else if( nIdx >= 0 &&
-                         panReqIds[nIdx] != psWayFeaturePairs->panNodeRefs[i] )
-                    nIdx = -1;
+            }
+            else if( nIdx >= 0 &&
+                     panReqIds[nIdx] != psWayFeaturePair->panNodeRefs[i] )
+                nIdx = -1;
 
-                if( nIdx >= 0 )
-                {
-                    pasLonLatCache[nFound].nLon = pasLonLatArray[nIdx].nLon;
-                    pasLonLatCache[nFound].nLat = pasLonLatArray[nIdx].nLat;
-                    nFound ++;
-                }
+            if( nIdx >= 0 )
+            {
+                pasLonLat[nFound].nLon = pasLonLatArray[nIdx].nLon;
+                pasLonLat[nFound].nLat = pasLonLatArray[nIdx].nLat;
+                nFound ++;
             }
         }
-        else
+    }
+    else
 #endif // ENABLE_NODE_LOOKUP_BY_HASHING
+    {
+        int nIdx = -1;
+        for( unsigned int i=0;i<psWayFeaturePair->nRefs;i++)
         {
-            int nIdx = -1;
-            for( unsigned int i=0;i<psWayFeaturePairs->nRefs;i++)
+            if( nIdx >= 0 && psWayFeaturePair->panNodeRefs[i] ==
+                             psWayFeaturePair->panNodeRefs[i-1] + 1 )
             {
-                if( nIdx >= 0 && psWayFeaturePairs->panNodeRefs[i] ==
-                                 psWayFeaturePairs->panNodeRefs[i-1] + 1 )
-                {
-                    if( nIdx+1 < (int)nReqIds && panReqIds[nIdx+1] ==
-                                        psWayFeaturePairs->panNodeRefs[i] )
-                        nIdx ++;
-                    else
-                        nIdx = -1;
-                }
+                if( nIdx+1 < (int)nReqIds && panReqIds[nIdx+1] ==
+                                    psWayFeaturePair->panNodeRefs[i] )
+                    nIdx ++;
                 else
-                    nIdx = FindNode( psWayFeaturePairs->panNodeRefs[i] );
-                if( nIdx >= 0 )
-                {
-                    pasLonLatCache[nFound].nLon = pasLonLatArray[nIdx].nLon;
-                    pasLonLatCache[nFound].nLat = pasLonLatArray[nIdx].nLat;
-                    nFound ++;
-                }
+                    nIdx = -1;
+            }
+            else
+                nIdx = FindNode( psWayFeaturePair->panNodeRefs[i] );
+            if( nIdx >= 0 )
+            {
+                pasLonLat[nFound].nLon = pasLonLatArray[nIdx].nLon;
+                pasLonLat[nFound].nLat = pasLonLatArray[nIdx].nLat;
+                nFound ++;
             }
         }
+    }
+
+    if( nFound > 0 && psWayFeaturePair->bIsArea )
+    {
+        pasLonLat[nFound].nLon = pasLonLat[0].nLon;
+        pasLonLat[nFound].nLat = pasLonLat[0].nLat;
+        nFound ++;
+    }
+
+    return nFound;
+}
 
-        if( nFound > 0 && bIsArea )
+/************************************************************************/
+/*                           ResolveWaysJob()                           */
+/************************************************************************/
+
+typedef struct
+{
+    OGROSMDataSource   *poDS;
+    int                 iFirstPair;
+    int                 iLastPair;  /* exclusive */
+} ResolveWaysJobData;
+
+void OGROSMDataSource::ResolveWaysJob( void* pData )
+{
+    ResolveWaysJobData* psJob = static_cast<ResolveWaysJobData*>(pData);
+    OGROSMDataSource* poDS = psJob->poDS;
+    for( int iPair = psJob->iFirstPair; iPair < psJob->iLastPair; iPair++ )
+    {
+        const WayFeaturePair* psWayFeaturePair =
+                                        &poDS->pasWayFeaturePairs[iPair];
+        ResolvedWay& sResolvedWay = poDS->m_asResolvedWays[iPair];
+        LonLat* pasLonLat =
+                    &poDS->m_asResolvedLonLat[sResolvedWay.nOffset];
+        sResolvedWay.nFound =
+                    poDS->ResolveWayNodes(psWayFeaturePair, pasLonLat);
+        sResolvedWay.poLS = nullptr;
+        if( sResolvedWay.nFound >= 2 && psWayFeaturePair->poFeature )
         {
-            pasLonLatCache[nFound].nLon = pasLonLatCache[0].nLon;
-            pasLonLatCache[nFound].nLat = pasLonLatCache[0].nLat;
-            nFound ++;
+            sResolvedWay.poLS = new OGRLineString();
+            sResolvedWay.poLS->setNumPoints(
+                                static_cast<int>(sResolvedWay.nFound), FALSE);
+            for( unsigned int i = 0; i < sResolvedWay.nFound; i++ )
+            {
+                sResolvedWay.poLS->setPoint(i,
+                                            INT_TO_DBL(pasLonLat[i].nLon),
+                                            INT_TO_DBL(pasLonLat[i].nLat));
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                        ResolveWaysInParallel()                       */
+/************************************************************************/
+
+constexpr int MIN_WAYS_PER_RESOLVE_JOB = 1000;
+
+void OGROSMDataSource::ResolveWaysInParallel( CPLWorkerThreadPool* poWTP )
+{
+    m_asResolvedWays.resize(nWayFeaturePairs);
+    size_t nOffset = 0;
+    for( int iPair = 0; iPair < nWayFeaturePairs; iPair ++)
+    {
+        m_asResolvedWays[iPair].nOffset = nOffset;
+        // One extra slot to close areas
+        nOffset += pasWayFeaturePairs[iPair].nRefs + 1;
+    }
+    m_asResolvedLonLat.resize(nOffset);
+
+    const int nJobs = std::min(4 * poWTP->GetThreadCount(),
+                               nWayFeaturePairs / MIN_WAYS_PER_RESOLVE_JOB);
+    std::vector<ResolveWaysJobData> asJobs(nJobs);
+    std::vector<void*> ahJobs;
+    for( int i = 0; i < nJobs; i++ )
+    {
+        asJobs[i].poDS = this;
+        asJobs[i].iFirstPair =
+            static_cast<int>(static_cast<GIntBig>(nWayFeaturePairs) * i / nJobs);
+        asJobs[i].iLastPair =
+            static_cast<int>(static_cast<GIntBig>(nWayFeaturePairs) * (i + 1) / nJobs);
+        ahJobs.push_back(&asJobs[i]);
+    }
+    poWTP->SubmitJobs(ResolveWaysJob, ahJobs);
+    poWTP->WaitCompletion();
+}
+
+/************************************************************************/
+/*                         ProcessWaysBatch()                           */
+/************************************************************************/
+
+void OGROSMDataSource::ProcessWaysBatch()
+{
+    if( nWayFeaturePairs == 0 ) return;
+
+    //printf("nodes = %d, features = %d\n", nUnsortedReqIds, nWayFeaturePairs);
+    LookupNodes();
+
+    // With a PBF file decoded with several threads, fetch the node
+    // coordinates and build the line geometries of the batch in parallel.
+    // Indexing of ways and emission of features remain done in file order.
+    CPLWorkerThreadPool* poWTP = OSM_GetWorkerThreadPool(psParser);
+    const bool bResolvedInParallel =
+        poWTP != nullptr && nWayFeaturePairs >= 2 * MIN_WAYS_PER_RESOLVE_JOB;
+    if( bResolvedInParallel )
+        ResolveWaysInParallel(poWTP);
+
+    for( int iPair = 0; iPair < nWayFeaturePairs; iPair ++)
+    {
+        WayFeaturePair* psWayFeaturePairs = &pasWayFeaturePairs[iPair];
+
+        const EMULATED_BOOL bIsArea = psWayFeaturePairs->bIsArea;
+
+        LonLat* pasLonLat = pasLonLatCache;
+        unsigned int nFound = 0;
+        OGRLineString* poLS = nullptr;
+        if( bResolvedInParallel )
+        {
+            const ResolvedWay& sResolvedWay = m_asResolvedWays[iPair];
+            pasLonLat = &m_asResolvedLonLat[sResolvedWay.nOffset];
+            nFound = sResolvedWay.nFound;
+            poLS = sResolvedWay.poLS;
+        }
+        else
+        {
+            nFound = ResolveWayNodes(psWayFeaturePairs, pasLonLatCache);
         }
 
         if( nFound < 2 )
@@ -1770,30 +2048,31 @@ void OGROSMDataSource::ProcessWaysBatch()
                      bIsArea != 0,
                      psWayFeaturePairs->nTags,
                      psWayFeaturePairs->pasTags,
-                     pasLonLatCache, (int)nFound,
+                     pasLonLat, (int)nFound,
                      &psWayFeaturePairs->sInfo);
         }
         else
             IndexWay(psWayFeaturePairs->nWayID, bIsArea != 0, 0, nullptr,
-                     pasLonLatCache, (int)nFound, nullptr);
+                     pasLonLat, (int)nFound, nullptr);
 
         if( psWayFeaturePairs->poFeature == nullptr )
         {
             continue;
         }
 
-        OGRLineString* poLS = new OGRLineString();
-        OGRGeometry* poGeom = poLS;
-
-        poLS->setNumPoints((int)nFound);
-        for( unsigned int i=0;i<nFound;i++)
+        if( poLS == nullptr )
         {
-            poLS->setPoint(i,
-                        INT_TO_DBL(pasLonLatCache[i].nLon),
-                        INT_TO_DBL(pasLonLatCache[i].nLat));
+            poLS = new OGRLineString();
+            poLS->setNumPoints((int)nFound);
+            for( unsigned int i=0;i<nFound;i++)
+            {
+                poLS->setPoint(i,
+                            INT_TO_DBL(pasLonLat[i].nLon),
+                            INT_TO_DBL(pasLonLat[i].nLat));
+            }
         }
 
-        psWayFeaturePairs->poFeature->SetGeometryDirectly(poGeom);
+        psWayFeaturePairs->poFeature->SetGeometryDirectly(poLS);
 
         if( nFound != psWayFeaturePairs->nRefs )
             CPLDebug("OSM", "For way " CPL_FRMT_GIB ", got only %d nodes instead of %d",
@@ -2827,6 +3106,21 @@ int OGROSMDataSource::Open( const char * pszFilename,
                         CPLGetConfigOption("OSM_COMPRESS_NODES", "NO")));
     if( bCompressNodes )
         CPLDebug("OSM", "Using compression for nodes DB");
+    m_bFlatNodes = CPLTestBool(CSLFetchNameValueDef(
+            papszOpenOptionsIn, "FLAT_NODES",
+                        CPLGetConfigOption("OSM_FLAT_NODES", "NO")));
+    if( m_bFlatNodes && !CPLIsVirtualMemFileMapAvailable() )
+    {
+        CPLError( CE_Warning, CPLE_NotSupported,
+                  "Memory mapping of files not available. "
+                  "Ignoring FLAT_NODES=YES" );
+        m_bFlatNodes = false;
+    }
+    if( m_bFlatNodes )
+    {
+        CPLDebug("OSM", "Using memory-mapped flat file for nodes");
+        bCustomIndexing = false;
+    }
 
     nLayers = 5;
     papoLayers = static_cast<OGROSMLayer **>(
@@ -2976,6 +3270,29 @@ int OGROSMDataSource::Open( const char * pszFilename,
         }
     }
 
+    if( m_bFlatNodes )
+    {
+        m_osFlatNodesFilename = CPLGenerateTempFilename("osm_tmp_flat_nodes");
+        m_fpFlatNodes = VSIFOpenL(m_osFlatNodesFilename, "wb+");
+        if( m_fpFlatNodes == nullptr )
+        {
+            CPLError( CE_Failure, CPLE_OpenFailed,
+                      "Cannot create %s", m_osFlatNodesFilename.c_str() );
+            return FALSE;
+        }
+
+        /* On Unix filesystems, you can remove a file even if it */
+        /* opened */
+        const char* pszVal = CPLGetConfigOption("OSM_UNLINK_TMPFILE", "YES");
+        if( EQUAL(pszVal, "YES") )
+        {
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            m_bMustUnlinkFlatNodesFile =
+                VSIUnlink( m_osFlatNodesFilename ) != 0;
+            CPLPopErrorHandler();
+        }
+    }
+
     const bool bRet = CreateTempDB();
     if( bRet )
     {
@@ -3843,6 +4160,9 @@ int OGROSMDataSource::MyResetReading()
         nNextKeyIndex = 0;
     }
 
+    if( m_bFlatNodes )
+        ResetFlatNodes();
+
     if( bCustomIndexing )
     {
         nPrevNodeId = -1;
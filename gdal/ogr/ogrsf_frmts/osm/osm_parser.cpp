@@ -36,6 +36,7 @@
 #include <cstring>
 #include <algorithm>
 #include <exception>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -120,6 +121,37 @@ typedef struct
     bool         bStatus;
 } DecompressionJob;
 
+// Notifications emitted while decoding a PrimitiveBlock in a worker thread
+// are recorded in a DecodedBlock, and replayed in file order from the
+// calling thread.
+typedef enum
+{
+    DECODED_NODES,
+    DECODED_WAY,
+    DECODED_RELATION
+} DecodedEventType;
+
+typedef struct
+{
+    DecodedEventType eType;
+    unsigned int     nCount;
+} DecodedEvent;
+
+struct DecodedBlock
+{
+    OSMContext                *psWorkerCtxt = nullptr;
+    const DecompressionJob    *psJob = nullptr;
+    bool                       bStatus = false;
+
+    std::vector<DecodedEvent>  asEvents{};
+    std::vector<OSMNode>       asNodes{};
+    std::vector<OSMWay>        asWays{};
+    std::vector<OSMRelation>   asRelations{};
+    std::vector<OSMTag>        asTags{};
+    std::vector<GIntBig>       anNodeRefs{};
+    std::vector<OSMMember>     asMembers{};
+};
+
 struct _OSMContext
 {
     char          *pszStrBuf;
@@ -162,6 +194,11 @@ struct _OSMContext
     int              nJobs;
     int              iNextJob;
 
+    DecodedBlock    *pasDecodedBlocks;
+    int              nDecodedBlocksAllocated;
+    int              iFirstDecodedJob;
+    int              nDecodedJobs;
+
 #ifdef HAVE_EXPAT
     XML_Parser     hXMLParser;
     bool           bEOF;
@@ -1638,6 +1675,7 @@ static void DecompressFunction(void* pDataIn)
 static bool RunDecompressionJobs(OSMContext* psCtxt)
 {
     psCtxt->nTotalUncompressedSize = 0;
+    psCtxt->nDecodedJobs = 0;
 
     GByte* pabyDstBase = psCtxt->pabyUncompressed;
     std::vector<void*> ahJobs;
@@ -1663,13 +1701,229 @@ static bool RunDecompressionJobs(OSMContext* psCtxt)
     return bRet;
 }
 
+/************************************************************************/
+/*                         Record notifications                         */
+/************************************************************************/
+
+static void RecordTags( DecodedBlock* psBlock,
+                        unsigned int nTags, const OSMTag* pasTags )
+{
+    if( nTags )
+        psBlock->asTags.insert(psBlock->asTags.end(), pasTags, pasTags + nTags);
+}
+
+static void RecordNodes( unsigned int nNodes, OSMNode* pasNodes,
+                         OSMContext* /* psCtxt */, void* user_data )
+{
+    DecodedBlock* psBlock = static_cast<DecodedBlock*>(user_data);
+    const DecodedEvent sEvent = { DECODED_NODES, nNodes };
+    psBlock->asEvents.push_back(sEvent);
+    for( unsigned int i = 0; i < nNodes; i++ )
+    {
+        psBlock->asNodes.push_back(pasNodes[i]);
+        RecordTags(psBlock, pasNodes[i].nTags, pasNodes[i].pasTags);
+    }
+}
+
+static void RecordWay( OSMWay* psWay,
+                       OSMContext* /* psCtxt */, void* user_data )
+{
+    DecodedBlock* psBlock = static_cast<DecodedBlock*>(user_data);
+    const DecodedEvent sEvent = { DECODED_WAY, 1 };
+    psBlock->asEvents.push_back(sEvent);
+    psBlock->asWays.push_back(*psWay);
+    RecordTags(psBlock, psWay->nTags, psWay->pasTags);
+    psBlock->anNodeRefs.insert(psBlock->anNodeRefs.end(),
+                               psWay->panNodeRefs,
+                               psWay->panNodeRefs + psWay->nRefs);
+}
+
+static void RecordRelation( OSMRelation* psRelation,
+                            OSMContext* /* psCtxt */, void* user_data )
+{
+    DecodedBlock* psBlock = static_cast<DecodedBlock*>(user_data);
+    const DecodedEvent sEvent = { DECODED_RELATION, 1 };
+    psBlock->asEvents.push_back(sEvent);
+    psBlock->asRelations.push_back(*psRelation);
+    RecordTags(psBlock, psRelation->nTags, psRelation->pasTags);
+    psBlock->asMembers.insert(psBlock->asMembers.end(),
+                              psRelation->pasMembers,
+                              psRelation->pasMembers + psRelation->nMembers);
+}
+
+/************************************************************************/
+/*                           DecodeFunction()                           */
+/************************************************************************/
+
+static void DecodeFunction(void* pDataIn)
+{
+    DecodedBlock* psBlock = static_cast<DecodedBlock*>(pDataIn);
+    psBlock->asEvents.clear();
+    psBlock->asNodes.clear();
+    psBlock->asWays.clear();
+    psBlock->asRelations.clear();
+    psBlock->asTags.clear();
+    psBlock->anNodeRefs.clear();
+    psBlock->asMembers.clear();
+
+    const DecompressionJob* psJob = psBlock->psJob;
+    psBlock->bStatus = ReadPrimitiveBlock(
+        psJob->pabyDstBase + psJob->nDstOffset,
+        psJob->pabyDstBase + psJob->nDstOffset + psJob->nDstSize,
+        psBlock->psWorkerCtxt);
+}
+
+/************************************************************************/
+/*                         FreeDecodedBlocks()                          */
+/************************************************************************/
+
+static void FreeDecodedBlocks(OSMContext* psCtxt)
+{
+    for( int i = 0; i < psCtxt->nDecodedBlocksAllocated; i++ )
+    {
+        OSMContext* psWorkerCtxt = psCtxt->pasDecodedBlocks[i].psWorkerCtxt;
+        if( psWorkerCtxt )
+        {
+            VSIFree(psWorkerCtxt->panStrOff);
+            VSIFree(psWorkerCtxt->pasNodes);
+            VSIFree(psWorkerCtxt->pasTags);
+            VSIFree(psWorkerCtxt->pasMembers);
+            VSIFree(psWorkerCtxt->panNodeRefs);
+            VSIFree(psWorkerCtxt);
+        }
+    }
+    delete[] psCtxt->pasDecodedBlocks;
+    psCtxt->pasDecodedBlocks = nullptr;
+    psCtxt->nDecodedBlocksAllocated = 0;
+    psCtxt->nDecodedJobs = 0;
+}
+
+/************************************************************************/
+/*                          RunDecodingJobs()                           */
+/************************************************************************/
+
+// Decode the PrimitiveBlock of the decompressed jobs starting at iFirstJob
+// in parallel. At most 2 blocks per worker thread are decoded at once, to
+// bound the memory used by the recorded notifications.
+static bool RunDecodingJobs(OSMContext* psCtxt, int iFirstJob)
+{
+    if( psCtxt->pasDecodedBlocks == nullptr )
+    {
+        const int nBlocks = 2 * psCtxt->poWTP->GetThreadCount();
+        psCtxt->pasDecodedBlocks = new (std::nothrow) DecodedBlock[nBlocks];
+        if( psCtxt->pasDecodedBlocks == nullptr )
+            return false;
+        psCtxt->nDecodedBlocksAllocated = nBlocks;
+        for( int i = 0; i < nBlocks; i++ )
+        {
+            OSMContext* psWorkerCtxt = static_cast<OSMContext *>(
+                VSI_CALLOC_VERBOSE(1, sizeof(OSMContext)) );
+            if( psWorkerCtxt == nullptr )
+            {
+                FreeDecodedBlocks(psCtxt);
+                return false;
+            }
+            psWorkerCtxt->bPBF = true;
+            psWorkerCtxt->pfnNotifyNodes = RecordNodes;
+            psWorkerCtxt->pfnNotifyWay = RecordWay;
+            psWorkerCtxt->pfnNotifyRelation = RecordRelation;
+            psWorkerCtxt->pfnNotifyBounds = psCtxt->pfnNotifyBounds;
+            psWorkerCtxt->user_data = &psCtxt->pasDecodedBlocks[i];
+            psCtxt->pasDecodedBlocks[i].psWorkerCtxt = psWorkerCtxt;
+        }
+    }
+
+    const int nToDecode = std::min(psCtxt->nDecodedBlocksAllocated,
+                                   psCtxt->nJobs - iFirstJob);
+    std::vector<void*> ahJobs;
+    for( int i = 0; i < nToDecode; i++ )
+    {
+        psCtxt->pasDecodedBlocks[i].psJob = &psCtxt->asJobs[iFirstJob + i];
+        ahJobs.push_back(&psCtxt->pasDecodedBlocks[i]);
+    }
+    psCtxt->poWTP->SubmitJobs(DecodeFunction, ahJobs);
+    psCtxt->poWTP->WaitCompletion();
+
+    psCtxt->iFirstDecodedJob = iFirstJob;
+    psCtxt->nDecodedJobs = nToDecode;
+    return true;
+}
+
+/************************************************************************/
+/*                         ReplayDecodedBlock()                         */
+/************************************************************************/
+
+static bool ReplayDecodedBlock(OSMContext* psCtxt, DecodedBlock& sBlock)
+{
+    size_t iNode = 0;
+    size_t iWay = 0;
+    size_t iRelation = 0;
+    size_t iTag = 0;
+    size_t iNodeRef = 0;
+    size_t iMember = 0;
+
+    for( const DecodedEvent& sEvent : sBlock.asEvents )
+    {
+        if( sEvent.eType == DECODED_NODES )
+        {
+            OSMNode* pasNodes = sBlock.asNodes.data() + iNode;
+            for( unsigned int i = 0; i < sEvent.nCount; i++ )
+            {
+                pasNodes[i].pasTags =
+                    pasNodes[i].nTags ? &sBlock.asTags[iTag] : nullptr;
+                iTag += pasNodes[i].nTags;
+            }
+            iNode += sEvent.nCount;
+            psCtxt->pfnNotifyNodes(sEvent.nCount, pasNodes,
+                                   psCtxt, psCtxt->user_data);
+        }
+        else if( sEvent.eType == DECODED_WAY )
+        {
+            OSMWay* psWay = &sBlock.asWays[iWay++];
+            psWay->pasTags = psWay->nTags ? &sBlock.asTags[iTag] : nullptr;
+            iTag += psWay->nTags;
+            psWay->panNodeRefs = sBlock.anNodeRefs.data() + iNodeRef;
+            iNodeRef += psWay->nRefs;
+            psCtxt->pfnNotifyWay(psWay, psCtxt, psCtxt->user_data);
+        }
+        else
+        {
+            OSMRelation* psRelation = &sBlock.asRelations[iRelation++];
+            psRelation->pasTags =
+                psRelation->nTags ? &sBlock.asTags[iTag] : nullptr;
+            iTag += psRelation->nTags;
+            psRelation->pasMembers = sBlock.asMembers.data() + iMember;
+            iMember += psRelation->nMembers;
+            psCtxt->pfnNotifyRelation(psRelation, psCtxt, psCtxt->user_data);
+        }
+    }
+
+    return sBlock.bStatus;
+}
+
 /************************************************************************/
 /*                          ProcessSingleBlob()                         */
 /************************************************************************/
 
-static bool ProcessSingleBlob(OSMContext* psCtxt,
-                           DecompressionJob& sJob, BlobType eType)
+static bool ProcessSingleBlob(OSMContext* psCtxt, int iJob, BlobType eType)
 {
+    // When several blobs have been decompressed, decode their content
+    // in parallel, and deliver the notifications in file order.
+    if( eType == BLOB_OSMDATA && psCtxt->poWTP != nullptr &&
+        psCtxt->nJobs > 1 )
+    {
+        if( iJob < psCtxt->iFirstDecodedJob ||
+            iJob >= psCtxt->iFirstDecodedJob + psCtxt->nDecodedJobs )
+        {
+            if( !RunDecodingJobs(psCtxt, iJob) )
+                return false;
+        }
+        return ReplayDecodedBlock(
+            psCtxt,
+            psCtxt->pasDecodedBlocks[iJob - psCtxt->iFirstDecodedJob]);
+    }
+
+    DecompressionJob& sJob = psCtxt->asJobs[iJob];
     if( eType == BLOB_OSMHEADER )
     {
         return ReadOSMHeader(
@@ -1700,7 +1954,7 @@ static bool RunDecompressionJobsAndProcessAll(OSMContext* psCtxt,
     }
     for( int i = 0; i < psCtxt->nJobs; i++ )
     {
-        if( !ProcessSingleBlob(psCtxt, psCtxt->asJobs[i], eType) )
+        if( !ProcessSingleBlob(psCtxt, i, eType) )
         {
             return false;
         }
@@ -1870,7 +2124,7 @@ bool ReadBlob( OSMContext* psCtxt, BlobType eType )
                 THROW_OSM_PARSING_EXCEPTION;
             }
             // Just process one blob at a time
-            if( !ProcessSingleBlob(psCtxt, psCtxt->asJobs[0], eType) )
+            if( !ProcessSingleBlob(psCtxt, 0, eType) )
             {
                 THROW_OSM_PARSING_EXCEPTION;
             }
@@ -1896,9 +2150,7 @@ static OSMRetCode PBF_ProcessBlock(OSMContext* psCtxt)
     // Process any remaining queued jobs one by one
     if (psCtxt->iNextJob < psCtxt->nJobs)
     {
-        if( !(ProcessSingleBlob(psCtxt,
-                                psCtxt->asJobs[psCtxt->iNextJob],
-                                BLOB_OSMDATA)) )
+        if( !(ProcessSingleBlob(psCtxt, psCtxt->iNextJob, BLOB_OSMDATA)) )
         {
             return OSM_ERROR;
         }
@@ -2797,11 +3049,21 @@ void OSM_Close(OSMContext* psCtxt)
     VSIFree(psCtxt->pasTags);
     VSIFree(psCtxt->pasMembers);
     VSIFree(psCtxt->panNodeRefs);
+    FreeDecodedBlocks(psCtxt);
     delete psCtxt->poWTP;
 
     VSIFCloseL(psCtxt->fp);
     VSIFree(psCtxt);
 }
+/************************************************************************/
+/*                       OSM_GetWorkerThreadPool()                      */
+/************************************************************************/
+
+CPLWorkerThreadPool* OSM_GetWorkerThreadPool( OSMContext* psCtxt )
+{
+    return psCtxt->bPBF ? psCtxt->poWTP : nullptr;
+}
+
 /************************************************************************/
 /*                          OSM_ResetReading()                          */
 /************************************************************************/
@@ -2813,6 +3075,7 @@ void OSM_ResetReading( OSMContext* psCtxt )
     psCtxt->nBytesRead = 0;
     psCtxt->nJobs = 0;
     psCtxt->iNextJob = 0;
+    psCtxt->nDecodedJobs = 0;
     psCtxt->nBlobOffset = 0;
     psCtxt->nBlobSize = 0;
     psCtxt->nTotalUncompressedSize = 0;
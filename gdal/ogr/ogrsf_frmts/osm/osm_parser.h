@@ -130,4 +130,9 @@ void OSM_Close( OSMContext* psOSMContext );
 
 CPL_C_END
 
+class CPLWorkerThreadPool;
+
+/* Worker thread pool of the parser (PBF only), or NULL if single-threaded */
+CPLWorkerThreadPool* OSM_GetWorkerThreadPool( OSMContext* psOSMContext );
+
 #endif /*  OSM_PARSER_H_INCLUDED */
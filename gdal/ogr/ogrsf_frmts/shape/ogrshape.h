@@ -53,8 +53,10 @@
 /* ==================================================================== */
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding );
-OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape );
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRFeature *poFeatureToReuse = nullptr );
+OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape,
+                               OGRGeometry *poGeomToReuse = nullptr );
 OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
                                        SHPHandle hSHP, DBFHandle hDBF,
                                        const char *pszSHPEncoding,
@@ -93,6 +95,44 @@ class OGRShapeGeomFieldDefn CPL_FINAL: public OGRGeomFieldDefn
         const CPLString& GetPrjFilename() const { return osPrjFile; }
 };
 
+/************************************************************************/
+/*                         OGRShapeHilbertIndex                         */
+/*                                                                      */
+/*      Packed Hilbert R-tree stored in a .hrt file.                    */
+/************************************************************************/
+
+class OGRShapeHilbertIndex
+{
+    VSILFILE              *fp;
+    int                    nNodeSize;
+    GUInt32                nItemCount;
+    int                    nShapeCount;
+    std::vector<GUIntBig>  anLevelCount;
+    std::vector<GUIntBig>  anLevelStart;
+
+    OGRShapeHilbertIndex();
+
+    static void ComputeLevels( GUIntBig nItemCount, int nNodeSize,
+                               std::vector<GUIntBig>& anLevelCount,
+                               std::vector<GUIntBig>& anLevelStart );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRShapeHilbertIndex)
+
+  public:
+                           ~OGRShapeHilbertIndex();
+
+    static bool            Build( SHPHandle hSHP, const char* pszFilename,
+                                  int nNodeSize = 16 );
+    static OGRShapeHilbertIndex* Open( SHPHandle hSHP,
+                                       const char* pszFilename );
+    static bool            ReadShapeExtents(
+                   SHPHandle hSHP,
+                   std::vector<std::pair<int, OGREnvelope> >& aoExtents );
+
+    int                   *Search( const OGREnvelope& sEnvelope,
+                                   int* pnShapeCount );
+};
+
 /************************************************************************/
 /*                            OGRShapeLayer                             */
 /************************************************************************/
@@ -138,6 +178,16 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     SBNSearchHandle     hSBN;
     bool                CheckForSBN();
 
+    bool                bCheckedForHRT;
+    OGRShapeHilbertIndex *poHRT;
+    bool                CheckForHRT();
+
+    bool                HasAttributeIndex();
+    OGRFeature         *ReadFeatureForIndex( GIntBig nFID );
+    OGRErr              RebuildAttributeIndex();
+    OGRErr              DropAttributeIndexOnField( int iField );
+    void                ReloadAttributeIndex();
+
     bool                bSbnSbxDeleted;
 
     CPLString           ConvertCodePage( const char * );
@@ -165,6 +215,7 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     void                TruncateDBF();
 
     bool                bCreateSpatialIndexAtClose;
+    bool                bSpatialSortAtClose;
     bool                bRewindOnWrite;
 
     bool                m_bAutoRepack;
@@ -176,6 +227,8 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     } NormandyState; /* French joke. "Peut'et' ben que oui, peut'et' ben que non." Sorry :-) */
     NormandyState       m_eNeedRepack;
 
+    OGRErr              RewriteFiles( bool bSpatialSort );
+
   protected:
 
     virtual void        CloseUnderlyingLayer() override;
@@ -188,6 +241,7 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     OGRErr              CreateSpatialIndex( int nMaxDepth );
     OGRErr              DropSpatialIndex();
     OGRErr              Repack();
+    OGRErr              SpatialSort();
     OGRErr              RecomputeExtent();
     OGRErr              ResizeDBF();
 
@@ -196,7 +250,9 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
 
     const char         *GetFullName() { return pszFullName; }
 
-    OGRFeature *        FetchShape( int iShapeId );
+    OGRFeature *        FetchShape( int iShapeId,
+                                    OGRFeature *poFeatureToReuse = nullptr );
+    OGRFeature *        GetNextFeatureInternal( OGRFeature *poFeatureToReuse );
     int                 GetFeatureCountWithSpatialFilterOnly();
 
   public:
@@ -211,6 +267,7 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
 
     void                ResetReading() override;
     OGRFeature *        GetNextFeature() override;
+    bool                GetNextFeatureInto( OGRFeature *poFeature ) override;
     virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override;
 
     OGRFeature         *GetFeature( GIntBig nFeatureId ) override;
@@ -245,6 +302,8 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     void                AddToFileList( CPLStringList& oFileList );
     void                CreateSpatialIndexAtClose( int bFlag )
         { bCreateSpatialIndexAtClose = CPL_TO_BOOL(bFlag); }
+    void                SpatialSortAtClose( int bFlag )
+        { bSpatialSortAtClose = CPL_TO_BOOL(bFlag); }
     void                SetModificationDate( const char* pszStr );
     void                SetAutoRepack(bool b) { m_bAutoRepack = b; }
     void                SetWriteDBFEOFChar(bool b);
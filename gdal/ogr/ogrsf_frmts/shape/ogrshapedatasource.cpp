@@ -815,6 +815,8 @@ OGRShapeDataSource::ICreateLayer( const char * pszLayerName,
         CPLFetchBool( papszOptions, "RESIZE", false ) );
     poLayer->CreateSpatialIndexAtClose(
         CPLFetchBool( papszOptions, "SPATIAL_INDEX", false ) );
+    poLayer->SpatialSortAtClose(
+        CPLFetchBool( papszOptions, "SPATIAL_SORT", false ) );
     poLayer->SetModificationDate(
         CSLFetchNameValue( papszOptions, "DBF_DATE_LAST_UPDATE" ) );
     poLayer->SetAutoRepack(
@@ -1186,6 +1188,8 @@ OGRErr OGRShapeDataSource::DeleteLayer( int iLayer )
     VSIUnlink( CPLResetExtension(pszFilename, "dbf") );
     VSIUnlink( CPLResetExtension(pszFilename, "prj") );
     VSIUnlink( CPLResetExtension(pszFilename, "qix") );
+    VSIUnlink( CPLResetExtension(pszFilename, "hrt") );
+    VSIUnlink( CPLResetExtension(pszFilename, "obi") );
 
     CPLFree( pszFilename );
 
@@ -217,8 +217,8 @@ static CPLErr OGRShapeDriverDelete( const char *pszDataSource )
     }
 
     static const char * const apszExtensions[] =
-        { "shp", "shx", "dbf", "sbn", "sbx", "prj", "idm", "ind",
-          "qix", "cpg", nullptr };
+        { "shp", "shx", "dbf", "sbn", "sbx", "prj", "idm", "ind", "obi",
+          "qix", "hrt", "cpg", nullptr };
 
     if( VSI_ISREG(sStatBuf.st_mode)
         && (EQUAL(CPLGetExtension(pszDataSource), "shp")
@@ -320,6 +320,7 @@ void RegisterOGRShape()
 "  <Option name='ENCODING' type='string' description='DBF encoding' default='LDID/87'/>"
 "  <Option name='RESIZE' type='boolean' description='To resize fields to their optimal size.' default='NO'/>"
 "  <Option name='SPATIAL_INDEX' type='boolean' description='To create a spatial index.' default='NO'/>"
+"  <Option name='SPATIAL_SORT' type='boolean' description='Whether to sort the features along a Hilbert curve when closing the layer, to improve the locality of spatial queries.' default='NO'/>"
 "  <Option name='DBF_DATE_LAST_UPDATE' type='string' description='Modification date to write in DBF header with YYYY-MM-DD format'/>"
 "  <Option name='AUTO_REPACK' type='boolean' description='Whether the shapefile should be automatically repacked when needed' default='YES'/>"
 "  <Option name='DBF_EOF_CHAR' type='boolean' description='Whether to write the 0x1A end-of-file character in DBF files' default='YES'/>"
@@ -0,0 +1,609 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implements OGRShapeHilbertIndex class, a packed Hilbert R-tree
+ *           spatial index stored in a .hrt file next to the .shp.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+/*
+ * File layout (all values little endian):
+ *
+ *   Header (56 bytes):
+ *     char[4]   magic "SHRT"
+ *     uint32    version (1)
+ *     uint32    node size (maximum number of children of a node)
+ *     uint32    number of indexed shapes
+ *     uint32    number of records of the .shp when the index was built
+ *     uint32    size of the .shp in bytes when the index was built
+ *     double[4] extent: minx, miny, maxx, maxy
+ *
+ *   Nodes (40 bytes each): minx, miny, maxx, maxy as doubles, followed by
+ *   an uint64 which is the shape id for leaves, and the index of the first
+ *   child for the other nodes.
+ *
+ * Nodes are ordered level by level, starting with the root and ending with
+ * the leaves sorted along a Hilbert curve. The children of a node are
+ * consecutive, so the tree can be walked level by level with forward only
+ * reads of one node at a time.
+ */
+
+#include "ogrshape.h"
+#include "ogr_p.h"
+
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_port.h"
+#include "cpl_vsi.h"
+
+CPL_CVSID("$Id$")
+
+static const char HRT_MAGIC[4] = { 'S', 'H', 'R', 'T' };
+static const GUInt32 HRT_VERSION = 1;
+static const int HRT_HEADER_SIZE = 56;
+static const int HRT_NODE_SIZE_IN_BYTES = 40;
+
+/************************************************************************/
+/*                           Little endian I/O                          */
+/************************************************************************/
+
+static void HRTWriteUInt32( GByte* pabyDest, GUInt32 nVal )
+{
+    CPL_LSBPTR32(&nVal);
+    memcpy(pabyDest, &nVal, sizeof(nVal));
+}
+
+static void HRTWriteUInt64( GByte* pabyDest, GUIntBig nVal )
+{
+    CPL_LSBPTR64(&nVal);
+    memcpy(pabyDest, &nVal, sizeof(nVal));
+}
+
+static void HRTWriteDouble( GByte* pabyDest, double dfVal )
+{
+    CPL_LSBPTR64(&dfVal);
+    memcpy(pabyDest, &dfVal, sizeof(dfVal));
+}
+
+static GUInt32 HRTReadUInt32( const GByte* pabySrc )
+{
+    GUInt32 nVal;
+    memcpy(&nVal, pabySrc, sizeof(nVal));
+    CPL_LSBPTR32(&nVal);
+    return nVal;
+}
+
+static GUIntBig HRTReadUInt64( const GByte* pabySrc )
+{
+    GUIntBig nVal;
+    memcpy(&nVal, pabySrc, sizeof(nVal));
+    CPL_LSBPTR64(&nVal);
+    return nVal;
+}
+
+static double HRTReadDouble( const GByte* pabySrc )
+{
+    double dfVal;
+    memcpy(&dfVal, pabySrc, sizeof(dfVal));
+    CPL_LSBPTR64(&dfVal);
+    return dfVal;
+}
+
+/************************************************************************/
+/*                           ComputeLevels()                            */
+/*                                                                      */
+/*      Number of nodes of each level, leaves first, and index of the   */
+/*      first node of each level.                                       */
+/************************************************************************/
+
+void OGRShapeHilbertIndex::ComputeLevels( GUIntBig nItemCount,
+                                          int nNodeSize,
+                                          std::vector<GUIntBig>& anLevelCount,
+                                          std::vector<GUIntBig>& anLevelStart )
+{
+    anLevelCount.clear();
+    anLevelStart.clear();
+    if( nItemCount == 0 )
+        return;
+
+    GUIntBig nCount = nItemCount;
+    while( true )
+    {
+        anLevelCount.push_back(nCount);
+        if( nCount == 1 )
+            break;
+        nCount = (nCount + nNodeSize - 1) / nNodeSize;
+    }
+
+    anLevelStart.resize(anLevelCount.size());
+    GUIntBig nStart = 0;
+    for( size_t i = anLevelCount.size(); i > 0; i-- )
+    {
+        anLevelStart[i - 1] = nStart;
+        nStart += anLevelCount[i - 1];
+    }
+}
+
+/************************************************************************/
+/*                          ReadShapeExtents()                          */
+/*                                                                      */
+/*      Read the bounding box of the shapes from the record headers     */
+/*      of the .shp, in a single forward pass. Null shapes and shapes   */
+/*      with an invalid bounding box are skipped.                       */
+/************************************************************************/
+
+namespace {
+bool HRTOffsetLess( const std::pair<unsigned int, int>& a,
+                    const std::pair<unsigned int, int>& b )
+{
+    return a.first < b.first;
+}
+} // namespace
+
+bool OGRShapeHilbertIndex::ReadShapeExtents(
+    SHPHandle hSHP, std::vector<std::pair<int, OGREnvelope> >& aoExtents )
+{
+    aoExtents.clear();
+    if( hSHP == nullptr )
+        return false;
+
+    std::vector<std::pair<unsigned int, int> > aoRecords;
+    try
+    {
+/* -------------------------------------------------------------------- */
+/*      Visit the records in file order so that reads are sequential.   */
+/* -------------------------------------------------------------------- */
+        aoRecords.reserve(hSHP->nRecords);
+        for( int i = 0; i < hSHP->nRecords; i++ )
+        {
+            if( hSHP->panRecSize[i] >= 4 )
+                aoRecords.push_back(
+                    std::pair<unsigned int, int>(hSHP->panRecOffset[i], i));
+        }
+        std::stable_sort(aoRecords.begin(), aoRecords.end(), HRTOffsetLess);
+        aoExtents.reserve(aoRecords.size());
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate memory for shape extents");
+        return false;
+    }
+
+    const int nBufferSize = 1024 * 1024;
+    GByte* pabyBuffer = static_cast<GByte*>(VSI_MALLOC_VERBOSE(nBufferSize));
+    if( pabyBuffer == nullptr )
+        return false;
+    SAOffset nBufferOffset = 0;
+    size_t nBufferFilled = 0;
+
+    // Record header (8 bytes), shape type and bounding box or point.
+    const int nNeeded = 8 + 4 + 4 * 8;
+    for( size_t iRec = 0; iRec < aoRecords.size(); iRec++ )
+    {
+        const SAOffset nOffset = aoRecords[iRec].first;
+        const int iShape = aoRecords[iRec].second;
+        if( nOffset < nBufferOffset ||
+            nOffset + nNeeded > nBufferOffset + nBufferFilled )
+        {
+            nBufferOffset = nOffset;
+            hSHP->sHooks.FSeek(hSHP->fpSHP, nBufferOffset, 0);
+            nBufferFilled = hSHP->sHooks.FRead(pabyBuffer, 1, nBufferSize,
+                                               hSHP->fpSHP);
+        }
+        const size_t nAvailable =
+            nBufferOffset + nBufferFilled > nOffset ?
+                static_cast<size_t>(nBufferOffset + nBufferFilled - nOffset) : 0;
+        if( nAvailable < 12 )
+            continue;
+        const GByte* pabyRec = pabyBuffer + (nOffset - nBufferOffset);
+
+        const int nSHPType = static_cast<int>(HRTReadUInt32(pabyRec + 8));
+        OGREnvelope sEnvelope;
+        if( nSHPType == SHPT_POINT || nSHPType == SHPT_POINTZ ||
+            nSHPType == SHPT_POINTM )
+        {
+            if( nAvailable < 12 + 16 || hSHP->panRecSize[iShape] < 20 )
+                continue;
+            sEnvelope.MinX = HRTReadDouble(pabyRec + 12);
+            sEnvelope.MinY = HRTReadDouble(pabyRec + 20);
+            sEnvelope.MaxX = sEnvelope.MinX;
+            sEnvelope.MaxY = sEnvelope.MinY;
+        }
+        else if( nSHPType != SHPT_NULL )
+        {
+            if( nAvailable < static_cast<size_t>(nNeeded) ||
+                hSHP->panRecSize[iShape] < 4 + 32 )
+                continue;
+            sEnvelope.MinX = HRTReadDouble(pabyRec + 12);
+            sEnvelope.MinY = HRTReadDouble(pabyRec + 20);
+            sEnvelope.MaxX = HRTReadDouble(pabyRec + 28);
+            sEnvelope.MaxY = HRTReadDouble(pabyRec + 36);
+        }
+        else
+        {
+            continue;
+        }
+        // Also skips NaN coordinates.
+        if( !(sEnvelope.MinX <= sEnvelope.MaxX &&
+              sEnvelope.MinY <= sEnvelope.MaxY) )
+            continue;
+
+        aoExtents.push_back(std::pair<int, OGREnvelope>(iShape, sEnvelope));
+    }
+    CPLFree(pabyBuffer);
+
+    return true;
+}
+
+/************************************************************************/
+/*                                Build()                               */
+/************************************************************************/
+
+namespace {
+typedef struct
+{
+    OGREnvelope sEnvelope;
+    GUInt32     nHilbert;
+    int         nShapeId;
+} HRTItem;
+
+bool HRTItemLess( const HRTItem& a, const HRTItem& b )
+{
+    if( a.nHilbert != b.nHilbert )
+        return a.nHilbert < b.nHilbert;
+    return a.nShapeId < b.nShapeId;
+}
+} // namespace
+
+bool OGRShapeHilbertIndex::Build( SHPHandle hSHP, const char* pszFilename,
+                                  int nNodeSize )
+{
+    if( hSHP == nullptr || nNodeSize < 2 )
+        return false;
+
+    std::vector<std::pair<int, OGREnvelope> > aoExtents;
+    if( !ReadShapeExtents(hSHP, aoExtents) )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Sort the shapes along the Hilbert curve of their center.        */
+/* -------------------------------------------------------------------- */
+    OGREnvelope sExtent;
+    for( size_t i = 0; i < aoExtents.size(); i++ )
+        sExtent.Merge(aoExtents[i].second);
+
+    std::vector<HRTItem> aoItems;
+    try
+    {
+        aoItems.resize(aoExtents.size());
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate memory for spatial index");
+        return false;
+    }
+    for( size_t i = 0; i < aoExtents.size(); i++ )
+    {
+        const OGREnvelope& sEnvelope = aoExtents[i].second;
+        aoItems[i].sEnvelope = sEnvelope;
+        aoItems[i].nShapeId = aoExtents[i].first;
+        aoItems[i].nHilbert = OGRHilbertCode(
+            sExtent,
+            (sEnvelope.MinX + sEnvelope.MaxX) / 2,
+            (sEnvelope.MinY + sEnvelope.MaxY) / 2);
+    }
+    std::vector<std::pair<int, OGREnvelope> >().swap(aoExtents);
+    std::sort(aoItems.begin(), aoItems.end(), HRTItemLess);
+
+/* -------------------------------------------------------------------- */
+/*      Compute the nodes, from the leaves up to the root.              */
+/* -------------------------------------------------------------------- */
+    std::vector<GUIntBig> anLevelCount;
+    std::vector<GUIntBig> anLevelStart;
+    ComputeLevels(aoItems.size(), nNodeSize, anLevelCount, anLevelStart);
+    const GUIntBig nNodeCount =
+        anLevelCount.empty() ? 0 : anLevelStart[0] + anLevelCount[0];
+
+    GByte* pabyNodes = nullptr;
+    if( nNodeCount > 0 )
+    {
+        pabyNodes = static_cast<GByte*>(VSI_MALLOC2_VERBOSE(
+            static_cast<size_t>(nNodeCount), HRT_NODE_SIZE_IN_BYTES));
+        if( pabyNodes == nullptr )
+            return false;
+    }
+
+    for( size_t i = 0; i < aoItems.size(); i++ )
+    {
+        GByte* pabyNode = pabyNodes +
+            static_cast<size_t>(anLevelStart[0] + i) * HRT_NODE_SIZE_IN_BYTES;
+        HRTWriteDouble(pabyNode, aoItems[i].sEnvelope.MinX);
+        HRTWriteDouble(pabyNode + 8, aoItems[i].sEnvelope.MinY);
+        HRTWriteDouble(pabyNode + 16, aoItems[i].sEnvelope.MaxX);
+        HRTWriteDouble(pabyNode + 24, aoItems[i].sEnvelope.MaxY);
+        HRTWriteUInt64(pabyNode + 32, aoItems[i].nShapeId);
+    }
+    const GUInt32 nItemCount = static_cast<GUInt32>(aoItems.size());
+    std::vector<HRTItem>().swap(aoItems);
+
+    for( size_t iLevel = 1; iLevel < anLevelCount.size(); iLevel++ )
+    {
+        const GUIntBig nChildStart = anLevelStart[iLevel - 1];
+        const GUIntBig nChildEnd = nChildStart + anLevelCount[iLevel - 1];
+        for( GUIntBig iNode = 0; iNode < anLevelCount[iLevel]; iNode++ )
+        {
+            const GUIntBig nFirstChild = nChildStart + iNode * nNodeSize;
+            const GUIntBig nLastChild =
+                std::min(nFirstChild + nNodeSize, nChildEnd);
+            OGREnvelope sNodeExtent;
+            for( GUIntBig iChild = nFirstChild; iChild < nLastChild; iChild++ )
+            {
+                const GByte* pabyChild = pabyNodes +
+                    static_cast<size_t>(iChild) * HRT_NODE_SIZE_IN_BYTES;
+                sNodeExtent.Merge(HRTReadDouble(pabyChild),
+                                  HRTReadDouble(pabyChild + 8));
+                sNodeExtent.Merge(HRTReadDouble(pabyChild + 16),
+                                  HRTReadDouble(pabyChild + 24));
+            }
+            GByte* pabyNode = pabyNodes +
+                static_cast<size_t>(anLevelStart[iLevel] + iNode) *
+                    HRT_NODE_SIZE_IN_BYTES;
+            HRTWriteDouble(pabyNode, sNodeExtent.MinX);
+            HRTWriteDouble(pabyNode + 8, sNodeExtent.MinY);
+            HRTWriteDouble(pabyNode + 16, sNodeExtent.MaxX);
+            HRTWriteDouble(pabyNode + 24, sNodeExtent.MaxY);
+            HRTWriteUInt64(pabyNode + 32, nFirstChild);
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the file.                                                 */
+/* -------------------------------------------------------------------- */
+    VSILFILE* fp = VSIFOpenL(pszFilename, "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_OpenFailed,
+                 "Failed to create index file %s", pszFilename);
+        CPLFree(pabyNodes);
+        return false;
+    }
+
+    GByte abyHeader[HRT_HEADER_SIZE];
+    memcpy(abyHeader, HRT_MAGIC, 4);
+    HRTWriteUInt32(abyHeader + 4, HRT_VERSION);
+    HRTWriteUInt32(abyHeader + 8, static_cast<GUInt32>(nNodeSize));
+    HRTWriteUInt32(abyHeader + 12, nItemCount);
+    HRTWriteUInt32(abyHeader + 16, static_cast<GUInt32>(hSHP->nRecords));
+    HRTWriteUInt32(abyHeader + 20, hSHP->nFileSize);
+    HRTWriteDouble(abyHeader + 24, sExtent.MinX);
+    HRTWriteDouble(abyHeader + 32, sExtent.MinY);
+    HRTWriteDouble(abyHeader + 40, sExtent.MaxX);
+    HRTWriteDouble(abyHeader + 48, sExtent.MaxY);
+
+    bool bOK = VSIFWriteL(abyHeader, HRT_HEADER_SIZE, 1, fp) == 1;
+    if( bOK && nNodeCount > 0 )
+    {
+        bOK = VSIFWriteL(pabyNodes, HRT_NODE_SIZE_IN_BYTES,
+                         static_cast<size_t>(nNodeCount), fp) ==
+              static_cast<size_t>(nNodeCount);
+    }
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+    CPLFree(pabyNodes);
+
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Failed to write index file %s", pszFilename);
+        VSIUnlink(pszFilename);
+    }
+    return bOK;
+}
+
+/************************************************************************/
+/*                        OGRShapeHilbertIndex()                        */
+/************************************************************************/
+
+OGRShapeHilbertIndex::OGRShapeHilbertIndex() :
+    fp(nullptr),
+    nNodeSize(0),
+    nItemCount(0),
+    nShapeCount(0)
+{}
+
+/************************************************************************/
+/*                       ~OGRShapeHilbertIndex()                        */
+/************************************************************************/
+
+OGRShapeHilbertIndex::~OGRShapeHilbertIndex()
+{
+    if( fp != nullptr )
+        VSIFCloseL(fp);
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/*                                                                      */
+/*      Returns nullptr if the file does not exist, is invalid, or was  */
+/*      not built from the current content of the .shp.                 */
+/************************************************************************/
+
+OGRShapeHilbertIndex* OGRShapeHilbertIndex::Open( SHPHandle hSHP,
+                                                  const char* pszFilename )
+{
+    if( hSHP == nullptr )
+        return nullptr;
+
+    VSILFILE* fp = VSIFOpenL(pszFilename, "rb");
+    if( fp == nullptr )
+        return nullptr;
+
+    GByte abyHeader[HRT_HEADER_SIZE];
+    if( VSIFReadL(abyHeader, HRT_HEADER_SIZE, 1, fp) != 1 ||
+        memcmp(abyHeader, HRT_MAGIC, 4) != 0 ||
+        HRTReadUInt32(abyHeader + 4) != HRT_VERSION )
+    {
+        CPLDebug("SHAPE", "%s is not a valid spatial index file",
+                 pszFilename);
+        VSIFCloseL(fp);
+        return nullptr;
+    }
+
+    const GUInt32 nNodeSize = HRTReadUInt32(abyHeader + 8);
+    const GUInt32 nItemCount = HRTReadUInt32(abyHeader + 12);
+    if( HRTReadUInt32(abyHeader + 16) !=
+                            static_cast<GUInt32>(hSHP->nRecords) ||
+        HRTReadUInt32(abyHeader + 20) != hSHP->nFileSize )
+    {
+        CPLDebug("SHAPE", "%s does not match the .shp file. Ignoring it",
+                 pszFilename);
+        VSIFCloseL(fp);
+        return nullptr;
+    }
+
+    OGRShapeHilbertIndex* poIndex = new OGRShapeHilbertIndex();
+    poIndex->fp = fp;
+    poIndex->nNodeSize = static_cast<int>(nNodeSize);
+    poIndex->nItemCount = nItemCount;
+    poIndex->nShapeCount = hSHP->nRecords;
+
+    bool bValid = nNodeSize >= 2 && nNodeSize <= 65535 &&
+                  nItemCount <= static_cast<GUInt32>(hSHP->nRecords);
+    if( bValid )
+    {
+        ComputeLevels(nItemCount, poIndex->nNodeSize,
+                      poIndex->anLevelCount, poIndex->anLevelStart);
+        const GUIntBig nNodeCount = poIndex->anLevelCount.empty() ? 0 :
+            poIndex->anLevelStart[0] + poIndex->anLevelCount[0];
+        VSIFSeekL(fp, 0, SEEK_END);
+        bValid = VSIFTellL(fp) ==
+            HRT_HEADER_SIZE + nNodeCount * HRT_NODE_SIZE_IN_BYTES;
+    }
+    if( !bValid )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "%s is corrupted. Ignoring it", pszFilename);
+        delete poIndex;
+        return nullptr;
+    }
+
+    return poIndex;
+}
+
+/************************************************************************/
+/*                               Search()                               */
+/*                                                                      */
+/*      Returns the sorted ids of the shapes whose bounding box         */
+/*      intersects the envelope, in an array to free with free(), or    */
+/*      nullptr in case of error.                                       */
+/************************************************************************/
+
+int* OGRShapeHilbertIndex::Search( const OGREnvelope& sEnvelope,
+                                   int* pnShapeCount )
+{
+    *pnShapeCount = 0;
+    std::vector<int> anShapes;
+
+    if( nItemCount > 0 )
+    {
+        // Queue of (first node, level) of the nodes to visit. Nodes are
+        // pushed in increasing order, so reads only go forward.
+        std::vector<std::pair<GUIntBig, int> > aoQueue;
+        aoQueue.push_back(std::pair<GUIntBig, int>(
+            0, static_cast<int>(anLevelCount.size()) - 1));
+
+        std::vector<GByte> abyNodes(
+            static_cast<size_t>(nNodeSize) * HRT_NODE_SIZE_IN_BYTES);
+        for( size_t iQueue = 0; iQueue < aoQueue.size(); iQueue++ )
+        {
+            const GUIntBig nFirst = aoQueue[iQueue].first;
+            const int iLevel = aoQueue[iQueue].second;
+            const GUIntBig nLevelEnd =
+                anLevelStart[iLevel] + anLevelCount[iLevel];
+            if( nFirst < anLevelStart[iLevel] || nFirst >= nLevelEnd )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Corrupted spatial index");
+                return nullptr;
+            }
+            const size_t nNodes = static_cast<size_t>(
+                std::min(nFirst + nNodeSize, nLevelEnd) - nFirst);
+
+            if( VSIFSeekL(fp, HRT_HEADER_SIZE +
+                              nFirst * HRT_NODE_SIZE_IN_BYTES, SEEK_SET) != 0 ||
+                VSIFReadL(&abyNodes[0], HRT_NODE_SIZE_IN_BYTES, nNodes, fp) !=
+                                                                    nNodes )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot read spatial index");
+                return nullptr;
+            }
+
+            for( size_t i = 0; i < nNodes; i++ )
+            {
+                const GByte* pabyNode = &abyNodes[i * HRT_NODE_SIZE_IN_BYTES];
+                if( HRTReadDouble(pabyNode) > sEnvelope.MaxX ||
+                    HRTReadDouble(pabyNode + 8) > sEnvelope.MaxY ||
+                    HRTReadDouble(pabyNode + 16) < sEnvelope.MinX ||
+                    HRTReadDouble(pabyNode + 24) < sEnvelope.MinY )
+                    continue;
+                const GUIntBig nOffset = HRTReadUInt64(pabyNode + 32);
+                if( iLevel == 0 )
+                {
+                    if( nOffset >= static_cast<GUIntBig>(nShapeCount) )
+                    {
+                        CPLError(CE_Failure, CPLE_AppDefined,
+                                 "Corrupted spatial index");
+                        return nullptr;
+                    }
+                    anShapes.push_back(static_cast<int>(nOffset));
+                }
+                else
+                {
+                    aoQueue.push_back(
+                        std::pair<GUIntBig, int>(nOffset, iLevel - 1));
+                }
+            }
+        }
+    }
+
+    std::sort(anShapes.begin(), anShapes.end());
+
+    // The caller expects a non-NULL pointer, even for no match.
+    int* panShapes = static_cast<int*>(
+        malloc(sizeof(int) * std::max(static_cast<size_t>(1),
+                                      anShapes.size())));
+    if( panShapes == nullptr )
+        return nullptr;
+    if( !anShapes.empty() )
+        memcpy(panShapes, &anShapes[0], sizeof(int) * anShapes.size());
+    *pnShapeCount = static_cast<int>(anShapes.size());
+    return panShapes;
+}
@@ -38,6 +38,8 @@
 #include <ctime>
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -46,6 +48,7 @@
 #include "cpl_string.h"
 #include "cpl_time.h"
 #include "cpl_vsi.h"
+#include "ogr_attrind.h"
 #include "ogr_core.h"
 #include "ogr_feature.h"
 #include "ogr_geometry.h"
@@ -93,6 +96,8 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
     hQIX(nullptr),
     bCheckedForSBN(false),
     hSBN(nullptr),
+    bCheckedForHRT(false),
+    poHRT(nullptr),
     bSbnSbxDeleted(false),
     bTruncationWarningEmitted(false),
     bHSHPWasNonNULL(hSHPIn != nullptr),
@@ -100,6 +105,7 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
     eFileDescriptorsState(FD_OPENED),
     bResizeAtClose(false),
     bCreateSpatialIndexAtClose(false),
+    bSpatialSortAtClose(false),
     bRewindOnWrite(false),
     m_bAutoRepack(false),
     m_eNeedRepack(MAYBE)
@@ -260,7 +266,9 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
 OGRShapeLayer::~OGRShapeLayer()
 
 {
-    if( m_eNeedRepack == YES && m_bAutoRepack )
+    if( bSpatialSortAtClose )
+        SpatialSort();
+    else if( m_eNeedRepack == YES && m_bAutoRepack )
         Repack();
 
     if( bResizeAtClose && hDBF != nullptr )
@@ -298,6 +306,8 @@ OGRShapeLayer::~OGRShapeLayer()
 
     if( hSBN != nullptr )
         SBNCloseDiskTree( hSBN );
+
+    delete poHRT;
 }
 
 /************************************************************************/
@@ -487,6 +497,142 @@ bool OGRShapeLayer::CheckForSBN()
     return hSBN != nullptr;
 }
 
+/************************************************************************/
+/*                            CheckForHRT()                             */
+/************************************************************************/
+
+bool OGRShapeLayer::CheckForHRT()
+
+{
+    if( bCheckedForHRT )
+        return poHRT != nullptr;
+
+    if( hSHP == nullptr )
+        return false;
+
+    const char *pszHRTFilename = CPLResetExtension( pszFullName, "hrt" );
+
+    poHRT = OGRShapeHilbertIndex::Open( hSHP, pszHRTFilename );
+
+    bCheckedForHRT = true;
+
+    return poHRT != nullptr;
+}
+
+/************************************************************************/
+/*                         HasAttributeIndex()                          */
+/*                                                                      */
+/*      Returns true if at least one field has an attribute index       */
+/*      that must be kept up to date with the content of the layer.     */
+/************************************************************************/
+
+bool OGRShapeLayer::HasAttributeIndex()
+
+{
+    InitializeIndexSupport( pszFullName );
+
+    if( m_poAttrIndex == nullptr )
+        return false;
+
+    for( int iField = 0; iField < poFeatureDefn->GetFieldCount(); iField++ )
+    {
+        if( m_poAttrIndex->GetFieldIndex( iField ) != nullptr )
+            return true;
+    }
+
+    return false;
+}
+
+/************************************************************************/
+/*                        ReadFeatureForIndex()                         */
+/*                                                                      */
+/*      Fetch the stored attributes of a record, without counting it    */
+/*      as a read feature.                                              */
+/************************************************************************/
+
+OGRFeature *OGRShapeLayer::ReadFeatureForIndex( GIntBig nFID )
+
+{
+    if( hDBF == nullptr || nFID < 0 || nFID >= hDBF->nRecords )
+        return nullptr;
+
+    return SHPReadOGRFeature( nullptr, hDBF, poFeatureDefn,
+                              static_cast<int>(nFID), nullptr, osEncoding );
+}
+
+/************************************************************************/
+/*                       RebuildAttributeIndex()                        */
+/*                                                                      */
+/*      Reindex all records, typically after a REPACK changed the       */
+/*      FIDs.                                                           */
+/************************************************************************/
+
+OGRErr OGRShapeLayer::RebuildAttributeIndex()
+
+{
+    if( !HasAttributeIndex() )
+        return OGRERR_NONE;
+
+    for( int iField = 0; iField < poFeatureDefn->GetFieldCount(); iField++ )
+    {
+        OGRAttrIndex *poIndex = m_poAttrIndex->GetFieldIndex( iField );
+        if( poIndex != nullptr && poIndex->Clear() != OGRERR_NONE )
+            return OGRERR_FAILURE;
+    }
+
+    for( int iShape = 0; iShape < nTotalShapeCount; iShape++ )
+    {
+        OGRFeature *poFeature = ReadFeatureForIndex( iShape );
+        if( poFeature == nullptr )
+            continue;
+        const OGRErr eErr = m_poAttrIndex->AddToIndex( poFeature );
+        delete poFeature;
+        if( eErr != OGRERR_NONE )
+            return eErr;
+    }
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                     DropAttributeIndexOnField()                      */
+/*                                                                      */
+/*      Drop the attribute index of a field whose definition changed,   */
+/*      as its keys no longer match the field content.                  */
+/************************************************************************/
+
+OGRErr OGRShapeLayer::DropAttributeIndexOnField( int iField )
+
+{
+    if( !HasAttributeIndex() ||
+        m_poAttrIndex->GetFieldIndex( iField ) == nullptr )
+        return OGRERR_NONE;
+
+    CPLDebug( "Shape", "Dropping attribute index on field %s of layer %s.",
+              poFeatureDefn->GetFieldDefn(iField)->GetNameRef(),
+              poFeatureDefn->GetName() );
+    return m_poAttrIndex->DropIndex( iField );
+}
+
+/************************************************************************/
+/*                        ReloadAttributeIndex()                        */
+/*                                                                      */
+/*      Field indexes are bound to field positions when the index is    */
+/*      loaded, so they must be resolved again after fields have been   */
+/*      deleted or reordered.                                           */
+/************************************************************************/
+
+void OGRShapeLayer::ReloadAttributeIndex()
+
+{
+    if( m_poAttrIndex == nullptr )
+        return;
+
+    delete m_poAttrIndex;
+    m_poAttrIndex = nullptr;
+    InitializeIndexSupport( pszFullName );
+}
+
 /************************************************************************/
 /*                            ScanIndices()                             */
 /*                                                                      */
@@ -550,16 +696,19 @@ bool OGRShapeLayer::ScanIndices()
 
     if( bTryQIXorSBN )
     {
-        if( !bCheckedForQIX )
+        if( !bCheckedForHRT )
+            CPL_IGNORE_RET_VAL(CheckForHRT());
+        if( poHRT == nullptr && !bCheckedForQIX )
             CPL_IGNORE_RET_VAL(CheckForQIX());
-        if( hQIX == nullptr && !bCheckedForSBN )
+        if( poHRT == nullptr && hQIX == nullptr && !bCheckedForSBN )
             CPL_IGNORE_RET_VAL(CheckForSBN());
     }
 
 /* -------------------------------------------------------------------- */
 /*      Compute spatial index if appropriate.                           */
 /* -------------------------------------------------------------------- */
-    if( bTryQIXorSBN && (hQIX != nullptr || hSBN != nullptr) &&
+    if( bTryQIXorSBN &&
+        (poHRT != nullptr || hQIX != nullptr || hSBN != nullptr) &&
         panSpatialFIDs == nullptr )
     {
         double adfBoundsMin[4] = {
@@ -573,7 +722,10 @@ bool OGRShapeLayer::ScanIndices()
             0.0,
             0.0 };
 
-        if( hQIX != nullptr )
+        if( poHRT != nullptr )
+            panSpatialFIDs = poHRT->Search( oSpatialFilterEnvelope,
+                                            &nSpatialFIDCount );
+        else if( hQIX != nullptr )
             panSpatialFIDs = SHPSearchDiskTreeEx( hQIX,
                                                   adfBoundsMin, adfBoundsMax,
                                                   &nSpatialFIDCount );
@@ -760,7 +912,8 @@ OGRErr OGRShapeLayer::SetNextByIndex( GIntBig nIndex )
 /*      if the shapeid bbox intersects the geometry.                    */
 /************************************************************************/
 
-OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
+OGRFeature *OGRShapeLayer::FetchShape( int iShapeId,
+                                        OGRFeature *poFeatureToReuse )
 
 {
     OGRFeature *poFeature = nullptr;
@@ -780,7 +933,8 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
             || psShape->nSHPType == SHPT_NULL )
         {
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, psShape, osEncoding,
+                                           poFeatureToReuse );
         }
         else if( m_sFilterEnvelope.MaxX < psShape->dfXMin
                  || m_sFilterEnvelope.MaxY < psShape->dfYMin
@@ -793,13 +947,15 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
         else
         {
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, psShape, osEncoding,
+                                           poFeatureToReuse );
         }
     }
     else
     {
         poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                       iShapeId, nullptr, osEncoding );
+                                       iShapeId, nullptr, osEncoding,
+                                       poFeatureToReuse );
     }
 
     return poFeature;
@@ -811,6 +967,34 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
 
 OGRFeature *OGRShapeLayer::GetNextFeature()
 
+{
+    return GetNextFeatureInternal( nullptr );
+}
+
+/************************************************************************/
+/*                         GetNextFeatureInto()                         */
+/************************************************************************/
+
+bool OGRShapeLayer::GetNextFeatureInto( OGRFeature *poFeature )
+
+{
+    if( poFeature->GetDefnRef() != poFeatureDefn )
+        return OGRLayer::GetNextFeatureInto( poFeature );
+
+    return GetNextFeatureInternal( poFeature ) != nullptr;
+}
+
+/************************************************************************/
+/*                       GetNextFeatureInternal()                       */
+/*                                                                      */
+/*      Shared by GetNextFeature() and GetNextFeatureInto().  If        */
+/*      poFeatureToReuse is not NULL, shapes are decoded into it and    */
+/*      it is returned on success.                                      */
+/************************************************************************/
+
+OGRFeature *OGRShapeLayer::GetNextFeatureInternal(
+                                        OGRFeature *poFeatureToReuse )
+
 {
     if( !TouchLayer() )
         return nullptr;
@@ -843,7 +1027,8 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
             // Check the shape object's geometry, and if it matches
             // any spatial filter, return it.
             poFeature =
-                FetchShape(static_cast<int>(panMatchingFIDs[iMatchingFID]));
+                FetchShape(static_cast<int>(panMatchingFIDs[iMatchingFID]),
+                           poFeatureToReuse);
 
             iMatchingFID++;
         }
@@ -861,10 +1046,10 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 else if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
                     return nullptr;  //* I/O error.
                 else
-                    poFeature = FetchShape(iNextShapeId);
+                    poFeature = FetchShape(iNextShapeId, poFeatureToReuse);
             }
             else
-                poFeature = FetchShape(iNextShapeId);
+                poFeature = FetchShape(iNextShapeId, poFeatureToReuse);
 
             iNextShapeId++;
         }
@@ -886,7 +1071,8 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 return poFeature;
             }
 
-            delete poFeature;
+            if( poFeature != poFeatureToReuse )
+                delete poFeature;
         }
     }
 }
@@ -948,9 +1134,22 @@ OGRErr OGRShapeLayer::ISetFeature( OGRFeature *poFeature )
     }
 
     bHeaderDirty = true;
-    if( CheckForQIX() || CheckForSBN() )
+    if( CheckForHRT() || CheckForQIX() || CheckForSBN() )
         DropSpatialIndex();
 
+    const bool bHasAttributeIndex = HasAttributeIndex();
+    if( bHasAttributeIndex )
+    {
+        OGRFeature *poOldFeature = ReadFeatureForIndex( nFID );
+        if( poOldFeature != nullptr )
+        {
+            const OGRErr eErr = m_poAttrIndex->RemoveFromIndex( poOldFeature );
+            delete poOldFeature;
+            if( eErr != OGRERR_NONE )
+                return eErr;
+        }
+    }
+
     unsigned int nOffset = 0;
     unsigned int nSize = 0;
     bool bIsLastRecord = false;
@@ -986,6 +1185,16 @@ OGRErr OGRShapeLayer::ISetFeature( OGRFeature *poFeature )
         }
     }
 
+    if( eErr == OGRERR_NONE && bHasAttributeIndex )
+    {
+        OGRFeature *poNewFeature = ReadFeatureForIndex( nFID );
+        if( poNewFeature != nullptr )
+        {
+            eErr = m_poAttrIndex->AddToIndex( poNewFeature );
+            delete poNewFeature;
+        }
+    }
+
     return eErr;
 }
 
@@ -1028,11 +1237,23 @@ OGRErr OGRShapeLayer::DeleteFeature( GIntBig nFID )
         return OGRERR_NON_EXISTING_FEATURE;
     }
 
+    if( HasAttributeIndex() )
+    {
+        OGRFeature *poOldFeature = ReadFeatureForIndex( nFID );
+        if( poOldFeature != nullptr )
+        {
+            const OGRErr eErr = m_poAttrIndex->RemoveFromIndex( poOldFeature );
+            delete poOldFeature;
+            if( eErr != OGRERR_NONE )
+                return eErr;
+        }
+    }
+
     if( !DBFMarkRecordDeleted( hDBF, static_cast<int>(nFID), TRUE ) )
         return OGRERR_FAILURE;
 
     bHeaderDirty = true;
-    if( CheckForQIX() || CheckForSBN() )
+    if( CheckForHRT() || CheckForQIX() || CheckForSBN() )
         DropSpatialIndex();
     m_eNeedRepack = YES;
 
@@ -1064,7 +1285,7 @@ OGRErr OGRShapeLayer::ICreateFeature( OGRFeature *poFeature )
     }
 
     bHeaderDirty = true;
-    if( CheckForQIX() || CheckForSBN() )
+    if( CheckForHRT() || CheckForQIX() || CheckForSBN() )
         DropSpatialIndex();
 
     poFeature->SetFID( OGRNullFID );
@@ -1219,7 +1440,7 @@ OGRErr OGRShapeLayer::ICreateFeature( OGRFeature *poFeature )
         }
     }
 
-    const OGRErr eErr =
+    OGRErr eErr =
         SHPWriteOGRFeature( hSHP, hDBF, poFeatureDefn, poFeature,
                             osEncoding, &bTruncationWarningEmitted,
                             bRewindOnWrite );
@@ -1234,6 +1455,20 @@ OGRErr OGRShapeLayer::ICreateFeature( OGRFeature *poFeature )
                  "Should not happen: Both hSHP and hDBF are nullptrs");
 #endif
 
+/* -------------------------------------------------------------------- */
+/*      Index the feature as it has been written, that is to say        */
+/*      with its potentially truncated values.                          */
+/* -------------------------------------------------------------------- */
+    if( eErr == OGRERR_NONE && HasAttributeIndex() )
+    {
+        OGRFeature *poNewFeature = ReadFeatureForIndex( poFeature->GetFID() );
+        if( poNewFeature != nullptr )
+        {
+            eErr = m_poAttrIndex->AddToIndex( poNewFeature );
+            delete poNewFeature;
+        }
+    }
+
     return eErr;
 }
 
@@ -1588,7 +1823,8 @@ int OGRShapeLayer::TestCapability( const char * pszCap )
 
     if( EQUAL(pszCap,OLCFastFeatureCount) )
     {
-        if( !(m_poFilterGeom == nullptr || CheckForQIX() || CheckForSBN()) )
+        if( !(m_poFilterGeom == nullptr || CheckForHRT() || CheckForQIX() ||
+              CheckForSBN()) )
             return FALSE;
 
         if( m_poAttrQuery != nullptr )
@@ -1603,7 +1839,7 @@ int OGRShapeLayer::TestCapability( const char * pszCap )
         return bUpdateAccess;
 
     if( EQUAL(pszCap,OLCFastSpatialFilter) )
-        return CheckForQIX() || CheckForSBN();
+        return CheckForHRT() || CheckForQIX() || CheckForSBN();
 
     if( EQUAL(pszCap,OLCFastGetExtent) )
         return TRUE;
@@ -1925,11 +2161,16 @@ OGRErr OGRShapeLayer::DeleteField( int iField )
         return OGRERR_FAILURE;
     }
 
+    if( DropAttributeIndexOnField( iField ) != OGRERR_NONE )
+        return OGRERR_FAILURE;
+
     if( DBFDeleteField( hDBF, iField ) )
     {
         TruncateDBF();
 
-        return poFeatureDefn->DeleteFieldDefn( iField );
+        const OGRErr eErr = poFeatureDefn->DeleteFieldDefn( iField );
+        ReloadAttributeIndex();
+        return eErr;
     }
 
     return OGRERR_FAILURE;
@@ -1961,7 +2202,9 @@ OGRErr OGRShapeLayer::ReorderFields( int* panMap )
 
     if( DBFReorderFields( hDBF, panMap ) )
     {
-        return poFeatureDefn->ReorderFieldDefns( panMap );
+        eErr = poFeatureDefn->ReorderFieldDefns( panMap );
+        ReloadAttributeIndex();
+        return eErr;
     }
 
     return OGRERR_FAILURE;
@@ -2075,6 +2318,13 @@ OGRErr OGRShapeLayer::AlterFieldDefn( int iField, OGRFieldDefn* poNewFieldDefn,
 
             TruncateDBF();
         }
+
+        // Keys depend on the type and width of the field, and the index
+        // is bound to the field name.
+        if( nFlagsIn & (ALTER_TYPE_FLAG | ALTER_NAME_FLAG |
+                        ALTER_WIDTH_PRECISION_FLAG) )
+            return DropAttributeIndexOnField( iField );
+
         return OGRERR_NONE;
     }
 
@@ -2302,7 +2552,11 @@ OGRErr OGRShapeLayer::DropSpatialIndex()
     if( !TouchLayer() )
         return OGRERR_FAILURE;
 
-    if( !CheckForQIX() && !CheckForSBN() )
+    // A .hrt and a .qix can coexist, so all the index files are checked.
+    const bool bHadHRT = CheckForHRT();
+    const bool bHadQIX = CheckForQIX();
+    const bool bHadSBN = CheckForSBN();
+    if( !bHadHRT && !bHadQIX && !bHadSBN )
     {
         CPLError( CE_Warning, CPLE_AppDefined,
                   "Layer %s has no spatial index, DROP SPATIAL INDEX failed.",
@@ -2310,8 +2564,6 @@ OGRErr OGRShapeLayer::DropSpatialIndex()
         return OGRERR_FAILURE;
     }
 
-    const bool bHadQIX = hQIX != nullptr;
-
     SHPCloseDiskTree( hQIX );
     hQIX = nullptr;
     bCheckedForQIX = false;
@@ -2320,6 +2572,25 @@ OGRErr OGRShapeLayer::DropSpatialIndex()
     hSBN = nullptr;
     bCheckedForSBN = false;
 
+    delete poHRT;
+    poHRT = nullptr;
+    bCheckedForHRT = false;
+
+    if( bHadHRT )
+    {
+        const char *pszHRTFilename =
+            CPLResetExtension( pszFullName, "hrt" );
+        CPLDebug( "SHAPE", "Unlinking index file %s", pszHRTFilename );
+
+        if( VSIUnlink( pszHRTFilename ) != 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Failed to delete file %s.\n%s",
+                      pszHRTFilename, VSIStrerror( errno ) );
+            return OGRERR_FAILURE;
+        }
+    }
+
     if( bHadQIX )
     {
         const char *pszQIXFilename =
@@ -2373,15 +2644,35 @@ OGRErr OGRShapeLayer::CreateSpatialIndex( int nMaxDepth )
 /* -------------------------------------------------------------------- */
 /*      If we have an existing spatial index, blow it away first.       */
 /* -------------------------------------------------------------------- */
-    if( CheckForQIX() )
+    if( CheckForHRT() || CheckForQIX() )
         DropSpatialIndex();
 
     bCheckedForQIX = false;
+    bCheckedForHRT = false;
+
+    SyncToDisk();
+
+/* -------------------------------------------------------------------- */
+/*      Build a packed Hilbert R-tree in a .hrt file if requested.      */
+/* -------------------------------------------------------------------- */
+    if( EQUAL(CPLGetConfigOption("SHAPE_SPATIAL_INDEX_FORMAT", "QIX"),
+              "HILBERT") )
+    {
+        const char *pszHRTFilename = CPLResetExtension( pszFullName, "hrt" );
+
+        CPLDebug( "SHAPE", "Creating index file %s", pszHRTFilename );
+
+        if( !OGRShapeHilbertIndex::Build( hSHP, pszHRTFilename ) )
+            return OGRERR_FAILURE;
+
+        CheckForHRT();
+
+        return OGRERR_NONE;
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Build a quadtree structure for this file.                       */
 /* -------------------------------------------------------------------- */
-    SyncToDisk();
     SHPTree *psTree = SHPCreateTree( hSHP, 2, nMaxDepth, nullptr, nullptr );
 
     if( nullptr == psTree )
@@ -2529,6 +2820,46 @@ OGRErr OGRShapeLayer::Repack()
         return OGRERR_FAILURE;
     }
 
+    return RewriteFiles( false );
+}
+
+/************************************************************************/
+/*                            SpatialSort()                             */
+/*                                                                      */
+/*      Rewrite the files with the shapes sorted along a Hilbert        */
+/*      curve of the center of their bounding box, so that shapes       */
+/*      close in space are close in the files. Deleted records are      */
+/*      dropped, as with Repack().                                      */
+/************************************************************************/
+
+OGRErr OGRShapeLayer::SpatialSort()
+
+{
+    if( !TouchLayer() )
+        return OGRERR_FAILURE;
+
+    if( !bUpdateAccess )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  UNSUPPORTED_OP_READ_ONLY,
+                  "SpatialSort");
+        return OGRERR_FAILURE;
+    }
+
+    if( hSHP == nullptr )
+        return OGRERR_NONE;
+
+    return RewriteFiles( true );
+}
+
+/************************************************************************/
+/*                            RewriteFiles()                            */
+/************************************************************************/
+
+OGRErr OGRShapeLayer::RewriteFiles( bool bSpatialSort )
+
+{
+
 /* -------------------------------------------------------------------- */
 /*      Build a list of records to be dropped.                          */
 /* -------------------------------------------------------------------- */
@@ -2585,7 +2916,7 @@ OGRErr OGRShapeLayer::Repack()
 /*      If there are no records marked for deletion, we take no         */
 /*      action.                                                         */
 /* -------------------------------------------------------------------- */
-    if( nDeleteCount == 0 && !bSHPNeedsRepack )
+    if( nDeleteCount == 0 && !bSHPNeedsRepack && !bSpatialSort )
     {
         CPLDebug("Shape", "REPACK: nothing to do");
         CPLFree( panRecordsToDelete );
@@ -2593,6 +2924,59 @@ OGRErr OGRShapeLayer::Repack()
     }
     panRecordsToDelete[nDeleteCount] = -1;
 
+/* -------------------------------------------------------------------- */
+/*      Compute the order of the records in the new files.              */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anSourceShapes;
+    {
+        std::vector<GUInt32> anSortKeys;
+        if( bSpatialSort )
+        {
+            CPLDebug("Shape", "REPACK: sorting shapes spatially");
+
+            std::vector<std::pair<int, OGREnvelope> > aoExtents;
+            if( !OGRShapeHilbertIndex::ReadShapeExtents( hSHP, aoExtents ) )
+            {
+                CPLFree( panRecordsToDelete );
+                return OGRERR_FAILURE;
+            }
+
+            OGREnvelope sLayerExtent;
+            for( size_t i = 0; i < aoExtents.size(); i++ )
+                sLayerExtent.Merge( aoExtents[i].second );
+
+            // Shapes without a bounding box go last.
+            anSortKeys.resize( nTotalShapeCount, 0xFFFFFFFFU );
+            for( size_t i = 0; i < aoExtents.size(); i++ )
+            {
+                const OGREnvelope& sEnvelope = aoExtents[i].second;
+                if( aoExtents[i].first < nTotalShapeCount )
+                    anSortKeys[aoExtents[i].first] = OGRHilbertCode(
+                        sLayerExtent,
+                        (sEnvelope.MinX + sEnvelope.MaxX) / 2,
+                        (sEnvelope.MinY + sEnvelope.MaxY) / 2 );
+            }
+        }
+
+        std::vector<std::pair<GUInt32, int> > aoOrder;
+        aoOrder.reserve( nTotalShapeCount - nDeleteCount );
+        int iNextDeletedShape = 0;
+        for( int iShape = 0; iShape < nTotalShapeCount; iShape++ )
+        {
+            if( panRecordsToDelete[iNextDeletedShape] == iShape )
+                iNextDeletedShape++;
+            else
+                aoOrder.push_back( std::pair<GUInt32, int>(
+                    anSortKeys.empty() ? 0 : anSortKeys[iShape], iShape) );
+        }
+        if( bSpatialSort )
+            std::sort( aoOrder.begin(), aoOrder.end() );
+
+        anSourceShapes.reserve( aoOrder.size() );
+        for( size_t i = 0; i < aoOrder.size(); i++ )
+            anSourceShapes.push_back( aoOrder[i].second );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Find existing filenames with exact case (see #3293).            */
 /* -------------------------------------------------------------------- */
@@ -2672,7 +3056,7 @@ OGRErr OGRShapeLayer::Repack()
 /*      Cleanup any existing spatial index.  It will become             */
 /*      meaningless when the fids change.                               */
 /* -------------------------------------------------------------------- */
-    if( CheckForQIX() || CheckForSBN() )
+    if( CheckForHRT() || CheckForQIX() || CheckForSBN() )
         DropSpatialIndex();
 
 /* -------------------------------------------------------------------- */
@@ -2682,7 +3066,7 @@ OGRErr OGRShapeLayer::Repack()
     CPLString oTempFileDBF;
     const int nNewRecords = nTotalShapeCount - nDeleteCount;
 
-    if( hDBF != nullptr && nDeleteCount > 0 )
+    if( hDBF != nullptr && (nDeleteCount > 0 || bSpatialSort) )
     {
         CPLDebug("Shape", "REPACK: repacking .dbf");
         bMustReopenDBF = true;
@@ -2713,28 +3097,19 @@ OGRErr OGRShapeLayer::Repack()
 /* -------------------------------------------------------------------- */
 /*      Copy over all records that are not deleted.                     */
 /* -------------------------------------------------------------------- */
-        int iDestShape = 0;
-        int iNextDeletedShape = 0;
-
-        for( int iShape = 0;
-             iShape < nTotalShapeCount && eErr == OGRERR_NONE;
-             iShape++ )
+        for( int iDestShape = 0;
+             iDestShape < nNewRecords && eErr == OGRERR_NONE;
+             iDestShape++ )
         {
-            if( panRecordsToDelete[iNextDeletedShape] == iShape )
-            {
-                iNextDeletedShape++;
-            }
-            else
+            const int iShape = anSourceShapes[iDestShape];
+            void *pTuple =
+                const_cast<char *>( DBFReadTuple( hDBF, iShape ) );
+            if( pTuple == nullptr ||
+                !DBFWriteTuple( hNewDBF, iDestShape, pTuple ) )
             {
-                void *pTuple =
-                    const_cast<char *>( DBFReadTuple( hDBF, iShape ) );
-                if( pTuple == nullptr ||
-                    !DBFWriteTuple( hNewDBF, iDestShape++, pTuple ) )
-                {
-                    CPLError(CE_Failure, CPLE_AppDefined,
-                             "Error writing record %d in .dbf", iShape);
-                    eErr = OGRERR_FAILURE;
-                }
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Error writing record %d in .dbf", iShape);
+                eErr = OGRERR_FAILURE;
             }
         }
 
@@ -2793,30 +3168,22 @@ OGRErr OGRShapeLayer::Repack()
 /* -------------------------------------------------------------------- */
 /*      Copy over all records that are not deleted.                     */
 /* -------------------------------------------------------------------- */
-        int iNextDeletedShape = 0;
-
-        for( int iShape = 0;
-             iShape < nTotalShapeCount && eErr == OGRERR_NONE;
-             iShape++ )
+        for( int iDestShape = 0;
+             iDestShape < nNewRecords && eErr == OGRERR_NONE;
+             iDestShape++ )
         {
-            if( panRecordsToDelete[iNextDeletedShape] == iShape )
+            const int iShape = anSourceShapes[iDestShape];
+            SHPObject *hObject = SHPReadObject( hSHP, iShape );
+            if( hObject == nullptr ||
+                SHPWriteObject( hNewSHP, -1, hObject ) == -1 )
             {
-                iNextDeletedShape++;
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Error writing record %d in .shp", iShape);
+                eErr = OGRERR_FAILURE;
             }
-            else
-            {
-                SHPObject *hObject = SHPReadObject( hSHP, iShape );
-                if( hObject == nullptr ||
-                    SHPWriteObject( hNewSHP, -1, hObject ) == -1 )
-                {
-                    CPLError(CE_Failure, CPLE_AppDefined,
-                             "Error writing record %d in .shp", iShape);
-                    eErr = OGRERR_FAILURE;
-                }
 
-                if( hObject )
-                    SHPDestroyObject( hObject );
-            }
+            if( hObject )
+                SHPDestroyObject( hObject );
         }
 
         if( bPackInPlace )
@@ -3079,7 +3446,10 @@ OGRErr OGRShapeLayer::Repack()
     bSHPNeedsRepack = false;
     m_eNeedRepack = NO;
 
-    return OGRERR_NONE;
+/* -------------------------------------------------------------------- */
+/*      FIDs have changed, so attribute indexes must be rebuilt.        */
+/* -------------------------------------------------------------------- */
+    return RebuildAttributeIndex();
 }
 
 /************************************************************************/
@@ -3421,6 +3791,10 @@ void OGRShapeLayer::CloseUnderlyingLayer()
     hSBN = nullptr;
     bCheckedForSBN = false;
 
+    delete poHRT;
+    poHRT = nullptr;
+    bCheckedForHRT = false;
+
     eFileDescriptorsState = FD_CLOSED;
 }
 
@@ -3466,13 +3840,21 @@ void OGRShapeLayer::AddToFileList( CPLStringList& oFileList )
                 (OGRShapeGeomFieldDefn*)GetLayerDefn()->GetGeomFieldDefn(0);
             oFileList.AddString(poGeomFieldDefn->GetPrjFilename());
         }
-        if( CheckForQIX() )
+        const bool bHasHRT = CheckForHRT();
+        const bool bHasQIX = CheckForQIX();
+        if( bHasHRT )
+        {
+            const char* pszHRTFilename =
+                CPLResetExtension( pszFullName, "hrt" );
+            oFileList.AddString(pszHRTFilename);
+        }
+        if( bHasQIX )
         {
             const char* pszQIXFilename =
                 CPLResetExtension( pszFullName, "qix" );
             oFileList.AddString(pszQIXFilename);
         }
-        else if( CheckForSBN() )
+        if( !bHasHRT && !bHasQIX && CheckForSBN() )
         {
             const char* pszSBNFilename =
                 CPLResetExtension( pszFullName, "sbn" );
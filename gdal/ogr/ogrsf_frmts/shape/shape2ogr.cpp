@@ -74,17 +74,25 @@ static void RingStartEnd( SHPObject *psShape, int ring, int *start, int *end )
 
 /************************************************************************/
 /*                        CreateLinearRing                              */
+/*                                                                      */
+/*      If poRing is provided, its point arrays are reused instead of   */
+/*      allocating a new ring.                                          */
 /************************************************************************/
 static OGRLinearRing * CreateLinearRing(
-    SHPObject *psShape, int ring, bool bHasZ, bool bHasM )
+    SHPObject *psShape, int ring, bool bHasZ, bool bHasM,
+    OGRLinearRing *poRing = nullptr )
 {
     int nRingStart = 0;
     int nRingEnd = 0;
     RingStartEnd( psShape, ring, &nRingStart, &nRingEnd );
 
-    OGRLinearRing * const poRing = new OGRLinearRing();
+    if( poRing == nullptr )
+        poRing = new OGRLinearRing();
     if( !(nRingEnd >= nRingStart) )
+    {
+        poRing->empty();
         return poRing;
+    }
 
     const int nRingPoints = nRingEnd - nRingStart + 1;
 
@@ -112,9 +120,14 @@ static OGRLinearRing * CreateLinearRing(
 /*                                                                      */
 /*      Read an item in a shapefile, and translate to OGR geometry      */
 /*      representation.                                                 */
+/*                                                                      */
+/*      poGeomToReuse, if not NULL, is owned by this function.  When    */
+/*      its type matches the shape, its coordinate arrays are           */
+/*      overwritten and it is returned, otherwise it is destroyed.      */
 /************************************************************************/
 
-OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
+OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape,
+                               OGRGeometry *poGeomToReuse )
 {
 #if DEBUG_VERBOSE
     CPLDebug( "Shape", "SHPReadOGRObject( iShape=%d )", iShape );
@@ -125,37 +138,59 @@ OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
 
     if( psShape == nullptr )
     {
+        delete poGeomToReuse;
         return nullptr;
     }
 
+    const OGRwkbGeometryType eReuseType =
+        poGeomToReuse ? poGeomToReuse->getGeometryType() : wkbUnknown;
+
     OGRGeometry *poOGR = nullptr;
 
 /* -------------------------------------------------------------------- */
 /*      Point.                                                          */
 /* -------------------------------------------------------------------- */
-    if( psShape->nSHPType == SHPT_POINT )
-    {
-        poOGR = new OGRPoint( psShape->padfX[0], psShape->padfY[0] );
-    }
-    else if(psShape->nSHPType == SHPT_POINTZ )
+    if( psShape->nSHPType == SHPT_POINT
+        || psShape->nSHPType == SHPT_POINTZ
+        || psShape->nSHPType == SHPT_POINTM )
     {
-        if( psShape->bMeasureIsUsed )
+        OGRPoint oPoint;
+        if( psShape->nSHPType == SHPT_POINT )
+        {
+            oPoint = OGRPoint( psShape->padfX[0], psShape->padfY[0] );
+        }
+        else if( psShape->nSHPType == SHPT_POINTZ )
+        {
+            if( psShape->bMeasureIsUsed )
+            {
+                oPoint = OGRPoint( psShape->padfX[0], psShape->padfY[0],
+                                   psShape->padfZ[0], psShape->padfM[0] );
+            }
+            else
+            {
+                oPoint = OGRPoint( psShape->padfX[0], psShape->padfY[0],
+                                   psShape->padfZ[0] );
+            }
+        }
+        else
+        {
+            oPoint = OGRPoint( psShape->padfX[0], psShape->padfY[0],
+                               0.0, psShape->padfM[0] );
+            oPoint.set3D(FALSE);
+        }
+
+        if( wkbFlatten(eReuseType) == wkbPoint )
         {
-            poOGR = new OGRPoint( psShape->padfX[0], psShape->padfY[0],
-                                  psShape->padfZ[0], psShape->padfM[0] );
+            OGRPoint *poPoint = static_cast<OGRPoint *>(poGeomToReuse);
+            *poPoint = oPoint;
+            poOGR = poPoint;
+            poGeomToReuse = nullptr;
         }
         else
         {
-            poOGR = new OGRPoint( psShape->padfX[0], psShape->padfY[0],
-                                  psShape->padfZ[0] );
+            poOGR = oPoint.clone();
         }
     }
-    else if( psShape->nSHPType == SHPT_POINTM )
-    {
-        poOGR = new OGRPoint( psShape->padfX[0], psShape->padfY[0],
-                              0.0, psShape->padfM[0] );
-        poOGR->set3D(FALSE);
-    }
 /* -------------------------------------------------------------------- */
 /*      Multipoint.                                                     */
 /* -------------------------------------------------------------------- */
@@ -227,7 +262,17 @@ OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
         }
         else if( psShape->nParts == 1 )
         {
-            OGRLineString *poOGRLine = new OGRLineString();
+            OGRLineString *poOGRLine = nullptr;
+            if( wkbFlatten(eReuseType) == wkbLineString &&
+                EQUAL(poGeomToReuse->getGeometryName(), "LINESTRING") )
+            {
+                poOGRLine = static_cast<OGRLineString *>(poGeomToReuse);
+                poGeomToReuse = nullptr;
+            }
+            else
+            {
+                poOGRLine = new OGRLineString();
+            }
             poOGR = poOGRLine;
 
             if( psShape->nSHPType == SHPT_ARCZ )
@@ -317,12 +362,30 @@ OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
         else if( psShape->nParts == 1 )
         {
             // Surely outer ring.
-            OGRPolygon *poOGRPoly = new OGRPolygon();
-            poOGR = poOGRPoly;
+            OGRPolygon *poOGRPoly = nullptr;
+            if( wkbFlatten(eReuseType) == wkbPolygon &&
+                static_cast<OGRPolygon *>(poGeomToReuse)->
+                    getExteriorRing() != nullptr &&
+                static_cast<OGRPolygon *>(poGeomToReuse)->
+                    getNumInteriorRings() == 0 )
+            {
+                poOGRPoly = static_cast<OGRPolygon *>(poGeomToReuse);
+                poGeomToReuse = nullptr;
+
+                OGRLinearRing *poRing = poOGRPoly->getExteriorRing();
+                CreateLinearRing( psShape, 0, bHasZ, bHasM, poRing );
+                poOGRPoly->set3D( poRing->Is3D() );
+                poOGRPoly->setMeasured( poRing->IsMeasured() );
+            }
+            else
+            {
+                poOGRPoly = new OGRPolygon();
 
-            OGRLinearRing *poRing =
-                CreateLinearRing( psShape, 0, bHasZ, bHasM );
-            poOGRPoly->addRingDirectly( poRing );
+                OGRLinearRing *poRing =
+                    CreateLinearRing( psShape, 0, bHasZ, bHasM );
+                poOGRPoly->addRingDirectly( poRing );
+            }
+            poOGR = poOGRPoly;
         }
         else
         {
@@ -386,6 +449,7 @@ OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
 /*      Cleanup shape, and set feature id.                              */
 /* -------------------------------------------------------------------- */
     SHPDestroyObject( psShape );
+    delete poGeomToReuse;
 
     return poOGR;
 }
@@ -1183,11 +1247,16 @@ OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
 
 /************************************************************************/
 /*                         SHPReadOGRFeature()                          */
+/*                                                                      */
+/*      If poFeatureToReuse is provided, it is filled and returned      */
+/*      instead of a new feature.  It is left untouched if the shape    */
+/*      cannot be read.                                                 */
 /************************************************************************/
 
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding )
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRFeature *poFeatureToReuse )
 
 {
     if( iShape < 0
@@ -1211,17 +1280,35 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         return nullptr;
     }
 
-    OGRFeature  *poFeature = new OGRFeature( poDefn );
+    OGRFeature *poFeature = poFeatureToReuse;
+    if( poFeature == nullptr )
+    {
+        poFeature = new OGRFeature( poDefn );
+    }
+    else
+    {
+        poFeature->SetStyleString( nullptr );
+        poFeature->SetNativeData( nullptr );
+        poFeature->SetNativeMediaType( nullptr );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Fetch geometry from Shapefile to OGRFeature.                    */
 /* -------------------------------------------------------------------- */
+    if( hSHP == nullptr || poDefn->IsGeometryIgnored() )
+    {
+        if( poFeatureToReuse != nullptr )
+            poFeature->SetGeometryDirectly( nullptr );
+    }
+
     if( hSHP != nullptr )
     {
         if( !poDefn->IsGeometryIgnored() )
         {
             OGRGeometry* poGeometry =
-                SHPReadOGRObject( hSHP, iShape, psShape );
+                SHPReadOGRObject( hSHP, iShape, psShape,
+                                  poFeatureToReuse != nullptr ?
+                                        poFeature->StealGeometry() : nullptr );
 
             // Two possibilities are expected here (both are tested by
             // GDAL Autotests):
@@ -1278,7 +1365,11 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
     {
         const OGRFieldDefn * const poFieldDefn = poDefn->GetFieldDefn(iField);
         if( poFieldDefn->IsIgnored() )
+        {
+            if( poFeatureToReuse != nullptr )
+                poFeature->UnsetField( iField );
             continue;
+        }
 
         switch( poFieldDefn->GetType() )
         {
@@ -1335,7 +1426,11 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
               // (trimmed by DBFReadStringAttribute) to indicate null
               // values for dates (#4265).
               if( pszDateValue[0] == '\0' )
+              {
+                  if( poFeatureToReuse != nullptr )
+                      poFeature->UnsetField( iField );
                   continue;
+              }
 
               OGRField sFld;
               memset( &sFld, 0, sizeof(sFld) );
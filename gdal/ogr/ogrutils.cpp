@@ -1807,3 +1807,99 @@ OGRErr OGRReadWKBGeometryType( const unsigned char * pabyData,
 
     return OGRERR_NONE;
 }
+
+/************************************************************************/
+/*                        OGRHilbertXYToIndex()                         */
+/*                                                                      */
+/*      Position along a Hilbert curve of order 16 of the (x, y) cell.  */
+/*      Branch free implementation from Fabian Giesen (public domain).  */
+/************************************************************************/
+
+static GUInt32 OGRHilbertXYToIndex( GUInt32 x, GUInt32 y )
+{
+    GUInt32 a = x ^ y;
+    GUInt32 b = 0xFFFF ^ a;
+    GUInt32 c = 0xFFFF ^ (x | y);
+    GUInt32 d = x & (y ^ 0xFFFF);
+
+    GUInt32 A = a | (b >> 1);
+    GUInt32 B = (a >> 1) ^ a;
+    GUInt32 C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    GUInt32 D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+    B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+    C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+    D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+    B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+    C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+    D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+    a = A; b = B; c = C; d = D;
+    C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+    D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+
+    GUInt32 i0 = x ^ y;
+    GUInt32 i1 = b | (0xFFFF ^ (i0 | a));
+
+    i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+    i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+    i0 = (i0 | (i0 << 2)) & 0x33333333;
+    i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+    i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+    i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+    i1 = (i1 | (i1 << 2)) & 0x33333333;
+    i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+    return (i1 << 1) | i0;
+}
+
+/************************************************************************/
+/*                           OGRHilbertCode()                           */
+/************************************************************************/
+
+/**
+ * \brief Position of a point along a Hilbert curve covering a domain.
+ *
+ * The domain is divided in a grid of 65536 x 65536 cells, and the returned
+ * value is the index of the cell of the point along the Hilbert curve that
+ * visits all cells. Sorting objects on the code of their center keeps
+ * objects close in space close in the sort order.
+ *
+ * @param sDomain extent of the domain.
+ * @param dfX x coordinate of the point, normally within the domain.
+ * @param dfY y coordinate of the point, normally within the domain.
+ * @return the Hilbert code of the point.
+ * @since GDAL 2.3
+ */
+
+GUInt32 OGRHilbertCode( const OGREnvelope& sDomain, double dfX, double dfY )
+{
+    const double dfWidth = sDomain.MaxX - sDomain.MinX;
+    const double dfHeight = sDomain.MaxY - sDomain.MinY;
+    double dfCellX = 0.0;
+    double dfCellY = 0.0;
+    if( dfWidth > 0 )
+        dfCellX = 65535.0 * (dfX - sDomain.MinX) / dfWidth;
+    if( dfHeight > 0 )
+        dfCellY = 65535.0 * (dfY - sDomain.MinY) / dfHeight;
+    // Also handles NaN.
+    if( !(dfCellX >= 0.0) )
+        dfCellX = 0.0;
+    else if( dfCellX > 65535.0 )
+        dfCellX = 65535.0;
+    if( !(dfCellY >= 0.0) )
+        dfCellY = 0.0;
+    else if( dfCellY > 65535.0 )
+        dfCellY = 65535.0;
+    return OGRHilbertXYToIndex( static_cast<GUInt32>(dfCellX),
+                                static_cast<GUInt32>(dfCellY) );
+}